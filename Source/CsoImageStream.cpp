@@ -91,12 +91,13 @@ void CCsoImageStream::InitializeBuffers()
 	// We might read a bit of alignment too, so be prepared.
 	if(m_frameSize + (1 << m_indexShift) < CSO_READ_BUFFER_SIZE)
 	{
-		m_readBuffer = new uint8[CSO_READ_BUFFER_SIZE];
+		m_readBufferSize = CSO_READ_BUFFER_SIZE;
 	}
 	else
 	{
-		m_readBuffer = new uint8[m_frameSize + (1 << m_indexShift)];
+		m_readBufferSize = m_frameSize + (1 << m_indexShift);
 	}
+	m_readBuffer = new uint8[m_readBufferSize];
 	m_zlibBuffer = new uint8[m_frameSize + (1 << m_indexShift)];
 	m_zlibBufferFrame = numFrames;
 
@@ -139,10 +140,19 @@ uint64 CCsoImageStream::Read(void* buffer, uint64 size)
 	uint64 remaining = size;
 	uint8* dest = reinterpret_cast<uint8*>(buffer);
 
-	// We read only one frame at a time for now.
 	while(remaining > 0 && !IsEOF())
 	{
-		uint32 bytes = ReadFromNextFrame(dest, remaining);
+		uint32 bytes = 0;
+		// If we're aligned on a frame and want at least a full one, we can batch frames together.
+		uint64 wholeFrames = std::min(remaining, GetTotalSize() - m_position) >> m_frameShift;
+		if(((m_position & (m_frameSize - 1)) == 0) && (wholeFrames != 0))
+		{
+			bytes = ReadWholeFrames(dest, static_cast<uint32>(wholeFrames));
+		}
+		else
+		{
+			bytes = ReadFromNextFrame(dest, remaining);
+		}
 		remaining -= bytes;
 		m_position += bytes;
 		dest += bytes;
@@ -205,7 +215,71 @@ uint32 CCsoImageStream::ReadFromNextFrame(uint8* dest, uint64 maxBytes)
 	return bytes;
 }
 
+uint32 CCsoImageStream::ReadWholeFrames(uint8* dest, uint32 frameCount)
+{
+	assert((m_position & (m_frameSize - 1)) == 0);
+
+	const uint32 firstFrame = static_cast<uint32>(m_position >> m_frameShift);
+	const uint64 firstRawPos = static_cast<uint64>(m_index[firstFrame] & 0x7FFFFFFF) << m_indexShift;
+
+	// Frames are stored sequentially, gather as many as will fit in our read buffer.
+	uint32 batchCount = 0;
+	while(batchCount < frameCount)
+	{
+		const uint32 index1 = m_index[firstFrame + batchCount + 1] & 0x7FFFFFFF;
+		const uint64 batchRawSize = (static_cast<uint64>(index1) << m_indexShift) - firstRawPos;
+		if(batchRawSize > m_readBufferSize) break;
+		batchCount++;
+	}
+
+	if(batchCount == 0)
+	{
+		// Frame doesn't fit with its alignment, use the regular path.
+		return ReadFromNextFrame(dest, m_frameSize);
+	}
+
+	const uint32 lastIndex = m_index[firstFrame + batchCount] & 0x7FFFFFFF;
+	const uint64 batchRawSize = (static_cast<uint64>(lastIndex) << m_indexShift) - firstRawPos;
+	const uint64 readRawBytes = ReadBaseAt(firstRawPos, m_readBuffer, batchRawSize);
+
+	for(uint32 i = 0; i < batchCount; i++)
+	{
+		const uint32 frame = firstFrame + i;
+		const bool compressed = (m_index[frame + 0] & 0x80000000) == 0;
+		const uint64 frameRawPos = static_cast<uint64>(m_index[frame + 0] & 0x7FFFFFFF) << m_indexShift;
+		const uint64 frameRawNext = static_cast<uint64>(m_index[frame + 1] & 0x7FFFFFFF) << m_indexShift;
+		const uint64 frameOffset = frameRawPos - firstRawPos;
+		// Last frame might be shorter than its aligned size.
+		const uint64 frameRawSize = std::min(frameRawNext, firstRawPos + readRawBytes) - frameRawPos;
+		uint8* frameDest = dest + (static_cast<uint64>(i) << m_frameShift);
+
+		if(!compressed)
+		{
+			if(frameRawSize < m_frameSize)
+			{
+				throw std::runtime_error("Unable to read uncompressed bytes from CSO.");
+			}
+			memcpy(frameDest, m_readBuffer + frameOffset, m_frameSize);
+		}
+		else
+		{
+			// Decompress straight into the destination buffer.
+			InflateFrame(m_readBuffer + frameOffset, frameRawSize, frameDest);
+		}
+	}
+
+	return batchCount << m_frameShift;
+}
+
 void CCsoImageStream::DecompressFrame(uint32 frame, uint64 readBufferSize)
+{
+	InflateFrame(m_readBuffer, readBufferSize, m_zlibBuffer);
+
+	// Our buffer now contains this frame.
+	m_zlibBufferFrame = frame;
+}
+
+void CCsoImageStream::InflateFrame(const uint8* src, uint64 srcSize, uint8* dest)
 {
 	z_stream z;
 	z.zalloc = Z_NULL;
@@ -216,9 +290,9 @@ void CCsoImageStream::DecompressFrame(uint32 frame, uint64 readBufferSize)
 		throw std::runtime_error("Unable to initialize zlib for CSO decompression.");
 	}
 
-	z.next_in = m_readBuffer;
-	z.avail_in = static_cast<uint32>(readBufferSize);
-	z.next_out = m_zlibBuffer;
+	z.next_in = const_cast<Bytef*>(src);
+	z.avail_in = static_cast<uint32>(srcSize);
+	z.next_out = dest;
 	z.avail_out = m_frameSize;
 
 	int status = inflate(&z, Z_FINISH);
@@ -228,9 +302,6 @@ void CCsoImageStream::DecompressFrame(uint32 frame, uint64 readBufferSize)
 		throw std::runtime_error("Unable to decompress CSO frame using zlib.");
 	}
 	inflateEnd(&z);
-
-	// Our buffer now contains this frame.
-	m_zlibBufferFrame = frame;
 }
 
 uint64 CCsoImageStream::ReadBaseAt(uint64 pos, uint8* dest, uint64 bytes)
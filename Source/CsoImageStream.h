@@ -20,14 +20,17 @@ private:
 	void InitializeBuffers();
 	uint64 GetTotalSize() const;
 	uint32 ReadFromNextFrame(uint8* dest, uint64 maxBytes);
+	uint32 ReadWholeFrames(uint8* dest, uint32 frameCount);
 	uint64 ReadBaseAt(uint64 pos, uint8* dest, uint64 bytes);
 	void DecompressFrame(uint32 frame, uint64 readBufferSize);
+	void InflateFrame(const uint8* src, uint64 srcSize, uint8* dest);
 
 	Framework::CStream* m_baseStream;
 	uint32 m_frameSize;
 	uint8 m_frameShift;
 	uint8 m_indexShift;
 	uint8* m_readBuffer;
+	uint32 m_readBufferSize;
 	uint8* m_zlibBuffer;
 	uint32 m_zlibBufferFrame;
 	uint32* m_index;
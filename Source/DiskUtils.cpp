@@ -7,6 +7,7 @@
 #include "IszImageStream.h"
 #include "CsoImageStream.h"
 #include "MdsDiscImage.h"
+#include "MappedFileStream.h"
 #include "StdStream.h"
 #include "StringUtils.h"
 #ifdef HAS_AMAZON_S3
@@ -98,6 +99,21 @@ DiskUtils::OpticalMediaPtr DiskUtils::CreateOpticalMediaFromPath(const fs::path&
 	}
 #endif
 
+#if !defined(__ANDROID__)
+	//Plain images can be memory mapped (only on 64-bit hosts, we need enough address space)
+	if(!stream && (sizeof(void*) == 8))
+	{
+		try
+		{
+			stream = std::make_shared<CMappedFileStream>(imagePath);
+		}
+		catch(...)
+		{
+			//Failed to map file or file isn't safe to map, will be handled below
+		}
+	}
+#endif
+
 	//If it's null after all that, just feed it to a StdStream
 	if(!stream)
 	{
@@ -1,8 +1,14 @@
 #pragma once
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
 #include "Types.h"
 #include "Stream.h"
+#include "../MappedFileStream.h"
 
 namespace ISO9660
 {
@@ -16,6 +22,25 @@ namespace ISO9660
 
 		virtual ~CBlockProvider() = default;
 		virtual void ReadBlock(uint32, void*) = 0;
+
+		//Reads 'count' consecutive blocks. Providers should override this
+		//if they can service the whole range with a single read.
+		virtual void ReadBlocks(uint32 address, uint32 count, void* blocks)
+		{
+			auto output = reinterpret_cast<uint8*>(blocks);
+			for(uint32 i = 0; i < count; i++)
+			{
+				ReadBlock(address + i, output);
+				output += BLOCKSIZE;
+			}
+		}
+
+		//True if blocks are copied from memory rather than read through
+		//system calls (ie.: writing to protected memory will fault normally)
+		virtual bool IsMemoryMapped() const
+		{
+			return false;
+		}
 	};
 
 	class CBlockProvider2048 : public CBlockProvider
@@ -31,13 +56,22 @@ namespace ISO9660
 
 		void ReadBlock(uint32 address, void* block) override
 		{
+			std::lock_guard<std::mutex> lock(m_mutex);
 			m_stream->Seek(static_cast<uint64>(address + m_offset) * BLOCKSIZE, Framework::STREAM_SEEK_SET);
 			m_stream->Read(block, BLOCKSIZE);
 		}
 
+		void ReadBlocks(uint32 address, uint32 count, void* blocks) override
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stream->Seek(static_cast<uint64>(address + m_offset) * BLOCKSIZE, Framework::STREAM_SEEK_SET);
+			m_stream->Read(blocks, static_cast<uint64>(count) * BLOCKSIZE);
+		}
+
 	private:
 		StreamPtr m_stream;
 		uint32 m_offset = 0;
+		std::mutex m_mutex;
 	};
 
 	class CBlockProviderCDROMXA : public CBlockProvider
@@ -52,10 +86,26 @@ namespace ISO9660
 
 		void ReadBlock(uint32 address, void* block) override
 		{
+			std::lock_guard<std::mutex> lock(m_mutex);
 			m_stream->Seek((static_cast<uint64>(address) * INTERNAL_BLOCKSIZE) + BLOCKHEADER_SIZE, Framework::STREAM_SEEK_SET);
 			m_stream->Read(block, BLOCKSIZE);
 		}
 
+		void ReadBlocks(uint32 address, uint32 count, void* blocks) override
+		{
+			//Read all raw sectors at once and strip headers/ECC data afterwards
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_rawBuffer.resize(static_cast<size_t>(count) * INTERNAL_BLOCKSIZE);
+			m_stream->Seek(static_cast<uint64>(address) * INTERNAL_BLOCKSIZE, Framework::STREAM_SEEK_SET);
+			m_stream->Read(m_rawBuffer.data(), m_rawBuffer.size());
+			auto output = reinterpret_cast<uint8*>(blocks);
+			for(uint32 i = 0; i < count; i++)
+			{
+				memcpy(output, m_rawBuffer.data() + (i * INTERNAL_BLOCKSIZE) + BLOCKHEADER_SIZE, BLOCKSIZE);
+				output += BLOCKSIZE;
+			}
+		}
+
 	private:
 		enum
 		{
@@ -64,5 +114,139 @@ namespace ISO9660
 		};
 
 		StreamPtr m_stream;
+		std::vector<uint8> m_rawBuffer;
+		std::mutex m_mutex;
+	};
+
+	class CBlockProviderMapped : public CBlockProvider
+	{
+	public:
+		typedef std::shared_ptr<CMappedFileStream> StreamPtr;
+
+		enum
+		{
+			RAW_BLOCKSIZE = 0x930ULL,
+			RAW_BLOCKHEADER_SIZE = 0x18ULL
+		};
+
+		CBlockProviderMapped(const StreamPtr& stream, uint32 internalBlockSize = BLOCKSIZE, uint32 blockHeaderSize = 0)
+		    : m_stream(stream)
+		    , m_internalBlockSize(internalBlockSize)
+		    , m_blockHeaderSize(blockHeaderSize)
+		{
+			m_blockCount = static_cast<uint32>(m_stream->GetSize() / m_internalBlockSize);
+		}
+
+		void ReadBlock(uint32 address, void* block) override
+		{
+			ReadBlocks(address, 1, block);
+		}
+
+		void ReadBlocks(uint32 address, uint32 count, void* blocks) override
+		{
+			UpdateAccessPattern(address, count);
+			auto output = reinterpret_cast<uint8*>(blocks);
+			uint64 inputOffset = static_cast<uint64>(address) * m_internalBlockSize;
+			if((m_internalBlockSize == BLOCKSIZE) && ((static_cast<uint64>(address) + count) <= m_blockCount))
+			{
+				memcpy(output, m_stream->GetData() + inputOffset, static_cast<size_t>(count) * BLOCKSIZE);
+				return;
+			}
+			//Truncated images are tolerated, data past the end of the file reads as zeroes
+			uint64 size = m_stream->GetSize();
+			for(uint32 i = 0; i < count; i++)
+			{
+				uint64 blockOffset = inputOffset + m_blockHeaderSize;
+				uint64 copySize = (blockOffset < size) ? std::min<uint64>(BLOCKSIZE, size - blockOffset) : 0;
+				if(copySize != 0)
+				{
+					memcpy(output, m_stream->GetData() + blockOffset, static_cast<size_t>(copySize));
+				}
+				memset(output + copySize, 0, static_cast<size_t>(BLOCKSIZE - copySize));
+				inputOffset += m_internalBlockSize;
+				output += BLOCKSIZE;
+			}
+		}
+
+		bool IsMemoryMapped() const override
+		{
+			return true;
+		}
+
+	private:
+		enum
+		{
+			SEQUENTIAL_THRESHOLD = 4,
+			READAHEAD_BLOCKS = 0x200,
+		};
+
+		//Hint the OS about upcoming reads when the game is reading sequentially
+		void UpdateAccessPattern(uint32 address, uint32 count)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if(address == m_nextAddress)
+			{
+				m_sequentialCount++;
+			}
+			else
+			{
+				m_sequentialCount = 0;
+				m_readAheadEnd = 0;
+			}
+			m_nextAddress = address + count;
+			if(m_sequentialCount < SEQUENTIAL_THRESHOLD) return;
+			if(m_nextAddress < m_readAheadEnd) return;
+			if(m_nextAddress >= m_blockCount) return;
+			uint32 readAheadCount = std::min<uint32>(READAHEAD_BLOCKS, m_blockCount - m_nextAddress);
+			if(readAheadCount == 0) return;
+			uint64 readAheadOffset = static_cast<uint64>(m_nextAddress) * m_internalBlockSize;
+			uint64 readAheadSize = static_cast<uint64>(readAheadCount) * m_internalBlockSize;
+			m_stream->Advise(readAheadOffset, readAheadSize, CMappedFileStream::ACCESS_HINT_SEQUENTIAL);
+			m_stream->Advise(readAheadOffset, readAheadSize, CMappedFileStream::ACCESS_HINT_WILLNEED);
+			m_readAheadEnd = m_nextAddress + (readAheadCount / 2);
+		}
+
+		StreamPtr m_stream;
+		uint32 m_internalBlockSize = BLOCKSIZE;
+		uint32 m_blockHeaderSize = 0;
+		uint32 m_blockCount = 0;
+
+		uint32 m_nextAddress = ~0U;
+		uint32 m_sequentialCount = 0;
+		uint32 m_readAheadEnd = 0;
+		std::mutex m_mutex;
+	};
+
+	//Exposes blocks of another provider starting at an offset (ie.: second layer of a DVD).
+	//Allows both layers to share the same provider and its lock.
+	class CBlockProviderOffset : public CBlockProvider
+	{
+	public:
+		typedef std::shared_ptr<CBlockProvider> BlockProviderPtr;
+
+		CBlockProviderOffset(const BlockProviderPtr& provider, uint32 offset)
+		    : m_provider(provider)
+		    , m_offset(offset)
+		{
+		}
+
+		void ReadBlock(uint32 address, void* block) override
+		{
+			m_provider->ReadBlock(address + m_offset, block);
+		}
+
+		void ReadBlocks(uint32 address, uint32 count, void* blocks) override
+		{
+			m_provider->ReadBlocks(address + m_offset, count, blocks);
+		}
+
+		bool IsMemoryMapped() const override
+		{
+			return m_provider->IsMemoryMapped();
+		}
+
+	private:
+		BlockProviderPtr m_provider;
+		uint32 m_offset = 0;
 	};
 }
@@ -1,4 +1,6 @@
 #include <string.h>
+#include <ctype.h>
+#include <algorithm>
 #include <limits.h>
 #include "ISO9660.h"
 #include "StdStream.h"
@@ -19,60 +21,239 @@ CISO9660::~CISO9660()
 {
 }
 
+const CISO9660::BlockProviderPtr& CISO9660::GetBlockProvider() const
+{
+	return m_blockProvider;
+}
+
 void CISO9660::ReadBlock(uint32 address, void* data)
 {
 	//The buffer is needed to make sure exception handlers
 	//are properly called as some system calls (ie.: ReadFile)
 	//won't generate an exception when trying to write to
 	//a write protected area
+	if(m_blockProvider->IsMemoryMapped())
+	{
+		m_blockProvider->ReadBlock(address, data);
+		return;
+	}
+	std::lock_guard<std::mutex> blockBufferLock(m_blockBufferMutex);
 	m_blockProvider->ReadBlock(address, m_blockBuffer);
 	memcpy(data, m_blockBuffer, CBlockProvider::BLOCKSIZE);
 }
 
+void CISO9660::ReadBlocks(uint32 address, uint32 count, void* data)
+{
+	//Same as ReadBlock, we go through our buffer, but we let the
+	//block provider fetch a whole batch of blocks in one go
+	if(m_blockProvider->IsMemoryMapped())
+	{
+		m_blockProvider->ReadBlocks(address, count, data);
+		return;
+	}
+	std::lock_guard<std::mutex> blockBufferLock(m_blockBufferMutex);
+	auto output = reinterpret_cast<uint8*>(data);
+	while(count != 0)
+	{
+		uint32 batchCount = std::min<uint32>(count, MAX_BATCH_BLOCKS);
+		uint32 batchSize = batchCount * CBlockProvider::BLOCKSIZE;
+		m_blockProvider->ReadBlocks(address, batchCount, m_blockBuffer);
+		memcpy(output, m_blockBuffer, batchSize);
+		address += batchCount;
+		count -= batchCount;
+		output += batchSize;
+	}
+}
+
 bool CISO9660::GetFileRecord(CDirectoryRecord* record, const char* filename)
+{
+	auto path = NormalizePath(filename);
+
+	std::lock_guard<std::mutex> indexLock(m_indexMutex);
+
+	//Only successful lookups are memoized, games probing for files that don't exist would fill the cache
+	const CDirectoryRecord* foundRecord = nullptr;
+	auto pathIterator = m_pathCacheIndex.find(path);
+	if(pathIterator != std::end(m_pathCacheIndex))
+	{
+		m_pathCache.splice(m_pathCache.begin(), m_pathCache, pathIterator->second);
+		foundRecord = m_pathCache.front().second;
+	}
+	else
+	{
+		foundRecord = FindFileRecord(path);
+		if(!foundRecord)
+		{
+			return false;
+		}
+		InsertPathCacheEntry(path, foundRecord);
+	}
+
+	(*record) = (*foundRecord);
+	return true;
+}
+
+bool CISO9660::GetDirectoryRecords(const char* path, DirectoryRecordList& records)
+{
+	auto directoryPath = NormalizePath(path);
+	if(!directoryPath.empty() && (directoryPath.back() != '/'))
+	{
+		directoryPath += '/';
+	}
+
+	std::lock_guard<std::mutex> indexLock(m_indexMutex);
+
+	uint32 address = 0;
+	if(!FindDirectoryAddress(directoryPath, address))
+	{
+		return false;
+	}
+
+	records = GetDirectory(address).records;
+	return true;
+}
+
+std::string CISO9660::NormalizePath(const char* path)
 {
 	//Remove the first '/'
-	if(filename[0] == '/' || filename[0] == '\\') filename++;
+	if(path[0] == '/' || path[0] == '\\') path++;
+
+	std::string result(path);
+	for(auto& pathChar : result)
+	{
+		if(pathChar == '\\')
+		{
+			pathChar = '/';
+		}
+		else
+		{
+			pathChar = toupper(pathChar);
+		}
+	}
+	return result;
+}
 
+bool CISO9660::FindDirectoryAddress(const std::string& path, uint32& address) const
+{
+	//Walks all the directories of a path (everything before the last '/')
 	unsigned int recordIndex = m_pathTable.FindRoot();
 
+	std::string::size_type componentStart = 0;
 	while(1)
 	{
-		//Find the next '/'
-		const char* next = strchr(filename, '/');
-		if(next == nullptr) break;
+		auto componentEnd = path.find('/', componentStart);
+		if(componentEnd == std::string::npos) break;
 
-		std::string dir(filename, next);
+		auto dir = path.substr(componentStart, componentEnd - componentStart);
 		recordIndex = m_pathTable.FindDirectory(dir.c_str(), recordIndex);
 		if(recordIndex == 0)
 		{
 			return false;
 		}
 
-		filename = next + 1;
+		componentStart = componentEnd + 1;
 	}
 
-	unsigned int address = m_pathTable.GetDirectoryAddress(recordIndex);
+	address = m_pathTable.GetDirectoryAddress(recordIndex);
+	return true;
+}
 
-	return GetFileRecordFromDirectory(record, address, filename);
+const CISO9660::DIRECTORY& CISO9660::GetDirectory(uint32 address)
+{
+	auto directoryIterator = m_directories.find(address);
+	if(directoryIterator != std::end(m_directories))
+	{
+		return *directoryIterator->second;
+	}
+
+	auto directory = std::make_unique<DIRECTORY>();
+	LoadDirectory(*directory, address);
+	return *m_directories.emplace(address, std::move(directory)).first->second;
 }
 
-bool CISO9660::GetFileRecordFromDirectory(CDirectoryRecord* record, uint32 address, const char* filename)
+void CISO9660::LoadDirectory(DIRECTORY& directory, uint32 address)
 {
-	CFile directory(m_blockProvider.get(), address * CBlockProvider::BLOCKSIZE);
+	CFile stream(m_blockProvider.get(), static_cast<uint64>(address) * CBlockProvider::BLOCKSIZE);
 
+	//The first record ('.') tells us how big the directory is
+	uint64 directorySize = CBlockProvider::BLOCKSIZE;
 	while(1)
 	{
-		CDirectoryRecord entry(&directory);
+		uint64 position = stream.Tell();
+		if(position >= directorySize) break;
+
+		CDirectoryRecord entry(&stream);
+		if(entry.GetLength() == 0)
+		{
+			//Records don't cross block boundaries, rest of the block is padding
+			uint64 nextBlockPosition = (position & ~static_cast<uint64>(CBlockProvider::BLOCKSIZE - 1)) + CBlockProvider::BLOCKSIZE;
+			if(nextBlockPosition >= directorySize) break;
+			stream.Seek(nextBlockPosition, Framework::STREAM_SEEK_SET);
+			continue;
+		}
+
+		if(directory.records.empty())
+		{
+			directorySize = std::max<uint64>(entry.GetDataLength(), CBlockProvider::BLOCKSIZE);
+		}
+
+		size_t recordIndex = directory.records.size();
+		directory.records.push_back(entry);
+
+		//Skip the '.' and '..' entries
+		const char* name = entry.GetName();
+		if((name[0] == 0x00) || (name[0] == 0x01)) continue;
+
+		//Index by full name and by name without version (ie.: ';1'), first one wins
+		std::string key(name);
+		std::transform(key.begin(), key.end(), key.begin(), ::toupper);
+		directory.recordIndices.emplace(key, recordIndex);
+		auto versionPos = key.find(';');
+		if(versionPos != std::string::npos)
+		{
+			directory.recordIndices.emplace(key.substr(0, versionPos), recordIndex);
+		}
+	}
+}
+
+const CDirectoryRecord* CISO9660::FindFileRecord(const std::string& path)
+{
+	uint32 address = 0;
+	if(!FindDirectoryAddress(path, address))
+	{
+		return nullptr;
+	}
 
-		if(entry.GetLength() == 0) break;
-		if(strnicmp(entry.GetName(), filename, strlen(filename))) continue;
+	auto namePos = path.rfind('/');
+	auto name = (namePos == std::string::npos) ? path : path.substr(namePos + 1);
 
-		(*record) = entry;
-		return true;
+	const auto& directory = GetDirectory(address);
+	auto recordIndexIterator = directory.recordIndices.find(name);
+	if(recordIndexIterator != std::end(directory.recordIndices))
+	{
+		return &directory.records[recordIndexIterator->second];
 	}
 
-	return false;
+	//Fallback on prefix matching for names that don't match exactly
+	for(const auto& record : directory.records)
+	{
+		if(strnicmp(record.GetName(), name.c_str(), name.size())) continue;
+		return &record;
+	}
+
+	return nullptr;
+}
+
+void CISO9660::InsertPathCacheEntry(const std::string& path, const CDirectoryRecord* record)
+{
+	//Records are owned by the directory index which is never trimmed, only the cache entries are evicted
+	m_pathCache.emplace_front(path, record);
+	m_pathCacheIndex[path] = m_pathCache.begin();
+	while(m_pathCache.size() > MAX_PATH_CACHE_ENTRIES)
+	{
+		m_pathCacheIndex.erase(m_pathCache.back().first);
+		m_pathCache.pop_back();
+	}
 }
 
 Framework::CStream* CISO9660::Open(const char* filename)
@@ -1,6 +1,11 @@
 #pragma once
 
+#include <list>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "BlockProvider.h"
 #include "VolumeDescriptor.h"
 #include "PathTable.h"
@@ -10,21 +15,59 @@ class CISO9660
 {
 public:
 	typedef std::shared_ptr<ISO9660::CBlockProvider> BlockProviderPtr;
+	typedef std::vector<ISO9660::CDirectoryRecord> DirectoryRecordList;
 
 	CISO9660(const BlockProviderPtr&);
 	~CISO9660();
 
+	const BlockProviderPtr& GetBlockProvider() const;
+
 	void ReadBlock(uint32, void*);
+	void ReadBlocks(uint32, uint32, void*);
 
 	Framework::CStream* Open(const char*);
 	bool GetFileRecord(ISO9660::CDirectoryRecord*, const char*);
+	bool GetDirectoryRecords(const char*, DirectoryRecordList&);
 
 private:
-	bool GetFileRecordFromDirectory(ISO9660::CDirectoryRecord*, uint32, const char*);
+	enum
+	{
+		MAX_BATCH_BLOCKS = 0x40,
+		MAX_PATH_CACHE_ENTRIES = 0x400,
+	};
+
+	//Contents of a directory, indexed by upper case name
+	struct DIRECTORY
+	{
+		typedef std::unordered_map<std::string, size_t> RecordIndexMap;
+
+		DirectoryRecordList records;
+		RecordIndexMap recordIndices;
+	};
+	typedef std::unique_ptr<DIRECTORY> DirectoryPtr;
+	typedef std::unordered_map<uint32, DirectoryPtr> DirectoryMap;
+	typedef std::list<std::pair<std::string, const ISO9660::CDirectoryRecord*>> PathCacheList;
+	typedef std::unordered_map<std::string, PathCacheList::iterator> PathCacheIndex;
+
+	static std::string NormalizePath(const char*);
+
+	bool FindDirectoryAddress(const std::string&, uint32&) const;
+	const DIRECTORY& GetDirectory(uint32);
+	void LoadDirectory(DIRECTORY&, uint32);
+	const ISO9660::CDirectoryRecord* FindFileRecord(const std::string&);
+	void InsertPathCacheEntry(const std::string&, const ISO9660::CDirectoryRecord*);
 
 	BlockProviderPtr m_blockProvider;
 	ISO9660::CVolumeDescriptor m_volumeDescriptor;
 	ISO9660::CPathTable m_pathTable;
 
-	uint8 m_blockBuffer[ISO9660::CBlockProvider::BLOCKSIZE];
+	std::mutex m_indexMutex;
+	DirectoryMap m_directories;
+
+	//Most recently found paths, front is the most recent
+	PathCacheList m_pathCache;
+	PathCacheIndex m_pathCacheIndex;
+
+	std::mutex m_blockBufferMutex;
+	uint8 m_blockBuffer[ISO9660::CBlockProvider::BLOCKSIZE * MAX_BATCH_BLOCKS];
 };
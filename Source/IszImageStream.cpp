@@ -39,6 +39,7 @@ CIszImageStream::~CIszImageStream()
 	delete[] m_cachedBlock;
 	delete[] m_readBuffer;
 	delete[] m_blockDescriptorTable;
+	delete[] m_blockOffsetTable;
 	delete m_baseStream;
 }
 
@@ -73,6 +74,18 @@ uint64 CIszImageStream::Read(void* buffer, uint64 size)
 		{
 			break;
 		}
+		uint64 blockNumber = m_position / m_header.blockSize;
+		if(((m_position % m_header.blockSize) == 0) && (size >= m_header.blockSize) &&
+		   (blockNumber != m_cachedBlockNumber) && ((GetTotalSize() - m_position) >= m_header.blockSize))
+		{
+			//Whole block requested, decode it straight into the output buffer
+			DecodeBlock(blockNumber, inputBuffer);
+			m_position += m_header.blockSize;
+			size -= m_header.blockSize;
+			inputBuffer += m_header.blockSize;
+			bytesRead += m_header.blockSize;
+			continue;
+		}
 		SyncCache();
 		uint64 blockPosition = (m_position % m_header.blockSize);
 		uint64 sizeLeft = m_header.blockSize - blockPosition;
@@ -109,12 +122,19 @@ void CIszImageStream::ReadBlockDescriptorTable()
 	}
 
 	m_blockDescriptorTable = new BLOCKDESCRIPTOR[m_header.blockNumber];
+	m_blockOffsetTable = new uint64[m_header.blockNumber];
+	uint64 blockOffset = m_header.dataOffset;
 	for(unsigned int i = 0; i < m_header.blockNumber; i++)
 	{
 		uint32 value = *reinterpret_cast<uint32*>(&cryptedTable[i * m_header.blockPtrLength]);
 		value &= 0xFFFFFF;
 		m_blockDescriptorTable[i].size = value & 0x3FFFFF;
 		m_blockDescriptorTable[i].storageType = static_cast<uint8>(value >> 22);
+		m_blockOffsetTable[i] = blockOffset;
+		if(m_blockDescriptorTable[i].storageType != ADI_ZERO)
+		{
+			blockOffset += m_blockDescriptorTable[i].size;
+		}
 	}
 
 	delete[] cryptedTable;
@@ -128,16 +148,7 @@ uint64 CIszImageStream::GetTotalSize() const
 const CIszImageStream::BLOCKDESCRIPTOR& CIszImageStream::SeekToBlock(uint64 blockNumber)
 {
 	assert(blockNumber < m_header.blockNumber);
-	uint64 seekPosition = m_header.dataOffset;
-	for(unsigned int i = 0; i < blockNumber; i++)
-	{
-		const BLOCKDESCRIPTOR& blockDescriptor = m_blockDescriptorTable[i];
-		if(blockDescriptor.storageType != ADI_ZERO)
-		{
-			seekPosition += blockDescriptor.size;
-		}
-	}
-	m_baseStream->Seek(seekPosition, Framework::STREAM_SEEK_SET);
+	m_baseStream->Seek(m_blockOffsetTable[blockNumber], Framework::STREAM_SEEK_SET);
 	return m_blockDescriptorTable[blockNumber];
 }
 
@@ -149,35 +160,40 @@ void CIszImageStream::SyncCache()
 	{
 		return;
 	}
-	if(neededBlock >= m_header.blockNumber)
+	DecodeBlock(neededBlock, m_cachedBlock);
+	m_cachedBlockNumber = neededBlock;
+}
+
+void CIszImageStream::DecodeBlock(uint64 blockNumber, uint8* output)
+{
+	if(blockNumber >= m_header.blockNumber)
 	{
 		throw std::runtime_error("Trying to read past eof.");
 	}
 
-	const BLOCKDESCRIPTOR& blockDescriptor = SeekToBlock(neededBlock);
-	memset(m_cachedBlock, 0, m_header.blockSize);
+	const BLOCKDESCRIPTOR& blockDescriptor = SeekToBlock(blockNumber);
+	memset(output, 0, m_header.blockSize);
 	switch(blockDescriptor.storageType)
 	{
 	case ADI_ZERO:
-		ReadZeroBlock(blockDescriptor.size);
+		ReadZeroBlock(blockDescriptor.size, output);
 		break;
 	case ADI_DATA:
-		ReadDataBlock(blockDescriptor.size);
+		ReadDataBlock(blockDescriptor.size, output);
 		break;
 	case ADI_ZLIB:
-		ReadGzipBlock(blockDescriptor.size);
+		ReadGzipBlock(blockDescriptor.size, output);
 		break;
 	case ADI_BZ2:
-		ReadBz2Block(blockDescriptor.size);
+		ReadBz2Block(blockDescriptor.size, output);
 		break;
 	default:
 		throw std::runtime_error("Unsupported block storage mode.");
 		break;
 	}
-	m_cachedBlockNumber = neededBlock;
 }
 
-void CIszImageStream::ReadZeroBlock(uint32 compressedBlockSize)
+void CIszImageStream::ReadZeroBlock(uint32 compressedBlockSize, uint8* output)
 {
 	if(compressedBlockSize != m_header.blockSize)
 	{
@@ -185,28 +201,28 @@ void CIszImageStream::ReadZeroBlock(uint32 compressedBlockSize)
 	}
 }
 
-void CIszImageStream::ReadDataBlock(uint32 compressedBlockSize)
+void CIszImageStream::ReadDataBlock(uint32 compressedBlockSize, uint8* output)
 {
 	if(compressedBlockSize != m_header.blockSize)
 	{
 		throw std::runtime_error("Invalid data block.");
 	}
-	m_baseStream->Read(m_cachedBlock, compressedBlockSize);
+	m_baseStream->Read(output, compressedBlockSize);
 }
 
-void CIszImageStream::ReadGzipBlock(uint32 compressedBlockSize)
+void CIszImageStream::ReadGzipBlock(uint32 compressedBlockSize, uint8* output)
 {
 	m_baseStream->Read(m_readBuffer, compressedBlockSize);
 	uLongf destLength = m_header.blockSize;
 	if(uncompress(
-	       reinterpret_cast<Bytef*>(m_cachedBlock), &destLength,
+	       reinterpret_cast<Bytef*>(output), &destLength,
 	       reinterpret_cast<Bytef*>(m_readBuffer), compressedBlockSize) != Z_OK)
 	{
 		throw std::runtime_error("Error decompressing zlib block.");
 	}
 }
 
-void CIszImageStream::ReadBz2Block(uint32 compressedBlockSize)
+void CIszImageStream::ReadBz2Block(uint32 compressedBlockSize, uint8* output)
 {
 	m_baseStream->Read(m_readBuffer, compressedBlockSize);
 	//Force BZ2 header
@@ -215,7 +231,7 @@ void CIszImageStream::ReadBz2Block(uint32 compressedBlockSize)
 	m_readBuffer[2] = 'h';
 	unsigned int destLength = m_header.blockSize;
 	if(BZ2_bzBuffToBuffDecompress(
-	       reinterpret_cast<char*>(m_cachedBlock), &destLength,
+	       reinterpret_cast<char*>(output), &destLength,
 	       reinterpret_cast<char*>(m_readBuffer), compressedBlockSize, 0, 0) != BZ_OK)
 	{
 		throw std::runtime_error("Error decompressing bz2 block.");
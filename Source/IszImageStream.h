@@ -72,15 +72,17 @@ private:
 	uint64 GetTotalSize() const;
 	const BLOCKDESCRIPTOR& SeekToBlock(uint64);
 	void SyncCache();
+	void DecodeBlock(uint64, uint8*);
 
-	void ReadZeroBlock(uint32);
-	void ReadDataBlock(uint32);
-	void ReadGzipBlock(uint32);
-	void ReadBz2Block(uint32);
+	void ReadZeroBlock(uint32, uint8*);
+	void ReadDataBlock(uint32, uint8*);
+	void ReadGzipBlock(uint32, uint8*);
+	void ReadBz2Block(uint32, uint8*);
 
 	Framework::CStream* m_baseStream = nullptr;
 	HEADER m_header;
 	BLOCKDESCRIPTOR* m_blockDescriptorTable = nullptr;
+	uint64* m_blockOffsetTable = nullptr;
 	int64 m_cachedBlockNumber = -1;
 	uint8* m_cachedBlock = nullptr;
 	uint8* m_readBuffer = nullptr;
@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <cstring>
+#include "LzBlockCodec.h"
+
+//Each sequence is: token (literal length:4, match length:4), extra literal length bytes,
+//literals, match offset (16 bits), extra match length bytes. Last sequence only has literals.
+
+#define HASH_BITS (12)
+#define MIN_MATCH (4)
+#define MAX_OFFSET (0xFFFF)
+#define LAST_LITERALS (5)
+#define LENGTH_MASK (0x0F)
+
+static uint32 Read32(const uint8* ptr)
+{
+	uint32 value = 0;
+	memcpy(&value, ptr, sizeof(uint32));
+	return value;
+}
+
+static uint32 Hash(uint32 sequence)
+{
+	return (sequence * 2654435761U) >> (32 - HASH_BITS);
+}
+
+static bool WriteLength(uint8*& output, const uint8* outputEnd, size_t length)
+{
+	while(length >= 0xFF)
+	{
+		if(output == outputEnd) return false;
+		*output++ = 0xFF;
+		length -= 0xFF;
+	}
+	if(output == outputEnd) return false;
+	*output++ = static_cast<uint8>(length);
+	return true;
+}
+
+static bool ReadLength(const uint8*& input, const uint8* inputEnd, size_t& length)
+{
+	while(1)
+	{
+		if(input == inputEnd) return false;
+		uint8 value = *input++;
+		length += value;
+		if(value != 0xFF) return true;
+	}
+}
+
+static bool WriteSequence(uint8*& output, const uint8* outputEnd, const uint8* literals, size_t literalLength, size_t offset, size_t matchLength)
+{
+	if(output == outputEnd) return false;
+	size_t matchLengthCode = (matchLength != 0) ? (matchLength - MIN_MATCH) : 0;
+	uint8* token = output++;
+	*token = static_cast<uint8>((std::min<size_t>(literalLength, LENGTH_MASK) << 4) | std::min<size_t>(matchLengthCode, LENGTH_MASK));
+	if((literalLength >= LENGTH_MASK) && !WriteLength(output, outputEnd, literalLength - LENGTH_MASK)) return false;
+	if(static_cast<size_t>(outputEnd - output) < literalLength) return false;
+	memcpy(output, literals, literalLength);
+	output += literalLength;
+	if(matchLength == 0) return true;
+	if((outputEnd - output) < 2) return false;
+	*output++ = static_cast<uint8>(offset);
+	*output++ = static_cast<uint8>(offset >> 8);
+	if((matchLengthCode >= LENGTH_MASK) && !WriteLength(output, outputEnd, matchLengthCode - LENGTH_MASK)) return false;
+	return true;
+}
+
+size_t LzBlockCodec::GetMaxCompressedSize(size_t inputSize)
+{
+	//Worst case is everything stored as literals
+	return inputSize + (inputSize / 0xFF) + 16;
+}
+
+size_t LzBlockCodec::Compress(const uint8* input, size_t inputSize, uint8* output, size_t outputSize)
+{
+	uint32 hashTable[1 << HASH_BITS];
+	memset(hashTable, 0, sizeof(hashTable));
+
+	const uint8* outputStart = output;
+	const uint8* outputEnd = output + outputSize;
+	size_t anchor = 0;
+	size_t position = 0;
+
+	if(inputSize > (MIN_MATCH + LAST_LITERALS))
+	{
+		size_t matchLimit = inputSize - LAST_LITERALS;
+		while((position + MIN_MATCH) <= matchLimit)
+		{
+			uint32 sequence = Read32(input + position);
+			uint32 hash = Hash(sequence);
+			size_t candidate = hashTable[hash];
+			hashTable[hash] = static_cast<uint32>(position);
+
+			if((candidate >= position) || ((position - candidate) > MAX_OFFSET) || (Read32(input + candidate) != sequence))
+			{
+				position++;
+				continue;
+			}
+
+			size_t matchLength = MIN_MATCH;
+			while(((position + matchLength) < matchLimit) && (input[candidate + matchLength] == input[position + matchLength]))
+			{
+				matchLength++;
+			}
+
+			if(!WriteSequence(output, outputEnd, input + anchor, position - anchor, position - candidate, matchLength)) return 0;
+			position += matchLength;
+			anchor = position;
+		}
+	}
+
+	if(!WriteSequence(output, outputEnd, input + anchor, inputSize - anchor, 0, 0)) return 0;
+	return output - outputStart;
+}
+
+bool LzBlockCodec::Decompress(const uint8* input, size_t inputSize, uint8* output, size_t outputSize)
+{
+	const uint8* inputEnd = input + inputSize;
+	uint8* outputStart = output;
+	uint8* outputEnd = output + outputSize;
+
+	while(input != inputEnd)
+	{
+		uint8 token = *input++;
+
+		size_t literalLength = token >> 4;
+		if((literalLength == LENGTH_MASK) && !ReadLength(input, inputEnd, literalLength)) return false;
+		if((static_cast<size_t>(inputEnd - input) < literalLength) || (static_cast<size_t>(outputEnd - output) < literalLength)) return false;
+		memcpy(output, input, literalLength);
+		input += literalLength;
+		output += literalLength;
+
+		//Last sequence doesn't have a match
+		if(input == inputEnd) break;
+
+		if((inputEnd - input) < 2) return false;
+		size_t offset = input[0] | (input[1] << 8);
+		input += 2;
+		size_t matchLength = token & LENGTH_MASK;
+		if((matchLength == LENGTH_MASK) && !ReadLength(input, inputEnd, matchLength)) return false;
+		matchLength += MIN_MATCH;
+
+		if((offset == 0) || (offset > static_cast<size_t>(output - outputStart))) return false;
+		if(static_cast<size_t>(outputEnd - output) < matchLength) return false;
+
+		const uint8* match = output - offset;
+		if(offset >= matchLength)
+		{
+			memcpy(output, match, matchLength);
+			output += matchLength;
+		}
+		else
+		{
+			//Overlapping copy (ie.: repeated pattern)
+			for(size_t i = 0; i < matchLength; i++)
+			{
+				*output++ = *match++;
+			}
+		}
+	}
+
+	return output == outputEnd;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include "Types.h"
+
+//Byte oriented LZ77 codec (same idea as LZ4's block format). Ratio is modest but it
+//is fast enough to compress and decompress memory snapshots while emulation runs.
+namespace LzBlockCodec
+{
+	size_t GetMaxCompressedSize(size_t);
+
+	//Returns the compressed size or 0 if the output buffer is too small
+	size_t Compress(const uint8*, size_t, uint8*, size_t);
+
+	//Returns false if input is malformed or doesn't decompress to the exact output size
+	bool Decompress(const uint8*, size_t, uint8*, size_t);
+}
@@ -0,0 +1,235 @@
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include "MappedFileStream.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#if defined(__linux__)
+#include <sys/vfs.h>
+#else
+#include <sys/param.h>
+#include <sys/mount.h>
+#endif
+#endif
+
+//Accessing a mapping fails with a fault (SIGBUS on POSIX) instead of an error when the file
+//can't be read anymore, which is more likely to happen with remote or removable volumes.
+#ifdef _WIN32
+static bool CanMapFileFromVolume(const fs::path& path)
+{
+	wchar_t volumePath[MAX_PATH + 1] = {};
+	if(!GetVolumePathNameW(path.native().c_str(), volumePath, MAX_PATH))
+	{
+		return false;
+	}
+	auto driveType = GetDriveTypeW(volumePath);
+	return (driveType != DRIVE_REMOTE) && (driveType != DRIVE_CDROM) && (driveType != DRIVE_UNKNOWN);
+}
+#elif defined(__linux__)
+static bool CanMapFileFromVolume(int fd)
+{
+	struct statfs fileSystemStat = {};
+	if(fstatfs(fd, &fileSystemStat) != 0)
+	{
+		return false;
+	}
+	switch(static_cast<uint32>(fileSystemStat.f_type))
+	{
+	case 0x6969:     //NFS
+	case 0x517B:     //SMB
+	case 0xFF534D42: //CIFS
+	case 0xFE534D42: //SMB2
+	case 0x65735546: //FUSE
+	case 0x01021997: //9P
+	case 0x9660:     //ISO9660
+	case 0x15013346: //UDF
+		return false;
+	default:
+		return true;
+	}
+}
+#else
+static bool CanMapFileFromVolume(int fd)
+{
+	struct statfs fileSystemStat = {};
+	if(fstatfs(fd, &fileSystemStat) != 0)
+	{
+		return false;
+	}
+	return (fileSystemStat.f_flags & MNT_LOCAL) != 0;
+}
+#endif
+
+CMappedFileStream::CMappedFileStream(const fs::path& path)
+{
+#ifdef _WIN32
+	if(!CanMapFileFromVolume(path))
+	{
+		throw std::runtime_error("File is not on a local volume.");
+	}
+	m_file = CreateFileW(path.native().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(m_file == INVALID_HANDLE_VALUE)
+	{
+		m_file = nullptr;
+		throw std::runtime_error("Failed to open file for mapping.");
+	}
+	LARGE_INTEGER fileSize = {};
+	if(!GetFileSizeEx(m_file, &fileSize))
+	{
+		CloseHandle(m_file);
+		throw std::runtime_error("Failed to obtain file size.");
+	}
+	m_size = fileSize.QuadPart;
+	if(m_size == 0)
+	{
+		CloseHandle(m_file);
+		throw std::runtime_error("Can't map empty file.");
+	}
+	m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if(m_mapping == nullptr)
+	{
+		CloseHandle(m_file);
+		throw std::runtime_error("Failed to create file mapping.");
+	}
+	m_data = reinterpret_cast<const uint8*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+	if(m_data == nullptr)
+	{
+		CloseHandle(m_mapping);
+		CloseHandle(m_file);
+		throw std::runtime_error("Failed to map file.");
+	}
+#else
+	m_fd = open(path.native().c_str(), O_RDONLY);
+	if(m_fd < 0)
+	{
+		throw std::runtime_error("Failed to open file for mapping.");
+	}
+	struct stat fileStat = {};
+	if(fstat(m_fd, &fileStat) != 0)
+	{
+		close(m_fd);
+		throw std::runtime_error("Failed to obtain file size.");
+	}
+	if(!S_ISREG(fileStat.st_mode))
+	{
+		close(m_fd);
+		throw std::runtime_error("Not a regular file.");
+	}
+	if(!CanMapFileFromVolume(m_fd))
+	{
+		close(m_fd);
+		throw std::runtime_error("File is not on a local volume.");
+	}
+	m_size = fileStat.st_size;
+	if(m_size == 0)
+	{
+		close(m_fd);
+		throw std::runtime_error("Can't map empty file.");
+	}
+	void* data = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, m_fd, 0);
+	if(data == MAP_FAILED)
+	{
+		close(m_fd);
+		throw std::runtime_error("Failed to map file.");
+	}
+	m_data = reinterpret_cast<const uint8*>(data);
+#endif
+}
+
+CMappedFileStream::~CMappedFileStream()
+{
+#ifdef _WIN32
+	UnmapViewOfFile(m_data);
+	CloseHandle(m_mapping);
+	CloseHandle(m_file);
+#else
+	munmap(const_cast<uint8*>(m_data), m_size);
+	close(m_fd);
+#endif
+}
+
+void CMappedFileStream::Seek(int64 position, Framework::STREAM_SEEK_DIRECTION origin)
+{
+	switch(origin)
+	{
+	case Framework::STREAM_SEEK_SET:
+		m_position = position;
+		break;
+	case Framework::STREAM_SEEK_CUR:
+		m_position += position;
+		break;
+	case Framework::STREAM_SEEK_END:
+		m_position = m_size + position;
+		break;
+	}
+}
+
+uint64 CMappedFileStream::Tell()
+{
+	return m_position;
+}
+
+uint64 CMappedFileStream::Read(void* buffer, uint64 size)
+{
+	if(m_position >= m_size) return 0;
+	uint64 readSize = std::min<uint64>(size, m_size - m_position);
+	memcpy(buffer, m_data + m_position, readSize);
+	m_position += readSize;
+	return readSize;
+}
+
+uint64 CMappedFileStream::Write(const void*, uint64)
+{
+	throw std::runtime_error("Not supported.");
+}
+
+bool CMappedFileStream::IsEOF()
+{
+	return (m_position >= m_size);
+}
+
+const uint8* CMappedFileStream::GetData() const
+{
+	return m_data;
+}
+
+uint64 CMappedFileStream::GetSize() const
+{
+	return m_size;
+}
+
+void CMappedFileStream::Advise(uint64 offset, uint64 size, ACCESS_HINT hint)
+{
+	if(offset >= m_size) return;
+	size = std::min<uint64>(size, m_size - offset);
+#ifdef _WIN32
+	//PrefetchVirtualMemory could be used here, but it's not available on all supported versions
+#else
+	//madvise requires a page aligned address
+	static const uint64 pageMask = ~static_cast<uint64>(sysconf(_SC_PAGESIZE) - 1);
+	uint64 alignedOffset = offset & pageMask;
+	size += (offset - alignedOffset);
+	int advice = MADV_NORMAL;
+	switch(hint)
+	{
+	case ACCESS_HINT_SEQUENTIAL:
+		advice = MADV_SEQUENTIAL;
+		break;
+	case ACCESS_HINT_WILLNEED:
+		advice = MADV_WILLNEED;
+		break;
+	default:
+		assert(hint == ACCESS_HINT_NORMAL);
+		break;
+	}
+	//Failure is not a problem, it's only a hint
+	madvise(const_cast<uint8*>(m_data + alignedOffset), size, advice);
+#endif
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Types.h"
+#include "Stream.h"
+#include "filesystem_def.h"
+
+//Read-only stream backed by a memory mapping of a whole file.
+//Allows block providers to copy sectors straight out of the mapping.
+class CMappedFileStream : public Framework::CStream
+{
+public:
+	enum ACCESS_HINT
+	{
+		ACCESS_HINT_NORMAL,
+		ACCESS_HINT_SEQUENTIAL,
+		ACCESS_HINT_WILLNEED,
+	};
+
+	CMappedFileStream(const fs::path&);
+	virtual ~CMappedFileStream();
+
+	void Seek(int64, Framework::STREAM_SEEK_DIRECTION) override;
+	uint64 Tell() override;
+	uint64 Read(void*, uint64) override;
+	uint64 Write(const void*, uint64) override;
+	bool IsEOF() override;
+
+	const uint8* GetData() const;
+	uint64 GetSize() const;
+
+	void Advise(uint64, uint64, ACCESS_HINT);
+
+private:
+	const uint8* m_data = nullptr;
+	uint64 m_size = 0;
+	uint64 m_position = 0;
+
+#ifdef _WIN32
+	void* m_file = nullptr;
+	void* m_mapping = nullptr;
+#else
+	int m_fd = -1;
+#endif
+};
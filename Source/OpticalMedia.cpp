@@ -4,20 +4,39 @@
 
 #define DVD_LAYER_MAX_BLOCKS 2295104
 
+static CISO9660::BlockProviderPtr CreateBlockProvider2048(const COpticalMedia::StreamPtr& stream)
+{
+	if(auto mappedStream = std::dynamic_pointer_cast<CMappedFileStream>(stream))
+	{
+		return std::make_shared<ISO9660::CBlockProviderMapped>(mappedStream);
+	}
+	return std::make_shared<ISO9660::CBlockProvider2048>(stream);
+}
+
+static CISO9660::BlockProviderPtr CreateBlockProviderCDROMXA(const COpticalMedia::StreamPtr& stream)
+{
+	if(auto mappedStream = std::dynamic_pointer_cast<CMappedFileStream>(stream))
+	{
+		return std::make_shared<ISO9660::CBlockProviderMapped>(mappedStream,
+		                                                       ISO9660::CBlockProviderMapped::RAW_BLOCKSIZE, ISO9660::CBlockProviderMapped::RAW_BLOCKHEADER_SIZE);
+	}
+	return std::make_shared<ISO9660::CBlockProviderCDROMXA>(stream);
+}
+
 COpticalMedia* COpticalMedia::CreateAuto(StreamPtr& stream)
 {
 	auto result = new COpticalMedia();
 	//Simulate a disk with only one data track
 	try
 	{
-		auto blockProvider = std::make_shared<ISO9660::CBlockProvider2048>(stream);
+		auto blockProvider = CreateBlockProvider2048(stream);
 		result->m_fileSystem = std::make_unique<CISO9660>(blockProvider);
 		result->m_track0DataType = TRACK_DATA_TYPE_MODE1_2048;
 	}
 	catch(...)
 	{
 		//Failed with block size 2048, try with CD-ROM XA
-		auto blockProvider = std::make_shared<ISO9660::CBlockProviderCDROMXA>(stream);
+		auto blockProvider = CreateBlockProviderCDROMXA(stream);
 		result->m_fileSystem = std::make_unique<CISO9660>(blockProvider);
 		result->m_track0DataType = TRACK_DATA_TYPE_MODE2_2352;
 	}
@@ -27,7 +46,7 @@ COpticalMedia* COpticalMedia::CreateAuto(StreamPtr& stream)
 		try
 		{
 			result->CheckDualLayerDvd(stream);
-			result->SetupSecondLayer(stream);
+			result->SetupSecondLayer();
 		}
 		catch(...)
 		{
@@ -40,12 +59,12 @@ COpticalMedia* COpticalMedia::CreateAuto(StreamPtr& stream)
 COpticalMedia* COpticalMedia::CreateDvd(StreamPtr& stream, bool isDualLayer, uint32 secondLayerStart)
 {
 	auto result = new COpticalMedia();
-	auto blockProvider = std::make_shared<ISO9660::CBlockProvider2048>(stream);
+	auto blockProvider = CreateBlockProvider2048(stream);
 	result->m_fileSystem = std::make_unique<CISO9660>(blockProvider);
 	result->m_track0DataType = TRACK_DATA_TYPE_MODE1_2048;
 	result->m_dvdIsDualLayer = isDualLayer;
 	result->m_dvdSecondLayerStart = secondLayerStart;
-	result->SetupSecondLayer(stream);
+	result->SetupSecondLayer();
 	return result;
 }
 
@@ -124,9 +143,10 @@ void COpticalMedia::CheckDualLayerDvd(const StreamPtr& stream)
 	assert(m_dvdSecondLayerStart != 0);
 }
 
-void COpticalMedia::SetupSecondLayer(const StreamPtr& stream)
+void COpticalMedia::SetupSecondLayer()
 {
 	if(!m_dvdIsDualLayer) return;
-	auto blockProvider = std::make_shared<ISO9660::CBlockProvider2048>(stream, GetDvdSecondLayerStart());
+	//Share the first layer's block provider to make sure accesses to the stream are serialized
+	auto blockProvider = std::make_shared<ISO9660::CBlockProviderOffset>(m_fileSystem->GetBlockProvider(), GetDvdSecondLayerStart());
 	m_fileSystemL1 = std::make_unique<CISO9660>(blockProvider);
 }
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <exception>
 #include <memory>
+#include <algorithm>
 #include <fenv.h>
 #include "make_unique.h"
 #include "string_format.h"
@@ -14,6 +15,7 @@
 #include "StdStreamUtils.h"
 #include "GZipStream.h"
 #include "states/MemoryStateFile.h"
+#include "states/ParallelStateReader.h"
 #include "zip/ZipArchiveWriter.h"
 #include "zip/ZipArchiveReader.h"
 #include "xml/Node.h"
@@ -38,6 +40,8 @@
 #define ONSCREEN_TICKS (FRAME_TICKS * 9 / 10)
 #define VBLANK_TICKS (FRAME_TICKS / 10)
 
+#define STATE_THREAD_COUNT_MAX 4
+
 CPS2VM::CPS2VM()
     : m_nStatus(PAUSED)
     , m_nEnd(false)
@@ -82,14 +86,34 @@ CPS2VM::CPS2VM()
 
 	CAppConfig::GetInstance().RegisterPreferencePath(PREF_PS2_CDROM0_PATH, "");
 
+	m_hostDevice = std::make_shared<Iop::Ioman::CDirectoryDevice>(PREF_PS2_HOST_DIRECTORY);
+	//McServ modifies, deletes and renames memory card files directly, files can't be kept opened
+	m_mc0Device = std::make_shared<Iop::Ioman::CDirectoryDevice>(PREF_PS2_MC0_DIRECTORY, false);
+	m_mc1Device = std::make_shared<Iop::Ioman::CDirectoryDevice>(PREF_PS2_MC1_DIRECTORY, false);
+
 	Framework::PathUtils::EnsurePathExists(GetStateDirectoryPath());
 
 	m_iop = std::make_unique<Iop::CSubSystem>(true);
 	auto iopOs = dynamic_cast<CIopBios*>(m_iop->m_bios.get());
 
 	m_ee = std::make_unique<Ee::CSubSystem>(m_iop->m_ram, *iopOs);
+
 	m_OnRequestLoadExecutableConnection = m_ee->m_os->OnRequestLoadExecutable.Connect(std::bind(&CPS2VM::ReloadExecutable, this, std::placeholders::_1, std::placeholders::_2));
 
+	{
+		//EE RAM writes are tracked using the executor's write protection, saves us from scanning it entirely
+		auto eeExecutor = static_cast<CEeExecutor*>(m_ee->m_EE.m_executor.get());
+		auto pageSize = static_cast<uint32>(eeExecutor->GetPageSize());
+		m_stateDeltaTracker.SetDirtyPageQuery(m_ee->m_ram, pageSize,
+		                                      [eeExecutor](CMemoryStateTracker::PageBitmap& dirtyPages) { return eeExecutor->CollectDirtyPages(EE_DIRTY_PAGE_TRACKER_STATEDELTA, dirtyPages); });
+		m_rewindBuffer.SetDirtyPageQuery(m_ee->m_ram, pageSize,
+		                                 [eeExecutor](CMemoryStateTracker::PageBitmap& dirtyPages) { return eeExecutor->CollectDirtyPages(EE_DIRTY_PAGE_TRACKER_REWIND, dirtyPages); });
+		m_ee->m_gifReplayCache.SetDirtyPageTracker(eeExecutor, EE_DIRTY_PAGE_TRACKER_GIFREPLAY);
+	}
+
+	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_PS2_GIFREPLAYCACHE_ENABLED, false);
+	m_ee->m_gifReplayCache.SetEnabled(CAppConfig::GetInstance().GetPreferenceBoolean(PREF_PS2_GIFREPLAYCACHE_ENABLED));
+
 	CAppConfig::GetInstance().RegisterPreferenceInteger(PREF_AUDIO_SPUBLOCKCOUNT, 100);
 	m_spuBlockCount = CAppConfig::GetInstance().GetPreferenceInteger(PREF_AUDIO_SPUBLOCKCOUNT);
 }
@@ -234,6 +258,7 @@ void CPS2VM::Destroy()
 {
 	m_mailBox.SendCall(std::bind(&CPS2VM::DestroyImpl, this));
 	m_thread.join();
+	WaitForStateWrite();
 	DestroyVM();
 }
 
@@ -242,6 +267,13 @@ fs::path CPS2VM::GetStateDirectoryPath()
 	return CAppConfig::GetBasePath() / fs::path("states/");
 }
 
+//Shared by every VM, a few threads are enough to compress states faster than they are written
+Framework::CThreadPool& CPS2VM::GetStateThreadPool()
+{
+	static Framework::CThreadPool threadPool(std::min<unsigned int>(std::max<unsigned int>(std::thread::hardware_concurrency(), 1), STATE_THREAD_COUNT_MAX));
+	return threadPool;
+}
+
 fs::path CPS2VM::GenerateStatePath(unsigned int slot) const
 {
 	auto stateFileName = string_format("%s.st%d.zip", m_ee->m_os->GetExecutableName(), slot);
@@ -254,8 +286,25 @@ std::future<bool> CPS2VM::SaveState(const fs::path& statePath)
 	auto future = promise->get_future();
 	m_mailBox.SendCall(
 	    [this, promise, statePath]() {
-		    auto result = SaveVMState(statePath);
-		    promise->set_value(result);
+		    auto stateWriter = SaveVMState();
+		    if(!stateWriter)
+		    {
+			    promise->set_value(false);
+			    return;
+		    }
+		    //Compression and disk writes are done while the machine keeps running.
+		    //Waiting for a previous write is also done there to avoid stalling this thread.
+		    auto previousStateWrite = m_stateWriteFuture;
+		    auto stateWrite = std::async(std::launch::async,
+		                                 [previousStateWrite, stateWriter, promise, statePath]() {
+			                                 if(previousStateWrite.valid())
+			                                 {
+				                                 previousStateWrite.wait();
+			                                 }
+			                                 auto result = WriteVMState(*stateWriter, statePath);
+			                                 promise->set_value(result);
+		                                 });
+		    m_stateWriteFuture = stateWrite.share();
 	    });
 	return future;
 }
@@ -272,6 +321,60 @@ std::future<bool> CPS2VM::LoadState(const fs::path& statePath)
 	return future;
 }
 
+std::future<bool> CPS2VM::SaveIncrementalState(const fs::path& statePath)
+{
+	auto promise = std::make_shared<std::promise<bool>>();
+	auto future = promise->get_future();
+	m_mailBox.SendCall(
+	    [this, promise, statePath]() {
+		    auto result = SaveVMIncrementalState(statePath);
+		    promise->set_value(result);
+	    });
+	return future;
+}
+
+void CPS2VM::SetRewindParams(unsigned int frameInterval, unsigned int capacity)
+{
+	m_mailBox.SendCall(
+	    [this, frameInterval, capacity]() {
+		    m_rewindFrameInterval = frameInterval;
+		    m_rewindFrameCounter = 0;
+		    m_rewindCapturePending = false;
+		    m_rewindBuffer.SetCapacity(std::max<unsigned int>(capacity, 1));
+		    if(frameInterval == 0)
+		    {
+			    m_rewindBuffer.Clear();
+		    }
+	    });
+}
+
+unsigned int CPS2VM::GetRewindEntryCount() const
+{
+	return m_rewindBuffer.GetEntryCount();
+}
+
+uint32 CPS2VM::GetRewindEntryFrame(unsigned int index) const
+{
+	return m_rewindBuffer.GetEntryFrame(index);
+}
+
+CRewindBuffer::STATS CPS2VM::GetRewindStats() const
+{
+	return m_rewindBuffer.GetStats();
+}
+
+std::future<bool> CPS2VM::RestoreRewindEntry(unsigned int index)
+{
+	auto promise = std::make_shared<std::promise<bool>>();
+	auto future = promise->get_future();
+	m_mailBox.SendCall(
+	    [this, promise, index]() {
+		    auto result = RestoreVMRewindEntry(index);
+		    promise->set_value(result);
+	    });
+	return future;
+}
+
 void CPS2VM::TriggerFrameDump(const FrameDumpCallback& frameDumpCallback)
 {
 	m_mailBox.SendCall(
@@ -288,6 +391,49 @@ CPS2VM::CPU_UTILISATION_INFO CPS2VM::GetCpuUtilisationInfo() const
 	return m_cpuUtilisation;
 }
 
+uint64 CPS2VM::GetEeCycleCount() const
+{
+	return m_eeCycleCount;
+}
+
+uint64 CPS2VM::GetIopCycleCount() const
+{
+	return m_iopCycleCount;
+}
+
+CSIF::STATS CPS2VM::GetSifStats() const
+{
+	return m_ee->m_sif.GetFrameStats();
+}
+
+CGifReplayCache::STATS CPS2VM::GetGifReplayStats() const
+{
+	return m_ee->m_gifReplayCache.GetFrameStats();
+}
+
+Iop::Ioman::CHostFileCache::STATS CPS2VM::GetHostFileStats() const
+{
+	Iop::Ioman::CHostFileCache::STATS result;
+	for(const auto& device : {m_hostDevice, m_mc0Device, m_mc1Device})
+	{
+		auto stats = device->GetFrameStats();
+		result.openCount += stats.openCount;
+		result.handleCacheHitCount += stats.handleCacheHitCount;
+		result.readCount += stats.readCount;
+		result.hostReadCount += stats.hostReadCount;
+		result.seekCount += stats.seekCount;
+		result.hostSeekCount += stats.hostSeekCount;
+		result.hostStatCount += stats.hostStatCount;
+	}
+	return result;
+}
+
+Iop::CCdvdStreamPrefetcher::STATS CPS2VM::GetCdvdStreamStats()
+{
+	std::lock_guard<std::mutex> frameStatsLock(m_cdvdStreamFrameStatsMutex);
+	return m_cdvdStreamFrameStats;
+}
+
 #ifdef DEBUGGER_INCLUDED
 
 #define TAGS_SECTION_TAGS ("tags")
@@ -391,9 +537,9 @@ void CPS2VM::ResetVM()
 
 		iopOs->Reset(std::make_shared<Iop::CSifManPs2>(m_ee->m_sif, m_ee->m_ram, m_iop->m_ram));
 
-		iopOs->GetIoman()->RegisterDevice("host", Iop::CIoman::DevicePtr(new Iop::Ioman::CDirectoryDevice(PREF_PS2_HOST_DIRECTORY)));
-		iopOs->GetIoman()->RegisterDevice("mc0", Iop::CIoman::DevicePtr(new Iop::Ioman::CDirectoryDevice(PREF_PS2_MC0_DIRECTORY)));
-		iopOs->GetIoman()->RegisterDevice("mc1", Iop::CIoman::DevicePtr(new Iop::Ioman::CDirectoryDevice(PREF_PS2_MC1_DIRECTORY)));
+		iopOs->GetIoman()->RegisterDevice("host", m_hostDevice);
+		iopOs->GetIoman()->RegisterDevice("mc0", m_mc0Device);
+		iopOs->GetIoman()->RegisterDevice("mc1", m_mc1Device);
 		iopOs->GetIoman()->RegisterDevice("cdrom", Iop::CIoman::DevicePtr(new Iop::Ioman::COpticalMediaDevice(m_cdrom0)));
 		iopOs->GetIoman()->RegisterDevice("cdrom0", Iop::CIoman::DevicePtr(new Iop::Ioman::COpticalMediaDevice(m_cdrom0)));
 
@@ -407,10 +553,19 @@ void CPS2VM::ResetVM()
 
 	m_eeExecutionTicks = 0;
 	m_iopExecutionTicks = 0;
+	m_eeCycleCount = 0;
+	m_iopCycleCount = 0;
 
 	m_spuUpdateTicks = SPU_UPDATE_TICKS;
 	m_currentSpuBlock = 0;
 
+	m_stateDeltaTracker.Reset();
+
+	m_rewindBuffer.Clear();
+	m_rewindFrameCounter = 0;
+	m_rewindFrameNumber = 0;
+	m_rewindCapturePending = false;
+
 	RegisterModulesInPadHandler();
 }
 
@@ -419,24 +574,39 @@ void CPS2VM::DestroyVM()
 	CDROM0_Reset();
 }
 
-bool CPS2VM::SaveVMState(const fs::path& statePath)
+std::shared_ptr<CParallelStateWriter> CPS2VM::SaveVMState()
 {
 	if(m_ee->m_gs == NULL)
 	{
 		printf("PS2VM: GS Handler was not instancied. Cannot save state.\r\n");
-		return false;
+		return nullptr;
 	}
 
 	try
 	{
-		auto stateStream = Framework::CreateOutputStdStream(statePath.native());
+		//Only copies memory regions, compression is done later by WriteVMState
+		auto stateWriter = std::make_shared<CParallelStateWriter>(GetStateThreadPool());
 		Framework::CZipArchiveWriter archive;
 
-		m_ee->SaveState(archive);
-		m_iop->SaveState(archive);
-		m_ee->m_gs->SaveState(archive);
+		m_ee->SaveState(archive, stateWriter.get());
+		m_iop->SaveState(archive, stateWriter.get());
+		m_ee->m_gs->SaveState(archive, stateWriter.get());
 
-		archive.Write(stateStream);
+		stateWriter->CaptureArchive(archive);
+		return stateWriter;
+	}
+	catch(...)
+	{
+		return nullptr;
+	}
+}
+
+bool CPS2VM::WriteVMState(CParallelStateWriter& stateWriter, const fs::path& statePath)
+{
+	try
+	{
+		auto stateStream = Framework::CreateOutputStdStream(statePath.native());
+		stateWriter.Write(stateStream);
 	}
 	catch(...)
 	{
@@ -446,6 +616,14 @@ bool CPS2VM::SaveVMState(const fs::path& statePath)
 	return true;
 }
 
+void CPS2VM::WaitForStateWrite()
+{
+	if(m_stateWriteFuture.valid())
+	{
+		m_stateWriteFuture.wait();
+	}
+}
+
 bool CPS2VM::LoadVMState(const fs::path& statePath)
 {
 	if(m_ee->m_gs == NULL)
@@ -454,16 +632,22 @@ bool CPS2VM::LoadVMState(const fs::path& statePath)
 		return false;
 	}
 
+	//State might still be being written
+	WaitForStateWrite();
+
 	try
 	{
 		auto stateStream = Framework::CreateInputStdStream(statePath.native());
+
+		//Starts inflating large memory regions in the background
+		CParallelStateReader stateReader(stateStream, GetStateThreadPool());
 		Framework::CZipArchiveReader archive(stateStream);
 
 		try
 		{
-			m_ee->LoadState(archive);
-			m_iop->LoadState(archive);
-			m_ee->m_gs->LoadState(archive);
+			m_ee->LoadState(archive, &stateReader);
+			m_iop->LoadState(archive, &stateReader);
+			m_ee->m_gs->LoadState(archive, &stateReader);
 		}
 		catch(...)
 		{
@@ -477,6 +661,109 @@ bool CPS2VM::LoadVMState(const fs::path& statePath)
 		return false;
 	}
 
+	//Machine state doesn't follow the previous checkpoints anymore
+	m_stateDeltaTracker.Reset();
+
+	OnMachineStateChange();
+
+	return true;
+}
+
+bool CPS2VM::SaveVMIncrementalState(const fs::path& statePath)
+{
+	if(m_ee->m_gs == NULL)
+	{
+		printf("PS2VM: GS Handler was not instancied. Cannot save state.\r\n");
+		return false;
+	}
+
+	try
+	{
+		auto stateStream = Framework::CreateOutputStdStream(statePath.native());
+		Framework::CZipArchiveWriter archive;
+
+		//First state of a chain is a complete state, following ones only contain memory pages
+		//modified since the previous one. Use CStateDeltaTracker::MaterializeChain to get a full state back.
+		m_stateDeltaTracker.BeginCheckpoint(archive);
+
+		m_ee->SaveState(archive, &m_stateDeltaTracker);
+		m_iop->SaveState(archive, &m_stateDeltaTracker);
+		m_ee->m_gs->SaveState(archive, &m_stateDeltaTracker);
+
+		archive.Write(stateStream);
+	}
+	catch(...)
+	{
+		//Chain is broken, next state will start a new one
+		m_stateDeltaTracker.Reset();
+		return false;
+	}
+
+	return true;
+}
+
+void CPS2VM::CaptureRewindEntry()
+{
+	if(m_ee->m_gs == NULL) return;
+
+	try
+	{
+		//Large memory regions are kept as shared pages by the rewind buffer, only
+		//the remaining (small) state files go through the archive
+		Framework::CZipArchiveWriter archive;
+		m_rewindBuffer.BeginCapture(m_rewindFrameNumber);
+
+		m_ee->SaveState(archive, &m_rewindBuffer);
+		m_iop->SaveState(archive, &m_rewindBuffer);
+		m_ee->m_gs->SaveState(archive, &m_rewindBuffer);
+
+		m_rewindBuffer.EndCapture(archive);
+	}
+	catch(const std::exception& exception)
+	{
+		CLog::GetInstance().Warn(LOG_NAME, "Failed to capture rewind entry: %s\r\n", exception.what());
+		m_rewindBuffer.Clear();
+	}
+}
+
+bool CPS2VM::RestoreVMRewindEntry(unsigned int index)
+{
+	if(m_ee->m_gs == NULL)
+	{
+		printf("PS2VM: GS Handler was not instancied. Cannot load state.\r\n");
+		return false;
+	}
+
+	try
+	{
+		auto stateStream = m_rewindBuffer.BeginRestore(index);
+		Framework::CZipArchiveReader archive(*stateStream);
+
+		try
+		{
+			m_ee->LoadState(archive, &m_rewindBuffer);
+			m_iop->LoadState(archive, &m_rewindBuffer);
+			m_ee->m_gs->LoadState(archive, &m_rewindBuffer);
+		}
+		catch(...)
+		{
+			//Any error that occurs in the previous block is critical
+			PauseImpl();
+			throw;
+		}
+
+		m_rewindBuffer.EndRestore();
+		m_rewindFrameNumber = m_rewindBuffer.GetEntryFrame(index);
+		m_rewindFrameCounter = 0;
+	}
+	catch(...)
+	{
+		return false;
+	}
+
+	//Machine state doesn't follow the previous checkpoints anymore
+	m_stateDeltaTracker.Reset();
+
 	OnMachineStateChange();
 
 	return true;
@@ -593,6 +880,7 @@ void CPS2VM::UpdateEe()
 		m_ee->m_vpu1->Execute(m_singleStepVu1 ? 1 : executed);
 
 		m_eeExecutionTicks -= executed;
+		m_eeCycleCount += executed;
 		m_ee->CountTicks(executed);
 		m_vblankTicks -= executed;
 
@@ -624,6 +912,7 @@ void CPS2VM::UpdateIop()
 #endif
 
 		m_iopExecutionTicks -= executed;
+		m_iopCycleCount += executed;
 		m_spuUpdateTicks -= executed;
 		m_iop->CountTicks(executed);
 
@@ -732,7 +1021,7 @@ void CPS2VM::ReloadExecutable(const char* executablePath, const CPS2OS::Argument
 void CPS2VM::EmuThread()
 {
 	fesetround(FE_TOWARDZERO);
-	CProfiler::GetInstance().SetWorkThread();
+	CProfiler::GetInstance().SetThreadName("Emulator");
 #ifdef PROFILE
 	CProfilerZone profilerZone(m_otherProfilerZone);
 #endif
@@ -744,6 +1033,12 @@ void CPS2VM::EmuThread()
 			m_mailBox.ReceiveCall();
 		}
 		if(m_nEnd) break;
+		if(m_rewindCapturePending && (m_nStatus == RUNNING))
+		{
+			//Done here so that state isn't captured in the middle of a mailbox call
+			m_rewindCapturePending = false;
+			CaptureRewindEntry();
+		}
 		if(m_nStatus == PAUSED)
 		{
 			std::this_thread::sleep_for(std::chrono::milliseconds(100));
@@ -767,6 +1062,23 @@ void CPS2VM::EmuThread()
 						m_vblankTicks += VBLANK_TICKS;
 						m_ee->NotifyVBlankStart();
 						m_iop->NotifyVBlankStart();
+						m_hostDevice->EndFrame();
+						m_mc0Device->EndFrame();
+						m_mc1Device->EndFrame();
+						{
+							auto iopBios = static_cast<CIopBios*>(m_iop->m_bios.get());
+							auto& streamPrefetcher = iopBios->GetCdvdman()->GetStreamPrefetcher();
+							std::lock_guard<std::mutex> frameStatsLock(m_cdvdStreamFrameStatsMutex);
+							m_cdvdStreamFrameStats = streamPrefetcher.GetStats();
+							streamPrefetcher.ResetStats();
+						}
+
+						m_rewindFrameNumber++;
+						if((m_rewindFrameInterval != 0) && (++m_rewindFrameCounter >= m_rewindFrameInterval))
+						{
+							m_rewindFrameCounter = 0;
+							m_rewindCapturePending = true;
+						}
 
 						if(m_ee->m_gs != NULL)
 						{
@@ -786,6 +1098,7 @@ void CPS2VM::EmuThread()
 							auto stats = CProfiler::GetInstance().GetStats();
 							ProfileFrameDone(stats);
 							CProfiler::GetInstance().Reset();
+							CProfiler::GetInstance().EndFrame();
 						}
 
 						m_cpuUtilisation = CPU_UTILISATION_INFO();
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <thread>
 #include <future>
 #include "filesystem_def.h"
@@ -12,8 +13,14 @@
 #include "VirtualMachine.h"
 #include "ee/Ee_SubSystem.h"
 #include "iop/Iop_SubSystem.h"
+#include "iop/DirectoryDevice.h"
+#include "iop/CdvdStreamPrefetcher.h"
 #include "../tools/PsfPlayer/Source/SoundHandler.h"
 #include "FrameDump.h"
+#include "states/StateDeltaTracker.h"
+#include "RewindBuffer.h"
+#include "states/ParallelStateWriter.h"
+#include "ThreadPool.h"
 #include "Profiler.h"
 
 class CPS2VM : public CVirtualMachine
@@ -70,10 +77,25 @@ public:
 
 	std::future<bool> SaveState(const fs::path&);
 	std::future<bool> LoadState(const fs::path&);
+	std::future<bool> SaveIncrementalState(const fs::path&);
+
+	//Captures a state in memory every 'frameInterval' frames (0 disables rewind)
+	void SetRewindParams(unsigned int frameInterval, unsigned int capacity);
+	unsigned int GetRewindEntryCount() const;
+	uint32 GetRewindEntryFrame(unsigned int) const;
+	CRewindBuffer::STATS GetRewindStats() const;
+	std::future<bool> RestoreRewindEntry(unsigned int);
 
 	void TriggerFrameDump(const FrameDumpCallback&);
 
 	CPU_UTILISATION_INFO GetCpuUtilisationInfo() const;
+	//Amount of cycles executed since the last reset, can be called while the VM is running
+	uint64 GetEeCycleCount() const;
+	uint64 GetIopCycleCount() const;
+	CSIF::STATS GetSifStats() const;
+	CGifReplayCache::STATS GetGifReplayStats() const;
+	Iop::Ioman::CHostFileCache::STATS GetHostFileStats() const;
+	Iop::CCdvdStreamPrefetcher::STATS GetCdvdStreamStats();
 
 #ifdef DEBUGGER_INCLUDED
 	std::string MakeDebugTagsPackagePath(const char*);
@@ -90,12 +112,19 @@ public:
 
 private:
 	typedef std::unique_ptr<COpticalMedia> OpticalMediaPtr;
+	typedef std::shared_ptr<Iop::Ioman::CDirectoryDevice> DirectoryDevicePtr;
 
 	void CreateVM();
 	void ResetVM();
 	void DestroyVM();
-	bool SaveVMState(const fs::path&);
+	std::shared_ptr<CParallelStateWriter> SaveVMState();
+	static bool WriteVMState(CParallelStateWriter&, const fs::path&);
+	static Framework::CThreadPool& GetStateThreadPool();
+	void WaitForStateWrite();
 	bool LoadVMState(const fs::path&);
+	bool SaveVMIncrementalState(const fs::path&);
+	void CaptureRewindEntry();
+	bool RestoreVMRewindEntry(unsigned int);
 
 	void ReloadExecutable(const char*, const CPS2OS::ArgumentList&);
 
@@ -138,6 +167,8 @@ private:
 	int m_iopExecutionTicks = 0;
 
 	CPU_UTILISATION_INFO m_cpuUtilisation;
+	std::atomic<uint64> m_eeCycleCount = {0};
+	std::atomic<uint64> m_iopCycleCount = {0};
 
 	bool m_singleStepEe;
 	bool m_singleStepIop;
@@ -151,6 +182,34 @@ private:
 
 	OpticalMediaPtr m_cdrom0;
 
+	//Directory devices are kept across resets to collect host file access statistics
+	DirectoryDevicePtr m_hostDevice;
+	DirectoryDevicePtr m_mc0Device;
+	DirectoryDevicePtr m_mc1Device;
+
+	//CDVD module is recreated on reset, its stream stats are collected at every frame
+	Iop::CCdvdStreamPrefetcher::STATS m_cdvdStreamFrameStats;
+	std::mutex m_cdvdStreamFrameStatsMutex;
+
+	//Writing states happens in the background, each write waits for the previous one
+	std::shared_future<void> m_stateWriteFuture;
+
+	CStateDeltaTracker m_stateDeltaTracker;
+
+	//Each consumer of EE RAM modifications needs its own tracker in the executor
+	enum
+	{
+		EE_DIRTY_PAGE_TRACKER_STATEDELTA,
+		EE_DIRTY_PAGE_TRACKER_REWIND,
+		EE_DIRTY_PAGE_TRACKER_GIFREPLAY,
+	};
+
+	CRewindBuffer m_rewindBuffer;
+	unsigned int m_rewindFrameInterval = 0;
+	unsigned int m_rewindFrameCounter = 0;
+	uint32 m_rewindFrameNumber = 0;
+	bool m_rewindCapturePending = false;
+
 	//SPU update parameters
 	enum
 	{
@@ -6,4 +6,6 @@
 #define PREF_PS2_MC0_DIRECTORY ("ps2.mc0.directory.v2")
 #define PREF_PS2_MC1_DIRECTORY ("ps2.mc1.directory.v2")
 
+#define PREF_PS2_GIFREPLAYCACHE_ENABLED ("ps2.gifreplaycache.enabled")
+
 #define PREF_AUDIO_SPUBLOCKCOUNT ("audio.spublockcount")
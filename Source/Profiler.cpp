@@ -1,8 +1,49 @@
 #include "Profiler.h"
 
 #include <cassert>
+#include <algorithm>
+#include "string_format.h"
+
+#define CHROME_TRACE_PROCESS_ID 1
+#define CHROME_TRACE_FRAMES_THREAD_ID 0
+#define CHROME_TRACE_FLUSH_SIZE 0x10000
+
+static std::string EscapeJsonString(const std::string& input)
+{
+	std::string result;
+	for(auto character : input)
+	{
+		switch(character)
+		{
+		case '"':
+			result += "\\\"";
+			break;
+		case '\\':
+			result += "\\\\";
+			break;
+		default:
+			if(static_cast<unsigned char>(character) < 0x20)
+			{
+				result += string_format("\\u%04x", character);
+			}
+			else
+			{
+				result += character;
+			}
+			break;
+		}
+	}
+	return result;
+}
+
+static double GetTraceTime(const CProfiler::TimePoint& time, const CProfiler::TimePoint& baseTime)
+{
+	auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(time - baseTime);
+	return static_cast<double>(duration.count()) / 1000.0;
+}
 
 CProfiler::CProfiler()
+    : m_capturing(false)
 {
 }
 
@@ -13,88 +54,264 @@ CProfiler::~CProfiler()
 CProfiler::ZoneHandle CProfiler::RegisterZone(const char* name)
 {
 #ifdef PROFILE
-	for(unsigned int i = 0; i < m_zones.size(); i++)
+	std::lock_guard<std::mutex> profilerLock(m_mutex);
+	for(unsigned int i = 0; i < m_zoneNames.size(); i++)
 	{
-		const auto& zone(m_zones[i]);
-		if(zone.name == name) return i;
+		if(m_zoneNames[i] == name) return i;
 	}
-	auto newZone = ZONE();
-	newZone.name = name;
-	newZone.totalTime = 0;
-	m_zones.push_back(newZone);
-	return static_cast<CProfiler::ZoneHandle>(m_zones.size() - 1);
+	m_zoneNames.push_back(name);
+	return static_cast<CProfiler::ZoneHandle>(m_zoneNames.size() - 1);
 #else
 	return 0;
 #endif
 }
 
+void CProfiler::SetThreadName(const char* name)
+{
+	auto& threadState = GetThreadState();
+	std::lock_guard<std::mutex> threadLock(threadState.mutex);
+	threadState.name = name;
+}
+
 void CProfiler::CountCurrentZone()
 {
-	assert(std::this_thread::get_id() == m_workThreadId);
-	assert(!m_zoneStack.empty());
+	auto& threadState = GetThreadState();
+	std::lock_guard<std::mutex> threadLock(threadState.mutex);
+	assert(!threadState.zoneStack.empty());
 
 	auto thisTime = std::chrono::high_resolution_clock::now();
 
 	{
-		auto topZoneHandle = m_zoneStack.top();
-		auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(thisTime - m_currentTime);
-		AddTimeToZone(topZoneHandle, duration.count());
+		auto topZoneHandle = threadState.zoneStack.back().zoneHandle;
+		auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(thisTime - threadState.currentTime);
+		AddTimeToZone(threadState, topZoneHandle, duration.count());
 	}
 
-	m_currentTime = thisTime;
+	threadState.currentTime = thisTime;
 }
 
 void CProfiler::EnterZone(ZoneHandle zoneHandle)
 {
-	assert(std::this_thread::get_id() == m_workThreadId);
+	auto& threadState = GetThreadState();
+	std::lock_guard<std::mutex> threadLock(threadState.mutex);
 
 	auto thisTime = std::chrono::high_resolution_clock::now();
 
-	if(!m_zoneStack.empty())
+	if(!threadState.zoneStack.empty())
 	{
-		auto topZoneHandle = m_zoneStack.top();
-		auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(thisTime - m_currentTime);
-		AddTimeToZone(topZoneHandle, duration.count());
+		auto topZoneHandle = threadState.zoneStack.back().zoneHandle;
+		auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(thisTime - threadState.currentTime);
+		AddTimeToZone(threadState, topZoneHandle, duration.count());
 	}
 
-	m_zoneStack.push(zoneHandle);
+	STACKENTRY stackEntry;
+	stackEntry.zoneHandle = zoneHandle;
+	stackEntry.enterTime = thisTime;
+	threadState.zoneStack.push_back(stackEntry);
 
-	m_currentTime = thisTime;
+	threadState.currentTime = thisTime;
 }
 
 void CProfiler::ExitZone()
 {
-	CountCurrentZone();
-	m_zoneStack.pop();
+	auto& threadState = GetThreadState();
+	std::lock_guard<std::mutex> threadLock(threadState.mutex);
+	assert(!threadState.zoneStack.empty());
+
+	auto thisTime = std::chrono::high_resolution_clock::now();
+	auto stackEntry = threadState.zoneStack.back();
+
+	{
+		auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(thisTime - threadState.currentTime);
+		AddTimeToZone(threadState, stackEntry.zoneHandle, duration.count());
+	}
+
+	threadState.zoneStack.pop_back();
+	threadState.currentTime = thisTime;
+
+	if(m_capturing.load(std::memory_order_acquire))
+	{
+		if(threadState.captureEvents.size() < threadState.captureMaxEventCount)
+		{
+			CAPTUREEVENT captureEvent;
+			captureEvent.zoneHandle = stackEntry.zoneHandle;
+			captureEvent.depth = static_cast<uint32>(threadState.zoneStack.size());
+			captureEvent.beginTime = std::max(stackEntry.enterTime, threadState.captureStartTime);
+			captureEvent.endTime = thisTime;
+			threadState.captureEvents.push_back(captureEvent);
+		}
+		else
+		{
+			threadState.droppedEventCount++;
+		}
+	}
+}
+
+void CProfiler::EndFrame()
+{
+	if(!m_capturing.load(std::memory_order_acquire)) return;
+	std::lock_guard<std::mutex> profilerLock(m_mutex);
+	m_captureFrameTimes.push_back(std::chrono::high_resolution_clock::now());
 }
 
 CProfiler::ZoneArray CProfiler::GetStats() const
 {
-	assert(std::this_thread::get_id() == m_workThreadId);
-	return m_zones;
+	std::lock_guard<std::mutex> profilerLock(m_mutex);
+	ZoneArray zones;
+	zones.resize(m_zoneNames.size());
+	for(unsigned int i = 0; i < m_zoneNames.size(); i++)
+	{
+		zones[i].name = m_zoneNames[i];
+	}
+	for(const auto& threadState : m_threads)
+	{
+		std::lock_guard<std::mutex> threadLock(threadState->mutex);
+		for(unsigned int i = 0; i < threadState->zoneTimes.size(); i++)
+		{
+			assert(i < zones.size());
+			zones[i].totalTime += threadState->zoneTimes[i];
+		}
+	}
+	return zones;
 }
 
 void CProfiler::Reset()
 {
-	assert(std::this_thread::get_id() == m_workThreadId);
-	for(auto& zone : m_zones)
+	std::lock_guard<std::mutex> profilerLock(m_mutex);
+	for(auto& threadState : m_threads)
 	{
-		zone.totalTime = 0;
+		std::lock_guard<std::mutex> threadLock(threadState->mutex);
+		std::fill(threadState->zoneTimes.begin(), threadState->zoneTimes.end(), 0);
 	}
 }
 
-void CProfiler::SetWorkThread()
+void CProfiler::BeginCapture(uint32 maxEventCount)
 {
-#ifdef _DEBUG
-	m_workThreadId = std::this_thread::get_id();
-#endif
+	std::lock_guard<std::mutex> profilerLock(m_mutex);
+	m_captureMaxEventCount = maxEventCount;
+	m_captureStartTime = std::chrono::high_resolution_clock::now();
+	m_captureEndTime = m_captureStartTime;
+	m_captureFrameTimes.clear();
+	for(auto& threadState : m_threads)
+	{
+		std::lock_guard<std::mutex> threadLock(threadState->mutex);
+		threadState->captureEvents.clear();
+		threadState->captureStartTime = m_captureStartTime;
+		threadState->captureMaxEventCount = maxEventCount;
+		threadState->droppedEventCount = 0;
+	}
+	m_capturing.store(true, std::memory_order_release);
+}
+
+void CProfiler::EndCapture()
+{
+	std::lock_guard<std::mutex> profilerLock(m_mutex);
+	if(!m_capturing.load(std::memory_order_acquire)) return;
+	m_capturing.store(false, std::memory_order_release);
+	m_captureEndTime = std::chrono::high_resolution_clock::now();
+	//Zones that are still active are recorded as ending with the capture
+	for(auto& threadState : m_threads)
+	{
+		std::lock_guard<std::mutex> threadLock(threadState->mutex);
+		for(uint32 depth = 0; depth < threadState->zoneStack.size(); depth++)
+		{
+			const auto& stackEntry = threadState->zoneStack[depth];
+			CAPTUREEVENT captureEvent;
+			captureEvent.zoneHandle = stackEntry.zoneHandle;
+			captureEvent.depth = depth;
+			captureEvent.beginTime = std::max(stackEntry.enterTime, m_captureStartTime);
+			captureEvent.endTime = m_captureEndTime;
+			threadState->captureEvents.push_back(captureEvent);
+		}
+	}
 }
 
-void CProfiler::AddTimeToZone(ZoneHandle zoneHandle, uint64 timeNs)
+bool CProfiler::IsCapturing() const
 {
-	assert(m_zones.size() > zoneHandle);
-	auto& zone = m_zones[zoneHandle];
-	zone.totalTime += timeNs;
+	return m_capturing.load(std::memory_order_acquire);
+}
+
+void CProfiler::WriteChromeTrace(Framework::CStream& stream) const
+{
+	std::lock_guard<std::mutex> profilerLock(m_mutex);
+
+	std::string output;
+	bool firstEvent = true;
+	auto writeEvent =
+	    [&](const std::string& event) {
+		    output += firstEvent ? "\n" : ",\n";
+		    output += event;
+		    firstEvent = false;
+		    if(output.size() >= CHROME_TRACE_FLUSH_SIZE)
+		    {
+			    stream.Write(output.data(), output.size());
+			    output.clear();
+		    }
+	    };
+
+	output += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+	writeEvent(string_format("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"Play!\"}}",
+	                         CHROME_TRACE_PROCESS_ID, CHROME_TRACE_FRAMES_THREAD_ID));
+	writeEvent(string_format("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"Frames\"}}",
+	                         CHROME_TRACE_PROCESS_ID, CHROME_TRACE_FRAMES_THREAD_ID));
+
+	for(unsigned int i = 1; i < m_captureFrameTimes.size(); i++)
+	{
+		double beginTime = GetTraceTime(m_captureFrameTimes[i - 1], m_captureStartTime);
+		double endTime = GetTraceTime(m_captureFrameTimes[i], m_captureStartTime);
+		writeEvent(string_format("{\"name\":\"Frame %d\",\"cat\":\"frame\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d}",
+		                         i, beginTime, endTime - beginTime, CHROME_TRACE_PROCESS_ID, CHROME_TRACE_FRAMES_THREAD_ID));
+	}
+
+	for(const auto& threadState : m_threads)
+	{
+		std::lock_guard<std::mutex> threadLock(threadState->mutex);
+		uint32 threadId = threadState->index + 1;
+		auto threadName = threadState->name.empty() ? string_format("Thread %d", threadState->index) : threadState->name;
+		writeEvent(string_format("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\",\"droppedEvents\":%d}}",
+		                         CHROME_TRACE_PROCESS_ID, threadId, EscapeJsonString(threadName).c_str(), threadState->droppedEventCount));
+		writeEvent(string_format("{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"sort_index\":%d}}",
+		                         CHROME_TRACE_PROCESS_ID, threadId, threadId));
+		for(const auto& captureEvent : threadState->captureEvents)
+		{
+			assert(captureEvent.zoneHandle < m_zoneNames.size());
+			double beginTime = GetTraceTime(captureEvent.beginTime, m_captureStartTime);
+			double endTime = GetTraceTime(captureEvent.endTime, m_captureStartTime);
+			writeEvent(string_format("{\"name\":\"%s\",\"cat\":\"zone\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d,\"args\":{\"depth\":%d}}",
+			                         EscapeJsonString(m_zoneNames[captureEvent.zoneHandle]).c_str(), beginTime, endTime - beginTime,
+			                         CHROME_TRACE_PROCESS_ID, threadId, captureEvent.depth));
+		}
+	}
+
+	output += "\n]}\n";
+	stream.Write(output.data(), output.size());
+}
+
+CProfiler::THREADSTATE& CProfiler::GetThreadState()
+{
+	static thread_local THREADSTATE* threadState = nullptr;
+	if(!threadState)
+	{
+		//States are owned by the profiler so that captures of exited threads can still be written
+		auto newThreadState = std::make_unique<THREADSTATE>();
+		std::lock_guard<std::mutex> profilerLock(m_mutex);
+		newThreadState->index = static_cast<uint32>(m_threads.size());
+		newThreadState->captureStartTime = m_captureStartTime;
+		newThreadState->captureMaxEventCount = m_captureMaxEventCount;
+		threadState = newThreadState.get();
+		m_threads.push_back(std::move(newThreadState));
+	}
+	return *threadState;
+}
+
+void CProfiler::AddTimeToZone(THREADSTATE& threadState, ZoneHandle zoneHandle, uint64 timeNs)
+{
+	if(zoneHandle >= threadState.zoneTimes.size())
+	{
+		threadState.zoneTimes.resize(zoneHandle + 1);
+	}
+	threadState.zoneTimes[zoneHandle] += timeNs;
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -1,18 +1,30 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
 #include <string>
-#include <stack>
 #include <thread>
 #include <vector>
-#include <chrono>
 #include "Singleton.h"
+#include "Stream.h"
 #include "Types.h"
 
+//Zones can be entered from any thread, each thread having its own zone stack.
+//Time spent in a zone excludes time spent in zones nested inside it.
+//When a capture is active, every zone exit is also recorded in a timeline that
+//can be exported in Chrome trace format (readable by chrome://tracing and Perfetto).
 class CProfiler : public CSingleton<CProfiler>
 {
 public:
 	typedef uint32 ZoneHandle;
 
+	enum
+	{
+		DEFAULT_CAPTURE_EVENT_COUNT = 0x100000,
+	};
+
 	struct ZONE
 	{
 		std::string name;
@@ -27,28 +39,68 @@ public:
 
 	ZoneHandle RegisterZone(const char*);
 
+	void SetThreadName(const char*);
+
 	void CountCurrentZone();
 
 	void EnterZone(ZoneHandle);
 	void ExitZone();
 
+	void EndFrame();
+
 	ZoneArray GetStats() const;
 	void Reset();
 
-	void SetWorkThread();
+	//Maximum event count is per thread, events past that limit are dropped
+	void BeginCapture(uint32 = DEFAULT_CAPTURE_EVENT_COUNT);
+	void EndCapture();
+	bool IsCapturing() const;
+	void WriteChromeTrace(Framework::CStream&) const;
 
 private:
-	typedef std::stack<ZoneHandle> ZoneStack;
+	struct STACKENTRY
+	{
+		ZoneHandle zoneHandle = 0;
+		TimePoint enterTime;
+	};
+
+	struct CAPTUREEVENT
+	{
+		ZoneHandle zoneHandle = 0;
+		uint32 depth = 0;
+		TimePoint beginTime;
+		TimePoint endTime;
+	};
+
+	struct THREADSTATE
+	{
+		uint32 index = 0;
+		//Other threads read the state when gathering stats or captures
+		mutable std::mutex mutex;
+		std::string name;
+		std::vector<STACKENTRY> zoneStack;
+		TimePoint currentTime;
+		std::vector<uint64> zoneTimes;
+		std::vector<CAPTUREEVENT> captureEvents;
+		TimePoint captureStartTime;
+		uint32 captureMaxEventCount = 0;
+		uint32 droppedEventCount = 0;
+	};
+
+	typedef std::unique_ptr<THREADSTATE> ThreadStatePtr;
 
-	void AddTimeToZone(ZoneHandle, uint64);
+	THREADSTATE& GetThreadState();
+	void AddTimeToZone(THREADSTATE&, ZoneHandle, uint64);
 
-	ZoneArray m_zones;
-	ZoneStack m_zoneStack;
-	TimePoint m_currentTime;
+	mutable std::mutex m_mutex;
+	std::vector<std::string> m_zoneNames;
+	std::vector<ThreadStatePtr> m_threads;
 
-#ifdef _DEBUG
-	std::thread::id m_workThreadId;
-#endif
+	std::atomic<bool> m_capturing;
+	uint32 m_captureMaxEventCount = 0;
+	TimePoint m_captureStartTime;
+	TimePoint m_captureEndTime;
+	std::vector<TimePoint> m_captureFrameTimes;
 };
 
 class CProfilerZone
@@ -0,0 +1,377 @@
+#include <cassert>
+#include <cstring>
+#include <set>
+#include <stdexcept>
+#include "RewindBuffer.h"
+#include "LzBlockCodec.h"
+#include "MemStream.h"
+#include "PtrStream.h"
+
+CRewindBuffer::CRewindBuffer()
+{
+	m_compressThread = std::thread([this]() { CompressThreadProc(); });
+}
+
+CRewindBuffer::~CRewindBuffer()
+{
+	{
+		std::unique_lock<std::mutex> compressLock(m_compressMutex);
+		m_compressThreadOver = true;
+	}
+	m_compressCondition.notify_one();
+	m_compressThread.join();
+}
+
+void CRewindBuffer::SetCapacity(unsigned int capacity)
+{
+	assert(capacity != 0);
+	std::lock_guard<std::mutex> entriesLock(m_entriesMutex);
+	m_capacity = capacity;
+	while(m_entries.size() > m_capacity)
+	{
+		m_entries.pop_front();
+	}
+}
+
+unsigned int CRewindBuffer::GetEntryCount() const
+{
+	std::lock_guard<std::mutex> entriesLock(m_entriesMutex);
+	return static_cast<unsigned int>(m_entries.size());
+}
+
+uint32 CRewindBuffer::GetEntryFrame(unsigned int index) const
+{
+	std::lock_guard<std::mutex> entriesLock(m_entriesMutex);
+	if(index >= m_entries.size())
+	{
+		throw std::runtime_error("Invalid rewind entry index.");
+	}
+	return m_entries[index]->frame;
+}
+
+void CRewindBuffer::Clear()
+{
+	std::lock_guard<std::mutex> entriesLock(m_entriesMutex);
+	m_entries.clear();
+	m_currentEntry.reset();
+	m_captureEntry.reset();
+	m_capturedPages.clear();
+}
+
+void CRewindBuffer::BeginCapture(uint32 frame)
+{
+	assert(!m_captureEntry);
+	m_captureStartTime = std::chrono::steady_clock::now();
+	m_captureEntry = std::make_shared<ENTRY>();
+	m_captureEntry->frame = frame;
+	m_capturedPages.clear();
+}
+
+void CRewindBuffer::EndCapture(Framework::CZipArchiveWriter& archive)
+{
+	assert(m_captureEntry);
+
+	//Everything else than the large memory regions is small, keep it as a regular state archive
+	{
+		Framework::CMemStream archiveStream;
+		archive.Write(archiveStream);
+		m_captureEntry->archiveData.assign(archiveStream.GetBuffer(), archiveStream.GetBuffer() + archiveStream.GetSize());
+	}
+
+	{
+		std::lock_guard<std::mutex> entriesLock(m_entriesMutex);
+		m_entries.push_back(m_captureEntry);
+		while(m_entries.size() > m_capacity)
+		{
+			m_entries.pop_front();
+		}
+	}
+
+	if(!m_capturedPages.empty())
+	{
+		{
+			std::unique_lock<std::mutex> compressLock(m_compressMutex);
+			m_compressQueue.insert(m_compressQueue.end(), m_capturedPages.begin(), m_capturedPages.end());
+		}
+		m_compressCondition.notify_one();
+		m_capturedPages.clear();
+	}
+
+	m_currentEntry = std::move(m_captureEntry);
+	m_lastCaptureTimeUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_captureStartTime).count();
+}
+
+std::unique_ptr<Framework::CStream> CRewindBuffer::BeginRestore(unsigned int index)
+{
+	m_restoreStartTime = std::chrono::steady_clock::now();
+
+	{
+		std::lock_guard<std::mutex> entriesLock(m_entriesMutex);
+		if(index >= m_entries.size())
+		{
+			throw std::runtime_error("Invalid rewind entry index.");
+		}
+		m_restoreEntry = m_entries[index];
+	}
+
+	//Only write pages that differ between the machine's memory and the entry
+	m_restorePlan.clear();
+	uint32 restorePageCount = 0;
+	for(const auto& regionPair : m_restoreEntry->regions)
+	{
+		const auto& region = regionPair.second;
+		auto currentRegion = FindCurrentRegion(regionPair.first.c_str(), region.memory, region.size);
+
+		PageBitmap pagesToWrite(region.pages.size(), 1);
+		if(currentRegion)
+		{
+			PageBitmap dirtyPages(region.pages.size(), 1);
+			bool tracked = QueryDirtyPages(region.memory, dirtyPages) && (dirtyPages.size() == region.pages.size());
+			auto memory = reinterpret_cast<const uint8*>(region.memory);
+			for(size_t pageIndex = 0; pageIndex < region.pages.size(); pageIndex++)
+			{
+				const auto& page = region.pages[pageIndex];
+				const auto& currentPage = currentRegion->pages[pageIndex];
+				if(tracked && dirtyPages[pageIndex])
+				{
+					pagesToWrite[pageIndex] = 1;
+				}
+				else if(tracked && (page == currentPage))
+				{
+					pagesToWrite[pageIndex] = 0;
+				}
+				else
+				{
+					//Hashes only rule pages out, contents must be compared before skipping a page
+					auto pageMemory = memory + (pageIndex * region.pageSize);
+					uint64 hash = tracked ? currentPage->hash : HashPage(pageMemory, page->size);
+					pagesToWrite[pageIndex] = (hash != page->hash) || !PageMatches(*page, pageMemory);
+				}
+			}
+		}
+
+		for(auto pageToWrite : pagesToWrite)
+		{
+			restorePageCount += pageToWrite;
+		}
+		m_restorePlan.emplace(regionPair.first, std::move(pagesToWrite));
+	}
+
+	m_lastRestorePageCount = restorePageCount;
+
+	//Memory won't match any entry if restoring fails midway
+	m_currentEntry.reset();
+
+	const auto& archiveData = m_restoreEntry->archiveData;
+	return std::make_unique<Framework::CPtrStream>(archiveData.data(), archiveData.size());
+}
+
+void CRewindBuffer::EndRestore()
+{
+	assert(m_restoreEntry);
+
+	//Memory matches the restored entry now, start tracking modifications from here
+	for(const auto& regionPair : m_restoreEntry->regions)
+	{
+		PageBitmap dirtyPages;
+		QueryDirtyPages(regionPair.second.memory, dirtyPages);
+	}
+
+	m_currentEntry = std::move(m_restoreEntry);
+	m_restorePlan.clear();
+	m_lastRestoreTimeUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_restoreStartTime).count();
+}
+
+CRewindBuffer::STATS CRewindBuffer::GetStats() const
+{
+	STATS stats;
+	std::set<const PAGE*> pages;
+	{
+		std::lock_guard<std::mutex> entriesLock(m_entriesMutex);
+		stats.entryCount = static_cast<uint32>(m_entries.size());
+		for(const auto& entry : m_entries)
+		{
+			stats.storedBytes += entry->archiveData.size();
+			for(const auto& regionPair : entry->regions)
+			{
+				for(const auto& page : regionPair.second.pages)
+				{
+					pages.insert(page.get());
+				}
+			}
+		}
+	}
+	{
+		std::lock_guard<std::mutex> pageLock(m_pageMutex);
+		for(const auto& page : pages)
+		{
+			stats.storedBytes += page->data.size();
+		}
+	}
+	stats.pageCount = static_cast<uint32>(pages.size());
+	stats.lastCaptureTimeUs = m_lastCaptureTimeUs;
+	stats.lastRestoreTimeUs = m_lastRestoreTimeUs;
+	stats.lastRestorePageCount = m_lastRestorePageCount;
+	return stats;
+}
+
+void CRewindBuffer::InsertMemoryFile(Framework::CZipArchiveWriter&, const char* name, const void* memory, size_t size)
+{
+	assert(m_captureEntry);
+
+	REGION region;
+	region.memory = memory;
+	region.size = size;
+	region.pageSize = GetPageSize(memory);
+	size_t pageCount = (size + region.pageSize - 1) / region.pageSize;
+	region.pages.resize(pageCount);
+
+	auto currentRegion = FindCurrentRegion(name, memory, size);
+
+	PageBitmap dirtyPages(pageCount, 1);
+	bool tracked = QueryDirtyPages(memory, dirtyPages) && currentRegion && (dirtyPages.size() == pageCount);
+
+	auto pageData = reinterpret_cast<const uint8*>(memory);
+	for(size_t pageIndex = 0; pageIndex < pageCount; pageIndex++)
+	{
+		//Pages that weren't written to are shared with the previous entry
+		if(tracked && !dirtyPages[pageIndex])
+		{
+			region.pages[pageIndex] = currentRegion->pages[pageIndex];
+			continue;
+		}
+
+		size_t pageOffset = pageIndex * region.pageSize;
+		uint32 pageSize = static_cast<uint32>(std::min<size_t>(region.pageSize, size - pageOffset));
+		uint64 hash = HashPage(pageData + pageOffset, pageSize);
+		if(
+		    currentRegion && (currentRegion->pages[pageIndex]->hash == hash) &&
+		    PageMatches(*currentRegion->pages[pageIndex], pageData + pageOffset))
+		{
+			region.pages[pageIndex] = currentRegion->pages[pageIndex];
+			continue;
+		}
+
+		region.pages[pageIndex] = CapturePage(pageData + pageOffset, pageSize, hash);
+	}
+
+	m_captureEntry->regions[name] = std::move(region);
+}
+
+void CRewindBuffer::ReadMemoryFile(Framework::CZipArchiveReader& archive, const char* name, void* memory, size_t size)
+{
+	assert(m_restoreEntry);
+
+	auto regionIterator = m_restoreEntry->regions.find(name);
+	auto planIterator = m_restorePlan.find(name);
+	if((regionIterator == std::end(m_restoreEntry->regions)) || (planIterator == std::end(m_restorePlan)))
+	{
+		CMemoryStateTracker::ReadMemoryFile(archive, name, memory, size);
+		return;
+	}
+
+	const auto& region = regionIterator->second;
+	const auto& pagesToWrite = planIterator->second;
+	if((region.memory != memory) || (region.size != size))
+	{
+		throw std::runtime_error("Memory region doesn't match rewind entry.");
+	}
+
+	std::lock_guard<std::mutex> pageLock(m_pageMutex);
+	auto output = reinterpret_cast<uint8*>(memory);
+	for(size_t pageIndex = 0; pageIndex < region.pages.size(); pageIndex++)
+	{
+		if(!pagesToWrite[pageIndex]) continue;
+		ReadPage(*region.pages[pageIndex], output + (pageIndex * region.pageSize));
+	}
+}
+
+const CRewindBuffer::REGION* CRewindBuffer::FindCurrentRegion(const char* name, const void* memory, size_t size) const
+{
+	if(!m_currentEntry) return nullptr;
+	auto regionIterator = m_currentEntry->regions.find(name);
+	if(regionIterator == std::end(m_currentEntry->regions)) return nullptr;
+	const auto& region = regionIterator->second;
+	if((region.memory != memory) || (region.size != size)) return nullptr;
+	return &region;
+}
+
+CRewindBuffer::PagePtr CRewindBuffer::CapturePage(const uint8* pageData, uint32 pageSize, uint64 hash)
+{
+	auto page = std::make_shared<PAGE>();
+	page->hash = hash;
+	page->size = pageSize;
+	{
+		std::lock_guard<std::mutex> pageLock(m_pageMutex);
+		if(!m_bufferPool.empty())
+		{
+			page->data = std::move(m_bufferPool.back());
+			m_bufferPool.pop_back();
+		}
+	}
+	page->data.resize(pageSize);
+	memcpy(page->data.data(), pageData, pageSize);
+	m_capturedPages.push_back(page);
+	return page;
+}
+
+bool CRewindBuffer::PageMatches(const PAGE& page, const uint8* memory)
+{
+	std::lock_guard<std::mutex> pageLock(m_pageMutex);
+	if(!page.compressed)
+	{
+		return memcmp(page.data.data(), memory, page.size) == 0;
+	}
+	m_compareBuffer.resize(page.size);
+	ReadPage(page, m_compareBuffer.data());
+	return memcmp(m_compareBuffer.data(), memory, page.size) == 0;
+}
+
+void CRewindBuffer::ReadPage(const PAGE& page, uint8* output)
+{
+	if(page.compressed)
+	{
+		bool result = LzBlockCodec::Decompress(page.data.data(), page.data.size(), output, page.size);
+		if(!result)
+		{
+			throw std::runtime_error("Failed to decompress rewind page.");
+		}
+	}
+	else
+	{
+		memcpy(output, page.data.data(), page.size);
+	}
+}
+
+void CRewindBuffer::CompressThreadProc()
+{
+	std::vector<uint8> compressBuffer;
+	while(1)
+	{
+		PagePtr page;
+		{
+			std::unique_lock<std::mutex> compressLock(m_compressMutex);
+			m_compressCondition.wait(compressLock, [this]() { return m_compressThreadOver || !m_compressQueue.empty(); });
+			if(m_compressThreadOver) break;
+			page = std::move(m_compressQueue.front());
+			m_compressQueue.pop_front();
+		}
+
+		//Page was dropped from the buffer before we got to it
+		if(page.use_count() == 1) continue;
+
+		//Raw data isn't modified by anyone else until the page is marked as compressed
+		compressBuffer.resize(LzBlockCodec::GetMaxCompressedSize(page->size));
+		size_t compressedSize = LzBlockCodec::Compress(page->data.data(), page->size, compressBuffer.data(), compressBuffer.size());
+		if((compressedSize == 0) || (compressedSize >= page->size)) continue;
+
+		std::vector<uint8> compressedData(compressBuffer.begin(), compressBuffer.begin() + compressedSize);
+		std::lock_guard<std::mutex> pageLock(m_pageMutex);
+		std::swap(page->data, compressedData);
+		page->compressed = true;
+		if(m_bufferPool.size() < MAX_POOLED_BUFFERS)
+		{
+			m_bufferPool.push_back(std::move(compressedData));
+		}
+	}
+}
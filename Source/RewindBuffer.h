@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Stream.h"
+#include "states/MemoryStateTracker.h"
+
+//Keeps a rolling history of machine states in memory. Memory regions are split in pages:
+//pages that didn't change since the previous entry are shared and modified ones are copied
+//then compressed on a worker thread, keeping capture cheap enough to be done every few frames.
+class CRewindBuffer : public CMemoryStateTracker
+{
+public:
+	struct STATS
+	{
+		uint32 entryCount = 0;
+		uint32 pageCount = 0;
+		uint64 storedBytes = 0;
+		uint64 lastCaptureTimeUs = 0;
+		uint64 lastRestoreTimeUs = 0;
+		uint32 lastRestorePageCount = 0;
+	};
+
+	enum
+	{
+		DEFAULT_CAPACITY = 60,
+	};
+
+	CRewindBuffer();
+	virtual ~CRewindBuffer();
+
+	void SetCapacity(unsigned int);
+	unsigned int GetEntryCount() const;
+	uint32 GetEntryFrame(unsigned int) const;
+	void Clear();
+
+	void BeginCapture(uint32);
+	void EndCapture(Framework::CZipArchiveWriter&);
+
+	std::unique_ptr<Framework::CStream> BeginRestore(unsigned int);
+	void EndRestore();
+
+	STATS GetStats() const;
+
+	void InsertMemoryFile(Framework::CZipArchiveWriter&, const char*, const void*, size_t) override;
+	void ReadMemoryFile(Framework::CZipArchiveReader&, const char*, void*, size_t) override;
+
+private:
+	enum
+	{
+		MAX_POOLED_BUFFERS = 0x400,
+	};
+
+	struct PAGE
+	{
+		uint64 hash = 0;
+		uint32 size = 0;
+		bool compressed = false;
+		std::vector<uint8> data;
+	};
+	typedef std::shared_ptr<PAGE> PagePtr;
+	typedef std::vector<PagePtr> PageList;
+
+	struct REGION
+	{
+		const void* memory = nullptr;
+		size_t size = 0;
+		uint32 pageSize = 0;
+		PageList pages;
+	};
+	typedef std::map<std::string, REGION> RegionMap;
+
+	struct ENTRY
+	{
+		uint32 frame = 0;
+		std::vector<uint8> archiveData;
+		RegionMap regions;
+	};
+	typedef std::shared_ptr<ENTRY> EntryPtr;
+	typedef std::deque<EntryPtr> EntryList;
+
+	typedef std::map<std::string, PageBitmap> RestorePlan;
+
+	const REGION* FindCurrentRegion(const char*, const void*, size_t) const;
+	PagePtr CapturePage(const uint8*, uint32, uint64);
+	bool PageMatches(const PAGE&, const uint8*);
+	void ReadPage(const PAGE&, uint8*);
+	void CompressThreadProc();
+
+	mutable std::mutex m_entriesMutex;
+	EntryList m_entries;
+	unsigned int m_capacity = DEFAULT_CAPACITY;
+
+	//Entry that matches the current machine state, except for pages modified since
+	EntryPtr m_currentEntry;
+	EntryPtr m_captureEntry;
+	std::vector<PagePtr> m_capturedPages;
+
+	EntryPtr m_restoreEntry;
+	RestorePlan m_restorePlan;
+	std::chrono::steady_clock::time_point m_restoreStartTime;
+
+	mutable std::mutex m_pageMutex;
+	std::vector<std::vector<uint8>> m_bufferPool;
+	std::vector<uint8> m_compareBuffer;
+
+	std::thread m_compressThread;
+	std::mutex m_compressMutex;
+	std::condition_variable m_compressCondition;
+	std::deque<PagePtr> m_compressQueue;
+	bool m_compressThreadOver = false;
+
+	std::chrono::steady_clock::time_point m_captureStartTime;
+
+	//Read by GetStats from other threads
+	std::atomic<uint64> m_lastCaptureTimeUs = {0};
+	std::atomic<uint64> m_lastRestoreTimeUs = {0};
+	std::atomic<uint32> m_lastRestorePageCount = {0};
+};
@@ -0,0 +1,157 @@
+#include <chrono>
+#include "TraceLog.h"
+#include "AppConfig.h"
+#include "PathUtils.h"
+#include "StdStreamUtils.h"
+
+#define LOG_PATH "logs"
+#define TRACE_FILE_NAME "trace.bin"
+
+#define PREF_LOG_TRACEMASK "log.tracemask"
+
+static const char* g_subsystemNames[TRACE_SUBSYSTEM_COUNT] =
+    {
+        "sif",
+        "cdvd",
+        "dmac",
+};
+
+CTraceLog::CTraceLog()
+    : m_enabledMask(0)
+{
+#ifndef DISABLE_LOGGING
+	m_logBasePath = CAppConfig::GetBasePath() / LOG_PATH;
+	//Tracing is opt-in, set bits (1 << TRACE_SUBSYSTEM_*) to enable subsystems
+	CAppConfig::GetInstance().RegisterPreferenceInteger(PREF_LOG_TRACEMASK, 0);
+	m_enabledMask = CAppConfig::GetInstance().GetPreferenceInteger(PREF_LOG_TRACEMASK);
+#endif
+}
+
+CTraceLog::~CTraceLog()
+{
+	//Keep the last events around for bug reports
+	if(m_logBasePath.empty() || m_rings.empty()) return;
+	try
+	{
+		Framework::PathUtils::EnsurePathExists(m_logBasePath);
+		Dump(m_logBasePath / TRACE_FILE_NAME);
+	}
+	catch(...)
+	{
+	}
+}
+
+const char* CTraceLog::GetSubsystemName(uint32 subsystem)
+{
+	if(subsystem >= TRACE_SUBSYSTEM_COUNT) return "unknown";
+	return g_subsystemNames[subsystem];
+}
+
+uint32 CTraceLog::GetEnabledMask() const
+{
+	return m_enabledMask.load(std::memory_order_relaxed);
+}
+
+void CTraceLog::SetEnabledMask(uint32 enabledMask)
+{
+	m_enabledMask.store(enabledMask, std::memory_order_relaxed);
+}
+
+uint32 CTraceLog::RegisterFormat(TRACE_SUBSYSTEM subsystem, const char* format)
+{
+	std::lock_guard<std::mutex> formatsLock(m_formatsMutex);
+	FORMAT newFormat;
+	newFormat.subsystem = subsystem;
+	newFormat.format = format;
+	m_formats.push_back(std::move(newFormat));
+	return static_cast<uint32>(m_formats.size() - 1);
+}
+
+void CTraceLog::Dump(Framework::CStream& stream)
+{
+	std::vector<FORMAT> formats;
+	{
+		std::lock_guard<std::mutex> formatsLock(m_formatsMutex);
+		formats = m_formats;
+	}
+
+	std::vector<RingPtr> rings;
+	{
+		std::lock_guard<std::mutex> ringsLock(m_ringsMutex);
+		rings = m_rings;
+	}
+
+	FILEHEADER header = {};
+	header.magic = FILE_MAGIC;
+	header.version = FILE_VERSION;
+	header.formatCount = static_cast<uint32>(formats.size());
+	header.threadCount = static_cast<uint32>(rings.size());
+	stream.Write(&header, sizeof(FILEHEADER));
+
+	for(const auto& format : formats)
+	{
+		FORMATHEADER formatHeader = {};
+		formatHeader.subsystem = format.subsystem;
+		formatHeader.length = static_cast<uint32>(format.format.size());
+		stream.Write(&formatHeader, sizeof(FORMATHEADER));
+		stream.Write(format.format.data(), format.format.size());
+	}
+
+	std::vector<EVENT> events;
+	events.reserve(RING_SIZE);
+	for(const auto& ring : rings)
+	{
+		events.clear();
+		uint64 endIndex = ring->writeIndex.load(std::memory_order_acquire);
+		uint64 beginIndex = (endIndex > RING_SIZE) ? (endIndex - RING_SIZE) : 0;
+		for(uint64 index = beginIndex; index < endIndex; index++)
+		{
+			//Slots can be rewritten by the owning thread while we copy them, only keep consistent ones
+			const auto& slot = ring->slots[index & (RING_SIZE - 1)];
+			uint64 sequence = slot.sequence.load(std::memory_order_acquire);
+			if(sequence != (index + 1)) continue;
+			EVENT event = slot.event;
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if(slot.sequence.load(std::memory_order_relaxed) != sequence) continue;
+			events.push_back(event);
+		}
+
+		THREADHEADER threadHeader = {};
+		threadHeader.threadIndex = ring->threadIndex;
+		threadHeader.eventCount = static_cast<uint32>(events.size());
+		threadHeader.lostEventCount = endIndex - events.size();
+		stream.Write(&threadHeader, sizeof(THREADHEADER));
+		if(!events.empty())
+		{
+			stream.Write(events.data(), events.size() * sizeof(EVENT));
+		}
+	}
+}
+
+void CTraceLog::Dump(const fs::path& path)
+{
+	auto stream = Framework::CreateOutputStdStream(path.native());
+	Dump(stream);
+}
+
+uint64 CTraceLog::GetTimestamp()
+{
+	auto now = std::chrono::steady_clock::now().time_since_epoch();
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
+CTraceLog::RING& CTraceLog::GetThreadRing()
+{
+	static thread_local RING* threadRing = nullptr;
+	if(!threadRing)
+	{
+		//Rings are owned by the log so that events of exited threads can still be dumped
+		auto ring = std::make_shared<RING>();
+		ring->slots = std::make_unique<SLOT[]>(RING_SIZE);
+		std::lock_guard<std::mutex> ringsLock(m_ringsMutex);
+		ring->threadIndex = static_cast<uint32>(m_rings.size());
+		m_rings.push_back(ring);
+		threadRing = ring.get();
+	}
+	return *threadRing;
+}
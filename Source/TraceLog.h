@@ -0,0 +1,180 @@
+#pragma once
+
+#include <atomic>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "filesystem_def.h"
+#include "Singleton.h"
+#include "Stream.h"
+#include "Types.h"
+
+enum TRACE_SUBSYSTEM
+{
+	TRACE_SUBSYSTEM_SIF,
+	TRACE_SUBSYSTEM_CDVD,
+	TRACE_SUBSYSTEM_DMAC,
+	TRACE_SUBSYSTEM_COUNT,
+};
+
+//Binary event log that is cheap enough to be used in release builds.
+//Each thread writes fixed size events (format id, timestamp and raw arguments) in its own ring,
+//older events being overwritten. Format strings are only stored once and events are
+//formatted offline by the TraceDecoder tool from a file written by Dump.
+//Arguments must be 32-bit or smaller integers, enums or floats (no strings or pointers).
+class CTraceLog : public CSingleton<CTraceLog>
+{
+public:
+	enum
+	{
+		MAX_ARGS = 12,
+		RING_SIZE = 0x4000,
+	};
+
+	enum : uint32
+	{
+		FILE_MAGIC = 0x43525450, //'PTRC'
+		FILE_VERSION = 1,
+	};
+
+	struct FILEHEADER
+	{
+		uint32 magic;
+		uint32 version;
+		uint32 formatCount;
+		uint32 threadCount;
+	};
+	static_assert(sizeof(FILEHEADER) == 0x10, "FILEHEADER size must be 16 bytes.");
+
+	//Followed by the format string (without terminating null character)
+	struct FORMATHEADER
+	{
+		uint32 subsystem;
+		uint32 length;
+	};
+	static_assert(sizeof(FORMATHEADER) == 0x08, "FORMATHEADER size must be 8 bytes.");
+
+	//Followed by eventCount EVENT structures, ordered from oldest to newest
+	struct THREADHEADER
+	{
+		uint32 threadIndex;
+		uint32 eventCount;
+		uint64 lostEventCount;
+	};
+	static_assert(sizeof(THREADHEADER) == 0x10, "THREADHEADER size must be 16 bytes.");
+
+	struct EVENT
+	{
+		uint64 timestamp; //In nanoseconds
+		uint32 formatId;
+		uint32 argCount;
+		uint32 args[MAX_ARGS];
+	};
+	static_assert(sizeof(EVENT) == 0x40, "EVENT size must be 64 bytes.");
+
+	CTraceLog();
+	virtual ~CTraceLog();
+
+	static const char* GetSubsystemName(uint32);
+
+	bool IsEnabled(TRACE_SUBSYSTEM subsystem) const
+	{
+		return (m_enabledMask.load(std::memory_order_relaxed) & (1 << subsystem)) != 0;
+	}
+
+	uint32 GetEnabledMask() const;
+	void SetEnabledMask(uint32);
+
+	uint32 RegisterFormat(TRACE_SUBSYSTEM, const char*);
+
+	template <typename... Args>
+	void Write(uint32 formatId, Args... args)
+	{
+		static_assert(sizeof...(Args) <= MAX_ARGS, "Too many trace event arguments.");
+		auto& ring = GetThreadRing();
+		uint64 index = ring.writeIndex.load(std::memory_order_relaxed);
+		auto& slot = ring.slots[index & (RING_SIZE - 1)];
+		slot.sequence.store(SEQUENCE_WRITING, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		slot.event.timestamp = GetTimestamp();
+		slot.event.formatId = formatId;
+		slot.event.argCount = sizeof...(Args);
+		uint32* output = slot.event.args;
+		(void)std::initializer_list<int>{(*output++ = EncodeArg(args), 0)...};
+		slot.sequence.store(index + 1, std::memory_order_release);
+		ring.writeIndex.store(index + 1, std::memory_order_release);
+	}
+
+	void Dump(Framework::CStream&);
+	void Dump(const fs::path&);
+
+private:
+	enum : uint64
+	{
+		SEQUENCE_WRITING = ~0ULL,
+	};
+
+	struct FORMAT
+	{
+		uint32 subsystem = 0;
+		std::string format;
+	};
+
+	struct SLOT
+	{
+		std::atomic<uint64> sequence = {0};
+		EVENT event;
+	};
+
+	//Only written by its owning thread, read concurrently by Dump
+	struct RING
+	{
+		uint32 threadIndex = 0;
+		std::atomic<uint64> writeIndex = {0};
+		std::unique_ptr<SLOT[]> slots;
+	};
+	typedef std::shared_ptr<RING> RingPtr;
+
+	template <typename T>
+	static typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value, uint32>::type EncodeArg(T value)
+	{
+		static_assert(sizeof(T) <= sizeof(uint32), "Trace event arguments must fit in 32 bits.");
+		return static_cast<uint32>(value);
+	}
+
+	static uint32 EncodeArg(float value)
+	{
+		uint32 result = 0;
+		memcpy(&result, &value, sizeof(uint32));
+		return result;
+	}
+
+	static uint64 GetTimestamp();
+	RING& GetThreadRing();
+
+	std::atomic<uint32> m_enabledMask;
+	fs::path m_logBasePath;
+
+	std::mutex m_formatsMutex;
+	std::vector<FORMAT> m_formats;
+
+	std::mutex m_ringsMutex;
+	std::vector<RingPtr> m_rings;
+};
+
+//Records an event if the subsystem is enabled. The format string must be a literal: its id is
+//registered once per call site.
+#define TRACE_EVENT(subsystem, format, ...)                                                 \
+	do                                                                                      \
+	{                                                                                       \
+		auto& traceLog = CTraceLog::GetInstance();                                          \
+		if(traceLog.IsEnabled(subsystem))                                                   \
+		{                                                                                   \
+			static const uint32 traceFormatId = traceLog.RegisterFormat(subsystem, format); \
+			traceLog.Write(traceFormatId, ##__VA_ARGS__);                                   \
+		}                                                                                   \
+	} while(0)
@@ -3,6 +3,7 @@
 #include "DMAC.h"
 #include "../Ps2Const.h"
 #include "../Log.h"
+#include "../TraceLog.h"
 #include "../states/RegisterStateFile.h"
 #include "../MIPS.h"
 #include "../COP_SCU.h"
@@ -148,6 +149,22 @@ void CDMAC::SetChannelTransferFunction(unsigned int channel, const DmaReceiveHan
 	}
 }
 
+void CDMAC::SetChannelSourceChainCache(unsigned int channel, Dmac::CSourceChainCache* sourceChainCache)
+{
+	switch(channel)
+	{
+	case 1:
+		m_D1.SetSourceChainCache(sourceChainCache);
+		break;
+	case 2:
+		m_D2.SetSourceChainCache(sourceChainCache);
+		break;
+	default:
+		throw std::runtime_error("Unsupported channel.");
+		break;
+	}
+}
+
 bool CDMAC::IsInterruptPending()
 {
 	uint16 mask = static_cast<uint16>((m_D_STAT & 0x63FF0000) >> 16);
@@ -294,9 +311,10 @@ uint32 CDMAC::ReceiveDMA9(uint32 nSrcAddress, uint32 nCount, uint32 unused, bool
 
 uint32 CDMAC::GetRegister(uint32 nAddress)
 {
-#ifdef _DEBUG
-	DisassembleGet(nAddress);
-#endif
+	if(CTraceLog::GetInstance().IsEnabled(TRACE_SUBSYSTEM_DMAC))
+	{
+		DisassembleGet(nAddress);
+	}
 
 	switch(nAddress)
 	{
@@ -881,9 +899,10 @@ void CDMAC::SetRegister(uint32 nAddress, uint32 nData)
 		break;
 	}
 
-#ifdef _DEBUG
-	DisassembleSet(nAddress, nData);
-#endif
+	if(CTraceLog::GetInstance().IsEnabled(TRACE_SUBSYSTEM_DMAC))
+	{
+		DisassembleSet(nAddress, nData);
+	}
 }
 
 void CDMAC::LoadState(Framework::CZipArchiveReader& archive)
@@ -948,9 +967,9 @@ void CDMAC::UpdateCpCond()
 
 void CDMAC::DisassembleGet(uint32 nAddress)
 {
-#define LOG_GET(registerId)                                            \
-	case registerId:                                                   \
-		CLog::GetInstance().Print(LOG_NAME, "= " #registerId ".\r\n"); \
+#define LOG_GET(registerId)                                      \
+	case registerId:                                             \
+		TRACE_EVENT(TRACE_SUBSYSTEM_DMAC, "= " #registerId "."); \
 		break;
 
 	switch(nAddress)
@@ -1015,9 +1034,9 @@ void CDMAC::DisassembleGet(uint32 nAddress)
 
 void CDMAC::DisassembleSet(uint32 nAddress, uint32 nData)
 {
-#define LOG_SET(registerId)                                                       \
-	case registerId:                                                              \
-		CLog::GetInstance().Print(LOG_NAME, #registerId " = 0x%08X.\r\n", nData); \
+#define LOG_SET(registerId)                                                 \
+	case registerId:                                                        \
+		TRACE_EVENT(TRACE_SUBSYSTEM_DMAC, #registerId " = 0x%08X.", nData); \
 		break;
 
 	switch(nAddress)
@@ -100,6 +100,7 @@ public:
 	void Reset();
 
 	void SetChannelTransferFunction(unsigned int, const Dmac::DmaReceiveHandler&);
+	void SetChannelSourceChainCache(unsigned int, Dmac::CSourceChainCache*);
 
 	uint32 GetRegister(uint32);
 	void SetRegister(uint32, uint32);
@@ -269,6 +269,18 @@ void CChannel::ExecuteSourceChain()
 		return;
 	}
 
+	//Chains starting from scratch can be replayed by the device if it has already seen them
+	bool recordingChain = false;
+	if(m_sourceChainCache && !isMfifo && !isStallDrainChannel && (m_nQWC == 0) && (m_nSCCTRL & SCCTRL_INITXFER) &&
+	   (m_CHCR.nASP == 0) && (m_CHCR.nTTE == 0) && (m_CHCR.nReserved0 == 0))
+	{
+		if(ReplaySourceChain())
+		{
+			return;
+		}
+		recordingChain = m_sourceChainCache->BeginRecording(m_nTADR, m_CHCR);
+	}
+
 	//Execute current
 	if(m_nQWC != 0)
 	{
@@ -366,6 +378,11 @@ void CChannel::ExecuteSourceChain()
 			continue;
 		}
 
+		if(recordingChain)
+		{
+			m_sourceChainCache->RecordSource(m_nTADR, 1);
+		}
+
 		uint64 nTag = m_dmac.FetchDMATag(m_nTADR);
 
 		//Save higher 16 bits of tag into CHCR
@@ -453,10 +470,22 @@ void CChannel::ExecuteSourceChain()
 
 		if(qwc != 0)
 		{
+			if(recordingChain)
+			{
+				m_sourceChainCache->RecordSource(m_nMADR, qwc);
+			}
+
 			uint32 nRecv = m_receive(m_nMADR, qwc, CHCR_DIR_FROM, false);
 
 			m_nMADR += nRecv * 0x10;
 			m_nQWC -= nRecv;
+
+			if(recordingChain && (nRecv != qwc))
+			{
+				//Device couldn't take everything, chain will be resumed later
+				m_sourceChainCache->CancelRecording();
+				recordingChain = false;
+			}
 		}
 
 		if(isMfifo)
@@ -477,6 +506,18 @@ void CChannel::ExecuteSourceChain()
 			m_nTADR += m_dmac.m_D_RBOR;
 		}
 	}
+
+	if(recordingChain)
+	{
+		if(m_CHCR.nSTR == 0)
+		{
+			m_sourceChainCache->EndRecording(GetSourceChainState());
+		}
+		else
+		{
+			m_sourceChainCache->CancelRecording();
+		}
+	}
 }
 
 void CChannel::ExecuteDestinationChain()
@@ -521,6 +562,43 @@ void CChannel::SetReceiveHandler(const DmaReceiveHandler& handler)
 	m_receive = handler;
 }
 
+void CChannel::SetSourceChainCache(CSourceChainCache* sourceChainCache)
+{
+	m_sourceChainCache = sourceChainCache;
+}
+
+bool CChannel::ReplaySourceChain()
+{
+	CSourceChainCache::CHANNELSTATE state;
+	if(!m_sourceChainCache->Replay(m_nTADR, m_CHCR, state))
+	{
+		return false;
+	}
+
+	m_CHCR <<= state.chcr;
+	m_CHCR.nSTR = 1;
+	m_nMADR = state.madr;
+	m_nQWC = 0;
+	m_nTADR = state.tadr;
+	m_nASR[0] = state.asr[0];
+	m_nASR[1] = state.asr[1];
+	m_nSCCTRL = state.scctrl;
+	ClearSTR();
+	return true;
+}
+
+CSourceChainCache::CHANNELSTATE CChannel::GetSourceChainState()
+{
+	CSourceChainCache::CHANNELSTATE state;
+	state.chcr = m_CHCR;
+	state.madr = m_nMADR;
+	state.tadr = m_nTADR;
+	state.asr[0] = m_nASR[0];
+	state.asr[1] = m_nASR[1];
+	state.scctrl = m_nSCCTRL;
+	return state;
+}
+
 void CChannel::ClearSTR()
 {
 	m_CHCR.nSTR = ~m_CHCR.nSTR;
@@ -12,6 +12,32 @@ namespace Dmac
 {
 	typedef std::function<uint32(uint32, uint32, uint32, bool)> DmaReceiveHandler;
 
+	//Lets the receiving device replay a source chain it has already processed instead of
+	//having the channel walk the tags and send the data again.
+	class CSourceChainCache
+	{
+	public:
+		//Channel registers once the chain is completed
+		struct CHANNELSTATE
+		{
+			uint32 chcr = 0;
+			uint32 madr = 0;
+			uint32 tadr = 0;
+			uint32 asr[2] = {};
+			uint32 scctrl = 0;
+		};
+
+		virtual ~CSourceChainCache() = default;
+
+		//Chains are identified by their starting TADR and CHCR
+		virtual bool Replay(uint32, uint32, CHANNELSTATE&) = 0;
+
+		virtual bool BeginRecording(uint32, uint32) = 0;
+		virtual void RecordSource(uint32, uint32) = 0;
+		virtual void CancelRecording() = 0;
+		virtual void EndRecording(const CHANNELSTATE&) = 0;
+	};
+
 	class CChannel
 	{
 	public:
@@ -79,6 +105,7 @@ namespace Dmac
 		void ExecuteSourceChain();
 		void ExecuteDestinationChain();
 		void SetReceiveHandler(const DmaReceiveHandler&);
+		void SetSourceChainCache(CSourceChainCache*);
 
 		CHCR m_CHCR;
 		uint32 m_nMADR;
@@ -95,9 +122,13 @@ namespace Dmac
 
 		void ClearSTR();
 
+		bool ReplaySourceChain();
+		CSourceChainCache::CHANNELSTATE GetSourceChainState();
+
 		unsigned int m_number = 0;
 		uint32 m_nSCCTRL;
 		DmaReceiveHandler m_receive;
+		CSourceChainCache* m_sourceChainCache = nullptr;
 		CDMAC& m_dmac;
 	};
 };
@@ -11,6 +11,18 @@ void CEEAssembler::LQ(unsigned int rt, uint16 offset, unsigned int base)
 	m_ptr++;
 }
 
+void CEEAssembler::MADD(unsigned int rd, unsigned int rs, unsigned int rt)
+{
+	(*m_ptr) = ((0x1C) << 26) | (rs << 21) | (rt << 16) | (rd << 11) | (0x00);
+	m_ptr++;
+}
+
+void CEEAssembler::MADDU(unsigned int rd, unsigned int rs, unsigned int rt)
+{
+	(*m_ptr) = ((0x1C) << 26) | (rs << 21) | (rt << 16) | (rd << 11) | (0x01);
+	m_ptr++;
+}
+
 void CEEAssembler::MFHI1(unsigned int rd)
 {
 	(*m_ptr) = ((0x1C) << 26) | (rd << 11) | (0x10);
@@ -35,18 +47,54 @@ void CEEAssembler::MTLO1(unsigned int rs)
 	m_ptr++;
 }
 
+void CEEAssembler::PABSH(unsigned int rd, unsigned int rt)
+{
+	(*m_ptr) = ((0x1C) << 26) | (rt << 16) | (rd << 11) | ((0x05) << 6) | (0x28);
+	m_ptr++;
+}
+
+void CEEAssembler::PABSW(unsigned int rd, unsigned int rt)
+{
+	(*m_ptr) = ((0x1C) << 26) | (rt << 16) | (rd << 11) | ((0x01) << 6) | (0x28);
+	m_ptr++;
+}
+
 void CEEAssembler::PADDW(unsigned int rd, unsigned int rs, unsigned int rt)
 {
 	(*m_ptr) = ((0x1C) << 26) | (rs << 21) | (rt << 16) | (rd << 11) | ((0x00) << 6) | (0x08);
 	m_ptr++;
 }
 
+void CEEAssembler::PADSBH(unsigned int rd, unsigned int rs, unsigned int rt)
+{
+	(*m_ptr) = ((0x1C) << 26) | (rs << 21) | (rt << 16) | (rd << 11) | ((0x04) << 6) | (0x28);
+	m_ptr++;
+}
+
+void CEEAssembler::PDIVBW(unsigned int rs, unsigned int rt)
+{
+	(*m_ptr) = ((0x1C) << 26) | (rs << 21) | (rt << 16) | ((0x1D) << 6) | (0x09);
+	m_ptr++;
+}
+
+void CEEAssembler::PDIVUW(unsigned int rs, unsigned int rt)
+{
+	(*m_ptr) = ((0x1C) << 26) | (rs << 21) | (rt << 16) | ((0x0D) << 6) | (0x29);
+	m_ptr++;
+}
+
 void CEEAssembler::PEXCH(unsigned int rd, unsigned int rt)
 {
 	(*m_ptr) = ((0x1C) << 26) | (rt << 16) | (rd << 11) | ((0x1A) << 6) | (0x29);
 	m_ptr++;
 }
 
+void CEEAssembler::PEXEH(unsigned int rd, unsigned int rt)
+{
+	(*m_ptr) = ((0x1C) << 26) | (rt << 16) | (rd << 11) | ((0x1A) << 6) | (0x09);
+	m_ptr++;
+}
+
 void CEEAssembler::PEXTLB(unsigned int rd, unsigned int rs, unsigned int rt)
 {
 	(*m_ptr) = ((0x1C) << 26) | (rs << 21) | (rt << 16) | (rd << 11) | ((0x1A) << 6) | (0x08);
@@ -77,6 +125,42 @@ void CEEAssembler::PEXCW(unsigned int rd, unsigned int rt)
 	m_ptr++;
 }
 
+void CEEAssembler::PHMADH(unsigned int rd, unsigned int rs, unsigned int rt)
+{
+	(*m_ptr) = ((0x1C) << 26) | (rs << 21) | (rt << 16) | (rd << 11) | ((0x11) << 6) | (0x09);
+	m_ptr++;
+}
+
+void CEEAssembler::PHMSBH(unsigned int rd, unsigned int rs, unsigned int rt)
+{
+	(*m_ptr) = ((0x1C) << 26) | (rs << 21) | (rt << 16) | (rd << 11) | ((0x15) << 6) | (0x09);
+	m_ptr++;
+}
+
+void CEEAssembler::PINTH(unsigned int rd, unsigned int rs, unsigned int rt)
+{
+	(*m_ptr) = ((0x1C) << 26) | (rs << 21) | (rt << 16) | (rd << 11) | ((0x0A) << 6) | (0x09);
+	m_ptr++;
+}
+
+void CEEAssembler::PMADDH(unsigned int rd, unsigned int rs, unsigned int rt)
+{
+	(*m_ptr) = ((0x1C) << 26) | (rs << 21) | (rt << 16) | (rd << 11) | ((0x10) << 6) | (0x09);
+	m_ptr++;
+}
+
+void CEEAssembler::PMADDUW(unsigned int rd, unsigned int rs, unsigned int rt)
+{
+	(*m_ptr) = ((0x1C) << 26) | (rs << 21) | (rt << 16) | (rd << 11) | ((0x00) << 6) | (0x29);
+	m_ptr++;
+}
+
+void CEEAssembler::PMADDW(unsigned int rd, unsigned int rs, unsigned int rt)
+{
+	(*m_ptr) = ((0x1C) << 26) | (rs << 21) | (rt << 16) | (rd << 11) | ((0x00) << 6) | (0x09);
+	m_ptr++;
+}
+
 void CEEAssembler::PMFLO(unsigned int rd)
 {
 	(*m_ptr) = ((0x1C) << 26) | (rd << 11) | ((0x09) << 6) | (0x09);
@@ -101,12 +185,48 @@ void CEEAssembler::PMFHL_LH(unsigned int rd)
 	m_ptr++;
 }
 
+void CEEAssembler::PMFHL_SLW(unsigned int rd)
+{
+	(*m_ptr) = ((0x1C) << 26) | (rd << 11) | ((0x02) << 6) | (0x30);
+	m_ptr++;
+}
+
+void CEEAssembler::PMSUBH(unsigned int rd, unsigned int rs, unsigned int rt)
+{
+	(*m_ptr) = ((0x1C) << 26) | (rs << 21) | (rt << 16) | (rd << 11) | ((0x14) << 6) | (0x09);
+	m_ptr++;
+}
+
+void CEEAssembler::PMSUBW(unsigned int rd, unsigned int rs, unsigned int rt)
+{
+	(*m_ptr) = ((0x1C) << 26) | (rs << 21) | (rt << 16) | (rd << 11) | ((0x04) << 6) | (0x09);
+	m_ptr++;
+}
+
+void CEEAssembler::PMTHL_LW(unsigned int rs)
+{
+	(*m_ptr) = ((0x1C) << 26) | (rs << 21) | ((0x00) << 6) | (0x31);
+	m_ptr++;
+}
+
 void CEEAssembler::PMULTH(unsigned int rd, unsigned int rs, unsigned int rt)
 {
 	(*m_ptr) = ((0x1C) << 26) | (rs << 21) | (rt << 16) | (rd << 11) | ((0x1C) << 6) | (0x09);
 	m_ptr++;
 }
 
+void CEEAssembler::PMULTUW(unsigned int rd, unsigned int rs, unsigned int rt)
+{
+	(*m_ptr) = ((0x1C) << 26) | (rs << 21) | (rt << 16) | (rd << 11) | ((0x0C) << 6) | (0x29);
+	m_ptr++;
+}
+
+void CEEAssembler::PMULTW(unsigned int rd, unsigned int rs, unsigned int rt)
+{
+	(*m_ptr) = ((0x1C) << 26) | (rs << 21) | (rt << 16) | (rd << 11) | ((0x0C) << 6) | (0x09);
+	m_ptr++;
+}
+
 void CEEAssembler::PPACH(unsigned int rd, unsigned int rs, unsigned int rt)
 {
 	(*m_ptr) = ((0x1C) << 26) | (rs << 21) | (rt << 16) | (rd << 11) | ((0x17) << 6) | (0x08);
@@ -119,6 +239,30 @@ void CEEAssembler::PPACW(unsigned int rd, unsigned int rs, unsigned int rt)
 	m_ptr++;
 }
 
+void CEEAssembler::PSLLVW(unsigned int rd, unsigned int rt, unsigned int rs)
+{
+	(*m_ptr) = ((0x1C) << 26) | (rs << 21) | (rt << 16) | (rd << 11) | ((0x02) << 6) | (0x09);
+	m_ptr++;
+}
+
+void CEEAssembler::PSRAVW(unsigned int rd, unsigned int rt, unsigned int rs)
+{
+	(*m_ptr) = ((0x1C) << 26) | (rs << 21) | (rt << 16) | (rd << 11) | ((0x03) << 6) | (0x29);
+	m_ptr++;
+}
+
+void CEEAssembler::PSRLVW(unsigned int rd, unsigned int rt, unsigned int rs)
+{
+	(*m_ptr) = ((0x1C) << 26) | (rs << 21) | (rt << 16) | (rd << 11) | ((0x03) << 6) | (0x09);
+	m_ptr++;
+}
+
+void CEEAssembler::PSUBSB(unsigned int rd, unsigned int rs, unsigned int rt)
+{
+	(*m_ptr) = ((0x1C) << 26) | (rs << 21) | (rt << 16) | (rd << 11) | ((0x19) << 6) | (0x08);
+	m_ptr++;
+}
+
 void CEEAssembler::SQ(unsigned int rt, uint16 offset, unsigned int base)
 {
 	(*m_ptr) = ((0x1F) << 26) | (base << 21) | (rt << 16) | offset;
@@ -8,23 +8,47 @@ public:
 	CEEAssembler(uint32*);
 
 	void LQ(unsigned int, uint16, unsigned int);
+	void MADD(unsigned int, unsigned int, unsigned int);
+	void MADDU(unsigned int, unsigned int, unsigned int);
 	void MFHI1(unsigned int);
 	void MFLO1(unsigned int);
 	void MTHI1(unsigned int);
 	void MTLO1(unsigned int);
+	void PABSH(unsigned int, unsigned int);
+	void PABSW(unsigned int, unsigned int);
 	void PADDW(unsigned int, unsigned int, unsigned int);
+	void PADSBH(unsigned int, unsigned int, unsigned int);
+	void PDIVBW(unsigned int, unsigned int);
+	void PDIVUW(unsigned int, unsigned int);
 	void PEXCH(unsigned int, unsigned int);
+	void PEXEH(unsigned int, unsigned int);
 	void PEXTLB(unsigned int, unsigned int, unsigned int);
 	void PEXTUB(unsigned int, unsigned int, unsigned int);
 	void PEXTLH(unsigned int, unsigned int, unsigned int);
 	void PEXTUH(unsigned int, unsigned int, unsigned int);
 	void PEXCW(unsigned int, unsigned int);
+	void PHMADH(unsigned int, unsigned int, unsigned int);
+	void PHMSBH(unsigned int, unsigned int, unsigned int);
+	void PINTH(unsigned int, unsigned int, unsigned int);
+	void PMADDH(unsigned int, unsigned int, unsigned int);
+	void PMADDUW(unsigned int, unsigned int, unsigned int);
+	void PMADDW(unsigned int, unsigned int, unsigned int);
 	void PMFLO(unsigned int);
 	void PMFHI(unsigned int);
 	void PMFHL_UW(unsigned int);
 	void PMFHL_LH(unsigned int);
+	void PMFHL_SLW(unsigned int);
+	void PMSUBH(unsigned int, unsigned int, unsigned int);
+	void PMSUBW(unsigned int, unsigned int, unsigned int);
+	void PMTHL_LW(unsigned int);
 	void PMULTH(unsigned int, unsigned int, unsigned int);
+	void PMULTUW(unsigned int, unsigned int, unsigned int);
+	void PMULTW(unsigned int, unsigned int, unsigned int);
 	void PPACH(unsigned int, unsigned int, unsigned int);
 	void PPACW(unsigned int, unsigned int, unsigned int);
+	void PSLLVW(unsigned int, unsigned int, unsigned int);
+	void PSRAVW(unsigned int, unsigned int, unsigned int);
+	void PSRLVW(unsigned int, unsigned int, unsigned int);
+	void PSUBSB(unsigned int, unsigned int, unsigned int);
 	void SQ(unsigned int, uint16, unsigned int);
 };
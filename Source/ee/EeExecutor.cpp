@@ -1,3 +1,7 @@
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
 #include "EeExecutor.h"
 #include "../Ps2Const.h"
 #include "AlignedAlloc.h"
@@ -9,6 +13,7 @@
 #if defined(__APPLE__)
 
 #include <TargetConditionals.h>
+#include <thread>
 
 #if TARGET_CPU_ARM
 #define DISABLE_PROTECTION
@@ -30,19 +35,58 @@
 
 #endif
 
-static CEeExecutor* g_eeExecutor = nullptr;
+#define MAX_EE_EXECUTORS 32
+
+//Every VM has its own executor, access faults are given to the one that owns the faulting address.
+//Slots are only changed with atomic operations since they are read from fault handlers.
+static std::atomic<CEeExecutor*> g_eeExecutors[MAX_EE_EXECUTORS];
+
+#if defined(__APPLE__)
+
+//EE RAM can be written by threads other than the emulation thread (ie.: GS thread reading back
+//image data), the exception port is thus installed for the whole task and shared by all executors.
+struct SAVED_EXCEPTION_PORTS
+{
+	mach_msg_type_number_t count = 0;
+	exception_mask_t masks[EXC_TYPES_COUNT];
+	mach_port_t ports[EXC_TYPES_COUNT];
+	exception_behavior_t behaviors[EXC_TYPES_COUNT];
+	thread_state_flavor_t flavors[EXC_TYPES_COUNT];
+};
+
+static std::mutex g_exceptionPortMutex;
+static unsigned int g_exceptionPortUserCount = 0;
+static mach_port_t g_exceptionPort = MACH_PORT_NULL;
+static SAVED_EXCEPTION_PORTS g_savedExceptionPorts;
+static std::thread g_exceptionHandlerThread;
+static std::atomic<bool> g_exceptionHandlerRunning(false);
+
+#endif
 
 CEeExecutor::CEeExecutor(CMIPS& context, uint8* ram)
     : CGenericMipsExecutor(context, 0x20000000)
     , m_ram(ram)
 {
 	m_pageSize = framework_getpagesize();
+	m_codePages.resize(PS2::EE_RAM_SIZE / m_pageSize);
 }
 
 void CEeExecutor::AddExceptionHandler()
 {
-	assert(g_eeExecutor == nullptr);
-	g_eeExecutor = this;
+	bool registered = false;
+	for(auto& executorSlot : g_eeExecutors)
+	{
+		CEeExecutor* emptySlot = nullptr;
+		if(executorSlot.compare_exchange_strong(emptySlot, this))
+		{
+			registered = true;
+			break;
+		}
+	}
+	if(!registered)
+	{
+		throw std::runtime_error("Too many EE executors running at the same time.");
+	}
 
 #ifdef DISABLE_PROTECTION
 	return;
@@ -60,19 +104,25 @@ void CEeExecutor::AddExceptionHandler()
 	int result = sigaction(SIGSEGV, &sigAction, nullptr);
 	assert(result >= 0);
 #elif defined(__APPLE__)
-	kern_return_t result = mach_port_allocate(mach_task_self(), MACH_PORT_RIGHT_RECEIVE, &m_port);
+	std::lock_guard<std::mutex> exceptionPortLock(g_exceptionPortMutex);
+	if(g_exceptionPortUserCount++ != 0) return;
+
+	kern_return_t result = mach_port_allocate(mach_task_self(), MACH_PORT_RIGHT_RECEIVE, &g_exceptionPort);
 	assert(result == KERN_SUCCESS);
 
-	m_running = true;
-	m_handlerThread = std::thread([this]() { HandlerThreadProc(); });
+	g_exceptionHandlerRunning = true;
+	g_exceptionHandlerThread = std::thread(&CEeExecutor::HandlerThreadProc);
 
-	result = mach_port_insert_right(mach_task_self(), m_port, m_port, MACH_MSG_TYPE_MAKE_SEND);
+	result = mach_port_insert_right(mach_task_self(), g_exceptionPort, g_exceptionPort, MACH_MSG_TYPE_MAKE_SEND);
 	assert(result == KERN_SUCCESS);
 
-	result = thread_set_exception_ports(mach_thread_self(), EXC_MASK_BAD_ACCESS, m_port, EXCEPTION_STATE | MACH_EXCEPTION_CODES, STATE_FLAVOR);
+	g_savedExceptionPorts.count = EXC_TYPES_COUNT;
+	result = task_swap_exception_ports(mach_task_self(), EXC_MASK_BAD_ACCESS, g_exceptionPort, EXCEPTION_STATE | MACH_EXCEPTION_CODES, STATE_FLAVOR,
+	                                   g_savedExceptionPorts.masks, &g_savedExceptionPorts.count, g_savedExceptionPorts.ports,
+	                                   g_savedExceptionPorts.behaviors, g_savedExceptionPorts.flavors);
 	assert(result == KERN_SUCCESS);
 
-	result = mach_port_mod_refs(mach_task_self(), m_port, MACH_PORT_RIGHT_SEND, -1);
+	result = mach_port_mod_refs(mach_task_self(), g_exceptionPort, MACH_PORT_RIGHT_SEND, -1);
 	assert(result == KERN_SUCCESS);
 #endif
 }
@@ -84,18 +134,42 @@ void CEeExecutor::RemoveExceptionHandler()
 #if defined(_WIN32)
 	RemoveVectoredExceptionHandler(m_handler);
 #elif defined(__APPLE__)
-	m_running = false;
-	m_handlerThread.join();
+	{
+		std::lock_guard<std::mutex> exceptionPortLock(g_exceptionPortMutex);
+		assert(g_exceptionPortUserCount != 0);
+		if(--g_exceptionPortUserCount == 0)
+		{
+			for(mach_msg_type_number_t i = 0; i < g_savedExceptionPorts.count; i++)
+			{
+				task_set_exception_ports(mach_task_self(), g_savedExceptionPorts.masks[i], g_savedExceptionPorts.ports[i],
+				                         g_savedExceptionPorts.behaviors[i], g_savedExceptionPorts.flavors[i]);
+			}
+			g_savedExceptionPorts.count = 0;
+
+			g_exceptionHandlerRunning = false;
+			g_exceptionHandlerThread.join();
+
+			mach_port_mod_refs(mach_task_self(), g_exceptionPort, MACH_PORT_RIGHT_RECEIVE, -1);
+			g_exceptionPort = MACH_PORT_NULL;
+		}
+	}
 #endif
 
 #endif //!DISABLE_PROTECTION
 
-	g_eeExecutor = nullptr;
+	for(auto& executorSlot : g_eeExecutors)
+	{
+		CEeExecutor* registeredExecutor = this;
+		executorSlot.compare_exchange_strong(registeredExecutor, nullptr);
+	}
 }
 
 void CEeExecutor::Reset()
 {
 	SetMemoryProtected(m_ram, PS2::EE_RAM_SIZE, false);
+	SetPageRangeState(m_codePages, 0, PS2::EE_RAM_SIZE, 0);
+	//We won't be notified of writes anymore, assume everything changed
+	MarkPagesDirty(0, PS2::EE_RAM_SIZE);
 	CGenericMipsExecutor::Reset();
 }
 
@@ -103,6 +177,8 @@ void CEeExecutor::ClearActiveBlocksInRange(uint32 start, uint32 end, bool execut
 {
 	uint32 rangeSize = end - start;
 	SetMemoryProtected(m_ram + start, rangeSize, false);
+	SetPageRangeState(m_codePages, start, end, 0);
+	MarkPagesDirty(start, end);
 	CGenericMipsExecutor::ClearActiveBlocksInRange(start, end, executing);
 }
 
@@ -114,22 +190,106 @@ BasicBlockPtr CEeExecutor::BlockFactory(CMIPS& context, uint32 start, uint32 end
 	if(start >= 0x100000 && start < PS2::EE_RAM_SIZE)
 	{
 		SetMemoryProtected(m_ram + start, end - start + 4, true);
+		SetPageRangeState(m_codePages, start, end + 4, 1);
 	}
 	return CGenericMipsExecutor::BlockFactory(context, start, end);
 }
 
+size_t CEeExecutor::GetPageSize() const
+{
+	return m_pageSize;
+}
+
+bool CEeExecutor::CollectDirtyPages(unsigned int trackerIndex, PageBitmap& dirtyPages)
+{
+#ifdef DISABLE_PROTECTION
+	return false;
+#else
+	assert(trackerIndex < MAX_DIRTY_PAGE_TRACKERS);
+	size_t pageCount = PS2::EE_RAM_SIZE / m_pageSize;
+	auto& trackerDirtyPages = m_dirtyPages[trackerIndex];
+	if(!trackerDirtyPages.empty())
+	{
+		dirtyPages = trackerDirtyPages;
+	}
+	else
+	{
+		dirtyPages.assign(pageCount, 1);
+	}
+	trackerDirtyPages.assign(pageCount, 0);
+	m_dirtyPageTracking = true;
+	//Protect everything, first write to any page will be caught by HandleAccessFault.
+	//Writes done by the kernel (ie.: read syscalls) don't fault, host I/O must go through a staging buffer.
+	SetMemoryProtected(m_ram, PS2::EE_RAM_SIZE, true);
+	return true;
+#endif
+}
+
+bool CEeExecutor::HasDirtyPages(unsigned int trackerIndex, uint32 start, uint32 end) const
+{
+	assert(trackerIndex < MAX_DIRTY_PAGE_TRACKERS);
+	const auto& trackerDirtyPages = m_dirtyPages[trackerIndex];
+	//Tracker was never collected, we can't know
+	if(trackerDirtyPages.empty()) return true;
+	end = std::min<uint32>(end, PS2::EE_RAM_SIZE);
+	if(start >= end) return false;
+	auto firstPage = trackerDirtyPages.begin() + (start / m_pageSize);
+	auto lastPage = trackerDirtyPages.begin() + ((end - 1) / m_pageSize);
+	return std::find(firstPage, lastPage + 1, 1) != (lastPage + 1);
+}
+
 bool CEeExecutor::HandleAccessFault(intptr_t ptr)
 {
 	ptrdiff_t addr = reinterpret_cast<uint8*>(ptr) - m_ram;
 	if(addr >= 0 && addr < PS2::EE_RAM_SIZE)
 	{
 		addr &= ~(m_pageSize - 1);
+		size_t pageIndex = addr / m_pageSize;
+		if(m_dirtyPageTracking && !m_codePages[pageIndex])
+		{
+			//Page was only protected to track writes, no code to invalidate
+			MarkPagesDirty(addr, addr + m_pageSize);
+			SetMemoryProtected(m_ram + addr, m_pageSize, false);
+			return true;
+		}
 		ClearActiveBlocksInRange(addr, addr + m_pageSize, true);
 		return true;
 	}
 	return false;
 }
 
+bool CEeExecutor::DispatchAccessFault(intptr_t ptr)
+{
+	for(auto& executorSlot : g_eeExecutors)
+	{
+		auto executor = executorSlot.load();
+		if(executor && executor->HandleAccessFault(ptr))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void CEeExecutor::MarkPagesDirty(uint32 start, uint32 end)
+{
+	if(!m_dirtyPageTracking) return;
+	for(auto& trackerDirtyPages : m_dirtyPages)
+	{
+		SetPageRangeState(trackerDirtyPages, start, end, 1);
+	}
+}
+
+void CEeExecutor::SetPageRangeState(PageBitmap& pages, uint32 start, uint32 end, uint8 state)
+{
+	if(pages.empty()) return;
+	end = std::min<uint32>(end, PS2::EE_RAM_SIZE);
+	if(start >= end) return;
+	size_t firstPage = start / m_pageSize;
+	size_t lastPage = (end - 1) / m_pageSize;
+	std::fill(pages.begin() + firstPage, pages.begin() + lastPage + 1, state);
+}
+
 void CEeExecutor::SetMemoryProtected(void* addr, size_t size, bool protect)
 {
 #ifdef DISABLE_PROTECTION
@@ -154,16 +314,11 @@ void CEeExecutor::SetMemoryProtected(void* addr, size_t size, bool protect)
 #if defined(_WIN32)
 
 LONG WINAPI CEeExecutor::HandleException(_EXCEPTION_POINTERS* exceptionInfo)
-{
-	return g_eeExecutor->HandleExceptionInternal(exceptionInfo);
-}
-
-LONG CEeExecutor::HandleExceptionInternal(_EXCEPTION_POINTERS* exceptionInfo)
 {
 	auto exceptionRecord = exceptionInfo->ExceptionRecord;
 	if(exceptionRecord->ExceptionCode == EXCEPTION_ACCESS_VIOLATION)
 	{
-		if(HandleAccessFault(exceptionRecord->ExceptionInformation[1]))
+		if(DispatchAccessFault(exceptionRecord->ExceptionInformation[1]))
 		{
 			return EXCEPTION_CONTINUE_EXECUTION;
 		}
@@ -173,15 +328,10 @@ LONG CEeExecutor::HandleExceptionInternal(_EXCEPTION_POINTERS* exceptionInfo)
 
 #elif defined(__unix__) || defined(__ANDROID__)
 
-void CEeExecutor::HandleException(int sigId, siginfo_t* sigInfo, void* baseContext)
-{
-	g_eeExecutor->HandleExceptionInternal(sigId, sigInfo, baseContext);
-}
-
-void CEeExecutor::HandleExceptionInternal(int sigId, siginfo_t* sigInfo, void* baseContext)
+void CEeExecutor::HandleException(int sigId, siginfo_t* sigInfo, void*)
 {
 	if(sigId != SIGSEGV) return;
-	if(HandleAccessFault(reinterpret_cast<intptr_t>(sigInfo->si_addr)))
+	if(DispatchAccessFault(reinterpret_cast<intptr_t>(sigInfo->si_addr)))
 	{
 		return;
 	}
@@ -216,18 +366,18 @@ void CEeExecutor::HandlerThreadProc()
 	};
 #pragma pack(pop)
 
-	while(m_running)
+	while(g_exceptionHandlerRunning)
 	{
 		kern_return_t result = KERN_SUCCESS;
 
 		INPUT_MESSAGE inMsg;
-		result = mach_msg(&inMsg.head, MACH_RCV_MSG | MACH_RCV_LARGE | MACH_RCV_TIMEOUT, 0, sizeof(inMsg), m_port, 1000, MACH_PORT_NULL);
+		result = mach_msg(&inMsg.head, MACH_RCV_MSG | MACH_RCV_LARGE | MACH_RCV_TIMEOUT, 0, sizeof(inMsg), g_exceptionPort, 1000, MACH_PORT_NULL);
 		if(result == MACH_RCV_TIMED_OUT) continue;
 		assert(result == KERN_SUCCESS);
 
 		assert(inMsg.head.msgh_id == 2406); //MACH_EXCEPTION_RAISE_RPC
 
-		bool success = HandleAccessFault(inMsg.code[1]);
+		bool success = DispatchAccessFault(inMsg.code[1]);
 
 		OUTPUT_MESSAGE outMsg;
 		outMsg.head.msgh_bits = MACH_MSGH_BITS(MACH_MSGH_BITS_REMOTE(inMsg.head.msgh_bits), 0);
@@ -4,16 +4,24 @@
 #include <Windows.h>
 #elif defined(__APPLE__)
 #include <mach/mach.h>
-#include <thread>
 #elif defined(__unix__)
 #include <signal.h>
 #endif
 
+#include <array>
+#include <vector>
 #include "../GenericMipsExecutor.h"
 
 class CEeExecutor : public CGenericMipsExecutor<BlockLookupTwoWay>
 {
 public:
+	typedef std::vector<uint8> PageBitmap;
+
+	enum
+	{
+		MAX_DIRTY_PAGE_TRACKERS = 3,
+	};
+
 	CEeExecutor(CMIPS&, uint8*);
 	virtual ~CEeExecutor() = default;
 
@@ -25,26 +33,36 @@ public:
 
 	BasicBlockPtr BlockFactory(CMIPS&, uint32, uint32) override;
 
+	size_t GetPageSize() const;
+	bool CollectDirtyPages(unsigned int, PageBitmap&);
+
+	//Checks if a range was written to since the tracker's last call to CollectDirtyPages
+	bool HasDirtyPages(unsigned int, uint32, uint32) const;
+
 private:
 	uint8* m_ram = nullptr;
 	size_t m_pageSize = 0;
 
+	//Pages protected because they contain code
+	PageBitmap m_codePages;
+
+	//Pages written to since the last call to CollectDirtyPages, for each tracker
+	bool m_dirtyPageTracking = false;
+	std::array<PageBitmap, MAX_DIRTY_PAGE_TRACKERS> m_dirtyPages;
+
+	static bool DispatchAccessFault(intptr_t);
 	bool HandleAccessFault(intptr_t);
 	void SetMemoryProtected(void*, size_t, bool);
+	void SetPageRangeState(PageBitmap&, uint32, uint32, uint8);
+	void MarkPagesDirty(uint32, uint32);
 
 #if defined(_WIN32)
 	static LONG CALLBACK HandleException(_EXCEPTION_POINTERS*);
-	LONG HandleExceptionInternal(_EXCEPTION_POINTERS*);
 
 	LPVOID m_handler = NULL;
 #elif defined(__unix__) || defined(__ANDROID__)
 	static void HandleException(int, siginfo_t*, void*);
-	void HandleExceptionInternal(int, siginfo_t*, void*);
 #elif defined(__APPLE__)
-	void HandlerThreadProc();
-
-	mach_port_t m_port = MACH_PORT_NULL;
-	std::thread m_handlerThread;
-	std::atomic<bool> m_running;
+	static void HandlerThreadProc();
 #endif
 };
@@ -38,6 +38,7 @@ CSubSystem::CSubSystem(uint8* iopRam, CIopBios& iopBios)
     , m_VU1(MEMORYMAP_ENDIAN_LSBF)
     , m_dmac(m_ram, m_spr, m_vuMem0, m_EE)
     , m_gif(m_gs, m_ram, m_spr)
+    , m_gifReplayCache(m_gif, m_ram)
     , m_sif(m_dmac, m_ram, iopRam)
     , m_intc(m_dmac)
     , m_ipu(m_intc)
@@ -150,6 +151,9 @@ CSubSystem::CSubSystem(uint8* iopRam, CIopBios& iopBios)
 	m_dmac.SetChannelTransferFunction(CDMAC::CHANNEL_ID_SIF0, std::bind(&CSIF::ReceiveDMA5, &m_sif, PLACEHOLDER_1, PLACEHOLDER_2, PLACEHOLDER_3, PLACEHOLDER_4));
 	m_dmac.SetChannelTransferFunction(CDMAC::CHANNEL_ID_SIF1, std::bind(&CSIF::ReceiveDMA6, &m_sif, PLACEHOLDER_1, PLACEHOLDER_2, PLACEHOLDER_3, PLACEHOLDER_4));
 
+	m_dmac.SetChannelSourceChainCache(CDMAC::CHANNEL_ID_GIF, &m_gifReplayCache);
+	m_gif.SetReplayCache(&m_gifReplayCache);
+
 	m_ipu.SetDMA3ReceiveHandler(std::bind(&CDMAC::ResumeDMA3, &m_dmac, PLACEHOLDER_1, PLACEHOLDER_2));
 
 	m_os = new CPS2OS(m_EE, m_ram, m_bios, m_spr, m_gs, m_sif, iopBios);
@@ -212,6 +216,7 @@ void CSubSystem::Reset()
 	m_sif.Reset();
 	m_ipu.Reset();
 	m_gif.Reset();
+	m_gifReplayCache.Reset();
 	m_vpu0->Reset();
 	m_vpu1->Reset();
 	m_dmac.Reset();
@@ -334,6 +339,8 @@ void CSubSystem::CountTicks(int ticks)
 
 void CSubSystem::NotifyVBlankStart()
 {
+	m_sif.EndFrame();
+	m_gifReplayCache.EndFrame();
 	m_timer.NotifyVBlankStart();
 	m_intc.AssertLine(CINTC::INTC_LINE_VBLANK_START);
 	if(m_os->CheckVBlankFlag())
@@ -350,17 +357,17 @@ void CSubSystem::NotifyVBlankEnd()
 	m_intc.AssertLine(CINTC::INTC_LINE_VBLANK_END);
 }
 
-void CSubSystem::SaveState(Framework::CZipArchiveWriter& archive)
+void CSubSystem::SaveState(Framework::CZipArchiveWriter& archive, CMemoryStateTracker* memoryTracker)
 {
 	archive.InsertFile(new CMemoryStateFile(STATE_EE, &m_EE.m_State, sizeof(MIPSSTATE)));
 	archive.InsertFile(new CMemoryStateFile(STATE_VU0, &m_VU0.m_State, sizeof(MIPSSTATE)));
 	archive.InsertFile(new CMemoryStateFile(STATE_VU1, &m_VU1.m_State, sizeof(MIPSSTATE)));
-	archive.InsertFile(new CMemoryStateFile(STATE_RAM, m_ram, PS2::EE_RAM_SIZE));
-	archive.InsertFile(new CMemoryStateFile(STATE_SPR, m_spr, PS2::EE_SPR_SIZE));
-	archive.InsertFile(new CMemoryStateFile(STATE_VUMEM0, m_vuMem0, PS2::VUMEM0SIZE));
-	archive.InsertFile(new CMemoryStateFile(STATE_MICROMEM0, m_microMem0, PS2::MICROMEM0SIZE));
-	archive.InsertFile(new CMemoryStateFile(STATE_VUMEM1, m_vuMem1, PS2::VUMEM1SIZE));
-	archive.InsertFile(new CMemoryStateFile(STATE_MICROMEM1, m_microMem1, PS2::MICROMEM1SIZE));
+	CMemoryStateTracker::SaveMemory(archive, memoryTracker, STATE_RAM, m_ram, PS2::EE_RAM_SIZE);
+	CMemoryStateTracker::SaveMemory(archive, memoryTracker, STATE_SPR, m_spr, PS2::EE_SPR_SIZE);
+	CMemoryStateTracker::SaveMemory(archive, memoryTracker, STATE_VUMEM0, m_vuMem0, PS2::VUMEM0SIZE);
+	CMemoryStateTracker::SaveMemory(archive, memoryTracker, STATE_MICROMEM0, m_microMem0, PS2::MICROMEM0SIZE);
+	CMemoryStateTracker::SaveMemory(archive, memoryTracker, STATE_VUMEM1, m_vuMem1, PS2::VUMEM1SIZE);
+	CMemoryStateTracker::SaveMemory(archive, memoryTracker, STATE_MICROMEM1, m_microMem1, PS2::MICROMEM1SIZE);
 
 	m_dmac.SaveState(archive);
 	m_intc.SaveState(archive);
@@ -371,19 +378,19 @@ void CSubSystem::SaveState(Framework::CZipArchiveWriter& archive)
 	m_gif.SaveState(archive);
 }
 
-void CSubSystem::LoadState(Framework::CZipArchiveReader& archive)
+void CSubSystem::LoadState(Framework::CZipArchiveReader& archive, CMemoryStateTracker* memoryTracker)
 {
 	m_EE.m_executor->Reset();
 
 	archive.BeginReadFile(STATE_EE)->Read(&m_EE.m_State, sizeof(MIPSSTATE));
 	archive.BeginReadFile(STATE_VU0)->Read(&m_VU0.m_State, sizeof(MIPSSTATE));
 	archive.BeginReadFile(STATE_VU1)->Read(&m_VU1.m_State, sizeof(MIPSSTATE));
-	archive.BeginReadFile(STATE_RAM)->Read(m_ram, PS2::EE_RAM_SIZE);
-	archive.BeginReadFile(STATE_SPR)->Read(m_spr, PS2::EE_SPR_SIZE);
-	archive.BeginReadFile(STATE_VUMEM0)->Read(m_vuMem0, PS2::VUMEM0SIZE);
-	archive.BeginReadFile(STATE_MICROMEM0)->Read(m_microMem0, PS2::MICROMEM0SIZE);
-	archive.BeginReadFile(STATE_VUMEM1)->Read(m_vuMem1, PS2::VUMEM1SIZE);
-	archive.BeginReadFile(STATE_MICROMEM1)->Read(m_microMem1, PS2::MICROMEM1SIZE);
+	CMemoryStateTracker::LoadMemory(archive, memoryTracker, STATE_RAM, m_ram, PS2::EE_RAM_SIZE);
+	CMemoryStateTracker::LoadMemory(archive, memoryTracker, STATE_SPR, m_spr, PS2::EE_SPR_SIZE);
+	CMemoryStateTracker::LoadMemory(archive, memoryTracker, STATE_VUMEM0, m_vuMem0, PS2::VUMEM0SIZE);
+	CMemoryStateTracker::LoadMemory(archive, memoryTracker, STATE_MICROMEM0, m_microMem0, PS2::MICROMEM0SIZE);
+	CMemoryStateTracker::LoadMemory(archive, memoryTracker, STATE_VUMEM1, m_vuMem1, PS2::VUMEM1SIZE);
+	CMemoryStateTracker::LoadMemory(archive, memoryTracker, STATE_MICROMEM1, m_microMem1, PS2::MICROMEM1SIZE);
 
 	m_dmac.LoadState(archive);
 	m_intc.LoadState(archive);
@@ -392,6 +399,7 @@ void CSubSystem::LoadState(Framework::CZipArchiveReader& archive)
 	m_vpu1->LoadState(archive);
 	m_timer.LoadState(archive);
 	m_gif.LoadState(archive);
+	m_gifReplayCache.Reset();
 }
 
 void CSubSystem::SetupEePageTable()
@@ -5,6 +5,7 @@
 #include "../COP_FPU.h"
 #include "DMAC.h"
 #include "GIF.h"
+#include "GifReplayCache.h"
 #include "SIF.h"
 #include "Vpu.h"
 #include "IPU.h"
@@ -35,8 +36,8 @@ namespace Ee
 		void NotifyVBlankStart();
 		void NotifyVBlankEnd();
 
-		void SaveState(Framework::CZipArchiveWriter&);
-		void LoadState(Framework::CZipArchiveReader&);
+		void SaveState(Framework::CZipArchiveWriter&, CMemoryStateTracker* = nullptr);
+		void LoadState(Framework::CZipArchiveReader&, CMemoryStateTracker* = nullptr);
 
 		void SetVpu0(std::shared_ptr<CVpu>);
 		void SetVpu1(std::shared_ptr<CVpu>);
@@ -55,6 +56,7 @@ namespace Ee
 		CGSHandler* m_gs = nullptr;
 		CDMAC m_dmac;
 		CGIF m_gif;
+		CGifReplayCache m_gifReplayCache;
 		CSIF m_sif;
 		std::shared_ptr<CVpu> m_vpu0;
 		std::shared_ptr<CVpu> m_vpu1;
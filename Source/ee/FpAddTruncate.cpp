@@ -34,6 +34,10 @@ static inline int rep_clz(rep_t a)
 
 uint32 FpAddTruncate(uint32 a, uint32 b)
 {
+	//Denormals are treated as zero by the VU
+	if((a & exponentMask) == 0) a &= signBit;
+	if((b & exponentMask) == 0) b &= signBit;
+
 	const rep_t aAbs = a & absMask;
 	const rep_t bAbs = b & absMask;
 
@@ -149,8 +153,9 @@ uint32 FpAddTruncate(uint32 a, uint32 b)
 		}
 	}
 
-	// If we have overflowed the type, return +/- infinity:
-	if(aExponent >= maxExponent) return infRep | resultSign;
+	// If we have overflowed the type, return the largest finite value, like
+	// other operations computed on the host when rounding toward zero.
+	if(aExponent >= maxExponent) return (infRep - 1U) | resultSign;
 
 	if(aExponent <= 0)
 	{
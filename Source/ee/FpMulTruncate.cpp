@@ -70,7 +70,8 @@ static void wideRightShiftWithSticky(rep_t* hi, rep_t* lo, int count)
 	}
 	else if(count < 2 * typeWidth)
 	{
-		const bool sticky = *hi << (2 * typeWidth - count) | *lo;
+		//Shifting by the type's width is undefined, all of hi is kept when count is typeWidth
+		const bool sticky = ((count != typeWidth) && (*hi << (2 * typeWidth - count))) || *lo;
 		*lo = *hi >> (count - typeWidth) | sticky;
 		*hi = 0;
 	}
@@ -6,6 +6,7 @@
 #include "../FrameDump.h"
 #include "../states/RegisterStateFile.h"
 #include "GIF.h"
+#include "GifReplayCache.h"
 
 #define QTEMP_INIT (0x3F800000)
 
@@ -74,7 +75,7 @@ void CGIF::SaveState(Framework::CZipArchiveWriter& archive)
 	archive.InsertFile(registerFile);
 }
 
-uint32 CGIF::ProcessPacked(CGSHandler::RegisterWriteList& writeList, const uint8* memory, uint32 address, uint32 end)
+uint32 CGIF::ProcessPacked(CGsRegisterWriteBuffer& writeBuffer, const uint8* memory, uint32 address, uint32 end)
 {
 	uint32 start = address;
 
@@ -91,7 +92,7 @@ uint32 CGIF::ProcessPacked(CGSHandler::RegisterWriteList& writeList, const uint8
 			{
 			case 0x00:
 				//PRIM
-				writeList.push_back(CGSHandler::RegisterWrite(GS_REG_PRIM, packet.nV0));
+				writeBuffer.Push(GS_REG_PRIM, packet.nV0);
 				break;
 			case 0x01:
 				//RGBA
@@ -100,18 +101,18 @@ uint32 CGIF::ProcessPacked(CGSHandler::RegisterWriteList& writeList, const uint8
 				temp |= (packet.nV[2] & 0xFF) << 16;
 				temp |= (packet.nV[3] & 0xFF) << 24;
 				temp |= ((uint64)m_qtemp << 32);
-				writeList.push_back(CGSHandler::RegisterWrite(GS_REG_RGBAQ, temp));
+				writeBuffer.Push(GS_REG_RGBAQ, temp);
 				break;
 			case 0x02:
 				//ST
 				m_qtemp = packet.nV2;
-				writeList.push_back(CGSHandler::RegisterWrite(GS_REG_ST, packet.nD0));
+				writeBuffer.Push(GS_REG_ST, packet.nD0);
 				break;
 			case 0x03:
 				//UV
 				temp = (packet.nV[0] & 0x7FFF);
 				temp |= (packet.nV[1] & 0x7FFF) << 16;
-				writeList.push_back(CGSHandler::RegisterWrite(GS_REG_UV, temp));
+				writeBuffer.Push(GS_REG_UV, temp);
 				break;
 			case 0x04:
 				//XYZF2
@@ -121,11 +122,11 @@ uint32 CGIF::ProcessPacked(CGSHandler::RegisterWriteList& writeList, const uint8
 				temp |= (uint64)(packet.nV[3] & 0x00000FF0) << 52;
 				if(packet.nV[3] & 0x8000)
 				{
-					writeList.push_back(CGSHandler::RegisterWrite(GS_REG_XYZF3, temp));
+					writeBuffer.Push(GS_REG_XYZF3, temp);
 				}
 				else
 				{
-					writeList.push_back(CGSHandler::RegisterWrite(GS_REG_XYZF2, temp));
+					writeBuffer.Push(GS_REG_XYZF2, temp);
 				}
 				break;
 			case 0x05:
@@ -135,36 +136,36 @@ uint32 CGIF::ProcessPacked(CGSHandler::RegisterWriteList& writeList, const uint8
 				temp |= (uint64)(packet.nV[2] & 0xFFFFFFFF) << 32;
 				if(packet.nV[3] & 0x8000)
 				{
-					writeList.push_back(CGSHandler::RegisterWrite(GS_REG_XYZ3, temp));
+					writeBuffer.Push(GS_REG_XYZ3, temp);
 				}
 				else
 				{
-					writeList.push_back(CGSHandler::RegisterWrite(GS_REG_XYZ2, temp));
+					writeBuffer.Push(GS_REG_XYZ2, temp);
 				}
 				break;
 			case 0x06:
 				//TEX0_1
-				writeList.push_back(CGSHandler::RegisterWrite(GS_REG_TEX0_1, packet.nD0));
+				writeBuffer.Push(GS_REG_TEX0_1, packet.nD0);
 				break;
 			case 0x07:
 				//TEX0_2
-				writeList.push_back(CGSHandler::RegisterWrite(GS_REG_TEX0_2, packet.nD0));
+				writeBuffer.Push(GS_REG_TEX0_2, packet.nD0);
 				break;
 			case 0x08:
 				//CLAMP_1
-				writeList.push_back(CGSHandler::RegisterWrite(GS_REG_CLAMP_1, packet.nD0));
+				writeBuffer.Push(GS_REG_CLAMP_1, packet.nD0);
 				break;
 			case 0x09:
 				//CLAMP_2
-				writeList.push_back(CGSHandler::RegisterWrite(GS_REG_CLAMP_2, packet.nD0));
+				writeBuffer.Push(GS_REG_CLAMP_2, packet.nD0);
 				break;
 			case 0x0A:
 				//FOG
-				writeList.push_back(CGSHandler::RegisterWrite(GS_REG_FOG, (packet.nD1 >> 36) << 56));
+				writeBuffer.Push(GS_REG_FOG, (packet.nD1 >> 36) << 56);
 				break;
 			case 0x0D:
 				//XYZ3
-				writeList.push_back(CGSHandler::RegisterWrite(GS_REG_XYZ3, packet.nD0));
+				writeBuffer.Push(GS_REG_XYZ3, packet.nD0);
 				break;
 			case 0x0E:
 				//A + D
@@ -172,6 +173,12 @@ uint32 CGIF::ProcessPacked(CGSHandler::RegisterWriteList& writeList, const uint8
 					uint8 reg = static_cast<uint8>(packet.nD1);
 					if(reg == GS_REG_SIGNAL)
 					{
+						//Outcome depends on the GS state at the time it's processed, can't be replayed
+						if(m_replayCache)
+						{
+							m_replayCache->CancelRecording();
+						}
+
 						//Check if there's already a signal pending
 						auto csr = m_gs->ReadPrivRegister(CGSHandler::GS_CSR);
 						if((m_signalState == SIGNAL_STATE_ENCOUNTERED) || ((csr & CGSHandler::CSR_SIGNAL_EVENT) != 0))
@@ -182,7 +189,7 @@ uint32 CGIF::ProcessPacked(CGSHandler::RegisterWriteList& writeList, const uint8
 						}
 						m_signalState = SIGNAL_STATE_ENCOUNTERED;
 					}
-					writeList.push_back(CGSHandler::RegisterWrite(reg, packet.nD0));
+					writeBuffer.Push(reg, packet.nD0);
 				}
 				break;
 			case 0x0F:
@@ -207,7 +214,7 @@ uint32 CGIF::ProcessPacked(CGSHandler::RegisterWriteList& writeList, const uint8
 	return address - start;
 }
 
-uint32 CGIF::ProcessRegList(CGSHandler::RegisterWriteList& writeList, const uint8* memory, uint32 address, uint32 end)
+uint32 CGIF::ProcessRegList(CGsRegisterWriteBuffer& writeBuffer, const uint8* memory, uint32 address, uint32 end)
 {
 	uint32 start = address;
 
@@ -231,7 +238,7 @@ uint32 CGIF::ProcessRegList(CGSHandler::RegisterWriteList& writeList, const uint
 
 			if(nRegDesc == 0x0F) continue;
 
-			writeList.push_back(CGSHandler::RegisterWrite(static_cast<uint8>(nRegDesc), packet.nD0));
+			writeBuffer.Push(static_cast<uint8>(nRegDesc), packet.nD0);
 		}
 
 		m_loops--;
@@ -250,25 +257,46 @@ uint32 CGIF::ProcessImage(const uint8* memory, uint32 address, uint32 end)
 {
 	uint16 totalLoops = static_cast<uint16>((end - address) / 0x10);
 	totalLoops = std::min<uint16>(totalLoops, m_loops);
+	if(m_replayCache && m_replayCache->IsRecording())
+	{
+		if(memory == m_ram)
+		{
+			m_replayCache->RecordImageData(address, totalLoops * 0x10);
+		}
+		else
+		{
+			m_replayCache->CancelRecording();
+		}
+	}
 	m_gs->FeedImageData(memory + address, totalLoops * 0x10);
 	m_loops -= totalLoops;
 
 	return (totalLoops * 0x10);
 }
 
-uint32 CGIF::ProcessSinglePacket(const uint8* memory, uint32 address, uint32 end, const CGsPacketMetadata& packetMetadata)
+CGsRegisterWriteBuffer& CGIF::GetWriteBuffer()
+{
+	if(!m_writeBuffer)
+	{
+		m_writeBuffer = m_gs->AcquireRegisterWriteBuffer();
+	}
+	return *m_writeBuffer;
+}
+
+void CGIF::FlushWriteBuffer(const CGsPacketMetadata& packetMetadata)
 {
-	static CGSHandler::RegisterWriteList writeList;
-	static const auto flushWriteList =
-	    [](CGSHandler* gs, const CGsPacketMetadata& packetMetadata) {
-		    if(!writeList.empty())
-		    {
-			    auto currentCapacity = writeList.capacity();
-			    gs->WriteRegisterMassively(std::move(writeList), &packetMetadata);
-			    writeList.reserve(currentCapacity);
-		    }
-	    };
+	if(m_writeBuffer && !m_writeBuffer->IsEmpty())
+	{
+		if(m_replayCache && m_replayCache->IsRecording())
+		{
+			m_replayCache->RecordRegisterWrites(*m_writeBuffer);
+		}
+		m_gs->WriteRegisterMassively(std::move(m_writeBuffer), &packetMetadata);
+	}
+}
 
+uint32 CGIF::ProcessSinglePacket(const uint8* memory, uint32 address, uint32 end, const CGsPacketMetadata& packetMetadata)
+{
 #ifdef PROFILE
 	CProfilerZone profilerZone(m_gifProfilerZone);
 #endif
@@ -280,7 +308,6 @@ uint32 CGIF::ProcessSinglePacket(const uint8* memory, uint32 address, uint32 end
 
 	assert((m_activePath == 0) || (m_activePath == packetMetadata.pathIndex));
 	m_signalState = SIGNAL_STATE_NONE;
-	writeList.clear();
 
 	uint32 start = address;
 	while(address < end)
@@ -313,7 +340,7 @@ uint32 CGIF::ProcessSinglePacket(const uint8* memory, uint32 address, uint32 end
 			{
 				if(tag.pre != 0)
 				{
-					writeList.push_back(CGSHandler::RegisterWrite(GS_REG_PRIM, static_cast<uint64>(tag.prim)));
+					GetWriteBuffer().Push(GS_REG_PRIM, static_cast<uint64>(tag.prim));
 				}
 			}
 
@@ -325,17 +352,17 @@ uint32 CGIF::ProcessSinglePacket(const uint8* memory, uint32 address, uint32 end
 		switch(m_cmd)
 		{
 		case 0x00:
-			address += ProcessPacked(writeList, memory, address, end);
+			address += ProcessPacked(GetWriteBuffer(), memory, address, end);
 			break;
 		case 0x01:
-			address += ProcessRegList(writeList, memory, address, end);
+			address += ProcessRegList(GetWriteBuffer(), memory, address, end);
 			break;
 		case 0x02:
 		case 0x03:
 			//We need to flush our list here because image data can be embedded in a GIF packet
 			//that specifies pixel transfer information in GS registers (and that has to be send first)
 			//This is done by FFX
-			flushWriteList(m_gs, packetMetadata);
+			FlushWriteBuffer(packetMetadata);
 			address += ProcessImage(memory, address, end);
 			break;
 		}
@@ -355,7 +382,7 @@ uint32 CGIF::ProcessSinglePacket(const uint8* memory, uint32 address, uint32 end
 		}
 	}
 
-	flushWriteList(m_gs, packetMetadata);
+	FlushWriteBuffer(packetMetadata);
 
 #ifdef _DEBUG
 	CLog::GetInstance().Print(LOG_NAME, "Processed 0x%08X bytes.\r\n", address - start);
@@ -456,6 +483,42 @@ void CGIF::SetPath3Masked(bool masked)
 	m_path3Masked = masked;
 }
 
+bool CGIF::IsIdle() const
+{
+	return (m_activePath == 0) && (m_loops == 0) && !m_eop;
+}
+
+CGIF::DECODERSTATE CGIF::GetDecoderState() const
+{
+	DECODERSTATE state;
+	state.activePath = m_activePath;
+	state.loops = m_loops;
+	state.cmd = m_cmd;
+	state.regs = m_regs;
+	state.regsTemp = m_regsTemp;
+	state.regList = m_regList;
+	state.eop = m_eop;
+	state.qtemp = m_qtemp;
+	return state;
+}
+
+void CGIF::SetDecoderState(const DECODERSTATE& state)
+{
+	m_activePath = state.activePath;
+	m_loops = state.loops;
+	m_cmd = state.cmd;
+	m_regs = state.regs;
+	m_regsTemp = state.regsTemp;
+	m_regList = state.regList;
+	m_eop = state.eop;
+	m_qtemp = state.qtemp;
+}
+
+void CGIF::SetReplayCache(CGifReplayCache* replayCache)
+{
+	m_replayCache = replayCache;
+}
+
 void CGIF::DisassembleGet(uint32 address)
 {
 	switch(address)
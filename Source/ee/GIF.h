@@ -6,6 +6,8 @@
 #include "../gs/GSHandler.h"
 #include "../Profiler.h"
 
+class CGifReplayCache;
+
 class CGIF
 {
 public:
@@ -40,6 +42,19 @@ public:
 	};
 	static_assert(sizeof(TAG) == 0x10, "Size of TAG must be 16 bytes.");
 
+	//Packet decoding state, restored after a cached chain is replayed
+	struct DECODERSTATE
+	{
+		uint32 activePath = 0;
+		uint16 loops = 0;
+		uint8 cmd = 0;
+		uint8 regs = 0;
+		uint8 regsTemp = 0;
+		uint64 regList = 0;
+		bool eop = false;
+		uint32 qtemp = 0;
+	};
+
 	CGIF(CGSHandler*&, uint8*, uint8*);
 	virtual ~CGIF() = default;
 
@@ -56,6 +71,11 @@ public:
 
 	void SetPath3Masked(bool);
 
+	bool IsIdle() const;
+	DECODERSTATE GetDecoderState() const;
+	void SetDecoderState(const DECODERSTATE&);
+	void SetReplayCache(CGifReplayCache*);
+
 	void LoadState(Framework::CZipArchiveReader&);
 	void SaveState(Framework::CZipArchiveWriter&);
 
@@ -67,10 +87,13 @@ private:
 		SIGNAL_STATE_PENDING,
 	};
 
-	uint32 ProcessPacked(CGSHandler::RegisterWriteList&, const uint8*, uint32, uint32);
-	uint32 ProcessRegList(CGSHandler::RegisterWriteList&, const uint8*, uint32, uint32);
+	uint32 ProcessPacked(CGsRegisterWriteBuffer&, const uint8*, uint32, uint32);
+	uint32 ProcessRegList(CGsRegisterWriteBuffer&, const uint8*, uint32, uint32);
 	uint32 ProcessImage(const uint8*, uint32, uint32);
 
+	CGsRegisterWriteBuffer& GetWriteBuffer();
+	void FlushWriteBuffer(const CGsPacketMetadata&);
+
 	void DisassembleGet(uint32);
 	void DisassembleSet(uint32, uint32);
 
@@ -88,6 +111,8 @@ private:
 	uint8* m_ram;
 	uint8* m_spr;
 	CGSHandler*& m_gs;
+	GsRegisterWriteBufferPtr m_writeBuffer;
+	CGifReplayCache* m_replayCache = nullptr;
 
 	CProfiler::ZoneHandle m_gifProfilerZone = 0;
 };
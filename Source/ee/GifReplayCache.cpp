@@ -0,0 +1,361 @@
+#include <cassert>
+#include <cstring>
+#include "GifReplayCache.h"
+#include "EeExecutor.h"
+#include "../Ps2Const.h"
+#include "../FrameDump.h"
+
+//Only the lower half of CHCR is relevant, upper half contains the last tag of the previous transfer
+#define CHCR_KEY_MASK (0xFFFF)
+
+CGifReplayCache::CGifReplayCache(CGIF& gif, uint8* ram)
+    : m_gif(gif)
+    , m_ram(ram)
+{
+}
+
+void CGifReplayCache::Reset()
+{
+	Clear();
+	m_recording = false;
+	m_recordingEntry = ENTRY();
+}
+
+bool CGifReplayCache::IsEnabled() const
+{
+	return m_enabled;
+}
+
+void CGifReplayCache::SetEnabled(bool enabled)
+{
+	m_enabled = enabled;
+	if(!m_enabled)
+	{
+		Reset();
+	}
+}
+
+void CGifReplayCache::SetDirtyPageTracker(CEeExecutor* executor, unsigned int trackerIndex)
+{
+	m_executor = executor;
+	m_dirtyPageTrackerIndex = trackerIndex;
+}
+
+bool CGifReplayCache::Replay(uint32 tadr, uint32 chcr, CHANNELSTATE& channelState)
+{
+	if(!m_enabled) return false;
+	if(!m_gif.IsIdle()) return false;
+
+	m_currentStats.lookupCount++;
+
+	auto entryIterator = m_entries.find(tadr);
+	if(entryIterator == std::end(m_entries)) return false;
+
+	auto& entry = entryIterator->second;
+	if(entry.backoffCount != 0) return false;
+	if(entry.chcr != (chcr & CHCR_KEY_MASK)) return false;
+	if(!IsSourceUnchanged(entry)) return false;
+
+	ReplayCommands(entry);
+	m_gif.SetDecoderState(entry.decoderState);
+	channelState = entry.channelState;
+	entry.missCount = 0;
+
+	m_currentStats.hitCount++;
+	m_currentStats.replayedWriteCount += entry.writeCount;
+	return true;
+}
+
+bool CGifReplayCache::BeginRecording(uint32 tadr, uint32 chcr)
+{
+	if(!m_enabled) return false;
+	if(!m_gif.IsIdle()) return false;
+
+	uint32 missCount = 0;
+	auto entryIterator = m_entries.find(tadr);
+	if(entryIterator != std::end(m_entries))
+	{
+		auto& entry = entryIterator->second;
+		if(entry.backoffCount != 0)
+		{
+			entry.backoffCount--;
+			return false;
+		}
+		missCount = entry.missCount + 1;
+		if(missCount >= MAX_CONSECUTIVE_MISSES)
+		{
+			//Chain is different every time, don't bother recording it for now
+			ReleaseEntryUsage(entry);
+			entry = ENTRY();
+			entry.backoffCount = RECORD_BACKOFF_COUNT;
+			return false;
+		}
+	}
+
+	m_recording = true;
+	m_recordingTadr = tadr;
+	m_recordingEntry = ENTRY();
+	m_recordingEntry.chcr = chcr & CHCR_KEY_MASK;
+	m_recordingEntry.missCount = missCount;
+	return true;
+}
+
+void CGifReplayCache::RecordSource(uint32 address, uint32 qwc)
+{
+	if(!m_recording) return;
+
+	//Only EE RAM is tracked, chains using the scratchpad can't be cached
+	uint32 size = qwc * 0x10;
+	if((address >= PS2::EE_RAM_SIZE) || (size > (PS2::EE_RAM_SIZE - address)))
+	{
+		CancelRecording();
+		return;
+	}
+
+	//A copy of the source is kept, chains that are too large aren't worth it
+	if(size > (MAX_CACHED_SOURCE_SIZE - m_recordingEntry.sourceSize))
+	{
+		CancelRecording();
+		return;
+	}
+	m_recordingEntry.sourceSize += size;
+
+	auto& ranges = m_recordingEntry.sourceRanges;
+	if(!ranges.empty() && ((ranges.back().address + ranges.back().size) == address))
+	{
+		ranges.back().size += size;
+	}
+	else
+	{
+		RANGE range;
+		range.address = address;
+		range.size = size;
+		ranges.push_back(range);
+	}
+}
+
+void CGifReplayCache::CancelRecording()
+{
+	if(!m_recording) return;
+	m_recording = false;
+	m_recordingEntry = ENTRY();
+}
+
+void CGifReplayCache::EndRecording(const CHANNELSTATE& channelState)
+{
+	if(!m_recording) return;
+	m_recording = false;
+
+	//Chain must end on a packet boundary, the next one will need to start from scratch
+	if(!m_gif.IsIdle())
+	{
+		m_recordingEntry = ENTRY();
+		return;
+	}
+
+	auto& entry = m_recordingEntry;
+	entry.sourceHash = HashSourceRanges(entry.sourceRanges);
+	CopySourceRanges(entry.sourceRanges, entry.sourceData);
+	entry.verified = true;
+	entry.decoderState = m_gif.GetDecoderState();
+	entry.channelState = channelState;
+
+	auto entryIterator = m_entries.find(m_recordingTadr);
+	if(entryIterator != std::end(m_entries))
+	{
+		ReleaseEntryUsage(entryIterator->second);
+		m_entries.erase(entryIterator);
+	}
+
+	if((m_entries.size() >= MAX_ENTRIES) ||
+	   ((m_cachedWriteCount + entry.writeCount) > MAX_CACHED_WRITES) ||
+	   ((m_cachedSourceSize + entry.sourceSize) > MAX_CACHED_SOURCE_SIZE))
+	{
+		Clear();
+	}
+
+	m_cachedWriteCount += entry.writeCount;
+	m_cachedSourceSize += entry.sourceSize;
+	m_entries[m_recordingTadr] = std::move(entry);
+	m_recordingEntry = ENTRY();
+
+	m_currentStats.recordCount++;
+}
+
+void CGifReplayCache::RecordRegisterWrites(const CGsRegisterWriteBuffer& registerWrites)
+{
+	if(!m_recording) return;
+
+	auto& entry = m_recordingEntry;
+	if((entry.writeCount + registerWrites.GetSize()) > MAX_CACHED_WRITES)
+	{
+		CancelRecording();
+		return;
+	}
+
+	//Consecutive register writes are merged to send them to the GS in one go when replaying
+	auto& commands = entry.commands;
+	if(commands.empty() || (commands.back().imageSize != 0))
+	{
+		commands.emplace_back();
+	}
+	commands.back().registerWrites.Append(registerWrites);
+	entry.writeCount += registerWrites.GetSize();
+}
+
+void CGifReplayCache::RecordImageData(uint32 address, uint32 size)
+{
+	if(!m_recording) return;
+	if(size == 0) return;
+
+	COMMAND command;
+	command.imageAddress = address;
+	command.imageSize = size;
+	m_recordingEntry.commands.push_back(std::move(command));
+}
+
+CGifReplayCache::STATS CGifReplayCache::GetFrameStats()
+{
+	std::lock_guard<std::mutex> frameStatsLock(m_frameStatsMutex);
+	return m_frameStats;
+}
+
+void CGifReplayCache::EndFrame()
+{
+	if(m_enabled && !m_entries.empty())
+	{
+		//Restart tracking from now on, entries with modified pages will need to be hashed again
+		bool tracked = (m_executor != nullptr) && m_executor->CollectDirtyPages(m_dirtyPageTrackerIndex, m_dirtyPages);
+		for(auto& entryPair : m_entries)
+		{
+			auto& entry = entryPair.second;
+			if(!entry.verified) continue;
+			entry.verified = tracked && !HasDirtyPages(entry.sourceRanges, m_dirtyPages);
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> frameStatsLock(m_frameStatsMutex);
+		m_frameStats = m_currentStats;
+	}
+	m_currentStats = STATS();
+}
+
+bool CGifReplayCache::IsSourceUnchanged(ENTRY& entry)
+{
+	if(entry.verified && m_executor)
+	{
+		bool dirty = false;
+		for(const auto& range : entry.sourceRanges)
+		{
+			if(m_executor->HasDirtyPages(m_dirtyPageTrackerIndex, range.address, range.address + range.size))
+			{
+				dirty = true;
+				break;
+			}
+		}
+		if(!dirty) return true;
+	}
+
+	//Hash rejects modified sources quickly, but a match could be a collision
+	m_currentStats.hashCount++;
+	entry.verified = (HashSourceRanges(entry.sourceRanges) == entry.sourceHash) && IsSourceDataEqual(entry);
+	return entry.verified;
+}
+
+bool CGifReplayCache::HasDirtyPages(const RangeArray& ranges, const PageBitmap& dirtyPages) const
+{
+	size_t pageSize = m_executor->GetPageSize();
+	for(const auto& range : ranges)
+	{
+		if(range.size == 0) continue;
+		size_t firstPage = range.address / pageSize;
+		size_t lastPage = (range.address + range.size - 1) / pageSize;
+		assert(lastPage < dirtyPages.size());
+		for(size_t page = firstPage; page <= lastPage; page++)
+		{
+			if(dirtyPages[page]) return true;
+		}
+	}
+	return false;
+}
+
+uint64 CGifReplayCache::HashSourceRanges(const RangeArray& ranges) const
+{
+	//Uses xxHash64's round function, both halves of a qword go in their own lane
+	static const uint64 PRIME64_1 = 0x9E3779B185EBCA87ULL;
+	static const uint64 PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+	auto mixRound = [](uint64 acc, uint64 input) {
+		acc += input * PRIME64_2;
+		acc = (acc << 31) | (acc >> 33);
+		return acc * PRIME64_1;
+	};
+
+	uint64 lanes[2] = {PRIME64_1 + PRIME64_2, PRIME64_2};
+	uint64 totalSize = 0;
+	for(const auto& range : ranges)
+	{
+		auto words = reinterpret_cast<const uint64*>(m_ram + range.address);
+		uint32 wordCount = range.size / sizeof(uint64);
+		for(uint32 i = 0; i < wordCount; i += 2)
+		{
+			lanes[0] = mixRound(lanes[0], words[i + 0]);
+			lanes[1] = mixRound(lanes[1], words[i + 1]);
+		}
+		totalSize += range.size;
+	}
+	return mixRound(lanes[0], totalSize) ^ lanes[1];
+}
+
+void CGifReplayCache::CopySourceRanges(const RangeArray& ranges, std::vector<uint8>& data) const
+{
+	data.clear();
+	for(const auto& range : ranges)
+	{
+		data.insert(data.end(), m_ram + range.address, m_ram + range.address + range.size);
+	}
+}
+
+bool CGifReplayCache::IsSourceDataEqual(const ENTRY& entry) const
+{
+	assert(entry.sourceData.size() == entry.sourceSize);
+	auto sourceData = entry.sourceData.data();
+	for(const auto& range : entry.sourceRanges)
+	{
+		if(memcmp(m_ram + range.address, sourceData, range.size) != 0) return false;
+		sourceData += range.size;
+	}
+	return true;
+}
+
+void CGifReplayCache::ReleaseEntryUsage(ENTRY& entry)
+{
+	m_cachedWriteCount -= entry.writeCount;
+	m_cachedSourceSize -= entry.sourceSize;
+}
+
+void CGifReplayCache::ReplayCommands(const ENTRY& entry)
+{
+	auto gs = m_gif.GetGsHandler();
+	CGsPacketMetadata packetMetadata(3);
+	for(const auto& command : entry.commands)
+	{
+		if(command.imageSize != 0)
+		{
+			gs->FeedImageData(m_ram + command.imageAddress, command.imageSize);
+		}
+		else
+		{
+			auto registerWrites = gs->AcquireRegisterWriteBuffer();
+			registerWrites->Append(command.registerWrites);
+			gs->WriteRegisterMassively(std::move(registerWrites), &packetMetadata);
+		}
+	}
+}
+
+void CGifReplayCache::Clear()
+{
+	m_entries.clear();
+	m_cachedWriteCount = 0;
+	m_cachedSourceSize = 0;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <vector>
+#include "Types.h"
+#include "Dmac_Channel.h"
+#include "GIF.h"
+
+class CEeExecutor;
+
+//Remembers what PATH3 DMA chains sent to the GS. When a chain is kicked again from the same
+//address and its source memory didn't change, the GS commands it produced are sent again
+//without walking its tags or decoding its GIF packets. Source memory is checked with a hash,
+//which is skipped when the EE executor's dirty page tracking shows it wasn't written to.
+//Hash matches are confirmed by comparing source memory with a copy taken when recording.
+class CGifReplayCache : public Dmac::CSourceChainCache
+{
+public:
+	struct STATS
+	{
+		uint32 lookupCount = 0;
+		uint32 hitCount = 0;
+		uint32 hashCount = 0;
+		uint32 recordCount = 0;
+		uint64 replayedWriteCount = 0;
+	};
+
+	CGifReplayCache(CGIF&, uint8*);
+	virtual ~CGifReplayCache() = default;
+
+	void Reset();
+
+	bool IsEnabled() const;
+	void SetEnabled(bool);
+
+	void SetDirtyPageTracker(CEeExecutor*, unsigned int);
+
+	bool Replay(uint32, uint32, CHANNELSTATE&) override;
+	bool BeginRecording(uint32, uint32) override;
+	void RecordSource(uint32, uint32) override;
+	void CancelRecording() override;
+	void EndRecording(const CHANNELSTATE&) override;
+
+	//Used by the GIF to record what is sent to the GS while a chain is processed
+	bool IsRecording() const
+	{
+		return m_recording;
+	}
+	void RecordRegisterWrites(const CGsRegisterWriteBuffer&);
+	void RecordImageData(uint32, uint32);
+
+	//Counters of the last completed frame
+	STATS GetFrameStats();
+	void EndFrame();
+
+private:
+	enum
+	{
+		MAX_ENTRIES = 0x100,
+		MAX_CACHED_WRITES = 0x400000,
+		MAX_CACHED_SOURCE_SIZE = 0x1000000,
+		MAX_CONSECUTIVE_MISSES = 4,
+		RECORD_BACKOFF_COUNT = 0x40,
+	};
+
+	struct RANGE
+	{
+		uint32 address = 0;
+		uint32 size = 0;
+	};
+	typedef std::vector<RANGE> RangeArray;
+
+	//Either register writes or an image transfer from EE RAM
+	struct COMMAND
+	{
+		CGsRegisterWriteBuffer registerWrites;
+		uint32 imageAddress = 0;
+		uint32 imageSize = 0;
+	};
+	typedef std::vector<COMMAND> CommandArray;
+
+	struct ENTRY
+	{
+		uint32 chcr = 0;
+		RangeArray sourceRanges;
+		uint32 sourceSize = 0;
+		uint64 sourceHash = 0;
+		std::vector<uint8> sourceData;
+		//Set when source memory is known to be unchanged as long as its pages stay clean
+		bool verified = false;
+		CommandArray commands;
+		size_t writeCount = 0;
+		CGIF::DECODERSTATE decoderState;
+		CHANNELSTATE channelState;
+		//Chains that keep changing aren't recorded for a while
+		uint32 missCount = 0;
+		uint32 backoffCount = 0;
+	};
+	typedef std::map<uint32, ENTRY> EntryMap;
+	typedef std::vector<uint8> PageBitmap;
+
+	bool IsSourceUnchanged(ENTRY&);
+	bool HasDirtyPages(const RangeArray&, const PageBitmap&) const;
+	uint64 HashSourceRanges(const RangeArray&) const;
+	void CopySourceRanges(const RangeArray&, std::vector<uint8>&) const;
+	bool IsSourceDataEqual(const ENTRY&) const;
+	void ReleaseEntryUsage(ENTRY&);
+	void ReplayCommands(const ENTRY&);
+	void Clear();
+
+	CGIF& m_gif;
+	uint8* m_ram = nullptr;
+	bool m_enabled = false;
+
+	CEeExecutor* m_executor = nullptr;
+	unsigned int m_dirtyPageTrackerIndex = 0;
+	PageBitmap m_dirtyPages;
+
+	EntryMap m_entries;
+	size_t m_cachedWriteCount = 0;
+	size_t m_cachedSourceSize = 0;
+
+	bool m_recording = false;
+	uint32 m_recordingTadr = 0;
+	ENTRY m_recordingEntry;
+
+	STATS m_currentStats;
+	STATS m_frameStats;
+	std::mutex m_frameStatsMutex;
+};
@@ -34,6 +34,7 @@ CMA_EE::CMA_EE()
 	m_pOpSpecial2[0x28] = std::bind(&CMA_EE::MMI1, this);
 	m_pOpSpecial2[0x29] = std::bind(&CMA_EE::MMI3, this);
 	m_pOpSpecial2[0x30] = std::bind(&CMA_EE::PMFHL, this);
+	m_pOpSpecial2[0x31] = std::bind(&CMA_EE::PMTHL, this);
 	m_pOpSpecial2[0x34] = std::bind(&CMA_EE::PSLLH, this);
 	m_pOpSpecial2[0x36] = std::bind(&CMA_EE::PSRLH, this);
 	m_pOpSpecial2[0x37] = std::bind(&CMA_EE::PSRAH, this);
@@ -347,6 +348,29 @@ void CMA_EE::PMFHL()
 	((this)->*(m_pOpPmfhl[(m_nOpcode >> 6) & 0x1F]))();
 }
 
+//31
+void CMA_EE::PMTHL()
+{
+	//LW is the only valid format
+	if(((m_nOpcode >> 6) & 0x1F) != 0)
+	{
+		Illegal();
+		return;
+	}
+
+	m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRS].nV[0]));
+	m_codeGen->PullRel(offsetof(CMIPS, m_State.nLO[0]));
+
+	m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRS].nV[1]));
+	m_codeGen->PullRel(offsetof(CMIPS, m_State.nHI[0]));
+
+	m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRS].nV[2]));
+	m_codeGen->PullRel(offsetof(CMIPS, m_State.nLO1[0]));
+
+	m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRS].nV[3]));
+	m_codeGen->PullRel(offsetof(CMIPS, m_State.nHI1[0]));
+}
+
 //34
 void CMA_EE::PSLLH()
 {
@@ -651,6 +675,43 @@ void CMA_EE::PADDSB()
 	PullVector(m_nRD);
 }
 
+//19
+void CMA_EE::PSUBSB()
+{
+	if(m_nRD == 0) return;
+
+	//There's no saturating signed byte subtraction in the jitter. Bytes are sign extended
+	//to halfwords, subtracted and clamped to the byte range before being packed back.
+	//Upper half goes first since it ends up in the upper half of the packed result.
+	for(unsigned int i = 0; i < 2; i++)
+	{
+		bool isUpper = (i == 0);
+		for(auto reg : {m_nRS, m_nRT})
+		{
+			PushVector(reg);
+			PushVector(reg);
+			if(isUpper)
+			{
+				m_codeGen->MD_UnpackUpperBH();
+			}
+			else
+			{
+				m_codeGen->MD_UnpackLowerBH();
+			}
+			m_codeGen->MD_SraH(8);
+		}
+		m_codeGen->MD_SubH();
+
+		m_codeGen->MD_PushCstExpand(0xFF80FF80U);
+		m_codeGen->MD_MaxH();
+		m_codeGen->MD_PushCstExpand(0x007F007FU);
+		m_codeGen->MD_MinH();
+	}
+
+	m_codeGen->MD_PackHB();
+	PullVector(m_nRD);
+}
+
 //1A
 void CMA_EE::PEXTLB()
 {
@@ -750,42 +811,15 @@ void CMA_EE::PABSW()
 {
 	if(m_nRD == 0) return;
 
-	//RD = (RT != 0x80000000) ? |RT| : 0x7FFFFFFF;
-
-	for(unsigned int i = 0; i < 4; i++)
-	{
-		auto srcOffset = offsetof(CMIPS, m_State.nGPR[m_nRT].nV[i]);
-		auto dstOffset = offsetof(CMIPS, m_State.nGPR[m_nRD].nV[i]);
-
-		m_codeGen->PushRel(srcOffset);
-		m_codeGen->PushCst(0x80000000);
-
-		m_codeGen->BeginIf(Jitter::CONDITION_EQ);
-		{
-			m_codeGen->PushCst(0x7FFFFFFF);
-			m_codeGen->PullRel(dstOffset);
-		}
-		m_codeGen->Else();
-		{
-			m_codeGen->PushRel(srcOffset);
-			m_codeGen->PushCst(0);
-
-			m_codeGen->BeginIf(Jitter::CONDITION_LT);
-			{
-				m_codeGen->PushCst(0);
-				m_codeGen->PushRel(srcOffset);
-				m_codeGen->Sub();
-				m_codeGen->PullRel(dstOffset);
-			}
-			m_codeGen->Else();
-			{
-				m_codeGen->PushRel(srcOffset);
-				m_codeGen->PullRel(dstOffset);
-			}
-			m_codeGen->EndIf();
-		}
-		m_codeGen->EndIf();
-	}
+	//RD = (RT ^ sign) - sign, saturation turns 0x80000000 into 0x7FFFFFFF
+	PushVector(m_nRT);
+	PushVector(m_nRT);
+	m_codeGen->MD_SraW(31);
+	m_codeGen->MD_Xor();
+	PushVector(m_nRT);
+	m_codeGen->MD_SraW(31);
+	m_codeGen->MD_SubWSS();
+	PullVector(m_nRD);
 }
 
 //02
@@ -810,6 +844,48 @@ void CMA_EE::PMINW()
 	PullVector(m_nRD);
 }
 
+//04
+void CMA_EE::PADSBH()
+{
+	if(m_nRD == 0) return;
+
+	//Lower 4 halfwords are subtracted, upper 4 halfwords are added.
+	//The sum is kept in a VU temporary that isn't used by the EE since RD can be RS or RT.
+	static const size_t tempOffset = offsetof(CMIPS, m_State.nCOP2VF_UpRes);
+
+	PushVector(m_nRS);
+	PushVector(m_nRT);
+	m_codeGen->MD_AddH();
+	m_codeGen->MD_PullRel(tempOffset);
+
+	PushVector(m_nRS);
+	PushVector(m_nRT);
+	m_codeGen->MD_SubH();
+	PullVector(m_nRD);
+
+	for(unsigned int i = 2; i < 4; i++)
+	{
+		m_codeGen->PushRel(tempOffset + (i * 4));
+		m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRD].nV[i]));
+	}
+}
+
+//05
+void CMA_EE::PABSH()
+{
+	if(m_nRD == 0) return;
+
+	//Same as PABSW, 0x8000 saturates to 0x7FFF
+	PushVector(m_nRT);
+	PushVector(m_nRT);
+	m_codeGen->MD_SraH(15);
+	m_codeGen->MD_Xor();
+	PushVector(m_nRT);
+	m_codeGen->MD_SraH(15);
+	m_codeGen->MD_SubHSS();
+	PullVector(m_nRD);
+}
+
 //06
 void CMA_EE::PCEQH()
 {
@@ -956,6 +1032,12 @@ void CMA_EE::QFSRV()
 //MMI2 Opcodes
 //////////////////////////////////////////////////
 
+//00
+void CMA_EE::PMADDW()
+{
+	Generic_PMULTW(true, MULTIPLY_MODE_ADD);
+}
+
 //02
 void CMA_EE::PSLLVW()
 {
@@ -968,6 +1050,12 @@ void CMA_EE::PSRLVW()
 	Generic_PSxxV([this]() { m_codeGen->Srl(); });
 }
 
+//04
+void CMA_EE::PMSUBW()
+{
+	Generic_PMULTW(true, MULTIPLY_MODE_SUB);
+}
+
 //08
 void CMA_EE::PMFHI()
 {
@@ -992,10 +1080,50 @@ void CMA_EE::PMFLO()
 	}
 }
 
+//0A
+void CMA_EE::PINTH()
+{
+	if(m_nRD == 0) return;
+
+	//RD = B7 A3 B6 A2 B5 A1 B4 A0 (halfwords, A = RT, B = RS)
+	//All words are computed before being stored since RD can be RS or RT
+	for(unsigned int i = 0; i < 4; i++)
+	{
+		m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[i / 2]));
+		if(i & 1)
+		{
+			m_codeGen->Srl(16);
+		}
+		else
+		{
+			m_codeGen->PushCst(0xFFFF);
+			m_codeGen->And();
+		}
+
+		m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRS].nV[2 + (i / 2)]));
+		if(i & 1)
+		{
+			m_codeGen->PushCst(0xFFFF0000);
+			m_codeGen->And();
+		}
+		else
+		{
+			m_codeGen->Shl(16);
+		}
+
+		m_codeGen->Or();
+	}
+
+	for(unsigned int i = 0; i < 4; i++)
+	{
+		m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRD].nV[3 - i]));
+	}
+}
+
 //0C
 void CMA_EE::PMULTW()
 {
-	Generic_PMULTW(true);
+	Generic_PMULTW(true, MULTIPLY_MODE_SET);
 }
 
 //0D
@@ -1030,131 +1158,13 @@ void CMA_EE::PCPYLD()
 //10
 void CMA_EE::PMADDH()
 {
-	static const size_t offsets[8] =
-	    {
-	        offsetof(CMIPS, m_State.nLO[0]),
-	        offsetof(CMIPS, m_State.nLO[1]),
-	        offsetof(CMIPS, m_State.nHI[0]),
-	        offsetof(CMIPS, m_State.nHI[1]),
-	        offsetof(CMIPS, m_State.nLO1[0]),
-	        offsetof(CMIPS, m_State.nLO1[1]),
-	        offsetof(CMIPS, m_State.nHI1[0]),
-	        offsetof(CMIPS, m_State.nHI1[1])};
-
-	for(unsigned int i = 0; i < 4; i++)
-	{
-		//Lower 16-bits
-		{
-			m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRS].nV[i]));
-			m_codeGen->SignExt16();
-
-			m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[i]));
-			m_codeGen->SignExt16();
-
-			m_codeGen->MultS();
-			m_codeGen->ExtLow64();
-
-			m_codeGen->PushRel(offsets[(i * 2) + 0]);
-			m_codeGen->Add();
-			m_codeGen->PullRel(offsets[(i * 2) + 0]);
-		}
-
-		//Higher 16-bits
-		{
-			m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRS].nV[i]));
-			m_codeGen->Sra(16);
-
-			m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[i]));
-			m_codeGen->Sra(16);
-
-			m_codeGen->MultS();
-			m_codeGen->ExtLow64();
-
-			m_codeGen->PushRel(offsets[(i * 2) + 1]);
-			m_codeGen->Add();
-			m_codeGen->PullRel(offsets[(i * 2) + 1]);
-		}
-	}
-
-	if(m_nRD != 0)
-	{
-		//Copy to RD
-		m_codeGen->PushRel(offsetof(CMIPS, m_State.nLO[0]));
-		m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRD].nV[0]));
-
-		m_codeGen->PushRel(offsetof(CMIPS, m_State.nHI[0]));
-		m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRD].nV[1]));
-
-		m_codeGen->PushRel(offsetof(CMIPS, m_State.nLO1[0]));
-		m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRD].nV[2]));
-
-		m_codeGen->PushRel(offsetof(CMIPS, m_State.nHI1[0]));
-		m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRD].nV[3]));
-	}
+	Generic_PMULTH(MULTIPLY_MODE_ADD);
 }
 
 //11
 void CMA_EE::PHMADH()
 {
-	static const size_t offsets[4] =
-	    {
-	        offsetof(CMIPS, m_State.nLO[0]),
-	        offsetof(CMIPS, m_State.nHI[0]),
-	        offsetof(CMIPS, m_State.nLO1[0]),
-	        offsetof(CMIPS, m_State.nHI1[0]),
-	    };
-
-	static const size_t clearOffsets[4] =
-	    {
-	        offsetof(CMIPS, m_State.nLO[1]),
-	        offsetof(CMIPS, m_State.nHI[1]),
-	        offsetof(CMIPS, m_State.nLO1[1]),
-	        offsetof(CMIPS, m_State.nHI1[1]),
-	    };
-
-	for(unsigned int i = 0; i < 4; i++)
-	{
-		m_codeGen->PushCst(0);
-		m_codeGen->PullRel(clearOffsets[i]);
-	}
-
-	for(unsigned int i = 0; i < 4; i++)
-	{
-		//Lower 16-bits (An0 * An1)
-		{
-			m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRS].nV[i]));
-			m_codeGen->SignExt16();
-
-			m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[i]));
-			m_codeGen->SignExt16();
-
-			m_codeGen->MultS();
-			m_codeGen->ExtLow64();
-		}
-
-		//Higher 16-bits (Bn0 * Bn1)
-		{
-			m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRS].nV[i]));
-			m_codeGen->Sra(16);
-
-			m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[i]));
-			m_codeGen->Sra(16);
-
-			m_codeGen->MultS();
-			m_codeGen->ExtLow64();
-		}
-
-		m_codeGen->Add();
-
-		if(m_nRD != 0)
-		{
-			m_codeGen->PushTop();
-			m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRD].nV[i]));
-		}
-
-		//Store to LO/HI
-		m_codeGen->PullRel(offsets[i]);
-	}
+	Generic_PHMxxH(false);
 }
 
 //12
@@ -1179,16 +1189,57 @@ void CMA_EE::PXOR()
 	PullVector(m_nRD);
 }
 
-//1B
-void CMA_EE::PREVH()
+//14
+void CMA_EE::PMSUBH()
 {
-	if(m_nRD == 0) return;
+	Generic_PMULTH(MULTIPLY_MODE_SUB);
+}
 
-	for(unsigned int i = 0; i < 2; i++)
-	{
-		m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[(i * 2) + 0]));
-		m_codeGen->Shl(16);
-		m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[(i * 2) + 0]));
+//15
+void CMA_EE::PHMSBH()
+{
+	Generic_PHMxxH(true);
+}
+
+//1A
+void CMA_EE::PEXEH()
+{
+	if(m_nRD == 0) return;
+
+	//Exchanges halfwords 0 and 2 of each doubleword
+	for(unsigned int i = 0; i < 4; i += 2)
+	{
+		m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[i + 1]));
+		m_codeGen->PushCst(0x0000FFFF);
+		m_codeGen->And();
+		m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[i + 0]));
+		m_codeGen->PushCst(0xFFFF0000);
+		m_codeGen->And();
+		m_codeGen->Or();
+
+		m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[i + 0]));
+		m_codeGen->PushCst(0x0000FFFF);
+		m_codeGen->And();
+		m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[i + 1]));
+		m_codeGen->PushCst(0xFFFF0000);
+		m_codeGen->And();
+		m_codeGen->Or();
+
+		m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRD].nV[i + 1]));
+		m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRD].nV[i + 0]));
+	}
+}
+
+//1B
+void CMA_EE::PREVH()
+{
+	if(m_nRD == 0) return;
+
+	for(unsigned int i = 0; i < 2; i++)
+	{
+		m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[(i * 2) + 0]));
+		m_codeGen->Shl(16);
+		m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[(i * 2) + 0]));
 		m_codeGen->Srl(16);
 		m_codeGen->Or();
 
@@ -1206,62 +1257,86 @@ void CMA_EE::PREVH()
 //1C
 void CMA_EE::PMULTH()
 {
-	static const size_t offsets[8] =
-	    {
-	        offsetof(CMIPS, m_State.nLO[0]),
-	        offsetof(CMIPS, m_State.nLO[1]),
-	        offsetof(CMIPS, m_State.nHI[0]),
-	        offsetof(CMIPS, m_State.nHI[1]),
-	        offsetof(CMIPS, m_State.nLO1[0]),
-	        offsetof(CMIPS, m_State.nLO1[1]),
-	        offsetof(CMIPS, m_State.nHI1[0]),
-	        offsetof(CMIPS, m_State.nHI1[1])};
+	Generic_PMULTH(MULTIPLY_MODE_SET);
+}
+
+//1D
+void CMA_EE::PDIVBW()
+{
+	//Every word of RS is divided by the lower halfword of RT, results go in LO/HI words
+	size_t divisorOffset = offsetof(CMIPS, m_State.nGPR[m_nRT].nV[0]);
 
 	for(unsigned int i = 0; i < 4; i++)
 	{
-		//Lower 16-bits
-		{
-			m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRS].nV[i]));
-			m_codeGen->SignExt16();
+		size_t dividendOffset = offsetof(CMIPS, m_State.nGPR[m_nRS].nV[i]);
 
-			m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[i]));
-			m_codeGen->SignExt16();
-
-			m_codeGen->MultS();
-			m_codeGen->ExtLow64();
+		//Check for zero
+		m_codeGen->PushRel(divisorOffset);
+		m_codeGen->PushCst(0xFFFF);
+		m_codeGen->And();
+		m_codeGen->PushCst(0);
+		m_codeGen->BeginIf(Jitter::CONDITION_EQ);
+		{
+			//If r[rs] < 0, then lo = 1 else lo = ~0
+			m_codeGen->PushRel(dividendOffset);
+			m_codeGen->PushCst(0);
+			m_codeGen->BeginIf(Jitter::CONDITION_LT);
+			{
+				m_codeGen->PushCst(1);
+				m_codeGen->PullRel(GetLoOffset(i));
+			}
+			m_codeGen->Else();
+			{
+				m_codeGen->PushCst(~0);
+				m_codeGen->PullRel(GetLoOffset(i));
+			}
+			m_codeGen->EndIf();
 
-			m_codeGen->PullRel(offsets[(i * 2) + 0]);
+			m_codeGen->PushRel(dividendOffset);
+			m_codeGen->PullRel(GetHiOffset(i));
 		}
-
-		//Higher 16-bits
+		m_codeGen->Else();
 		{
-			m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRS].nV[i]));
-			m_codeGen->Sra(16);
-
-			m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[i]));
-			m_codeGen->Sra(16);
-
-			m_codeGen->MultS();
-			m_codeGen->ExtLow64();
+			//Check for overflow condition (0x80000000 / 0xFFFF)
+			m_codeGen->PushRel(dividendOffset);
+			m_codeGen->PushCst(0x80000000);
+			m_codeGen->Cmp(Jitter::CONDITION_EQ);
+
+			m_codeGen->PushRel(divisorOffset);
+			m_codeGen->PushCst(0xFFFF);
+			m_codeGen->And();
+			m_codeGen->PushCst(0xFFFF);
+			m_codeGen->Cmp(Jitter::CONDITION_EQ);
+
+			m_codeGen->And();
+			m_codeGen->PushCst(0);
 
-			m_codeGen->PullRel(offsets[(i * 2) + 1]);
-		}
-	}
+			m_codeGen->BeginIf(Jitter::CONDITION_NE);
+			{
+				m_codeGen->PushCst(0x80000000);
+				m_codeGen->PullRel(GetLoOffset(i));
 
-	if(m_nRD != 0)
-	{
-		//Copy to RD
-		m_codeGen->PushRel(offsetof(CMIPS, m_State.nLO[0]));
-		m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRD].nV[0]));
+				m_codeGen->PushCst(0);
+				m_codeGen->PullRel(GetHiOffset(i));
+			}
+			m_codeGen->Else();
+			{
+				m_codeGen->PushRel(dividendOffset);
+				m_codeGen->PushRel(divisorOffset);
+				m_codeGen->SignExt16();
+				m_codeGen->DivS();
 
-		m_codeGen->PushRel(offsetof(CMIPS, m_State.nHI[0]));
-		m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRD].nV[1]));
+				m_codeGen->PushTop();
 
-		m_codeGen->PushRel(offsetof(CMIPS, m_State.nLO1[0]));
-		m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRD].nV[2]));
+				m_codeGen->ExtLow64();
+				m_codeGen->PullRel(GetLoOffset(i));
 
-		m_codeGen->PushRel(offsetof(CMIPS, m_State.nHI1[0]));
-		m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRD].nV[3]));
+				m_codeGen->ExtHigh64();
+				m_codeGen->PullRel(GetHiOffset(i));
+			}
+			m_codeGen->EndIf();
+		}
+		m_codeGen->EndIf();
 	}
 }
 
@@ -1333,6 +1408,12 @@ void CMA_EE::PROT3W()
 //MMI3 Opcodes
 //////////////////////////////////////////////////
 
+//00
+void CMA_EE::PMADDUW()
+{
+	Generic_PMULTW(false, MULTIPLY_MODE_ADD);
+}
+
 //03
 void CMA_EE::PSRAVW()
 {
@@ -1383,7 +1464,16 @@ void CMA_EE::PINTEH()
 //0C
 void CMA_EE::PMULTUW()
 {
-	Generic_PMULTW(false);
+	Generic_PMULTW(false, MULTIPLY_MODE_SET);
+}
+
+//0D
+void CMA_EE::PDIVUW()
+{
+	for(unsigned int i = 0; i < 2; i++)
+	{
+		Template_Div32(false, i, i * 2);
+	}
 }
 
 //0E
@@ -1555,6 +1645,58 @@ void CMA_EE::PMFHL_UW()
 	m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRD].nV[3]));
 }
 
+//02
+void CMA_EE::PMFHL_SLW()
+{
+	if(m_nRD == 0) return;
+
+	//RD = HI:LO saturated to a signed word and sign extended to a doubleword
+	for(unsigned int i = 0; i < 2; i++)
+	{
+		size_t loOffset = GetLoOffset(i * 2);
+		size_t hiOffset = GetHiOffset(i * 2);
+		size_t dstOffset[2] =
+		    {
+		        offsetof(CMIPS, m_State.nGPR[m_nRD].nV[(i * 2) + 0]),
+		        offsetof(CMIPS, m_State.nGPR[m_nRD].nV[(i * 2) + 1]),
+		    };
+
+		//Value fits in a word if HI is the sign extension of LO
+		m_codeGen->PushRel(hiOffset);
+		m_codeGen->PushRel(loOffset);
+		m_codeGen->Sra(31);
+		m_codeGen->BeginIf(Jitter::CONDITION_EQ);
+		{
+			m_codeGen->PushRel(loOffset);
+			m_codeGen->PushTop();
+			m_codeGen->SignExt();
+			m_codeGen->PullRel(dstOffset[1]);
+			m_codeGen->PullRel(dstOffset[0]);
+		}
+		m_codeGen->Else();
+		{
+			m_codeGen->PushRel(hiOffset);
+			m_codeGen->PushCst(0);
+			m_codeGen->BeginIf(Jitter::CONDITION_LT);
+			{
+				m_codeGen->PushCst(0x80000000);
+				m_codeGen->PullRel(dstOffset[0]);
+				m_codeGen->PushCst(0xFFFFFFFF);
+				m_codeGen->PullRel(dstOffset[1]);
+			}
+			m_codeGen->Else();
+			{
+				m_codeGen->PushCst(0x7FFFFFFF);
+				m_codeGen->PullRel(dstOffset[0]);
+				m_codeGen->PushCst(0);
+				m_codeGen->PullRel(dstOffset[1]);
+			}
+			m_codeGen->EndIf();
+		}
+		m_codeGen->EndIf();
+	}
+}
+
 //03
 void CMA_EE::PMFHL_LH()
 {
@@ -1715,28 +1857,40 @@ void CMA_EE::Generic_MADD(unsigned int unit, bool isSigned)
 	m_codeGen->PullRel(hi[1]);
 	m_codeGen->PullRel(hi[0]);
 
+	//RD is written from values still on the stack instead of being loaded back from LO
 	m_codeGen->ExtLow64();
+	if(m_nRD != 0)
+	{
+		m_codeGen->PushTop();
+		m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRD].nV[0]));
+	}
 	m_codeGen->PushTop();
 	m_codeGen->SignExt();
-	m_codeGen->PullRel(lo[1]);
-	m_codeGen->PullRel(lo[0]);
-
 	if(m_nRD != 0)
 	{
-		m_codeGen->PushRel(lo[0]);
-		m_codeGen->PushRel(lo[1]);
-
+		m_codeGen->PushTop();
 		m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRD].nV[1]));
-		m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRD].nV[0]));
 	}
+	m_codeGen->PullRel(lo[1]);
+	m_codeGen->PullRel(lo[0]);
 }
 
-void CMA_EE::Generic_PMULTW(bool isSigned)
+void CMA_EE::Generic_PMULTW(bool isSigned, MULTIPLY_MODE mode)
 {
+	//prod = (HI || LO) +/- (RS * RT) for words 0 and 2
+	//RD = prod
+
 	for(unsigned int i = 0; i < 2; i++)
 	{
 		unsigned int regOffset = i * 2;
 
+		if(mode != MULTIPLY_MODE_SET)
+		{
+			m_codeGen->PushRel(GetLoOffset(regOffset));
+			m_codeGen->PushRel(GetHiOffset(regOffset));
+			m_codeGen->MergeTo64();
+		}
+
 		m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRS].nV[regOffset]));
 		m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[regOffset]));
 		if(isSigned)
@@ -1748,10 +1902,26 @@ void CMA_EE::Generic_PMULTW(bool isSigned)
 			m_codeGen->Mult();
 		}
 
+		if(mode == MULTIPLY_MODE_ADD)
+		{
+			m_codeGen->Add64();
+		}
+		else if(mode == MULTIPLY_MODE_SUB)
+		{
+			m_codeGen->Sub64();
+		}
+
 		m_codeGen->PushTop();
 
+		//RD can be written as we go, the next iteration only reads elements above the ones written here
+
 		//LO
 		m_codeGen->ExtLow64();
+		if(m_nRD != 0)
+		{
+			m_codeGen->PushTop();
+			m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRD].nV[regOffset + 0]));
+		}
 		{
 			m_codeGen->PushTop();
 			m_codeGen->SignExt();
@@ -1761,6 +1931,11 @@ void CMA_EE::Generic_PMULTW(bool isSigned)
 
 		//HI
 		m_codeGen->ExtHigh64();
+		if(m_nRD != 0)
+		{
+			m_codeGen->PushTop();
+			m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRD].nV[regOffset + 1]));
+		}
 		{
 			m_codeGen->PushTop();
 			m_codeGen->SignExt();
@@ -1768,19 +1943,145 @@ void CMA_EE::Generic_PMULTW(bool isSigned)
 		}
 		m_codeGen->PullRel(GetHiOffset(regOffset + 0));
 	}
+}
+
+void CMA_EE::Generic_PMULTH(MULTIPLY_MODE mode)
+{
+	//Products of halfword n go in element n of LO0 LO1 HI0 HI1 LO2 LO3 HI2 HI3 (words)
+	//RD = HI2 LO2 HI0 LO0
+
+	static const size_t offsets[8] =
+	    {
+	        offsetof(CMIPS, m_State.nLO[0]),
+	        offsetof(CMIPS, m_State.nLO[1]),
+	        offsetof(CMIPS, m_State.nHI[0]),
+	        offsetof(CMIPS, m_State.nHI[1]),
+	        offsetof(CMIPS, m_State.nLO1[0]),
+	        offsetof(CMIPS, m_State.nLO1[1]),
+	        offsetof(CMIPS, m_State.nHI1[0]),
+	        offsetof(CMIPS, m_State.nHI1[1])};
+
+	for(unsigned int i = 0; i < 8; i++)
+	{
+		if(mode != MULTIPLY_MODE_SET)
+		{
+			m_codeGen->PushRel(offsets[i]);
+		}
+
+		for(auto reg : {m_nRS, m_nRT})
+		{
+			m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[reg].nV[i / 2]));
+			if(i & 1)
+			{
+				m_codeGen->Sra(16);
+			}
+			else
+			{
+				m_codeGen->SignExt16();
+			}
+		}
+
+		m_codeGen->MultS();
+		m_codeGen->ExtLow64();
+
+		if(mode == MULTIPLY_MODE_ADD)
+		{
+			m_codeGen->Add();
+		}
+		else if(mode == MULTIPLY_MODE_SUB)
+		{
+			m_codeGen->Sub();
+		}
+
+		m_codeGen->PullRel(offsets[i]);
+	}
 
 	if(m_nRD != 0)
 	{
-		for(unsigned int i = 0; i < 2; i++)
+		//Copy to RD
+		m_codeGen->PushRel(offsetof(CMIPS, m_State.nLO[0]));
+		m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRD].nV[0]));
+
+		m_codeGen->PushRel(offsetof(CMIPS, m_State.nHI[0]));
+		m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRD].nV[1]));
+
+		m_codeGen->PushRel(offsetof(CMIPS, m_State.nLO1[0]));
+		m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRD].nV[2]));
+
+		m_codeGen->PushRel(offsetof(CMIPS, m_State.nHI1[0]));
+		m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRD].nV[3]));
+	}
+}
+
+void CMA_EE::Generic_PHMxxH(bool isSubtract)
+{
+	//Word n = (Bn0 * Bn1) +/- (An0 * An1), A and B being the lower and upper halfwords
+
+	static const size_t offsets[4] =
+	    {
+	        offsetof(CMIPS, m_State.nLO[0]),
+	        offsetof(CMIPS, m_State.nHI[0]),
+	        offsetof(CMIPS, m_State.nLO1[0]),
+	        offsetof(CMIPS, m_State.nHI1[0]),
+	    };
+
+	static const size_t clearOffsets[4] =
+	    {
+	        offsetof(CMIPS, m_State.nLO[1]),
+	        offsetof(CMIPS, m_State.nHI[1]),
+	        offsetof(CMIPS, m_State.nLO1[1]),
+	        offsetof(CMIPS, m_State.nHI1[1]),
+	    };
+
+	for(unsigned int i = 0; i < 4; i++)
+	{
+		m_codeGen->PushCst(0);
+		m_codeGen->PullRel(clearOffsets[i]);
+	}
+
+	for(unsigned int i = 0; i < 4; i++)
+	{
+		//Higher 16-bits (Bn0 * Bn1)
+		{
+			m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRS].nV[i]));
+			m_codeGen->Sra(16);
+
+			m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[i]));
+			m_codeGen->Sra(16);
+
+			m_codeGen->MultS();
+			m_codeGen->ExtLow64();
+		}
+
+		//Lower 16-bits (An0 * An1)
 		{
-			unsigned int regOffset = i * 2;
+			m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRS].nV[i]));
+			m_codeGen->SignExt16();
 
-			m_codeGen->PushRel(GetLoOffset(regOffset));
-			m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRD].nV[regOffset + 0]));
+			m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[i]));
+			m_codeGen->SignExt16();
 
-			m_codeGen->PushRel(GetHiOffset(regOffset));
-			m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRD].nV[regOffset + 1]));
+			m_codeGen->MultS();
+			m_codeGen->ExtLow64();
+		}
+
+		if(isSubtract)
+		{
+			m_codeGen->Sub();
+		}
+		else
+		{
+			m_codeGen->Add();
 		}
+
+		if(m_nRD != 0)
+		{
+			m_codeGen->PushTop();
+			m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRD].nV[i]));
+		}
+
+		//Store to LO/HI
+		m_codeGen->PullRel(offsets[i]);
 	}
 }
 
@@ -1788,6 +2089,8 @@ void CMA_EE::Generic_PSxxV(const TemplateOperationFunctionType& function)
 {
 	if(m_nRD == 0) return;
 
+	//Stays scalar: MD shifts only take an immediate amount shared by all lanes, and only two
+	//lanes are shifted here, so a vector version would need more operations than this.
 	for(unsigned int i = 0; i < 2; i++)
 	{
 		m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[i * 2]));
@@ -1815,13 +2118,13 @@ CMA_EE::InstructionFuncConstant CMA_EE::m_pOpMmi0[0x20] =
 	//0x10
 	&CMA_EE::PADDSW,		&CMA_EE::PSUBSW,		&CMA_EE::PEXTLW,		&CMA_EE::PPACW,			&CMA_EE::PADDSH,		&CMA_EE::PSUBSH,		&CMA_EE::PEXTLH,		&CMA_EE::PPACH,
 	//0x18
-	&CMA_EE::PADDSB,		&CMA_EE::Illegal,		&CMA_EE::PEXTLB,		&CMA_EE::PPACB,			&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::PEXT5,			&CMA_EE::PPAC5,
+	&CMA_EE::PADDSB,		&CMA_EE::PSUBSB,		&CMA_EE::PEXTLB,		&CMA_EE::PPACB,			&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::PEXT5,			&CMA_EE::PPAC5,
 };
 
 CMA_EE::InstructionFuncConstant CMA_EE::m_pOpMmi1[0x20] = 
 {
 	//0x00
-	&CMA_EE::Illegal,		&CMA_EE::PABSW,			&CMA_EE::PCEQW,			&CMA_EE::PMINW,			&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::PCEQH,			&CMA_EE::PMINH,
+	&CMA_EE::Illegal,		&CMA_EE::PABSW,			&CMA_EE::PCEQW,			&CMA_EE::PMINW,			&CMA_EE::PADSBH,		&CMA_EE::PABSH,			&CMA_EE::PCEQH,			&CMA_EE::PMINH,
 	//0x08
 	&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::PCEQB,			&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::Illegal,
 	//0x10
@@ -1833,21 +2136,21 @@ CMA_EE::InstructionFuncConstant CMA_EE::m_pOpMmi1[0x20] =
 CMA_EE::InstructionFuncConstant CMA_EE::m_pOpMmi2[0x20] = 
 {
 	//0x00
-	&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::PSLLVW,		&CMA_EE::PSRLVW,		&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::Illegal,
+	&CMA_EE::PMADDW,		&CMA_EE::Illegal,		&CMA_EE::PSLLVW,		&CMA_EE::PSRLVW,		&CMA_EE::PMSUBW,		&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::Illegal,
 	//0x08
-	&CMA_EE::PMFHI,			&CMA_EE::PMFLO,			&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::PMULTW,		&CMA_EE::PDIVW,			&CMA_EE::PCPYLD,		&CMA_EE::Illegal,
+	&CMA_EE::PMFHI,			&CMA_EE::PMFLO,			&CMA_EE::PINTH,			&CMA_EE::Illegal,		&CMA_EE::PMULTW,		&CMA_EE::PDIVW,			&CMA_EE::PCPYLD,		&CMA_EE::Illegal,
 	//0x10
-	&CMA_EE::PMADDH,		&CMA_EE::PHMADH,		&CMA_EE::PAND,			&CMA_EE::PXOR,			&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::Illegal,
+	&CMA_EE::PMADDH,		&CMA_EE::PHMADH,		&CMA_EE::PAND,			&CMA_EE::PXOR,			&CMA_EE::PMSUBH,		&CMA_EE::PHMSBH,		&CMA_EE::Illegal,		&CMA_EE::Illegal,
 	//0x18
-	&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::PREVH,			&CMA_EE::PMULTH,		&CMA_EE::Illegal,		&CMA_EE::PEXEW,			&CMA_EE::PROT3W,
+	&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::PEXEH,			&CMA_EE::PREVH,			&CMA_EE::PMULTH,		&CMA_EE::PDIVBW,		&CMA_EE::PEXEW,			&CMA_EE::PROT3W,
 };
 
 CMA_EE::InstructionFuncConstant CMA_EE::m_pOpMmi3[0x20] = 
 {
 	//0x00
-	&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::PSRAVW,		&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::Illegal,
+	&CMA_EE::PMADDUW,		&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::PSRAVW,		&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::Illegal,
 	//0x08
-	&CMA_EE::PMTHI,			&CMA_EE::PMTLO,			&CMA_EE::PINTEH,		&CMA_EE::Illegal,		&CMA_EE::PMULTUW,		&CMA_EE::Illegal,		&CMA_EE::PCPYUD,		&CMA_EE::Illegal,
+	&CMA_EE::PMTHI,			&CMA_EE::PMTLO,			&CMA_EE::PINTEH,		&CMA_EE::Illegal,		&CMA_EE::PMULTUW,		&CMA_EE::PDIVUW,		&CMA_EE::PCPYUD,		&CMA_EE::Illegal,
 	//0x10
 	&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::POR,			&CMA_EE::PNOR,			&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::Illegal,
 	//0x18
@@ -1857,7 +2160,7 @@ CMA_EE::InstructionFuncConstant CMA_EE::m_pOpMmi3[0x20] =
 CMA_EE::InstructionFuncConstant CMA_EE::m_pOpPmfhl[0x20] = 
 {
 	//0x00
-	&CMA_EE::PMFHL_LW,		&CMA_EE::PMFHL_UW,		&CMA_EE::Illegal,		&CMA_EE::PMFHL_LH,		&CMA_EE::PMFHL_SH,		&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::Illegal,
+	&CMA_EE::PMFHL_LW,		&CMA_EE::PMFHL_UW,		&CMA_EE::PMFHL_SLW,		&CMA_EE::PMFHL_LH,		&CMA_EE::PMFHL_SH,		&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::Illegal,
 	//0x08
 	&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::Illegal,		&CMA_EE::Illegal,
 	//0x10
@@ -37,6 +37,13 @@ protected:
 	MIPSReflection::SUBTABLE m_ReflPmfhlTable;
 
 private:
+	enum MULTIPLY_MODE
+	{
+		MULTIPLY_MODE_SET,
+		MULTIPLY_MODE_ADD,
+		MULTIPLY_MODE_SUB,
+	};
+
 	void PushVector(unsigned int);
 	void PullVector(unsigned int);
 	size_t GetLoOffset(unsigned int);
@@ -73,6 +80,7 @@ private:
 	void MMI1();
 	void MMI3();
 	void PMFHL();
+	void PMTHL();
 	void PSLLH();
 	void PSRLH();
 	void PSRAH();
@@ -101,6 +109,7 @@ private:
 	void PEXTLH();
 	void PPACH();
 	void PADDSB();
+	void PSUBSB();
 	void PEXTLB();
 	void PPACB();
 	void PEXT5();
@@ -110,6 +119,8 @@ private:
 	void PABSW();
 	void PCEQW();
 	void PMINW();
+	void PADSBH();
+	void PABSH();
 	void PCEQH();
 	void PMINH();
 	void PCEQB();
@@ -125,10 +136,13 @@ private:
 	void QFSRV();
 
 	//Mmi2
+	void PMADDW();
 	void PSLLVW();
 	void PSRLVW();
+	void PMSUBW();
 	void PMFHI();
 	void PMFLO();
+	void PINTH();
 	void PMULTW();
 	void PDIVW();
 	void PCPYLD();
@@ -136,17 +150,23 @@ private:
 	void PHMADH();
 	void PAND();
 	void PXOR();
+	void PMSUBH();
+	void PHMSBH();
+	void PEXEH();
 	void PREVH();
 	void PMULTH();
+	void PDIVBW();
 	void PEXEW();
 	void PROT3W();
 
 	//Mmi3
+	void PMADDUW();
 	void PSRAVW();
 	void PMTHI();
 	void PMTLO();
 	void PINTEH();
 	void PMULTUW();
+	void PDIVUW();
 	void PCPYUD();
 	void POR();
 	void PNOR();
@@ -157,11 +177,14 @@ private:
 	//Pmfhl
 	void PMFHL_LW();
 	void PMFHL_UW();
+	void PMFHL_SLW();
 	void PMFHL_LH();
 	void PMFHL_SH();
 
 	void Generic_MADD(unsigned int unit, bool isSigned);
-	void Generic_PMULTW(bool);
+	void Generic_PMULTW(bool, MULTIPLY_MODE);
+	void Generic_PMULTH(MULTIPLY_MODE);
+	void Generic_PHMxxH(bool);
 	void Generic_PSxxV(const TemplateOperationFunctionType&);
 
 	//Reflection tables
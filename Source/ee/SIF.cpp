@@ -1,6 +1,8 @@
+#include <algorithm>
 #include <cstring>
 #include <stdio.h>
 #include "../Log.h"
+#include "../TraceLog.h"
 #include "../Ps2Const.h"
 #include "../states/StructCollectionStateFile.h"
 #include "../states/MemoryStateFile.h"
@@ -76,11 +78,18 @@ void CSIF::Reset()
 	m_cmdBufferSize = 0;
 
 	m_packetQueue.clear();
+	m_savedPacketQueue.clear();
 	m_packetProcessed = true;
 
 	m_callReplies.clear();
 	m_bindReplies.clear();
 
+	m_currentStats = STATS();
+	{
+		std::lock_guard<std::mutex> frameStatsLock(m_frameStatsMutex);
+		m_frameStats = STATS();
+	}
+
 	DeleteModules();
 }
 
@@ -124,13 +133,43 @@ void CSIF::DeleteModules()
 	m_modules.clear();
 }
 
+void CSIF::CountCopy(uint32 size)
+{
+	m_currentStats.copyCount++;
+	m_currentStats.bytesMoved += size;
+}
+
+CSIF::STATS CSIF::GetFrameStats()
+{
+	std::lock_guard<std::mutex> frameStatsLock(m_frameStatsMutex);
+	return m_frameStats;
+}
+
+void CSIF::EndFrame()
+{
+	std::lock_guard<std::mutex> frameStatsLock(m_frameStatsMutex);
+	m_frameStats = m_currentStats;
+	m_currentStats = STATS();
+}
+
 uint32 CSIF::ReceiveDMA5(uint32 srcAddress, uint32 size, uint32 unused, bool isTagIncluded)
 {
 	if(size > m_dmaBufferSize)
 	{
 		throw std::runtime_error("Packet too big.");
 	}
-	memcpy(m_eeRam + srcAddress, m_iopRam + m_dmaBufferAddress, size);
+	if(m_dma5Source)
+	{
+		//Transfer started by SendDMA, read straight from the packet instead of staging it in IOP RAM
+		uint32 copySize = std::min(size, m_dma5SourceSize);
+		memcpy(m_eeRam + srcAddress, m_dma5Source, copySize);
+		memset(m_eeRam + srcAddress + copySize, 0, size - copySize);
+	}
+	else
+	{
+		memcpy(m_eeRam + srcAddress, m_iopRam + m_dmaBufferAddress, size);
+	}
+	CountCopy(size);
 	return size;
 }
 
@@ -166,7 +205,7 @@ uint32 CSIF::ReceiveDMA6(uint32 nSrcAddr, uint32 nSize, uint32 nDstAddr, bool is
 	{
 		auto hdr = reinterpret_cast<SIFCMDHEADER*>(m_eeRam + nSrcAddr);
 
-		CLog::GetInstance().Print(LOG_NAME, "Received command 0x%08X.\r\n", hdr->commandId);
+		TRACE_EVENT(TRACE_SUBSYSTEM_SIF, "Received command 0x%08X.", hdr->commandId);
 
 		switch(hdr->commandId)
 		{
@@ -189,6 +228,7 @@ uint32 CSIF::ReceiveDMA6(uint32 nSrcAddr, uint32 nSize, uint32 nDstAddr, bool is
 			if(m_customCommandHandler)
 			{
 				memcpy(m_iopRam + nDstAddr, m_eeRam + nSrcAddr, nSize);
+				CountCopy(nSize);
 				m_customCommandHandler(nDstAddr);
 			}
 			break;
@@ -199,16 +239,17 @@ uint32 CSIF::ReceiveDMA6(uint32 nSrcAddr, uint32 nSize, uint32 nDstAddr, bool is
 	else
 	{
 		assert(nDstAddr < PS2::IOP_RAM_SIZE);
-		CLog::GetInstance().Print(LOG_NAME, "WriteToIop(dstAddr = 0x%08X, srcAddr = 0x%08X, size = 0x%08X);\r\n",
-		                          nDstAddr, nSrcAddr, nSize);
+		TRACE_EVENT(TRACE_SUBSYSTEM_SIF, "WriteToIop(dstAddr = 0x%08X, srcAddr = 0x%08X, size = 0x%08X);",
+		            nDstAddr, nSrcAddr, nSize);
 		nSize &= 0x7FFFFFFF; //Fix for Gregory Horror Show's crash
 		if(nDstAddr >= 0 && nDstAddr <= CIopBios::CONTROL_BLOCK_END)
 		{
-			CLog::GetInstance().Print(LOG_NAME, "Warning: Trying to DMA in Bios Control Area.\r\n");
+			TRACE_EVENT(TRACE_SUBSYSTEM_SIF, "Warning: Trying to DMA in Bios Control Area.");
 		}
 		else
 		{
 			memcpy(m_iopRam + nDstAddr, m_eeRam + nSrcAddr, nSize);
+			CountCopy(nSize);
 		}
 		return nSize;
 	}
@@ -216,12 +257,14 @@ uint32 CSIF::ReceiveDMA6(uint32 nSrcAddr, uint32 nSize, uint32 nDstAddr, bool is
 
 void CSIF::SendPacket(void* packet, uint32 size)
 {
-	m_packetQueue.insert(m_packetQueue.begin(),
+	m_packetQueue.insert(m_packetQueue.end(),
 	                     reinterpret_cast<uint8*>(packet),
 	                     reinterpret_cast<uint8*>(packet) + size);
-	m_packetQueue.insert(m_packetQueue.begin(),
+	m_packetQueue.insert(m_packetQueue.end(),
 	                     reinterpret_cast<uint8*>(&size),
 	                     reinterpret_cast<uint8*>(&size) + 4);
+	m_currentStats.packetCount++;
+	CountCopy(size);
 }
 
 void CSIF::ProcessPackets()
@@ -229,9 +272,12 @@ void CSIF::ProcessPackets()
 	if(m_packetProcessed && !m_packetQueue.empty())
 	{
 		assert(m_packetQueue.size() > 4);
-		uint32 size = *reinterpret_cast<uint32*>(&m_packetQueue[0]);
-		SendDMA(&m_packetQueue[4], size);
-		m_packetQueue.erase(m_packetQueue.begin(), m_packetQueue.begin() + 4 + size);
+		uint32 packetEnd = static_cast<uint32>(m_packetQueue.size()) - 4;
+		uint32 size = *reinterpret_cast<uint32*>(&m_packetQueue[packetEnd]);
+		assert(size <= packetEnd);
+		uint32 packetStart = packetEnd - size;
+		SendDMA(&m_packetQueue[packetStart], size);
+		m_packetQueue.resize(packetStart);
 		m_packetProcessed = false;
 	}
 }
@@ -242,7 +288,7 @@ void CSIF::MarkPacketProcessed()
 	m_packetProcessed = true;
 }
 
-void CSIF::SendDMA(void* pData, uint32 nSize)
+void CSIF::SendDMA(const void* pData, uint32 nSize)
 {
 	//Humm, the DMAC doesn't know about our addresses on this side...
 
@@ -251,12 +297,47 @@ void CSIF::SendDMA(void* pData, uint32 nSize)
 		throw std::runtime_error("Packet too big.");
 	}
 
-	memcpy(m_iopRam + m_dmaBufferAddress, pData, nSize);
 	uint32 nQuads = (nSize + 0x0F) / 0x10;
 
+	//DMAC calls ReceiveDMA5 before returning, source only needs to live until then
+	m_dma5Source = reinterpret_cast<const uint8*>(pData);
+	m_dma5SourceSize = nSize;
+
 	m_dmac.SetRegister(CDMAC::D5_MADR, m_nEERecvAddr);
 	m_dmac.SetRegister(CDMAC::D5_QWC, nQuads);
 	m_dmac.SetRegister(CDMAC::D5_CHCR, CDMAC::CHCR_STR);
+
+	m_dma5Source = nullptr;
+	m_dma5SourceSize = 0;
+}
+
+void CSIF::SendDmaChain(const SIFDMAREG* dmaRegs, uint32 count)
+{
+	//Entries that continue the previous one on both sides are merged in a single copy
+	uint32 index = 0;
+	while(index < count)
+	{
+		uint32 srcAddr = dmaRegs[index].srcAddr;
+		uint32 dstAddr = dmaRegs[index].dstAddr & (PS2::EE_RAM_SIZE - 1);
+		uint32 size = dmaRegs[index].size;
+		for(index++; index < count; index++)
+		{
+			const auto& dmaReg = dmaRegs[index];
+			if(dmaReg.srcAddr != (srcAddr + size)) break;
+			if((dmaReg.dstAddr & (PS2::EE_RAM_SIZE - 1)) != (dstAddr + size)) break;
+			size += dmaReg.size;
+		}
+		memcpy(m_eeRam + dstAddr, m_iopRam + srcAddr, size);
+		CountCopy(size);
+	}
+}
+
+void CSIF::ReceiveOtherData(uint32 dstAddr, uint32 srcAddr, uint32 size)
+{
+	uint8* srcPtr = m_eeRam + (srcAddr & (PS2::EE_RAM_SIZE - 1));
+	uint8* dstPtr = m_iopRam + dstAddr;
+	memcpy(dstPtr, srcPtr, size);
+	CountCopy(size);
 }
 
 void CSIF::LoadState(Framework::CZipArchiveReader& archive)
@@ -272,7 +353,7 @@ void CSIF::LoadState(Framework::CZipArchiveReader& archive)
 		m_packetProcessed = registerFile.GetRegister32(STATE_REG_PACKETPROCESSED) != 0;
 	}
 
-	m_packetQueue = LoadPacketQueue(archive);
+	DeserializePacketQueue(ReadPacketQueue(archive));
 
 	m_callReplies = LoadCallReplies(archive);
 	m_bindReplies = LoadBindReplies(archive);
@@ -292,7 +373,9 @@ void CSIF::SaveState(Framework::CZipArchiveWriter& archive)
 		archive.InsertFile(registerFile);
 	}
 
-	archive.InsertFile(new CMemoryStateFile(STATE_PACKETQUEUE, m_packetQueue.data(), m_packetQueue.size()));
+	//Kept alive until the next save since the archive only references the data
+	m_savedPacketQueue = SerializePacketQueue();
+	archive.InsertFile(new CMemoryStateFile(STATE_PACKETQUEUE, m_savedPacketQueue.data(), m_savedPacketQueue.size()));
 
 	SaveCallReplies(archive);
 	SaveBindReplies(archive);
@@ -331,7 +414,7 @@ void CSIF::SaveBindReplies(Framework::CZipArchiveWriter& archive)
 	archive.InsertFile(bindRepliesFile);
 }
 
-CSIF::PacketQueue CSIF::LoadPacketQueue(Framework::CZipArchiveReader& archive)
+CSIF::PacketQueue CSIF::ReadPacketQueue(Framework::CZipArchiveReader& archive)
 {
 	PacketQueue packetQueue;
 	auto file = archive.BeginReadFile(STATE_PACKETQUEUE);
@@ -346,6 +429,60 @@ CSIF::PacketQueue CSIF::LoadPacketQueue(Framework::CZipArchiveReader& archive)
 	return packetQueue;
 }
 
+//Saved queue lists packets in sending order, each one preceded by its size
+CSIF::PacketQueue CSIF::SerializePacketQueue() const
+{
+	PacketQueue result;
+	result.reserve(m_packetQueue.size());
+	uint32 packetEnd = static_cast<uint32>(m_packetQueue.size());
+	while(packetEnd != 0)
+	{
+		uint32 size = *reinterpret_cast<const uint32*>(&m_packetQueue[packetEnd - 4]);
+		uint32 packetStart = packetEnd - 4 - size;
+		result.insert(std::end(result),
+		              reinterpret_cast<const uint8*>(&size),
+		              reinterpret_cast<const uint8*>(&size) + 4);
+		result.insert(std::end(result),
+		              m_packetQueue.begin() + packetStart,
+		              m_packetQueue.begin() + packetStart + size);
+		packetEnd = packetStart;
+	}
+	return result;
+}
+
+void CSIF::DeserializePacketQueue(const PacketQueue& savedQueue)
+{
+	std::vector<uint32> packetOffsets;
+	for(uint32 offset = 0; offset < savedQueue.size();)
+	{
+		if((offset + 4) > savedQueue.size())
+		{
+			throw std::runtime_error("Invalid packet queue.");
+		}
+		uint32 size = *reinterpret_cast<const uint32*>(&savedQueue[offset]);
+		if((offset + 4 + size) > savedQueue.size())
+		{
+			throw std::runtime_error("Invalid packet queue.");
+		}
+		packetOffsets.push_back(offset);
+		offset += 4 + size;
+	}
+
+	m_packetQueue.clear();
+	m_packetQueue.reserve(savedQueue.size());
+	for(auto offsetIterator = packetOffsets.rbegin(); offsetIterator != packetOffsets.rend(); offsetIterator++)
+	{
+		uint32 offset = *offsetIterator;
+		uint32 size = *reinterpret_cast<const uint32*>(&savedQueue[offset]);
+		m_packetQueue.insert(std::end(m_packetQueue),
+		                     savedQueue.begin() + offset + 4,
+		                     savedQueue.begin() + offset + 4 + size);
+		m_packetQueue.insert(std::end(m_packetQueue),
+		                     reinterpret_cast<const uint8*>(&size),
+		                     reinterpret_cast<const uint8*>(&size) + 4);
+	}
+}
+
 CSIF::CallReplyMap CSIF::LoadCallReplies(Framework::CZipArchiveReader& archive)
 {
 	CallReplyMap callReplies;
@@ -513,7 +650,7 @@ void CSIF::Cmd_Bind(const SIFCMDHEADER* hdr)
 	rend.buffer = RPC_RECVADDR;
 	rend.cbuffer = 0xDEADCAFE;
 
-	CLog::GetInstance().Print(LOG_NAME, "Bound client data (0x%08X) with server id 0x%08X.\r\n", bind->clientDataAddr, bind->serverId);
+	TRACE_EVENT(TRACE_SUBSYSTEM_SIF, "Bound client data (0x%08X) with server id 0x%08X.", bind->clientDataAddr, bind->serverId);
 
 	auto moduleIterator(m_modules.find(bind->serverId));
 	if(moduleIterator != m_modules.end())
@@ -532,7 +669,7 @@ void CSIF::Cmd_Call(const SIFCMDHEADER* hdr)
 	auto call = reinterpret_cast<const SIFRPCCALL*>(hdr);
 	bool sendReply = true;
 
-	CLog::GetInstance().Print(LOG_NAME, "Calling function 0x%08X of module 0x%08X.\r\n", call->rpcNumber, call->serverDataAddr);
+	TRACE_EVENT(TRACE_SUBSYSTEM_SIF, "Calling function 0x%08X of module 0x%08X.", call->rpcNumber, call->serverDataAddr);
 
 	uint32 nRecvAddr = (call->recv & (PS2::EE_RAM_SIZE - 1));
 
@@ -547,7 +684,7 @@ void CSIF::Cmd_Call(const SIFCMDHEADER* hdr)
 	}
 	else
 	{
-		CLog::GetInstance().Print(LOG_NAME, "Called an unknown module (0x%08X).\r\n", call->serverDataAddr);
+		TRACE_EVENT(TRACE_SUBSYSTEM_SIF, "Called an unknown module (0x%08X).", call->serverDataAddr);
 	}
 
 	{
@@ -584,13 +721,14 @@ void CSIF::Cmd_GetOtherData(const SIFCMDHEADER* hdr)
 {
 	auto otherData = reinterpret_cast<const SIFRPCOTHERDATA*>(hdr);
 
-	CLog::GetInstance().Print(LOG_NAME, "GetOtherData(dstPtr = 0x%08X, srcPtr = 0x%08X, size = 0x%08X);\r\n",
-	                          otherData->dstPtr, otherData->srcPtr, otherData->size);
+	TRACE_EVENT(TRACE_SUBSYSTEM_SIF, "GetOtherData(dstPtr = 0x%08X, srcPtr = 0x%08X, size = 0x%08X);",
+	            otherData->dstPtr, otherData->srcPtr, otherData->size);
 
 	uint32 dstPtr = otherData->dstPtr & (PS2::EE_RAM_SIZE - 1);
 	uint32 srcPtr = otherData->srcPtr & (PS2::IOP_RAM_SIZE - 1);
 
 	memcpy(m_eeRam + dstPtr, m_iopRam + srcPtr, otherData->size);
+	CountCopy(otherData->size);
 
 	{
 		SIFRPCREQUESTEND rend;
@@ -611,7 +749,7 @@ void CSIF::Cmd_GetOtherData(const SIFCMDHEADER* hdr)
 
 void CSIF::SendCallReply(uint32 serverId, const void* returnData)
 {
-	CLog::GetInstance().Print(LOG_NAME, "Processing call reply from serverId: 0x%08X\r\n", serverId);
+	TRACE_EVENT(TRACE_SUBSYSTEM_SIF, "Processing call reply from serverId: 0x%08X", serverId);
 
 	auto replyIterator(m_callReplies.find(serverId));
 	assert(replyIterator != m_callReplies.end());
@@ -626,6 +764,7 @@ void CSIF::SendCallReply(uint32 serverId, const void* returnData)
 		assert((requestInfo.call.recvSize & 0x03) == 0);
 		uint32 dstSize = (requestInfo.call.recvSize + 0x03) & ~0x03;
 		memcpy(m_eeRam + dstPtr, returnData, dstSize);
+		CountCopy(dstSize);
 	}
 	SendPacket(&requestInfo.reply, sizeof(SIFRPCREQUESTEND));
 	m_callReplies.erase(replyIterator);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <map>
+#include <mutex>
 #include <vector>
 #include "../SifDefs.h"
 #include "../SifModule.h"
@@ -16,6 +17,13 @@ public:
 	typedef std::function<void(const std::string&)> ModuleResetHandler;
 	typedef std::function<void(uint32)> CustomCommandHandler;
 
+	struct STATS
+	{
+		uint32 packetCount = 0;
+		uint32 copyCount = 0;
+		uint64 bytesMoved = 0;
+	};
+
 	CSIF(CDMAC&, uint8*, uint8*);
 	virtual ~CSIF() = default;
 
@@ -38,7 +46,15 @@ public:
 
 	void SendPacket(void*, uint32);
 
-	void SendDMA(void*, uint32);
+	void SendDMA(const void*, uint32);
+
+	//Transfers initiated by the IOP (SifSetDma, SifGetOtherData)
+	void SendDmaChain(const SIFDMAREG*, uint32);
+	void ReceiveOtherData(uint32, uint32, uint32);
+
+	//Counters of the last completed frame
+	STATS GetFrameStats();
+	void EndFrame();
 
 	uint32 GetRegister(uint32);
 	void SetRegister(uint32, uint32);
@@ -59,11 +75,15 @@ private:
 	typedef std::map<uint32, SIFRPCREQUESTEND> BindReplyMap;
 
 	void DeleteModules();
+	void CountCopy(uint32);
+
+	PacketQueue SerializePacketQueue() const;
+	void DeserializePacketQueue(const PacketQueue&);
 
 	void SaveCallReplies(Framework::CZipArchiveWriter&);
 	void SaveBindReplies(Framework::CZipArchiveWriter&);
 
-	static PacketQueue LoadPacketQueue(Framework::CZipArchiveReader&);
+	static PacketQueue ReadPacketQueue(Framework::CZipArchiveReader&);
 	static CallReplyMap LoadCallReplies(Framework::CZipArchiveReader&);
 	static BindReplyMap LoadBindReplies(Framework::CZipArchiveReader&);
 
@@ -99,9 +119,20 @@ private:
 
 	ModuleMap m_modules;
 
+	//Packets are stored back to back as they come in (data followed by size) and
+	//the most recent one is sent first
 	PacketQueue m_packetQueue;
+	PacketQueue m_savedPacketQueue;
 	bool m_packetProcessed;
 
+	//Source of the SIF0 transfer started by SendDMA, DMAC completes it synchronously
+	const uint8* m_dma5Source = nullptr;
+	uint32 m_dma5SourceSize = 0;
+
+	STATS m_currentStats;
+	STATS m_frameStats;
+	std::mutex m_frameStatsMutex;
+
 	CallReplyMap m_callReplies;
 	BindReplyMap m_bindReplies;
 
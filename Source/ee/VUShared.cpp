@@ -2,7 +2,6 @@
 #include "../MIPS.h"
 #include "../MemoryUtils.h"
 #include "offsetof_def.h"
-#include "FpAddTruncate.h"
 #include "../FpUtils.h"
 
 #define STATUS_Z 0x01
@@ -164,6 +163,74 @@ void VUShared::ClampVector(CMipsJitter* codeGen)
 	codeGen->MD_And();
 }
 
+void VUShared::PushTruncatedAddOperand(CMipsJitter* codeGen, size_t operand, bool operandExpand, size_t other, bool otherExpand)
+{
+	//Pushes an operand of an addition the way the FMAC sees it: denormals are flushed to zero and
+	//bits shifted past the guard bits when aligning it to the other operand are dropped.
+	//Adding two of these while rounding toward zero gives the same result as FpAddTruncate.
+	auto pushValue = [codeGen](size_t offset, bool expand) {
+		if(expand)
+		{
+			codeGen->MD_PushRelExpand(offset);
+		}
+		else
+		{
+			codeGen->MD_PushRel(offset);
+		}
+	};
+
+	auto pushExponent = [codeGen, &pushValue](size_t offset, bool expand) {
+		pushValue(offset, expand);
+		codeGen->MD_SrlW(23);
+		codeGen->MD_PushCstExpand(0xFFU);
+		codeGen->MD_And();
+	};
+
+	pushValue(operand, operandExpand);
+
+	//Compute shift amount (exponent difference minus 3 guard bits), denormals are shifted out completely
+	pushExponent(operand, operandExpand);
+	pushExponent(other, otherExpand);
+	codeGen->MD_MaxW();
+	pushExponent(operand, operandExpand);
+	codeGen->MD_SubW();
+	codeGen->MD_PushCstExpand(3U);
+	codeGen->MD_SubW();
+	codeGen->MD_PushCstExpand(0U);
+	codeGen->MD_MaxW();
+	pushExponent(operand, operandExpand);
+	codeGen->MD_PushCstExpand(0U);
+	codeGen->MD_CmpEqW();
+	codeGen->MD_SrlW(1);
+	codeGen->MD_Or();
+
+	//If the whole significand is shifted out, only the sign is left: use a shift of 31
+	codeGen->PushTop();
+	codeGen->MD_PushCstExpand(23U);
+	codeGen->MD_CmpGtW();
+	codeGen->MD_PushCstExpand(31U);
+	codeGen->MD_And();
+	codeGen->MD_Or();
+	codeGen->MD_PushCstExpand(31U);
+	codeGen->MD_MinW();
+
+	//Clear shifted out bits, mask is -(2^shift) obtained by converting that value from a float
+	codeGen->MD_PushCstExpand(127U);
+	codeGen->MD_AddW();
+	codeGen->MD_SllW(23);
+	codeGen->MD_PushCstExpand(0x80000000U);
+	codeGen->MD_Or();
+	codeGen->MD_ToWordTruncate();
+	codeGen->MD_And();
+}
+
+void VUShared::PushTruncatedAddOperands(CMipsJitter* codeGen, size_t fs, size_t ft, bool expand)
+{
+	//Result of the addition or subtraction that follows needs to match FpAddTruncate's
+	PushTruncatedAddOperand(codeGen, fs, false, ft, expand);
+	PushTruncatedAddOperand(codeGen, ft, expand, fs, false);
+}
+
 void VUShared::TestSZFlags(CMipsJitter* codeGen, uint8 dest, size_t regOffset, uint32 relativePipeTime)
 {
 	codeGen->MD_PushRel(regOffset);
@@ -303,15 +370,7 @@ void VUShared::SetStatus(CMipsJitter* codeGen, size_t srcOffset)
 
 void VUShared::ADDA_base(CMipsJitter* codeGen, uint8 dest, size_t fs, size_t ft, bool expand, uint32 relativePipeTime)
 {
-	codeGen->MD_PushRel(fs);
-	if(expand)
-	{
-		codeGen->MD_PushRelExpand(ft);
-	}
-	else
-	{
-		codeGen->MD_PushRel(ft);
-	}
+	PushTruncatedAddOperands(codeGen, fs, ft, expand);
 	codeGen->MD_AddS();
 	PullVector(codeGen, dest, offsetof(CMIPS, m_State.nCOP2A));
 	TestSZFlags(codeGen, dest, offsetof(CMIPS, m_State.nCOP2A), relativePipeTime);
@@ -319,7 +378,8 @@ void VUShared::ADDA_base(CMipsJitter* codeGen, uint8 dest, size_t fs, size_t ft,
 
 void VUShared::MADD_base(CMipsJitter* codeGen, uint8 dest, size_t fd, size_t fs, size_t ft, bool expand, uint32 relativePipeTime)
 {
-	codeGen->MD_PushRel(offsetof(CMIPS, m_State.nCOP2A));
+	//Product is rounded on its own before being accumulated, keep it in the temporary register
+	size_t productOffset = offsetof(CMIPS, m_State.nCOP2[32]);
 	codeGen->MD_PushRel(fs);
 	//Clamping is needed by Baldur's Gate Deadly Alliance here because it multiplies junk values (potentially NaN/INF) by 0
 	ClampVector(codeGen);
@@ -332,6 +392,8 @@ void VUShared::MADD_base(CMipsJitter* codeGen, uint8 dest, size_t fd, size_t fs,
 		codeGen->MD_PushRel(ft);
 	}
 	codeGen->MD_MulS();
+	codeGen->MD_PullRel(productOffset);
+	PushTruncatedAddOperands(codeGen, offsetof(CMIPS, m_State.nCOP2A), productOffset, false);
 	codeGen->MD_AddS();
 	PullVector(codeGen, dest, fd);
 	TestSZFlags(codeGen, dest, fd, relativePipeTime);
@@ -339,7 +401,8 @@ void VUShared::MADD_base(CMipsJitter* codeGen, uint8 dest, size_t fd, size_t fs,
 
 void VUShared::MADDA_base(CMipsJitter* codeGen, uint8 dest, size_t fs, size_t ft, bool expand, uint32 relativePipeTime)
 {
-	codeGen->MD_PushRel(offsetof(CMIPS, m_State.nCOP2A));
+	//Product is rounded on its own before being accumulated, keep it in the temporary register
+	size_t productOffset = offsetof(CMIPS, m_State.nCOP2[32]);
 	codeGen->MD_PushRel(fs);
 	//Clamping is needed by Dynasty Warriors 2 here because it multiplies junk values (potentially NaN/INF) by some other value
 	ClampVector(codeGen);
@@ -352,6 +415,8 @@ void VUShared::MADDA_base(CMipsJitter* codeGen, uint8 dest, size_t fs, size_t ft
 		codeGen->MD_PushRel(ft);
 	}
 	codeGen->MD_MulS();
+	codeGen->MD_PullRel(productOffset);
+	PushTruncatedAddOperands(codeGen, offsetof(CMIPS, m_State.nCOP2A), productOffset, false);
 	codeGen->MD_AddS();
 	PullVector(codeGen, dest, offsetof(CMIPS, m_State.nCOP2A));
 	TestSZFlags(codeGen, dest, offsetof(CMIPS, m_State.nCOP2A), relativePipeTime);
@@ -359,15 +424,7 @@ void VUShared::MADDA_base(CMipsJitter* codeGen, uint8 dest, size_t fs, size_t ft
 
 void VUShared::SUB_base(CMipsJitter* codeGen, uint8 dest, size_t fd, size_t fs, size_t ft, bool expand, uint32 relativePipeTime)
 {
-	codeGen->MD_PushRel(fs);
-	if(expand)
-	{
-		codeGen->MD_PushRelExpand(ft);
-	}
-	else
-	{
-		codeGen->MD_PushRel(ft);
-	}
+	PushTruncatedAddOperands(codeGen, fs, ft, expand);
 	codeGen->MD_SubS();
 	PullVector(codeGen, dest, fd);
 	TestSZFlags(codeGen, dest, fd, relativePipeTime);
@@ -375,15 +432,7 @@ void VUShared::SUB_base(CMipsJitter* codeGen, uint8 dest, size_t fd, size_t fs,
 
 void VUShared::SUBA_base(CMipsJitter* codeGen, uint8 dest, size_t fs, size_t ft, bool expand, uint32 relativePipeTime)
 {
-	codeGen->MD_PushRel(fs);
-	if(expand)
-	{
-		codeGen->MD_PushRelExpand(ft);
-	}
-	else
-	{
-		codeGen->MD_PushRel(ft);
-	}
+	PushTruncatedAddOperands(codeGen, fs, ft, expand);
 	codeGen->MD_SubS();
 	PullVector(codeGen, dest, offsetof(CMIPS, m_State.nCOP2A));
 	TestSZFlags(codeGen, dest, offsetof(CMIPS, m_State.nCOP2A), relativePipeTime);
@@ -391,7 +440,8 @@ void VUShared::SUBA_base(CMipsJitter* codeGen, uint8 dest, size_t fs, size_t ft,
 
 void VUShared::MSUB_base(CMipsJitter* codeGen, uint8 dest, size_t fd, size_t fs, size_t ft, bool expand, uint32 relativePipeTime)
 {
-	codeGen->MD_PushRel(offsetof(CMIPS, m_State.nCOP2A));
+	//Product is rounded on its own before being accumulated, keep it in the temporary register
+	size_t productOffset = offsetof(CMIPS, m_State.nCOP2[32]);
 	codeGen->MD_PushRel(fs);
 	if(expand)
 	{
@@ -402,6 +452,8 @@ void VUShared::MSUB_base(CMipsJitter* codeGen, uint8 dest, size_t fd, size_t fs,
 		codeGen->MD_PushRel(ft);
 	}
 	codeGen->MD_MulS();
+	codeGen->MD_PullRel(productOffset);
+	PushTruncatedAddOperands(codeGen, offsetof(CMIPS, m_State.nCOP2A), productOffset, false);
 	codeGen->MD_SubS();
 	PullVector(codeGen, dest, fd);
 	TestSZFlags(codeGen, dest, fd, relativePipeTime);
@@ -409,7 +461,8 @@ void VUShared::MSUB_base(CMipsJitter* codeGen, uint8 dest, size_t fd, size_t fs,
 
 void VUShared::MSUBA_base(CMipsJitter* codeGen, uint8 dest, size_t fs, size_t ft, bool expand, uint32 relativePipeTime)
 {
-	codeGen->MD_PushRel(offsetof(CMIPS, m_State.nCOP2A));
+	//Product is rounded on its own before being accumulated, keep it in the temporary register
+	size_t productOffset = offsetof(CMIPS, m_State.nCOP2[32]);
 	codeGen->MD_PushRel(fs);
 	if(expand)
 	{
@@ -420,6 +473,8 @@ void VUShared::MSUBA_base(CMipsJitter* codeGen, uint8 dest, size_t fs, size_t ft
 		codeGen->MD_PushRel(ft);
 	}
 	codeGen->MD_MulS();
+	codeGen->MD_PullRel(productOffset);
+	PushTruncatedAddOperands(codeGen, offsetof(CMIPS, m_State.nCOP2A), productOffset, false);
 	codeGen->MD_SubS();
 	PullVector(codeGen, dest, offsetof(CMIPS, m_State.nCOP2A));
 	TestSZFlags(codeGen, dest, offsetof(CMIPS, m_State.nCOP2A), relativePipeTime);
@@ -474,8 +529,7 @@ void VUShared::ADD(CMipsJitter* codeGen, uint8 nDest, uint8 nFd, uint8 nFs, uint
 		nFd = 32;
 	}
 
-	codeGen->MD_PushRel(offsetof(CMIPS, m_State.nCOP2[nFs]));
-	codeGen->MD_PushRel(offsetof(CMIPS, m_State.nCOP2[nFt]));
+	PushTruncatedAddOperands(codeGen, offsetof(CMIPS, m_State.nCOP2[nFs]), offsetof(CMIPS, m_State.nCOP2[nFt]), false);
 	codeGen->MD_AddS();
 	PullVector(codeGen, nDest, offsetof(CMIPS, m_State.nCOP2[nFd]));
 
@@ -492,8 +546,7 @@ void VUShared::ADDbc(CMipsJitter* codeGen, uint8 nDest, uint8 nFd, uint8 nFs, ui
 		nFd = 32;
 	}
 
-	codeGen->MD_PushRel(offsetof(CMIPS, m_State.nCOP2[nFs]));
-	codeGen->MD_PushRelExpand(offsetof(CMIPS, m_State.nCOP2[nFt].nV[nBc]));
+	PushTruncatedAddOperands(codeGen, offsetof(CMIPS, m_State.nCOP2[nFs]), offsetof(CMIPS, m_State.nCOP2[nFt].nV[nBc]), true);
 	codeGen->MD_AddS();
 	PullVector(codeGen, nDest, offsetof(CMIPS, m_State.nCOP2[nFd]));
 
@@ -508,22 +561,9 @@ void VUShared::ADDi(CMipsJitter* codeGen, uint8 nDest, uint8 nFd, uint8 nFs, uin
 		nFd = 32;
 	}
 
-#if 1
-	for(unsigned int i = 0; i < 4; i++)
-	{
-		if(!VUShared::DestinationHasElement(nDest, i)) continue;
-
-		codeGen->PushRel(offsetof(CMIPS, m_State.nCOP2[nFs].nV[i]));
-		codeGen->PushRel(offsetof(CMIPS, m_State.nCOP2I));
-		codeGen->Call(reinterpret_cast<void*>(&FpAddTruncate), 2, true);
-		codeGen->PullRel(offsetof(CMIPS, m_State.nCOP2[nFd].nV[i]));
-	}
-#else
-	codeGen->MD_PushRel(offsetof(CMIPS, m_State.nCOP2[nFs]));
-	codeGen->MD_PushRelExpand(offsetof(CMIPS, m_State.nCOP2I));
+	PushTruncatedAddOperands(codeGen, offsetof(CMIPS, m_State.nCOP2[nFs]), offsetof(CMIPS, m_State.nCOP2I), true);
 	codeGen->MD_AddS();
 	PullVector(codeGen, nDest, offsetof(CMIPS, m_State.nCOP2[nFd]));
-#endif
 
 	TestSZFlags(codeGen, nDest, offsetof(CMIPS, m_State.nCOP2[nFd]), relativePipeTime);
 }
@@ -536,8 +576,7 @@ void VUShared::ADDq(CMipsJitter* codeGen, uint8 nDest, uint8 nFd, uint8 nFs, uin
 		nFd = 32;
 	}
 
-	codeGen->MD_PushRel(offsetof(CMIPS, m_State.nCOP2[nFs]));
-	codeGen->MD_PushRelExpand(offsetof(CMIPS, m_State.nCOP2Q));
+	PushTruncatedAddOperands(codeGen, offsetof(CMIPS, m_State.nCOP2[nFs]), offsetof(CMIPS, m_State.nCOP2Q), true);
 	codeGen->MD_AddS();
 	PullVector(codeGen, nDest, offsetof(CMIPS, m_State.nCOP2[nFd]));
 
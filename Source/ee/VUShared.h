@@ -93,6 +93,8 @@ namespace VUShared
 	void PushIntegerRegister(CMipsJitter*, unsigned int);
 
 	void ClampVector(CMipsJitter*);
+	void PushTruncatedAddOperand(CMipsJitter*, size_t, bool, size_t, bool);
+	void PushTruncatedAddOperands(CMipsJitter*, size_t, size_t, bool);
 	void TestSZFlags(CMipsJitter*, uint8, size_t, uint32);
 
 	void GetStatus(CMipsJitter*, size_t, uint32);
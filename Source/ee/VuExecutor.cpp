@@ -1,3 +1,4 @@
+#include <chrono>
 #include "VuExecutor.h"
 #include "VuBasicBlock.h"
 #include <zlib.h>
@@ -13,6 +14,16 @@ void CVuExecutor::Reset()
 	CGenericMipsExecutor::Reset();
 }
 
+const CVuExecutor::STATS& CVuExecutor::GetStats() const
+{
+	return m_stats;
+}
+
+void CVuExecutor::ResetStats()
+{
+	m_stats = STATS();
+}
+
 BasicBlockPtr CVuExecutor::BlockFactory(CMIPS& context, uint32 begin, uint32 end)
 {
 	uint32 blockSize = ((end - begin) + 4) / 4;
@@ -35,6 +46,7 @@ BasicBlockPtr CVuExecutor::BlockFactory(CMIPS& context, uint32 begin, uint32 end
 	}
 
 	uint32 checksum = crc32(0, reinterpret_cast<Bytef*>(blockMemory), blockSizeByte);
+	m_stats.blockLookupCount++;
 
 	auto equalRange = m_cachedBlocks.equal_range(checksum);
 	for(; equalRange.first != equalRange.second; ++equalRange.first)
@@ -44,13 +56,18 @@ BasicBlockPtr CVuExecutor::BlockFactory(CMIPS& context, uint32 begin, uint32 end
 		{
 			if(basicBlock->GetEndAddress() == end)
 			{
+				m_stats.blockCacheHitCount++;
 				return basicBlock;
 			}
 		}
 	}
 
+	auto compileStartTime = std::chrono::steady_clock::now();
 	auto result = std::make_shared<CVuBasicBlock>(context, begin, end);
 	result->Compile();
+	auto compileEndTime = std::chrono::steady_clock::now();
+	m_stats.compileCount++;
+	m_stats.compileTime += std::chrono::duration_cast<std::chrono::nanoseconds>(compileEndTime - compileStartTime).count();
 	m_cachedBlocks.insert(std::make_pair(checksum, result));
 	return result;
 }
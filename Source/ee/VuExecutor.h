@@ -6,11 +6,23 @@
 class CVuExecutor : public CGenericMipsExecutor<BlockLookupOneWay, 8>
 {
 public:
+	struct STATS
+	{
+		uint32 blockLookupCount = 0;
+		uint32 blockCacheHitCount = 0;
+		uint32 compileCount = 0;
+		uint64 compileTime = 0; //In nanoseconds
+	};
+
 	CVuExecutor(CMIPS&, uint32);
 	virtual ~CVuExecutor() = default;
 
 	void Reset() override;
 
+	//Counters of block creations, blocks are looked up in the compiled block cache before being compiled
+	const STATS& GetStats() const;
+	void ResetStats();
+
 protected:
 	typedef std::unordered_multimap<uint32, BasicBlockPtr> CachedBlockMap;
 
@@ -18,4 +30,5 @@ protected:
 	void PartitionFunction(uint32) override;
 
 	CachedBlockMap m_cachedBlocks;
+	STATS m_stats;
 };
@@ -8,6 +8,8 @@
 #include "../GsPixelFormats.h"
 #include "GSH_OpenGL.h"
 
+#define LOG_NAME "gsh_opengl"
+
 #ifdef USE_DUALSOURCE_BLENDING
 //Dual source blending constants
 #define BLEND_SRC_ALPHA GL_SRC1_ALPHA
@@ -56,6 +58,22 @@ static uint32 MakeColor(uint8 r, uint8 g, uint8 b, uint8 a)
 	return (a << 24) | (b << 16) | (g << 8) | (r);
 }
 
+static bool IsParallelShaderCompileSupported()
+{
+	GLint extensionCount = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+	for(GLint i = 0; i < extensionCount; i++)
+	{
+		auto extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+		if(extension == nullptr) continue;
+		if(!strcmp(extension, "GL_KHR_parallel_shader_compile") || !strcmp(extension, "GL_ARB_parallel_shader_compile"))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
 CGSH_OpenGL::CGSH_OpenGL()
     : m_pCvtBuffer(nullptr)
 {
@@ -76,6 +94,14 @@ CGSH_OpenGL::~CGSH_OpenGL()
 void CGSH_OpenGL::InitializeImpl()
 {
 	InitializeRC();
+	ProgramCache_Load();
+
+	//Without a way to know when the driver is done compiling, programs are generated when needed
+	if(CAppConfig::GetInstance().GetPreferenceBoolean(PREF_CGSH_OPENGL_ASYNCSHADERCOMPILATION) && IsParallelShaderCompileSupported())
+	{
+		m_uberShader = GenerateUberShader();
+		InitializeShader(m_uberShader);
+	}
 
 	m_nVtxCount = 0;
 
@@ -84,6 +110,8 @@ void CGSH_OpenGL::InitializeImpl()
 		m_paletteCache.push_back(PalettePtr(new CPalette()));
 	}
 
+	ProgramCache_Prewarm();
+
 	m_renderState.isValid = false;
 	m_validGlState = 0;
 }
@@ -92,8 +120,12 @@ void CGSH_OpenGL::ReleaseImpl()
 {
 	ResetImpl();
 
+	ProgramCache_Release();
+
 	m_paletteCache.clear();
 	m_shaders.clear();
+	m_pendingShaders.clear();
+	m_uberShader.reset();
 	m_presentProgram.reset();
 	m_presentVertexBuffer.Reset();
 	m_presentVertexArray.Reset();
@@ -124,6 +156,7 @@ void CGSH_OpenGL::ResetImpl()
 void CGSH_OpenGL::FlipImpl()
 {
 	FlushVertexBuffer();
+	ProcessPendingShaders();
 	m_renderState.isValid = false;
 	m_validGlState = 0;
 
@@ -289,9 +322,9 @@ void CGSH_OpenGL::FlipImpl()
 	CGSHandler::FlipImpl();
 }
 
-void CGSH_OpenGL::LoadState(Framework::CZipArchiveReader& archive)
+void CGSH_OpenGL::LoadState(Framework::CZipArchiveReader& archive, CMemoryStateTracker* memoryTracker)
 {
-	CGSHandler::LoadState(archive);
+	CGSHandler::LoadState(archive, memoryTracker);
 	m_mailBox.SendCall(
 	    [this]() {
 		    m_textureCache.InvalidateRange(0, RAMSIZE);
@@ -303,6 +336,8 @@ void CGSH_OpenGL::RegisterPreferences()
 	CGSHandler::RegisterPreferences();
 	CAppConfig::GetInstance().RegisterPreferenceInteger(PREF_CGSH_OPENGL_RESOLUTION_FACTOR, 1);
 	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_CGSH_OPENGL_FORCEBILINEARTEXTURES, false);
+	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_CGSH_OPENGL_PROGRAMCACHE, true);
+	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_CGSH_OPENGL_ASYNCSHADERCOMPILATION, true);
 }
 
 void CGSH_OpenGL::NotifyPreferencesChangedImpl()
@@ -560,41 +595,96 @@ Framework::OpenGl::ProgramPtr CGSH_OpenGL::GetShaderFromCaps(const SHADERCAPS& s
 	auto shaderIterator = m_shaders.find(static_cast<uint32>(shaderCaps));
 	if(shaderIterator == m_shaders.end())
 	{
-		auto shader = GenerateShader(shaderCaps);
-
-		glUseProgram(*shader);
-		m_validGlState &= ~GLSTATE_PROGRAM;
-
-		auto textureUniform = glGetUniformLocation(*shader, "g_texture");
-		if(textureUniform != -1)
+		if(m_uberShader)
 		{
-			glUniform1i(textureUniform, 0);
+			//Let the driver compile the program in the background and draw with the uber shader meanwhile
+			auto pendingShaderIterator = m_pendingShaders.find(static_cast<uint32>(shaderCaps));
+			if(pendingShaderIterator == m_pendingShaders.end())
+			{
+				m_pendingShaders.insert(std::make_pair(static_cast<uint32>(shaderCaps), BeginShaderGeneration(shaderCaps)));
+				return m_uberShader;
+			}
+			if(!IsShaderGenerationComplete(pendingShaderIterator->second))
+			{
+				return m_uberShader;
+			}
+			auto shader = std::move(pendingShaderIterator->second);
+			m_pendingShaders.erase(pendingShaderIterator);
+			CompleteShaderGeneration(shaderCaps, std::move(shader));
 		}
-
-		auto paletteUniform = glGetUniformLocation(*shader, "g_palette");
-		if(paletteUniform != -1)
+		else
 		{
-			glUniform1i(paletteUniform, 1);
+			CompleteShaderGeneration(shaderCaps, GenerateShader(shaderCaps));
 		}
+		shaderIterator = m_shaders.find(static_cast<uint32>(shaderCaps));
+	}
+	return shaderIterator->second;
+}
 
-		auto vertexParamsUniformBlock = glGetUniformBlockIndex(*shader, "VertexParams");
-		if(vertexParamsUniformBlock != GL_INVALID_INDEX)
-		{
-			glUniformBlockBinding(*shader, vertexParamsUniformBlock, 0);
-		}
+void CGSH_OpenGL::CompleteShaderGeneration(const SHADERCAPS& shaderCaps, Framework::OpenGl::ProgramPtr shader)
+{
+	GLint linkStatus = GL_FALSE;
+	glGetProgramiv(*shader, GL_LINK_STATUS, &linkStatus);
+	if(linkStatus != GL_TRUE)
+	{
+		//Generate it again while waiting for the results to get errors reported
+		CLog::GetInstance().Warn(LOG_NAME, "Failed to generate program for shader caps 0x%08X.\r\n", static_cast<uint32>(shaderCaps));
+		shader = GenerateShader(shaderCaps);
+	}
+
+	InitializeShader(shader);
+	ProgramCache_Store(shaderCaps, shader);
+
+	m_shaders.insert(std::make_pair(static_cast<uint32>(shaderCaps), shader));
+}
 
-		auto fragmentParamsUniformBlock = glGetUniformBlockIndex(*shader, "FragmentParams");
-		if(fragmentParamsUniformBlock != GL_INVALID_INDEX)
+void CGSH_OpenGL::ProcessPendingShaders()
+{
+	//Programs that weren't needed again since they started compiling still need to end up in the cache
+	for(auto shaderIterator = m_pendingShaders.begin(); shaderIterator != m_pendingShaders.end();)
+	{
+		if(!IsShaderGenerationComplete(shaderIterator->second))
 		{
-			glUniformBlockBinding(*shader, fragmentParamsUniformBlock, 1);
+			shaderIterator++;
+			continue;
 		}
+		auto shaderCaps = make_convertible<SHADERCAPS>(shaderIterator->first);
+		auto shader = std::move(shaderIterator->second);
+		shaderIterator = m_pendingShaders.erase(shaderIterator);
+		CompleteShaderGeneration(shaderCaps, std::move(shader));
+	}
+}
 
-		CHECKGLERROR();
+void CGSH_OpenGL::InitializeShader(const Framework::OpenGl::ProgramPtr& shader)
+{
+	glUseProgram(*shader);
+	m_validGlState &= ~GLSTATE_PROGRAM;
 
-		m_shaders.insert(std::make_pair(static_cast<uint32>(shaderCaps), shader));
-		shaderIterator = m_shaders.find(static_cast<uint32>(shaderCaps));
+	auto textureUniform = glGetUniformLocation(*shader, "g_texture");
+	if(textureUniform != -1)
+	{
+		glUniform1i(textureUniform, 0);
 	}
-	return shaderIterator->second;
+
+	auto paletteUniform = glGetUniformLocation(*shader, "g_palette");
+	if(paletteUniform != -1)
+	{
+		glUniform1i(paletteUniform, 1);
+	}
+
+	auto vertexParamsUniformBlock = glGetUniformBlockIndex(*shader, "VertexParams");
+	if(vertexParamsUniformBlock != GL_INVALID_INDEX)
+	{
+		glUniformBlockBinding(*shader, vertexParamsUniformBlock, 0);
+	}
+
+	auto fragmentParamsUniformBlock = glGetUniformBlockIndex(*shader, "FragmentParams");
+	if(fragmentParamsUniformBlock != GL_INVALID_INDEX)
+	{
+		glUniformBlockBinding(*shader, fragmentParamsUniformBlock, 1);
+	}
+
+	CHECKGLERROR();
 }
 
 void CGSH_OpenGL::SetRenderingContext(uint64 primReg)
@@ -1705,6 +1795,17 @@ void CGSH_OpenGL::FlushVertexBuffer()
 
 void CGSH_OpenGL::DoRenderPass()
 {
+	if(m_uberShader && (m_renderState.shaderHandle == *m_uberShader))
+	{
+		//Uber shader picks what it does from the shader caps
+		uint32 shaderCaps = m_renderState.shaderCaps;
+		if(m_fragmentParams.shaderCaps != shaderCaps)
+		{
+			m_fragmentParams.shaderCaps = shaderCaps;
+			m_validGlState &= ~GLSTATE_FRAGMENT_PARAMS;
+		}
+	}
+
 	if((m_validGlState & GLSTATE_VERTEX_PARAMS) == 0)
 	{
 		glBindBuffer(GL_UNIFORM_BUFFER, m_vertexParamsBuffer);
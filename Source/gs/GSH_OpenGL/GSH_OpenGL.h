@@ -1,10 +1,14 @@
 #pragma once
 
 #include <list>
+#include <memory>
+#include <set>
 #include <unordered_map>
 #include "../GSHandler.h"
 #include "../GsCachedArea.h"
 #include "../GsTextureCache.h"
+#include "StdStream.h"
+#include "filesystem_def.h"
 #include "opengl/OpenGlDef.h"
 #include "opengl/Program.h"
 #include "opengl/Shader.h"
@@ -12,6 +16,8 @@
 
 #define PREF_CGSH_OPENGL_RESOLUTION_FACTOR "renderer.opengl.resfactor"
 #define PREF_CGSH_OPENGL_FORCEBILINEARTEXTURES "renderer.opengl.forcebilineartextures"
+#define PREF_CGSH_OPENGL_PROGRAMCACHE "renderer.opengl.programcache"
+#define PREF_CGSH_OPENGL_ASYNCSHADERCOMPILATION "renderer.opengl.asyncshadercompilation"
 
 #if !defined(GLES_COMPATIBILITY) && !defined(__APPLE__)
 //- Dual source blending is disabled on macOS because it seems to be problematic on
@@ -27,7 +33,7 @@ public:
 
 	static void RegisterPreferences();
 
-	virtual void LoadState(Framework::CZipArchiveReader&) override;
+	virtual void LoadState(Framework::CZipArchiveReader&, CMemoryStateTracker* = nullptr) override;
 
 	void ProcessHostToLocalTransfer() override;
 	void ProcessLocalToHostTransfer() override;
@@ -46,6 +52,9 @@ protected:
 	void NotifyPreferencesChangedImpl() override;
 	void FlipImpl() override;
 
+	//Directory where program binaries and the shader caps list are kept
+	virtual fs::path GetProgramCachePath() const;
+
 	GLuint m_presentFramebuffer = 0;
 
 private:
@@ -144,7 +153,7 @@ private:
 		float texA0;
 		float texA1;
 		uint32 alphaRef;
-		float padding1;
+		uint32 shaderCaps;
 		float fogColor[3];
 		float padding2;
 	};
@@ -303,9 +312,18 @@ private:
 	void VertexKick(uint8, uint64);
 
 	Framework::OpenGl::ProgramPtr GetShaderFromCaps(const SHADERCAPS&);
+	void InitializeShader(const Framework::OpenGl::ProgramPtr&);
 	Framework::OpenGl::ProgramPtr GenerateShader(const SHADERCAPS&);
-	Framework::OpenGl::CShader GenerateVertexShader(const SHADERCAPS&);
-	Framework::OpenGl::CShader GenerateFragmentShader(const SHADERCAPS&);
+	Framework::OpenGl::ProgramPtr BeginShaderGeneration(const SHADERCAPS&);
+	bool IsShaderGenerationComplete(const Framework::OpenGl::ProgramPtr&);
+	void CompleteShaderGeneration(const SHADERCAPS&, Framework::OpenGl::ProgramPtr);
+	void ProcessPendingShaders();
+	Framework::OpenGl::ProgramPtr GenerateProgram(const std::string&, const std::string&, bool);
+	Framework::OpenGl::ProgramPtr GenerateUberShader();
+	std::string GenerateVertexShaderSource(const SHADERCAPS&);
+	std::string GenerateFragmentShaderSource(const SHADERCAPS&);
+	std::string GenerateUberFragmentShaderSource();
+	uint64 GetShaderSourceHash(const SHADERCAPS&);
 	std::string GenerateTexCoordClampingSection(TEXTURE_CLAMP_MODE, const char*);
 	std::string GenerateAlphaTestSection(ALPHA_TEST_METHOD);
 
@@ -382,6 +400,13 @@ private:
 	void PalCache_Insert(const TEX0&, const uint32*, GLuint);
 	void PalCache_Invalidate(uint32);
 
+	//Program binaries and the list of shader caps used so far are kept between runs
+	void ProgramCache_Load();
+	void ProgramCache_LoadBinaries(const fs::path&);
+	void ProgramCache_Prewarm();
+	void ProgramCache_Store(const SHADERCAPS&, const Framework::OpenGl::ProgramPtr&);
+	void ProgramCache_Release();
+
 	void PopulateFramebuffer(const FramebufferPtr&);
 	void CommitFramebufferDirtyPages(const FramebufferPtr&, unsigned int, unsigned int);
 	void ResolveFramebufferMultisample(const FramebufferPtr&, uint32);
@@ -436,6 +461,13 @@ private:
 	};
 
 	ShaderMap m_shaders;
+	//Programs that are still being compiled by the driver, the uber shader is used until they are ready
+	ShaderMap m_pendingShaders;
+	Framework::OpenGl::ProgramPtr m_uberShader;
+	bool m_programCacheEnabled = false;
+	std::unique_ptr<Framework::CStdStream> m_programCacheStream;
+	std::unique_ptr<Framework::CStdStream> m_programCacheCapsListStream;
+	std::set<uint32> m_programCacheCapsList;
 	RENDERSTATE m_renderState;
 	uint32 m_validGlState = 0;
 	VERTEXPARAMS m_vertexParams;
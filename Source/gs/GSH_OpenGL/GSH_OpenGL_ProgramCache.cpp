@@ -0,0 +1,362 @@
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include "GSH_OpenGL.h"
+#include "../../AppConfig.h"
+#include "../../AppDef.h"
+#include "../../Log.h"
+#include "PathUtils.h"
+#include "StdStreamUtils.h"
+#include "filesystem_def.h"
+
+#define LOG_NAME "gsh_opengl"
+
+#define PROGRAMCACHE_DIRECTORY "shadercache"
+#define PROGRAMCACHE_BINARIES_FILENAME "opengl_programs.bin"
+#define PROGRAMCACHE_CAPSLIST_FILENAME "opengl_shadercaps.txt"
+
+#define PROGRAMCACHE_MAGIC 0x42504C47 //'GLPB'
+#define PROGRAMCACHE_VERSION 1
+#define PROGRAMCACHE_MAX_BINARY_SIZE 0x1000000
+
+struct PROGRAMBINARY
+{
+	uint32 caps = 0;
+	uint64 sourceHash = 0;
+	uint32 format = 0;
+	std::vector<uint8> data;
+};
+typedef std::vector<PROGRAMBINARY> ProgramBinaryArray;
+
+static std::string GetGlString(GLenum name)
+{
+	auto value = reinterpret_cast<const char*>(glGetString(name));
+	return value ? value : "";
+}
+
+//Binaries are only usable with the driver that produced them
+static std::string GetDriverId()
+{
+	std::stringstream driverId;
+	driverId << GetGlString(GL_VENDOR) << std::endl;
+	driverId << GetGlString(GL_RENDERER) << std::endl;
+	driverId << GetGlString(GL_VERSION) << std::endl;
+	driverId << APP_VERSION;
+	return driverId.str();
+}
+
+static uint64 HashString(uint64 hash, const std::string& value)
+{
+	//FNV-1a
+	for(auto character : value)
+	{
+		hash ^= static_cast<uint8>(character);
+		hash *= 0x100000001B3ULL;
+	}
+	return hash;
+}
+
+static FILE* OpenCacheFile(const fs::path& path, bool append)
+{
+#ifdef _WIN32
+	auto file = _wfopen(path.native().c_str(), append ? L"ab" : L"wb");
+#else
+	auto file = fopen(path.native().c_str(), append ? "ab" : "wb");
+#endif
+	if(file == nullptr)
+	{
+		throw std::runtime_error("Failed to open program cache file.");
+	}
+	return file;
+}
+
+static void WriteCapsListEntry(Framework::CStream& stream, uint32 caps)
+{
+	char line[16];
+	snprintf(line, sizeof(line), "%08X\n", caps);
+	stream.Write(line, strlen(line));
+}
+
+static void WriteProgramBinaryHeader(Framework::CStream& stream, const std::string& driverId)
+{
+	stream.Write32(PROGRAMCACHE_MAGIC);
+	stream.Write32(PROGRAMCACHE_VERSION);
+	stream.Write32(static_cast<uint32>(driverId.size()));
+	stream.Write(driverId.c_str(), driverId.size());
+}
+
+static void WriteProgramBinary(Framework::CStream& stream, const PROGRAMBINARY& binary)
+{
+	stream.Write32(binary.caps);
+	stream.Write64(binary.sourceHash);
+	stream.Write32(binary.format);
+	stream.Write32(static_cast<uint32>(binary.data.size()));
+	stream.Write(binary.data.data(), binary.data.size());
+}
+
+//Returns false if the file wasn't made by this driver or if its last record was only partially written
+static bool ReadProgramBinaries(Framework::CStream& stream, const std::string& driverId, ProgramBinaryArray& binaries)
+{
+	uint64 fileSize = stream.GetLength();
+	uint32 magic = stream.Read32();
+	uint32 version = stream.Read32();
+	uint32 driverIdSize = stream.Read32();
+	if(stream.IsEOF() || (magic != PROGRAMCACHE_MAGIC) || (version != PROGRAMCACHE_VERSION) || (driverIdSize != driverId.size()))
+	{
+		return false;
+	}
+	if(stream.ReadString(driverIdSize) != driverId)
+	{
+		return false;
+	}
+
+	static const uint64 recordHeaderSize = 20;
+	while(stream.Tell() != fileSize)
+	{
+		if((fileSize - stream.Tell()) < recordHeaderSize)
+		{
+			return false;
+		}
+		PROGRAMBINARY binary;
+		binary.caps = stream.Read32();
+		binary.sourceHash = stream.Read64();
+		binary.format = stream.Read32();
+		uint32 binarySize = stream.Read32();
+		if((binarySize > PROGRAMCACHE_MAX_BINARY_SIZE) || (binarySize > (fileSize - stream.Tell())))
+		{
+			return false;
+		}
+		binary.data.resize(binarySize);
+		stream.Read(binary.data.data(), binarySize);
+		binaries.push_back(std::move(binary));
+	}
+	return true;
+}
+
+static Framework::OpenGl::ProgramPtr CreateProgramFromBinary(const PROGRAMBINARY& binary)
+{
+	auto program = std::make_shared<Framework::OpenGl::CProgram>();
+	glProgramBinary(*program, binary.format, binary.data.data(), static_cast<GLsizei>(binary.data.size()));
+
+	//Drivers are allowed to reject binaries, in which case the program needs to be generated again
+	GLint linkStatus = GL_FALSE;
+	glGetProgramiv(*program, GL_LINK_STATUS, &linkStatus);
+	while(glGetError() != GL_NO_ERROR)
+	{
+	}
+	if(linkStatus != GL_TRUE)
+	{
+		return Framework::OpenGl::ProgramPtr();
+	}
+	return program;
+}
+
+fs::path CGSH_OpenGL::GetProgramCachePath() const
+{
+	return CAppConfig::GetBasePath() / PROGRAMCACHE_DIRECTORY;
+}
+
+uint64 CGSH_OpenGL::GetShaderSourceHash(const SHADERCAPS& caps)
+{
+	uint64 hash = 0xCBF29CE484222325ULL;
+	hash = HashString(hash, GenerateVertexShaderSource(caps));
+	hash = HashString(hash, GenerateFragmentShaderSource(caps));
+	return hash;
+}
+
+void CGSH_OpenGL::ProgramCache_Load()
+{
+	m_programCacheStream.reset();
+	m_programCacheCapsListStream.reset();
+	m_programCacheCapsList.clear();
+
+	m_programCacheEnabled = CAppConfig::GetInstance().GetPreferenceBoolean(PREF_CGSH_OPENGL_PROGRAMCACHE);
+	if(!m_programCacheEnabled) return;
+
+	auto cachePath = GetProgramCachePath();
+	try
+	{
+		Framework::PathUtils::EnsurePathExists(cachePath);
+
+		auto capsListPath = cachePath / PROGRAMCACHE_CAPSLIST_FILENAME;
+		if(fs::exists(capsListPath))
+		{
+			auto capsListStream = Framework::CreateInputStdStream(capsListPath.native());
+			std::stringstream capsList(capsListStream.ReadString(capsListStream.GetLength()));
+			std::string line;
+			while(std::getline(capsList, line))
+			{
+				if(line.empty()) continue;
+				m_programCacheCapsList.insert(std::stoul(line, nullptr, 16));
+			}
+		}
+	}
+	catch(const std::exception& exception)
+	{
+		CLog::GetInstance().Warn(LOG_NAME, "Failed to load shader caps list: %s\r\n", exception.what());
+	}
+
+	ProgramCache_LoadBinaries(cachePath);
+
+	//Caps are appended to the list as soon as they're used, it doesn't rely on Release being called
+	try
+	{
+		auto capsListPath = cachePath / PROGRAMCACHE_CAPSLIST_FILENAME;
+		m_programCacheCapsListStream = std::make_unique<Framework::CStdStream>(OpenCacheFile(capsListPath, false));
+		for(auto caps : m_programCacheCapsList)
+		{
+			WriteCapsListEntry(*m_programCacheCapsListStream, caps);
+		}
+		m_programCacheCapsListStream->Flush();
+	}
+	catch(const std::exception& exception)
+	{
+		CLog::GetInstance().Warn(LOG_NAME, "Failed to open shader caps list: %s\r\n", exception.what());
+		m_programCacheCapsListStream.reset();
+	}
+}
+
+void CGSH_OpenGL::ProgramCache_LoadBinaries(const fs::path& cachePath)
+{
+	GLint binaryFormatCount = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormatCount);
+	if(binaryFormatCount == 0)
+	{
+		//Driver can't give back program binaries, only the caps list can be used
+		return;
+	}
+
+	auto driverId = GetDriverId();
+	auto binariesPath = cachePath / PROGRAMCACHE_BINARIES_FILENAME;
+	ProgramBinaryArray binaries;
+	bool isFileValid = false;
+	try
+	{
+		if(fs::exists(binariesPath))
+		{
+			auto binariesStream = Framework::CreateInputStdStream(binariesPath.native());
+			isFileValid = ReadProgramBinaries(binariesStream, driverId, binaries);
+		}
+	}
+	catch(const std::exception& exception)
+	{
+		CLog::GetInstance().Warn(LOG_NAME, "Failed to read program binaries: %s\r\n", exception.what());
+		binaries.clear();
+		isFileValid = false;
+	}
+
+	//Records are appended as programs are created, the last one for given caps is the most recent
+	ProgramBinaryArray loadedBinaries;
+	for(auto binaryIterator = binaries.rbegin(); binaryIterator != binaries.rend(); binaryIterator++)
+	{
+		auto& binary = *binaryIterator;
+		auto caps = make_convertible<SHADERCAPS>(binary.caps);
+		bool isStale = (m_shaders.find(binary.caps) != std::end(m_shaders)) || (caps.padding != 0) ||
+		               (GetShaderSourceHash(caps) != binary.sourceHash);
+		auto program = isStale ? Framework::OpenGl::ProgramPtr() : CreateProgramFromBinary(binary);
+		if(!program)
+		{
+			isFileValid = false;
+			continue;
+		}
+		InitializeShader(program);
+		m_shaders.insert(std::make_pair(binary.caps, program));
+		m_programCacheCapsList.insert(binary.caps);
+		loadedBinaries.push_back(std::move(binary));
+	}
+
+	try
+	{
+		if(isFileValid)
+		{
+			m_programCacheStream = std::make_unique<Framework::CStdStream>(OpenCacheFile(binariesPath, true));
+		}
+		else
+		{
+			//Rewrite the file without records that can't be used anymore
+			m_programCacheStream = std::make_unique<Framework::CStdStream>(OpenCacheFile(binariesPath, false));
+			WriteProgramBinaryHeader(*m_programCacheStream, driverId);
+			for(auto binaryIterator = loadedBinaries.rbegin(); binaryIterator != loadedBinaries.rend(); binaryIterator++)
+			{
+				WriteProgramBinary(*m_programCacheStream, *binaryIterator);
+			}
+			m_programCacheStream->Flush();
+		}
+	}
+	catch(const std::exception& exception)
+	{
+		CLog::GetInstance().Warn(LOG_NAME, "Failed to open program binaries file: %s\r\n", exception.what());
+		m_programCacheStream.reset();
+	}
+
+	CLog::GetInstance().Print(LOG_NAME, "Loaded %d program binaries.\r\n", static_cast<int>(loadedBinaries.size()));
+}
+
+void CGSH_OpenGL::ProgramCache_Prewarm()
+{
+	if(!m_programCacheEnabled) return;
+
+	//Programs from the caps list that didn't have a usable binary are generated now instead of while drawing
+	for(auto capsValue : m_programCacheCapsList)
+	{
+		auto caps = make_convertible<SHADERCAPS>(capsValue);
+		if(caps.padding != 0) continue;
+		GetShaderFromCaps(caps);
+	}
+}
+
+void CGSH_OpenGL::ProgramCache_Store(const SHADERCAPS& caps, const Framework::OpenGl::ProgramPtr& program)
+{
+	if(!m_programCacheEnabled) return;
+
+	if(m_programCacheCapsList.insert(caps).second && m_programCacheCapsListStream)
+	{
+		try
+		{
+			WriteCapsListEntry(*m_programCacheCapsListStream, caps);
+			m_programCacheCapsListStream->Flush();
+		}
+		catch(const std::exception& exception)
+		{
+			CLog::GetInstance().Warn(LOG_NAME, "Failed to save shader caps list: %s\r\n", exception.what());
+			m_programCacheCapsListStream.reset();
+		}
+	}
+
+	if(!m_programCacheStream) return;
+
+	GLint binarySize = 0;
+	glGetProgramiv(*program, GL_PROGRAM_BINARY_LENGTH, &binarySize);
+	if(binarySize == 0) return;
+
+	PROGRAMBINARY binary;
+	binary.caps = caps;
+	binary.sourceHash = GetShaderSourceHash(caps);
+	binary.data.resize(binarySize);
+
+	GLsizei writtenSize = 0;
+	GLenum format = 0;
+	glGetProgramBinary(*program, binarySize, &writtenSize, &format, binary.data.data());
+	CHECKGLERROR();
+
+	binary.format = format;
+	binary.data.resize(writtenSize);
+
+	try
+	{
+		WriteProgramBinary(*m_programCacheStream, binary);
+		m_programCacheStream->Flush();
+	}
+	catch(const std::exception& exception)
+	{
+		CLog::GetInstance().Warn(LOG_NAME, "Failed to write program binary: %s\r\n", exception.what());
+		m_programCacheStream.reset();
+	}
+}
+
+void CGSH_OpenGL::ProgramCache_Release()
+{
+	m_programCacheStream.reset();
+	m_programCacheCapsListStream.reset();
+}
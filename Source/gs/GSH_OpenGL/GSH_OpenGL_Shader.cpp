@@ -1,5 +1,6 @@
 #include "GSH_OpenGL.h"
 #include <assert.h>
+#include <functional>
 #include <sstream>
 
 #ifdef GLES_COMPATIBILITY
@@ -54,10 +55,51 @@ static const char* s_orFunction =
     "	return float(r);\r\n"
     "}\r\n";
 
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
 Framework::OpenGl::ProgramPtr CGSH_OpenGL::GenerateShader(const SHADERCAPS& caps)
 {
-	auto vertexShader = GenerateVertexShader(caps);
-	auto fragmentShader = GenerateFragmentShader(caps);
+	return GenerateProgram(GenerateVertexShaderSource(caps), GenerateFragmentShaderSource(caps), true);
+}
+
+Framework::OpenGl::ProgramPtr CGSH_OpenGL::BeginShaderGeneration(const SHADERCAPS& caps)
+{
+	return GenerateProgram(GenerateVertexShaderSource(caps), GenerateFragmentShaderSource(caps), false);
+}
+
+bool CGSH_OpenGL::IsShaderGenerationComplete(const Framework::OpenGl::ProgramPtr& program)
+{
+	GLint completionStatus = GL_FALSE;
+	glGetProgramiv(*program, GL_COMPLETION_STATUS_KHR, &completionStatus);
+	return (completionStatus == GL_TRUE);
+}
+
+Framework::OpenGl::ProgramPtr CGSH_OpenGL::GenerateProgram(const std::string& vertexShaderSource, const std::string& fragmentShaderSource, bool waitForCompletion)
+{
+	Framework::OpenGl::CShader vertexShader(GL_VERTEX_SHADER);
+	Framework::OpenGl::CShader fragmentShader(GL_FRAGMENT_SHADER);
+
+	vertexShader.SetSource(vertexShaderSource.c_str(), vertexShaderSource.size());
+	fragmentShader.SetSource(fragmentShaderSource.c_str(), fragmentShaderSource.size());
+
+	if(waitForCompletion)
+	{
+		FRAMEWORK_MAYBE_UNUSED bool vertexShaderCompilationResult = vertexShader.Compile();
+		assert(vertexShaderCompilationResult);
+
+		FRAMEWORK_MAYBE_UNUSED bool fragmentShaderCompilationResult = fragmentShader.Compile();
+		assert(fragmentShaderCompilationResult);
+	}
+	else
+	{
+		//Querying the compilation status would wait for the driver to finish its work
+		glCompileShader(vertexShader);
+		glCompileShader(fragmentShader);
+	}
+
+	CHECKGLERROR();
 
 	auto result = std::make_shared<Framework::OpenGl::CProgram>();
 
@@ -75,15 +117,27 @@ Framework::OpenGl::ProgramPtr CGSH_OpenGL::GenerateShader(const SHADERCAPS& caps
 	glBindFragDataLocationIndexed(*result, 0, 1, "blendColor");
 #endif
 
-	FRAMEWORK_MAYBE_UNUSED bool linkResult = result->Link();
-	assert(linkResult);
+	if(m_programCacheStream)
+	{
+		glProgramParameteri(*result, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+
+	if(waitForCompletion)
+	{
+		FRAMEWORK_MAYBE_UNUSED bool linkResult = result->Link();
+		assert(linkResult);
+	}
+	else
+	{
+		glLinkProgram(*result);
+	}
 
 	CHECKGLERROR();
 
 	return result;
 }
 
-Framework::OpenGl::CShader CGSH_OpenGL::GenerateVertexShader(const SHADERCAPS& caps)
+std::string CGSH_OpenGL::GenerateVertexShaderSource(const SHADERCAPS& caps)
 {
 	std::stringstream shaderBuilder;
 	shaderBuilder << GLSL_VERSION << std::endl;
@@ -121,19 +175,10 @@ Framework::OpenGl::CShader CGSH_OpenGL::GenerateVertexShader(const SHADERCAPS& c
 	shaderBuilder << "	gl_Position = g_projMatrix * vec4(a_position, 0, 1);" << std::endl;
 	shaderBuilder << "}" << std::endl;
 
-	auto shaderSource = shaderBuilder.str();
-
-	Framework::OpenGl::CShader result(GL_VERTEX_SHADER);
-	result.SetSource(shaderSource.c_str(), shaderSource.size());
-	FRAMEWORK_MAYBE_UNUSED bool compilationResult = result.Compile();
-	assert(compilationResult);
-
-	CHECKGLERROR();
-
-	return result;
+	return shaderBuilder.str();
 }
 
-Framework::OpenGl::CShader CGSH_OpenGL::GenerateFragmentShader(const SHADERCAPS& caps)
+std::string CGSH_OpenGL::GenerateFragmentShaderSource(const SHADERCAPS& caps)
 {
 	std::stringstream shaderBuilder;
 
@@ -344,16 +389,221 @@ Framework::OpenGl::CShader CGSH_OpenGL::GenerateFragmentShader(const SHADERCAPS&
 
 	shaderBuilder << "}" << std::endl;
 
-	auto shaderSource = shaderBuilder.str();
+	return shaderBuilder.str();
+}
 
-	Framework::OpenGl::CShader result(GL_FRAGMENT_SHADER);
-	result.SetSource(shaderSource.c_str(), shaderSource.size());
-	FRAMEWORK_MAYBE_UNUSED bool compilationResult = result.Compile();
-	assert(compilationResult);
+Framework::OpenGl::ProgramPtr CGSH_OpenGL::GenerateUberShader()
+{
+	auto vertexCaps = make_convertible<SHADERCAPS>(0);
+	vertexCaps.hasFog = 1;
+	return GenerateProgram(GenerateVertexShaderSource(vertexCaps), GenerateUberFragmentShaderSource(), true);
+}
 
-	CHECKGLERROR();
+std::string CGSH_OpenGL::GenerateUberFragmentShaderSource()
+{
+	//Features are selected using the SHADERCAPS value held in g_shaderCaps, field positions are
+	//taken from the structure itself to make sure they match
+	auto getCapsField = [](const std::function<void(SHADERCAPS&)>& setField) {
+		auto fieldCaps = make_convertible<SHADERCAPS>(0);
+		setField(fieldCaps);
+		uint32 fieldMask = fieldCaps;
+		unsigned int fieldShift = 0;
+		while(((fieldMask >> fieldShift) & 1) == 0)
+		{
+			fieldShift++;
+		}
+		std::stringstream fieldBuilder;
+		fieldBuilder << "((g_shaderCaps >> " << fieldShift << "u) & " << (fieldMask >> fieldShift) << "u)";
+		return fieldBuilder.str();
+	};
+
+	auto texFunction = getCapsField([](SHADERCAPS& caps) { caps.texFunction = 3; });
+	auto texClampS = getCapsField([](SHADERCAPS& caps) { caps.texClampS = 3; });
+	auto texClampT = getCapsField([](SHADERCAPS& caps) { caps.texClampT = 3; });
+	auto texSourceMode = getCapsField([](SHADERCAPS& caps) { caps.texSourceMode = 3; });
+	auto texHasAlpha = getCapsField([](SHADERCAPS& caps) { caps.texHasAlpha = 1; });
+	auto texBilinearFilter = getCapsField([](SHADERCAPS& caps) { caps.texBilinearFilter = 1; });
+	auto texUseAlphaExpansion = getCapsField([](SHADERCAPS& caps) { caps.texUseAlphaExpansion = 1; });
+	auto texBlackIsTransparent = getCapsField([](SHADERCAPS& caps) { caps.texBlackIsTransparent = 1; });
+	auto hasFog = getCapsField([](SHADERCAPS& caps) { caps.hasFog = 1; });
+	auto hasAlphaTest = getCapsField([](SHADERCAPS& caps) { caps.hasAlphaTest = 1; });
+	auto alphaTestMethod = getCapsField([](SHADERCAPS& caps) { caps.alphaTestMethod = 7; });
 
-	return result;
+	std::stringstream shaderBuilder;
+
+	shaderBuilder << GLSL_VERSION << std::endl;
+
+	shaderBuilder << "precision mediump float;" << std::endl;
+
+	shaderBuilder << "in highp float v_depth;" << std::endl;
+	shaderBuilder << "in vec4 v_color;" << std::endl;
+	shaderBuilder << "in highp vec3 v_texCoord;" << std::endl;
+	shaderBuilder << "in float v_fog;" << std::endl;
+
+	shaderBuilder << "out vec4 fragColor;" << std::endl;
+#ifdef USE_DUALSOURCE_BLENDING
+	shaderBuilder << "out vec4 blendColor;" << std::endl;
+#endif
+
+	shaderBuilder << "uniform sampler2D g_texture;" << std::endl;
+	shaderBuilder << "uniform sampler2D g_palette;" << std::endl;
+
+	shaderBuilder << "layout(std140) uniform FragmentParams" << std::endl;
+	shaderBuilder << "{" << std::endl;
+	shaderBuilder << "	vec2 g_textureSize;" << std::endl;
+	shaderBuilder << "	vec2 g_texelSize;" << std::endl;
+	shaderBuilder << "	vec2 g_clampMin;" << std::endl;
+	shaderBuilder << "	vec2 g_clampMax;" << std::endl;
+	shaderBuilder << "	float g_texA0;" << std::endl;
+	shaderBuilder << "	float g_texA1;" << std::endl;
+	shaderBuilder << "	uint g_alphaRef;" << std::endl;
+	shaderBuilder << "	uint g_shaderCaps;" << std::endl;
+	shaderBuilder << "	vec3 g_fogColor;" << std::endl;
+	shaderBuilder << "};" << std::endl;
+
+	shaderBuilder << s_andFunction << std::endl;
+	shaderBuilder << s_orFunction << std::endl;
+
+	shaderBuilder << "float combineColors(float a, float b)" << std::endl;
+	shaderBuilder << "{" << std::endl;
+	shaderBuilder << "	uint aInt = uint(a * 255.0);" << std::endl;
+	shaderBuilder << "	uint bInt = uint(b * 255.0);" << std::endl;
+	shaderBuilder << "	uint result = min((aInt * bInt) >> 7, 255u);" << std::endl;
+	shaderBuilder << "	return float(result) / 255.0;" << std::endl;
+	shaderBuilder << "}" << std::endl;
+
+	shaderBuilder << "vec4 expandAlpha(vec4 inputColor)" << std::endl;
+	shaderBuilder << "{" << std::endl;
+	shaderBuilder << "	if(" << texUseAlphaExpansion << " == 0u) return inputColor;" << std::endl;
+	shaderBuilder << "	float alpha = mix(g_texA0, g_texA1, inputColor.a);" << std::endl;
+	shaderBuilder << "	if(" << texBlackIsTransparent << " != 0u)" << std::endl;
+	shaderBuilder << "	{" << std::endl;
+	shaderBuilder << "		float black = inputColor.r + inputColor.g + inputColor.b;" << std::endl;
+	shaderBuilder << "		if(black == 0.0) alpha = 0.0;" << std::endl;
+	shaderBuilder << "	}" << std::endl;
+	shaderBuilder << "	return vec4(inputColor.rgb, alpha);" << std::endl;
+	shaderBuilder << "}" << std::endl;
+
+	shaderBuilder << "highp float clampTexCoord(highp float texCoord, uint clampMode, float clampMin, float clampMax)" << std::endl;
+	shaderBuilder << "{" << std::endl;
+	shaderBuilder << "	if(clampMode == " << TEXTURE_CLAMP_MODE_REGION_CLAMP << "u) return min(clampMax, max(clampMin, texCoord));" << std::endl;
+	shaderBuilder << "	if(clampMode == " << TEXTURE_CLAMP_MODE_REGION_REPEAT << "u) return or(int(and(int(texCoord), int(clampMin))), int(clampMax));" << std::endl;
+	shaderBuilder << "	if(clampMode == " << TEXTURE_CLAMP_MODE_REGION_REPEAT_SIMPLE << "u) return mod(texCoord, clampMin) + clampMax;" << std::endl;
+	shaderBuilder << "	return texCoord;" << std::endl;
+	shaderBuilder << "}" << std::endl;
+
+	shaderBuilder << "void main()" << std::endl;
+	shaderBuilder << "{" << std::endl;
+
+	shaderBuilder << "	uint texFunction = " << texFunction << ";" << std::endl;
+	shaderBuilder << "	uint texClampS = " << texClampS << ";" << std::endl;
+	shaderBuilder << "	uint texClampT = " << texClampT << ";" << std::endl;
+	shaderBuilder << "	uint texSourceMode = " << texSourceMode << ";" << std::endl;
+	shaderBuilder << "	bool texHasAlpha = (" << texHasAlpha << " != 0u);" << std::endl;
+
+	shaderBuilder << "	highp vec3 texCoord = v_texCoord;" << std::endl;
+	shaderBuilder << "	texCoord.st /= texCoord.p;" << std::endl;
+
+	shaderBuilder << "	if((texClampS != " << TEXTURE_CLAMP_MODE_STD << "u) || (texClampT != " << TEXTURE_CLAMP_MODE_STD << "u))" << std::endl;
+	shaderBuilder << "	{" << std::endl;
+	shaderBuilder << "		texCoord.st *= g_textureSize.st;" << std::endl;
+	shaderBuilder << "		texCoord.s = clampTexCoord(texCoord.s, texClampS, g_clampMin.s, g_clampMax.s);" << std::endl;
+	shaderBuilder << "		texCoord.t = clampTexCoord(texCoord.t, texClampT, g_clampMin.t, g_clampMax.t);" << std::endl;
+	shaderBuilder << "		texCoord.st /= g_textureSize.st;" << std::endl;
+	shaderBuilder << "	}" << std::endl;
+
+	shaderBuilder << "	vec4 textureColor = vec4(1, 1, 1, 1);" << std::endl;
+	shaderBuilder << "	if((texSourceMode == " << TEXTURE_SOURCE_MODE_IDX4 << "u) || (texSourceMode == " << TEXTURE_SOURCE_MODE_IDX8 << "u))" << std::endl;
+	shaderBuilder << "	{" << std::endl;
+	shaderBuilder << "		float paletteSize = (texSourceMode == " << TEXTURE_SOURCE_MODE_IDX4 << "u) ? 16.0 : 256.0;" << std::endl;
+	shaderBuilder << "		float paletteTexelBias = 0.5 / paletteSize;" << std::endl;
+	shaderBuilder << "		if(" << texBilinearFilter << " == 0u)" << std::endl;
+	shaderBuilder << "		{" << std::endl;
+	shaderBuilder << "			float colorIndex = texture(g_texture, texCoord.st).r * 255.0;" << std::endl;
+	shaderBuilder << "			textureColor = expandAlpha(texture(g_palette, vec2(colorIndex / paletteSize + paletteTexelBias, 0)));" << std::endl;
+	shaderBuilder << "		}" << std::endl;
+	shaderBuilder << "		else" << std::endl;
+	shaderBuilder << "		{" << std::endl;
+	shaderBuilder << "			float tlIdx = texture(g_texture, texCoord.st                                     ).r * 255.0;" << std::endl;
+	shaderBuilder << "			float trIdx = texture(g_texture, texCoord.st + vec2(g_texelSize.x, 0)            ).r * 255.0;" << std::endl;
+	shaderBuilder << "			float blIdx = texture(g_texture, texCoord.st + vec2(0, g_texelSize.y)            ).r * 255.0;" << std::endl;
+	shaderBuilder << "			float brIdx = texture(g_texture, texCoord.st + vec2(g_texelSize.x, g_texelSize.y)).r * 255.0;" << std::endl;
+	shaderBuilder << "			vec4 tl = expandAlpha(texture(g_palette, vec2(tlIdx / paletteSize + paletteTexelBias, 0)));" << std::endl;
+	shaderBuilder << "			vec4 tr = expandAlpha(texture(g_palette, vec2(trIdx / paletteSize + paletteTexelBias, 0)));" << std::endl;
+	shaderBuilder << "			vec4 bl = expandAlpha(texture(g_palette, vec2(blIdx / paletteSize + paletteTexelBias, 0)));" << std::endl;
+	shaderBuilder << "			vec4 br = expandAlpha(texture(g_palette, vec2(brIdx / paletteSize + paletteTexelBias, 0)));" << std::endl;
+	shaderBuilder << "			highp vec2 f = fract(texCoord.st * g_textureSize);" << std::endl;
+	shaderBuilder << "			vec4 tA = mix(tl, tr, f.x);" << std::endl;
+	shaderBuilder << "			vec4 tB = mix(bl, br, f.x);" << std::endl;
+	shaderBuilder << "			textureColor = mix(tA, tB, f.y);" << std::endl;
+	shaderBuilder << "		}" << std::endl;
+	shaderBuilder << "	}" << std::endl;
+	shaderBuilder << "	else if(texSourceMode == " << TEXTURE_SOURCE_MODE_STD << "u)" << std::endl;
+	shaderBuilder << "	{" << std::endl;
+	shaderBuilder << "		textureColor = expandAlpha(texture(g_texture, texCoord.st));" << std::endl;
+	shaderBuilder << "	}" << std::endl;
+
+	shaderBuilder << "	if(texSourceMode != " << TEXTURE_SOURCE_MODE_NONE << "u)" << std::endl;
+	shaderBuilder << "	{" << std::endl;
+	shaderBuilder << "		if(!texHasAlpha) textureColor.a = 1.0;" << std::endl;
+	shaderBuilder << "		if(texFunction == " << TEX0_FUNCTION_MODULATE << "u)" << std::endl;
+	shaderBuilder << "		{" << std::endl;
+	shaderBuilder << "			textureColor.rgb = clamp(textureColor.rgb * v_color.rgb * 2.0, 0.0, 1.0);" << std::endl;
+	shaderBuilder << "			textureColor.a = texHasAlpha ? combineColors(textureColor.a, v_color.a) : v_color.a;" << std::endl;
+	shaderBuilder << "		}" << std::endl;
+	shaderBuilder << "		else if(texFunction == " << TEX0_FUNCTION_HIGHLIGHT << "u)" << std::endl;
+	shaderBuilder << "		{" << std::endl;
+	shaderBuilder << "			textureColor.rgb = clamp(textureColor.rgb * v_color.rgb * 2.0, 0.0, 1.0) + v_color.aaa;" << std::endl;
+	shaderBuilder << "			textureColor.a = texHasAlpha ? (textureColor.a + v_color.a) : v_color.a;" << std::endl;
+	shaderBuilder << "		}" << std::endl;
+	shaderBuilder << "		else if(texFunction == " << TEX0_FUNCTION_HIGHLIGHT2 << "u)" << std::endl;
+	shaderBuilder << "		{" << std::endl;
+	shaderBuilder << "			textureColor.rgb = clamp(textureColor.rgb * v_color.rgb * 2.0, 0.0, 1.0) + v_color.aaa;" << std::endl;
+	shaderBuilder << "			if(!texHasAlpha) textureColor.a = v_color.a;" << std::endl;
+	shaderBuilder << "		}" << std::endl;
+	shaderBuilder << "	}" << std::endl;
+	shaderBuilder << "	else" << std::endl;
+	shaderBuilder << "	{" << std::endl;
+	shaderBuilder << "		textureColor = v_color;" << std::endl;
+	shaderBuilder << "	}" << std::endl;
+
+	//Same conditions as GenerateAlphaTestSection, tests tell when a fragment is discarded
+	shaderBuilder << "	if(" << hasAlphaTest << " != 0u)" << std::endl;
+	shaderBuilder << "	{" << std::endl;
+	shaderBuilder << "		uint alphaTestMethod = " << alphaTestMethod << ";" << std::endl;
+	shaderBuilder << "		uint textureColorAlphaInt = uint(textureColor.a * 255.0);" << std::endl;
+	shaderBuilder << "		bool alphaTestFail = false;" << std::endl;
+	shaderBuilder << "		if(alphaTestMethod == " << ALPHA_TEST_NEVER << "u) alphaTestFail = true;" << std::endl;
+	shaderBuilder << "		if(alphaTestMethod == " << ALPHA_TEST_LESS << "u) alphaTestFail = (textureColorAlphaInt >= g_alphaRef);" << std::endl;
+	shaderBuilder << "		if(alphaTestMethod == " << ALPHA_TEST_LEQUAL << "u) alphaTestFail = (textureColorAlphaInt > g_alphaRef);" << std::endl;
+	shaderBuilder << "		if(alphaTestMethod == " << ALPHA_TEST_EQUAL << "u) alphaTestFail = (textureColorAlphaInt != g_alphaRef);" << std::endl;
+	shaderBuilder << "		if(alphaTestMethod == " << ALPHA_TEST_GEQUAL << "u) alphaTestFail = (textureColorAlphaInt < g_alphaRef);" << std::endl;
+	shaderBuilder << "		if(alphaTestMethod == " << ALPHA_TEST_GREATER << "u) alphaTestFail = (textureColorAlphaInt <= g_alphaRef);" << std::endl;
+	shaderBuilder << "		if(alphaTestMethod == " << ALPHA_TEST_NOTEQUAL << "u) alphaTestFail = (textureColorAlphaInt == g_alphaRef);" << std::endl;
+	shaderBuilder << "		if(alphaTestFail) discard;" << std::endl;
+	shaderBuilder << "	}" << std::endl;
+
+	shaderBuilder << "	if(" << hasFog << " != 0u)" << std::endl;
+	shaderBuilder << "	{" << std::endl;
+	shaderBuilder << "		fragColor.xyz = mix(textureColor.rgb, g_fogColor, v_fog);" << std::endl;
+	shaderBuilder << "	}" << std::endl;
+	shaderBuilder << "	else" << std::endl;
+	shaderBuilder << "	{" << std::endl;
+	shaderBuilder << "		fragColor.xyz = textureColor.xyz;" << std::endl;
+	shaderBuilder << "	}" << std::endl;
+
+#ifdef USE_DUALSOURCE_BLENDING
+	shaderBuilder << "	fragColor.a = textureColor.a;" << std::endl;
+	shaderBuilder << "	blendColor.a = clamp(textureColor.a * 2.0, 0.0, 1.0);" << std::endl;
+#else
+	shaderBuilder << "	fragColor.a = clamp(textureColor.a * 2.0, 0.0, 1.0);" << std::endl;
+#endif
+
+	shaderBuilder << "	gl_FragDepth = v_depth;" << std::endl;
+
+	shaderBuilder << "}" << std::endl;
+
+	return shaderBuilder.str();
 }
 
 std::string CGSH_OpenGL::GenerateTexCoordClampingSection(TEXTURE_CLAMP_MODE clampMode, const char* coordinate)
@@ -59,7 +59,7 @@ struct MASSIVEWRITE_INFO
 #ifdef DEBUGGER_INCLUDED
 	CGsPacketMetadata metadata;
 #endif
-	CGSHandler::RegisterWriteList writes;
+	GsRegisterWriteBufferPtr writes;
 };
 
 CGSHandler::CGSHandler()
@@ -69,6 +69,7 @@ CGSHandler::CGSHandler()
     , m_pRAM(nullptr)
     , m_frameDump(nullptr)
     , m_loggingEnabled(true)
+    , m_gsProfilerZone(CProfiler::GetInstance().RegisterZone("GS"))
 {
 	RegisterPreferences();
 
@@ -170,9 +171,9 @@ void CGSHandler::SetPresentationParams(const PRESENTATION_PARAMS& presentationPa
 	m_presentationParams = presentationParams;
 }
 
-void CGSHandler::SaveState(Framework::CZipArchiveWriter& archive)
+void CGSHandler::SaveState(Framework::CZipArchiveWriter& archive, CMemoryStateTracker* memoryTracker)
 {
-	archive.InsertFile(new CMemoryStateFile(STATE_RAM, m_pRAM, RAMSIZE));
+	CMemoryStateTracker::SaveMemory(archive, memoryTracker, STATE_RAM, m_pRAM, RAMSIZE);
 	archive.InsertFile(new CMemoryStateFile(STATE_REGS, m_nReg, sizeof(uint64) * CGSHandler::REGISTER_MAX));
 	archive.InsertFile(new CMemoryStateFile(STATE_TRXCTX, &m_trxCtx, sizeof(TRXCONTEXT)));
 
@@ -194,9 +195,9 @@ void CGSHandler::SaveState(Framework::CZipArchiveWriter& archive)
 	}
 }
 
-void CGSHandler::LoadState(Framework::CZipArchiveReader& archive)
+void CGSHandler::LoadState(Framework::CZipArchiveReader& archive, CMemoryStateTracker* memoryTracker)
 {
-	archive.BeginReadFile(STATE_RAM)->Read(m_pRAM, RAMSIZE);
+	CMemoryStateTracker::LoadMemory(archive, memoryTracker, STATE_RAM, m_pRAM, RAMSIZE);
 	archive.BeginReadFile(STATE_REGS)->Read(m_nReg, sizeof(uint64) * CGSHandler::REGISTER_MAX);
 	archive.BeginReadFile(STATE_TRXCTX)->Read(&m_trxCtx, sizeof(TRXCONTEXT));
 
@@ -453,13 +454,31 @@ void CGSHandler::ReadImageData(void* data, uint32 length)
 
 void CGSHandler::WriteRegisterMassively(RegisterWriteList registerWrites, const CGsPacketMetadata* metadata)
 {
+	auto writeBuffer = AcquireRegisterWriteBuffer();
 	for(const auto& write : registerWrites)
 	{
-		switch(write.first)
+		writeBuffer->Push(write.first, write.second);
+	}
+	WriteRegisterMassively(std::move(writeBuffer), metadata);
+}
+
+GsRegisterWriteBufferPtr CGSHandler::AcquireRegisterWriteBuffer()
+{
+	return m_registerWriteBufferPool.Acquire();
+}
+
+void CGSHandler::WriteRegisterMassively(GsRegisterWriteBufferPtr registerWrites, const CGsPacketMetadata* metadata)
+{
+	const uint8* registers = registerWrites->GetRegisters();
+	const uint64* values = registerWrites->GetValues();
+	size_t writeCount = registerWrites->GetSize();
+	for(size_t i = 0; i < writeCount; i++)
+	{
+		switch(registers[i])
 		{
 		case GS_REG_SIGNAL:
 		{
-			auto signal = make_convertible<SIGNAL>(write.second);
+			auto signal = make_convertible<SIGNAL>(values[i]);
 			auto siglblid = make_convertible<SIGLBLID>(m_nSIGLBLID);
 			siglblid.sigid &= ~signal.idmsk;
 			siglblid.sigid |= signal.id;
@@ -475,7 +494,7 @@ void CGSHandler::WriteRegisterMassively(RegisterWriteList registerWrites, const
 			break;
 		case GS_REG_LABEL:
 		{
-			auto label = make_convertible<LABEL>(write.second);
+			auto label = make_convertible<LABEL>(values[i]);
 			auto siglblid = make_convertible<SIGLBLID>(m_nSIGLBLID);
 			siglblid.lblid &= ~label.idmsk;
 			siglblid.lblid |= label.id;
@@ -611,18 +630,31 @@ void CGSHandler::ReadImageDataImpl(void* ptr, uint32 size)
 
 void CGSHandler::WriteRegisterMassivelyImpl(const MASSIVEWRITE_INFO& massiveWrite)
 {
+	const auto& writes = *massiveWrite.writes;
+	const uint8* registers = writes.GetRegisters();
+	const uint64* values = writes.GetValues();
+	size_t writeCount = writes.GetSize();
+
 #ifdef DEBUGGER_INCLUDED
 	if(m_frameDump)
 	{
-		m_frameDump->AddRegisterPacket(massiveWrite.writes.data(), massiveWrite.writes.size(), &massiveWrite.metadata);
+		RegisterWriteList registerWrites;
+		registerWrites.reserve(writeCount);
+		for(size_t i = 0; i < writeCount; i++)
+		{
+			registerWrites.push_back(RegisterWrite(registers[i], values[i]));
+		}
+		m_frameDump->AddRegisterPacket(registerWrites.data(), registerWrites.size(), &massiveWrite.metadata);
 	}
 #endif
 
-	for(const auto& write : massiveWrite.writes)
+	for(size_t i = 0; i < writeCount; i++)
 	{
-		WriteRegisterImpl(write.first, write.second);
+		WriteRegisterImpl(registers[i], values[i]);
 	}
 
+	m_registerWriteBufferPool.Release(massiveWrite.writes);
+
 	assert(m_transferCount != 0);
 	m_transferCount--;
 }
@@ -1718,9 +1750,13 @@ void CGSHandler::WriteToDelayedRegister(uint32 address, uint32 value, DELAYED_RE
 
 void CGSHandler::ThreadProc()
 {
+	CProfiler::GetInstance().SetThreadName("GS");
 	while(!m_threadDone)
 	{
 		m_mailBox.WaitForCall();
+#ifdef PROFILE
+		CProfilerZone profilerZone(m_gsProfilerZone);
+#endif
 		while(m_mailBox.IsPending())
 		{
 			m_mailBox.ReceiveCall();
@@ -12,8 +12,11 @@
 #include "Convertible.h"
 #include "../MailBox.h"
 #include "../Integer64.h"
+#include "../Profiler.h"
 #include "zip/ZipArchiveWriter.h"
 #include "zip/ZipArchiveReader.h"
+#include "../states/MemoryStateTracker.h"
+#include "GsRegisterWriteBuffer.h"
 
 class CFrameDump;
 class CGsPacketMetadata;
@@ -714,8 +717,8 @@ public:
 	void Reset();
 	void SetPresentationParams(const PRESENTATION_PARAMS&);
 
-	virtual void SaveState(Framework::CZipArchiveWriter&);
-	virtual void LoadState(Framework::CZipArchiveReader&);
+	virtual void SaveState(Framework::CZipArchiveWriter&, CMemoryStateTracker* = nullptr);
+	virtual void LoadState(Framework::CZipArchiveReader&, CMemoryStateTracker* = nullptr);
 
 	void SetFrameDump(CFrameDump*);
 
@@ -735,6 +738,8 @@ public:
 	void FeedImageData(const void*, uint32);
 	void ReadImageData(void*, uint32);
 	void WriteRegisterMassively(RegisterWriteList, const CGsPacketMetadata*);
+	void WriteRegisterMassively(GsRegisterWriteBufferPtr, const CGsPacketMetadata*);
+	GsRegisterWriteBufferPtr AcquireRegisterWriteBuffer();
 
 	virtual void SetCrt(bool, unsigned int, bool);
 	void Initialize();
@@ -983,9 +988,11 @@ protected:
 	std::thread m_thread;
 	std::recursive_mutex m_registerMutex;
 	std::atomic<int> m_transferCount;
+	CGsRegisterWriteBufferPool m_registerWriteBufferPool;
 	CMailBox m_mailBox;
 	bool m_threadDone;
 	CFrameDump* m_frameDump;
 	bool m_drawEnabled = true;
 	CINTC* m_intc = nullptr;
+	CProfiler::ZoneHandle m_gsProfilerZone = 0;
 };
@@ -0,0 +1,47 @@
+#include <algorithm>
+#include "GsRegisterWriteBuffer.h"
+
+void CGsRegisterWriteBuffer::Grow()
+{
+	size_t capacity = std::max<size_t>(INITIAL_CAPACITY, m_values.size() * 2);
+	m_registers.resize(capacity);
+	m_values.resize(capacity);
+}
+
+void CGsRegisterWriteBuffer::Append(const CGsRegisterWriteBuffer& src)
+{
+	size_t size = m_size + src.m_size;
+	if(size > m_values.size())
+	{
+		size_t capacity = std::max<size_t>(size, m_values.size() * 2);
+		m_registers.resize(capacity);
+		m_values.resize(capacity);
+	}
+	std::copy(src.m_registers.begin(), src.m_registers.begin() + src.m_size, m_registers.begin() + m_size);
+	std::copy(src.m_values.begin(), src.m_values.begin() + src.m_size, m_values.begin() + m_size);
+	m_size = size;
+}
+
+GsRegisterWriteBufferPtr CGsRegisterWriteBufferPool::Acquire()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if(!m_freeBuffers.empty())
+		{
+			auto buffer = std::move(m_freeBuffers.back());
+			m_freeBuffers.pop_back();
+			return buffer;
+		}
+	}
+	return std::make_shared<CGsRegisterWriteBuffer>();
+}
+
+void CGsRegisterWriteBufferPool::Release(const GsRegisterWriteBufferPtr& buffer)
+{
+	buffer->Clear();
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if(m_freeBuffers.size() < MAX_FREE_BUFFERS)
+	{
+		m_freeBuffers.push_back(buffer);
+	}
+}
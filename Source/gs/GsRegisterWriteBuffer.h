@@ -0,0 +1,86 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Types.h"
+
+//Register writes sent from the GIF to the GS thread. Register ids and values are kept in
+//separate arrays and buffers go back to a pool once the GS thread is done with them, so
+//capacity is reused from one packet to the next instead of being allocated every time.
+class CGsRegisterWriteBuffer
+{
+public:
+	void Clear()
+	{
+		m_size = 0;
+	}
+
+	bool IsEmpty() const
+	{
+		return m_size == 0;
+	}
+
+	size_t GetSize() const
+	{
+		return m_size;
+	}
+
+	size_t GetCapacity() const
+	{
+		return m_values.size();
+	}
+
+	const uint8* GetRegisters() const
+	{
+		return m_registers.data();
+	}
+
+	const uint64* GetValues() const
+	{
+		return m_values.data();
+	}
+
+	void Push(uint8 registerId, uint64 value)
+	{
+		if(m_size == m_values.size())
+		{
+			Grow();
+		}
+		m_registers[m_size] = registerId;
+		m_values[m_size] = value;
+		m_size++;
+	}
+
+	void Append(const CGsRegisterWriteBuffer&);
+
+private:
+	enum
+	{
+		INITIAL_CAPACITY = 0x400,
+	};
+
+	void Grow();
+
+	std::vector<uint8> m_registers;
+	std::vector<uint64> m_values;
+	size_t m_size = 0;
+};
+
+typedef std::shared_ptr<CGsRegisterWriteBuffer> GsRegisterWriteBufferPtr;
+
+class CGsRegisterWriteBufferPool
+{
+public:
+	GsRegisterWriteBufferPtr Acquire();
+	void Release(const GsRegisterWriteBufferPtr&);
+
+private:
+	enum
+	{
+		MAX_FREE_BUFFERS = 0x40,
+	};
+
+	std::mutex m_mutex;
+	std::vector<GsRegisterWriteBufferPtr> m_freeBuffers;
+};
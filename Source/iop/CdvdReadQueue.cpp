@@ -0,0 +1,286 @@
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include "CdvdReadQueue.h"
+#include "IopBios.h"
+#include "../OpticalMedia.h"
+#include "../Ps2Const.h"
+#include "../states/RegisterStateFile.h"
+
+using namespace Iop;
+
+//Rough approximations of the PS2's drive performance
+#define DVD_SECTORS_PER_SECOND (2700) //~4x DVD speed
+#define CD_SECTORS_PER_SECOND (1800)  //~24x CD speed
+#define NEAR_SEEK_SECTORS (0x4000)
+#define NEAR_SEEK_TIME_US (2000)
+#define FAR_SEEK_TIME_US (20000)
+
+#define STATE_READQUEUE_NEXT_SECTOR ("ReadQueueNextSector")
+#define STATE_READQUEUE_DRIVE_BUSY_UNTIL ("ReadQueueDriveBusyUntil")
+#define STATE_READQUEUE_LAST_ERROR ("ReadQueueLastError")
+
+CCdvdReadQueue::CCdvdReadQueue(const CIopBios& bios)
+    : m_bios(bios)
+{
+	m_thread = std::thread([this]() { ThreadProc(); });
+}
+
+CCdvdReadQueue::~CCdvdReadQueue()
+{
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_terminate = true;
+	}
+	m_requestCondition.notify_one();
+	m_thread.join();
+}
+
+void CCdvdReadQueue::SetOpticalMedia(COpticalMedia* opticalMedia)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	WaitForIdle(lock);
+	AbortRequests();
+	m_opticalMedia = opticalMedia;
+}
+
+CCdvdReadQueue::RequestId CCdvdReadQueue::QueueRead(uint32 sector, uint32 count)
+{
+	uint64 currentTime = m_bios.GetCurrentTime();
+	RequestId requestId = INVALID_REQUEST_ID;
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		//Requests are serviced in order by the drive
+		uint64 startTime = std::max(currentTime, m_driveBusyUntil);
+		uint64 completionTime = startTime + ComputeReadTime(sector, count);
+		m_driveBusyUntil = completionTime;
+		m_nextSector = sector + count;
+
+		requestId = PushRequest(sector, count, completionTime);
+	}
+	m_requestCondition.notify_one();
+	return requestId;
+}
+
+CCdvdReadQueue::RequestId CCdvdReadQueue::RestoreRead(uint32 sector, uint32 count, uint64 completionTime)
+{
+	RequestId requestId = INVALID_REQUEST_ID;
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		requestId = PushRequest(sector, count, completionTime);
+	}
+	m_requestCondition.notify_one();
+	return requestId;
+}
+
+bool CCdvdReadQueue::IsReadComplete(RequestId requestId)
+{
+	uint64 currentTime = m_bios.GetCurrentTime();
+	std::unique_lock<std::mutex> lock(m_mutex);
+	if(m_abortedRequests.count(requestId) != 0) return true;
+	auto requestIterator = FindRequest(requestId);
+	assert(requestIterator != std::end(m_requests));
+	if(requestIterator == std::end(m_requests)) return false;
+	auto request = *requestIterator;
+	if(currentTime < request->completionTime) return false;
+	//Emulated drive is done, the host must catch up for timing to stay deterministic
+	m_loadedCondition.wait(lock, [&]() { return request->loaded; });
+	return true;
+}
+
+bool CCdvdReadQueue::IsAnyReadDue(uint64 currentTime) const
+{
+	return currentTime >= m_nextCompletionTime;
+}
+
+uint64 CCdvdReadQueue::GetCompletionTime(RequestId requestId)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	//Aborted reads are already due
+	if(m_abortedRequests.count(requestId) != 0) return 0;
+	auto requestIterator = FindRequest(requestId);
+	assert(requestIterator != std::end(m_requests));
+	if(requestIterator == std::end(m_requests)) return 0;
+	return (*requestIterator)->completionTime;
+}
+
+bool CCdvdReadQueue::FinishRead(RequestId requestId, uint8* output)
+{
+	RequestPtr request;
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		if(m_abortedRequests.erase(requestId) != 0)
+		{
+			m_lastError = DRIVE_ERROR_ABORTED;
+			UpdateNextCompletionTime();
+			return false;
+		}
+		auto requestIterator = FindRequest(requestId);
+		if(requestIterator == std::end(m_requests)) return false;
+		request = *requestIterator;
+		m_loadedCondition.wait(lock, [&]() { return request->loaded; });
+		m_requests.erase(FindRequest(requestId));
+		UpdateNextCompletionTime();
+	}
+	m_lastError = DRIVE_ERROR_NONE;
+	if(request->error)
+	{
+		std::rethrow_exception(request->error);
+	}
+	if(output && !request->data.empty())
+	{
+		memcpy(output, request->data.data(), request->data.size());
+	}
+	return true;
+}
+
+uint32 CCdvdReadQueue::GetLastError() const
+{
+	return m_lastError;
+}
+
+void CCdvdReadQueue::Reset()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	WaitForIdle(lock);
+	AbortRequests();
+	m_nextSector = 0;
+	m_driveBusyUntil = 0;
+	m_lastError = DRIVE_ERROR_NONE;
+}
+
+void CCdvdReadQueue::LoadState(const CRegisterStateFile& registerFile)
+{
+	//Older states don't have these, the drive is considered idle in that case
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_nextSector = registerFile.GetRegister32(STATE_READQUEUE_NEXT_SECTOR);
+	m_driveBusyUntil = registerFile.GetRegister64(STATE_READQUEUE_DRIVE_BUSY_UNTIL);
+	m_lastError = registerFile.GetRegister32(STATE_READQUEUE_LAST_ERROR);
+	//Modules reissue the reads they had in flight when loading their state, aborted ones are forgotten
+	m_abortedRequests.clear();
+	UpdateNextCompletionTime();
+}
+
+void CCdvdReadQueue::SaveState(CRegisterStateFile& registerFile)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	registerFile.SetRegister32(STATE_READQUEUE_NEXT_SECTOR, m_nextSector);
+	registerFile.SetRegister64(STATE_READQUEUE_DRIVE_BUSY_UNTIL, m_driveBusyUntil);
+	registerFile.SetRegister32(STATE_READQUEUE_LAST_ERROR, m_lastError);
+}
+
+uint64 CCdvdReadQueue::ComputeReadTime(uint32 sector, uint32 count)
+{
+	uint32 sectorsPerSecond = DVD_SECTORS_PER_SECOND;
+	if(m_opticalMedia && (m_opticalMedia->GetTrackDataType(0) == COpticalMedia::TRACK_DATA_TYPE_MODE2_2352))
+	{
+		sectorsPerSecond = CD_SECTORS_PER_SECOND;
+	}
+
+	uint64 seekTime = 0;
+	if(sector != m_nextSector)
+	{
+		uint32 distance = (sector > m_nextSector) ? (sector - m_nextSector) : (m_nextSector - sector);
+		seekTime = (distance < NEAR_SEEK_SECTORS) ? NEAR_SEEK_TIME_US : FAR_SEEK_TIME_US;
+		seekTime = (seekTime * PS2::IOP_CLOCK_OVER_FREQ) / 1000000;
+	}
+
+	uint64 transferTime = (static_cast<uint64>(count) * PS2::IOP_CLOCK_OVER_FREQ) / sectorsPerSecond;
+	return seekTime + transferTime;
+}
+
+CCdvdReadQueue::RequestId CCdvdReadQueue::PushRequest(uint32 sector, uint32 count, uint64 completionTime)
+{
+	auto request = std::make_shared<REQUEST>();
+
+	request->id = m_nextRequestId++;
+	if(m_nextRequestId == INVALID_REQUEST_ID) m_nextRequestId++;
+	request->sector = sector;
+	request->count = count;
+	request->completionTime = completionTime;
+
+	if(!m_opticalMedia || (count == 0))
+	{
+		request->loaded = true;
+	}
+
+	m_requests.push_back(request);
+	UpdateNextCompletionTime();
+	return request->id;
+}
+
+CCdvdReadQueue::RequestQueue::iterator CCdvdReadQueue::FindRequest(RequestId requestId)
+{
+	return std::find_if(std::begin(m_requests), std::end(m_requests),
+	                    [requestId](const RequestPtr& request) { return request->id == requestId; });
+}
+
+void CCdvdReadQueue::AbortRequests()
+{
+	//Request ids are still held by the modules that issued them, they must see the reads complete
+	for(const auto& request : m_requests)
+	{
+		m_abortedRequests.insert(request->id);
+	}
+	m_requests.clear();
+	UpdateNextCompletionTime();
+}
+
+void CCdvdReadQueue::UpdateNextCompletionTime()
+{
+	uint64 nextCompletionTime = m_abortedRequests.empty() ? UINT64_MAX : 0;
+	for(const auto& request : m_requests)
+	{
+		nextCompletionTime = std::min(nextCompletionTime, request->completionTime);
+	}
+	m_nextCompletionTime = nextCompletionTime;
+}
+
+void CCdvdReadQueue::WaitForIdle(std::unique_lock<std::mutex>& lock)
+{
+	m_loadedCondition.wait(lock, [this]() { return !m_activeRequest; });
+}
+
+void CCdvdReadQueue::ThreadProc()
+{
+	while(1)
+	{
+		RequestPtr request;
+		CISO9660* fileSystem = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_requestCondition.wait(lock,
+			                        [this]() {
+				                        return m_terminate ||
+				                               std::any_of(std::begin(m_requests), std::end(m_requests),
+				                                           [](const RequestPtr& request) { return !request->loaded; });
+			                        });
+			if(m_terminate) break;
+			auto requestIterator = std::find_if(std::begin(m_requests), std::end(m_requests),
+			                                    [](const RequestPtr& request) { return !request->loaded; });
+			assert(requestIterator != std::end(m_requests));
+			request = *requestIterator;
+			m_activeRequest = request;
+			assert(m_opticalMedia);
+			fileSystem = m_opticalMedia->GetFileSystem();
+		}
+
+		try
+		{
+			request->data.resize(static_cast<size_t>(request->count) * SECTOR_SIZE);
+			fileSystem->ReadBlocks(request->sector, request->count, request->data.data());
+		}
+		catch(...)
+		{
+			request->error = std::current_exception();
+		}
+
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			request->loaded = true;
+			m_activeRequest.reset();
+		}
+		m_loadedCondition.notify_all();
+	}
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+#include "Types.h"
+
+class CIopBios;
+class COpticalMedia;
+class CRegisterStateFile;
+
+namespace Iop
+{
+	//Services CDVD sector reads on a worker thread. Data lands in a staging buffer
+	//and is only made available once the emulated drive would have completed the read.
+	class CCdvdReadQueue
+	{
+	public:
+		typedef uint32 RequestId;
+
+		enum : RequestId
+		{
+			INVALID_REQUEST_ID = 0,
+		};
+
+		//Same values as the ones returned by sceCdGetError
+		enum DRIVE_ERROR : uint32
+		{
+			DRIVE_ERROR_NONE = 0x00,
+			DRIVE_ERROR_ABORTED = 0x01,
+		};
+
+		CCdvdReadQueue(const CIopBios&);
+		virtual ~CCdvdReadQueue();
+
+		//Reads in flight are aborted, they complete right away without data
+		void SetOpticalMedia(COpticalMedia*);
+
+		RequestId QueueRead(uint32, uint32);
+		//Queues a read that was in flight when a state was saved, keeping its completion time
+		RequestId RestoreRead(uint32, uint32, uint64);
+		//Returns true once the emulated drive is done, waits for the data if the host is late
+		bool IsReadComplete(RequestId);
+		//Cheap check that can be done every time IOP ticks are counted
+		bool IsAnyReadDue(uint64) const;
+		uint64 GetCompletionTime(RequestId);
+		//Returns false if the read was aborted, output is left untouched in that case
+		bool FinishRead(RequestId, uint8*);
+		uint32 GetLastError() const;
+		void Reset();
+
+		void LoadState(const CRegisterStateFile&);
+		void SaveState(CRegisterStateFile&);
+
+	private:
+		enum
+		{
+			SECTOR_SIZE = 0x800,
+		};
+
+		struct REQUEST
+		{
+			RequestId id = INVALID_REQUEST_ID;
+			uint32 sector = 0;
+			uint32 count = 0;
+			uint64 completionTime = 0;
+			bool loaded = false;
+			std::exception_ptr error;
+			std::vector<uint8> data;
+		};
+		typedef std::shared_ptr<REQUEST> RequestPtr;
+		typedef std::deque<RequestPtr> RequestQueue;
+
+		uint64 ComputeReadTime(uint32, uint32);
+		RequestId PushRequest(uint32, uint32, uint64);
+		RequestQueue::iterator FindRequest(RequestId);
+		void AbortRequests();
+		void UpdateNextCompletionTime();
+		void WaitForIdle(std::unique_lock<std::mutex>&);
+		void ThreadProc();
+
+		const CIopBios& m_bios;
+		COpticalMedia* m_opticalMedia = nullptr;
+
+		std::thread m_thread;
+		std::mutex m_mutex;
+		std::condition_variable m_requestCondition;
+		std::condition_variable m_loadedCondition;
+		RequestQueue m_requests;
+		RequestPtr m_activeRequest;
+		//Requests dropped by a media change or a reset, kept until their owner finishes them
+		std::set<RequestId> m_abortedRequests;
+		std::atomic<uint32> m_lastError = {DRIVE_ERROR_NONE};
+		bool m_terminate = false;
+
+		RequestId m_nextRequestId = INVALID_REQUEST_ID + 1;
+		uint32 m_nextSector = 0;
+		uint64 m_driveBusyUntil = 0;
+		std::atomic<uint64> m_nextCompletionTime = {UINT64_MAX};
+	};
+}
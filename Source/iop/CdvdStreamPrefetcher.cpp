@@ -0,0 +1,191 @@
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include "CdvdStreamPrefetcher.h"
+#include "../OpticalMedia.h"
+
+using namespace Iop;
+
+CCdvdStreamPrefetcher::CCdvdStreamPrefetcher()
+{
+	m_ring.resize(m_depth * SECTOR_SIZE);
+	m_thread = std::thread([this]() { ThreadProc(); });
+}
+
+CCdvdStreamPrefetcher::~CCdvdStreamPrefetcher()
+{
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_terminate = true;
+	}
+	m_fillCondition.notify_one();
+	m_thread.join();
+}
+
+void CCdvdStreamPrefetcher::SetOpticalMedia(COpticalMedia* opticalMedia)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_idleCondition.wait(lock, [this]() { return !m_filling; });
+	m_opticalMedia = opticalMedia;
+	m_active = false;
+	RestartLocked(0);
+}
+
+void CCdvdStreamPrefetcher::SetDepth(uint32 depth)
+{
+	depth = std::max<uint32>(depth, MIN_DEPTH);
+	depth = std::min<uint32>(depth, MAX_DEPTH);
+	std::unique_lock<std::mutex> lock(m_mutex);
+	if(depth == m_depth) return;
+	m_idleCondition.wait(lock, [this]() { return !m_filling; });
+	m_depth = depth;
+	m_ring.resize(m_depth * SECTOR_SIZE);
+	RestartLocked(m_ringStartSector);
+}
+
+void CCdvdStreamPrefetcher::Start(uint32 sector)
+{
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_active = (m_opticalMedia != nullptr);
+		RestartLocked(sector);
+	}
+	m_fillCondition.notify_one();
+}
+
+void CCdvdStreamPrefetcher::Stop()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_active = false;
+}
+
+void CCdvdStreamPrefetcher::Read(uint32 sector, uint32 count, uint8* output)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	if(!m_opticalMedia) return;
+
+	m_stats.sectorsRead += count;
+
+	if(!m_active || (sector != m_ringStartSector))
+	{
+		//Reading from somewhere we didn't expect, start streaming from there
+		m_active = true;
+		RestartLocked(sector);
+	}
+
+	//Consume what's already in the ring
+	while((count != 0) && (m_ringFilled != 0))
+	{
+		uint32 copyCount = std::min(count, std::min(m_ringFilled, m_depth - m_ringStart));
+		memcpy(output, m_ring.data() + (m_ringStart * SECTOR_SIZE), copyCount * SECTOR_SIZE);
+		output += copyCount * SECTOR_SIZE;
+		count -= copyCount;
+		m_ringStart = (m_ringStart + copyCount) % m_depth;
+		m_ringStartSector += copyCount;
+		m_ringFilled -= copyCount;
+		m_stats.sectorsFromBuffer += copyCount;
+	}
+
+	if(count != 0)
+	{
+		//Underrun: prefetching didn't keep up, read the rest directly
+		m_stats.underruns++;
+		m_stats.underrunSectors += count;
+		uint32 readSector = m_ringStartSector;
+		RestartLocked(readSector + count);
+		auto fileSystem = m_opticalMedia->GetFileSystem();
+		lock.unlock();
+		fileSystem->ReadBlocks(readSector, count, output);
+	}
+	else
+	{
+		lock.unlock();
+	}
+
+	m_fillCondition.notify_one();
+}
+
+uint32 CCdvdStreamPrefetcher::GetBufferedSectorCount()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	return m_ringFilled;
+}
+
+CCdvdStreamPrefetcher::STATS CCdvdStreamPrefetcher::GetStats()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	return m_stats;
+}
+
+void CCdvdStreamPrefetcher::ResetStats()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_stats = STATS();
+}
+
+void CCdvdStreamPrefetcher::RestartLocked(uint32 sector)
+{
+	//Any fill in progress will be discarded since generation changes
+	m_generation++;
+	m_ringStart = 0;
+	m_ringStartSector = sector;
+	m_ringFilled = 0;
+	m_endReached = false;
+}
+
+void CCdvdStreamPrefetcher::ThreadProc()
+{
+	while(1)
+	{
+		CISO9660* fileSystem = nullptr;
+		uint32 generation = 0;
+		uint32 fillSector = 0;
+		uint32 fillCount = 0;
+		uint8* fillOutput = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_filling = false;
+			m_idleCondition.notify_all();
+			m_fillCondition.wait(lock,
+			                     [this]() {
+				                     return m_terminate ||
+				                            (m_active && !m_endReached && (m_ringFilled < m_depth));
+			                     });
+			if(m_terminate) break;
+			assert(m_opticalMedia);
+			//Fill the next contiguous free area of the ring
+			uint32 fillIndex = (m_ringStart + m_ringFilled) % m_depth;
+			fillCount = std::min<uint32>(m_depth - m_ringFilled, m_depth - fillIndex);
+			fillCount = std::min<uint32>(fillCount, MAX_FILL_SECTORS);
+			fillSector = m_ringStartSector + m_ringFilled;
+			fillOutput = m_ring.data() + (fillIndex * SECTOR_SIZE);
+			generation = m_generation;
+			fileSystem = m_opticalMedia->GetFileSystem();
+			m_filling = true;
+		}
+
+		bool succeeded = true;
+		try
+		{
+			fileSystem->ReadBlocks(fillSector, fillCount, fillOutput);
+		}
+		catch(...)
+		{
+			succeeded = false;
+		}
+
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			if(generation != m_generation) continue;
+			if(succeeded)
+			{
+				m_ringFilled += fillCount;
+			}
+			else
+			{
+				//Probably reached the end of the disc
+				m_endReached = true;
+			}
+		}
+	}
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Types.h"
+
+class COpticalMedia;
+
+namespace Iop
+{
+	//Keeps a ring of upcoming sectors resident for CDVD streaming (CdStRead & co.).
+	//Sectors are read ahead of the consumer on a worker thread.
+	class CCdvdStreamPrefetcher
+	{
+	public:
+		struct STATS
+		{
+			uint32 sectorsRead = 0;
+			uint32 sectorsFromBuffer = 0;
+			uint32 underruns = 0;
+			uint32 underrunSectors = 0;
+		};
+
+		enum
+		{
+			DEFAULT_DEPTH = 0x100,
+			MIN_DEPTH = 0x20,
+			MAX_DEPTH = 0x1000,
+		};
+
+		CCdvdStreamPrefetcher();
+		virtual ~CCdvdStreamPrefetcher();
+
+		void SetOpticalMedia(COpticalMedia*);
+		void SetDepth(uint32);
+
+		void Start(uint32);
+		void Stop();
+		void Read(uint32, uint32, uint8*);
+
+		//Amount of sectors ready to be read from the current stream position
+		uint32 GetBufferedSectorCount();
+
+		STATS GetStats();
+		void ResetStats();
+
+	private:
+		enum
+		{
+			SECTOR_SIZE = 0x800,
+			MAX_FILL_SECTORS = 0x20,
+		};
+
+		void RestartLocked(uint32);
+		void ThreadProc();
+
+		COpticalMedia* m_opticalMedia = nullptr;
+
+		std::thread m_thread;
+		std::mutex m_mutex;
+		std::condition_variable m_fillCondition;
+		std::condition_variable m_idleCondition;
+		bool m_terminate = false;
+		bool m_active = false;
+		bool m_filling = false;
+		bool m_endReached = false;
+
+		std::vector<uint8> m_ring;
+		uint32 m_depth = DEFAULT_DEPTH;
+		uint32 m_ringStart = 0;
+		uint32 m_ringStartSector = 0;
+		uint32 m_ringFilled = 0;
+		uint32 m_generation = 0;
+
+		STATS m_stats;
+	};
+}
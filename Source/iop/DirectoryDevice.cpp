@@ -7,8 +7,9 @@
 
 using namespace Iop::Ioman;
 
-CDirectoryDevice::CDirectoryDevice(const char* basePathPreferenceName)
+CDirectoryDevice::CDirectoryDevice(const char* basePathPreferenceName, bool cacheHostFiles)
     : m_basePathPreferenceName(basePathPreferenceName)
+    , m_fileCache(std::make_shared<CHostFileCache>(cacheHostFiles ? CHostFileCache::DEFAULT_MAX_ENTRIES : 0))
 {
 }
 
@@ -38,7 +39,14 @@ Framework::CStream* CDirectoryDevice::GetFile(uint32 accessType, const char* dev
 	{
 	case 0:
 	case OPEN_FLAG_RDONLY:
-		mode = "rb";
+		try
+		{
+			return new CReadAheadStream(m_fileCache, path);
+		}
+		catch(...)
+		{
+			return nullptr;
+		}
 		break;
 	case(OPEN_FLAG_WRONLY | OPEN_FLAG_CREAT):
 	case(OPEN_FLAG_WRONLY | OPEN_FLAG_CREAT | OPEN_FLAG_TRUNC):
@@ -55,6 +63,9 @@ Framework::CStream* CDirectoryDevice::GetFile(uint32 accessType, const char* dev
 		break;
 	}
 
+	//Don't keep the file opened while it's modified, some hosts don't allow replacing opened files
+	m_fileCache->Evict(path);
+
 	try
 	{
 		return CreateStdStream(path.native(), mode);
@@ -65,6 +76,16 @@ Framework::CStream* CDirectoryDevice::GetFile(uint32 accessType, const char* dev
 	}
 }
 
+CHostFileCache::STATS CDirectoryDevice::GetFrameStats()
+{
+	return m_fileCache->GetFrameStats();
+}
+
+void CDirectoryDevice::EndFrame()
+{
+	m_fileCache->EndFrame();
+}
+
 Directory CDirectoryDevice::GetDirectory(const char* devicePath)
 {
 	auto basePath = CAppConfig::GetInstance().GetPreferencePath(m_basePathPreferenceName.c_str());
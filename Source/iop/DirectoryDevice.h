@@ -2,6 +2,7 @@
 
 #include <string>
 #include "Ioman_Device.h"
+#include "Ioman_ReadAheadStream.h"
 
 namespace Iop
 {
@@ -10,14 +11,20 @@ namespace Iop
 		class CDirectoryDevice : public CDevice
 		{
 		public:
-			CDirectoryDevice(const char*);
+			//Files closed by the guest are kept opened for a while if 'cacheHostFiles' is set. This must
+			//not be used if something else than the device can modify, delete or rename its files.
+			CDirectoryDevice(const char*, bool cacheHostFiles = true);
 			virtual ~CDirectoryDevice() = default;
 
 			Framework::CStream* GetFile(uint32, const char*) override;
 			Directory GetDirectory(const char*) override;
 
+			CHostFileCache::STATS GetFrameStats();
+			void EndFrame();
+
 		private:
 			std::string m_basePathPreferenceName;
+			HostFileCachePtr m_fileCache;
 		};
 	}
 }
@@ -0,0 +1,214 @@
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include "Ioman_ReadAheadStream.h"
+
+using namespace Iop::Ioman;
+
+/////////////////////////////////////////////
+//CHostFileCache Implementation
+/////////////////////////////////////////////
+
+CHostFileCache::CHostFileCache(uint32 maxEntries)
+    : m_maxEntries(maxEntries)
+{
+}
+
+CHostFileCache::HOSTFILE CHostFileCache::Acquire(const fs::path& path)
+{
+	m_currentStats.openCount++;
+	m_currentStats.hostStatCount++;
+
+	auto modificationTime = fs::last_write_time(path);
+	auto entryIterator = std::find_if(std::begin(m_entries), std::end(m_entries),
+	                                  [&path](const ENTRY& entry) { return entry.key == path; });
+	if(entryIterator != std::end(m_entries))
+	{
+		auto file = std::move(entryIterator->file);
+		m_entries.erase(entryIterator);
+		if(file.modificationTime == modificationTime)
+		{
+			m_currentStats.handleCacheHitCount++;
+			return file;
+		}
+	}
+
+	HOSTFILE file;
+	file.stream = OpenHostFile(path);
+	file.modificationTime = modificationTime;
+	return file;
+}
+
+void CHostFileCache::Release(const fs::path& path, HOSTFILE file)
+{
+	if(m_maxEntries == 0) return;
+
+	ENTRY entry;
+	entry.key = path;
+	entry.file = std::move(file);
+	m_entries.push_front(std::move(entry));
+	if(m_entries.size() > m_maxEntries)
+	{
+		m_entries.pop_back();
+	}
+}
+
+void CHostFileCache::Evict(const fs::path& path)
+{
+	m_entries.remove_if([&path](const ENTRY& entry) { return entry.key == path; });
+}
+
+void CHostFileCache::Clear()
+{
+	m_entries.clear();
+}
+
+CHostFileCache::STATS CHostFileCache::GetFrameStats()
+{
+	std::lock_guard<std::mutex> frameStatsLock(m_frameStatsMutex);
+	return m_frameStats;
+}
+
+void CHostFileCache::EndFrame()
+{
+	std::lock_guard<std::mutex> frameStatsLock(m_frameStatsMutex);
+	m_frameStats = m_currentStats;
+	m_currentStats = STATS();
+}
+
+CHostFileCache::FilePtr CHostFileCache::OpenHostFile(const fs::path& path)
+{
+#ifdef _WIN32
+	auto file = _wfopen(path.native().c_str(), L"rb");
+#else
+	auto file = fopen(path.native().c_str(), "rb");
+#endif
+	if(file == nullptr)
+	{
+		throw std::runtime_error("Failed to open host file.");
+	}
+	//Streams do their own buffering, this avoids copying data twice
+	setvbuf(file, nullptr, _IONBF, 0);
+	return std::make_unique<Framework::CStdStream>(file);
+}
+
+/////////////////////////////////////////////
+//CReadAheadStream Implementation
+/////////////////////////////////////////////
+
+CReadAheadStream::CReadAheadStream(const HostFileCachePtr& cache, const fs::path& path)
+    : m_cache(cache)
+    , m_path(path)
+    , m_file(cache->Acquire(path))
+{
+}
+
+CReadAheadStream::~CReadAheadStream()
+{
+	m_cache->Release(m_path, std::move(m_file));
+}
+
+void CReadAheadStream::Seek(int64 offset, Framework::STREAM_SEEK_DIRECTION whence)
+{
+	auto& stats = m_cache->m_currentStats;
+	stats.seekCount++;
+	switch(whence)
+	{
+	case Framework::STREAM_SEEK_SET:
+		m_position = offset;
+		break;
+	case Framework::STREAM_SEEK_CUR:
+		m_position += offset;
+		break;
+	case Framework::STREAM_SEEK_END:
+		//File size isn't known, let the host figure out the position
+		stats.hostSeekCount++;
+		m_file.stream->Seek(offset, Framework::STREAM_SEEK_END);
+		m_file.position = m_file.stream->Tell();
+		m_position = m_file.position;
+		break;
+	}
+	m_isEof = false;
+}
+
+uint64 CReadAheadStream::Tell()
+{
+	return m_position;
+}
+
+uint64 CReadAheadStream::Read(void* buffer, uint64 size)
+{
+	m_cache->m_currentStats.readCount++;
+
+	auto output = reinterpret_cast<uint8*>(buffer);
+	uint64 totalSize = 0;
+	while(size != 0)
+	{
+		uint64 bufferEnd = m_bufferPosition + m_bufferSize;
+		if((m_position >= m_bufferPosition) && (m_position < bufferEnd))
+		{
+			uint64 copySize = std::min(size, bufferEnd - m_position);
+			memcpy(output, m_buffer.data() + (m_position - m_bufferPosition), copySize);
+			output += copySize;
+			size -= copySize;
+			totalSize += copySize;
+			m_position += copySize;
+			continue;
+		}
+
+		if(m_bufferAtEnd && (m_position == bufferEnd))
+		{
+			m_isEof = true;
+			break;
+		}
+
+		if(size >= BUFFER_SIZE)
+		{
+			//Large reads don't benefit from buffering
+			uint64 readSize = ReadHost(output, size);
+			totalSize += readSize;
+			m_position += readSize;
+			m_isEof = (readSize != size);
+			break;
+		}
+
+		m_buffer.resize(BUFFER_SIZE);
+		m_bufferPosition = m_position;
+		m_bufferSize = ReadHost(m_buffer.data(), BUFFER_SIZE);
+		m_bufferAtEnd = (m_bufferSize != BUFFER_SIZE);
+		if(m_bufferSize == 0)
+		{
+			m_isEof = true;
+			break;
+		}
+	}
+	return totalSize;
+}
+
+uint64 CReadAheadStream::Write(const void*, uint64)
+{
+	throw std::runtime_error("Stream is read-only.");
+}
+
+bool CReadAheadStream::IsEOF()
+{
+	return m_isEof;
+}
+
+void CReadAheadStream::SyncHostPosition()
+{
+	if(m_file.position == m_position) return;
+	m_cache->m_currentStats.hostSeekCount++;
+	m_file.stream->Seek(m_position, Framework::STREAM_SEEK_SET);
+	m_file.position = m_position;
+}
+
+uint64 CReadAheadStream::ReadHost(void* buffer, uint64 size)
+{
+	SyncHostPosition();
+	m_cache->m_currentStats.hostReadCount++;
+	uint64 readSize = m_file.stream->Read(buffer, size);
+	m_file.position += readSize;
+	return readSize;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <algorithm>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Types.h"
+#include "Stream.h"
+#include "StdStream.h"
+#include "filesystem_def.h"
+
+namespace Iop
+{
+	namespace Ioman
+	{
+		class CReadAheadStream;
+
+		//Keeps host files that were recently closed by the guest opened, since games tend to open
+		//the same files over and over again. Files are checked for modifications before being reused.
+		class CHostFileCache
+		{
+		public:
+			typedef std::unique_ptr<Framework::CStdStream> FilePtr;
+
+			struct STATS
+			{
+				uint32 openCount = 0;
+				uint32 handleCacheHitCount = 0;
+				uint64 readCount = 0;
+				uint64 hostReadCount = 0;
+				uint64 seekCount = 0;
+				uint64 hostSeekCount = 0;
+				//Modification time checks, done on every open
+				uint64 hostStatCount = 0;
+
+				//Every cache hit saves an open and a close. Host seeks don't always match a guest seek,
+				//so more syscalls than the guest asked for can be made.
+				uint64 GetSavedSyscallCount() const
+				{
+					int64 guestSyscallCount = static_cast<int64>(readCount + seekCount + (2 * static_cast<uint64>(handleCacheHitCount)));
+					int64 hostSyscallCount = static_cast<int64>(hostReadCount + hostSeekCount + hostStatCount);
+					return static_cast<uint64>(std::max<int64>(guestSyscallCount - hostSyscallCount, 0));
+				}
+			};
+
+			struct HOSTFILE
+			{
+				FilePtr stream;
+				uint64 position = 0;
+				fs::file_time_type modificationTime;
+			};
+
+			enum
+			{
+				DEFAULT_MAX_ENTRIES = 8,
+			};
+
+			//A cache with no entries closes files as soon as they are released
+			CHostFileCache(uint32 maxEntries = DEFAULT_MAX_ENTRIES);
+
+			HOSTFILE Acquire(const fs::path&);
+			void Release(const fs::path&, HOSTFILE);
+			void Evict(const fs::path&);
+			void Clear();
+
+			STATS GetFrameStats();
+			void EndFrame();
+
+		private:
+			friend class CReadAheadStream;
+
+			struct ENTRY
+			{
+				fs::path key;
+				HOSTFILE file;
+			};
+			typedef std::list<ENTRY> EntryList;
+
+			static FilePtr OpenHostFile(const fs::path&);
+
+			uint32 m_maxEntries = DEFAULT_MAX_ENTRIES;
+
+			//Most recently released first
+			EntryList m_entries;
+
+			STATS m_currentStats;
+			STATS m_frameStats;
+			std::mutex m_frameStatsMutex;
+		};
+		typedef std::shared_ptr<CHostFileCache> HostFileCachePtr;
+
+		//Read-only stream over a host file, small reads are served from a buffer filled with larger reads.
+		//File is given back to the cache when the stream is destroyed.
+		class CReadAheadStream : public Framework::CStream
+		{
+		public:
+			CReadAheadStream(const HostFileCachePtr&, const fs::path&);
+			virtual ~CReadAheadStream();
+
+			void Seek(int64, Framework::STREAM_SEEK_DIRECTION) override;
+			uint64 Tell() override;
+			uint64 Read(void*, uint64) override;
+			uint64 Write(const void*, uint64) override;
+			bool IsEOF() override;
+
+		private:
+			enum
+			{
+				BUFFER_SIZE = 0x10000,
+			};
+
+			void SyncHostPosition();
+			uint64 ReadHost(void*, uint64);
+
+			HostFileCachePtr m_cache;
+			fs::path m_path;
+			CHostFileCache::HOSTFILE m_file;
+
+			std::vector<uint8> m_buffer;
+			uint64 m_bufferPosition = 0;
+			uint64 m_bufferSize = 0;
+			//Set when the host returned less than requested, nothing is available past the end of the buffer
+			bool m_bufferAtEnd = false;
+
+			uint64 m_position = 0;
+			bool m_isEof = false;
+		};
+	}
+}
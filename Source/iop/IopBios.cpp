@@ -140,6 +140,7 @@ void CIopBios::Reset(const Iop::SifManPtr& sifMan)
 	//0xBE00000 = Stupid constant to make FFX PSF happy
 	CurrentTime() = 0xBE00000;
 	ThreadLinkHead() = 0;
+	ResetThreadQueues();
 	m_currentThreadId = -1;
 
 	m_cpu.m_State.nCOP0[CCOP_SCU::STATUS] |= CMIPS::STATUS_IE;
@@ -387,6 +388,9 @@ void CIopBios::LoadState(Framework::CZipArchiveReader& archive)
 	}
 #endif
 
+	//Thread list was restored with RAM
+	RebuildThreadQueues();
+
 #ifdef DEBUGGER_INCLUDED
 	m_cpu.m_analysis->Clear();
 	for(const auto& moduleTag : m_moduleTags)
@@ -1049,8 +1053,8 @@ int32 CIopBios::StartThreadArgs(uint32 threadId, uint32 args, uint32 argpPtr)
 	    };
 
 	thread->status = THREAD_STATUS_RUNNING;
-	LinkThread(threadId);
 	thread->priority = thread->initPriority;
+	LinkThread(threadId);
 	thread->context.epc = thread->threadProc;
 	thread->context.gpr[CMIPS::RA] = m_threadFinishAddress;
 	thread->context.gpr[CMIPS::SP] = thread->stackBase + thread->stackSize;
@@ -1227,6 +1231,17 @@ int32 CIopBios::ChangeThreadPriority(uint32 threadId, uint32 newPrio)
 		return KERNEL_RESULT_ERROR_UNKNOWN_THID;
 	}
 
+	if(newPrio == 0)
+	{
+		newPrio = thread->initPriority;
+	}
+
+	//Priority needs to be between [1, 126], same as CreateThread
+	if((newPrio < 1) || (newPrio > 126))
+	{
+		return KERNEL_RESULT_ERROR_ILLEGAL_PRIORITY;
+	}
+
 	thread->priority = newPrio;
 	if(thread->status == THREAD_STATUS_RUNNING)
 	{
@@ -1409,18 +1424,17 @@ int32 CIopBios::RotateThreadReadyQueue(uint32 priority)
 		priority = thread->priority;
 	}
 
-	uint32 nextThreadId = ThreadLinkHead();
-	while(nextThreadId != 0)
+	if(priority > 126)
 	{
-		auto nextThread = m_threads[nextThreadId];
-		if(nextThread->priority == priority)
-		{
-			UnlinkThread(nextThreadId);
-			LinkThread(nextThreadId);
-			m_rescheduleNeeded = true;
-			break;
-		}
-		nextThreadId = nextThread->nextThreadId;
+		return KERNEL_RESULT_ERROR_ILLEGAL_PRIORITY;
+	}
+
+	uint32 threadId = m_readyQueue.GetFirstWithPriority(priority);
+	if(threadId != Iop::CThreadReadyQueue::INVALID_THREAD_ID)
+	{
+		UnlinkThread(threadId);
+		LinkThread(threadId);
+		m_rescheduleNeeded = true;
 	}
 
 	return KERNEL_RESULT_OK;
@@ -1527,6 +1541,7 @@ void CIopBios::SleepThreadTillVBlankStart()
 	THREAD* thread = GetThread(m_currentThreadId);
 	thread->status = THREAD_STATUS_WAIT_VBLANK_START;
 	UnlinkThread(thread->id);
+	m_vblankStartWaitList.Set(thread->id);
 	m_rescheduleNeeded = true;
 }
 
@@ -1535,6 +1550,7 @@ void CIopBios::SleepThreadTillVBlankEnd()
 	THREAD* thread = GetThread(m_currentThreadId);
 	thread->status = THREAD_STATUS_WAIT_VBLANK_END;
 	UnlinkThread(thread->id);
+	m_vblankEndWaitList.Set(thread->id);
 	m_rescheduleNeeded = true;
 }
 
@@ -1566,48 +1582,104 @@ void CIopBios::SaveThreadContext(uint32 threadId)
 	thread->context.delayJump = m_cpu.m_State.nDelayedJumpAddr;
 }
 
+//The thread list in RAM is the one saved in states and used by the debugger,
+//m_readyQueue mirrors it to avoid walking it when looking for a thread to run.
 void CIopBios::LinkThread(uint32 threadId)
 {
 	auto thread = m_threads[threadId];
-	auto nextThreadId = &ThreadLinkHead();
-	while(1)
+	assert(thread);
+	uint32 prevThreadId = m_readyQueue.Link(threadId, thread->priority, thread->nextActivateTime, GetCurrentTime());
+	thread->nextThreadId = m_readyQueue.GetNext(threadId);
+	if(prevThreadId == Iop::CThreadReadyQueue::INVALID_THREAD_ID)
 	{
-		assert((*nextThreadId) < MAX_THREAD);
-		if((*nextThreadId) == 0)
-		{
-			(*nextThreadId) = threadId;
-			thread->nextThreadId = 0;
-			break;
-		}
-		auto currentThread = m_threads[(*nextThreadId)];
-		if(currentThread->priority > thread->priority)
-		{
-			thread->nextThreadId = (*nextThreadId);
-			(*nextThreadId) = threadId;
-			break;
-		}
-		nextThreadId = &currentThread->nextThreadId;
+		ThreadLinkHead() = threadId;
+	}
+	else
+	{
+		m_threads[prevThreadId]->nextThreadId = threadId;
 	}
 }
 
 void CIopBios::UnlinkThread(uint32 threadId)
 {
+	if(!m_readyQueue.IsLinked(threadId)) return;
 	THREAD* thread = m_threads[threadId];
-	uint32* nextThreadId = &ThreadLinkHead();
-	while(1)
+	uint32 prevThreadId = m_readyQueue.Unlink(threadId);
+	if(prevThreadId == Iop::CThreadReadyQueue::INVALID_THREAD_ID)
+	{
+		ThreadLinkHead() = thread->nextThreadId;
+	}
+	else
+	{
+		m_threads[prevThreadId]->nextThreadId = thread->nextThreadId;
+	}
+	thread->nextThreadId = 0;
+}
+
+void CIopBios::ResetThreadQueues()
+{
+	m_readyQueue.Reset();
+	m_vblankStartWaitList.Reset();
+	m_vblankEndWaitList.Reset();
+	for(auto& waitList : m_semaphoreWaitLists)
 	{
-		if((*nextThreadId) == 0)
+		waitList.Reset();
+	}
+	for(auto& waitList : m_eventFlagWaitLists)
+	{
+		waitList.Reset();
+	}
+}
+
+void CIopBios::RebuildThreadQueues()
+{
+	ResetThreadQueues();
+
+	//Relink threads in the order they were in, this also fixes the list if it was
+	//not properly ordered by priority
+	std::vector<uint32> linkedThreadIds;
+	uint32 nextThreadId = ThreadLinkHead();
+	while((nextThreadId != 0) && (linkedThreadIds.size() < MAX_THREAD))
+	{
+		auto thread = m_threads[nextThreadId];
+		if(!thread || (std::find(linkedThreadIds.begin(), linkedThreadIds.end(), nextThreadId) != linkedThreadIds.end()))
 		{
 			break;
 		}
-		THREAD* currentThread = m_threads[(*nextThreadId)];
-		if((*nextThreadId) == threadId)
+		linkedThreadIds.push_back(nextThreadId);
+		nextThreadId = thread->nextThreadId;
+	}
+
+	ThreadLinkHead() = 0;
+	for(auto threadId : linkedThreadIds)
+	{
+		LinkThread(threadId);
+	}
+
+	for(auto thread : m_threads)
+	{
+		if(!thread) continue;
+		switch(thread->status)
 		{
-			(*nextThreadId) = thread->nextThreadId;
-			thread->nextThreadId = 0;
+		case THREAD_STATUS_WAIT_VBLANK_START:
+			m_vblankStartWaitList.Set(thread->id);
+			break;
+		case THREAD_STATUS_WAIT_VBLANK_END:
+			m_vblankEndWaitList.Set(thread->id);
+			break;
+		case THREAD_STATUS_WAITING_EVENTFLAG:
+			if(thread->waitEventFlag < m_eventFlagWaitLists.size())
+			{
+				m_eventFlagWaitLists[thread->waitEventFlag].Set(thread->id);
+			}
+			break;
+		default:
 			break;
 		}
-		nextThreadId = &currentThread->nextThreadId;
+		if((thread->waitSemaphore != 0) && (thread->waitSemaphore < m_semaphoreWaitLists.size()))
+		{
+			m_semaphoreWaitLists[thread->waitSemaphore].Set(thread->id);
+		}
 	}
 }
 
@@ -1649,16 +1721,13 @@ void CIopBios::Reschedule()
 
 uint32 CIopBios::GetNextReadyThread()
 {
-	uint32 nextThreadId = ThreadLinkHead();
-	while(nextThreadId != 0)
+	uint32 nextThreadId = m_readyQueue.FindNextReady(GetCurrentTime());
+	if(nextThreadId == Iop::CThreadReadyQueue::INVALID_THREAD_ID)
 	{
-		THREAD* nextThread = m_threads[nextThreadId];
-		nextThreadId = nextThread->nextThreadId;
-		if(GetCurrentTime() <= nextThread->nextActivateTime) continue;
-		assert(nextThread->status == THREAD_STATUS_RUNNING);
-		return nextThread->id;
+		return -1;
 	}
-	return -1;
+	assert(m_threads[nextThreadId]->status == THREAD_STATUS_RUNNING);
+	return nextThreadId;
 }
 
 uint64 CIopBios::GetCurrentTime() const
@@ -1684,12 +1753,23 @@ uint64 CIopBios::ClockToMicroSec(uint64 clock)
 void CIopBios::CountTicks(uint32 ticks)
 {
 	CurrentTime() += ticks;
+#ifdef _IOP_EMULATE_MODULES
+	//CDVD reads complete when the emulated drive is done with them
+	if(m_cdvdman->GetReadQueue().IsAnyReadDue(CurrentTime()))
+	{
+		m_cdvdfsv->ProcessCommands(m_sifMan.get());
+		m_cdvdman->ProcessCommands();
+	}
+#endif
 }
 
 void CIopBios::NotifyVBlankStart()
 {
-	for(auto thread : m_threads)
+	for(uint32 threadId = m_vblankStartWaitList.FindFirst(); threadId != Iop::ThreadWaitList::INVALID_ID;
+	    threadId = m_vblankStartWaitList.FindFirst(threadId + 1))
 	{
+		m_vblankStartWaitList.Clear(threadId);
+		auto thread = m_threads[threadId];
 		if(!thread) continue;
 		if(thread->status == THREAD_STATUS_WAIT_VBLANK_START)
 		{
@@ -1701,8 +1781,11 @@ void CIopBios::NotifyVBlankStart()
 
 void CIopBios::NotifyVBlankEnd()
 {
-	for(auto thread : m_threads)
+	for(uint32 threadId = m_vblankEndWaitList.FindFirst(); threadId != Iop::ThreadWaitList::INVALID_ID;
+	    threadId = m_vblankEndWaitList.FindFirst(threadId + 1))
 	{
+		m_vblankEndWaitList.Clear(threadId);
+		auto thread = m_threads[threadId];
 		if(!thread) continue;
 		if(thread->status == THREAD_STATUS_WAIT_VBLANK_END)
 		{
@@ -1830,6 +1913,7 @@ uint32 CIopBios::WaitSemaphore(uint32 semaphoreId)
 		thread->status = THREAD_STATUS_WAITING_SEMAPHORE;
 		thread->waitSemaphore = semaphoreId;
 		UnlinkThread(threadId);
+		m_semaphoreWaitLists[semaphoreId].Set(threadId);
 		semaphore->waitCount++;
 		m_rescheduleNeeded = true;
 	}
@@ -1890,8 +1974,12 @@ bool CIopBios::SemaReleaseSingleThread(uint32 semaphoreId, bool deleted)
 	assert(semaphore->waitCount != 0);
 
 	bool changed = false;
-	for(auto thread : m_threads)
+	auto& waitList = m_semaphoreWaitLists[semaphoreId];
+	for(uint32 threadId = waitList.FindFirst(); threadId != Iop::ThreadWaitList::INVALID_ID;
+	    threadId = waitList.FindFirst(threadId + 1))
 	{
+		waitList.Clear(threadId);
+		auto thread = m_threads[threadId];
 		if(!thread) continue;
 		if(thread->waitSemaphore == semaphoreId)
 		{
@@ -1971,26 +2059,30 @@ uint32 CIopBios::SetEventFlag(uint32 eventId, uint32 value, bool inInterrupt)
 	eventFlag->value |= value;
 
 	//Check all threads waiting for this event
-	for(auto thread : m_threads)
+	auto& waitList = m_eventFlagWaitLists[eventId];
+	for(uint32 threadId = waitList.FindFirst(); threadId != Iop::ThreadWaitList::INVALID_ID;
+	    threadId = waitList.FindFirst(threadId + 1))
 	{
-		if(!thread) continue;
-		if(thread->status != THREAD_STATUS_WAITING_EVENTFLAG) continue;
-		if(thread->waitEventFlag == eventId)
+		auto thread = m_threads[threadId];
+		if(!thread || (thread->status != THREAD_STATUS_WAITING_EVENTFLAG) || (thread->waitEventFlag != eventId))
 		{
-			bool success = ProcessEventFlag(thread->waitEventFlagMode, eventFlag->value, thread->waitEventFlagMask,
-			                                (thread->waitEventFlagResultPtr != 0) ? reinterpret_cast<uint32*>(m_ram + thread->waitEventFlagResultPtr) : nullptr);
-			if(success)
-			{
-				thread->waitEventFlag = 0;
-				thread->waitEventFlagResultPtr = 0;
+			waitList.Clear(threadId);
+			continue;
+		}
+		bool success = ProcessEventFlag(thread->waitEventFlagMode, eventFlag->value, thread->waitEventFlagMask,
+		                                (thread->waitEventFlagResultPtr != 0) ? reinterpret_cast<uint32*>(m_ram + thread->waitEventFlagResultPtr) : nullptr);
+		if(success)
+		{
+			waitList.Clear(threadId);
+			thread->waitEventFlag = 0;
+			thread->waitEventFlagResultPtr = 0;
 
-				thread->status = THREAD_STATUS_RUNNING;
-				LinkThread(thread->id);
+			thread->status = THREAD_STATUS_RUNNING;
+			LinkThread(thread->id);
 
-				if(!inInterrupt)
-				{
-					m_rescheduleNeeded = true;
-				}
+			if(!inInterrupt)
+			{
+				m_rescheduleNeeded = true;
 			}
 		}
 	}
@@ -2036,6 +2128,7 @@ uint32 CIopBios::WaitEventFlag(uint32 eventId, uint32 value, uint32 mode, uint32
 		auto thread = GetThread(m_currentThreadId);
 		thread->status = THREAD_STATUS_WAITING_EVENTFLAG;
 		UnlinkThread(thread->id);
+		m_eventFlagWaitLists[eventId].Set(thread->id);
 		thread->waitEventFlag = eventId;
 		thread->waitEventFlagMode = mode;
 		thread->waitEventFlagMask = value;
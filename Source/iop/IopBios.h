@@ -24,6 +24,7 @@
 #include "Iop_PadMan.h"
 #include "Iop_MtapMan.h"
 #include "Iop_Cdvdfsv.h"
+#include "Iop_ThreadQueues.h"
 #endif
 
 #ifdef _IOP_EMULATE_MODULES
@@ -549,6 +550,8 @@ private:
 
 	void LinkThread(uint32);
 	void UnlinkThread(uint32);
+	void ResetThreadQueues();
+	void RebuildThreadQueues();
 
 	uint32& ThreadLinkHead() const;
 	uint64& CurrentTime() const;
@@ -601,6 +604,11 @@ private:
 	bool m_rescheduleNeeded = false;
 	LoadedModuleList m_loadedModules;
 	ThreadList m_threads;
+	Iop::CThreadReadyQueue m_readyQueue;
+	Iop::ThreadWaitList m_vblankStartWaitList;
+	Iop::ThreadWaitList m_vblankEndWaitList;
+	std::array<Iop::ThreadWaitList, MAX_SEMAPHORE + 1> m_semaphoreWaitLists;
+	std::array<Iop::ThreadWaitList, MAX_EVENTFLAG + 1> m_eventFlagWaitLists;
 	MemoryBlockList m_memoryBlocks;
 	SemaphoreList m_semaphores;
 	EventFlagList m_eventFlags;
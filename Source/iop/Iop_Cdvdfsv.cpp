@@ -1,5 +1,6 @@
 #include <assert.h>
 #include "../Log.h"
+#include "../TraceLog.h"
 #include "../Ps2Const.h"
 #include "Iop_Cdvdfsv.h"
 #include "Iop_Cdvdman.h"
@@ -15,6 +16,7 @@ using namespace Iop;
 #define STATE_PENDINGREADSECTOR ("PendingReadSector")
 #define STATE_PENDINGREADCOUNT ("PendingReadCount")
 #define STATE_PENDINGREADADDR ("PendingReadAddr")
+#define STATE_PENDINGREADCOMPLETIONTIME ("PendingReadCompletionTime")
 
 #define STATE_STREAMING ("Streaming")
 #define STATE_STREAMPOS ("StreamPos")
@@ -62,7 +64,14 @@ void CCdvdfsv::ProcessCommands(CSifMan* sifMan)
 {
 	if(m_pendingCommand != COMMAND_NONE)
 	{
-		static const uint32 sectorSize = 0x800;
+		auto& readQueue = m_cdvdman.GetReadQueue();
+		if(
+		    (m_pendingReadRequestId != CCdvdReadQueue::INVALID_REQUEST_ID) &&
+		    !readQueue.IsReadComplete(m_pendingReadRequestId))
+		{
+			//Drive hasn't finished reading yet
+			return;
+		}
 
 		uint8* eeRam = nullptr;
 		if(auto sifManPs2 = dynamic_cast<CSifManPs2*>(sifMan))
@@ -70,40 +79,26 @@ void CCdvdfsv::ProcessCommands(CSifMan* sifMan)
 			eeRam = sifManPs2->GetEeRam();
 		}
 
-		if(m_pendingCommand == COMMAND_READ)
+		switch(m_pendingCommand)
 		{
-			if(m_opticalMedia != nullptr)
+		case COMMAND_READ:
+			readQueue.FinishRead(m_pendingReadRequestId, eeRam ? (eeRam + m_pendingReadAddr) : nullptr);
+			break;
+		case COMMAND_READIOP:
+			readQueue.FinishRead(m_pendingReadRequestId, m_iopRam + m_pendingReadAddr);
+			break;
+		case COMMAND_STREAM_READ:
+			//Streamed data comes from the prefetcher's buffer
+			if(eeRam)
 			{
-				auto fileSystem = m_opticalMedia->GetFileSystem();
-				for(unsigned int i = 0; i < m_pendingReadCount; i++)
-				{
-					fileSystem->ReadBlock(m_pendingReadSector + i, eeRam + (m_pendingReadAddr + (i * sectorSize)));
-				}
-			}
-		}
-		else if(m_pendingCommand == COMMAND_READIOP)
-		{
-			if(m_opticalMedia != nullptr)
-			{
-				auto fileSystem = m_opticalMedia->GetFileSystem();
-				for(unsigned int i = 0; i < m_pendingReadCount; i++)
-				{
-					fileSystem->ReadBlock(m_pendingReadSector + i, m_iopRam + (m_pendingReadAddr + (i * sectorSize)));
-				}
-			}
-		}
-		else if(m_pendingCommand == COMMAND_STREAM_READ)
-		{
-			if(m_opticalMedia != nullptr)
-			{
-				auto fileSystem = m_opticalMedia->GetFileSystem();
-				for(unsigned int i = 0; i < m_pendingReadCount; i++)
-				{
-					fileSystem->ReadBlock(m_streamPos, eeRam + (m_pendingReadAddr + (i * sectorSize)));
-					m_streamPos++;
-				}
+				m_cdvdman.GetStreamPrefetcher().Read(m_pendingReadSector, m_pendingReadCount, eeRam + m_pendingReadAddr);
 			}
+			break;
+		default:
+			assert(false);
+			break;
 		}
+		m_pendingReadRequestId = CCdvdReadQueue::INVALID_REQUEST_ID;
 
 		m_pendingCommand = COMMAND_NONE;
 		sifMan->SendCallReply(MODULE_ID_4, nullptr);
@@ -123,10 +118,30 @@ void CCdvdfsv::LoadState(Framework::CZipArchiveReader& archive)
 	m_pendingReadSector = registerFile.GetRegister32(STATE_PENDINGREADSECTOR);
 	m_pendingReadCount = registerFile.GetRegister32(STATE_PENDINGREADCOUNT);
 	m_pendingReadAddr = registerFile.GetRegister32(STATE_PENDINGREADADDR);
+	uint64 pendingReadCompletionTime = registerFile.GetRegister64(STATE_PENDINGREADCOMPLETIONTIME);
 
 	m_streaming = registerFile.GetRegister32(STATE_STREAMING) != 0;
 	m_streamPos = registerFile.GetRegister32(STATE_STREAMPOS);
 	m_streamBufferSize = registerFile.GetRegister32(STATE_STREAMBUFFERSIZE);
+
+	//Data of reads in flight is not saved, issue them again
+	m_pendingReadRequestId = CCdvdReadQueue::INVALID_REQUEST_ID;
+	if((m_pendingCommand == COMMAND_READ) || (m_pendingCommand == COMMAND_READIOP))
+	{
+		if(pendingReadCompletionTime != 0)
+		{
+			m_pendingReadRequestId = m_cdvdman.GetReadQueue().RestoreRead(m_pendingReadSector, m_pendingReadCount, pendingReadCompletionTime);
+		}
+		else
+		{
+			//Older states don't have the completion time, read is timed from now in that case
+			QueuePendingRead();
+		}
+	}
+	if(m_streaming)
+	{
+		m_cdvdman.GetStreamPrefetcher().Start(m_streamPos);
+	}
 }
 
 void CCdvdfsv::SaveState(Framework::CZipArchiveWriter& archive)
@@ -137,6 +152,10 @@ void CCdvdfsv::SaveState(Framework::CZipArchiveWriter& archive)
 	registerFile->SetRegister32(STATE_PENDINGREADSECTOR, m_pendingReadSector);
 	registerFile->SetRegister32(STATE_PENDINGREADCOUNT, m_pendingReadCount);
 	registerFile->SetRegister32(STATE_PENDINGREADADDR, m_pendingReadAddr);
+	if(m_pendingReadRequestId != CCdvdReadQueue::INVALID_REQUEST_ID)
+	{
+		registerFile->SetRegister64(STATE_PENDINGREADCOMPLETIONTIME, m_cdvdman.GetReadQueue().GetCompletionTime(m_pendingReadRequestId));
+	}
 
 	registerFile->SetRegister32(STATE_STREAMING, m_streaming);
 	registerFile->SetRegister32(STATE_STREAMPOS, m_streamPos);
@@ -145,6 +164,13 @@ void CCdvdfsv::SaveState(Framework::CZipArchiveWriter& archive)
 	archive.InsertFile(registerFile);
 }
 
+void CCdvdfsv::QueuePendingRead()
+{
+	assert(m_pendingCommand != COMMAND_NONE);
+	assert(m_pendingReadRequestId == CCdvdReadQueue::INVALID_REQUEST_ID);
+	m_pendingReadRequestId = m_cdvdman.GetReadQueue().QueueRead(m_pendingReadSector, m_pendingReadCount);
+}
+
 void CCdvdfsv::Invoke(CMIPS& context, unsigned int functionId)
 {
 	throw std::runtime_error("Not implemented.");
@@ -164,7 +190,7 @@ bool CCdvdfsv::Invoke592(uint32 method, uint32* args, uint32 argsSize, uint32* r
 			assert(retSize >= 0x10);
 			ret[0x03] = 0xFF;
 		}
-		CLog::GetInstance().Print(LOG_NAME, "Init(mode = %d);\r\n", mode);
+		TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, "Init(mode = %d);", mode);
 	}
 	break;
 	default:
@@ -181,7 +207,7 @@ bool CCdvdfsv::Invoke593(uint32 method, uint32* args, uint32 argsSize, uint32* r
 	case 0x01:
 	{
 		assert(retSize >= 0xC);
-		CLog::GetInstance().Print(LOG_NAME, "ReadClock();\r\n");
+		TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, "ReadClock();");
 
 		auto clockBuffer = reinterpret_cast<uint8*>(ret + 1);
 		(*ret) = m_cdvdman.CdReadClockDirect(clockBuffer);
@@ -190,14 +216,14 @@ bool CCdvdfsv::Invoke593(uint32 method, uint32* args, uint32 argsSize, uint32* r
 
 	case 0x03:
 		assert(retSize >= 4);
-		CLog::GetInstance().Print(LOG_NAME, "GetDiskType();\r\n");
+		TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, "GetDiskType();");
 		ret[0x00] = m_cdvdman.CdGetDiskTypeDirect(m_opticalMedia);
 		break;
 
 	case 0x04:
 		assert(retSize >= 4);
-		CLog::GetInstance().Print(LOG_NAME, "GetError();\r\n");
-		ret[0x00] = 0x00;
+		TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, "GetError();");
+		ret[0x00] = m_cdvdman.GetReadQueue().GetLastError();
 		break;
 
 	case 0x05:
@@ -205,7 +231,7 @@ bool CCdvdfsv::Invoke593(uint32 method, uint32* args, uint32 argsSize, uint32* r
 		assert(argsSize >= 4);
 		assert(retSize >= 8);
 		uint32 mode = args[0x00];
-		CLog::GetInstance().Print(LOG_NAME, "TrayReq(mode = %d);\r\n", mode);
+		TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, "TrayReq(mode = %d);", mode);
 		ret[0x00] = 0x01; //Result
 		ret[0x01] = 0x00; //Tray check
 	}
@@ -214,14 +240,14 @@ bool CCdvdfsv::Invoke593(uint32 method, uint32* args, uint32 argsSize, uint32* r
 	case 0x0C:
 		//Status
 		assert(retSize >= 4);
-		CLog::GetInstance().Print(LOG_NAME, "Status();\r\n");
+		TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, "Status();");
 		ret[0x00] = m_streaming ? CCdvdman::CDVD_STATUS_SEEK : CCdvdman::CDVD_STATUS_PAUSED;
 		break;
 
 	case 0x16:
 		//Break
 		{
-			CLog::GetInstance().Print(LOG_NAME, "Break();\r\n");
+			TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, "Break();");
 			ret[0x00] = 1;
 		}
 		break;
@@ -232,7 +258,7 @@ bool CCdvdfsv::Invoke593(uint32 method, uint32* args, uint32 argsSize, uint32* r
 		assert(argsSize >= 4);
 		assert(retSize >= 4);
 		uint32 mode = args[0x00];
-		CLog::GetInstance().Print(LOG_NAME, "SetMediaMode(mode = %i);\r\n", mode);
+		TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, "SetMediaMode(mode = %i);", mode);
 		ret[0x00] = 1;
 	}
 	break;
@@ -240,7 +266,7 @@ bool CCdvdfsv::Invoke593(uint32 method, uint32* args, uint32 argsSize, uint32* r
 	{
 		//ReadDvdDualInfo
 		assert(retSize >= 8);
-		CLog::GetInstance().Print(LOG_NAME, "ReadDvdDualInfo();\r\n");
+		TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, "ReadDvdDualInfo();");
 		ret[0] = 1;
 		ret[1] = (m_opticalMedia && m_opticalMedia->GetDvdIsDualLayer()) ? 1 : 0;
 	}
@@ -268,7 +294,7 @@ bool CCdvdfsv::Invoke595(uint32 method, uint32* args, uint32 argsSize, uint32* r
 		assert(argsSize >= 4);
 		assert(retSize >= 4);
 		uint32 nBuffer = args[0x00];
-		CLog::GetInstance().Print(LOG_NAME, "GetToc(buffer = 0x%08X);\r\n", nBuffer);
+		TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, "GetToc(buffer = 0x%08X);", nBuffer);
 		ret[0x00] = 1;
 	}
 	break;
@@ -277,7 +303,7 @@ bool CCdvdfsv::Invoke595(uint32 method, uint32* args, uint32 argsSize, uint32* r
 	{
 		assert(argsSize >= 4);
 		uint32 seekSector = args[0];
-		CLog::GetInstance().Print(LOG_NAME, "Seek(sector = 0x%08X);\r\n", seekSector);
+		TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, "Seek(sector = 0x%08X);", seekSector);
 	}
 	break;
 
@@ -293,7 +319,7 @@ bool CCdvdfsv::Invoke595(uint32 method, uint32* args, uint32 argsSize, uint32* r
 	case 0x0E:
 		//DiskReady (returns 2 if ready, 6 if not ready)
 		assert(retSize >= 4);
-		CLog::GetInstance().Print(LOG_NAME, "NDiskReady();\r\n");
+		TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, "NDiskReady();");
 		if(m_pendingCommand != COMMAND_NONE)
 		{
 			ret[0x00] = 6;
@@ -351,7 +377,7 @@ bool CCdvdfsv::Invoke59C(uint32 method, uint32* args, uint32 argsSize, uint32* r
 		assert(retSize >= 4);
 		assert(argsSize >= 4);
 		uint32 mode = args[0x00];
-		CLog::GetInstance().Print(LOG_NAME, "DiskReady(mode = %i);\r\n", mode);
+		TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, "DiskReady(mode = %i);", mode);
 		ret[0x00] = 2;
 	}
 	break;
@@ -369,8 +395,8 @@ void CCdvdfsv::Read(uint32* args, uint32 argsSize, uint32* ret, uint32 retSize,
 	uint32 dstAddr = args[0x02];
 	uint32 mode = args[0x03];
 
-	CLog::GetInstance().Print(LOG_NAME, "Read(sector = 0x%08X, count = 0x%08X, addr = 0x%08X, mode = 0x%08X);\r\n",
-	                          sector, count, dstAddr, mode);
+	TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, "Read(sector = 0x%08X, count = 0x%08X, addr = 0x%08X, mode = 0x%08X);",
+	            sector, count, dstAddr, mode);
 
 	//We write the result now, but ideally should be only written
 	//when pending read is completed
@@ -384,6 +410,7 @@ void CCdvdfsv::Read(uint32* args, uint32 argsSize, uint32* ret, uint32 retSize,
 	m_pendingReadSector = sector;
 	m_pendingReadCount = count;
 	m_pendingReadAddr = dstAddr & 0x1FFFFFFF;
+	QueuePendingRead();
 }
 
 void CCdvdfsv::ReadIopMem(uint32* args, uint32 argsSize, uint32* ret, uint32 retSize, uint8* ram)
@@ -393,8 +420,8 @@ void CCdvdfsv::ReadIopMem(uint32* args, uint32 argsSize, uint32* ret, uint32 ret
 	uint32 dstAddr = args[0x02];
 	uint32 mode = args[0x03];
 
-	CLog::GetInstance().Print(LOG_NAME, "ReadIopMem(sector = 0x%08X, count = 0x%08X, addr = 0x%08X, mode = 0x%08X);\r\n",
-	                          sector, count, dstAddr, mode);
+	TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, "ReadIopMem(sector = 0x%08X, count = 0x%08X, addr = 0x%08X, mode = 0x%08X);",
+	            sector, count, dstAddr, mode);
 
 	if(retSize >= 4)
 	{
@@ -406,6 +433,7 @@ void CCdvdfsv::ReadIopMem(uint32* args, uint32 argsSize, uint32* ret, uint32 ret
 	m_pendingReadSector = sector;
 	m_pendingReadCount = count;
 	m_pendingReadAddr = dstAddr & 0x1FFFFFFF;
+	QueuePendingRead();
 }
 
 bool CCdvdfsv::StreamCmd(uint32* args, uint32 argsSize, uint32* ret, uint32 retSize, uint8* ram)
@@ -418,8 +446,8 @@ bool CCdvdfsv::StreamCmd(uint32* args, uint32 argsSize, uint32* ret, uint32 retS
 	uint32 cmd = args[0x03];
 	uint32 mode = args[0x04];
 
-	CLog::GetInstance().Print(LOG_NAME, "StreamCmd(sector = 0x%08X, count = 0x%08X, addr = 0x%08X, cmd = 0x%08X, mode = 0x%08X);\r\n",
-	                          sector, count, dstAddr, cmd, mode);
+	TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, "StreamCmd(sector = 0x%08X, count = 0x%08X, addr = 0x%08X, cmd = 0x%08X, mode = 0x%08X);",
+	            sector, count, dstAddr, cmd, mode);
 
 	assert(m_pendingCommand == COMMAND_NONE);
 
@@ -429,44 +457,49 @@ bool CCdvdfsv::StreamCmd(uint32* args, uint32 argsSize, uint32* ret, uint32 retS
 		//Start
 		m_streamPos = sector;
 		ret[0] = 1;
-		CLog::GetInstance().Print(LOG_NAME, "StreamStart(pos = 0x%08X);\r\n", sector);
+		TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, "StreamStart(pos = 0x%08X);", sector);
 		m_streaming = true;
+		m_cdvdman.GetStreamPrefetcher().Start(sector);
 		break;
 	case 2:
 		//Read
 		m_pendingCommand = COMMAND_STREAM_READ;
-		m_pendingReadSector = 0;
+		m_pendingReadSector = m_streamPos;
 		m_pendingReadCount = count;
 		m_pendingReadAddr = dstAddr & (PS2::EE_RAM_SIZE - 1);
+		m_streamPos += count;
 		ret[0] = count;
 		immediateReply = false;
-		CLog::GetInstance().Print(LOG_NAME, "StreamRead(count = 0x%08X, dest = 0x%08X);\r\n",
-		                          count, dstAddr);
+		TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, "StreamRead(count = 0x%08X, dest = 0x%08X);",
+		            count, dstAddr);
 		break;
 	case 3:
 		//Stop
 		ret[0] = 1;
-		CLog::GetInstance().Print(LOG_NAME, "StreamStop();\r\n");
+		TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, "StreamStop();");
 		m_streaming = false;
+		m_cdvdman.GetStreamPrefetcher().Stop();
 		break;
 	case 5:
 		//Init
 		ret[0] = 1;
-		CLog::GetInstance().Print(LOG_NAME, "StreamInit(bufsize = 0x%08X, numbuf = 0x%08X, buf = 0x%08X);\r\n",
-		                          sector, count, dstAddr);
+		TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, "StreamInit(bufsize = 0x%08X, numbuf = 0x%08X, buf = 0x%08X);",
+		            sector, count, dstAddr);
 		m_streamBufferSize = sector;
+		m_cdvdman.GetStreamPrefetcher().SetDepth(sector);
 		break;
 	case 6:
 		//Status
 		ret[0] = m_streamBufferSize;
-		CLog::GetInstance().Print(LOG_NAME, "StreamStat();\r\n");
+		TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, "StreamStat();");
 		break;
 	case 4:
 	case 9:
 		//Seek
 		m_streamPos = sector;
 		ret[0] = 1;
-		CLog::GetInstance().Print(LOG_NAME, "StreamSeek(pos = 0x%08X);\r\n", sector);
+		TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, "StreamSeek(pos = 0x%08X);", sector);
+		m_cdvdman.GetStreamPrefetcher().Start(sector);
 		break;
 	default:
 		CLog::GetInstance().Warn(LOG_NAME, "Unknown stream command used.\r\n");
@@ -4,6 +4,7 @@
 #include "Iop_SifMan.h"
 #include "../SifModuleAdapter.h"
 #include "../OpticalMedia.h"
+#include "CdvdReadQueue.h"
 #include "zip/ZipArchiveWriter.h"
 #include "zip/ZipArchiveReader.h"
 
@@ -56,6 +57,8 @@ namespace Iop
 		bool Invoke59A(uint32, uint32*, uint32, uint32*, uint32, uint8*);
 		bool Invoke59C(uint32, uint32*, uint32, uint32*, uint32, uint8*);
 
+		void QueuePendingRead();
+
 		//Methods
 		void Read(uint32*, uint32, uint32*, uint32, uint8*);
 		void ReadIopMem(uint32*, uint32, uint32*, uint32, uint8*);
@@ -70,6 +73,7 @@ namespace Iop
 		uint32 m_pendingReadSector = 0;
 		uint32 m_pendingReadCount = 0;
 		uint32 m_pendingReadAddr = 0;
+		CCdvdReadQueue::RequestId m_pendingReadRequestId = CCdvdReadQueue::INVALID_REQUEST_ID;
 
 		bool m_streaming = false;
 		uint32 m_streamPos = 0;
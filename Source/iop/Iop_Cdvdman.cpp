@@ -1,5 +1,7 @@
+#include <algorithm>
 #include <cstring>
 #include "../Log.h"
+#include "../TraceLog.h"
 #include "../states/RegisterStateFile.h"
 #include "IopBios.h"
 #include "Iop_Cdvdman.h"
@@ -10,6 +12,10 @@
 #define STATE_CALLBACK_ADDRESS ("CallbackAddress")
 #define STATE_STATUS ("Status")
 #define STATE_PENDING_COMMAND ("PendingCommand")
+#define STATE_PENDING_READ_SECTOR ("PendingReadSector")
+#define STATE_PENDING_READ_COUNT ("PendingReadCount")
+#define STATE_PENDING_READ_BUFFER ("PendingReadBuffer")
+#define STATE_PENDING_READ_COMPLETION_TIME ("PendingReadCompletionTime")
 
 #define FUNCTION_CDINIT "CdInit"
 #define FUNCTION_CDREAD "CdRead"
@@ -37,6 +43,7 @@ using namespace Iop;
 
 CCdvdman::CCdvdman(CIopBios& bios, uint8* ram)
     : m_bios(bios)
+    , m_readQueue(bios)
     , m_ram(ram)
 {
 }
@@ -47,6 +54,23 @@ void CCdvdman::LoadState(Framework::CZipArchiveReader& archive)
 	m_callbackPtr = registerFile.GetRegister32(STATE_CALLBACK_ADDRESS);
 	m_status = registerFile.GetRegister32(STATE_STATUS);
 	m_pendingCommand = static_cast<COMMAND>(registerFile.GetRegister32(STATE_PENDING_COMMAND));
+	m_pendingReadSector = registerFile.GetRegister32(STATE_PENDING_READ_SECTOR);
+	m_pendingReadCount = registerFile.GetRegister32(STATE_PENDING_READ_COUNT);
+	m_pendingReadBufferPtr = registerFile.GetRegister32(STATE_PENDING_READ_BUFFER);
+	uint64 pendingReadCompletionTime = registerFile.GetRegister64(STATE_PENDING_READ_COMPLETION_TIME);
+
+	m_readQueue.Reset();
+	m_readQueue.LoadState(registerFile);
+
+	//Data of reads in flight is not saved, issue them again
+	m_pendingReadRequestId = CCdvdReadQueue::INVALID_REQUEST_ID;
+	if((m_pendingCommand == COMMAND_READ) && (m_pendingReadBufferPtr != 0))
+	{
+		//Older states don't have the completion time, read is timed from now in that case
+		m_pendingReadRequestId = (pendingReadCompletionTime != 0)
+		                             ? m_readQueue.RestoreRead(m_pendingReadSector, m_pendingReadCount, pendingReadCompletionTime)
+		                             : m_readQueue.QueueRead(m_pendingReadSector, m_pendingReadCount);
+	}
 }
 
 void CCdvdman::SaveState(Framework::CZipArchiveWriter& archive)
@@ -55,6 +79,11 @@ void CCdvdman::SaveState(Framework::CZipArchiveWriter& archive)
 	registerFile->SetRegister32(STATE_CALLBACK_ADDRESS, m_callbackPtr);
 	registerFile->SetRegister32(STATE_STATUS, m_status);
 	registerFile->SetRegister32(STATE_PENDING_COMMAND, m_pendingCommand);
+	registerFile->SetRegister32(STATE_PENDING_READ_SECTOR, m_pendingReadSector);
+	registerFile->SetRegister32(STATE_PENDING_READ_COUNT, m_pendingReadCount);
+	registerFile->SetRegister32(STATE_PENDING_READ_BUFFER, m_pendingReadBufferPtr);
+	registerFile->SetRegister64(STATE_PENDING_READ_COMPLETION_TIME, GetPendingReadCompletionTime());
+	m_readQueue.SaveState(*registerFile);
 	archive.InsertFile(registerFile);
 }
 
@@ -98,6 +127,22 @@ uint32 CCdvdman::CdGetDiskTypeDirect(COpticalMedia* opticalMedia)
 	}
 }
 
+CCdvdReadQueue& CCdvdman::GetReadQueue()
+{
+	return m_readQueue;
+}
+
+uint64 CCdvdman::GetPendingReadCompletionTime()
+{
+	if(m_pendingReadRequestId == CCdvdReadQueue::INVALID_REQUEST_ID) return 0;
+	return m_readQueue.GetCompletionTime(m_pendingReadRequestId);
+}
+
+CCdvdStreamPrefetcher& CCdvdman::GetStreamPrefetcher()
+{
+	return m_streamPrefetcher;
+}
+
 std::string CCdvdman::GetId() const
 {
 	return "cdvdman";
@@ -275,12 +320,33 @@ void CCdvdman::Invoke(CMIPS& ctx, unsigned int functionId)
 }
 
 void CCdvdman::ProcessCommands()
+{
+	if(m_pendingCommand != COMMAND_NONE)
+	{
+		if(
+		    (m_pendingCommand == COMMAND_READ) &&
+		    (m_pendingReadRequestId != CCdvdReadQueue::INVALID_REQUEST_ID) &&
+		    !m_readQueue.IsReadComplete(m_pendingReadRequestId))
+		{
+			//Drive hasn't finished reading yet
+			return;
+		}
+		CompletePendingCommand();
+	}
+}
+
+void CCdvdman::CompletePendingCommand()
 {
 	if(m_pendingCommand != COMMAND_NONE)
 	{
 		switch(m_pendingCommand)
 		{
 		case COMMAND_READ:
+			if(m_pendingReadRequestId != CCdvdReadQueue::INVALID_REQUEST_ID)
+			{
+				m_readQueue.FinishRead(m_pendingReadRequestId, m_ram + m_pendingReadBufferPtr);
+				m_pendingReadRequestId = CCdvdReadQueue::INVALID_REQUEST_ID;
+			}
 			if(m_callbackPtr != 0)
 			{
 				m_bios.TriggerCallback(m_callbackPtr, CDVD_FUNCTION_READ);
@@ -303,11 +369,13 @@ void CCdvdman::ProcessCommands()
 void CCdvdman::SetOpticalMedia(COpticalMedia* opticalMedia)
 {
 	m_opticalMedia = opticalMedia;
+	m_readQueue.SetOpticalMedia(opticalMedia);
+	m_streamPrefetcher.SetOpticalMedia(opticalMedia);
 }
 
 uint32 CCdvdman::CdInit(uint32 mode)
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_CDINIT "(mode = %d);\r\n", mode);
+	TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, FUNCTION_CDINIT "(mode = %d);", mode);
 	//Mode
 	//0 - Initialize
 	//1 - Init & No Check
@@ -317,35 +385,32 @@ uint32 CCdvdman::CdInit(uint32 mode)
 
 uint32 CCdvdman::CdRead(uint32 startSector, uint32 sectorCount, uint32 bufferPtr, uint32 modePtr)
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_CDREAD "(startSector = 0x%X, sectorCount = 0x%X, bufferPtr = 0x%08X, modePtr = 0x%08X);\r\n",
-	                          startSector, sectorCount, bufferPtr, modePtr);
+	TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, FUNCTION_CDREAD "(startSector = 0x%X, sectorCount = 0x%X, bufferPtr = 0x%08X, modePtr = 0x%08X);",
+	            startSector, sectorCount, bufferPtr, modePtr);
 	if(modePtr != 0)
 	{
 		uint8* mode = &m_ram[modePtr];
 		//Does that make sure it's 2048 byte mode?
 		assert(mode[2] == 0);
 	}
+	assert(m_pendingCommand == COMMAND_NONE);
+	m_pendingCommand = COMMAND_READ;
+	m_pendingReadSector = startSector;
+	m_pendingReadCount = sectorCount;
+	m_pendingReadBufferPtr = bufferPtr;
 	if(m_opticalMedia && (bufferPtr != 0))
 	{
-		uint8* buffer = &m_ram[bufferPtr];
-		static const uint32 sectorSize = 2048;
-		auto fileSystem = m_opticalMedia->GetFileSystem();
-		for(unsigned int i = 0; i < sectorCount; i++)
-		{
-			fileSystem->ReadBlock(startSector + i, buffer);
-			buffer += sectorSize;
-		}
+		//Data will be copied to the buffer when the read completes
+		m_pendingReadRequestId = m_readQueue.QueueRead(startSector, sectorCount);
 	}
-	assert(m_pendingCommand == COMMAND_NONE);
-	m_pendingCommand = COMMAND_READ;
 	m_status = CDVD_STATUS_READING;
 	return 1;
 }
 
 uint32 CCdvdman::CdSeek(uint32 sector)
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_CDSEEK "(sector = 0x%X);\r\n",
-	                          sector);
+	TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, FUNCTION_CDSEEK "(sector = 0x%X);",
+	            sector);
 	assert(m_pendingCommand == COMMAND_NONE);
 	m_pendingCommand = COMMAND_SEEK;
 	return 1;
@@ -353,8 +418,8 @@ uint32 CCdvdman::CdSeek(uint32 sector)
 
 uint32 CCdvdman::CdGetError()
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_CDGETERROR "();\r\n");
-	return 0;
+	TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, FUNCTION_CDGETERROR "();");
+	return m_readQueue.GetLastError();
 }
 
 uint32 CCdvdman::CdSearchFile(uint32 fileInfoPtr, uint32 namePtr)
@@ -417,41 +482,54 @@ uint32 CCdvdman::CdSearchFile(uint32 fileInfoPtr, uint32 namePtr)
 
 uint32 CCdvdman::CdSync(uint32 mode)
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_CDSYNC "(mode = %i);\r\n",
-	                          mode);
+	TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, FUNCTION_CDSYNC "(mode = %i);",
+	            mode);
 	assert(
 	    (mode == 0x00) || (mode == 0x01) ||
 	    (mode == 0x10) || (mode == 0x11));
-	if((mode == 0x00) || (mode == 0x10))
+	bool blocking = (mode == 0x00) || (mode == 0x10);
+	if(blocking)
 	{
-		ProcessCommands();
-		assert(m_pendingCommand == COMMAND_NONE);
+		//The calling thread waits until the drive is done with the read,
+		//ProcessCommands will complete it before the thread runs again.
+		uint64 completionTime = GetPendingReadCompletionTime();
+		uint64 currentTime = m_bios.GetCurrentTime();
+		if(completionTime > currentTime)
+		{
+			uint64 delay = std::min<uint64>(completionTime - currentTime, UINT32_MAX);
+			m_bios.DelayThreadTicks(static_cast<uint32>(delay));
+		}
+		else
+		{
+			CompletePendingCommand();
+			assert(m_pendingCommand == COMMAND_NONE);
+		}
 	}
 	if(m_status == CDVD_STATUS_READING)
 	{
 		m_status = CDVD_STATUS_PAUSED;
 	}
-	return (m_pendingCommand == COMMAND_NONE) ? 0 : 1;
+	return (blocking || (m_pendingCommand == COMMAND_NONE)) ? 0 : 1;
 }
 
 uint32 CCdvdman::CdGetDiskType()
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_CDGETDISKTYPE "();\r\n");
+	TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, FUNCTION_CDGETDISKTYPE "();");
 	return CdGetDiskTypeDirect(m_opticalMedia);
 }
 
 uint32 CCdvdman::CdDiskReady(uint32 mode)
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_CDDISKREADY "(mode = %i);\r\n",
-	                          mode);
+	TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, FUNCTION_CDDISKREADY "(mode = %i);",
+	            mode);
 	m_status = CDVD_STATUS_PAUSED;
 	return 2;
 }
 
 uint32 CCdvdman::CdTrayReq(uint32 mode, uint32 trayCntPtr)
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_CDTRAYREQ "(mode = %d, trayCntPtr = 0x%08X);\r\n",
-	                          mode, trayCntPtr);
+	TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, FUNCTION_CDTRAYREQ "(mode = %d, trayCntPtr = 0x%08X);",
+	            mode, trayCntPtr);
 
 	auto trayCnt = reinterpret_cast<uint32*>(m_ram + trayCntPtr);
 	(*trayCnt) = 0;
@@ -461,8 +539,8 @@ uint32 CCdvdman::CdTrayReq(uint32 mode, uint32 trayCntPtr)
 
 uint32 CCdvdman::CdReadClock(uint32 clockPtr)
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_CDREADCLOCK "(clockPtr = 0x%08X);\r\n",
-	                          clockPtr);
+	TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, FUNCTION_CDREADCLOCK "(clockPtr = 0x%08X);",
+	            clockPtr);
 
 	auto clockBuffer = m_ram + clockPtr;
 	return CdReadClockDirect(clockBuffer);
@@ -470,14 +548,14 @@ uint32 CCdvdman::CdReadClock(uint32 clockPtr)
 
 uint32 CCdvdman::CdStatus()
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_CDSTATUS "();\r\n");
+	TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, FUNCTION_CDSTATUS "();");
 	return m_status;
 }
 
 uint32 CCdvdman::CdCallback(uint32 callbackPtr)
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_CDCALLBACK "(callbackPtr = 0x%08X);\r\n",
-	                          callbackPtr);
+	TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, FUNCTION_CDCALLBACK "(callbackPtr = 0x%08X);",
+	            callbackPtr);
 
 	uint32 oldCallbackPtr = m_callbackPtr;
 	m_callbackPtr = callbackPtr;
@@ -486,23 +564,20 @@ uint32 CCdvdman::CdCallback(uint32 callbackPtr)
 
 uint32 CCdvdman::CdStInit(uint32 bufMax, uint32 bankMax, uint32 bufPtr)
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_CDSTINIT "(bufMax = %d, bankMax = %d, bufPtr = 0x%08X);\r\n",
-	                          bufMax, bankMax, bufPtr);
+	TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, FUNCTION_CDSTINIT "(bufMax = %d, bankMax = %d, bufPtr = 0x%08X);",
+	            bufMax, bankMax, bufPtr);
 	m_streamPos = 0;
 	m_streamBufferSize = bufMax;
+	m_streamPrefetcher.SetDepth(bufMax);
 	return 1;
 }
 
 uint32 CCdvdman::CdStRead(uint32 sectors, uint32 bufPtr, uint32 mode, uint32 errPtr)
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_CDSTREAD "(sectors = %d, bufPtr = 0x%08X, mode = %d, errPtr = 0x%08X);\r\n",
-	                          sectors, bufPtr, mode, errPtr);
-	auto fileSystem = m_opticalMedia->GetFileSystem();
-	for(unsigned int i = 0; i < sectors; i++)
-	{
-		fileSystem->ReadBlock(m_streamPos, m_ram + (bufPtr + (i * 0x800)));
-		m_streamPos++;
-	}
+	TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, FUNCTION_CDSTREAD "(sectors = %d, bufPtr = 0x%08X, mode = %d, errPtr = 0x%08X);",
+	            sectors, bufPtr, mode, errPtr);
+	m_streamPrefetcher.Read(m_streamPos, sectors, m_ram + bufPtr);
+	m_streamPos += sectors;
 	if(errPtr != 0)
 	{
 		auto err = reinterpret_cast<uint32*>(m_ram + errPtr);
@@ -513,42 +588,45 @@ uint32 CCdvdman::CdStRead(uint32 sectors, uint32 bufPtr, uint32 mode, uint32 err
 
 uint32 CCdvdman::CdStStart(uint32 sector, uint32 modePtr)
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_CDSTSTART "(sector = %d, modePtr = 0x%08X);\r\n",
-	                          sector, modePtr);
+	TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, FUNCTION_CDSTSTART "(sector = %d, modePtr = 0x%08X);",
+	            sector, modePtr);
 	m_streamPos = sector;
+	m_streamPrefetcher.Start(sector);
 	return 1;
 }
 
 uint32 CCdvdman::CdStStat()
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_CDSTSTAT "();\r\n");
+	TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, FUNCTION_CDSTSTAT "();");
 	return m_streamBufferSize;
 }
 
 uint32 CCdvdman::CdStStop()
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_CDSTSTOP "();\r\n");
+	TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, FUNCTION_CDSTSTOP "();");
+	m_streamPrefetcher.Stop();
 	return 1;
 }
 
 uint32 CCdvdman::CdSetMmode(uint32 mode)
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_CDSETMMODE "(mode = %d);\r\n", mode);
+	TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, FUNCTION_CDSETMMODE "(mode = %d);", mode);
 	return 1;
 }
 
 uint32 CCdvdman::CdStSeekF(uint32 sector)
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_CDSTSEEKF "(sector = %d);\r\n",
-	                          sector);
+	TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, FUNCTION_CDSTSEEKF "(sector = %d);",
+	            sector);
 	m_streamPos = sector;
+	m_streamPrefetcher.Start(sector);
 	return 1;
 }
 
 uint32 CCdvdman::CdReadDvdDualInfo(uint32 onDualPtr, uint32 layer1StartPtr)
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_CDREADDVDDUALINFO "(onDualPtr = 0x%08X, layer1StartPtr = 0x%08X);\r\n",
-	                          onDualPtr, layer1StartPtr);
+	TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, FUNCTION_CDREADDVDDUALINFO "(onDualPtr = 0x%08X, layer1StartPtr = 0x%08X);",
+	            onDualPtr, layer1StartPtr);
 
 	auto onDual = reinterpret_cast<uint32*>(m_ram + onDualPtr);
 	auto layer1Start = reinterpret_cast<uint32*>(m_ram + layer1StartPtr);
@@ -560,8 +638,8 @@ uint32 CCdvdman::CdReadDvdDualInfo(uint32 onDualPtr, uint32 layer1StartPtr)
 
 uint32 CCdvdman::CdLayerSearchFile(uint32 fileInfoPtr, uint32 namePtr, uint32 layer)
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_CDLAYERSEARCHFILE "(fileInfoPtr = 0x%08X, namePtr = 0x%08X, layer = %d);\r\n",
-	                          fileInfoPtr, namePtr, layer);
+	TRACE_EVENT(TRACE_SUBSYSTEM_CDVD, FUNCTION_CDLAYERSEARCHFILE "(fileInfoPtr = 0x%08X, namePtr = 0x%08X, layer = %d);",
+	            fileInfoPtr, namePtr, layer);
 	assert(layer == 0);
 	return CdSearchFile(fileInfoPtr, namePtr);
 }
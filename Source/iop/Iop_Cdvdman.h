@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Iop_Module.h"
+#include "CdvdReadQueue.h"
+#include "CdvdStreamPrefetcher.h"
 #include "../OpticalMedia.h"
 #include "zip/ZipArchiveWriter.h"
 #include "zip/ZipArchiveReader.h"
@@ -43,6 +45,11 @@ namespace Iop
 		uint32 CdReadClockDirect(uint8*);
 		uint32 CdGetDiskTypeDirect(COpticalMedia*);
 
+		CCdvdReadQueue& GetReadQueue();
+		CCdvdStreamPrefetcher& GetStreamPrefetcher();
+		//Returns 0 if no read is in flight
+		uint64 GetPendingReadCompletionTime();
+
 	private:
 		enum COMMAND : uint32
 		{
@@ -57,6 +64,8 @@ namespace Iop
 			CDVD_FUNCTION_SEEK = 4,
 		};
 
+		void CompletePendingCommand();
+
 		uint32 CdInit(uint32);
 		uint32 CdRead(uint32, uint32, uint32, uint32);
 		uint32 CdSeek(uint32);
@@ -80,6 +89,8 @@ namespace Iop
 		uint32 CdLayerSearchFile(uint32, uint32, uint32);
 
 		CIopBios& m_bios;
+		CCdvdReadQueue m_readQueue;
+		CCdvdStreamPrefetcher m_streamPrefetcher;
 		COpticalMedia* m_opticalMedia = nullptr;
 		uint8* m_ram = nullptr;
 
@@ -88,6 +99,10 @@ namespace Iop
 		uint32 m_streamPos = 0;
 		uint32 m_streamBufferSize = 0;
 		COMMAND m_pendingCommand = COMMAND_NONE;
+		uint32 m_pendingReadSector = 0;
+		uint32 m_pendingReadCount = 0;
+		uint32 m_pendingReadBufferPtr = 0;
+		CCdvdReadQueue::RequestId m_pendingReadRequestId = CCdvdReadQueue::INVALID_REQUEST_ID;
 	};
 
 	typedef std::shared_ptr<CCdvdman> CdvdmanPtr;
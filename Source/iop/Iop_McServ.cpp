@@ -15,6 +15,11 @@
 #include "MIPSAssembler.h"
 #include "FilesystemUtils.h"
 
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
 using namespace Iop;
 
 #define CLUSTER_SIZE 0x400
@@ -30,6 +35,10 @@ using namespace Iop;
 
 #define SEPARATOR_CHAR '/'
 
+#ifdef __linux__
+#define DIRECTORY_WATCH_FLAGS (IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF)
+#endif
+
 // clang-format off
 const char* CMcServ::m_mcPathPreference[2] =
 {
@@ -297,11 +306,17 @@ void CMcServ::Open(uint32* args, uint32 argsSize, uint32* ret, uint32 retSize, u
 		catch(...)
 		{
 		}
+		m_directoryIndex.Invalidate();
 		ret[0] = result;
 		return;
 	}
 	else
 	{
+		if(cmd->flags & (OPEN_FLAG_CREAT | OPEN_FLAG_TRUNC))
+		{
+			m_directoryIndex.Invalidate();
+		}
+
 		if(cmd->flags & OPEN_FLAG_CREAT)
 		{
 			if(!fs::exists(filePath))
@@ -358,6 +373,13 @@ void CMcServ::Close(uint32* args, uint32 argsSize, uint32* ret, uint32 retSize,
 
 	file->Clear();
 
+	if(m_fileModified[cmd->handle])
+	{
+		//File size and modification time are only final once the file is closed
+		m_fileModified[cmd->handle] = false;
+		m_directoryIndex.Invalidate();
+	}
+
 	ret[0] = 0;
 }
 
@@ -440,6 +462,9 @@ void CMcServ::Write(uint32* args, uint32 argsSize, uint32* ret, uint32 retSize,
 		return;
 	}
 
+	m_fileModified[cmd->handle] = true;
+	m_directoryIndex.Invalidate();
+
 	const void* dst = &ram[cmd->bufferAddress];
 	uint32 result = 0;
 
@@ -470,6 +495,11 @@ void CMcServ::Flush(uint32* args, uint32 argsSize, uint32* ret, uint32 retSize,
 
 	file->Flush();
 
+	if(m_fileModified[cmd->handle])
+	{
+		m_directoryIndex.Invalidate();
+	}
+
 	ret[0] = 0;
 }
 
@@ -550,6 +580,7 @@ void CMcServ::GetDir(uint32* args, uint32 argsSize, uint32* ret, uint32 retSize,
 		if(cmd->flags == 0)
 		{
 			m_pathFinder.Reset();
+			m_directoryIndex.ProcessHostChanges();
 
 			auto mcPath = CAppConfig::GetInstance().GetPreferencePath(m_mcPathPreference[cmd->port]);
 			if(cmd->name[0] != SEPARATOR_CHAR)
@@ -558,7 +589,7 @@ void CMcServ::GetDir(uint32* args, uint32 argsSize, uint32* ret, uint32 retSize,
 			}
 			mcPath = fs::absolute(mcPath);
 
-			if(!fs::exists(mcPath))
+			if(!m_directoryIndex.GetDirectory(mcPath))
 			{
 				//Directory doesn't exist
 				ret[0] = RET_NO_ENTRY;
@@ -567,7 +598,7 @@ void CMcServ::GetDir(uint32* args, uint32 argsSize, uint32* ret, uint32 retSize,
 
 			auto searchPath = Iop::PathUtils::MakeHostPath(mcPath, cmd->name);
 			searchPath.remove_filename();
-			if(!fs::exists(searchPath))
+			if(!m_directoryIndex.GetDirectory(searchPath))
 			{
 				//Specified directory doesn't exist, this is an error
 				ret[0] = RET_NO_ENTRY;
@@ -575,7 +606,7 @@ void CMcServ::GetDir(uint32* args, uint32 argsSize, uint32* ret, uint32 retSize,
 			}
 
 			assert(*mcPath.string().rbegin() != '/');
-			m_pathFinder.Search(mcPath, cmd->name);
+			m_pathFinder.Search(m_directoryIndex, mcPath, cmd->name);
 		}
 
 		auto entries = (cmd->maxEntries > 0) ? reinterpret_cast<ENTRY*>(&ram[cmd->tableAddress]) : nullptr;
@@ -601,6 +632,7 @@ void CMcServ::Delete(uint32* args, uint32 argsSize, uint32* ret, uint32 retSize,
 		if(fs::exists(filePath))
 		{
 			fs::remove(filePath);
+			m_directoryIndex.Invalidate();
 			ret[0] = 0;
 		}
 		else
@@ -778,6 +810,205 @@ fs::path CMcServ::GetAbsoluteFilePath(unsigned int port, unsigned int slot, cons
 	}
 }
 
+/////////////////////////////////////////////
+//CDirectoryIndex Implementation
+/////////////////////////////////////////////
+
+CMcServ::CDirectoryIndex::CDirectoryIndex()
+{
+#ifdef __linux__
+	m_notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if(m_notifyFd < 0)
+	{
+		CLog::GetInstance().Warn(LOG_NAME, "Failed to initialize inotify, directory changes will be detected using modification times.\r\n");
+	}
+#endif
+}
+
+CMcServ::CDirectoryIndex::~CDirectoryIndex()
+{
+#ifdef __linux__
+	if(m_notifyFd >= 0)
+	{
+		close(m_notifyFd);
+	}
+#endif
+}
+
+const CMcServ::CDirectoryIndex::NodeArray* CMcServ::CDirectoryIndex::GetDirectory(const fs::path& path)
+{
+	auto key = MakeKey(path);
+	auto directoryIterator = m_directories.find(key);
+	if(directoryIterator != std::end(m_directories))
+	{
+		//Watched directories are removed as soon as the host reports a change
+		auto& directory = directoryIterator->second;
+		if(directory.watchDescriptor >= 0)
+		{
+			return &directory.nodes;
+		}
+		std::error_code errorCode;
+		auto modificationTime = fs::last_write_time(path, errorCode);
+		if(!errorCode && (modificationTime == directory.modificationTime))
+		{
+			return &directory.nodes;
+		}
+		RemoveDirectory(directoryIterator);
+	}
+
+	if(!fs::is_directory(path))
+	{
+		return nullptr;
+	}
+
+	DIRECTORY directory;
+#ifdef __linux__
+	//Watch is added before listing the directory to make sure changes made while listing aren't missed
+	if(m_notifyFd >= 0)
+	{
+		int watchDescriptor = inotify_add_watch(m_notifyFd, path.c_str(), DIRECTORY_WATCH_FLAGS);
+		//Same directory reached through another path (ex.: symlink) already uses this watch
+		if((watchDescriptor >= 0) && (m_watches.find(watchDescriptor) == std::end(m_watches)))
+		{
+			directory.watchDescriptor = watchDescriptor;
+		}
+	}
+#endif
+	try
+	{
+		if(directory.watchDescriptor < 0)
+		{
+			directory.modificationTime = fs::last_write_time(path);
+		}
+		for(const auto& element : fs::directory_iterator(path))
+		{
+			directory.nodes.push_back(MakeNode(element));
+		}
+	}
+	catch(...)
+	{
+#ifdef __linux__
+		if(directory.watchDescriptor >= 0)
+		{
+			inotify_rm_watch(m_notifyFd, directory.watchDescriptor);
+		}
+#endif
+		throw;
+	}
+
+	if(directory.watchDescriptor >= 0)
+	{
+		m_watches[directory.watchDescriptor] = key;
+	}
+	auto& indexedDirectory = m_directories[key];
+	indexedDirectory = std::move(directory);
+	return &indexedDirectory.nodes;
+}
+
+void CMcServ::CDirectoryIndex::ProcessHostChanges()
+{
+#ifdef __linux__
+	if(m_notifyFd < 0) return;
+
+	alignas(struct inotify_event) char buffer[0x1000];
+	while(true)
+	{
+		auto readSize = read(m_notifyFd, buffer, sizeof(buffer));
+		if(readSize <= 0) break;
+		for(ssize_t offset = 0; offset < readSize;)
+		{
+			auto event = reinterpret_cast<const struct inotify_event*>(buffer + offset);
+			offset += sizeof(struct inotify_event) + event->len;
+			if(event->mask & IN_Q_OVERFLOW)
+			{
+				//Some events were lost, we can't tell which directories are still valid
+				Invalidate();
+				continue;
+			}
+			auto watchIterator = m_watches.find(event->wd);
+			if(watchIterator == std::end(m_watches)) continue;
+			auto directoryIterator = m_directories.find(watchIterator->second);
+			assert(directoryIterator != std::end(m_directories));
+			RemoveDirectory(directoryIterator);
+		}
+	}
+#endif
+}
+
+void CMcServ::CDirectoryIndex::Invalidate()
+{
+	while(!m_directories.empty())
+	{
+		RemoveDirectory(std::begin(m_directories));
+	}
+}
+
+std::string CMcServ::CDirectoryIndex::MakeKey(const fs::path& path)
+{
+	auto key = path.lexically_normal().generic_string();
+	if((key.size() > 1) && (*key.rbegin() == SEPARATOR_CHAR))
+	{
+		key.pop_back();
+	}
+	return key;
+}
+
+CMcServ::CDirectoryIndex::NODE CMcServ::CDirectoryIndex::MakeNode(const fs::directory_entry& element)
+{
+	//Attributes are taken from the directory entry, some platforms provide them while listing the directory
+	NODE node;
+	node.name = element.path().filename().string();
+	node.isDirectory = element.is_directory();
+
+	auto& entry = node.entry;
+	memset(&entry, 0, sizeof(entry));
+
+	strncpy(reinterpret_cast<char*>(entry.name), node.name.c_str(), 0x1F);
+	entry.name[0x1F] = 0;
+
+	if(node.isDirectory)
+	{
+		entry.size = 0;
+		entry.attributes = 0x8427;
+	}
+	else
+	{
+		entry.size = static_cast<uint32>(element.file_size());
+		entry.attributes = 0x8497;
+	}
+
+	//Fill in modification date info
+	{
+		auto changeSystemTime = Framework::ConvertFsTimeToSystemTime(element.last_write_time());
+		auto localChangeDate = std::localtime(&changeSystemTime);
+
+		entry.modificationTime.second = localChangeDate->tm_sec;
+		entry.modificationTime.minute = localChangeDate->tm_min;
+		entry.modificationTime.hour = localChangeDate->tm_hour;
+		entry.modificationTime.day = localChangeDate->tm_mday;
+		entry.modificationTime.month = localChangeDate->tm_mon;
+		entry.modificationTime.year = localChangeDate->tm_year + 1900;
+	}
+
+	//std::filesystem doesn't provide a way to get creation time, so just make it the same as modification date
+	entry.creationTime = entry.modificationTime;
+
+	return node;
+}
+
+void CMcServ::CDirectoryIndex::RemoveDirectory(DirectoryMap::iterator directoryIterator)
+{
+	int watchDescriptor = directoryIterator->second.watchDescriptor;
+	if(watchDescriptor >= 0)
+	{
+#ifdef __linux__
+		inotify_rm_watch(m_notifyFd, watchDescriptor);
+#endif
+		m_watches.erase(watchDescriptor);
+	}
+	m_directories.erase(directoryIterator);
+}
+
 /////////////////////////////////////////////
 //CPathFinder Implementation
 /////////////////////////////////////////////
@@ -797,24 +1028,15 @@ void CMcServ::CPathFinder::Reset()
 	m_index = 0;
 }
 
-void CMcServ::CPathFinder::Search(const fs::path& basePath, const char* filter)
+void CMcServ::CPathFinder::Search(CDirectoryIndex& directoryIndex, const fs::path& basePath, const char* filter)
 {
-	m_basePath = basePath;
-
 	std::string filterPathString = filter;
 	if(filterPathString[0] != '/')
 	{
 		filterPathString = "/" + filterPathString;
 	}
 
-	{
-		std::string filterExpString = filterPathString;
-		filterExpString = StringUtils::ReplaceAll(filterExpString, "\\", "\\\\");
-		filterExpString = StringUtils::ReplaceAll(filterExpString, ".", "\\.");
-		filterExpString = StringUtils::ReplaceAll(filterExpString, "?", ".?");
-		filterExpString = StringUtils::ReplaceAll(filterExpString, "*", ".*");
-		m_filterExp = std::regex(filterExpString);
-	}
+	CompileFilter(filterPathString);
 
 	auto filterPath = fs::path(filterPathString);
 	filterPath.remove_filename();
@@ -824,7 +1046,7 @@ void CMcServ::CPathFinder::Search(const fs::path& basePath, const char* filter)
 	auto currentDirPathString = currentDirPath.generic_string();
 	auto parentDirPathString = parentDirPath.generic_string();
 
-	if(std::regex_match(currentDirPathString, m_filterExp))
+	if(MatchFilter(currentDirPathString))
 	{
 		ENTRY entry;
 		memset(&entry, 0, sizeof(entry));
@@ -834,7 +1056,7 @@ void CMcServ::CPathFinder::Search(const fs::path& basePath, const char* filter)
 		m_entries.push_back(entry);
 	}
 
-	if(std::regex_match(parentDirPathString, m_filterExp))
+	if(MatchFilter(parentDirPathString))
 	{
 		ENTRY entry;
 		memset(&entry, 0, sizeof(entry));
@@ -844,7 +1066,7 @@ void CMcServ::CPathFinder::Search(const fs::path& basePath, const char* filter)
 		m_entries.push_back(entry);
 	}
 
-	SearchRecurse(m_basePath);
+	SearchRecurse(directoryIndex, basePath, std::string());
 }
 
 unsigned int CMcServ::CPathFinder::Read(ENTRY* entry, unsigned int size)
@@ -863,64 +1085,91 @@ unsigned int CMcServ::CPathFinder::Read(ENTRY* entry, unsigned int size)
 	return readCount;
 }
 
-void CMcServ::CPathFinder::SearchRecurse(const fs::path& path)
+void CMcServ::CPathFinder::CompileFilter(const std::string& filter)
 {
-	bool found = false;
-	fs::directory_iterator endIterator;
-
-	for(fs::directory_iterator elementIterator(path);
-	    elementIterator != endIterator; elementIterator++)
+	m_filterTokens.clear();
+	for(auto filterChar : filter)
 	{
-		fs::path relativePath(*elementIterator);
-		std::string relativePathString(relativePath.generic_string());
-
-		//"Extract" a more appropriate relative path from the memory card point of view
-		relativePathString.erase(0, m_basePath.string().size());
-
-		//Attempt to match this against the filter
-		if(std::regex_match(relativePathString, m_filterExp))
+		switch(filterChar)
 		{
-			//Fill in the information
-			ENTRY entry;
-			memset(&entry, 0, sizeof(entry));
-
-			strncpy(reinterpret_cast<char*>(entry.name), relativePath.filename().string().c_str(), 0x1F);
-			entry.name[0x1F] = 0;
+		case '*':
+			//Consecutive wildcards match the same thing as a single one
+			if(m_filterTokens.empty() || (m_filterTokens.back() != FILTER_TOKEN_ANY_SEQUENCE))
+			{
+				m_filterTokens.push_back(FILTER_TOKEN_ANY_SEQUENCE);
+			}
+			break;
+		case '?':
+			m_filterTokens.push_back(FILTER_TOKEN_OPTIONAL_CHAR);
+			break;
+		default:
+			m_filterTokens.push_back(static_cast<uint8>(filterChar));
+			break;
+		}
+	}
+}
 
-			if(fs::is_directory(*elementIterator))
+bool CMcServ::CPathFinder::MatchFilter(const std::string& path)
+{
+	//Each state tells if the tokens processed so far match the path's prefix of that length
+	size_t stateCount = path.size() + 1;
+	m_matchStates.assign(stateCount, 0);
+	m_nextMatchStates.resize(stateCount);
+	m_matchStates[0] = 1;
+	for(auto token : m_filterTokens)
+	{
+		switch(token)
+		{
+		case FILTER_TOKEN_ANY_SEQUENCE:
+		{
+			uint8 matched = 0;
+			for(size_t i = 0; i < stateCount; i++)
 			{
-				entry.size = 0;
-				entry.attributes = 0x8427;
+				matched |= m_matchStates[i];
+				m_nextMatchStates[i] = matched;
 			}
-			else
+		}
+		break;
+		case FILTER_TOKEN_OPTIONAL_CHAR:
+			m_nextMatchStates[0] = m_matchStates[0];
+			for(size_t i = 1; i < stateCount; i++)
 			{
-				entry.size = static_cast<uint32>(fs::file_size(*elementIterator));
-				entry.attributes = 0x8497;
+				m_nextMatchStates[i] = m_matchStates[i] | m_matchStates[i - 1];
 			}
-
-			//Fill in modification date info
+			break;
+		default:
+			m_nextMatchStates[0] = 0;
+			for(size_t i = 1; i < stateCount; i++)
 			{
-				auto changeSystemTime = Framework::ConvertFsTimeToSystemTime(fs::last_write_time(*elementIterator));
-				auto localChangeDate = std::localtime(&changeSystemTime);
-
-				entry.modificationTime.second = localChangeDate->tm_sec;
-				entry.modificationTime.minute = localChangeDate->tm_min;
-				entry.modificationTime.hour = localChangeDate->tm_hour;
-				entry.modificationTime.day = localChangeDate->tm_mday;
-				entry.modificationTime.month = localChangeDate->tm_mon;
-				entry.modificationTime.year = localChangeDate->tm_year + 1900;
+				m_nextMatchStates[i] = m_matchStates[i - 1] & (static_cast<uint8>(path[i - 1]) == token);
 			}
+			break;
+		}
+		std::swap(m_matchStates, m_nextMatchStates);
+	}
+	return m_matchStates[path.size()] != 0;
+}
 
-			//std::filesystem doesn't provide a way to get creation time, so just make it the same as modification date
-			entry.creationTime = entry.modificationTime;
+void CMcServ::CPathFinder::SearchRecurse(CDirectoryIndex& directoryIndex, const fs::path& path, const std::string& relativePath)
+{
+	//Directory might have been removed since its parent was listed
+	auto nodes = directoryIndex.GetDirectory(path);
+	if(!nodes) return;
 
-			m_entries.push_back(entry);
+	bool found = false;
+	for(const auto& node : *nodes)
+	{
+		//Match a relative path from the memory card point of view against the filter
+		auto nodePath = relativePath + SEPARATOR_CHAR + node.name;
+		if(MatchFilter(nodePath))
+		{
+			m_entries.push_back(node.entry);
 			found = true;
 		}
 
-		if(fs::is_directory(*elementIterator) && !found)
+		if(node.isDirectory && !found)
 		{
-			SearchRecurse(*elementIterator);
+			SearchRecurse(directoryIndex, path / node.name, nodePath);
 		}
 	}
 }
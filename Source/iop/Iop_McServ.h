@@ -2,7 +2,6 @@
 
 #include <string>
 #include <map>
-#include <regex>
 #include "filesystem_def.h"
 #include "StdStream.h"
 #include "Iop_Module.h"
@@ -118,6 +117,46 @@ namespace Iop
 			char data[16];
 		};
 
+		//Keeps the contents of host directories listed by GetDir to avoid walking and stat-ing them every time.
+		//Directories are dropped when the host notifies a change (inotify) or when their modification time changes.
+		class CDirectoryIndex
+		{
+		public:
+			struct NODE
+			{
+				std::string name;
+				bool isDirectory = false;
+				ENTRY entry;
+			};
+			typedef std::vector<NODE> NodeArray;
+
+			CDirectoryIndex();
+			virtual ~CDirectoryIndex();
+
+			//Returns nullptr if directory doesn't exist
+			const NodeArray* GetDirectory(const fs::path&);
+			void ProcessHostChanges();
+			void Invalidate();
+
+		private:
+			struct DIRECTORY
+			{
+				NodeArray nodes;
+				fs::file_time_type modificationTime;
+				int watchDescriptor = -1;
+			};
+			typedef std::map<std::string, DIRECTORY> DirectoryMap;
+			typedef std::map<int, std::string> WatchMap;
+
+			static std::string MakeKey(const fs::path&);
+			static NODE MakeNode(const fs::directory_entry&);
+			void RemoveDirectory(DirectoryMap::iterator);
+
+			DirectoryMap m_directories;
+			WatchMap m_watches;
+			int m_notifyFd = -1;
+		};
+
 		class CPathFinder
 		{
 		public:
@@ -125,17 +164,28 @@ namespace Iop
 			virtual ~CPathFinder();
 
 			void Reset();
-			void Search(const fs::path&, const char*);
+			void Search(CDirectoryIndex&, const fs::path&, const char*);
 			unsigned int Read(ENTRY*, unsigned int);
 
 		private:
 			typedef std::vector<ENTRY> EntryList;
 
-			void SearchRecurse(const fs::path&);
+			//'*' matches any sequence of characters, '?' matches one character or none
+			enum FILTER_TOKEN : int32
+			{
+				FILTER_TOKEN_ANY_SEQUENCE = -1,
+				FILTER_TOKEN_OPTIONAL_CHAR = -2,
+			};
+			typedef std::vector<int32> FilterTokenArray;
+
+			void CompileFilter(const std::string&);
+			bool MatchFilter(const std::string&);
+			void SearchRecurse(CDirectoryIndex&, const fs::path&, const std::string&);
 
 			EntryList m_entries;
-			fs::path m_basePath;
-			std::regex m_filterExp;
+			FilterTokenArray m_filterTokens;
+			std::vector<uint8> m_matchStates;
+			std::vector<uint8> m_nextMatchStates;
 			unsigned int m_index;
 		};
 
@@ -177,7 +227,9 @@ namespace Iop
 		uint32 m_readFastAddr = 0;
 		Framework::CStdStream m_files[MAX_FILES];
 		static const char* m_mcPathPreference[2];
+		bool m_fileModified[MAX_FILES] = {};
 		std::string m_currentDirectory;
+		CDirectoryIndex m_directoryIndex;
 		CPathFinder m_pathFinder;
 	};
 }
@@ -3,6 +3,7 @@
 #include "IopBios.h"
 #include "../ee/SIF.h"
 #include "../Log.h"
+#include "../TraceLog.h"
 #include "../states/StructCollectionStateFile.h"
 
 using namespace Iop;
@@ -212,7 +213,7 @@ void CSifCmd::Invoke(CMIPS& context, unsigned int functionId)
 		    context.m_pMemoryMap->GetWord(context.m_State.nGPR[CMIPS::SP].nV0 + 0x14));
 		break;
 	case 14:
-		CLog::GetInstance().Print(LOG_NAME, FUNCTION_SIFINITRPC "();\r\n");
+		TRACE_EVENT(TRACE_SUBSYSTEM_SIF, FUNCTION_SIFINITRPC "();");
 		break;
 	case 15:
 		SifBindRpc(context);
@@ -468,8 +469,9 @@ void CSifCmd::ProcessInvocation(uint32 serverDataAddr, uint32 methodId, uint32*
 	auto serverData = reinterpret_cast<SIFRPCSERVERDATA*>(m_ram + serverDataAddr);
 	auto queueData = reinterpret_cast<SIFRPCQUEUEDATA*>(m_ram + serverData->queueAddr);
 
-	//Copy params
-	if(serverData->buffer != 0)
+	//Params are a view of the EE RAM the call's data was sent from. This copy stands for the DMA
+	//transfer to the server's receive buffer and can't be avoided since the server reads from it.
+	if((serverData->buffer != 0) && (size != 0))
 	{
 		memcpy(&m_ram[serverData->buffer], params, size);
 	}
@@ -638,8 +640,8 @@ void CSifCmd::ProcessNextDynamicCommand()
 	{
 		const auto& cmdDataEntry = reinterpret_cast<SIFCMDDATA*>(m_ram + cmdBufferAddr)[cmd];
 
-		CLog::GetInstance().Print(LOG_NAME, "Calling SIF command handler for command 0x%08X at 0x%08X with data 0x%08X.\r\n",
-		                          commandHeader->commandId, cmdDataEntry.sifCmdHandler, cmdDataEntry.data);
+		TRACE_EVENT(TRACE_SUBSYSTEM_SIF, "Calling SIF command handler for command 0x%08X at 0x%08X with data 0x%08X.",
+		            commandHeader->commandId, cmdDataEntry.sifCmdHandler, cmdDataEntry.data);
 
 		assert(cmdDataEntry.sifCmdHandler != 0);
 		if(cmdDataEntry.sifCmdHandler != 0)
@@ -664,8 +666,8 @@ void CSifCmd::ProcessNextDynamicCommand()
 
 int32 CSifCmd::SifGetSreg(uint32 regIndex)
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_SIFGETSREG "(regIndex = %d);\r\n",
-	                          regIndex);
+	TRACE_EVENT(TRACE_SUBSYSTEM_SIF, FUNCTION_SIFGETSREG "(regIndex = %d);",
+	            regIndex);
 	assert(regIndex < MAX_SREG);
 	if(regIndex >= MAX_SREG)
 	{
@@ -678,8 +680,8 @@ int32 CSifCmd::SifGetSreg(uint32 regIndex)
 
 uint32 CSifCmd::SifSetCmdBuffer(uint32 cmdBufferAddr, uint32 length)
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_SIFSETCMDBUFFER "(cmdBufferAddr = 0x%08X, length = %d);\r\n",
-	                          cmdBufferAddr, length);
+	TRACE_EVENT(TRACE_SUBSYSTEM_SIF, FUNCTION_SIFSETCMDBUFFER "(cmdBufferAddr = 0x%08X, length = %d);",
+	            cmdBufferAddr, length);
 
 	auto moduleData = reinterpret_cast<MODULEDATA*>(m_ram + m_moduleDataAddr);
 	uint32 originalBuffer = moduleData->usrCmdBufferAddr;
@@ -691,8 +693,8 @@ uint32 CSifCmd::SifSetCmdBuffer(uint32 cmdBufferAddr, uint32 length)
 
 void CSifCmd::SifAddCmdHandler(uint32 pos, uint32 handler, uint32 data)
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_SIFADDCMDHANDLER "(pos = 0x%08X, handler = 0x%08X, data = 0x%08X);\r\n",
-	                          pos, handler, data);
+	TRACE_EVENT(TRACE_SUBSYSTEM_SIF, FUNCTION_SIFADDCMDHANDLER "(pos = 0x%08X, handler = 0x%08X, data = 0x%08X);",
+	            pos, handler, data);
 
 	auto moduleData = reinterpret_cast<const MODULEDATA*>(m_ram + m_moduleDataAddr);
 	bool isSystemCommand = (pos & SYSTEM_COMMAND_ID) != 0;
@@ -708,14 +710,14 @@ void CSifCmd::SifAddCmdHandler(uint32 pos, uint32 handler, uint32 data)
 	}
 	else
 	{
-		CLog::GetInstance().Print(LOG_NAME, "SifAddCmdHandler - error command buffer too small or not set.\r\n");
+		TRACE_EVENT(TRACE_SUBSYSTEM_SIF, "SifAddCmdHandler - error command buffer too small or not set.");
 	}
 }
 
 uint32 CSifCmd::SifSendCmd(uint32 commandId, uint32 packetPtr, uint32 packetSize, uint32 srcExtraPtr, uint32 dstExtraPtr, uint32 sizeExtra)
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_SIFSENDCMD "(commandId = 0x%08X, packetPtr = 0x%08X, packetSize = 0x%08X, srcExtraPtr = 0x%08X, dstExtraPtr = 0x%08X, sizeExtra = 0x%08X);\r\n",
-	                          commandId, packetPtr, packetSize, srcExtraPtr, dstExtraPtr, sizeExtra);
+	TRACE_EVENT(TRACE_SUBSYSTEM_SIF, FUNCTION_SIFSENDCMD "(commandId = 0x%08X, packetPtr = 0x%08X, packetSize = 0x%08X, srcExtraPtr = 0x%08X, dstExtraPtr = 0x%08X, sizeExtra = 0x%08X);",
+	            commandId, packetPtr, packetSize, srcExtraPtr, dstExtraPtr, sizeExtra);
 
 	assert(packetSize >= 0x10);
 
@@ -751,8 +753,8 @@ void CSifCmd::SifBindRpc(CMIPS& context)
 	uint32 serverId = context.m_State.nGPR[CMIPS::A1].nV0;
 	uint32 mode = context.m_State.nGPR[CMIPS::A2].nV0;
 
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_SIFBINDRPC "(clientDataAddr = 0x%08X, serverId = 0x%08X, mode = 0x%08X);\r\n",
-	                          clientDataAddr, serverId, mode);
+	TRACE_EVENT(TRACE_SUBSYSTEM_SIF, FUNCTION_SIFBINDRPC "(clientDataAddr = 0x%08X, serverId = 0x%08X, mode = 0x%08X);",
+	            clientDataAddr, serverId, mode);
 
 	//Could be in non waiting mode
 	assert(mode == 0);
@@ -774,9 +776,9 @@ void CSifCmd::SifCallRpc(CMIPS& context)
 
 	assert(mode == 0);
 
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_SIFCALLRPC "(clientDataAddr = 0x%08X, rpcNumber = 0x%08X, mode = 0x%08X, sendAddr = 0x%08X, sendSize = 0x%08X, "
-	                                                        "recvAddr = 0x%08X, recvSize = 0x%08X, endFctAddr = 0x%08X, endParam = 0x%08X);\r\n",
-	                          clientDataAddr, rpcNumber, mode, sendAddr, sendSize, recvAddr, recvSize, endFctAddr, endParam);
+	TRACE_EVENT(TRACE_SUBSYSTEM_SIF, FUNCTION_SIFCALLRPC "(clientDataAddr = 0x%08X, rpcNumber = 0x%08X, mode = 0x%08X, sendAddr = 0x%08X, sendSize = 0x%08X, "
+	                                                     "recvAddr = 0x%08X, recvSize = 0x%08X, endFctAddr = 0x%08X, endParam = 0x%08X);",
+	            clientDataAddr, rpcNumber, mode, sendAddr, sendSize, recvAddr, recvSize, endFctAddr, endParam);
 
 	auto clientData = reinterpret_cast<SIFRPCCLIENTDATA*>(m_ram + clientDataAddr);
 	assert(clientData->serverDataAddr != 0);
@@ -826,8 +828,8 @@ void CSifCmd::SifRegisterRpc(CMIPS& context)
 	uint32 cbuffer = context.m_pMemoryMap->GetWord(context.m_State.nGPR[CMIPS::SP].nV0 + 0x14);
 	uint32 queueAddr = context.m_pMemoryMap->GetWord(context.m_State.nGPR[CMIPS::SP].nV0 + 0x18);
 
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_SIFREGISTERRPC "(serverData = 0x%08X, serverId = 0x%08X, function = 0x%08X, buffer = 0x%08X, cfunction = 0x%08X, cbuffer = 0x%08X, queue = 0x%08X);\r\n",
-	                          serverDataAddr, serverId, function, buffer, cfunction, cbuffer, queueAddr);
+	TRACE_EVENT(TRACE_SUBSYSTEM_SIF, FUNCTION_SIFREGISTERRPC "(serverData = 0x%08X, serverId = 0x%08X, function = 0x%08X, buffer = 0x%08X, cfunction = 0x%08X, cbuffer = 0x%08X, queue = 0x%08X);",
+	            serverDataAddr, serverId, function, buffer, cfunction, cbuffer, queueAddr);
 
 	bool moduleRegistered = m_sifMan.IsModuleRegistered(serverId);
 	if(!moduleRegistered)
@@ -860,8 +862,8 @@ void CSifCmd::SifRegisterRpc(CMIPS& context)
 
 void CSifCmd::SifSetRpcQueue(uint32 queueDataAddr, uint32 threadId)
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_SIFSETRPCQUEUE "(queueData = 0x%08X, threadId = %d);\r\n",
-	                          queueDataAddr, threadId);
+	TRACE_EVENT(TRACE_SUBSYSTEM_SIF, FUNCTION_SIFSETRPCQUEUE "(queueData = 0x%08X, threadId = %d);",
+	            queueDataAddr, threadId);
 
 	if(queueDataAddr != 0)
 	{
@@ -877,8 +879,8 @@ void CSifCmd::SifSetRpcQueue(uint32 queueDataAddr, uint32 threadId)
 
 uint32 CSifCmd::SifGetNextRequest(uint32 queueDataAddr)
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_SIFGETNEXTREQUEST "(queueData = 0x%08X);\r\n",
-	                          queueDataAddr);
+	TRACE_EVENT(TRACE_SUBSYSTEM_SIF, FUNCTION_SIFGETNEXTREQUEST "(queueData = 0x%08X);",
+	            queueDataAddr);
 
 	uint32 result = 0;
 	if(queueDataAddr != 0)
@@ -894,38 +896,38 @@ void CSifCmd::SifExecRequest(CMIPS& context)
 {
 	uint32 serverDataAddr = context.m_State.nGPR[CMIPS::A0].nV0;
 	auto serverData = reinterpret_cast<SIFRPCSERVERDATA*>(&m_ram[serverDataAddr]);
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_SIFEXECREQUEST "(serverData = 0x%08X, serverId=0x%x, function=0x%x, rid=0x%x, buffer=0x%x, rsize=0x%x);\r\n",
-	                          serverDataAddr, serverData->serverId, serverData->function, serverData->rid, serverData->buffer, serverData->rsize);
+	TRACE_EVENT(TRACE_SUBSYSTEM_SIF, FUNCTION_SIFEXECREQUEST "(serverData = 0x%08X, serverId=0x%x, function=0x%x, rid=0x%x, buffer=0x%x, rsize=0x%x);",
+	            serverDataAddr, serverData->serverId, serverData->function, serverData->rid, serverData->buffer, serverData->rsize);
 	context.m_State.nPC = m_sifExecRequestAddr;
 }
 
 uint32 CSifCmd::SifCheckStatRpc(uint32 clientDataAddress)
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_SIFCHECKSTATRPC "(clientData = 0x%08X);\r\n",
-	                          clientDataAddress);
+	TRACE_EVENT(TRACE_SUBSYSTEM_SIF, FUNCTION_SIFCHECKSTATRPC "(clientData = 0x%08X);",
+	            clientDataAddress);
 	return 0;
 }
 
 void CSifCmd::SifRpcLoop(CMIPS& context)
 {
 	uint32 queueAddr = context.m_State.nGPR[CMIPS::A0].nV0;
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_SIFRPCLOOP "(queue = 0x%08X);\r\n",
-	                          queueAddr);
+	TRACE_EVENT(TRACE_SUBSYSTEM_SIF, FUNCTION_SIFRPCLOOP "(queue = 0x%08X);",
+	            queueAddr);
 	context.m_State.nPC = m_sifRpcLoopAddr;
 }
 
 uint32 CSifCmd::SifGetOtherData(uint32 packetPtr, uint32 src, uint32 dst, uint32 size, uint32 mode)
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_SIFGETOTHERDATA "(packetPtr = 0x%08X, src = 0x%08X, dst = 0x%08X, size = 0x%08X, mode = %d);\r\n",
-	                          packetPtr, src, dst, size, mode);
+	TRACE_EVENT(TRACE_SUBSYSTEM_SIF, FUNCTION_SIFGETOTHERDATA "(packetPtr = 0x%08X, src = 0x%08X, dst = 0x%08X, size = 0x%08X, mode = %d);",
+	            packetPtr, src, dst, size, mode);
 	m_sifMan.GetOtherData(dst, src, size);
 	return 0;
 }
 
 uint32 CSifCmd::SifSendCmdIntr(uint32 commandId, uint32 packetPtr, uint32 packetSize, uint32 srcExtraPtr, uint32 dstExtraPtr, uint32 sizeExtra, uint32 callbackPtr, uint32 callbackDataPtr)
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_SIFSENDCMDINTR "(commandId = 0x%08X, packetPtr = 0x%08X, packetSize = 0x%08X, srcExtraPtr = 0x%08X, dstExtraPtr = 0x%08X, sizeExtra = 0x%08X, callbackPtr = 0x%08X, callbackDataPtr = 0x%08X);\r\n",
-	                          commandId, packetPtr, packetSize, srcExtraPtr, dstExtraPtr, sizeExtra, callbackPtr, callbackDataPtr);
+	TRACE_EVENT(TRACE_SUBSYSTEM_SIF, FUNCTION_SIFSENDCMDINTR "(commandId = 0x%08X, packetPtr = 0x%08X, packetSize = 0x%08X, srcExtraPtr = 0x%08X, dstExtraPtr = 0x%08X, sizeExtra = 0x%08X, callbackPtr = 0x%08X, callbackDataPtr = 0x%08X);",
+	            commandId, packetPtr, packetSize, srcExtraPtr, dstExtraPtr, sizeExtra, callbackPtr, callbackDataPtr);
 
 	uint32 result = SifSendCmd(commandId, packetPtr, packetSize, srcExtraPtr, dstExtraPtr, sizeExtra);
 	m_bios.TriggerCallback(callbackPtr, callbackDataPtr);
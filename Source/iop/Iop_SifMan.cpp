@@ -2,6 +2,7 @@
 #include "Iop_Sysmem.h"
 #include "../MIPSAssembler.h"
 #include "../Log.h"
+#include "../TraceLog.h"
 
 #define LOG_NAME ("iop_sifman")
 
@@ -104,29 +105,29 @@ void CSifMan::GenerateHandlers(uint8* ram, CSysmem& sysMem)
 
 uint32 CSifMan::SifSetDma(uint32 structAddr, uint32 count)
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_SIFSETDMA "(structAddr = 0x%08X, count = %d);\r\n",
-	                          structAddr, count);
+	TRACE_EVENT(TRACE_SUBSYSTEM_SIF, FUNCTION_SIFSETDMA "(structAddr = 0x%08X, count = %d);",
+	            structAddr, count);
 	return count;
 }
 
 uint32 CSifMan::SifDmaStat(uint32 transferId)
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_SIFDMASTAT "(transferId = %X);\r\n",
-	                          transferId);
+	TRACE_EVENT(TRACE_SUBSYSTEM_SIF, FUNCTION_SIFDMASTAT "(transferId = %X);",
+	            transferId);
 	return -1;
 }
 
 uint32 CSifMan::SifCheckInit()
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_SIFCHECKINIT "();\r\n");
+	TRACE_EVENT(TRACE_SUBSYSTEM_SIF, FUNCTION_SIFCHECKINIT "();");
 	// Since we don't handle the init call, always return true for check init.
 	return 1;
 }
 
 uint32 CSifMan::SifSetDmaCallback(CMIPS& context, uint32 structAddr, uint32 count, uint32 callbackPtr, uint32 callbackParam)
 {
-	CLog::GetInstance().Print(LOG_NAME, FUNCTION_SIFSETDMACALLBACK "(structAddr = 0x%08X, count = %d, callbackPtr = 0x%08X, callbackParam = 0x%08X);\r\n",
-	                          structAddr, count, callbackPtr, callbackParam);
+	TRACE_EVENT(TRACE_SUBSYSTEM_SIF, FUNCTION_SIFSETDMACALLBACK "(structAddr = 0x%08X, count = %d, callbackPtr = 0x%08X, callbackParam = 0x%08X);",
+	            structAddr, count, callbackPtr, callbackParam);
 
 	//Modify context so we can execute the callback function
 	context.m_State.nPC = m_sifSetDmaCallbackHandlerPtr;
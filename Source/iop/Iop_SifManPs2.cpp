@@ -1,6 +1,4 @@
-#include <cstring>
 #include "Iop_SifManPs2.h"
-#include "../Ps2Const.h"
 
 using namespace Iop;
 
@@ -48,9 +46,7 @@ void CSifManPs2::SendCallReply(uint32 serverId, const void* returnData)
 
 void CSifManPs2::GetOtherData(uint32 dst, uint32 src, uint32 size)
 {
-	uint8* srcPtr = m_eeRam + (src & (PS2::EE_RAM_SIZE - 1));
-	uint8* dstPtr = m_iopRam + dst;
-	memcpy(dstPtr, srcPtr, size);
+	m_sif.ReceiveOtherData(dst, src, size);
 }
 
 void CSifManPs2::SetModuleResetHandler(const ModuleResetHandler& moduleResetHandler)
@@ -72,13 +68,8 @@ uint32 CSifManPs2::SifSetDma(uint32 structAddr, uint32 count)
 		return 0;
 	}
 
-	auto dmaReg = reinterpret_cast<SIFDMAREG*>(m_iopRam + structAddr);
-	for(unsigned int i = 0; i < count; i++)
-	{
-		uint8* src = m_iopRam + dmaReg[i].srcAddr;
-		uint8* dst = m_eeRam + (dmaReg[i].dstAddr & (PS2::EE_RAM_SIZE - 1));
-		memcpy(dst, src, dmaReg[i].size);
-	}
+	auto dmaReg = reinterpret_cast<const SIFDMAREG*>(m_iopRam + structAddr);
+	m_sif.SendDmaChain(dmaReg, count);
 
 	return count;
 }
@@ -98,12 +98,12 @@ void CSubSystem::NotifyVBlankEnd()
 	m_intc.AssertLine(Iop::CIntc::LINE_EVBLANK);
 }
 
-void CSubSystem::SaveState(Framework::CZipArchiveWriter& archive)
+void CSubSystem::SaveState(Framework::CZipArchiveWriter& archive, CMemoryStateTracker* memoryTracker)
 {
 	archive.InsertFile(new CMemoryStateFile(STATE_CPU, &m_cpu.m_State, sizeof(MIPSSTATE)));
-	archive.InsertFile(new CMemoryStateFile(STATE_RAM, m_ram, IOP_RAM_SIZE));
-	archive.InsertFile(new CMemoryStateFile(STATE_SCRATCH, m_scratchPad, IOP_SCRATCH_SIZE));
-	archive.InsertFile(new CMemoryStateFile(STATE_SPURAM, m_spuRam, SPU_RAM_SIZE));
+	CMemoryStateTracker::SaveMemory(archive, memoryTracker, STATE_RAM, m_ram, IOP_RAM_SIZE);
+	CMemoryStateTracker::SaveMemory(archive, memoryTracker, STATE_SCRATCH, m_scratchPad, IOP_SCRATCH_SIZE);
+	CMemoryStateTracker::SaveMemory(archive, memoryTracker, STATE_SPURAM, m_spuRam, SPU_RAM_SIZE);
 	m_intc.SaveState(archive);
 	m_dmac.SaveState(archive);
 	m_counters.SaveState(archive);
@@ -115,12 +115,12 @@ void CSubSystem::SaveState(Framework::CZipArchiveWriter& archive)
 	m_bios->SaveState(archive);
 }
 
-void CSubSystem::LoadState(Framework::CZipArchiveReader& archive)
+void CSubSystem::LoadState(Framework::CZipArchiveReader& archive, CMemoryStateTracker* memoryTracker)
 {
 	archive.BeginReadFile(STATE_CPU)->Read(&m_cpu.m_State, sizeof(MIPSSTATE));
-	archive.BeginReadFile(STATE_RAM)->Read(m_ram, IOP_RAM_SIZE);
-	archive.BeginReadFile(STATE_SCRATCH)->Read(m_scratchPad, IOP_SCRATCH_SIZE);
-	archive.BeginReadFile(STATE_SPURAM)->Read(m_spuRam, SPU_RAM_SIZE);
+	CMemoryStateTracker::LoadMemory(archive, memoryTracker, STATE_RAM, m_ram, IOP_RAM_SIZE);
+	CMemoryStateTracker::LoadMemory(archive, memoryTracker, STATE_SCRATCH, m_scratchPad, IOP_SCRATCH_SIZE);
+	CMemoryStateTracker::LoadMemory(archive, memoryTracker, STATE_SPURAM, m_spuRam, SPU_RAM_SIZE);
 	m_intc.LoadState(archive);
 	m_dmac.LoadState(archive);
 	m_counters.LoadState(archive);
@@ -13,6 +13,7 @@
 #include "Iop_BiosBase.h"
 #include "zip/ZipArchiveWriter.h"
 #include "zip/ZipArchiveReader.h"
+#include "../states/MemoryStateTracker.h"
 
 namespace Iop
 {
@@ -30,8 +31,8 @@ namespace Iop
 		void NotifyVBlankStart();
 		void NotifyVBlankEnd();
 
-		void SaveState(Framework::CZipArchiveWriter&);
-		void LoadState(Framework::CZipArchiveReader&);
+		void SaveState(Framework::CZipArchiveWriter&, CMemoryStateTracker* = nullptr);
+		void LoadState(Framework::CZipArchiveReader&, CMemoryStateTracker* = nullptr);
 
 		uint8* m_ram;
 		uint8* m_scratchPad;
@@ -0,0 +1,223 @@
+#include <algorithm>
+#include <cassert>
+#include "Iop_ThreadQueues.h"
+#include "../Log.h"
+
+#define LOG_NAME ("iop_threadqueues")
+
+using namespace Iop;
+
+CThreadReadyQueue::CThreadReadyQueue()
+{
+	m_timers.reserve(MAX_THREAD_ID);
+}
+
+void CThreadReadyQueue::Reset()
+{
+	m_entries.fill(ENTRY());
+	m_segments.fill(SEGMENT());
+	m_linkedPriorities.Reset();
+	m_readyPriorities.Reset();
+	m_timers.clear();
+}
+
+bool CThreadReadyQueue::IsLinked(uint32 threadId) const
+{
+	if(threadId >= MAX_THREAD_ID) return false;
+	return m_entries[threadId].linked;
+}
+
+uint32 CThreadReadyQueue::Link(uint32 threadId, uint32 priority, uint64 activateTime, uint64 currentTime)
+{
+	assert((threadId != INVALID_THREAD_ID) && (threadId < MAX_THREAD_ID));
+	assert(!m_entries[threadId].linked);
+	priority = ClampPriority(priority);
+
+	//Thread goes after all threads with the same or a higher priority (lower value)
+	uint32 prevId = INVALID_THREAD_ID;
+	auto& segment = m_segments[priority];
+	if(segment.tail != INVALID_THREAD_ID)
+	{
+		prevId = segment.tail;
+	}
+	else if(priority != 0)
+	{
+		uint32 prevPriority = m_linkedPriorities.FindLast(priority - 1);
+		if(prevPriority != CIdBitmap<PRIORITY_COUNT>::INVALID_ID)
+		{
+			prevId = m_segments[prevPriority].tail;
+		}
+	}
+
+	auto& entry = m_entries[threadId];
+	entry.prev = prevId;
+	entry.next = (prevId != INVALID_THREAD_ID) ? m_entries[prevId].next : GetHead();
+	entry.priority = priority;
+	entry.linked = true;
+	entry.delayed = (currentTime <= activateTime);
+	if(prevId != INVALID_THREAD_ID)
+	{
+		m_entries[prevId].next = threadId;
+	}
+	if(entry.next != INVALID_THREAD_ID)
+	{
+		m_entries[entry.next].prev = threadId;
+	}
+
+	if(segment.head == INVALID_THREAD_ID)
+	{
+		segment.head = threadId;
+	}
+	segment.tail = threadId;
+	m_linkedPriorities.Set(priority);
+
+	if(entry.delayed)
+	{
+		//Timers of threads that were unlinked before being activated are only dropped when they
+		//expire, make sure threads delayed far in the future don't make the heap grow forever
+		if(m_timers.size() >= (MAX_THREAD_ID * 2))
+		{
+			CompactTimers();
+		}
+		TIMER timer;
+		timer.activateTime = activateTime;
+		timer.threadId = threadId;
+		timer.generation = entry.generation;
+		m_timers.push_back(timer);
+		std::push_heap(m_timers.begin(), m_timers.end());
+	}
+	else
+	{
+		MarkReady(threadId);
+	}
+
+	return prevId;
+}
+
+uint32 CThreadReadyQueue::Unlink(uint32 threadId)
+{
+	if(!IsLinked(threadId)) return INVALID_THREAD_ID;
+
+	auto& entry = m_entries[threadId];
+	auto& segment = m_segments[entry.priority];
+	uint32 prevId = entry.prev;
+	if(prevId != INVALID_THREAD_ID)
+	{
+		m_entries[prevId].next = entry.next;
+	}
+	if(entry.next != INVALID_THREAD_ID)
+	{
+		m_entries[entry.next].prev = prevId;
+	}
+
+	if(segment.head == segment.tail)
+	{
+		assert(segment.head == threadId);
+		segment.head = INVALID_THREAD_ID;
+		segment.tail = INVALID_THREAD_ID;
+		m_linkedPriorities.Clear(entry.priority);
+	}
+	else if(segment.head == threadId)
+	{
+		segment.head = entry.next;
+	}
+	else if(segment.tail == threadId)
+	{
+		segment.tail = prevId;
+	}
+
+	if(!entry.delayed)
+	{
+		assert(segment.readyCount != 0);
+		segment.readyCount--;
+		if(segment.readyCount == 0)
+		{
+			m_readyPriorities.Clear(entry.priority);
+		}
+	}
+
+	//Invalidates timers that are still pending for this thread
+	entry.generation++;
+	entry.prev = INVALID_THREAD_ID;
+	entry.next = INVALID_THREAD_ID;
+	entry.linked = false;
+	entry.delayed = false;
+
+	return prevId;
+}
+
+uint32 CThreadReadyQueue::GetHead() const
+{
+	uint32 priority = m_linkedPriorities.FindFirst();
+	if(priority == CIdBitmap<PRIORITY_COUNT>::INVALID_ID) return INVALID_THREAD_ID;
+	return m_segments[priority].head;
+}
+
+uint32 CThreadReadyQueue::GetNext(uint32 threadId) const
+{
+	assert(IsLinked(threadId));
+	return m_entries[threadId].next;
+}
+
+uint32 CThreadReadyQueue::GetFirstWithPriority(uint32 priority) const
+{
+	return m_segments[ClampPriority(priority)].head;
+}
+
+uint32 CThreadReadyQueue::FindNextReady(uint64 currentTime)
+{
+	while(!m_timers.empty() && (m_timers.front().activateTime < currentTime))
+	{
+		auto timer = m_timers.front();
+		std::pop_heap(m_timers.begin(), m_timers.end());
+		m_timers.pop_back();
+		auto& entry = m_entries[timer.threadId];
+		if(!entry.linked || !entry.delayed || (entry.generation != timer.generation)) continue;
+		entry.delayed = false;
+		MarkReady(timer.threadId);
+	}
+
+	uint32 priority = m_readyPriorities.FindFirst();
+	if(priority == CIdBitmap<PRIORITY_COUNT>::INVALID_ID) return INVALID_THREAD_ID;
+
+	//Delayed threads stay at their position in the list, skip them
+	uint32 threadId = m_segments[priority].head;
+	while(m_entries[threadId].delayed)
+	{
+		threadId = m_entries[threadId].next;
+		assert(threadId != INVALID_THREAD_ID);
+		assert(m_entries[threadId].priority == priority);
+	}
+	return threadId;
+}
+
+uint32 CThreadReadyQueue::ClampPriority(uint32 priority)
+{
+	//Kernel functions reject illegal priorities, this should never happen
+	if(priority >= PRIORITY_COUNT)
+	{
+		CLog::GetInstance().Warn(LOG_NAME, "Illegal thread priority (%d), clamping.\r\n", priority);
+		assert(false);
+		return PRIORITY_COUNT - 1;
+	}
+	return priority;
+}
+
+void CThreadReadyQueue::MarkReady(uint32 threadId)
+{
+	const auto& entry = m_entries[threadId];
+	auto& segment = m_segments[entry.priority];
+	segment.readyCount++;
+	m_readyPriorities.Set(entry.priority);
+}
+
+void CThreadReadyQueue::CompactTimers()
+{
+	auto timerIterator = std::remove_if(m_timers.begin(), m_timers.end(),
+	                                    [this](const TIMER& timer) {
+		                                    const auto& entry = m_entries[timer.threadId];
+		                                    return !entry.linked || !entry.delayed || (entry.generation != timer.generation);
+	                                    });
+	m_timers.erase(timerIterator, m_timers.end());
+	std::make_heap(m_timers.begin(), m_timers.end());
+}
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include "Types.h"
+
+namespace Iop
+{
+	//Set of small ids (thread ids, priorities) that can be iterated in increasing order
+	template <uint32 BitCount>
+	class CIdBitmap
+	{
+	public:
+		enum : uint32
+		{
+			INVALID_ID = ~0U,
+		};
+
+		void Reset()
+		{
+			m_words.fill(0);
+		}
+
+		void Set(uint32 id)
+		{
+			m_words[id / 32] |= (1U << (id & 31));
+		}
+
+		void Clear(uint32 id)
+		{
+			m_words[id / 32] &= ~(1U << (id & 31));
+		}
+
+		bool Test(uint32 id) const
+		{
+			return (m_words[id / 32] & (1U << (id & 31))) != 0;
+		}
+
+		bool IsEmpty() const
+		{
+			for(auto word : m_words)
+			{
+				if(word != 0) return false;
+			}
+			return true;
+		}
+
+		//Returns the lowest id greater or equal to 'start' or INVALID_ID
+		uint32 FindFirst(uint32 start = 0) const
+		{
+			for(uint32 wordIndex = start / 32; wordIndex < WORD_COUNT; wordIndex++)
+			{
+				uint32 word = m_words[wordIndex];
+				if(wordIndex == (start / 32))
+				{
+					word &= ~((1U << (start & 31)) - 1);
+				}
+				if(word != 0)
+				{
+					return (wordIndex * 32) + LowestBit(word);
+				}
+			}
+			return INVALID_ID;
+		}
+
+		//Returns the highest id lower or equal to 'end' or INVALID_ID
+		uint32 FindLast(uint32 end) const
+		{
+			for(int32 wordIndex = end / 32; wordIndex >= 0; wordIndex--)
+			{
+				uint32 word = m_words[wordIndex];
+				if(static_cast<uint32>(wordIndex) == (end / 32))
+				{
+					uint32 shift = 31 - (end & 31);
+					word = (word << shift) >> shift;
+				}
+				if(word != 0)
+				{
+					return (wordIndex * 32) + HighestBit(word);
+				}
+			}
+			return INVALID_ID;
+		}
+
+	private:
+		enum
+		{
+			WORD_COUNT = (BitCount + 31) / 32,
+		};
+
+		static uint32 LowestBit(uint32 word)
+		{
+			uint32 result = 0;
+			while((word & 1) == 0)
+			{
+				word >>= 1;
+				result++;
+			}
+			return result;
+		}
+
+		static uint32 HighestBit(uint32 word)
+		{
+			uint32 result = 31;
+			while((word & 0x80000000) == 0)
+			{
+				word <<= 1;
+				result--;
+			}
+			return result;
+		}
+
+		std::array<uint32, WORD_COUNT> m_words = {};
+	};
+
+	//Host side index of the thread ready list kept in IOP RAM. Threads are kept in per
+	//priority FIFO segments (same order as the RAM list) and threads that are delayed
+	//until a later time are tracked in a timer heap, which makes finding the next thread
+	//to run independent of the amount of threads.
+	class CThreadReadyQueue
+	{
+	public:
+		enum
+		{
+			MAX_THREAD_ID = 0x100,
+			PRIORITY_COUNT = 0x80,
+		};
+
+		enum : uint32
+		{
+			INVALID_THREAD_ID = 0,
+		};
+
+		CThreadReadyQueue();
+
+		void Reset();
+
+		bool IsLinked(uint32) const;
+
+		//Links a thread at the end of its priority's segment. Returns the thread preceding it
+		//in the list (or INVALID_THREAD_ID if it's the new head).
+		uint32 Link(uint32 threadId, uint32 priority, uint64 activateTime, uint64 currentTime);
+
+		//Returns the thread that preceded the unlinked thread in the list (or INVALID_THREAD_ID)
+		uint32 Unlink(uint32 threadId);
+
+		uint32 GetHead() const;
+		uint32 GetNext(uint32) const;
+		uint32 GetFirstWithPriority(uint32) const;
+
+		//Returns the first thread in list order that can be activated at 'currentTime'
+		//(activation time lower than current time) or INVALID_THREAD_ID
+		uint32 FindNextReady(uint64 currentTime);
+
+	private:
+		struct TIMER
+		{
+			uint64 activateTime = 0;
+			uint32 threadId = 0;
+			uint32 generation = 0;
+
+			bool operator<(const TIMER& rhs) const
+			{
+				//Used with std heap functions, earliest timer must come first
+				return activateTime > rhs.activateTime;
+			}
+		};
+
+		struct SEGMENT
+		{
+			uint32 head = INVALID_THREAD_ID;
+			uint32 tail = INVALID_THREAD_ID;
+			uint32 readyCount = 0;
+		};
+
+		struct ENTRY
+		{
+			uint32 prev = INVALID_THREAD_ID;
+			uint32 next = INVALID_THREAD_ID;
+			uint32 priority = 0;
+			uint32 generation = 0;
+			bool linked = false;
+			bool delayed = false;
+		};
+
+		static uint32 ClampPriority(uint32);
+		void MarkReady(uint32);
+		void CompactTimers();
+
+		std::array<ENTRY, MAX_THREAD_ID> m_entries;
+		std::array<SEGMENT, PRIORITY_COUNT> m_segments;
+		CIdBitmap<PRIORITY_COUNT> m_linkedPriorities;
+		CIdBitmap<PRIORITY_COUNT> m_readyPriorities;
+		std::vector<TIMER> m_timers;
+	};
+
+	//Threads waiting on a kernel object. Entries are validated when the object is signaled
+	//(threads leaving the wait state through other means are not removed right away) and
+	//are visited in increasing id order, same as iterating over all threads.
+	typedef CIdBitmap<CThreadReadyQueue::MAX_THREAD_ID> ThreadWaitList;
+}
@@ -132,17 +132,28 @@ std::string timeToString(const tm* timeInfo)
 	return std::string(output);
 }
 
-CAmazonS3Client::CAmazonS3Client(std::string accessKeyId, std::string secretAccessKey, std::string region)
+CAmazonS3Client::CAmazonS3Client(std::string accessKeyId, std::string secretAccessKey, std::string region, std::string endpoint)
     : m_accessKeyId(std::move(accessKeyId))
     , m_secretAccessKey(std::move(secretAccessKey))
     , m_region(std::move(region))
 {
+	if(!endpoint.empty())
+	{
+		auto schemeEnd = endpoint.find("://");
+		m_endpointScheme = (schemeEnd != std::string::npos) ? endpoint.substr(0, schemeEnd) : "https";
+		m_endpointHost = (schemeEnd != std::string::npos) ? endpoint.substr(schemeEnd + 3) : endpoint;
+		while(!m_endpointHost.empty() && (m_endpointHost.back() == '/'))
+		{
+			m_endpointHost.pop_back();
+		}
+	}
 }
 
 GetBucketLocationResult CAmazonS3Client::GetBucketLocation(const GetBucketLocationRequest& request)
 {
 	Request rq;
 	rq.method = Framework::Http::HTTP_VERB::GET;
+	rq.bucket = request.bucket;
 	rq.host = string_format("%s." S3_HOSTNAME, request.bucket.c_str());
 	rq.urlHost = S3_HOSTNAME;
 	rq.uri = "/";
@@ -171,6 +182,7 @@ GetObjectResult CAmazonS3Client::GetObject(const GetObjectRequest& request)
 {
 	Request rq;
 	rq.method = Framework::Http::HTTP_VERB::GET;
+	rq.bucket = request.bucket;
 	rq.uri = "/" + Framework::Http::CHttpClient::UrlEncode(request.object);
 	rq.host = string_format("%s." S3_HOSTNAME, request.bucket.c_str());
 	rq.urlHost = rq.host;
@@ -200,6 +212,7 @@ HeadObjectResult CAmazonS3Client::HeadObject(const HeadObjectRequest& request)
 {
 	Request rq;
 	rq.method = Framework::Http::HTTP_VERB::HEAD;
+	rq.bucket = request.bucket;
 	rq.uri = "/" + Framework::Http::CHttpClient::UrlEncode(request.object);
 	rq.host = string_format("%s." S3_HOSTNAME, request.bucket.c_str());
 	rq.urlHost = rq.host;
@@ -232,6 +245,7 @@ ListObjectsResult CAmazonS3Client::ListObjects(std::string bucket)
 {
 	Request rq;
 	rq.method = Framework::Http::HTTP_VERB::GET;
+	rq.bucket = bucket;
 	rq.uri = "/";
 	rq.host = string_format("%s." S3_HOSTNAME, bucket.c_str());
 	rq.urlHost = rq.host;
@@ -259,12 +273,21 @@ ListObjectsResult CAmazonS3Client::ListObjects(std::string bucket)
 	return result;
 }
 
-Framework::Http::RequestResult CAmazonS3Client::ExecuteRequest(const Request& request)
+Framework::Http::RequestResult CAmazonS3Client::ExecuteRequest(const Request& inputRequest)
 {
 	assert(!m_accessKeyId.empty());
 	assert(!m_secretAccessKey.empty());
-	assert(!request.host.empty());
-	assert(!request.urlHost.empty());
+	assert(!inputRequest.host.empty());
+	assert(!inputRequest.urlHost.empty());
+
+	auto request = inputRequest;
+	if(!m_endpointHost.empty())
+	{
+		//Path-style request, bucket is part of the URI
+		request.host = m_endpointHost;
+		request.urlHost = m_endpointHost;
+		request.uri = "/" + request.bucket + request.uri;
+	}
 
 	time_t rawTime;
 	time(&rawTime);
@@ -303,7 +326,8 @@ Framework::Http::RequestResult CAmazonS3Client::ExecuteRequest(const Request& re
 	headers.insert(std::make_pair("Authorization", authorizationString));
 	headers.insert(request.headers.begin(), request.headers.end());
 
-	auto url = string_format("https://%s%s", request.urlHost.c_str(), request.uri.c_str());
+	auto scheme = m_endpointScheme.empty() ? std::string("https") : m_endpointScheme;
+	auto url = string_format("%s://%s%s", scheme.c_str(), request.urlHost.c_str(), request.uri.c_str());
 	if(!request.query.empty())
 	{
 		url += "?";
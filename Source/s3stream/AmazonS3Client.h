@@ -51,7 +51,9 @@ struct ListObjectsResult
 class CAmazonS3Client
 {
 public:
-	CAmazonS3Client(std::string, std::string, std::string = "us-east-1");
+	//Endpoint is optional, it allows using a S3 compatible server (ie.: "http://localhost:9000").
+	//Buckets are then addressed using path-style requests.
+	CAmazonS3Client(std::string, std::string, std::string = "us-east-1", std::string = std::string());
 
 	GetBucketLocationResult GetBucketLocation(const GetBucketLocationRequest&);
 	GetObjectResult GetObject(const GetObjectRequest&);
@@ -62,6 +64,7 @@ private:
 	struct Request
 	{
 		Framework::Http::HTTP_VERB method;
+		std::string bucket;
 		std::string host;
 		std::string urlHost;
 		std::string uri;
@@ -74,4 +77,6 @@ private:
 	std::string m_accessKeyId;
 	std::string m_secretAccessKey;
 	std::string m_region;
+	std::string m_endpointScheme;
+	std::string m_endpointHost;
 };
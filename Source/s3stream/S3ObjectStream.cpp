@@ -1,26 +1,38 @@
+#include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <mutex>
 #include "S3ObjectStream.h"
+#include "S3ReadCache.h"
 #include "AmazonS3Client.h"
 #include "Singleton.h"
 #include "AppConfig.h"
 #include "PathUtils.h"
 #include "string_format.h"
-#include "StdStreamUtils.h"
 #include "Log.h"
 
 #define PREF_S3_OBJECTSTREAM_ACCESSKEYID "s3.objectstream.accesskeyid"
 #define PREF_S3_OBJECTSTREAM_SECRETACCESSKEY "s3.objectstream.secretaccesskey"
+#define PREF_S3_OBJECTSTREAM_ENDPOINT "s3.objectstream.endpoint"
+#define PREF_S3_OBJECTSTREAM_READCACHESIZE "s3.objectstream.readcachesize"
 #define CACHE_PATH "Play Data Files/s3objectstream_cache"
+#define READCACHE_FILENAME "blocks.cache"
 
 #define LOG_NAME "s3objectstream"
 
-#define BUFFERSIZE 0x40000
+#define BLOCKSIZE 0x40000
+#define DEFAULT_READCACHE_SIZE_MB 1024
+#define FETCH_THREAD_COUNT 4
+#define READAHEAD_BLOCK_COUNT 8
+#define MAX_PENDING_BLOCKS 16
+#define RECENT_BLOCK_COUNT 32
 
 CS3ObjectStream::CConfig::CConfig()
 {
 	CAppConfig::GetInstance().RegisterPreferenceString(PREF_S3_OBJECTSTREAM_ACCESSKEYID, "");
 	CAppConfig::GetInstance().RegisterPreferenceString(PREF_S3_OBJECTSTREAM_SECRETACCESSKEY, "");
+	CAppConfig::GetInstance().RegisterPreferenceString(PREF_S3_OBJECTSTREAM_ENDPOINT, "");
+	CAppConfig::GetInstance().RegisterPreferenceInteger(PREF_S3_OBJECTSTREAM_READCACHESIZE, DEFAULT_READCACHE_SIZE_MB);
 }
 
 std::string CS3ObjectStream::CConfig::GetAccessKeyId()
@@ -33,13 +45,34 @@ std::string CS3ObjectStream::CConfig::GetSecretAccessKey()
 	return CAppConfig::GetInstance().GetPreferenceString(PREF_S3_OBJECTSTREAM_SECRETACCESSKEY);
 }
 
+std::string CS3ObjectStream::CConfig::GetEndpoint()
+{
+	return CAppConfig::GetInstance().GetPreferenceString(PREF_S3_OBJECTSTREAM_ENDPOINT);
+}
+
+uint64 CS3ObjectStream::CConfig::GetReadCacheSize()
+{
+	int sizeMb = CAppConfig::GetInstance().GetPreferenceInteger(PREF_S3_OBJECTSTREAM_READCACHESIZE);
+	return static_cast<uint64>(std::max(sizeMb, 0)) * 1024 * 1024;
+}
+
 CS3ObjectStream::CS3ObjectStream(const char* bucketName, const char* objectName)
-    : m_bucketName(bucketName)
-    , m_objectName(objectName)
 {
-	m_buffer.resize(BUFFERSIZE);
 	Framework::PathUtils::EnsurePathExists(GetCachePath());
+	auto objectInfo = std::make_shared<OBJECTINFO>();
+	objectInfo->bucketName = bucketName;
+	objectInfo->objectName = objectName;
+	m_objectInfo = objectInfo;
 	GetObjectInfo();
+	m_readCache = GetReadCache();
+	m_fetchThreadPool = std::make_unique<Framework::CThreadPool>(FETCH_THREAD_COUNT);
+}
+
+CS3ObjectStream::~CS3ObjectStream()
+{
+	//Fetches that haven't started yet are skipped, only the ones in progress are waited on
+	*m_fetchCancelled = true;
+	m_fetchThreadPool.reset();
 }
 
 uint64 CS3ObjectStream::Read(void* buffer, uint64 size)
@@ -49,27 +82,29 @@ uint64 CS3ObjectStream::Read(void* buffer, uint64 size)
 	uint64 adjSize = std::min(size, m_objectSize - m_objectPosition);
 	auto outBuffer = reinterpret_cast<uint8*>(buffer);
 
-	while(adjSize != 0)
+	if(adjSize != 0)
 	{
-		//Read if we're inside buffer size
-		if((m_bufferPosition / BUFFERSIZE) == (m_objectPosition / BUFFERSIZE))
-		{
-			uint64 bufferOffset = m_objectPosition % BUFFERSIZE;
-			uint64 remainSize = BUFFERSIZE - bufferOffset;
-			assert(remainSize <= BUFFERSIZE);
-			auto copySize = std::min(remainSize, adjSize);
-			assert(copySize <= adjSize);
-			memcpy(outBuffer, m_buffer.data() + bufferOffset, copySize);
-			m_objectPosition += copySize;
-			outBuffer += copySize;
-			adjSize -= copySize;
-		}
-		else
+		//Get all blocks covered by large reads in flight before waiting on the first one
+		uint64 firstBlockIndex = m_objectPosition / BLOCKSIZE;
+		uint64 lastBlockIndex = (m_objectPosition + adjSize - 1) / BLOCKSIZE;
+		if(firstBlockIndex != lastBlockIndex)
 		{
-			SyncBuffer();
+			RequestBlocks(firstBlockIndex + 1, lastBlockIndex + 1);
 		}
 	}
 
+	while(adjSize != 0)
+	{
+		auto block = GetBlock(m_objectPosition / BLOCKSIZE);
+		uint64 blockOffset = m_objectPosition % BLOCKSIZE;
+		assert(blockOffset < block->size());
+		auto copySize = std::min<uint64>(block->size() - blockOffset, adjSize);
+		memcpy(outBuffer, block->data() + blockOffset, copySize);
+		m_objectPosition += copySize;
+		outBuffer += copySize;
+		adjSize -= copySize;
+	}
+
 	assert(m_objectPosition <= m_objectSize);
 	return size;
 }
@@ -111,9 +146,37 @@ fs::path CS3ObjectStream::GetCachePath()
 	return Framework::PathUtils::GetCachePath() / CACHE_PATH;
 }
 
-std::string CS3ObjectStream::GenerateReadCacheKey(const std::pair<uint64, uint64>& range) const
+CS3ObjectStream::ReadCachePtr CS3ObjectStream::GetReadCache()
 {
-	return string_format("%s-%llu-%llu", m_objectEtag.c_str(), range.first, range.second);
+	//Cache file is shared by all streams
+	static std::mutex readCacheMutex;
+	static std::weak_ptr<CS3ReadCache> sharedReadCache;
+
+	std::lock_guard<std::mutex> readCacheLock(readCacheMutex);
+	auto readCache = sharedReadCache.lock();
+	if(readCache) return readCache;
+
+	uint64 readCacheSize = CConfig::GetInstance().GetReadCacheSize();
+	if(readCacheSize < BLOCKSIZE) return ReadCachePtr();
+
+	//Remove files left by older versions that used one file per range
+	{
+		std::error_code errorCode;
+		std::vector<fs::path> legacyCachePaths;
+		for(const auto& entry : fs::directory_iterator(GetCachePath(), errorCode))
+		{
+			if(entry.path().filename() == READCACHE_FILENAME) continue;
+			legacyCachePaths.push_back(entry.path());
+		}
+		for(const auto& legacyCachePath : legacyCachePaths)
+		{
+			fs::remove(legacyCachePath, errorCode);
+		}
+	}
+
+	readCache = std::make_shared<CS3ReadCache>(GetCachePath() / READCACHE_FILENAME, BLOCKSIZE, readCacheSize);
+	sharedReadCache = readCache;
+	return readCache;
 }
 
 static std::string TrimQuotes(std::string input)
@@ -133,86 +196,188 @@ static std::string TrimQuotes(std::string input)
 
 void CS3ObjectStream::GetObjectInfo()
 {
+	auto objectInfo = std::make_shared<OBJECTINFO>(*m_objectInfo);
+	auto endpoint = CConfig::GetInstance().GetEndpoint();
+
 	//Obtain bucket region
 	{
-		CAmazonS3Client client(CConfig::GetInstance().GetAccessKeyId(), CConfig::GetInstance().GetSecretAccessKey());
+		CAmazonS3Client client(CConfig::GetInstance().GetAccessKeyId(), CConfig::GetInstance().GetSecretAccessKey(), "us-east-1", endpoint);
 
 		GetBucketLocationRequest request;
-		request.bucket = m_bucketName;
+		request.bucket = objectInfo->bucketName;
 
 		auto result = client.GetBucketLocation(request);
-		m_bucketRegion = result.locationConstraint;
+		objectInfo->bucketRegion = result.locationConstraint;
 	}
 
 	//Obtain object info
 	{
-		CAmazonS3Client client(CConfig::GetInstance().GetAccessKeyId(), CConfig::GetInstance().GetSecretAccessKey(), m_bucketRegion);
+		CAmazonS3Client client(CConfig::GetInstance().GetAccessKeyId(), CConfig::GetInstance().GetSecretAccessKey(), objectInfo->bucketRegion, endpoint);
 
 		HeadObjectRequest request;
-		request.bucket = m_bucketName;
-		request.object = m_objectName;
+		request.bucket = objectInfo->bucketName;
+		request.object = objectInfo->objectName;
 
 		auto objectHeader = client.HeadObject(request);
-		m_objectSize = objectHeader.contentLength;
-		m_objectEtag = TrimQuotes(objectHeader.etag);
+		objectInfo->objectSize = objectHeader.contentLength;
+		objectInfo->objectEtag = TrimQuotes(objectHeader.etag);
 	}
+
+	objectInfo->cacheKey = string_format("%s/%s/%s", objectInfo->bucketName.c_str(), objectInfo->objectName.c_str(), objectInfo->objectEtag.c_str());
+	m_objectSize = objectInfo->objectSize;
+	m_objectInfo = objectInfo;
 }
 
-void CS3ObjectStream::SyncBuffer()
+CS3ObjectStream::BlockPtr CS3ObjectStream::GetBlock(uint64 blockIndex)
 {
-	m_bufferPosition = (m_objectPosition / BUFFERSIZE) * BUFFERSIZE;
+	CollectCompletedBlocks();
 
-	uint64 size = std::min<uint64>(BUFFERSIZE, m_objectSize - m_bufferPosition);
-	auto range = std::make_pair(m_bufferPosition, m_bufferPosition + size - 1);
-	auto readCacheFilePath = GetCachePath() / GenerateReadCacheKey(range);
+	//Keep blocks ahead of sequential reads in flight
+	bool sequential = (blockIndex == m_lastBlockIndex) || (blockIndex == (m_lastBlockIndex + 1));
+	m_lastBlockIndex = blockIndex;
+	if(sequential)
+	{
+		RequestBlocks(blockIndex + 1, blockIndex + 1 + READAHEAD_BLOCK_COUNT);
+	}
 
-#ifdef _TRACEGET
-	static FILE* output = fopen("getobject.log", "wb");
-	fprintf(output, "%ld,%ld,%ld\r\n", range.first, range.second, size);
-	fflush(output);
-#endif
+	auto recentBlockIterator = m_recentBlocksIndex.find(blockIndex);
+	if(recentBlockIterator != std::end(m_recentBlocksIndex))
+	{
+		m_recentBlocks.splice(m_recentBlocks.begin(), m_recentBlocks, recentBlockIterator->second);
+		return m_recentBlocks.front().second;
+	}
 
-	bool cachedReadSucceeded =
-	    [&]() {
-		    try
-		    {
-			    if(fs::exists(readCacheFilePath))
+	BlockPtr block;
+	auto pendingBlockIterator = m_pendingBlocks.find(blockIndex);
+	if(pendingBlockIterator != std::end(m_pendingBlocks))
+	{
+		auto blockFuture = pendingBlockIterator->second;
+		m_pendingBlocks.erase(pendingBlockIterator);
+		try
+		{
+			block = blockFuture.get();
+		}
+		catch(const std::exception& exception)
+		{
+			CLog::GetInstance().Print(LOG_NAME, "Failed to prefetch block, retrying: '%s'.\r\n", exception.what());
+		}
+	}
+	if(!block)
+	{
+		//Not fetched ahead or the fetch failed, load right away instead of waiting behind other fetches
+		block = LoadBlock(*m_objectInfo, m_readCache, blockIndex);
+	}
+
+	InsertRecentBlock(blockIndex, block);
+	return block;
+}
+
+void CS3ObjectStream::RequestBlocks(uint64 beginBlockIndex, uint64 endBlockIndex)
+{
+	uint64 blockCount = (m_objectSize + BLOCKSIZE - 1) / BLOCKSIZE;
+	endBlockIndex = std::min(endBlockIndex, blockCount);
+	for(uint64 blockIndex = beginBlockIndex; blockIndex < endBlockIndex; blockIndex++)
+	{
+		if(m_pendingBlocks.size() >= MAX_PENDING_BLOCKS) break;
+		if(m_recentBlocksIndex.find(blockIndex) != std::end(m_recentBlocksIndex)) continue;
+		if(m_pendingBlocks.find(blockIndex) != std::end(m_pendingBlocks)) continue;
+
+		auto promise = std::make_shared<std::promise<BlockPtr>>();
+		m_pendingBlocks.insert(std::make_pair(blockIndex, promise->get_future().share()));
+		m_fetchThreadPool->Enqueue(
+		    [promise, objectInfo = m_objectInfo, readCache = m_readCache, fetchCancelled = m_fetchCancelled, blockIndex]() {
+			    try
+			    {
+				    if(*fetchCancelled)
+				    {
+					    throw std::runtime_error("Fetch cancelled.");
+				    }
+				    promise->set_value(LoadBlock(*objectInfo, readCache, blockIndex));
+			    }
+			    catch(...)
 			    {
-				    auto readCacheFileStream = Framework::CreateInputStdStream(readCacheFilePath.native());
-				    auto cacheRead = readCacheFileStream.Read(m_buffer.data(), size);
-				    assert(cacheRead == size);
-				    return true;
+				    promise->set_exception(std::current_exception());
 			    }
-		    }
-		    catch(const std::exception& exception)
-		    {
-			    //Not a problem if we failed to read cache
-			    CLog::GetInstance().Print(LOG_NAME, "Failed to read cache: '%s'.\r\n", exception.what());
-		    }
-		    return false;
-	    }();
-
-	if(!cachedReadSucceeded)
-	{
-		assert(size > 0);
-		CAmazonS3Client client(CConfig::GetInstance().GetAccessKeyId(), CConfig::GetInstance().GetSecretAccessKey(), m_bucketRegion);
-		GetObjectRequest request;
-		request.object = m_objectName;
-		request.bucket = m_bucketName;
-		request.range = range;
-		auto objectContent = client.GetObject(request);
-		assert(objectContent.data.size() == size);
-		memcpy(m_buffer.data(), objectContent.data.data(), size);
+		    });
+	}
+}
 
+void CS3ObjectStream::CollectCompletedBlocks()
+{
+	for(auto pendingBlockIterator = m_pendingBlocks.begin(); pendingBlockIterator != m_pendingBlocks.end();)
+	{
+		const auto& blockFuture = pendingBlockIterator->second;
+		if(blockFuture.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			pendingBlockIterator++;
+			continue;
+		}
 		try
 		{
-			auto readCacheFileStream = Framework::CreateOutputStdStream(readCacheFilePath.native());
-			readCacheFileStream.Write(objectContent.data.data(), size);
+			InsertRecentBlock(pendingBlockIterator->first, blockFuture.get());
 		}
 		catch(const std::exception& exception)
 		{
-			//Not a problem if we failed to write cache
-			CLog::GetInstance().Print(LOG_NAME, "Failed to write cache: '%s'.\r\n", exception.what());
+			//Will be fetched again if it's needed
+			CLog::GetInstance().Print(LOG_NAME, "Failed to prefetch block: '%s'.\r\n", exception.what());
 		}
+		pendingBlockIterator = m_pendingBlocks.erase(pendingBlockIterator);
+	}
+}
+
+void CS3ObjectStream::InsertRecentBlock(uint64 blockIndex, BlockPtr block)
+{
+	assert(m_recentBlocksIndex.find(blockIndex) == std::end(m_recentBlocksIndex));
+	m_recentBlocks.emplace_front(blockIndex, std::move(block));
+	m_recentBlocksIndex[blockIndex] = m_recentBlocks.begin();
+	while(m_recentBlocks.size() > RECENT_BLOCK_COUNT)
+	{
+		m_recentBlocksIndex.erase(m_recentBlocks.back().first);
+		m_recentBlocks.pop_back();
+	}
+}
+
+CS3ObjectStream::BlockPtr CS3ObjectStream::LoadBlock(const OBJECTINFO& objectInfo, const ReadCachePtr& readCache, uint64 blockIndex)
+{
+	uint64 blockPosition = blockIndex * BLOCKSIZE;
+	assert(blockPosition < objectInfo.objectSize);
+	uint32 size = static_cast<uint32>(std::min<uint64>(BLOCKSIZE, objectInfo.objectSize - blockPosition));
+
+	auto block = std::make_shared<Block>(size);
+	if(readCache && readCache->Read(objectInfo.cacheKey, blockIndex, block->data(), size))
+	{
+		return block;
+	}
+
+	FetchRange(objectInfo, std::make_pair(blockPosition, blockPosition + size - 1), block->data());
+	if(readCache)
+	{
+		readCache->Write(objectInfo.cacheKey, blockIndex, block->data(), size);
+	}
+	return block;
+}
+
+void CS3ObjectStream::FetchRange(const OBJECTINFO& objectInfo, const std::pair<uint64, uint64>& range, uint8* outBuffer)
+{
+	uint64 size = range.second - range.first + 1;
+	assert(size > 0);
+
+#ifdef _TRACEGET
+	static FILE* output = fopen("getobject.log", "wb");
+	fprintf(output, "%ld,%ld,%ld\r\n", range.first, range.second, size);
+	fflush(output);
+#endif
+
+	CAmazonS3Client client(CConfig::GetInstance().GetAccessKeyId(), CConfig::GetInstance().GetSecretAccessKey(),
+	                       objectInfo.bucketRegion, CConfig::GetInstance().GetEndpoint());
+	GetObjectRequest request;
+	request.object = objectInfo.objectName;
+	request.bucket = objectInfo.bucketName;
+	request.range = range;
+	auto objectContent = client.GetObject(request);
+	if(objectContent.data.size() < size)
+	{
+		throw std::runtime_error("Received less data than requested.");
 	}
+	memcpy(outBuffer, objectContent.data.data(), size);
 }
@@ -1,10 +1,19 @@
 #pragma once
 
+#include <atomic>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 #include "Singleton.h"
 #include "Stream.h"
+#include "ThreadPool.h"
 #include "filesystem_def.h"
 
+class CS3ReadCache;
+
 class CS3ObjectStream : public Framework::CStream
 {
 public:
@@ -14,9 +23,12 @@ public:
 		CConfig();
 		std::string GetAccessKeyId();
 		std::string GetSecretAccessKey();
+		std::string GetEndpoint();
+		uint64 GetReadCacheSize();
 	};
 
 	CS3ObjectStream(const char*, const char*);
+	virtual ~CS3ObjectStream();
 
 	uint64 Read(void*, uint64) override;
 	uint64 Write(const void*, uint64) override;
@@ -25,21 +37,52 @@ public:
 	bool IsEOF() override;
 
 private:
+	struct OBJECTINFO
+	{
+		std::string bucketName;
+		std::string bucketRegion;
+		std::string objectName;
+		uint64 objectSize = 0;
+		std::string objectEtag;
+		std::string cacheKey;
+	};
+	typedef std::shared_ptr<const OBJECTINFO> ObjectInfoPtr;
+
+	typedef std::vector<uint8> Block;
+	typedef std::shared_ptr<const Block> BlockPtr;
+	typedef std::shared_future<BlockPtr> BlockFuture;
+	typedef std::map<uint64, BlockFuture> PendingBlockMap;
+	typedef std::list<std::pair<uint64, BlockPtr>> BlockList;
+	typedef std::unordered_map<uint64, BlockList::iterator> BlockListIndex;
+	typedef std::shared_ptr<CS3ReadCache> ReadCachePtr;
+
 	static fs::path GetCachePath();
-	std::string GenerateReadCacheKey(const std::pair<uint64, uint64>&) const;
+	static ReadCachePtr GetReadCache();
 	void GetObjectInfo();
-	void SyncBuffer();
 
-	std::string m_bucketName;
-	std::string m_bucketRegion;
-	std::string m_objectName;
+	BlockPtr GetBlock(uint64);
+	void RequestBlocks(uint64, uint64);
+	void CollectCompletedBlocks();
+	void InsertRecentBlock(uint64, BlockPtr);
 
-	//Object Metadata
-	uint64 m_objectSize = 0;
-	std::string m_objectEtag;
+	static BlockPtr LoadBlock(const OBJECTINFO&, const ReadCachePtr&, uint64);
+	static void FetchRange(const OBJECTINFO&, const std::pair<uint64, uint64>&, uint8*);
 
+	ObjectInfoPtr m_objectInfo;
+	uint64 m_objectSize = 0;
 	uint64 m_objectPosition = 0;
 
-	std::vector<uint8> m_buffer;
-	uint64 m_bufferPosition = ~0ULL;
+	ReadCachePtr m_readCache;
+
+	//Blocks being fetched by the thread pool
+	PendingBlockMap m_pendingBlocks;
+
+	//Most recently used blocks, front is the most recent
+	BlockList m_recentBlocks;
+	BlockListIndex m_recentBlocksIndex;
+
+	uint64 m_lastBlockIndex = ~0ULL;
+
+	std::shared_ptr<std::atomic<bool>> m_fetchCancelled = std::make_shared<std::atomic<bool>>(false);
+	std::unique_ptr<Framework::CThreadPool> m_fetchThreadPool;
 };
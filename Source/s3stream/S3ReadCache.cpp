@@ -0,0 +1,255 @@
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+#include "S3ReadCache.h"
+#include "StdStreamUtils.h"
+#include "Log.h"
+
+#define LOG_NAME "s3readcache"
+
+CS3ReadCache::CS3ReadCache(const fs::path& path, uint32 blockSize, uint64 maxSize)
+    : m_path(path)
+    , m_blockSize(blockSize)
+{
+	assert(blockSize != 0);
+	m_slotCount = static_cast<uint32>(std::min<uint64>(maxSize / blockSize, UINT32_MAX));
+	try
+	{
+		Open();
+	}
+	catch(const std::exception& exception)
+	{
+		//Cache file might be corrupted or from an older version, start over
+		CLog::GetInstance().Print(LOG_NAME, "Failed to open cache, recreating it: '%s'.\r\n", exception.what());
+		Create();
+	}
+}
+
+CS3ReadCache::~CS3ReadCache()
+{
+	try
+	{
+		FlushIndex();
+	}
+	catch(const std::exception& exception)
+	{
+		CLog::GetInstance().Print(LOG_NAME, "Failed to flush cache index: '%s'.\r\n", exception.what());
+	}
+}
+
+uint32 CS3ReadCache::GetBlockSize() const
+{
+	return m_blockSize;
+}
+
+uint32 CS3ReadCache::GetSlotCount() const
+{
+	return m_slotCount;
+}
+
+bool CS3ReadCache::Read(const std::string& objectKey, uint64 blockIndex, uint8* buffer, uint32 size)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if(!m_stream) return false;
+
+	auto slotIterator = m_slots.find(std::make_pair(HashObjectKey(objectKey), blockIndex));
+	if(slotIterator == std::end(m_slots)) return false;
+
+	uint32 slotIndex = slotIterator->second;
+	auto& indexEntry = m_index[slotIndex];
+	if(indexEntry.size != size) return false;
+
+	try
+	{
+		m_stream->Seek(GetSlotOffset(slotIndex), Framework::STREAM_SEEK_SET);
+		if(m_stream->Read(buffer, size) != size)
+		{
+			throw std::runtime_error("Unexpected end of cache file.");
+		}
+	}
+	catch(const std::exception& exception)
+	{
+		//Not a problem if we failed to read cache
+		CLog::GetInstance().Print(LOG_NAME, "Failed to read cache: '%s'.\r\n", exception.what());
+		return false;
+	}
+
+	//Usage is only saved when the cache is closed, losing it is harmless
+	indexEntry.lastUse = ++m_useCounter;
+	m_indexDirty = true;
+	return true;
+}
+
+void CS3ReadCache::Write(const std::string& objectKey, uint64 blockIndex, const uint8* buffer, uint32 size)
+{
+	assert(size <= m_blockSize);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if(!m_stream || (m_slotCount == 0)) return;
+
+	auto blockKey = std::make_pair(HashObjectKey(objectKey), blockIndex);
+	auto slotIterator = m_slots.find(blockKey);
+	uint32 slotIndex = (slotIterator != std::end(m_slots)) ? slotIterator->second : AllocateSlot();
+
+	auto& indexEntry = m_index[slotIndex];
+	try
+	{
+		//Mark slot as free while its data is being replaced
+		if(indexEntry.size != 0)
+		{
+			m_slots.erase(std::make_pair(indexEntry.objectHash, indexEntry.blockIndex));
+			indexEntry = INDEXENTRY();
+			WriteIndexEntry(slotIndex);
+		}
+
+		m_stream->Seek(GetSlotOffset(slotIndex), Framework::STREAM_SEEK_SET);
+		m_stream->Write(buffer, size);
+
+		indexEntry.objectHash = blockKey.first;
+		indexEntry.blockIndex = blockKey.second;
+		indexEntry.size = size;
+		indexEntry.lastUse = ++m_useCounter;
+		WriteIndexEntry(slotIndex);
+		m_stream->Flush();
+
+		m_slots[blockKey] = slotIndex;
+	}
+	catch(const std::exception& exception)
+	{
+		//Not a problem if we failed to write cache
+		CLog::GetInstance().Print(LOG_NAME, "Failed to write cache: '%s'.\r\n", exception.what());
+	}
+}
+
+uint64 CS3ReadCache::HashObjectKey(const std::string& objectKey)
+{
+	//FNV-1a
+	uint64 hash = 0xCBF29CE484222325ULL;
+	for(auto character : objectKey)
+	{
+		hash = (hash ^ static_cast<uint8>(character)) * 0x100000001B3ULL;
+	}
+	return hash;
+}
+
+void CS3ReadCache::Open()
+{
+	if(!fs::exists(m_path))
+	{
+		Create();
+		return;
+	}
+
+	m_stream = std::make_unique<Framework::CStdStream>(Framework::CreateUpdateExistingStdStream(m_path.native()));
+
+	HEADER header = {};
+	if(m_stream->Read(&header, sizeof(HEADER)) != sizeof(HEADER))
+	{
+		throw std::runtime_error("Failed to read cache header.");
+	}
+	if(
+	    (header.magic != CACHE_MAGIC) || (header.version != CACHE_VERSION) ||
+	    (header.blockSize != m_blockSize) || (header.slotCount != m_slotCount))
+	{
+		throw std::runtime_error("Cache parameters have changed.");
+	}
+
+	m_index.resize(m_slotCount);
+	uint64 indexSize = sizeof(INDEXENTRY) * static_cast<uint64>(m_slotCount);
+	if(m_stream->Read(m_index.data(), indexSize) != indexSize)
+	{
+		throw std::runtime_error("Failed to read cache index.");
+	}
+
+	m_slots.clear();
+	m_useCounter = 0;
+	for(uint32 slotIndex = 0; slotIndex < m_slotCount; slotIndex++)
+	{
+		auto& indexEntry = m_index[slotIndex];
+		if(indexEntry.size == 0) continue;
+		if(indexEntry.size > m_blockSize)
+		{
+			indexEntry = INDEXENTRY();
+			continue;
+		}
+		m_slots[std::make_pair(indexEntry.objectHash, indexEntry.blockIndex)] = slotIndex;
+		m_useCounter = std::max(m_useCounter, indexEntry.lastUse);
+	}
+}
+
+void CS3ReadCache::Create()
+{
+	m_stream.reset();
+	m_index.clear();
+	m_slots.clear();
+	m_useCounter = 0;
+	m_indexDirty = false;
+
+	try
+	{
+		{
+			auto stream = Framework::CreateOutputStdStream(m_path.native());
+
+			HEADER header = {};
+			header.magic = CACHE_MAGIC;
+			header.version = CACHE_VERSION;
+			header.blockSize = m_blockSize;
+			header.slotCount = m_slotCount;
+			stream.Write(&header, sizeof(HEADER));
+
+			//Data area is left sparse, it will grow as slots are used
+			m_index.resize(m_slotCount);
+			stream.Write(m_index.data(), sizeof(INDEXENTRY) * static_cast<uint64>(m_slotCount));
+		}
+		m_stream = std::make_unique<Framework::CStdStream>(Framework::CreateUpdateExistingStdStream(m_path.native()));
+	}
+	catch(const std::exception& exception)
+	{
+		//Cache won't be used
+		CLog::GetInstance().Print(LOG_NAME, "Failed to create cache: '%s'.\r\n", exception.what());
+		m_stream.reset();
+		m_index.clear();
+	}
+}
+
+uint32 CS3ReadCache::AllocateSlot()
+{
+	assert(m_slotCount != 0);
+	uint32 oldestSlotIndex = 0;
+	for(uint32 slotIndex = 0; slotIndex < m_slotCount; slotIndex++)
+	{
+		const auto& indexEntry = m_index[slotIndex];
+		if(indexEntry.size == 0) return slotIndex;
+		if(indexEntry.lastUse < m_index[oldestSlotIndex].lastUse)
+		{
+			oldestSlotIndex = slotIndex;
+		}
+	}
+	return oldestSlotIndex;
+}
+
+uint64 CS3ReadCache::GetIndexEntryOffset(uint32 slotIndex) const
+{
+	return sizeof(HEADER) + (sizeof(INDEXENTRY) * static_cast<uint64>(slotIndex));
+}
+
+uint64 CS3ReadCache::GetSlotOffset(uint32 slotIndex) const
+{
+	return GetIndexEntryOffset(m_slotCount) + (static_cast<uint64>(m_blockSize) * slotIndex);
+}
+
+void CS3ReadCache::WriteIndexEntry(uint32 slotIndex)
+{
+	m_stream->Seek(GetIndexEntryOffset(slotIndex), Framework::STREAM_SEEK_SET);
+	m_stream->Write(&m_index[slotIndex], sizeof(INDEXENTRY));
+}
+
+void CS3ReadCache::FlushIndex()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if(!m_stream || !m_indexDirty) return;
+	m_stream->Seek(GetIndexEntryOffset(0), Framework::STREAM_SEEK_SET);
+	m_stream->Write(m_index.data(), sizeof(INDEXENTRY) * static_cast<uint64>(m_slotCount));
+	m_indexDirty = false;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Types.h"
+#include "StdStream.h"
+#include "filesystem_def.h"
+
+//Keeps blocks of S3 objects in a single file with a fixed number of slots, least
+//recently used blocks are replaced once the file is full. Can be used from multiple
+//threads, but the file shouldn't be shared by more than one process.
+class CS3ReadCache
+{
+public:
+	CS3ReadCache(const fs::path&, uint32, uint64);
+	~CS3ReadCache();
+
+	CS3ReadCache(const CS3ReadCache&) = delete;
+	CS3ReadCache& operator=(const CS3ReadCache&) = delete;
+
+	uint32 GetBlockSize() const;
+	uint32 GetSlotCount() const;
+
+	bool Read(const std::string&, uint64, uint8*, uint32);
+	void Write(const std::string&, uint64, const uint8*, uint32);
+
+private:
+	enum
+	{
+		CACHE_MAGIC = 0x43523353, //'S3RC'
+		CACHE_VERSION = 1,
+	};
+
+#pragma pack(push, 1)
+	struct HEADER
+	{
+		uint32 magic;
+		uint32 version;
+		uint32 blockSize;
+		uint32 slotCount;
+	};
+	static_assert(sizeof(HEADER) == 16, "Size of HEADER must be 16 bytes.");
+
+	struct INDEXENTRY
+	{
+		uint64 objectHash;
+		uint64 blockIndex;
+		uint32 size;
+		uint32 reserved;
+		uint64 lastUse;
+	};
+	static_assert(sizeof(INDEXENTRY) == 32, "Size of INDEXENTRY must be 32 bytes.");
+#pragma pack(pop)
+
+	typedef std::pair<uint64, uint64> BlockKey;
+	typedef std::map<BlockKey, uint32> SlotMap;
+
+	static uint64 HashObjectKey(const std::string&);
+
+	void Open();
+	void Create();
+	uint32 AllocateSlot();
+	uint64 GetIndexEntryOffset(uint32) const;
+	uint64 GetSlotOffset(uint32) const;
+	void WriteIndexEntry(uint32);
+	void FlushIndex();
+
+	fs::path m_path;
+	uint32 m_blockSize = 0;
+	uint32 m_slotCount = 0;
+
+	std::mutex m_mutex;
+	std::unique_ptr<Framework::CStdStream> m_stream;
+	std::vector<INDEXENTRY> m_index;
+	SlotMap m_slots;
+	uint64 m_useCounter = 0;
+	bool m_indexDirty = false;
+};
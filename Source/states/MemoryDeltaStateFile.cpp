@@ -0,0 +1,75 @@
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include "MemoryDeltaStateFile.h"
+
+CMemoryDeltaStateFile::CMemoryDeltaStateFile(const char* name, const void* memory, size_t size, uint32 pageSize, const PageBitmap& dirtyPages)
+    : CZipFile(name)
+    , m_memory(memory)
+    , m_size(size)
+    , m_pageSize(pageSize)
+    , m_dirtyPages(dirtyPages)
+{
+	assert(m_dirtyPages.size() == ((m_size + m_pageSize - 1) / m_pageSize));
+}
+
+void CMemoryDeltaStateFile::Write(Framework::CStream& stream)
+{
+	HEADER header = {};
+	header.magic = DELTA_MAGIC;
+	header.memorySize = static_cast<uint32>(m_size);
+	header.pageSize = m_pageSize;
+	header.pageCount = static_cast<uint32>(m_dirtyPages.size());
+	stream.Write(&header, sizeof(HEADER));
+	stream.Write(m_dirtyPages.data(), m_dirtyPages.size());
+
+	auto memory = reinterpret_cast<const uint8*>(m_memory);
+	for(size_t pageIndex = 0; pageIndex < m_dirtyPages.size(); pageIndex++)
+	{
+		if(!m_dirtyPages[pageIndex]) continue;
+		size_t pageOffset = pageIndex * m_pageSize;
+		size_t pageSize = std::min<size_t>(m_pageSize, m_size - pageOffset);
+		stream.Write(memory + pageOffset, pageSize);
+	}
+}
+
+void CMemoryDeltaStateFile::Apply(uint8* memory, size_t size, const uint8* delta, size_t deltaSize)
+{
+	if(deltaSize < sizeof(HEADER))
+	{
+		throw std::runtime_error("Memory delta is too small.");
+	}
+
+	HEADER header = {};
+	memcpy(&header, delta, sizeof(HEADER));
+	if(header.magic != DELTA_MAGIC)
+	{
+		throw std::runtime_error("Invalid memory delta.");
+	}
+	if((header.memorySize != size) || (header.pageSize == 0) ||
+	   (header.pageCount != ((size + header.pageSize - 1) / header.pageSize)))
+	{
+		throw std::runtime_error("Memory delta doesn't match memory region.");
+	}
+
+	size_t dataOffset = sizeof(HEADER) + header.pageCount;
+	if(deltaSize < dataOffset)
+	{
+		throw std::runtime_error("Memory delta is truncated.");
+	}
+
+	const uint8* dirtyPages = delta + sizeof(HEADER);
+	for(uint32 pageIndex = 0; pageIndex < header.pageCount; pageIndex++)
+	{
+		if(!dirtyPages[pageIndex]) continue;
+		size_t pageOffset = static_cast<size_t>(pageIndex) * header.pageSize;
+		size_t pageSize = std::min<size_t>(header.pageSize, size - pageOffset);
+		if((dataOffset + pageSize) > deltaSize)
+		{
+			throw std::runtime_error("Memory delta is truncated.");
+		}
+		memcpy(memory + pageOffset, delta + dataOffset, pageSize);
+		dataOffset += pageSize;
+	}
+}
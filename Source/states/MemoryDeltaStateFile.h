@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+#include "Types.h"
+#include "zip/ZipFile.h"
+
+//Stores the pages of a memory region that changed since a previous checkpoint.
+//Layout: header, one byte per page (non-zero if page is present), page data.
+class CMemoryDeltaStateFile : public Framework::CZipFile
+{
+public:
+	typedef std::vector<uint8> PageBitmap;
+
+	CMemoryDeltaStateFile(const char*, const void*, size_t, uint32, const PageBitmap&);
+	virtual ~CMemoryDeltaStateFile() = default;
+
+	void Write(Framework::CStream&) override;
+
+	static void Apply(uint8*, size_t, const uint8*, size_t);
+
+private:
+	enum : uint32
+	{
+		DELTA_MAGIC = 0x544C444D, //'MDLT'
+	};
+
+	struct HEADER
+	{
+		uint32 magic;
+		uint32 memorySize;
+		uint32 pageSize;
+		uint32 pageCount;
+	};
+
+	const void* m_memory = nullptr;
+	size_t m_size = 0;
+	uint32 m_pageSize = 0;
+	PageBitmap m_dirtyPages;
+};
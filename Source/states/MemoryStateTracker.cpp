@@ -0,0 +1,77 @@
+#include <cassert>
+#include <cstring>
+#include "MemoryStateTracker.h"
+#include "MemoryStateFile.h"
+
+void CMemoryStateTracker::SetDirtyPageQuery(const void* memory, uint32 pageSize, const DirtyPageQuery& query)
+{
+	assert(pageSize != 0);
+	DIRTYPAGEQUERYINFO queryInfo;
+	queryInfo.pageSize = pageSize;
+	queryInfo.query = query;
+	m_dirtyPageQueries[memory] = queryInfo;
+}
+
+void CMemoryStateTracker::ReadMemoryFile(Framework::CZipArchiveReader& archive, const char* name, void* memory, size_t size)
+{
+	archive.BeginReadFile(name)->Read(memory, size);
+}
+
+void CMemoryStateTracker::SaveMemory(Framework::CZipArchiveWriter& archive, CMemoryStateTracker* tracker, const char* name, const void* memory, size_t size)
+{
+	if(tracker)
+	{
+		tracker->InsertMemoryFile(archive, name, memory, size);
+	}
+	else
+	{
+		archive.InsertFile(new CMemoryStateFile(name, memory, size));
+	}
+}
+
+void CMemoryStateTracker::LoadMemory(Framework::CZipArchiveReader& archive, CMemoryStateTracker* tracker, const char* name, void* memory, size_t size)
+{
+	if(tracker)
+	{
+		tracker->ReadMemoryFile(archive, name, memory, size);
+	}
+	else
+	{
+		archive.BeginReadFile(name)->Read(memory, size);
+	}
+}
+
+uint32 CMemoryStateTracker::GetPageSize(const void* memory) const
+{
+	auto queryIterator = m_dirtyPageQueries.find(memory);
+	return (queryIterator != std::end(m_dirtyPageQueries)) ? queryIterator->second.pageSize : DEFAULT_PAGE_SIZE;
+}
+
+bool CMemoryStateTracker::QueryDirtyPages(const void* memory, PageBitmap& dirtyPages)
+{
+	auto queryIterator = m_dirtyPageQueries.find(memory);
+	if(queryIterator == std::end(m_dirtyPageQueries))
+	{
+		return false;
+	}
+	return queryIterator->second.query(dirtyPages);
+}
+
+uint64 CMemoryStateTracker::HashPage(const uint8* page, size_t size)
+{
+	//FNV-1a, done on 64-bit words to keep up with large regions
+	static const uint64 FNV_PRIME = 0x100000001B3ULL;
+	uint64 hash = 0xCBF29CE484222325ULL;
+	size_t wordCount = size / sizeof(uint64);
+	for(size_t i = 0; i < wordCount; i++)
+	{
+		uint64 word = 0;
+		memcpy(&word, page + (i * sizeof(uint64)), sizeof(uint64));
+		hash = (hash ^ word) * FNV_PRIME;
+	}
+	for(size_t i = wordCount * sizeof(uint64); i < size; i++)
+	{
+		hash = (hash ^ page[i]) * FNV_PRIME;
+	}
+	return hash;
+}
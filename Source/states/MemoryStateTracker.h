@@ -0,0 +1,51 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <vector>
+#include "Types.h"
+#include "zip/ZipArchiveWriter.h"
+#include "zip/ZipArchiveReader.h"
+
+//Lets something other than the state archive decide how large memory regions
+//are saved and loaded (ie.: only saving modified pages).
+class CMemoryStateTracker
+{
+public:
+	typedef std::vector<uint8> PageBitmap;
+
+	//Fills the bitmap with pages modified since the previous call and starts tracking
+	//from the current point. Returns false if modifications can't be tracked.
+	typedef std::function<bool(PageBitmap&)> DirtyPageQuery;
+
+	enum
+	{
+		DEFAULT_PAGE_SIZE = 0x1000,
+	};
+
+	virtual ~CMemoryStateTracker() = default;
+
+	void SetDirtyPageQuery(const void*, uint32, const DirtyPageQuery&);
+
+	virtual void InsertMemoryFile(Framework::CZipArchiveWriter&, const char*, const void*, size_t) = 0;
+	virtual void ReadMemoryFile(Framework::CZipArchiveReader&, const char*, void*, size_t);
+
+	static void SaveMemory(Framework::CZipArchiveWriter&, CMemoryStateTracker*, const char*, const void*, size_t);
+	static void LoadMemory(Framework::CZipArchiveReader&, CMemoryStateTracker*, const char*, void*, size_t);
+
+protected:
+	uint32 GetPageSize(const void*) const;
+	bool QueryDirtyPages(const void*, PageBitmap&);
+
+	static uint64 HashPage(const uint8*, size_t);
+
+private:
+	struct DIRTYPAGEQUERYINFO
+	{
+		uint32 pageSize = DEFAULT_PAGE_SIZE;
+		DirtyPageQuery query;
+	};
+	typedef std::map<const void*, DIRTYPAGEQUERYINFO> DirtyPageQueryMap;
+
+	DirtyPageQueryMap m_dirtyPageQueries;
+};
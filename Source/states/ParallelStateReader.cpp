@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <zlib.h>
+#include "ParallelStateReader.h"
+#include "StateArchiveFormat.h"
+
+using namespace StateArchiveFormat;
+
+CParallelStateReader::CParallelStateReader(Framework::CStream& stream, Framework::CThreadPool& threadPool)
+{
+	for(const auto& entry : ReadEntries(stream))
+	{
+		const auto& header = entry.header;
+		if(header.uncompressedSize < PREFETCH_MIN_SIZE) continue;
+		if((header.compressionMethod != COMPRESSION_METHOD_DEFLATE) && (header.compressionMethod != COMPRESSION_METHOD_STORE)) continue;
+
+		auto compressedData = std::make_shared<Buffer>(header.compressedSize);
+		stream.Seek(entry.dataOffset, Framework::STREAM_SEEK_SET);
+		if(stream.Read(compressedData->data(), header.compressedSize) != header.compressedSize)
+		{
+			throw std::runtime_error("Unexpected end of state archive.");
+		}
+
+		uint32 chunkSize = 0;
+		std::vector<uint32> chunkSizes;
+		bool chunked = (header.compressionMethod == COMPRESSION_METHOD_DEFLATE) && GetChunkSizes(entry.extraField, chunkSize, chunkSizes);
+		if(chunked)
+		{
+			uint64 totalSize = 0;
+			for(auto size : chunkSizes)
+			{
+				totalSize += size;
+			}
+			size_t expectedChunkCount = std::max<size_t>((header.uncompressedSize + chunkSize - 1) / chunkSize, 1);
+			chunked = (totalSize == header.compressedSize) && (chunkSizes.size() == expectedChunkCount);
+		}
+		if(!chunked)
+		{
+			//Inflate the whole entry as a single chunk
+			chunkSize = header.uncompressedSize;
+			chunkSizes.assign(1, header.compressedSize);
+		}
+
+		PREFETCHEDFILE prefetchedFile;
+		prefetchedFile.data = std::make_shared<Buffer>(header.uncompressedSize);
+		prefetchedFile.crc = header.crc;
+
+		size_t inputOffset = 0;
+		for(size_t chunkIndex = 0; chunkIndex < chunkSizes.size(); chunkIndex++)
+		{
+			size_t outputOffset = chunkIndex * chunkSize;
+			size_t inputSize = chunkSizes[chunkIndex];
+			size_t outputSize = std::min<size_t>(header.uncompressedSize - outputOffset, chunkSize);
+			bool lastChunk = (chunkIndex + 1) == chunkSizes.size();
+
+			auto promise = std::make_shared<std::promise<uint32>>();
+			CHUNK chunk;
+			chunk.crc = promise->get_future();
+			chunk.size = static_cast<uint32>(outputSize);
+			prefetchedFile.chunks.push_back(std::move(chunk));
+
+			threadPool.Enqueue(
+			    [promise, compressedData, outputData = prefetchedFile.data, inputOffset, inputSize, outputOffset, outputSize,
+			     compressionMethod = header.compressionMethod, lastChunk]() {
+				    try
+				    {
+					    promise->set_value(InflateChunk(compressedData->data() + inputOffset, inputSize,
+					                                    outputData->data() + outputOffset, outputSize, compressionMethod, lastChunk));
+				    }
+				    catch(...)
+				    {
+					    promise->set_exception(std::current_exception());
+				    }
+			    });
+
+			inputOffset += inputSize;
+		}
+
+		m_prefetchedFiles.emplace(entry.name, std::move(prefetchedFile));
+	}
+
+	stream.Seek(0, Framework::STREAM_SEEK_SET);
+}
+
+void CParallelStateReader::InsertMemoryFile(Framework::CZipArchiveWriter& archive, const char* name, const void* memory, size_t size)
+{
+	//Only meant for loading, behave as if there was no tracker
+	SaveMemory(archive, nullptr, name, memory, size);
+}
+
+void CParallelStateReader::ReadMemoryFile(Framework::CZipArchiveReader& archive, const char* name, void* memory, size_t size)
+{
+	auto prefetchedFileIterator = m_prefetchedFiles.find(name);
+	if(prefetchedFileIterator == std::end(m_prefetchedFiles))
+	{
+		CMemoryStateTracker::ReadMemoryFile(archive, name, memory, size);
+		return;
+	}
+
+	auto& prefetchedFile = prefetchedFileIterator->second;
+	uint32 crc = crc32(0, Z_NULL, 0);
+	for(auto& chunk : prefetchedFile.chunks)
+	{
+		crc = crc32_combine(crc, chunk.crc.get(), chunk.size);
+	}
+	if(crc != prefetchedFile.crc)
+	{
+		throw std::runtime_error("CRC mismatch in state archive entry.");
+	}
+
+	//Archive entries can be smaller than the region they are loaded into
+	memcpy(memory, prefetchedFile.data->data(), std::min<size_t>(size, prefetchedFile.data->size()));
+	m_prefetchedFiles.erase(prefetchedFileIterator);
+}
+
+uint32 CParallelStateReader::InflateChunk(const uint8* input, size_t inputSize, uint8* output, size_t outputSize, uint16 compressionMethod, bool lastChunk)
+{
+	if(compressionMethod == COMPRESSION_METHOD_STORE)
+	{
+		if(inputSize != outputSize)
+		{
+			throw std::runtime_error("Invalid stored entry in state archive.");
+		}
+		memcpy(output, input, outputSize);
+	}
+	else
+	{
+		z_stream stream = {};
+		if(inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+		{
+			throw std::runtime_error("Failed to initialize zlib for state decompression.");
+		}
+		stream.next_in = const_cast<Bytef*>(input);
+		stream.avail_in = static_cast<uInt>(inputSize);
+		stream.next_out = output;
+		stream.avail_out = static_cast<uInt>(outputSize);
+		int result = inflate(&stream, lastChunk ? Z_FINISH : Z_SYNC_FLUSH);
+		bool succeeded = (stream.avail_out == 0) && (lastChunk ? (result == Z_STREAM_END) : ((result == Z_OK) || (result == Z_BUF_ERROR)));
+		inflateEnd(&stream);
+		if(!succeeded)
+		{
+			throw std::runtime_error("Failed to decompress state data.");
+		}
+	}
+	return crc32(crc32(0, Z_NULL, 0), output, static_cast<uInt>(outputSize));
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "MemoryStateTracker.h"
+#include "ThreadPool.h"
+
+//Reads large entries of a state archive upfront and inflates them on a thread pool while
+//the rest of the state is being loaded. Entries written by CParallelStateWriter are split
+//in chunks that are inflated in parallel.
+class CParallelStateReader : public CMemoryStateTracker
+{
+public:
+	enum
+	{
+		PREFETCH_MIN_SIZE = 0x10000,
+	};
+
+	CParallelStateReader(Framework::CStream&, Framework::CThreadPool&);
+	virtual ~CParallelStateReader() = default;
+
+	void InsertMemoryFile(Framework::CZipArchiveWriter&, const char*, const void*, size_t) override;
+	void ReadMemoryFile(Framework::CZipArchiveReader&, const char*, void*, size_t) override;
+
+private:
+	typedef std::vector<uint8> Buffer;
+	typedef std::shared_ptr<Buffer> BufferPtr;
+
+	struct CHUNK
+	{
+		std::future<uint32> crc;
+		uint32 size = 0;
+	};
+
+	struct PREFETCHEDFILE
+	{
+		BufferPtr data;
+		uint32 crc = 0;
+		std::vector<CHUNK> chunks;
+	};
+	typedef std::map<std::string, PREFETCHEDFILE> PrefetchedFileMap;
+
+	static uint32 InflateChunk(const uint8*, size_t, uint8*, size_t, uint16, bool);
+
+	PrefetchedFileMap m_prefetchedFiles;
+};
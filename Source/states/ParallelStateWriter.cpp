@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <future>
+#include <stdexcept>
+#include <zlib.h>
+#include "ParallelStateWriter.h"
+#include "StateArchiveFormat.h"
+#include "MemStream.h"
+#include "PtrStream.h"
+
+using namespace StateArchiveFormat;
+
+CParallelStateWriter::CParallelStateWriter(Framework::CThreadPool& threadPool)
+    : m_threadPool(threadPool)
+{
+}
+
+void CParallelStateWriter::InsertMemoryFile(Framework::CZipArchiveWriter&, const char* name, const void* memory, size_t size)
+{
+	MEMORYFILE memoryFile;
+	memoryFile.name = name;
+	memoryFile.data = std::make_shared<Buffer>(reinterpret_cast<const uint8*>(memory), reinterpret_cast<const uint8*>(memory) + size);
+	m_memoryFiles.push_back(std::move(memoryFile));
+}
+
+void CParallelStateWriter::CaptureArchive(Framework::CZipArchiveWriter& archive)
+{
+	//Remaining files are small, let the archive writer deal with them right away
+	Framework::CMemStream archiveStream;
+	archive.Write(archiveStream);
+	m_archiveData.assign(archiveStream.GetBuffer(), archiveStream.GetBuffer() + archiveStream.GetSize());
+}
+
+void CParallelStateWriter::Write(Framework::CStream& outputStream)
+{
+	typedef std::shared_ptr<std::promise<CHUNK>> ChunkPromisePtr;
+	typedef std::vector<std::future<CHUNK>> ChunkFutureList;
+
+	//Start compressing everything right away, files are written in order as soon as they are ready
+	std::vector<ChunkFutureList> memoryFileChunks;
+	for(const auto& memoryFile : m_memoryFiles)
+	{
+		ChunkFutureList chunks;
+		auto data = memoryFile.data;
+		size_t chunkCount = std::max<size_t>((data->size() + CHUNK_SIZE - 1) / CHUNK_SIZE, 1);
+		for(size_t chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++)
+		{
+			auto promise = std::make_shared<std::promise<CHUNK>>();
+			chunks.push_back(promise->get_future());
+			m_threadPool.Enqueue(
+			    [promise, data, chunkIndex, chunkCount]() {
+				    try
+				    {
+					    size_t offset = chunkIndex * CHUNK_SIZE;
+					    size_t size = std::min<size_t>(data->size() - offset, CHUNK_SIZE);
+					    promise->set_value(CompressChunk(data->data() + offset, size, (chunkIndex + 1) == chunkCount));
+				    }
+				    catch(...)
+				    {
+					    promise->set_exception(std::current_exception());
+				    }
+			    });
+		}
+		memoryFileChunks.push_back(std::move(chunks));
+	}
+
+	struct DIRECTORYENTRY
+	{
+		CENTRAL_DIRECTORY_HEADER header;
+		std::string name;
+		std::vector<uint8> extraField;
+	};
+	std::vector<DIRECTORYENTRY> directoryEntries;
+
+	auto writeLocalHeader =
+	    [&](const CENTRAL_DIRECTORY_HEADER& header, const std::string& name, const std::vector<uint8>& extraField) {
+		    DIRECTORYENTRY directoryEntry;
+		    directoryEntry.header = header;
+		    directoryEntry.header.signature = CENTRAL_DIRECTORY_HEADER_SIGNATURE;
+		    directoryEntry.header.versionMadeBy = VERSION_NEEDED;
+		    directoryEntry.header.versionNeeded = VERSION_NEEDED;
+		    directoryEntry.header.flags = 0;
+		    directoryEntry.header.fileNameLength = static_cast<uint16>(name.size());
+		    directoryEntry.header.extraFieldLength = static_cast<uint16>(extraField.size());
+		    directoryEntry.header.fileCommentLength = 0;
+		    directoryEntry.header.diskNumberStart = 0;
+		    directoryEntry.header.internalAttributes = 0;
+		    directoryEntry.header.externalAttributes = 0;
+		    //Offsets past 4GB would need ZIP64 records
+		    uint64 localHeaderOffset = outputStream.Tell();
+		    if(localHeaderOffset > UINT32_MAX)
+		    {
+			    throw std::runtime_error("State archive is too large.");
+		    }
+		    directoryEntry.header.localHeaderOffset = static_cast<uint32>(localHeaderOffset);
+		    directoryEntry.name = name;
+		    directoryEntry.extraField = extraField;
+
+		    LOCAL_FILE_HEADER localHeader = {};
+		    localHeader.signature = LOCAL_FILE_HEADER_SIGNATURE;
+		    localHeader.versionNeeded = VERSION_NEEDED;
+		    localHeader.compressionMethod = header.compressionMethod;
+		    localHeader.fileTime = header.fileTime;
+		    localHeader.fileDate = header.fileDate;
+		    localHeader.crc = header.crc;
+		    localHeader.compressedSize = header.compressedSize;
+		    localHeader.uncompressedSize = header.uncompressedSize;
+		    localHeader.fileNameLength = directoryEntry.header.fileNameLength;
+		    localHeader.extraFieldLength = directoryEntry.header.extraFieldLength;
+		    outputStream.Write(&localHeader, sizeof(LOCAL_FILE_HEADER));
+		    outputStream.Write(name.data(), name.size());
+		    if(!extraField.empty())
+		    {
+			    outputStream.Write(extraField.data(), extraField.size());
+		    }
+
+		    directoryEntries.push_back(std::move(directoryEntry));
+	    };
+
+	//Copy already compressed files from the small archive as is
+	{
+		Framework::CPtrStream archiveStream(m_archiveData.data(), m_archiveData.size());
+		for(const auto& entry : ReadEntries(archiveStream))
+		{
+			writeLocalHeader(entry.header, entry.name, std::vector<uint8>());
+			outputStream.Write(m_archiveData.data() + entry.dataOffset, entry.header.compressedSize);
+		}
+	}
+
+	for(size_t fileIndex = 0; fileIndex < m_memoryFiles.size(); fileIndex++)
+	{
+		const auto& memoryFile = m_memoryFiles[fileIndex];
+		std::vector<CHUNK> chunks;
+		for(auto& chunkFuture : memoryFileChunks[fileIndex])
+		{
+			chunks.push_back(chunkFuture.get());
+		}
+
+		CENTRAL_DIRECTORY_HEADER header = {};
+		header.compressionMethod = COMPRESSION_METHOD_DEFLATE;
+		header.fileDate = DOS_DATE_DEFAULT;
+		if(memoryFile.data->size() > UINT32_MAX)
+		{
+			throw std::runtime_error("State archive entry is too large.");
+		}
+		header.uncompressedSize = static_cast<uint32>(memoryFile.data->size());
+
+		std::vector<uint32> chunkSizes;
+		uint64 compressedSize = 0;
+		uint32 crc = crc32(0, Z_NULL, 0);
+		for(size_t chunkIndex = 0; chunkIndex < chunks.size(); chunkIndex++)
+		{
+			const auto& chunk = chunks[chunkIndex];
+			size_t size = std::min<size_t>(memoryFile.data->size() - (chunkIndex * CHUNK_SIZE), CHUNK_SIZE);
+			crc = crc32_combine(crc, chunk.crc, static_cast<z_off_t>(size));
+			compressedSize += chunk.compressedData.size();
+			chunkSizes.push_back(static_cast<uint32>(chunk.compressedData.size()));
+		}
+		if(compressedSize > UINT32_MAX)
+		{
+			throw std::runtime_error("State archive entry is too large.");
+		}
+		header.crc = crc;
+		header.compressedSize = static_cast<uint32>(compressedSize);
+
+		writeLocalHeader(header, memoryFile.name, MakeChunkExtraField(CHUNK_SIZE, chunkSizes));
+		for(const auto& chunk : chunks)
+		{
+			outputStream.Write(chunk.compressedData.data(), chunk.compressedData.size());
+		}
+	}
+
+	uint64 directoryOffset = outputStream.Tell();
+	for(const auto& directoryEntry : directoryEntries)
+	{
+		outputStream.Write(&directoryEntry.header, sizeof(CENTRAL_DIRECTORY_HEADER));
+		outputStream.Write(directoryEntry.name.data(), directoryEntry.name.size());
+		if(!directoryEntry.extraField.empty())
+		{
+			outputStream.Write(directoryEntry.extraField.data(), directoryEntry.extraField.size());
+		}
+	}
+	uint64 directoryEnd = outputStream.Tell();
+	if((directoryEnd > UINT32_MAX) || (directoryEntries.size() > UINT16_MAX))
+	{
+		throw std::runtime_error("State archive is too large.");
+	}
+
+	END_OF_CENTRAL_DIRECTORY endOfDirectory = {};
+	endOfDirectory.signature = END_OF_CENTRAL_DIRECTORY_SIGNATURE;
+	endOfDirectory.diskEntryCount = static_cast<uint16>(directoryEntries.size());
+	endOfDirectory.totalEntryCount = static_cast<uint16>(directoryEntries.size());
+	endOfDirectory.centralDirectorySize = static_cast<uint32>(directoryEnd - directoryOffset);
+	endOfDirectory.centralDirectoryOffset = static_cast<uint32>(directoryOffset);
+	outputStream.Write(&endOfDirectory, sizeof(END_OF_CENTRAL_DIRECTORY));
+	outputStream.Flush();
+}
+
+CParallelStateWriter::CHUNK CParallelStateWriter::CompressChunk(const uint8* data, size_t size, bool lastChunk)
+{
+	z_stream stream = {};
+	if(deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+	{
+		throw std::runtime_error("Failed to initialize zlib for state compression.");
+	}
+
+	//Chunks other than the last one are ended with a sync flush, making them byte aligned
+	//and independent from each other, they can be concatenated to form a valid stream
+	CHUNK chunk;
+	chunk.compressedData.resize(deflateBound(&stream, static_cast<uLong>(size)) + 0x10);
+	stream.next_in = const_cast<Bytef*>(data);
+	stream.avail_in = static_cast<uInt>(size);
+	stream.next_out = chunk.compressedData.data();
+	stream.avail_out = static_cast<uInt>(chunk.compressedData.size());
+	int result = deflate(&stream, lastChunk ? Z_FINISH : Z_SYNC_FLUSH);
+	bool succeeded = lastChunk ? (result == Z_STREAM_END) : ((result == Z_OK) && (stream.avail_in == 0) && (stream.avail_out != 0));
+	chunk.compressedData.resize(stream.total_out);
+	deflateEnd(&stream);
+	if(!succeeded)
+	{
+		throw std::runtime_error("Failed to compress state data.");
+	}
+
+	chunk.crc = crc32(crc32(0, Z_NULL, 0), data, static_cast<uInt>(size));
+	return chunk;
+}
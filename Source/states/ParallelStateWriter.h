@@ -0,0 +1,45 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "MemoryStateTracker.h"
+#include "ThreadPool.h"
+
+//Takes a copy of large memory regions while the machine is stopped, then compresses
+//them in chunks on a thread pool while the archive is being written. Write can be
+//called from any thread once CaptureArchive was called.
+class CParallelStateWriter : public CMemoryStateTracker
+{
+public:
+	CParallelStateWriter(Framework::CThreadPool&);
+	virtual ~CParallelStateWriter() = default;
+
+	void InsertMemoryFile(Framework::CZipArchiveWriter&, const char*, const void*, size_t) override;
+
+	void CaptureArchive(Framework::CZipArchiveWriter&);
+	void Write(Framework::CStream&);
+
+private:
+	typedef std::vector<uint8> Buffer;
+	typedef std::shared_ptr<Buffer> BufferPtr;
+
+	struct MEMORYFILE
+	{
+		std::string name;
+		BufferPtr data;
+	};
+	typedef std::vector<MEMORYFILE> MemoryFileList;
+
+	struct CHUNK
+	{
+		Buffer compressedData;
+		uint32 crc = 0;
+	};
+
+	static CHUNK CompressChunk(const uint8*, size_t, bool);
+
+	Framework::CThreadPool& m_threadPool;
+	MemoryFileList m_memoryFiles;
+	Buffer m_archiveData;
+};
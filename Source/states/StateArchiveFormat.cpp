@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include "StateArchiveFormat.h"
+
+using namespace StateArchiveFormat;
+
+static void ReadExact(Framework::CStream& stream, void* buffer, uint64 size)
+{
+	if(stream.Read(buffer, size) != size)
+	{
+		throw std::runtime_error("Unexpected end of state archive.");
+	}
+}
+
+EntryList StateArchiveFormat::ReadEntries(Framework::CStream& stream)
+{
+	stream.Seek(0, Framework::STREAM_SEEK_END);
+	uint64 streamSize = stream.Tell();
+
+	//End of central directory record is followed by a comment of 64KB at most
+	uint64 searchSize = std::min<uint64>(streamSize, sizeof(END_OF_CENTRAL_DIRECTORY) + 0xFFFF);
+	if(searchSize < sizeof(END_OF_CENTRAL_DIRECTORY))
+	{
+		throw std::runtime_error("State archive is too small.");
+	}
+	std::vector<uint8> tail(searchSize);
+	stream.Seek(streamSize - searchSize, Framework::STREAM_SEEK_SET);
+	ReadExact(stream, tail.data(), searchSize);
+
+	END_OF_CENTRAL_DIRECTORY endOfDirectory = {};
+	bool found = false;
+	for(uint64 offset = searchSize - sizeof(END_OF_CENTRAL_DIRECTORY) + 1; offset != 0; offset--)
+	{
+		memcpy(&endOfDirectory, tail.data() + offset - 1, sizeof(END_OF_CENTRAL_DIRECTORY));
+		if(endOfDirectory.signature == END_OF_CENTRAL_DIRECTORY_SIGNATURE)
+		{
+			found = true;
+			break;
+		}
+	}
+	if(!found)
+	{
+		throw std::runtime_error("Couldn't find state archive's central directory.");
+	}
+
+	EntryList entries;
+	entries.reserve(endOfDirectory.totalEntryCount);
+	uint64 directoryOffset = endOfDirectory.centralDirectoryOffset;
+	for(unsigned int i = 0; i < endOfDirectory.totalEntryCount; i++)
+	{
+		ENTRY entry;
+		stream.Seek(directoryOffset, Framework::STREAM_SEEK_SET);
+		ReadExact(stream, &entry.header, sizeof(CENTRAL_DIRECTORY_HEADER));
+		if(entry.header.signature != CENTRAL_DIRECTORY_HEADER_SIGNATURE)
+		{
+			throw std::runtime_error("Invalid central directory header in state archive.");
+		}
+		entry.name.resize(entry.header.fileNameLength);
+		ReadExact(stream, &entry.name[0], entry.header.fileNameLength);
+		entry.extraField.resize(entry.header.extraFieldLength);
+		ReadExact(stream, entry.extraField.data(), entry.header.extraFieldLength);
+		directoryOffset += sizeof(CENTRAL_DIRECTORY_HEADER) + entry.header.fileNameLength +
+		                   entry.header.extraFieldLength + entry.header.fileCommentLength;
+
+		//Local header's variable fields might not match the central directory's ones
+		LOCAL_FILE_HEADER localHeader = {};
+		stream.Seek(entry.header.localHeaderOffset, Framework::STREAM_SEEK_SET);
+		ReadExact(stream, &localHeader, sizeof(LOCAL_FILE_HEADER));
+		if(localHeader.signature != LOCAL_FILE_HEADER_SIGNATURE)
+		{
+			throw std::runtime_error("Invalid local file header in state archive.");
+		}
+		entry.dataOffset = entry.header.localHeaderOffset + sizeof(LOCAL_FILE_HEADER) +
+		                   localHeader.fileNameLength + localHeader.extraFieldLength;
+		if((entry.dataOffset + entry.header.compressedSize) > streamSize)
+		{
+			throw std::runtime_error("State archive entry is out of bounds.");
+		}
+
+		entries.push_back(std::move(entry));
+	}
+
+	return entries;
+}
+
+std::vector<uint8> StateArchiveFormat::MakeChunkExtraField(uint32 chunkSize, const std::vector<uint32>& chunkSizes)
+{
+	uint32 dataSize = sizeof(uint32) * (1 + chunkSizes.size());
+	if(dataSize > 0xFFFB)
+	{
+		//Doesn't fit, reader will inflate the entry in one go
+		return std::vector<uint8>();
+	}
+
+	std::vector<uint8> extraField(sizeof(uint16) * 2 + dataSize);
+	uint16 fieldHeader[2] = {CHUNK_EXTRA_FIELD_ID, static_cast<uint16>(dataSize)};
+	memcpy(extraField.data(), fieldHeader, sizeof(fieldHeader));
+	memcpy(extraField.data() + sizeof(fieldHeader), &chunkSize, sizeof(uint32));
+	if(!chunkSizes.empty())
+	{
+		memcpy(extraField.data() + sizeof(fieldHeader) + sizeof(uint32), chunkSizes.data(), sizeof(uint32) * chunkSizes.size());
+	}
+	return extraField;
+}
+
+bool StateArchiveFormat::GetChunkSizes(const std::vector<uint8>& extraField, uint32& chunkSize, std::vector<uint32>& chunkSizes)
+{
+	size_t offset = 0;
+	while((offset + sizeof(uint16) * 2) <= extraField.size())
+	{
+		uint16 fieldHeader[2] = {};
+		memcpy(fieldHeader, extraField.data() + offset, sizeof(fieldHeader));
+		offset += sizeof(fieldHeader);
+		uint16 dataSize = fieldHeader[1];
+		if((offset + dataSize) > extraField.size()) break;
+		if((fieldHeader[0] == CHUNK_EXTRA_FIELD_ID) && (dataSize >= sizeof(uint32)) && ((dataSize % sizeof(uint32)) == 0))
+		{
+			memcpy(&chunkSize, extraField.data() + offset, sizeof(uint32));
+			chunkSizes.resize((dataSize / sizeof(uint32)) - 1);
+			if(!chunkSizes.empty())
+			{
+				memcpy(chunkSizes.data(), extraField.data() + offset + sizeof(uint32), dataSize - sizeof(uint32));
+			}
+			return (chunkSize != 0);
+		}
+		offset += dataSize;
+	}
+	return false;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "Types.h"
+#include "Stream.h"
+
+//Raw ZIP structures used by the parallel state reader/writer. Large memory entries are
+//deflated in independent chunks, their compressed sizes are stored in an extra field
+//so that they can be inflated in parallel when loading.
+namespace StateArchiveFormat
+{
+	enum : uint32
+	{
+		LOCAL_FILE_HEADER_SIGNATURE = 0x04034B50,
+		CENTRAL_DIRECTORY_HEADER_SIGNATURE = 0x02014B50,
+		END_OF_CENTRAL_DIRECTORY_SIGNATURE = 0x06054B50,
+	};
+
+	enum : uint16
+	{
+		COMPRESSION_METHOD_STORE = 0,
+		COMPRESSION_METHOD_DEFLATE = 8,
+		VERSION_NEEDED = 20,
+		DOS_DATE_DEFAULT = 0x21, //1980-01-01
+		CHUNK_EXTRA_FIELD_ID = 0x5350,
+	};
+
+	enum : uint32
+	{
+		CHUNK_SIZE = 0x100000,
+	};
+
+#pragma pack(push, 1)
+	struct LOCAL_FILE_HEADER
+	{
+		uint32 signature;
+		uint16 versionNeeded;
+		uint16 flags;
+		uint16 compressionMethod;
+		uint16 fileTime;
+		uint16 fileDate;
+		uint32 crc;
+		uint32 compressedSize;
+		uint32 uncompressedSize;
+		uint16 fileNameLength;
+		uint16 extraFieldLength;
+	};
+	static_assert(sizeof(LOCAL_FILE_HEADER) == 30, "Size of LOCAL_FILE_HEADER must be 30 bytes.");
+
+	struct CENTRAL_DIRECTORY_HEADER
+	{
+		uint32 signature;
+		uint16 versionMadeBy;
+		uint16 versionNeeded;
+		uint16 flags;
+		uint16 compressionMethod;
+		uint16 fileTime;
+		uint16 fileDate;
+		uint32 crc;
+		uint32 compressedSize;
+		uint32 uncompressedSize;
+		uint16 fileNameLength;
+		uint16 extraFieldLength;
+		uint16 fileCommentLength;
+		uint16 diskNumberStart;
+		uint16 internalAttributes;
+		uint32 externalAttributes;
+		uint32 localHeaderOffset;
+	};
+	static_assert(sizeof(CENTRAL_DIRECTORY_HEADER) == 46, "Size of CENTRAL_DIRECTORY_HEADER must be 46 bytes.");
+
+	struct END_OF_CENTRAL_DIRECTORY
+	{
+		uint32 signature;
+		uint16 diskNumber;
+		uint16 centralDirectoryDiskNumber;
+		uint16 diskEntryCount;
+		uint16 totalEntryCount;
+		uint32 centralDirectorySize;
+		uint32 centralDirectoryOffset;
+		uint16 commentLength;
+	};
+	static_assert(sizeof(END_OF_CENTRAL_DIRECTORY) == 22, "Size of END_OF_CENTRAL_DIRECTORY must be 22 bytes.");
+#pragma pack(pop)
+
+	struct ENTRY
+	{
+		std::string name;
+		CENTRAL_DIRECTORY_HEADER header;
+		std::vector<uint8> extraField;
+		uint64 dataOffset = 0;
+	};
+	typedef std::vector<ENTRY> EntryList;
+
+	EntryList ReadEntries(Framework::CStream&);
+
+	std::vector<uint8> MakeChunkExtraField(uint32, const std::vector<uint32>&);
+	bool GetChunkSizes(const std::vector<uint8>&, uint32&, std::vector<uint32>&);
+}
@@ -0,0 +1,179 @@
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include "StateDeltaTracker.h"
+#include "MemoryStateFile.h"
+#include "MemoryDeltaStateFile.h"
+#include "RegisterStateFile.h"
+#include "zip/ZipArchiveReader.h"
+
+#define STATE_DELTA_INFO ("delta/info")
+#define STATE_DELTA_INFO_CHAINID ("ChainId")
+#define STATE_DELTA_INFO_SEQUENCE ("Sequence")
+
+#define DELTA_SUFFIX (".delta")
+
+static bool IsDeltaFileName(const std::string& name)
+{
+	size_t suffixLength = strlen(DELTA_SUFFIX);
+	return (name.size() > suffixLength) && (name.compare(name.size() - suffixLength, suffixLength, DELTA_SUFFIX) == 0);
+}
+
+void CStateDeltaTracker::BeginCheckpoint(Framework::CZipArchiveWriter& archive)
+{
+	if(!m_hasBase)
+	{
+		m_regions.clear();
+		m_chainId = std::random_device()();
+		m_sequence = 0;
+		m_hasBase = true;
+	}
+	else
+	{
+		m_sequence++;
+	}
+
+	auto infoFile = new CRegisterStateFile(STATE_DELTA_INFO);
+	infoFile->SetRegister32(STATE_DELTA_INFO_CHAINID, m_chainId);
+	infoFile->SetRegister32(STATE_DELTA_INFO_SEQUENCE, m_sequence);
+	archive.InsertFile(infoFile);
+}
+
+void CStateDeltaTracker::Reset()
+{
+	m_regions.clear();
+	m_hasBase = false;
+	m_sequence = 0;
+}
+
+bool CStateDeltaTracker::IsBaseCheckpoint() const
+{
+	return m_sequence == 0;
+}
+
+uint32 CStateDeltaTracker::GetSequence() const
+{
+	return m_sequence;
+}
+
+void CStateDeltaTracker::InsertMemoryFile(Framework::CZipArchiveWriter& archive, const char* name, const void* memory, size_t size)
+{
+	assert(m_hasBase);
+	bool isBase = IsBaseCheckpoint();
+
+	auto& region = m_regions[name];
+	if(isBase)
+	{
+		region.memory = memory;
+		region.size = size;
+		region.pageSize = GetPageSize(memory);
+		region.pageHashes.resize((size + region.pageSize - 1) / region.pageSize);
+	}
+	else if((region.memory != memory) || (region.size != size))
+	{
+		throw std::runtime_error("Memory region changed since last checkpoint.");
+	}
+
+	PageBitmap dirtyPages(region.pageHashes.size(), 1);
+	bool tracked = QueryDirtyPages(memory, dirtyPages);
+	assert(!tracked || (dirtyPages.size() == region.pageHashes.size()));
+	UpdatePageHashes(region, dirtyPages, tracked && !isBase);
+
+	if(isBase)
+	{
+		archive.InsertFile(new CMemoryStateFile(name, memory, size));
+	}
+	else
+	{
+		auto deltaName = std::string(name) + DELTA_SUFFIX;
+		archive.InsertFile(new CMemoryDeltaStateFile(deltaName.c_str(), memory, size, region.pageSize, dirtyPages));
+	}
+}
+
+void CStateDeltaTracker::UpdatePageHashes(REGION& region, PageBitmap& dirtyPages, bool tracked)
+{
+	auto memory = reinterpret_cast<const uint8*>(region.memory);
+	for(size_t pageIndex = 0; pageIndex < region.pageHashes.size(); pageIndex++)
+	{
+		//Untouched pages keep their previous hash, no need to look at them
+		if(tracked && !dirtyPages[pageIndex]) continue;
+		size_t pageOffset = pageIndex * region.pageSize;
+		size_t pageSize = std::min<size_t>(region.pageSize, region.size - pageOffset);
+		uint64 hash = HashPage(memory + pageOffset, pageSize);
+		dirtyPages[pageIndex] = (hash != region.pageHashes[pageIndex]) ? 1 : 0;
+		region.pageHashes[pageIndex] = hash;
+	}
+}
+
+void CStateDeltaTracker::MaterializeChain(const StreamList& chain, Framework::CStream& output)
+{
+	typedef std::map<std::string, std::vector<uint8>> FileMap;
+
+	if(chain.empty())
+	{
+		throw std::runtime_error("State chain is empty.");
+	}
+
+	FileMap files;
+	uint32 chainId = 0;
+	for(size_t stateIndex = 0; stateIndex < chain.size(); stateIndex++)
+	{
+		Framework::CZipArchiveReader archive(*chain[stateIndex]);
+		if(!archive.GetFileHeader(STATE_DELTA_INFO))
+		{
+			throw std::runtime_error("State is not part of a delta chain.");
+		}
+
+		{
+			CRegisterStateFile infoFile(*archive.BeginReadFile(STATE_DELTA_INFO));
+			uint32 stateChainId = infoFile.GetRegister32(STATE_DELTA_INFO_CHAINID);
+			uint32 stateSequence = infoFile.GetRegister32(STATE_DELTA_INFO_SEQUENCE);
+			if(stateIndex == 0)
+			{
+				chainId = stateChainId;
+			}
+			if(stateChainId != chainId)
+			{
+				throw std::runtime_error("State doesn't belong to the same chain as the base state.");
+			}
+			if(stateSequence != stateIndex)
+			{
+				throw std::runtime_error("State chain is incomplete or out of order.");
+			}
+		}
+
+		for(const auto& fileHeader : archive.GetFileHeaders())
+		{
+			const auto& fileName = fileHeader.first;
+			if(fileName == STATE_DELTA_INFO) continue;
+
+			std::vector<uint8> fileData(fileHeader.second.uncompressedSize);
+			archive.BeginReadFile(fileName.c_str())->Read(fileData.data(), fileData.size());
+
+			if(IsDeltaFileName(fileName))
+			{
+				auto baseFileName = fileName.substr(0, fileName.size() - strlen(DELTA_SUFFIX));
+				auto fileIterator = files.find(baseFileName);
+				if(fileIterator == std::end(files))
+				{
+					throw std::runtime_error("Memory delta has no matching memory in base state.");
+				}
+				auto& baseFileData = fileIterator->second;
+				CMemoryDeltaStateFile::Apply(baseFileData.data(), baseFileData.size(), fileData.data(), fileData.size());
+			}
+			else
+			{
+				files[fileName] = std::move(fileData);
+			}
+		}
+	}
+
+	Framework::CZipArchiveWriter archive;
+	for(const auto& file : files)
+	{
+		archive.InsertFile(new CMemoryStateFile(file.first.c_str(), file.second.data(), file.second.size()));
+	}
+	archive.Write(output);
+}
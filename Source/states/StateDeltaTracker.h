@@ -0,0 +1,44 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include "Stream.h"
+#include "MemoryStateTracker.h"
+
+//Tracks which memory pages changed between checkpoints, allowing states to be
+//saved as a full base state followed by a chain of deltas that only contain
+//modified pages. A chain can be turned back into a regular state with MaterializeChain.
+class CStateDeltaTracker : public CMemoryStateTracker
+{
+public:
+	typedef std::vector<Framework::CStream*> StreamList;
+
+	void BeginCheckpoint(Framework::CZipArchiveWriter&);
+	void Reset();
+
+	bool IsBaseCheckpoint() const;
+	uint32 GetSequence() const;
+
+	void InsertMemoryFile(Framework::CZipArchiveWriter&, const char*, const void*, size_t) override;
+
+	static void MaterializeChain(const StreamList&, Framework::CStream&);
+
+private:
+	struct REGION
+	{
+		const void* memory = nullptr;
+		size_t size = 0;
+		uint32 pageSize = DEFAULT_PAGE_SIZE;
+		std::vector<uint64> pageHashes;
+	};
+
+	typedef std::map<std::string, REGION> RegionMap;
+
+	void UpdatePageHashes(REGION&, PageBitmap&, bool);
+
+	RegionMap m_regions;
+	bool m_hasBase = false;
+	uint32 m_chainId = 0;
+	uint32 m_sequence = 0;
+};
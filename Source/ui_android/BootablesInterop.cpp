@@ -3,6 +3,13 @@
 #include "com_virtualapplications_play_Bootable.h"
 #include "NativeShared.h"
 
+static void logScanStats(const fs::path& path, const BootableScanStats& stats)
+{
+	Log_Print("Scanned '%s': %d files found, %d skipped, %d probed, %d registered in %f seconds (%f files/s).\r\n",
+	          path.string().c_str(), stats.foundFileCount, stats.skippedFileCount, stats.probedFileCount,
+	          stats.registeredFileCount, stats.elapsedSeconds, stats.GetFilesPerSecond());
+}
+
 void fullScan(JNIEnv* env, jobjectArray rootDirectories)
 {
 	auto rootDirectoryCount = env->GetArrayLength(rootDirectories);
@@ -10,7 +17,8 @@ void fullScan(JNIEnv* env, jobjectArray rootDirectories)
 	{
 		auto rootDirectoryString = static_cast<jstring>(env->GetObjectArrayElement(rootDirectories, i));
 		auto rootDirectory = GetStringFromJstring(env, rootDirectoryString);
-		ScanBootables(rootDirectory, true);
+		auto stats = ScanBootables(rootDirectory, true);
+		logScanStats(rootDirectory, stats);
 	}
 }
 
@@ -27,7 +35,8 @@ extern "C" JNIEXPORT void JNICALL Java_com_virtualapplications_play_BootablesInt
 		{
 			for(const auto& activeDirectory : activeDirectories)
 			{
-				ScanBootables(activeDirectory, false);
+				auto stats = ScanBootables(activeDirectory, false);
+				logScanStats(activeDirectory, stats);
 			}
 		}
 	}
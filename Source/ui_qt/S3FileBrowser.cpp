@@ -106,7 +106,9 @@ void S3FileBrowser::launchUpdate()
 			    {
 				    CAmazonS3Client client(
 				        CS3ObjectStream::CConfig::GetInstance().GetAccessKeyId(),
-				        CS3ObjectStream::CConfig::GetInstance().GetSecretAccessKey());
+				        CS3ObjectStream::CConfig::GetInstance().GetSecretAccessKey(),
+				        "us-east-1",
+				        CS3ObjectStream::CConfig::GetInstance().GetEndpoint());
 
 				    GetBucketLocationRequest request;
 				    request.bucket = bucketName;
@@ -119,7 +121,8 @@ void S3FileBrowser::launchUpdate()
 			    CAmazonS3Client client(
 			        CS3ObjectStream::CConfig::GetInstance().GetAccessKeyId(),
 			        CS3ObjectStream::CConfig::GetInstance().GetSecretAccessKey(),
-			        bucketRegion);
+			        bucketRegion,
+			        CS3ObjectStream::CConfig::GetInstance().GetEndpoint());
 			    return client.ListObjects(bucketName);
 		    }
 		    catch(...)
@@ -7,7 +7,9 @@
 
 using namespace BootablesDb;
 
-#define DATABASE_VERSION 2
+#define DATABASE_VERSION 3
+//Version 2 databases only lack file info columns, they can be migrated without losing data
+#define DATABASE_VERSION_NOFILEINFO 2
 
 static const char* g_dbFileName = "bootables.db";
 
@@ -19,7 +21,17 @@ static const char* g_bootablesTableCreateStatement =
     "    title TEXT DEFAULT '',"
     "    coverUrl TEXT DEFAULT '',"
     "    lastBootedTime INTEGER DEFAULT 0,"
-    "    overview TEXT DEFAULT ''"
+    "    overview TEXT DEFAULT '',"
+    "    fileSize INTEGER DEFAULT 0,"
+    "    fileTime INTEGER DEFAULT 0"
+    ")";
+
+static const char* g_unbootablesTableCreateStatement =
+    "CREATE TABLE IF NOT EXISTS unbootables"
+    "("
+    "    path TEXT PRIMARY KEY,"
+    "    fileSize INTEGER DEFAULT 0,"
+    "    fileTime INTEGER DEFAULT 0"
     ")";
 
 CClient::CClient()
@@ -31,16 +43,40 @@ CClient::CClient()
 	m_db = Framework::CSqliteDb(Framework::PathUtils::GetNativeStringFromPath(m_dbPath).c_str(),
 	                            SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
 
+	int version = 0;
 	{
-		auto query = string_format("PRAGMA user_version = %d", DATABASE_VERSION);
-		Framework::CSqliteStatement statement(m_db, query.c_str());
-		statement.StepNoResult();
+		Framework::CSqliteStatement statement(m_db, "PRAGMA user_version");
+		statement.StepWithResult();
+		version = sqlite3_column_int(statement, 0);
 	}
 
 	{
 		Framework::CSqliteStatement statement(m_db, g_bootablesTableCreateStatement);
 		statement.StepNoResult();
 	}
+
+	if(version == DATABASE_VERSION_NOFILEINFO)
+	{
+		{
+			Framework::CSqliteStatement statement(m_db, "ALTER TABLE bootables ADD COLUMN fileSize INTEGER DEFAULT 0");
+			statement.StepNoResult();
+		}
+		{
+			Framework::CSqliteStatement statement(m_db, "ALTER TABLE bootables ADD COLUMN fileTime INTEGER DEFAULT 0");
+			statement.StepNoResult();
+		}
+	}
+
+	{
+		Framework::CSqliteStatement statement(m_db, g_unbootablesTableCreateStatement);
+		statement.StepNoResult();
+	}
+
+	{
+		auto query = string_format("PRAGMA user_version = %d", DATABASE_VERSION);
+		Framework::CSqliteStatement statement(m_db, query.c_str());
+		statement.StepNoResult();
+	}
 }
 
 Bootable CClient::GetBootable(const fs::path& path)
@@ -87,6 +123,41 @@ void CClient::RegisterBootable(const fs::path& path, const char* title, const ch
 	statement.StepNoResult();
 }
 
+void CClient::RegisterBootables(const std::vector<Bootable>& bootables)
+{
+	if(bootables.empty()) return;
+
+	ExecuteTransaction(
+	    [&]() {
+		    Framework::CSqliteStatement insertStatement(m_db, "INSERT OR IGNORE INTO bootables (path, title, discId) VALUES (?,?,?)");
+		    Framework::CSqliteStatement updateStatement(m_db, "UPDATE bootables SET discId = ?, fileSize = ?, fileTime = ? WHERE path = ?");
+		    Framework::CSqliteStatement deleteStatement(m_db, "DELETE FROM unbootables WHERE path = ?");
+		    for(const auto& bootable : bootables)
+		    {
+			    //Statements are reused for all bootables
+			    auto path = Framework::PathUtils::GetNativeStringFromPath(bootable.path);
+
+			    sqlite3_reset(insertStatement);
+			    insertStatement.BindText(1, path.c_str(), true);
+			    insertStatement.BindText(2, bootable.title.c_str(), true);
+			    insertStatement.BindText(3, bootable.discId.c_str(), true);
+			    insertStatement.StepNoResult();
+
+			    sqlite3_reset(updateStatement);
+			    updateStatement.BindText(1, bootable.discId.c_str(), true);
+			    sqlite3_bind_int64(updateStatement, 2, bootable.fileSize);
+			    sqlite3_bind_int64(updateStatement, 3, bootable.fileTime);
+			    updateStatement.BindText(4, path.c_str(), true);
+			    updateStatement.StepNoResult();
+
+			    //File might have failed to probe before
+			    sqlite3_reset(deleteStatement);
+			    deleteStatement.BindText(1, path.c_str(), true);
+			    deleteStatement.StepNoResult();
+		    }
+	    });
+}
+
 void CClient::UnregisterBootable(const fs::path& path)
 {
 	Framework::CSqliteStatement statement(m_db, "DELETE FROM bootables WHERE path = ?");
@@ -94,6 +165,50 @@ void CClient::UnregisterBootable(const fs::path& path)
 	statement.StepNoResult();
 }
 
+std::vector<Unbootable> CClient::GetUnbootables()
+{
+	std::vector<Unbootable> unbootables;
+
+	Framework::CSqliteStatement statement(m_db, "SELECT path, fileSize, fileTime FROM unbootables");
+	while(statement.Step())
+	{
+		Unbootable unbootable;
+		unbootable.path = Framework::PathUtils::GetPathFromNativeString(reinterpret_cast<const char*>(sqlite3_column_text(statement, 0)));
+		unbootable.fileSize = sqlite3_column_int64(statement, 1);
+		unbootable.fileTime = sqlite3_column_int64(statement, 2);
+		unbootables.push_back(unbootable);
+	}
+
+	return unbootables;
+}
+
+void CClient::RegisterUnbootables(const std::vector<Unbootable>& unbootables)
+{
+	if(unbootables.empty()) return;
+
+	ExecuteTransaction(
+	    [&]() {
+		    Framework::CSqliteStatement statement(m_db, "INSERT OR REPLACE INTO unbootables (path, fileSize, fileTime) VALUES (?,?,?)");
+		    for(const auto& unbootable : unbootables)
+		    {
+			    auto path = Framework::PathUtils::GetNativeStringFromPath(unbootable.path);
+
+			    sqlite3_reset(statement);
+			    statement.BindText(1, path.c_str(), true);
+			    sqlite3_bind_int64(statement, 2, unbootable.fileSize);
+			    sqlite3_bind_int64(statement, 3, unbootable.fileTime);
+			    statement.StepNoResult();
+		    }
+	    });
+}
+
+void CClient::UnregisterUnbootable(const fs::path& path)
+{
+	Framework::CSqliteStatement statement(m_db, "DELETE FROM unbootables WHERE path = ?");
+	statement.BindText(1, Framework::PathUtils::GetNativeStringFromPath(path).c_str());
+	statement.StepNoResult();
+}
+
 void CClient::SetDiscId(const fs::path& path, const char* discId)
 {
 	Framework::CSqliteStatement statement(m_db, "UPDATE bootables SET discId = ? WHERE path = ?");
@@ -143,12 +258,38 @@ Bootable CClient::ReadBootable(Framework::CSqliteStatement& statement)
 	bootable.coverUrl = reinterpret_cast<const char*>(sqlite3_column_text(statement, 3));
 	bootable.overview = reinterpret_cast<const char*>(sqlite3_column_text(statement, 5));
 	bootable.lastBootedTime = sqlite3_column_int(statement, 4);
+	bootable.fileSize = sqlite3_column_int64(statement, 6);
+	bootable.fileTime = sqlite3_column_int64(statement, 7);
 	return bootable;
 }
 
+void CClient::ExecuteTransaction(const std::function<void()>& transaction)
+{
+	{
+		Framework::CSqliteStatement statement(m_db, "BEGIN TRANSACTION");
+		statement.StepNoResult();
+	}
+
+	try
+	{
+		transaction();
+	}
+	catch(...)
+	{
+		Framework::CSqliteStatement statement(m_db, "ROLLBACK");
+		statement.StepNoResult();
+		throw;
+	}
+
+	{
+		Framework::CSqliteStatement statement(m_db, "COMMIT");
+		statement.StepNoResult();
+	}
+}
+
 void CClient::CheckDbVersion()
 {
-	bool dbExistsAndMatchesVersion =
+	bool dbExistsAndHasKnownVersion =
 	    [&]() {
 		    try
 		    {
@@ -158,7 +299,7 @@ void CClient::CheckDbVersion()
 			    Framework::CSqliteStatement statement(db, "PRAGMA user_version");
 			    statement.StepWithResult();
 			    int version = sqlite3_column_int(statement, 0);
-			    return (version == DATABASE_VERSION);
+			    return (version == DATABASE_VERSION) || (version == DATABASE_VERSION_NOFILEINFO);
 		    }
 		    catch(...)
 		    {
@@ -166,7 +307,7 @@ void CClient::CheckDbVersion()
 		    }
 	    }();
 
-	if(!dbExistsAndMatchesVersion)
+	if(!dbExistsAndHasKnownVersion)
 	{
 		fs::remove(m_dbPath);
 	}
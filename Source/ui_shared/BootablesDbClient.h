@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <string>
 #include <vector>
 #include "filesystem_def.h"
@@ -18,6 +19,17 @@ namespace BootablesDb
 		std::string coverUrl;
 		std::string overview;
 		time_t lastBootedTime = 0;
+		//Used to tell if the file changed since it was last scanned
+		uint64 fileSize = 0;
+		int64 fileTime = 0;
+	};
+
+	//File that failed to be probed, won't be probed again until its size or time changes
+	struct Unbootable
+	{
+		fs::path path;
+		uint64 fileSize = 0;
+		int64 fileTime = 0;
 	};
 
 	class CClient : public CSingleton<CClient>
@@ -38,8 +50,14 @@ namespace BootablesDb
 		std::vector<Bootable> GetBootables(int32_t = SORT_METHOD_NONE);
 
 		void RegisterBootable(const fs::path&, const char*, const char*);
+		//Registers (or updates disc id and file info of) many bootables in a single transaction
+		void RegisterBootables(const std::vector<Bootable>&);
 		void UnregisterBootable(const fs::path&);
 
+		std::vector<Unbootable> GetUnbootables();
+		void RegisterUnbootables(const std::vector<Unbootable>&);
+		void UnregisterUnbootable(const fs::path&);
+
 		void SetDiscId(const fs::path&, const char*);
 		void SetTitle(const fs::path&, const char*);
 		void SetCoverUrl(const fs::path&, const char*);
@@ -49,6 +67,7 @@ namespace BootablesDb
 	private:
 		static Bootable ReadBootable(Framework::CSqliteStatement&);
 
+		void ExecuteTransaction(const std::function<void()>&);
 		void CheckDbVersion();
 
 		fs::path m_dbPath;
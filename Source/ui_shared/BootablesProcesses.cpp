@@ -1,4 +1,9 @@
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
 #include "AppConfig.h"
 #include "BootablesProcesses.h"
 #include "BootablesDbClient.h"
@@ -7,8 +12,12 @@
 #include "PathUtils.h"
 #include "string_format.h"
 #include "StdStreamUtils.h"
+#include "ThreadPool.h"
 #include "http/HttpClientFactory.h"
 
+#define SCAN_MIN_THREAD_COUNT 4
+#define SCAN_DB_BATCH_SIZE 64
+
 //Jobs
 // Scan for new games (from input directory)
 // Remove games that might not be available anymore
@@ -44,26 +53,171 @@ void TryRegisteringBootable(const fs::path& path)
 	BootablesDb::CClient::GetInstance().RegisterBootable(path, path.filename().string().c_str(), serial.c_str());
 }
 
-void ScanBootables(const fs::path& parentPath, bool recursive)
+double BootableScanStats::GetFilesPerSecond() const
+{
+	return (elapsedSeconds != 0) ? (static_cast<double>(foundFileCount) / elapsedSeconds) : 0;
+}
+
+BootableScanStats ScanBootables(const fs::path& parentPath, bool recursive)
 {
-	for(auto pathIterator = fs::directory_iterator(parentPath);
-	    pathIterator != fs::directory_iterator(); pathIterator++)
+	auto startTime = std::chrono::steady_clock::now();
+
+	BootableScanStats stats;
+	std::vector<BootablesDb::Bootable> pendingBootables;
+	std::vector<BootablesDb::Unbootable> pendingUnbootables;
+	std::mutex pendingBootablesMutex;
+	std::condition_variable probeDoneCondition;
+	uint32 pendingProbeCount = 0;
+
+	//Files that didn't change since they were registered don't need to be probed again
+	std::map<fs::path, BootablesDb::Bootable> knownBootables;
+	for(auto& bootable : BootablesDb::CClient::GetInstance().GetBootables())
+	{
+		knownBootables.emplace(bootable.path, std::move(bootable));
+	}
+
+	//Same goes for files that failed to be probed
+	std::map<fs::path, BootablesDb::Unbootable> knownUnbootables;
+	for(auto& unbootable : BootablesDb::CClient::GetInstance().GetUnbootables())
+	{
+		knownUnbootables.emplace(unbootable.path, std::move(unbootable));
+	}
+
+	auto isKnownFile =
+	    [](const auto& knownFiles, const BootablesDb::Bootable& bootable) {
+		    auto knownFileIterator = knownFiles.find(bootable.path);
+		    return (knownFileIterator != std::end(knownFiles)) &&
+		           (knownFileIterator->second.fileSize == bootable.fileSize) &&
+		           (knownFileIterator->second.fileTime == bootable.fileTime);
+	    };
+
+	auto getPendingCount =
+	    [&]() {
+		    return pendingBootables.size() + pendingUnbootables.size();
+	    };
+
+	auto flushBootables =
+	    [&](bool force) {
+		    std::vector<BootablesDb::Bootable> bootables;
+		    std::vector<BootablesDb::Unbootable> unbootables;
+		    {
+			    std::lock_guard<std::mutex> pendingBootablesLock(pendingBootablesMutex);
+			    if(!force && (getPendingCount() < SCAN_DB_BATCH_SIZE)) return;
+			    std::swap(bootables, pendingBootables);
+			    std::swap(unbootables, pendingUnbootables);
+			    stats.registeredFileCount += static_cast<uint32>(bootables.size());
+		    }
+		    BootablesDb::CClient::GetInstance().RegisterBootables(bootables);
+		    BootablesDb::CClient::GetInstance().RegisterUnbootables(unbootables);
+	    };
+
 	{
-		auto& path = pathIterator->path();
-		try
+		//Probing is mostly waiting on I/O (network shares, compressed images), use more threads than cores
+		Framework::CThreadPool threadPool(std::max<unsigned int>(std::thread::hardware_concurrency(), SCAN_MIN_THREAD_COUNT));
+
+		std::vector<fs::path> directories = {parentPath};
+		while(!directories.empty())
 		{
-			if(recursive && fs::is_directory(path))
+			auto directory = std::move(directories.back());
+			directories.pop_back();
+
+			std::error_code errorCode;
+			for(auto pathIterator = fs::directory_iterator(directory, errorCode);
+			    pathIterator != fs::directory_iterator(); pathIterator.increment(errorCode))
 			{
-				ScanBootables(path, recursive);
-				continue;
+				if(errorCode) break;
+				flushBootables(false);
+				try
+				{
+					auto path = pathIterator->path();
+					if(fs::is_directory(path))
+					{
+						if(recursive)
+						{
+							directories.push_back(path);
+						}
+						continue;
+					}
+
+					bool isExecutable = IsBootableExecutablePath(path);
+					if(!isExecutable && !IsBootableDiscImagePath(path)) continue;
+
+					BootablesDb::Bootable bootable;
+					bootable.path = path;
+					bootable.title = path.filename().string();
+					bootable.fileSize = fs::file_size(path);
+					bootable.fileTime = static_cast<int64>(fs::last_write_time(path).time_since_epoch().count());
+
+					std::unique_lock<std::mutex> pendingBootablesLock(pendingBootablesMutex);
+					stats.foundFileCount++;
+
+					if(isKnownFile(knownBootables, bootable) || isKnownFile(knownUnbootables, bootable))
+					{
+						stats.skippedFileCount++;
+						continue;
+					}
+
+					if(isExecutable)
+					{
+						pendingBootables.push_back(std::move(bootable));
+						continue;
+					}
+
+					pendingProbeCount++;
+					pendingBootablesLock.unlock();
+
+					threadPool.Enqueue(
+					    [&, bootable = std::move(bootable)]() mutable {
+						    bool succeeded = false;
+						    try
+						    {
+							    succeeded = DiskUtils::TryGetDiskId(bootable.path, &bootable.discId);
+						    }
+						    catch(...)
+						    {
+							    //Failed to process a path, keep going
+						    }
+						    std::lock_guard<std::mutex> pendingBootablesLock(pendingBootablesMutex);
+						    stats.probedFileCount++;
+						    if(succeeded)
+						    {
+							    pendingBootables.push_back(std::move(bootable));
+						    }
+						    else
+						    {
+							    BootablesDb::Unbootable unbootable;
+							    unbootable.path = std::move(bootable.path);
+							    unbootable.fileSize = bootable.fileSize;
+							    unbootable.fileTime = bootable.fileTime;
+							    pendingUnbootables.push_back(std::move(unbootable));
+						    }
+						    pendingProbeCount--;
+						    probeDoneCondition.notify_one();
+					    });
+				}
+				catch(const std::exception& exception)
+				{
+					//Failed to process a path, keep going
+				}
 			}
-			TryRegisteringBootable(path);
 		}
-		catch(const std::exception& exception)
+
+		//Keep writing batches while the remaining images are being probed
+		while(1)
 		{
-			//Failed to process a path, keep going
+			{
+				std::unique_lock<std::mutex> pendingBootablesLock(pendingBootablesMutex);
+				probeDoneCondition.wait(pendingBootablesLock,
+				                        [&]() { return (pendingProbeCount == 0) || (getPendingCount() >= SCAN_DB_BATCH_SIZE); });
+				if(pendingProbeCount == 0) break;
+			}
+			flushBootables(false);
 		}
 	}
+
+	flushBootables(true);
+	stats.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	return stats;
 }
 
 std::set<fs::path> GetActiveBootableDirectories()
@@ -86,6 +240,13 @@ void PurgeInexistingFiles()
 		if(fs::exists(bootable.path)) continue;
 		BootablesDb::CClient::GetInstance().UnregisterBootable(bootable.path);
 	}
+
+	auto unbootables = BootablesDb::CClient::GetInstance().GetUnbootables();
+	for(const auto& unbootable : unbootables)
+	{
+		if(fs::exists(unbootable.path)) continue;
+		BootablesDb::CClient::GetInstance().UnregisterUnbootable(unbootable.path);
+	}
 }
 
 void FetchGameTitles()
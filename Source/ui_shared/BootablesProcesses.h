@@ -1,12 +1,24 @@
 #pragma once
 
 #include "filesystem_def.h"
+#include "Types.h"
 #include <set>
 
+struct BootableScanStats
+{
+	uint32 foundFileCount = 0;
+	uint32 skippedFileCount = 0;
+	uint32 probedFileCount = 0;
+	uint32 registeredFileCount = 0;
+	double elapsedSeconds = 0;
+
+	double GetFilesPerSecond() const;
+};
+
 bool IsBootableExecutablePath(const fs::path&);
 bool IsBootableDiscImagePath(const fs::path&);
 void TryRegisteringBootable(const fs::path&);
-void ScanBootables(const fs::path&, bool = true);
+BootableScanStats ScanBootables(const fs::path&, bool = true);
 std::set<fs::path> GetActiveBootableDirectories();
 void PurgeInexistingFiles();
 void FetchGameTitles();
@@ -71,6 +71,42 @@ std::string CStatsManager::GetProfilingInfo()
 		result += string_format("IOP Usage: %6.2f%%\r\n", (1.f - iopIdleRatio) * 100.f);
 	}
 
+	if(m_frames != 0)
+	{
+		float packetsPerFrame = static_cast<float>(m_sifStats.packetCount) / static_cast<float>(m_frames);
+		float copiesPerFrame = static_cast<float>(m_sifStats.copyCount) / static_cast<float>(m_frames);
+		float kbPerFrame = static_cast<float>(m_sifStats.bytesMoved) / static_cast<float>(m_frames * 1024);
+		result += string_format("SIF:       %6.1f packets, %6.1f copies, %8.2fKB per frame\r\n",
+		                        packetsPerFrame, copiesPerFrame, kbPerFrame);
+	}
+
+	if((m_frames != 0) && (m_gifReplayStats.lookupCount != 0))
+	{
+		float hitRatio = static_cast<float>(m_gifReplayStats.hitCount) / static_cast<float>(m_gifReplayStats.lookupCount);
+		float lookupsPerFrame = static_cast<float>(m_gifReplayStats.lookupCount) / static_cast<float>(m_frames);
+		float hashesPerFrame = static_cast<float>(m_gifReplayStats.hashCount) / static_cast<float>(m_frames);
+		result += string_format("GIF Cache: %6.2f%% hits, %6.1f lookups, %6.1f hashes per frame\r\n",
+		                        hitRatio * 100.f, lookupsPerFrame, hashesPerFrame);
+	}
+
+	if((m_frames != 0) && (m_hostFileStats.readCount != 0))
+	{
+		float readsPerFrame = static_cast<float>(m_hostFileStats.readCount) / static_cast<float>(m_frames);
+		float hostReadsPerFrame = static_cast<float>(m_hostFileStats.hostReadCount) / static_cast<float>(m_frames);
+		float savedSyscallsPerFrame = static_cast<float>(m_hostFileStats.GetSavedSyscallCount()) / static_cast<float>(m_frames);
+		result += string_format("Host I/O:  %6.1f reads, %6.1f host reads, %6.1f saved syscalls per frame\r\n",
+		                        readsPerFrame, hostReadsPerFrame, savedSyscallsPerFrame);
+	}
+
+	if((m_frames != 0) && (m_cdvdStreamStats.sectorsRead != 0))
+	{
+		float bufferRatio = static_cast<float>(m_cdvdStreamStats.sectorsFromBuffer) / static_cast<float>(m_cdvdStreamStats.sectorsRead);
+		float sectorsPerFrame = static_cast<float>(m_cdvdStreamStats.sectorsRead) / static_cast<float>(m_frames);
+		float underrunsPerFrame = static_cast<float>(m_cdvdStreamStats.underruns) / static_cast<float>(m_frames);
+		result += string_format("CD Stream: %6.2f%% buffered, %6.1f sectors, %6.2f underruns per frame\r\n",
+		                        bufferRatio * 100.f, sectorsPerFrame, underrunsPerFrame);
+	}
+
 	return result;
 }
 
@@ -87,6 +123,10 @@ void CStatsManager::ClearStats()
 		zonePair.second.currentValue = 0;
 	}
 	m_cpuUtilisation = CPS2VM::CPU_UTILISATION_INFO();
+	m_sifStats = CSIF::STATS();
+	m_gifReplayStats = CGifReplayCache::STATS();
+	m_hostFileStats = Iop::Ioman::CHostFileCache::STATS();
+	m_cdvdStreamStats = Iop::CCdvdStreamPrefetcher::STATS();
 #endif
 }
 
@@ -112,6 +152,33 @@ void CStatsManager::OnProfileFrameDone(CPS2VM* virtualMachine, const CProfiler::
 	m_cpuUtilisation.eeIdleTicks += cpuUtilisation.eeIdleTicks;
 	m_cpuUtilisation.iopTotalTicks += cpuUtilisation.iopTotalTicks;
 	m_cpuUtilisation.iopIdleTicks += cpuUtilisation.iopIdleTicks;
+
+	auto sifStats = virtualMachine->GetSifStats();
+	m_sifStats.packetCount += sifStats.packetCount;
+	m_sifStats.copyCount += sifStats.copyCount;
+	m_sifStats.bytesMoved += sifStats.bytesMoved;
+
+	auto gifReplayStats = virtualMachine->GetGifReplayStats();
+	m_gifReplayStats.lookupCount += gifReplayStats.lookupCount;
+	m_gifReplayStats.hitCount += gifReplayStats.hitCount;
+	m_gifReplayStats.hashCount += gifReplayStats.hashCount;
+	m_gifReplayStats.recordCount += gifReplayStats.recordCount;
+	m_gifReplayStats.replayedWriteCount += gifReplayStats.replayedWriteCount;
+
+	auto hostFileStats = virtualMachine->GetHostFileStats();
+	m_hostFileStats.openCount += hostFileStats.openCount;
+	m_hostFileStats.handleCacheHitCount += hostFileStats.handleCacheHitCount;
+	m_hostFileStats.readCount += hostFileStats.readCount;
+	m_hostFileStats.hostReadCount += hostFileStats.hostReadCount;
+	m_hostFileStats.seekCount += hostFileStats.seekCount;
+	m_hostFileStats.hostSeekCount += hostFileStats.hostSeekCount;
+	m_hostFileStats.hostStatCount += hostFileStats.hostStatCount;
+
+	auto cdvdStreamStats = virtualMachine->GetCdvdStreamStats();
+	m_cdvdStreamStats.sectorsRead += cdvdStreamStats.sectorsRead;
+	m_cdvdStreamStats.sectorsFromBuffer += cdvdStreamStats.sectorsFromBuffer;
+	m_cdvdStreamStats.underruns += cdvdStreamStats.underruns;
+	m_cdvdStreamStats.underrunSectors += cdvdStreamStats.underrunSectors;
 }
 
 #endif
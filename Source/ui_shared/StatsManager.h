@@ -41,6 +41,10 @@ private:
 	typedef std::map<std::string, ZONEINFO> ZoneMap;
 
 	CPS2VM::CPU_UTILISATION_INFO m_cpuUtilisation;
+	CSIF::STATS m_sifStats;
+	CGifReplayCache::STATS m_gifReplayStats;
+	Iop::Ioman::CHostFileCache::STATS m_hostFileStats;
+	Iop::CCdvdStreamPrefetcher::STATS m_cdvdStreamStats;
 
 	std::mutex m_profilerZonesMutex;
 	ZoneMap m_profilerZones;
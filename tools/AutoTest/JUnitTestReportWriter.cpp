@@ -22,10 +22,28 @@ void CJUnitTestReportWriter::ReportTestEntry(const std::string& testName, const
 {
 	auto testCaseNode = new Framework::Xml::CNode("testcase", true);
 	testCaseNode->InsertAttribute("name", testName.c_str());
+	testCaseNode->InsertAttribute("time", string_format("%.3f", result.wallTime).c_str());
+
+	{
+		auto propertiesNode = new Framework::Xml::CNode("properties", true);
+		auto insertProperty = [&](const char* name, uint64 value) {
+			auto propertyNode = new Framework::Xml::CNode("property", true);
+			propertyNode->InsertAttribute("name", name);
+			propertyNode->InsertAttribute("value", string_format("%llu", static_cast<unsigned long long>(value)).c_str());
+			propertiesNode->InsertNode(propertyNode);
+		};
+		insertProperty("eeCycles", result.eeCycleCount);
+		insertProperty("iopCycles", result.iopCycleCount);
+		testCaseNode->InsertNode(propertiesNode);
+	}
 
 	if(!result.succeeded)
 	{
 		std::string failureDetails;
+		if(!result.error.empty())
+		{
+			failureDetails = result.error + "\r\n\r\n";
+		}
 		for(const auto& lineDiff : result.lineDiffs)
 		{
 			auto failureLine = string_format(
@@ -36,18 +54,26 @@ void CJUnitTestReportWriter::ReportTestEntry(const std::string& testName, const
 			failureDetails += failureLine;
 		}
 		auto resultNode = new Framework::Xml::CNode("failure", true);
+		if(!result.error.empty())
+		{
+			resultNode->InsertAttribute("message", result.error.c_str());
+		}
 		resultNode->InsertTextNode(failureDetails.c_str());
 		testCaseNode->InsertNode(resultNode);
+		m_failureCount++;
 	}
 
 	m_testSuiteNode->InsertNode(testCaseNode);
 
 	m_testCount++;
+	m_totalTime += result.wallTime;
 }
 
 void CJUnitTestReportWriter::Write(const fs::path& reportPath)
 {
 	m_testSuiteNode->InsertAttribute("tests", string_format("%d", m_testCount).c_str());
+	m_testSuiteNode->InsertAttribute("failures", string_format("%d", m_failureCount).c_str());
+	m_testSuiteNode->InsertAttribute("time", string_format("%.3f", m_totalTime).c_str());
 	auto testOutputFileStream = Framework::CreateOutputStdStream(reportPath.native());
 	Framework::Xml::CWriter::WriteDocument(testOutputFileStream, m_reportNode.get());
 }
@@ -18,4 +18,6 @@ private:
 	NodePtr m_reportNode;
 	Framework::Xml::CNode* m_testSuiteNode = nullptr;
 	unsigned int m_testCount = 0;
+	unsigned int m_failureCount = 0;
+	double m_totalTime = 0;
 };
@@ -1,9 +1,15 @@
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 #include "PS2VM.h"
 #include "filesystem_def.h"
 #include "StdStream.h"
 #include "StdStreamUtils.h"
 #include "iop/IopBios.h"
+#include "Profiler.h"
 #include "JUnitTestReportWriter.h"
+#include "ThreadPool.h"
+#include "string_format.h"
 #include "gs/GSH_Null.h"
 #ifdef _WIN32
 #include "gs/GSH_OpenGLWin32/GSH_OpenGLWin32.h"
@@ -16,6 +22,10 @@
 
 #define DEFAULT_GS_HANDLER_NAME GS_HANDLER_NAME_NULL
 
+//In seconds, 0 means tests can run forever
+#define DEFAULT_TIMEOUT 0
+#define POLL_INTERVAL_MS 10
+
 static std::set<std::string> g_validGsHandlersNames =
     {
         GS_HANDLER_NAME_NULL,
@@ -39,6 +49,23 @@ public:
 
 #endif
 
+struct TESTOPTIONS
+{
+	std::string gsHandlerName = DEFAULT_GS_HANDLER_NAME;
+	unsigned int jobCount = std::thread::hardware_concurrency();
+	double timeout = DEFAULT_TIMEOUT;
+};
+
+struct EXECUTIONINFO
+{
+	bool completed = false;
+	uint64 eeCycleCount = 0;
+	uint64 iopCycleCount = 0;
+};
+
+//VM construction registers preferences and profiler zones in shared singletons
+static std::mutex g_vmSetupMutex;
+
 CGSHandler::FactoryFunction GetGsHandlerFactoryFunction(const std::string& gsHandlerName)
 {
 	if(gsHandlerName == GS_HANDLER_NAME_NULL)
@@ -110,19 +137,36 @@ TESTRESULT GetTestResult(const fs::path& testFilePath)
 	return result;
 }
 
-void ExecuteEeTest(const fs::path& testFilePath, const std::string& gsHandlerName)
+bool WaitForExecutionEnd(const std::atomic<bool>& executionOver, double timeout)
+{
+	auto startTime = std::chrono::steady_clock::now();
+	while(!executionOver)
+	{
+		if(timeout > 0)
+		{
+			auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime);
+			if(elapsed.count() >= timeout) return false;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(POLL_INTERVAL_MS));
+	}
+	return true;
+}
+
+EXECUTIONINFO ExecuteEeTest(const fs::path& testFilePath, const TESTOPTIONS& options)
 {
 	auto resultFilePath = testFilePath;
 	resultFilePath.replace_extension(".result");
 	auto resultStream = new Framework::CStdStream(resultFilePath.string().c_str(), "wb");
 
-	bool executionOver = false;
+	std::atomic<bool> executionOver(false);
 
 	//Setup virtual machine
+	std::unique_lock<std::mutex> setupLock(g_vmSetupMutex);
 	CPS2VM virtualMachine;
 	virtualMachine.Initialize();
 	virtualMachine.Reset();
-	virtualMachine.CreateGSHandler(GetGsHandlerFactoryFunction(gsHandlerName));
+	virtualMachine.CreateGSHandler(GetGsHandlerFactoryFunction(options.gsHandlerName));
+	setupLock.unlock();
 	auto connection = virtualMachine.m_ee->m_os->OnRequestExit.Connect(
 	    [&executionOver]() {
 		    executionOver = true;
@@ -134,17 +178,18 @@ void ExecuteEeTest(const fs::path& testFilePath, const std::string& gsHandlerNam
 	}
 	virtualMachine.Resume();
 
-	while(!executionOver)
-	{
-		std::this_thread::sleep_for(std::chrono::milliseconds(100));
-	}
+	EXECUTIONINFO executionInfo;
+	executionInfo.completed = WaitForExecutionEnd(executionOver, options.timeout);
 
 	virtualMachine.Pause();
+	executionInfo.eeCycleCount = virtualMachine.GetEeCycleCount();
+	executionInfo.iopCycleCount = virtualMachine.GetIopCycleCount();
 	virtualMachine.DestroyGSHandler();
 	virtualMachine.Destroy();
+	return executionInfo;
 }
 
-void ExecuteIopTest(const fs::path& testFilePath)
+EXECUTIONINFO ExecuteIopTest(const fs::path& testFilePath, const TESTOPTIONS& options)
 {
 	//Read in the module data
 	std::vector<uint8> moduleData;
@@ -159,12 +204,14 @@ void ExecuteIopTest(const fs::path& testFilePath)
 	resultFilePath.replace_extension(".result");
 	auto resultStream = new Framework::CStdStream(resultFilePath.string().c_str(), "wb");
 
-	bool executionOver = false;
+	std::atomic<bool> executionOver(false);
 	CIopBios::ModuleStartedEvent::Connection connection;
 	//Setup virtual machine
+	std::unique_lock<std::mutex> setupLock(g_vmSetupMutex);
 	CPS2VM virtualMachine;
 	virtualMachine.Initialize();
 	virtualMachine.Reset();
+	setupLock.unlock();
 	{
 		auto iopOs = dynamic_cast<CIopBios*>(virtualMachine.m_iop->m_bios.get());
 		int32 rootModuleId = iopOs->LoadModuleFromHost(moduleData.data());
@@ -180,16 +227,55 @@ void ExecuteIopTest(const fs::path& testFilePath)
 	}
 	virtualMachine.Resume();
 
-	while(!executionOver)
-	{
-		std::this_thread::sleep_for(std::chrono::milliseconds(100));
-	}
+	EXECUTIONINFO executionInfo;
+	executionInfo.completed = WaitForExecutionEnd(executionOver, options.timeout);
 
 	virtualMachine.Pause();
+	executionInfo.eeCycleCount = virtualMachine.GetEeCycleCount();
+	executionInfo.iopCycleCount = virtualMachine.GetIopCycleCount();
 	virtualMachine.Destroy();
+	return executionInfo;
 }
 
-void ScanAndExecuteTests(const fs::path& testDirPath, const TestReportWriterPtr& testReportWriter, const std::string& gsHandlerName)
+TESTRESULT ExecuteTest(const fs::path& testPath, const TESTOPTIONS& options)
+{
+	EXECUTIONINFO executionInfo;
+	std::string error;
+	auto startTime = std::chrono::steady_clock::now();
+	try
+	{
+		if(testPath.extension() == ".elf")
+		{
+			executionInfo = ExecuteEeTest(testPath, options);
+		}
+		else
+		{
+			executionInfo = ExecuteIopTest(testPath, options);
+		}
+		if(!executionInfo.completed)
+		{
+			error = string_format("Test didn't complete within %.0f seconds.", options.timeout);
+		}
+	}
+	catch(const std::exception& exception)
+	{
+		error = string_format("Failed to execute test: %s", exception.what());
+	}
+	auto endTime = std::chrono::steady_clock::now();
+
+	auto result = GetTestResult(testPath);
+	result.wallTime = std::chrono::duration<double>(endTime - startTime).count();
+	result.eeCycleCount = executionInfo.eeCycleCount;
+	result.iopCycleCount = executionInfo.iopCycleCount;
+	if(!error.empty())
+	{
+		result.succeeded = false;
+		result.error = error;
+	}
+	return result;
+}
+
+void ScanTests(const fs::path& testDirPath, std::vector<fs::path>& testPaths)
 {
 	fs::directory_iterator endIterator;
 	for(auto testPathIterator = fs::directory_iterator(testDirPath);
@@ -198,32 +284,62 @@ void ScanAndExecuteTests(const fs::path& testDirPath, const TestReportWriterPtr&
 		auto testPath = testPathIterator->path();
 		if(fs::is_directory(testPath))
 		{
-			ScanAndExecuteTests(testPath, testReportWriter, gsHandlerName);
+			ScanTests(testPath, testPaths);
 			continue;
 		}
-		if(testPath.extension() == ".elf")
+		if((testPath.extension() == ".elf") || (testPath.extension() == ".irx"))
 		{
-			printf("Testing '%s': ", testPath.string().c_str());
-			ExecuteEeTest(testPath, gsHandlerName);
-			auto result = GetTestResult(testPath);
-			printf("%s.\r\n", result.succeeded ? "SUCCEEDED" : "FAILED");
-			if(testReportWriter)
-			{
-				testReportWriter->ReportTestEntry(testPath.string(), result);
-			}
+			testPaths.push_back(testPath);
+		}
+	}
+}
+
+//Every test runs in its own VM, results are reported in scan order once all of them are done
+void ExecuteTests(const std::vector<fs::path>& testPaths, const TestReportWriterPtr& testReportWriter, const TESTOPTIONS& options)
+{
+	std::vector<TESTRESULT> results(testPaths.size());
+	std::mutex outputMutex;
+
+	unsigned int jobCount = std::max<unsigned int>(std::min<unsigned int>(options.jobCount, testPaths.size()), 1);
+	auto startTime = std::chrono::steady_clock::now();
+	{
+		Framework::CThreadPool threadPool(jobCount);
+		for(size_t i = 0; i < testPaths.size(); i++)
+		{
+			threadPool.Enqueue(
+			    [&, i]() {
+				    const auto& testPath = testPaths[i];
+				    auto result = ExecuteTest(testPath, options);
+
+				    std::lock_guard<std::mutex> outputLock(outputMutex);
+				    printf("Testing '%s': %s (%.2fs, %llu EE cycles, %llu IOP cycles).\r\n",
+				           testPath.string().c_str(), result.succeeded ? "SUCCEEDED" : "FAILED", result.wallTime,
+				           static_cast<unsigned long long>(result.eeCycleCount), static_cast<unsigned long long>(result.iopCycleCount));
+				    if(!result.error.empty())
+				    {
+					    printf("\t%s\r\n", result.error.c_str());
+				    }
+				    fflush(stdout);
+				    results[i] = std::move(result);
+			    });
 		}
-		else if(testPath.extension() == ".irx")
+	}
+	auto endTime = std::chrono::steady_clock::now();
+
+	unsigned int succeededCount = 0;
+	for(size_t i = 0; i < testPaths.size(); i++)
+	{
+		const auto& result = results[i];
+		if(result.succeeded) succeededCount++;
+		if(testReportWriter)
 		{
-			printf("Testing '%s': ", testPath.string().c_str());
-			ExecuteIopTest(testPath);
-			auto result = GetTestResult(testPath);
-			printf("%s.\r\n", result.succeeded ? "SUCCEEDED" : "FAILED");
-			if(testReportWriter)
-			{
-				testReportWriter->ReportTestEntry(testPath.string(), result);
-			}
+			testReportWriter->ReportTestEntry(testPaths[i].string(), result);
 		}
 	}
+
+	printf("%d of %d tests succeeded in %.2fs using %d jobs.\r\n",
+	       succeededCount, static_cast<int>(testPaths.size()),
+	       std::chrono::duration<double>(endTime - startTime).count(), jobCount);
 }
 
 int main(int argc, const char** argv)
@@ -248,16 +364,20 @@ int main(int argc, const char** argv)
 		printf("Usage: AutoTest [options] testDir\r\n");
 		printf("Options: \r\n");
 		printf("\t --junitreport <path>\t Writes JUnit format report at <path>.\r\n");
+		printf("\t --profiletrace <path>\t Writes a Chrome trace format profile of the test run at <path> (requires a PROFILE build).\r\n");
 		printf("\t --gshandler <%s>\tSelects which GS handler to instantiate (default is '%s').\r\n",
 		       validGsHandlerNamesString.c_str(), DEFAULT_GS_HANDLER_NAME);
+		printf("\t --jobs <count>\t Amount of tests executed simultaneously (default is CPU count).\r\n");
+		printf("\t --timeout <seconds>\t Fails tests that don't complete in time (default is no timeout).\r\n");
 		return -1;
 	}
 
 	TestReportWriterPtr testReportWriter;
 	fs::path autoTestRoot;
 	fs::path reportPath;
-	std::string gsHandlerName = DEFAULT_GS_HANDLER_NAME;
-	assert(g_validGsHandlersNames.find(gsHandlerName) != std::end(g_validGsHandlersNames));
+	fs::path profileTracePath;
+	TESTOPTIONS options;
+	assert(g_validGsHandlersNames.find(options.gsHandlerName) != std::end(g_validGsHandlersNames));
 
 	for(int i = 1; i < argc; i++)
 	{
@@ -272,6 +392,16 @@ int main(int argc, const char** argv)
 			reportPath = fs::path(argv[i + 1]);
 			i++;
 		}
+		else if(!strcmp(argv[i], "--profiletrace"))
+		{
+			if((i + 1) >= argc)
+			{
+				printf("Error: Path must be specified for --profiletrace option.\r\n");
+				return -1;
+			}
+			profileTracePath = fs::path(argv[i + 1]);
+			i++;
+		}
 		else if(!strcmp(argv[i], "--gshandler"))
 		{
 			if((i + 1) >= argc)
@@ -279,14 +409,34 @@ int main(int argc, const char** argv)
 				printf("Error: GS handler name must be specified for --gshandler option.\r\n");
 				return -1;
 			}
-			gsHandlerName = argv[i + 1];
-			if(g_validGsHandlersNames.find(gsHandlerName) == std::end(g_validGsHandlersNames))
+			options.gsHandlerName = argv[i + 1];
+			if(g_validGsHandlersNames.find(options.gsHandlerName) == std::end(g_validGsHandlersNames))
 			{
-				printf("Error: Invalid GS handler name '%s'.\r\n", gsHandlerName.c_str());
+				printf("Error: Invalid GS handler name '%s'.\r\n", options.gsHandlerName.c_str());
 				return -1;
 			}
 			i++;
 		}
+		else if(!strcmp(argv[i], "--jobs"))
+		{
+			if((i + 1) >= argc)
+			{
+				printf("Error: Count must be specified for --jobs option.\r\n");
+				return -1;
+			}
+			options.jobCount = std::max(atoi(argv[i + 1]), 1);
+			i++;
+		}
+		else if(!strcmp(argv[i], "--timeout"))
+		{
+			if((i + 1) >= argc)
+			{
+				printf("Error: Time must be specified for --timeout option.\r\n");
+				return -1;
+			}
+			options.timeout = std::max(atof(argv[i + 1]), 0.0);
+			i++;
+		}
 		else
 		{
 			autoTestRoot = argv[i];
@@ -300,9 +450,27 @@ int main(int argc, const char** argv)
 		return -1;
 	}
 
+	if(!profileTracePath.empty())
+	{
+#ifndef PROFILE
+		printf("Warning: Profiling support wasn't enabled in this build, profile trace will be empty.\r\n");
+#endif
+		CProfiler::GetInstance().BeginCapture();
+	}
+
+	if((options.gsHandlerName != GS_HANDLER_NAME_NULL) && (options.jobCount > 1))
+	{
+		//Other GS handlers all render in the same test window
+		printf("Warning: GS handler '%s' doesn't support parallel execution, running tests one at a time.\r\n",
+		       options.gsHandlerName.c_str());
+		options.jobCount = 1;
+	}
+
 	try
 	{
-		ScanAndExecuteTests(autoTestRoot, testReportWriter, gsHandlerName);
+		std::vector<fs::path> testPaths;
+		ScanTests(autoTestRoot, testPaths);
+		ExecuteTests(testPaths, testReportWriter, options);
 	}
 	catch(const std::exception& exception)
 	{
@@ -310,6 +478,21 @@ int main(int argc, const char** argv)
 		return -1;
 	}
 
+	if(!profileTracePath.empty())
+	{
+		try
+		{
+			CProfiler::GetInstance().EndCapture();
+			auto profileTraceStream = Framework::CreateOutputStdStream(profileTracePath.native());
+			CProfiler::GetInstance().WriteChromeTrace(profileTraceStream);
+		}
+		catch(const std::exception& exception)
+		{
+			printf("Error: Failed to write profile trace: %s\r\n", exception.what());
+			return -1;
+		}
+	}
+
 	if(testReportWriter)
 	{
 		try
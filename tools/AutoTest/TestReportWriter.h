@@ -1,6 +1,7 @@
 #pragma once
 
 #include "filesystem_def.h"
+#include "Types.h"
 #include <string>
 #include <memory>
 #include <vector>
@@ -17,6 +18,12 @@ struct TESTRESULT
 
 	bool succeeded = false;
 	LineDiffArray lineDiffs;
+	//Set when the test couldn't be executed to completion (ex.: timeout)
+	std::string error;
+
+	double wallTime = 0;
+	uint64 eeCycleCount = 0;
+	uint64 iopCycleCount = 0;
 };
 
 class CTestReportWriter
@@ -0,0 +1,140 @@
+#include <stdio.h>
+#include <algorithm>
+#include "AppConfig.h"
+#include "PathUtils.h"
+#include "StdStreamUtils.h"
+#include "sqlite/SqliteDb.h"
+#include "sqlite/SqliteStatement.h"
+#include "ui_shared/BootablesDbClient.h"
+#include "ui_shared/BootablesProcesses.h"
+
+#define CHECK(condition)        \
+	if(!(condition))            \
+	{                           \
+		throw std::exception(); \
+	}
+
+static const char* g_migratedBootablePath = "/games/migrated.iso";
+
+static fs::path GetDbPath()
+{
+	return CAppConfig::GetBasePath() / "bootables.db";
+}
+
+static void WriteFile(const fs::path& path, uint32 size)
+{
+	auto stream = Framework::CreateOutputStdStream(path.native());
+	for(uint32 i = 0; i < size; i++)
+	{
+		stream.Write8(static_cast<uint8>(i));
+	}
+}
+
+static bool HasUnbootable(const fs::path& path)
+{
+	auto unbootables = BootablesDb::CClient::GetInstance().GetUnbootables();
+	return std::count_if(unbootables.begin(), unbootables.end(),
+	                     [&path](const auto& unbootable) { return unbootable.path == path; }) == 1;
+}
+
+//Creates a database as it was before file info was tracked
+void PrepareVersion2Database()
+{
+	auto dbPath = GetDbPath();
+	fs::remove(dbPath);
+
+	Framework::CSqliteDb db(Framework::PathUtils::GetNativeStringFromPath(dbPath).c_str(),
+	                        SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+	{
+		Framework::CSqliteStatement statement(db, "PRAGMA user_version = 2");
+		statement.StepNoResult();
+	}
+	{
+		Framework::CSqliteStatement statement(db,
+		                                      "CREATE TABLE bootables"
+		                                      "("
+		                                      "    path TEXT PRIMARY KEY,"
+		                                      "    discId VARCHAR(10) DEFAULT '',"
+		                                      "    title TEXT DEFAULT '',"
+		                                      "    coverUrl TEXT DEFAULT '',"
+		                                      "    lastBootedTime INTEGER DEFAULT 0,"
+		                                      "    overview TEXT DEFAULT ''"
+		                                      ")");
+		statement.StepNoResult();
+	}
+	{
+		Framework::CSqliteStatement statement(db, "INSERT INTO bootables (path, discId, title, lastBootedTime) VALUES (?, 'SLUS_123.45', 'Migrated', 1234)");
+		statement.BindText(1, g_migratedBootablePath);
+		statement.StepNoResult();
+	}
+}
+
+//Existing rows must survive the upgrade to the current schema
+void ExecuteMigrationTest()
+{
+	auto bootable = BootablesDb::CClient::GetInstance().GetBootable(g_migratedBootablePath);
+	CHECK(bootable.discId == "SLUS_123.45");
+	CHECK(bootable.title == "Migrated");
+	CHECK(bootable.lastBootedTime == 1234);
+	CHECK(bootable.fileSize == 0);
+	CHECK(bootable.fileTime == 0);
+
+	Framework::CSqliteDb db(Framework::PathUtils::GetNativeStringFromPath(GetDbPath()).c_str(), SQLITE_OPEN_READONLY);
+	Framework::CSqliteStatement statement(db, "PRAGMA user_version");
+	statement.StepWithResult();
+	CHECK(sqlite3_column_int(statement, 0) == 3);
+}
+
+//Unchanged files, including ones that failed to be probed, must not be probed again
+void ExecuteRescanTest()
+{
+	auto scanPath = CAppConfig::GetBasePath() / "scan";
+	fs::remove_all(scanPath);
+	Framework::PathUtils::EnsurePathExists(scanPath);
+
+	auto executablePath = scanPath / "game.elf";
+	auto invalidImagePath = scanPath / "invalid.iso";
+	WriteFile(executablePath, 0x100);
+	WriteFile(invalidImagePath, 0x1000);
+
+	{
+		auto stats = ScanBootables(scanPath, false);
+		CHECK(stats.foundFileCount == 2);
+		CHECK(stats.skippedFileCount == 0);
+		CHECK(stats.probedFileCount == 1);
+		CHECK(stats.registeredFileCount == 1);
+		CHECK(BootablesDb::CClient::GetInstance().GetBootable(executablePath).fileSize == 0x100);
+		CHECK(HasUnbootable(invalidImagePath));
+	}
+
+	{
+		auto stats = ScanBootables(scanPath, false);
+		CHECK(stats.foundFileCount == 2);
+		CHECK(stats.skippedFileCount == 2);
+		CHECK(stats.probedFileCount == 0);
+		CHECK(stats.registeredFileCount == 0);
+	}
+
+	//A different size means the file changed and needs to be probed again
+	WriteFile(invalidImagePath, 0x2000);
+	{
+		auto stats = ScanBootables(scanPath, false);
+		CHECK(stats.skippedFileCount == 1);
+		CHECK(stats.probedFileCount == 1);
+	}
+
+	fs::remove(invalidImagePath);
+	PurgeInexistingFiles();
+	CHECK(!HasUnbootable(invalidImagePath));
+}
+
+int main(int argc, const char** argv)
+{
+	Framework::PathUtils::EnsurePathExists(CAppConfig::GetBasePath());
+
+	PrepareVersion2Database();
+	ExecuteMigrationTest();
+	ExecuteRescanTest();
+
+	return 0;
+}
@@ -0,0 +1,16 @@
+#include "MappedBlockProviderTest.h"
+#include "ReadQueueTest.h"
+#include "StreamPrefetcherTest.h"
+
+int main(int argc, const char** argv)
+{
+	ExecuteMappedBlockProviderTruncatedTest();
+	ExecuteMappedBlockProviderRawTest();
+	ExecuteMappedFileStreamRejectTest();
+	ExecuteReadQueueOrderTest();
+	ExecuteReadQueueStateTest();
+	ExecuteReadQueueMediaSwapTest();
+	ExecuteStreamPrefetcherFillTest();
+	ExecuteStreamPrefetcherUnderrunTest();
+	return 0;
+}
@@ -0,0 +1,129 @@
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "MappedBlockProviderTest.h"
+#include "Test.h"
+#include "MappedFileStream.h"
+#include "StdStreamUtils.h"
+#include "ISO9660/BlockProvider.h"
+
+#define BLOCK_SIZE ISO9660::CBlockProvider::BLOCKSIZE
+#define RAW_BLOCK_SIZE ISO9660::CBlockProviderMapped::RAW_BLOCKSIZE
+#define RAW_BLOCK_HEADER_SIZE ISO9660::CBlockProviderMapped::RAW_BLOCKHEADER_SIZE
+
+static fs::path GetTestImagePath()
+{
+	return fs::path("./mappedtest.iso");
+}
+
+static std::vector<uint8> MakeTestImage(uint32 size)
+{
+	std::vector<uint8> data(size);
+	for(uint32 i = 0; i < size; i++)
+	{
+		data[i] = static_cast<uint8>((i * 5) + (i >> 11) + 1);
+	}
+	auto stream = Framework::CreateOutputStdStream(GetTestImagePath().native());
+	stream.Write(data.data(), data.size());
+	return data;
+}
+
+static bool IsZero(const uint8* data, uint32 size)
+{
+	for(uint32 i = 0; i < size; i++)
+	{
+		if(data[i] != 0) return false;
+	}
+	return true;
+}
+
+//Images that don't end on a block boundary (or that are shorter than what their file system
+//says) are read like they were padded with zeroes
+void ExecuteMappedBlockProviderTruncatedTest()
+{
+	static const uint32 tailSize = 0x100;
+	auto data = MakeTestImage((2 * BLOCK_SIZE) + tailSize);
+
+	{
+		auto stream = std::make_shared<CMappedFileStream>(GetTestImagePath());
+		ISO9660::CBlockProviderMapped blockProvider(stream);
+		CHECK(blockProvider.IsMemoryMapped());
+
+		std::vector<uint8> blocks(4 * BLOCK_SIZE, 0xCC);
+		blockProvider.ReadBlocks(0, 2, blocks.data());
+		CHECK(memcmp(blocks.data(), data.data(), 2 * BLOCK_SIZE) == 0);
+
+		std::fill(blocks.begin(), blocks.end(), 0xCC);
+		blockProvider.ReadBlock(2, blocks.data());
+		CHECK(memcmp(blocks.data(), data.data() + (2 * BLOCK_SIZE), tailSize) == 0);
+		CHECK(IsZero(blocks.data() + tailSize, BLOCK_SIZE - tailSize));
+
+		std::fill(blocks.begin(), blocks.end(), 0xCC);
+		blockProvider.ReadBlocks(1, 4, blocks.data());
+		CHECK(memcmp(blocks.data(), data.data() + BLOCK_SIZE, BLOCK_SIZE + tailSize) == 0);
+		CHECK(IsZero(blocks.data() + BLOCK_SIZE + tailSize, (3 * BLOCK_SIZE) - tailSize));
+
+		//Sequential reads past the end shouldn't cause problems with access hints
+		for(uint32 i = 0; i < 8; i++)
+		{
+			blockProvider.ReadBlock(i, blocks.data());
+		}
+	}
+
+	fs::remove(GetTestImagePath());
+}
+
+//Headers of raw sectors are stripped, last sector is cut in the middle of its data
+void ExecuteMappedBlockProviderRawTest()
+{
+	static const uint32 missingSize = 0x400;
+	auto data = MakeTestImage((3 * RAW_BLOCK_SIZE) - missingSize);
+
+	{
+		auto stream = std::make_shared<CMappedFileStream>(GetTestImagePath());
+		ISO9660::CBlockProviderMapped blockProvider(stream, RAW_BLOCK_SIZE, RAW_BLOCK_HEADER_SIZE);
+
+		std::vector<uint8> blocks(3 * BLOCK_SIZE, 0xCC);
+		blockProvider.ReadBlocks(0, 3, blocks.data());
+		for(uint32 i = 0; i < 2; i++)
+		{
+			CHECK(memcmp(blocks.data() + (i * BLOCK_SIZE), data.data() + (i * RAW_BLOCK_SIZE) + RAW_BLOCK_HEADER_SIZE, BLOCK_SIZE) == 0);
+		}
+		uint32 lastBlockSize = RAW_BLOCK_SIZE - RAW_BLOCK_HEADER_SIZE - missingSize;
+		CHECK(memcmp(blocks.data() + (2 * BLOCK_SIZE), data.data() + (2 * RAW_BLOCK_SIZE) + RAW_BLOCK_HEADER_SIZE, lastBlockSize) == 0);
+		CHECK(IsZero(blocks.data() + (2 * BLOCK_SIZE) + lastBlockSize, BLOCK_SIZE - lastBlockSize));
+	}
+
+	fs::remove(GetTestImagePath());
+}
+
+//Files that can't be mapped safely are rejected, callers fall back to a regular stream
+void ExecuteMappedFileStreamRejectTest()
+{
+	auto directoryPath = fs::path("./mappedtestdir");
+	fs::create_directory(directoryPath);
+	bool directoryRejected = false;
+	try
+	{
+		CMappedFileStream stream(directoryPath);
+	}
+	catch(const std::exception&)
+	{
+		directoryRejected = true;
+	}
+	fs::remove(directoryPath);
+	CHECK(directoryRejected);
+
+	MakeTestImage(0);
+	bool emptyFileRejected = false;
+	try
+	{
+		CMappedFileStream stream(GetTestImagePath());
+	}
+	catch(const std::exception&)
+	{
+		emptyFileRejected = true;
+	}
+	fs::remove(GetTestImagePath());
+	CHECK(emptyFileRejected);
+}
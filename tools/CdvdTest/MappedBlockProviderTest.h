@@ -0,0 +1,5 @@
+#pragma once
+
+void ExecuteMappedBlockProviderTruncatedTest();
+void ExecuteMappedBlockProviderRawTest();
+void ExecuteMappedFileStreamRejectTest();
@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <vector>
+#include "ReadQueueTest.h"
+#include "Test.h"
+#include "TestImage.h"
+#include "iop/IopBios.h"
+#include "iop/Iop_Cdvdman.h"
+#include "iop/Iop_SubSystem.h"
+#include "states/RegisterStateFile.h"
+
+//Reads are serviced one after the other, each one only completing once its emulated time has elapsed
+void ExecuteReadQueueOrderTest()
+{
+	Iop::CSubSystem subSystem(true);
+	subSystem.Reset();
+	auto bios = static_cast<CIopBios*>(subSystem.m_bios.get());
+	bios->Reset(std::shared_ptr<Iop::CSifMan>());
+	auto& readQueue = bios->GetCdvdman()->GetReadQueue();
+
+	uint64 startTime = bios->GetCurrentTime();
+	auto request0 = readQueue.QueueRead(0, 0x10);
+	auto request1 = readQueue.QueueRead(0x10, 0x10);
+	auto request2 = readQueue.QueueRead(0x100000, 0x10);
+	CHECK(request0 != Iop::CCdvdReadQueue::INVALID_REQUEST_ID);
+	CHECK((request0 != request1) && (request1 != request2));
+
+	uint64 completionTime0 = readQueue.GetCompletionTime(request0);
+	uint64 completionTime1 = readQueue.GetCompletionTime(request1);
+	uint64 completionTime2 = readQueue.GetCompletionTime(request2);
+	CHECK(completionTime0 > startTime);
+
+	//Second read is contiguous to the first one, it only costs the transfer time
+	uint64 transferTime = completionTime0 - startTime;
+	CHECK((completionTime1 - completionTime0) == transferTime);
+
+	//Third read requires a seek
+	CHECK((completionTime2 - completionTime1) > transferTime);
+
+	CHECK(!readQueue.IsAnyReadDue(bios->GetCurrentTime()));
+	CHECK(!readQueue.IsReadComplete(request0));
+
+	bios->CountTicks(static_cast<uint32>(transferTime - 1));
+	CHECK(!readQueue.IsAnyReadDue(bios->GetCurrentTime()));
+	CHECK(!readQueue.IsReadComplete(request0));
+
+	bios->CountTicks(1);
+	CHECK(readQueue.IsAnyReadDue(bios->GetCurrentTime()));
+	CHECK(readQueue.IsReadComplete(request0));
+	CHECK(!readQueue.IsReadComplete(request1));
+	readQueue.FinishRead(request0, nullptr);
+
+	bios->CountTicks(static_cast<uint32>(completionTime2 - bios->GetCurrentTime()));
+	CHECK(readQueue.IsReadComplete(request1));
+	CHECK(readQueue.IsReadComplete(request2));
+	readQueue.FinishRead(request1, nullptr);
+	readQueue.FinishRead(request2, nullptr);
+	CHECK(!readQueue.IsAnyReadDue(bios->GetCurrentTime()));
+
+	//Drive is idle, a new read is timed from the current time
+	uint64 idleTime = bios->GetCurrentTime();
+	auto request3 = readQueue.QueueRead(0x100010, 0x10);
+	CHECK(readQueue.GetCompletionTime(request3) == (idleTime + transferTime));
+	readQueue.FinishRead(request3, nullptr);
+}
+
+//Drive timing must survive a save state, older states start with an idle drive
+void ExecuteReadQueueStateTest()
+{
+	Iop::CSubSystem subSystem(true);
+	subSystem.Reset();
+	auto bios = static_cast<CIopBios*>(subSystem.m_bios.get());
+	bios->Reset(std::shared_ptr<Iop::CSifMan>());
+	auto& readQueue = bios->GetCdvdman()->GetReadQueue();
+
+	uint64 startTime = bios->GetCurrentTime();
+	auto request0 = readQueue.QueueRead(0, 0x10);
+	uint64 completionTime0 = readQueue.GetCompletionTime(request0);
+	uint64 transferTime = completionTime0 - startTime;
+
+	CRegisterStateFile registerFile("state.xml");
+	readQueue.SaveState(registerFile);
+
+	readQueue.Reset();
+	readQueue.LoadState(registerFile);
+
+	auto restoredRequest0 = readQueue.RestoreRead(0, 0x10, completionTime0);
+	CHECK(readQueue.GetCompletionTime(restoredRequest0) == completionTime0);
+
+	//Drive is still busy with the restored read, the next one is queued behind it
+	auto request1 = readQueue.QueueRead(0x10, 0x10);
+	CHECK(readQueue.GetCompletionTime(request1) == (completionTime0 + transferTime));
+
+	readQueue.Reset();
+	readQueue.LoadState(CRegisterStateFile("empty.xml"));
+
+	auto request2 = readQueue.QueueRead(0, 0x10);
+	CHECK(readQueue.GetCompletionTime(request2) == (bios->GetCurrentTime() + transferTime));
+}
+
+//Reads in flight when the media is swapped or the drive is reset must still complete for the
+//modules waiting on them, without data and with an error reported by the drive
+void ExecuteReadQueueMediaSwapTest()
+{
+	auto imageA = MakeTestImage(0x00);
+	auto imageB = MakeTestImage(0x55);
+	auto opticalMediaA = MakeTestOpticalMedia(imageA);
+	auto opticalMediaB = MakeTestOpticalMedia(imageB);
+
+	Iop::CSubSystem subSystem(true);
+	subSystem.Reset();
+	auto bios = static_cast<CIopBios*>(subSystem.m_bios.get());
+	bios->Reset(std::shared_ptr<Iop::CSifMan>());
+	auto& readQueue = bios->GetCdvdman()->GetReadQueue();
+	readQueue.SetOpticalMedia(opticalMediaA.get());
+	CHECK(readQueue.GetLastError() == Iop::CCdvdReadQueue::DRIVE_ERROR_NONE);
+
+	static const uint32 sector = 0x20;
+	static const uint32 count = 0x10;
+	std::vector<uint8> buffer(count * SECTOR_SIZE, 0xCC);
+
+	auto request0 = readQueue.QueueRead(sector, count);
+	CHECK(!readQueue.IsReadComplete(request0));
+
+	readQueue.SetOpticalMedia(opticalMediaB.get());
+	CHECK(readQueue.IsAnyReadDue(bios->GetCurrentTime()));
+	CHECK(readQueue.IsReadComplete(request0));
+	CHECK(readQueue.GetCompletionTime(request0) == 0);
+	CHECK(!readQueue.FinishRead(request0, buffer.data()));
+	CHECK(std::all_of(std::begin(buffer), std::end(buffer), [](uint8 value) { return value == 0xCC; }));
+	CHECK(readQueue.GetLastError() == Iop::CCdvdReadQueue::DRIVE_ERROR_ABORTED);
+	CHECK(!readQueue.IsAnyReadDue(bios->GetCurrentTime()));
+
+	//Next read comes from the new media and clears the error
+	auto request1 = readQueue.QueueRead(sector, count);
+	bios->CountTicks(static_cast<uint32>(readQueue.GetCompletionTime(request1) - bios->GetCurrentTime()));
+	CHECK(readQueue.IsReadComplete(request1));
+	CHECK(readQueue.FinishRead(request1, buffer.data()));
+	CHECK(MatchesTestImage(imageB, sector, count, buffer.data()));
+	CHECK(readQueue.GetLastError() == Iop::CCdvdReadQueue::DRIVE_ERROR_NONE);
+
+	auto request2 = readQueue.QueueRead(sector, count);
+	readQueue.Reset();
+	CHECK(readQueue.IsReadComplete(request2));
+	CHECK(!readQueue.FinishRead(request2, nullptr));
+	CHECK(readQueue.GetLastError() == Iop::CCdvdReadQueue::DRIVE_ERROR_ABORTED);
+
+	//Loading a state forgets aborted reads, their owners reissue what they need
+	auto request3 = readQueue.QueueRead(sector, count);
+	readQueue.Reset();
+	readQueue.LoadState(CRegisterStateFile("empty.xml"));
+	CHECK(!readQueue.IsAnyReadDue(bios->GetCurrentTime()));
+	CHECK(!readQueue.FinishRead(request3, nullptr));
+	CHECK(readQueue.GetLastError() == Iop::CCdvdReadQueue::DRIVE_ERROR_NONE);
+
+	readQueue.SetOpticalMedia(nullptr);
+}
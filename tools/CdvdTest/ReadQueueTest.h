@@ -0,0 +1,5 @@
+#pragma once
+
+void ExecuteReadQueueOrderTest();
+void ExecuteReadQueueStateTest();
+void ExecuteReadQueueMediaSwapTest();
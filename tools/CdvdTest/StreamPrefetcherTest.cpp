@@ -0,0 +1,102 @@
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "StreamPrefetcherTest.h"
+#include "Test.h"
+#include "TestImage.h"
+#include "iop/CdvdStreamPrefetcher.h"
+
+#define STREAM_DEPTH 0x40
+
+static void WaitForBufferedSectors(Iop::CCdvdStreamPrefetcher& prefetcher, uint32 count)
+{
+	for(uint32 i = 0; i < 1000; i++)
+	{
+		if(prefetcher.GetBufferedSectorCount() >= count) return;
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	CHECK(false);
+}
+
+//Sequential reads are served from the ring as long as the worker keeps up, including when
+//they wrap around the end of the ring
+void ExecuteStreamPrefetcherFillTest()
+{
+	auto image = MakeTestImage();
+	auto opticalMedia = MakeTestOpticalMedia(image);
+
+	Iop::CCdvdStreamPrefetcher prefetcher;
+	prefetcher.SetOpticalMedia(opticalMedia.get());
+	prefetcher.SetDepth(STREAM_DEPTH);
+
+	uint32 sector = 0x20;
+	prefetcher.Start(sector);
+
+	std::vector<uint8> buffer(STREAM_DEPTH * SECTOR_SIZE);
+	static const uint32 readCount = 7;
+	for(uint32 i = 0; i < 0x20; i++)
+	{
+		WaitForBufferedSectors(prefetcher, STREAM_DEPTH);
+		prefetcher.Read(sector, readCount, buffer.data());
+		CHECK(MatchesTestImage(image, sector, readCount, buffer.data()));
+		sector += readCount;
+	}
+
+	auto stats = prefetcher.GetStats();
+	CHECK(stats.sectorsRead == (0x20 * readCount));
+	CHECK(stats.sectorsFromBuffer == stats.sectorsRead);
+	CHECK(stats.underruns == 0);
+	CHECK(stats.underrunSectors == 0);
+
+	prefetcher.ResetStats();
+	stats = prefetcher.GetStats();
+	CHECK(stats.sectorsRead == 0);
+	CHECK(stats.sectorsFromBuffer == 0);
+
+	prefetcher.Stop();
+}
+
+//Reads that can't be served from the ring are read directly and counted as underruns
+void ExecuteStreamPrefetcherUnderrunTest()
+{
+	auto image = MakeTestImage();
+	auto opticalMedia = MakeTestOpticalMedia(image);
+
+	Iop::CCdvdStreamPrefetcher prefetcher;
+	prefetcher.SetOpticalMedia(opticalMedia.get());
+	prefetcher.SetDepth(STREAM_DEPTH);
+
+	prefetcher.Start(0x20);
+	WaitForBufferedSectors(prefetcher, STREAM_DEPTH);
+
+	//Larger than the ring, part of it is read directly
+	std::vector<uint8> buffer((STREAM_DEPTH + 0x10) * SECTOR_SIZE);
+	prefetcher.Read(0x20, STREAM_DEPTH + 0x10, buffer.data());
+	CHECK(MatchesTestImage(image, 0x20, STREAM_DEPTH + 0x10, buffer.data()));
+
+	auto stats = prefetcher.GetStats();
+	CHECK(stats.sectorsRead == (STREAM_DEPTH + 0x10));
+	CHECK(stats.sectorsFromBuffer == STREAM_DEPTH);
+	CHECK(stats.underruns == 1);
+	CHECK(stats.underrunSectors == 0x10);
+
+	//Reading from somewhere else restarts the stream, nothing is buffered there yet
+	prefetcher.ResetStats();
+	prefetcher.Read(0x200, 4, buffer.data());
+	CHECK(MatchesTestImage(image, 0x200, 4, buffer.data()));
+
+	stats = prefetcher.GetStats();
+	CHECK(stats.sectorsRead == 4);
+	CHECK(stats.sectorsFromBuffer == 0);
+	CHECK(stats.underruns == 1);
+	CHECK(stats.underrunSectors == 4);
+
+	//Stream continues after the directly read sectors
+	WaitForBufferedSectors(prefetcher, STREAM_DEPTH);
+	prefetcher.Read(0x204, 4, buffer.data());
+	CHECK(MatchesTestImage(image, 0x204, 4, buffer.data()));
+	CHECK(prefetcher.GetStats().underruns == 1);
+
+	prefetcher.Stop();
+}
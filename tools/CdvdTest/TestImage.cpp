@@ -0,0 +1,37 @@
+#include <cstring>
+#include "TestImage.h"
+#include "MemStream.h"
+
+std::vector<uint8> MakeTestImage(uint8 seed)
+{
+	std::vector<uint8> image(IMAGE_SECTOR_COUNT * SECTOR_SIZE);
+	for(uint32 sector = PATH_TABLE_SECTOR + 1; sector < IMAGE_SECTOR_COUNT; sector++)
+	{
+		auto sectorData = image.data() + (sector * SECTOR_SIZE);
+		for(uint32 i = 0; i < SECTOR_SIZE; i++)
+		{
+			sectorData[i] = static_cast<uint8>(sector + (i * 13) + seed);
+		}
+	}
+
+	auto volumeDescriptor = image.data() + (VOLUME_DESCRIPTOR_SECTOR * SECTOR_SIZE);
+	volumeDescriptor[0] = 0x01;
+	memcpy(volumeDescriptor + 1, "CD001", 5);
+	uint32 pathTableSector = PATH_TABLE_SECTOR;
+	memcpy(volumeDescriptor + 140, &pathTableSector, sizeof(uint32));
+
+	return image;
+}
+
+std::unique_ptr<COpticalMedia> MakeTestOpticalMedia(const std::vector<uint8>& image)
+{
+	auto stream = std::make_shared<Framework::CMemStream>();
+	stream->Write(image.data(), image.size());
+	auto opticalMediaStream = std::static_pointer_cast<Framework::CStream>(stream);
+	return std::unique_ptr<COpticalMedia>(COpticalMedia::CreateDvd(opticalMediaStream));
+}
+
+bool MatchesTestImage(const std::vector<uint8>& image, uint32 sector, uint32 count, const uint8* data)
+{
+	return memcmp(image.data() + (sector * SECTOR_SIZE), data, count * SECTOR_SIZE) == 0;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "Types.h"
+#include "OpticalMedia.h"
+
+#define SECTOR_SIZE 0x800
+#define IMAGE_SECTOR_COUNT 0x400
+#define VOLUME_DESCRIPTOR_SECTOR 0x10
+#define PATH_TABLE_SECTOR 0x11
+
+//Builds a disc image with an empty file system, sectors past the path table are filled with a
+//pattern that depends on the sector index and the seed
+std::vector<uint8> MakeTestImage(uint8 seed = 0);
+std::unique_ptr<COpticalMedia> MakeTestOpticalMedia(const std::vector<uint8>&);
+bool MatchesTestImage(const std::vector<uint8>&, uint32 sector, uint32 count, const uint8* data);
@@ -0,0 +1,164 @@
+#include <cstring>
+#include "GifReplayCacheTest.h"
+#include "ee/GIF.h"
+#include "ee/GifReplayCache.h"
+#include "gs/GSH_Null.h"
+
+#define TEST_TADR 0x1000
+#define TEST_CHCR 0x0145
+#define TEST_SOURCE_ADDRESS 0x2000
+#define TEST_SOURCE_QWC 2
+
+//Same constants as the hash used by the cache
+static const uint64 PRIME64_1 = 0x9E3779B185EBCA87ULL;
+static const uint64 PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+
+static uint64 MixRound(uint64 acc, uint64 input)
+{
+	acc += input * PRIME64_2;
+	acc = (acc << 31) | (acc >> 33);
+	return acc * PRIME64_1;
+}
+
+//Inverse of an odd number modulo 2^64, each iteration doubles the amount of correct bits
+static uint64 InverseOdd(uint64 value)
+{
+	uint64 inverse = value;
+	for(unsigned int i = 0; i < 5; i++)
+	{
+		inverse *= 2 - (value * inverse);
+	}
+	return inverse;
+}
+
+class CReplayCacheFixture
+{
+public:
+	CReplayCacheFixture(uint8* ram)
+	    : m_gs(new CGSH_Null())
+	    , m_gif(m_gs, nullptr, nullptr)
+	    , m_cache(m_gif, ram)
+	{
+		m_gs->Initialize();
+		m_gs->Reset();
+		m_gif.Reset();
+		m_cache.SetEnabled(true);
+	}
+
+	~CReplayCacheFixture()
+	{
+		m_gs->Release();
+		delete m_gs;
+	}
+
+	bool Record(uint32 qwc)
+	{
+		if(!m_cache.BeginRecording(TEST_TADR, TEST_CHCR)) return false;
+		m_cache.RecordSource(TEST_SOURCE_ADDRESS, qwc);
+		CGsRegisterWriteBuffer registerWrites;
+		registerWrites.Push(GS_REG_PRIM, 0x06);
+		m_cache.RecordRegisterWrites(registerWrites);
+		Dmac::CSourceChainCache::CHANNELSTATE channelState;
+		channelState.tadr = TEST_TADR + 0x10;
+		m_cache.EndRecording(channelState);
+		return true;
+	}
+
+	bool Replay()
+	{
+		Dmac::CSourceChainCache::CHANNELSTATE channelState;
+		return m_cache.Replay(TEST_TADR, TEST_CHCR, channelState);
+	}
+
+	CGifReplayCache& GetCache()
+	{
+		return m_cache;
+	}
+
+private:
+	CGSHandler* m_gs = nullptr;
+	CGIF m_gif;
+	CGifReplayCache m_cache;
+};
+
+void CGifReplayCacheTest::Execute(CTestVm& virtualMachine)
+{
+	ExecuteSourceChangeTest(virtualMachine);
+	ExecuteHashCollisionTest(virtualMachine);
+	ExecuteSourceLimitTest(virtualMachine);
+}
+
+//Without dirty page tracking, source memory is checked every time a chain is replayed
+void CGifReplayCacheTest::ExecuteSourceChangeTest(CTestVm& virtualMachine)
+{
+	virtualMachine.Reset();
+	auto source = virtualMachine.m_ram + TEST_SOURCE_ADDRESS;
+	for(uint32 i = 0; i < TEST_SOURCE_QWC * 0x10; i++)
+	{
+		source[i] = static_cast<uint8>(i * 3);
+	}
+
+	CReplayCacheFixture fixture(virtualMachine.m_ram);
+	TEST_VERIFY(!fixture.Replay());
+	TEST_VERIFY(fixture.Record(TEST_SOURCE_QWC));
+	TEST_VERIFY(fixture.Replay());
+
+	source[0x13] ^= 0xFF;
+	TEST_VERIFY(!fixture.Replay());
+
+	source[0x13] ^= 0xFF;
+	TEST_VERIFY(fixture.Replay());
+
+	fixture.GetCache().EndFrame();
+	auto stats = fixture.GetCache().GetFrameStats();
+	TEST_VERIFY(stats.lookupCount == 4);
+	TEST_VERIFY(stats.hitCount == 2);
+	TEST_VERIFY(stats.hashCount == 3);
+	TEST_VERIFY(stats.recordCount == 1);
+}
+
+//Source memory that hashes to the same value must still be detected as changed
+void CGifReplayCacheTest::ExecuteHashCollisionTest(CTestVm& virtualMachine)
+{
+	virtualMachine.Reset();
+	auto words = reinterpret_cast<uint64*>(virtualMachine.m_ram + TEST_SOURCE_ADDRESS);
+	words[0] = 0x0123456789ABCDEFULL;
+	words[1] = 0x1111111111111111ULL;
+	words[2] = 0xFEDCBA9876543210ULL;
+	words[3] = 0x2222222222222222ULL;
+
+	CReplayCacheFixture fixture(virtualMachine.m_ram);
+	TEST_VERIFY(fixture.Record(TEST_SOURCE_QWC));
+	TEST_VERIFY(fixture.Replay());
+
+	//Words 0 and 2 go through the same lane, change word 2 to cancel the change of word 0
+	uint64 lane = PRIME64_1 + PRIME64_2;
+	uint64 originalAcc = MixRound(lane, words[0]);
+	uint64 modifiedWord = words[0] ^ 1;
+	uint64 modifiedAcc = MixRound(lane, modifiedWord);
+	uint64 compensatedWord = words[2] + ((originalAcc - modifiedAcc) * InverseOdd(PRIME64_2));
+	TEST_VERIFY(MixRound(originalAcc, words[2]) == MixRound(modifiedAcc, compensatedWord));
+
+	uint64 originalWords[2] = {words[0], words[2]};
+	words[0] = modifiedWord;
+	words[2] = compensatedWord;
+	TEST_VERIFY(!fixture.Replay());
+
+	words[0] = originalWords[0];
+	words[2] = originalWords[1];
+	TEST_VERIFY(fixture.Replay());
+}
+
+//Chains larger than what the cache is allowed to copy aren't recorded
+void CGifReplayCacheTest::ExecuteSourceLimitTest(CTestVm& virtualMachine)
+{
+	virtualMachine.Reset();
+
+	CReplayCacheFixture fixture(virtualMachine.m_ram);
+	TEST_VERIFY(fixture.GetCache().BeginRecording(TEST_TADR, TEST_CHCR));
+	fixture.GetCache().RecordSource(TEST_SOURCE_ADDRESS, TEST_SOURCE_QWC);
+	//16MB worth of qwords, more than what a chain can use
+	fixture.GetCache().RecordSource(0, 0x100000);
+	TEST_VERIFY(!fixture.GetCache().IsRecording());
+	TEST_VERIFY(!fixture.Replay());
+}
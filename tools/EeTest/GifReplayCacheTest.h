@@ -0,0 +1,14 @@
+#pragma once
+
+#include "Test.h"
+
+class CGifReplayCacheTest : public CTest
+{
+public:
+	void Execute(CTestVm&) override;
+
+private:
+	void ExecuteSourceChangeTest(CTestVm&);
+	void ExecuteHashCollisionTest(CTestVm&);
+	void ExecuteSourceLimitTest(CTestVm&);
+};
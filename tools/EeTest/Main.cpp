@@ -0,0 +1,25 @@
+#include <functional>
+#include "GifReplayCacheTest.h"
+#include "MmiTest.h"
+
+typedef std::function<CTest*()> TestFactoryFunction;
+
+static const TestFactoryFunction s_factories[] =
+    {
+        []() { return new CMmiTest(); },
+        []() { return new CGifReplayCacheTest(); },
+};
+
+int main()
+{
+	CTestVm virtualMachine;
+
+	for(const auto& factory : s_factories)
+	{
+		virtualMachine.Reset();
+		auto test = factory();
+		test->Execute(virtualMachine);
+		delete test;
+	}
+	return 0;
+}
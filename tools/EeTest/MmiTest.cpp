@@ -0,0 +1,470 @@
+#include <stdio.h>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <functional>
+#include <random>
+#include "MmiTest.h"
+#include "ee/EEAssembler.h"
+
+#define REFERENCE_TEST_COUNT 0x1000
+#define THROUGHPUT_TEST_INSTRUCTION_COUNT 0x200
+#define THROUGHPUT_TEST_ITERATION_COUNT 0x1000
+
+//LO and HI hold both words of LO0 and HI0 followed by both words of LO1 and HI1
+struct MMI_STATE
+{
+	uint32 rs[4];
+	uint32 rt[4];
+	uint32 rd[4];
+	uint32 lo[4];
+	uint32 hi[4];
+};
+
+static uint32 GetHalf(const uint32* words, unsigned int index)
+{
+	return (words[index / 2] >> ((index & 1) * 16)) & 0xFFFF;
+}
+
+static void SetHalf(uint32* words, unsigned int index, uint32 value)
+{
+	unsigned int shift = (index & 1) * 16;
+	words[index / 2] = (words[index / 2] & ~(0xFFFF << shift)) | ((value & 0xFFFF) << shift);
+}
+
+static int32 Clamp(int64 value, int64 minValue, int64 maxValue)
+{
+	return static_cast<int32>((value < minValue) ? minValue : ((value > maxValue) ? maxValue : value));
+}
+
+static uint32 SignOf(uint32 value)
+{
+	return static_cast<uint32>(static_cast<int32>(value) >> 31);
+}
+
+static void RefPSUBSB(MMI_STATE& state)
+{
+	auto rs = reinterpret_cast<const uint8*>(state.rs);
+	auto rt = reinterpret_cast<const uint8*>(state.rt);
+	uint8 result[16];
+	for(unsigned int i = 0; i < 16; i++)
+	{
+		result[i] = static_cast<uint8>(Clamp(static_cast<int8>(rs[i]) - static_cast<int8>(rt[i]), -0x80, 0x7F));
+	}
+	memcpy(state.rd, result, 16);
+}
+
+static void RefPABSH(MMI_STATE& state)
+{
+	uint32 result[4];
+	for(unsigned int i = 0; i < 8; i++)
+	{
+		int32 value = static_cast<int16>(GetHalf(state.rt, i));
+		SetHalf(result, i, Clamp((value < 0) ? -value : value, -0x8000, 0x7FFF));
+	}
+	memcpy(state.rd, result, 16);
+}
+
+static void RefPABSW(MMI_STATE& state)
+{
+	for(unsigned int i = 0; i < 4; i++)
+	{
+		int64 value = static_cast<int32>(state.rt[i]);
+		state.rd[i] = Clamp((value < 0) ? -value : value, INT32_MIN, INT32_MAX);
+	}
+}
+
+static void RefPADSBH(MMI_STATE& state)
+{
+	uint32 result[4];
+	for(unsigned int i = 0; i < 8; i++)
+	{
+		uint32 rs = GetHalf(state.rs, i);
+		uint32 rt = GetHalf(state.rt, i);
+		SetHalf(result, i, (i < 4) ? (rs - rt) : (rs + rt));
+	}
+	memcpy(state.rd, result, 16);
+}
+
+static void RefPINTH(MMI_STATE& state)
+{
+	uint32 result[4];
+	for(unsigned int i = 0; i < 4; i++)
+	{
+		SetHalf(result, (i * 2) + 0, GetHalf(state.rt, i));
+		SetHalf(result, (i * 2) + 1, GetHalf(state.rs, i + 4));
+	}
+	memcpy(state.rd, result, 16);
+}
+
+static void RefPEXEH(MMI_STATE& state)
+{
+	static const unsigned int order[8] = {2, 1, 0, 3, 6, 5, 4, 7};
+	uint32 result[4];
+	for(unsigned int i = 0; i < 8; i++)
+	{
+		SetHalf(result, i, GetHalf(state.rt, order[i]));
+	}
+	memcpy(state.rd, result, 16);
+}
+
+//Only the even words are shifted, results are sign extended to 64 bits
+static void RefPSxxVW(MMI_STATE& state, uint32 (*shift)(uint32, uint32))
+{
+	uint32 result[4];
+	for(unsigned int i = 0; i < 2; i++)
+	{
+		uint32 value = shift(state.rt[i * 2], state.rs[i * 2] & 0x1F);
+		result[(i * 2) + 0] = value;
+		result[(i * 2) + 1] = SignOf(value);
+	}
+	memcpy(state.rd, result, 16);
+}
+
+static void StoreDoubleword(MMI_STATE& state, unsigned int index, uint64 value)
+{
+	uint32 lo = static_cast<uint32>(value);
+	uint32 hi = static_cast<uint32>(value >> 32);
+	state.lo[index + 0] = lo;
+	state.lo[index + 1] = SignOf(lo);
+	state.hi[index + 0] = hi;
+	state.hi[index + 1] = SignOf(hi);
+}
+
+static void RefPMxxxW(MMI_STATE& state, bool isSigned, int accumulate)
+{
+	for(unsigned int i = 0; i < 4; i += 2)
+	{
+		uint64 product = isSigned ? static_cast<uint64>(static_cast<int64>(static_cast<int32>(state.rs[i])) * static_cast<int32>(state.rt[i]))
+		                          : static_cast<uint64>(state.rs[i]) * state.rt[i];
+		uint64 acc = (static_cast<uint64>(state.hi[i]) << 32) | state.lo[i];
+		uint64 result = (accumulate == 0) ? product : ((accumulate > 0) ? (acc + product) : (acc - product));
+		StoreDoubleword(state, i, result);
+		state.rd[i + 0] = static_cast<uint32>(result);
+		state.rd[i + 1] = static_cast<uint32>(result >> 32);
+	}
+}
+
+static uint32* GetHalfProductSlot(MMI_STATE& state, unsigned int index)
+{
+	//Halfword products go in LO0[0] LO0[1] HI0[0] HI0[1] LO1[0] LO1[1] HI1[0] HI1[1]
+	uint32* words = (index & 2) ? state.hi : state.lo;
+	return &words[((index & 4) ? 2 : 0) + (index & 1)];
+}
+
+static void RefPMxxxH(MMI_STATE& state, int accumulate)
+{
+	for(unsigned int i = 0; i < 8; i++)
+	{
+		int32 product = static_cast<int16>(GetHalf(state.rs, i)) * static_cast<int16>(GetHalf(state.rt, i));
+		uint32* slot = GetHalfProductSlot(state, i);
+		*slot = (accumulate == 0) ? product : ((accumulate > 0) ? (*slot + product) : (*slot - product));
+	}
+	state.rd[0] = state.lo[0];
+	state.rd[1] = state.hi[0];
+	state.rd[2] = state.lo[2];
+	state.rd[3] = state.hi[2];
+}
+
+static void RefPHMxxH(MMI_STATE& state, bool isSubtract)
+{
+	for(unsigned int i = 0; i < 4; i++)
+	{
+		int32 lower = static_cast<int16>(GetHalf(state.rs, i * 2)) * static_cast<int16>(GetHalf(state.rt, i * 2));
+		int32 upper = static_cast<int16>(GetHalf(state.rs, (i * 2) + 1)) * static_cast<int16>(GetHalf(state.rt, (i * 2) + 1));
+		uint32 result = isSubtract ? (static_cast<uint32>(upper) - lower) : (static_cast<uint32>(upper) + lower);
+		uint32* words = (i & 1) ? state.hi : state.lo;
+		words[(i & 2) + 0] = result;
+		words[(i & 2) + 1] = 0;
+		state.rd[i] = result;
+	}
+}
+
+static void RefPDIVBW(MMI_STATE& state)
+{
+	int32 divisor = static_cast<int16>(GetHalf(state.rt, 0));
+	for(unsigned int i = 0; i < 4; i++)
+	{
+		int32 dividend = static_cast<int32>(state.rs[i]);
+		if(divisor == 0)
+		{
+			state.lo[i] = (dividend < 0) ? 1 : ~0U;
+			state.hi[i] = dividend;
+		}
+		else if((dividend == INT32_MIN) && (divisor == -1))
+		{
+			state.lo[i] = 0x80000000;
+			state.hi[i] = 0;
+		}
+		else
+		{
+			state.lo[i] = dividend / divisor;
+			state.hi[i] = dividend % divisor;
+		}
+	}
+}
+
+static void RefPDIVUW(MMI_STATE& state)
+{
+	for(unsigned int i = 0; i < 4; i += 2)
+	{
+		uint32 lo = (state.rt[i] == 0) ? ~0U : (state.rs[i] / state.rt[i]);
+		uint32 hi = (state.rt[i] == 0) ? state.rs[i] : (state.rs[i] % state.rt[i]);
+		StoreDoubleword(state, i, (static_cast<uint64>(hi) << 32) | lo);
+	}
+}
+
+static void RefPMFHL_SLW(MMI_STATE& state)
+{
+	for(unsigned int i = 0; i < 4; i += 2)
+	{
+		int64 value = static_cast<int64>((static_cast<uint64>(state.hi[i]) << 32) | state.lo[i]);
+		uint32 result = Clamp(value, INT32_MIN, INT32_MAX);
+		state.rd[i + 0] = result;
+		state.rd[i + 1] = SignOf(result);
+	}
+}
+
+static void RefPMTHL_LW(MMI_STATE& state)
+{
+	state.lo[0] = state.rs[0];
+	state.hi[0] = state.rs[1];
+	state.lo[2] = state.rs[2];
+	state.hi[2] = state.rs[3];
+}
+
+static void RefMADD(MMI_STATE& state, bool isSigned)
+{
+	uint64 product = isSigned ? static_cast<uint64>(static_cast<int64>(static_cast<int32>(state.rs[0])) * static_cast<int32>(state.rt[0]))
+	                          : static_cast<uint64>(state.rs[0]) * state.rt[0];
+	uint64 result = ((static_cast<uint64>(state.hi[0]) << 32) | state.lo[0]) + product;
+	StoreDoubleword(state, 0, result);
+	state.rd[0] = state.lo[0];
+	state.rd[1] = state.lo[1];
+}
+
+typedef std::function<void(CEEAssembler&, unsigned int, unsigned int, unsigned int)> EmitFunction;
+typedef std::function<void(MMI_STATE&)> ReferenceFunction;
+
+struct INSTRUCTION
+{
+	const char* name;
+	EmitFunction emit;
+	ReferenceFunction reference;
+};
+
+static const INSTRUCTION g_instructions[] =
+    {
+        {"PSUBSB", [](CEEAssembler& assembler, unsigned int rd, unsigned int rs, unsigned int rt) { assembler.PSUBSB(rd, rs, rt); }, RefPSUBSB},
+        {"PABSW", [](CEEAssembler& assembler, unsigned int rd, unsigned int, unsigned int rt) { assembler.PABSW(rd, rt); }, RefPABSW},
+        {"PABSH", [](CEEAssembler& assembler, unsigned int rd, unsigned int, unsigned int rt) { assembler.PABSH(rd, rt); }, RefPABSH},
+        {"PADSBH", [](CEEAssembler& assembler, unsigned int rd, unsigned int rs, unsigned int rt) { assembler.PADSBH(rd, rs, rt); }, RefPADSBH},
+        {"PINTH", [](CEEAssembler& assembler, unsigned int rd, unsigned int rs, unsigned int rt) { assembler.PINTH(rd, rs, rt); }, RefPINTH},
+        {"PEXEH", [](CEEAssembler& assembler, unsigned int rd, unsigned int, unsigned int rt) { assembler.PEXEH(rd, rt); }, RefPEXEH},
+        {"PSLLVW", [](CEEAssembler& assembler, unsigned int rd, unsigned int rs, unsigned int rt) { assembler.PSLLVW(rd, rt, rs); }, [](MMI_STATE& state) { RefPSxxVW(state, [](uint32 value, uint32 amount) { return value << amount; }); }},
+        {"PSRLVW", [](CEEAssembler& assembler, unsigned int rd, unsigned int rs, unsigned int rt) { assembler.PSRLVW(rd, rt, rs); }, [](MMI_STATE& state) { RefPSxxVW(state, [](uint32 value, uint32 amount) { return value >> amount; }); }},
+        {"PSRAVW", [](CEEAssembler& assembler, unsigned int rd, unsigned int rs, unsigned int rt) { assembler.PSRAVW(rd, rt, rs); }, [](MMI_STATE& state) { RefPSxxVW(state, [](uint32 value, uint32 amount) { return static_cast<uint32>(static_cast<int32>(value) >> amount); }); }},
+        {"PMULTW", [](CEEAssembler& assembler, unsigned int rd, unsigned int rs, unsigned int rt) { assembler.PMULTW(rd, rs, rt); }, [](MMI_STATE& state) { RefPMxxxW(state, true, 0); }},
+        {"PMADDW", [](CEEAssembler& assembler, unsigned int rd, unsigned int rs, unsigned int rt) { assembler.PMADDW(rd, rs, rt); }, [](MMI_STATE& state) { RefPMxxxW(state, true, 1); }},
+        {"PMSUBW", [](CEEAssembler& assembler, unsigned int rd, unsigned int rs, unsigned int rt) { assembler.PMSUBW(rd, rs, rt); }, [](MMI_STATE& state) { RefPMxxxW(state, true, -1); }},
+        {"PMULTUW", [](CEEAssembler& assembler, unsigned int rd, unsigned int rs, unsigned int rt) { assembler.PMULTUW(rd, rs, rt); }, [](MMI_STATE& state) { RefPMxxxW(state, false, 0); }},
+        {"PMADDUW", [](CEEAssembler& assembler, unsigned int rd, unsigned int rs, unsigned int rt) { assembler.PMADDUW(rd, rs, rt); }, [](MMI_STATE& state) { RefPMxxxW(state, false, 1); }},
+        {"PMULTH", [](CEEAssembler& assembler, unsigned int rd, unsigned int rs, unsigned int rt) { assembler.PMULTH(rd, rs, rt); }, [](MMI_STATE& state) { RefPMxxxH(state, 0); }},
+        {"PMADDH", [](CEEAssembler& assembler, unsigned int rd, unsigned int rs, unsigned int rt) { assembler.PMADDH(rd, rs, rt); }, [](MMI_STATE& state) { RefPMxxxH(state, 1); }},
+        {"PMSUBH", [](CEEAssembler& assembler, unsigned int rd, unsigned int rs, unsigned int rt) { assembler.PMSUBH(rd, rs, rt); }, [](MMI_STATE& state) { RefPMxxxH(state, -1); }},
+        {"PHMADH", [](CEEAssembler& assembler, unsigned int rd, unsigned int rs, unsigned int rt) { assembler.PHMADH(rd, rs, rt); }, [](MMI_STATE& state) { RefPHMxxH(state, false); }},
+        {"PHMSBH", [](CEEAssembler& assembler, unsigned int rd, unsigned int rs, unsigned int rt) { assembler.PHMSBH(rd, rs, rt); }, [](MMI_STATE& state) { RefPHMxxH(state, true); }},
+        {"PDIVBW", [](CEEAssembler& assembler, unsigned int, unsigned int rs, unsigned int rt) { assembler.PDIVBW(rs, rt); }, RefPDIVBW},
+        {"PDIVUW", [](CEEAssembler& assembler, unsigned int, unsigned int rs, unsigned int rt) { assembler.PDIVUW(rs, rt); }, RefPDIVUW},
+        {"PMFHL.SLW", [](CEEAssembler& assembler, unsigned int rd, unsigned int, unsigned int) { assembler.PMFHL_SLW(rd); }, RefPMFHL_SLW},
+        {"PMTHL.LW", [](CEEAssembler& assembler, unsigned int, unsigned int rs, unsigned int) { assembler.PMTHL_LW(rs); }, RefPMTHL_LW},
+        {"MADD", [](CEEAssembler& assembler, unsigned int rd, unsigned int rs, unsigned int rt) { assembler.MADD(rd, rs, rt); }, [](MMI_STATE& state) { RefMADD(state, true); }},
+        {"MADDU", [](CEEAssembler& assembler, unsigned int rd, unsigned int rs, unsigned int rt) { assembler.MADDU(rd, rs, rt); }, [](MMI_STATE& state) { RefMADD(state, false); }},
+};
+
+static void SetMulDivState(MIPSSTATE& state, const MMI_STATE& mmiState)
+{
+	state.nLO[0] = mmiState.lo[0];
+	state.nLO[1] = mmiState.lo[1];
+	state.nLO1[0] = mmiState.lo[2];
+	state.nLO1[1] = mmiState.lo[3];
+	state.nHI[0] = mmiState.hi[0];
+	state.nHI[1] = mmiState.hi[1];
+	state.nHI1[0] = mmiState.hi[2];
+	state.nHI1[1] = mmiState.hi[3];
+}
+
+static bool CompareMulDivState(const MIPSSTATE& state, const MMI_STATE& mmiState)
+{
+	return (state.nLO[0] == mmiState.lo[0]) && (state.nLO[1] == mmiState.lo[1]) &&
+	       (state.nLO1[0] == mmiState.lo[2]) && (state.nLO1[1] == mmiState.lo[3]) &&
+	       (state.nHI[0] == mmiState.hi[0]) && (state.nHI[1] == mmiState.hi[1]) &&
+	       (state.nHI1[0] == mmiState.hi[2]) && (state.nHI1[1] == mmiState.hi[3]);
+}
+
+void CMmiTest::Execute(CTestVm& virtualMachine)
+{
+	ExecuteBasicTest(virtualMachine);
+	ExecuteReferenceTest(virtualMachine);
+	ExecuteThroughputTest(virtualMachine);
+}
+
+void CMmiTest::ExecuteBasicTest(CTestVm& virtualMachine)
+{
+	virtualMachine.Reset();
+
+	CEEAssembler assembler(reinterpret_cast<uint32*>(virtualMachine.m_ram));
+	assembler.PMADDW(CMIPS::A0, CMIPS::T0, CMIPS::T1);
+	assembler.PSUBSB(CMIPS::A1, CMIPS::T2, CMIPS::T3);
+	assembler.SYSCALL();
+
+	auto& state = virtualMachine.m_cpu.m_State;
+	state.nLO[0] = 5;
+	state.nHI1[0] = 1;
+	state.nGPR[CMIPS::T0].nV[0] = static_cast<uint32>(-3);
+	state.nGPR[CMIPS::T1].nV[0] = 7;
+	state.nGPR[CMIPS::T0].nV[2] = 0x10000;
+	state.nGPR[CMIPS::T1].nV[2] = 0x10000;
+	state.nGPR[CMIPS::T2].nV[0] = 0x10807F80;
+	state.nGPR[CMIPS::T3].nV[0] = 0x2001FF7F;
+
+	virtualMachine.ExecuteTest(0);
+
+	//5 + (-3 * 7) and 0x100000000 + (0x10000 * 0x10000)
+	TEST_VERIFY(state.nGPR[CMIPS::A0].nV[0] == 0xFFFFFFF0);
+	TEST_VERIFY(state.nGPR[CMIPS::A0].nV[1] == 0xFFFFFFFF);
+	TEST_VERIFY(state.nGPR[CMIPS::A0].nV[2] == 0);
+	TEST_VERIFY(state.nGPR[CMIPS::A0].nV[3] == 2);
+	TEST_VERIFY(state.nLO[0] == 0xFFFFFFF0);
+	TEST_VERIFY(state.nHI[0] == 0xFFFFFFFF);
+	TEST_VERIFY(state.nLO1[0] == 0);
+	TEST_VERIFY(state.nHI1[0] == 2);
+
+	//0x80 - 0x7F, 0x7F - 0xFF and 0x80 - 0x01 saturate, 0x10 - 0x20 doesn't
+	TEST_VERIFY(state.nGPR[CMIPS::A1].nV[0] == 0xF0807F80);
+	TEST_VERIFY(state.nGPR[CMIPS::A1].nV[1] == 0);
+}
+
+void CMmiTest::ExecuteReferenceTest(CTestVm& virtualMachine)
+{
+	//Compares results against the reference functions, with destination aliasing sources
+	struct REGISTERS
+	{
+		unsigned int rd;
+		unsigned int rs;
+		unsigned int rt;
+	};
+
+	static const REGISTERS registerSets[] =
+	    {
+	        {CMIPS::A0, CMIPS::T0, CMIPS::T1},
+	        {CMIPS::T0, CMIPS::T0, CMIPS::T1},
+	        {CMIPS::T1, CMIPS::T0, CMIPS::T1},
+	        {CMIPS::A0, CMIPS::T0, CMIPS::T0},
+	        {CMIPS::T0, CMIPS::T0, CMIPS::T0},
+	    };
+
+	static const uint32 specialValues[] =
+	    {
+	        0x00000000, 0x00000001, 0xFFFFFFFF, 0x80000000, 0x7FFFFFFF, 0x00008000, 0x00007FFF,
+	        0x0000FFFF, 0x80008000, 0x7FFF7FFF, 0x80808080, 0x7F7F7F7F, 0xFFFF0001};
+
+	std::mt19937 randomGenerator(0x5A5A5A5A);
+	auto generateValue = [&]() {
+		uint32 value = randomGenerator();
+		if((value % 3) == 0)
+		{
+			value = specialValues[randomGenerator() % (sizeof(specialValues) / sizeof(specialValues[0]))];
+		}
+		return value;
+	};
+
+	auto& state = virtualMachine.m_cpu.m_State;
+	for(const auto& instruction : g_instructions)
+	{
+		for(const auto& registers : registerSets)
+		{
+			virtualMachine.Reset();
+
+			CEEAssembler assembler(reinterpret_cast<uint32*>(virtualMachine.m_ram));
+			instruction.emit(assembler, registers.rd, registers.rs, registers.rt);
+			assembler.SYSCALL();
+
+			for(unsigned int i = 0; i < REFERENCE_TEST_COUNT; i++)
+			{
+				MMI_STATE mmiState;
+				for(unsigned int j = 0; j < 4; j++)
+				{
+					mmiState.rs[j] = generateValue();
+					mmiState.rt[j] = generateValue();
+					mmiState.rd[j] = generateValue();
+					mmiState.lo[j] = generateValue();
+					mmiState.hi[j] = generateValue();
+				}
+				if((i % 4) == 0)
+				{
+					//Divisions by zero and by -1
+					mmiState.rt[0] = (mmiState.rt[0] & 0xFFFF0000) | ((i & 8) ? 0 : 0xFFFF);
+					mmiState.rt[2] = (i & 16) ? 0 : mmiState.rt[2];
+				}
+				if(registers.rs == registers.rt)
+				{
+					memcpy(mmiState.rt, mmiState.rs, sizeof(mmiState.rt));
+				}
+
+				memcpy(state.nGPR[registers.rd].nV, mmiState.rd, sizeof(mmiState.rd));
+				memcpy(state.nGPR[registers.rs].nV, mmiState.rs, sizeof(mmiState.rs));
+				memcpy(state.nGPR[registers.rt].nV, mmiState.rt, sizeof(mmiState.rt));
+				memcpy(mmiState.rd, state.nGPR[registers.rd].nV, sizeof(mmiState.rd));
+				SetMulDivState(state, mmiState);
+
+				state.nHasException = MIPS_EXCEPTION_NONE;
+				virtualMachine.ExecuteTest(0);
+
+				instruction.reference(mmiState);
+				TEST_VERIFY(!memcmp(state.nGPR[registers.rd].nV, mmiState.rd, sizeof(mmiState.rd)));
+				TEST_VERIFY(CompareMulDivState(state, mmiState));
+			}
+		}
+	}
+}
+
+void CMmiTest::ExecuteThroughputTest(CTestVm& virtualMachine)
+{
+	printf("MMI throughput (Minstructions/s):");
+	for(const auto& instruction : g_instructions)
+	{
+		virtualMachine.Reset();
+
+		//Results are fed back into the next instruction when it reads RS
+		CEEAssembler assembler(reinterpret_cast<uint32*>(virtualMachine.m_ram));
+		for(unsigned int i = 0; i < THROUGHPUT_TEST_INSTRUCTION_COUNT; i++)
+		{
+			instruction.emit(assembler, CMIPS::T0, CMIPS::T0, CMIPS::T1);
+		}
+		assembler.SYSCALL();
+
+		auto& state = virtualMachine.m_cpu.m_State;
+		for(unsigned int i = 0; i < 4; i++)
+		{
+			state.nGPR[CMIPS::T0].nV[i] = 0x12345678 * (i + 1);
+			state.nGPR[CMIPS::T1].nV[i] = 0x00030005 * (i + 1);
+		}
+
+		//First run compiles the program
+		virtualMachine.ExecuteTest(0);
+
+		auto startTime = std::chrono::steady_clock::now();
+		for(unsigned int i = 0; i < THROUGHPUT_TEST_ITERATION_COUNT; i++)
+		{
+			state.nHasException = MIPS_EXCEPTION_NONE;
+			virtualMachine.ExecuteTest(0);
+		}
+		auto endTime = std::chrono::steady_clock::now();
+
+		double elapsedTime = std::chrono::duration<double>(endTime - startTime).count();
+		double instructionCount = static_cast<double>(THROUGHPUT_TEST_ITERATION_COUNT * THROUGHPUT_TEST_INSTRUCTION_COUNT);
+		printf(" %s %.1f", instruction.name, instructionCount / (elapsedTime * 1000000.0));
+	}
+	printf(".\n");
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "Test.h"
+
+class CMmiTest : public CTest
+{
+public:
+	void Execute(CTestVm&) override;
+
+private:
+	void ExecuteBasicTest(CTestVm&);
+	void ExecuteReferenceTest(CTestVm&);
+	void ExecuteThroughputTest(CTestVm&);
+};
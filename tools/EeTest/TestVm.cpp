@@ -0,0 +1,37 @@
+#include <cstring>
+#include "TestVm.h"
+
+CTestVm::CTestVm()
+    : m_cpu(MEMORYMAP_ENDIAN_LSBF)
+    , m_executor(m_cpu, RAM_SIZE)
+    , m_ram(new uint8[RAM_SIZE])
+{
+	m_cpu.m_pMemoryMap->InsertReadMap(0x00000000, RAM_SIZE - 1, m_ram, 0x00);
+	m_cpu.m_pMemoryMap->InsertWriteMap(0x00000000, RAM_SIZE - 1, m_ram, 0x00);
+	m_cpu.m_pMemoryMap->InsertInstructionMap(0x00000000, RAM_SIZE - 1, m_ram, 0x00);
+
+	m_cpu.m_pArch = &m_maEe;
+	m_cpu.m_pAddrTranslator = CMIPS::TranslateAddress64;
+}
+
+CTestVm::~CTestVm()
+{
+	delete[] m_ram;
+}
+
+void CTestVm::Reset()
+{
+	m_cpu.Reset();
+	m_executor.Reset();
+	memset(m_ram, 0, RAM_SIZE);
+}
+
+void CTestVm::ExecuteTest(uint32 startAddress)
+{
+	//Test programs end with a SYSCALL
+	m_cpu.m_State.nPC = startAddress;
+	while(!m_cpu.m_State.nHasException)
+	{
+		m_executor.Execute(100);
+	}
+}
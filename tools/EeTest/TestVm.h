@@ -0,0 +1,25 @@
+#pragma once
+
+#include "MIPS.h"
+#include "GenericMipsExecutor.h"
+#include "ee/MA_EE.h"
+
+class CTestVm
+{
+public:
+	enum
+	{
+		RAM_SIZE = 0x10000,
+	};
+
+	CTestVm();
+	virtual ~CTestVm();
+
+	void Reset();
+	void ExecuteTest(uint32);
+
+	CMIPS m_cpu;
+	CGenericMipsExecutor<BlockLookupTwoWay> m_executor;
+	uint8* m_ram = nullptr;
+	CMA_EE m_maEe;
+};
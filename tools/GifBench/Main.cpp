@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "StdStream.h"
+#include "FrameDump.h"
+#include "ee/GIF.h"
+#include "gs/GSH_Null.h"
+
+//Replays the GS packets of a frame dump through the GIF, measuring how fast GIF packets
+//are decoded and handed over to the GS thread. Register writes are encoded as PACKED A+D
+//packets and image data as IMAGE packets, one GIF packet per captured packet.
+//Usage: GifBench <frame dump path> [pass count]
+
+#define GIF_PACKED 0
+#define GIF_IMAGE 2
+#define GIF_REG_AD 0x0E
+#define GIF_MAX_LOOPS 0x7FFF
+
+struct GIF_STREAM
+{
+	std::vector<uint8> data;
+	uint32 packetCount = 0;
+	uint32 registerWriteCount = 0;
+	uint32 imageSize = 0;
+};
+
+static void WriteTag(std::vector<uint8>& data, uint32 loops, uint32 flg, uint32 nreg, uint64 regs, bool eop)
+{
+	CGIF::TAG tag = {};
+	tag.loops = loops;
+	tag.eop = eop ? 1 : 0;
+	tag.cmd = flg;
+	tag.nreg = nreg;
+	tag.regs = regs;
+	auto tagBytes = reinterpret_cast<const uint8*>(&tag);
+	data.insert(data.end(), tagBytes, tagBytes + sizeof(CGIF::TAG));
+}
+
+static GIF_STREAM BuildGifStream(const CFrameDump& frameDump)
+{
+	GIF_STREAM stream;
+	for(const auto& packet : frameDump.GetPackets())
+	{
+		if(!packet.registerWrites.empty())
+		{
+			//SIGNAL would stall the GIF until the EE acknowledges it, leave it out
+			std::vector<CGSHandler::RegisterWrite> writes;
+			writes.reserve(packet.registerWrites.size());
+			for(const auto& write : packet.registerWrites)
+			{
+				if(write.first == GS_REG_SIGNAL) continue;
+				writes.push_back(write);
+			}
+			for(uint32 i = 0; i < writes.size(); i += GIF_MAX_LOOPS)
+			{
+				uint32 loops = std::min<uint32>(writes.size() - i, GIF_MAX_LOOPS);
+				WriteTag(stream.data, loops, GIF_PACKED, 1, GIF_REG_AD, true);
+				for(uint32 j = 0; j < loops; j++)
+				{
+					uint64 qword[2] = {writes[i + j].second, writes[i + j].first};
+					auto qwordBytes = reinterpret_cast<const uint8*>(qword);
+					stream.data.insert(stream.data.end(), qwordBytes, qwordBytes + sizeof(qword));
+				}
+				stream.packetCount++;
+			}
+			stream.registerWriteCount += writes.size();
+		}
+		if(!packet.imageData.empty())
+		{
+			uint32 imageSize = (packet.imageData.size() + 0x0F) & ~0x0F;
+			for(uint32 i = 0; i < imageSize; i += (GIF_MAX_LOOPS * 0x10))
+			{
+				uint32 chunkSize = std::min<uint32>(imageSize - i, GIF_MAX_LOOPS * 0x10);
+				uint32 copySize = std::min<uint32>(packet.imageData.size() - i, chunkSize);
+				WriteTag(stream.data, chunkSize / 0x10, GIF_IMAGE, 0, 0, true);
+				stream.data.insert(stream.data.end(), packet.imageData.begin() + i, packet.imageData.begin() + i + copySize);
+				stream.data.resize(stream.data.size() + (chunkSize - copySize));
+				stream.packetCount++;
+			}
+			stream.imageSize += imageSize;
+		}
+	}
+	return stream;
+}
+
+static void WaitForGs(CGSHandler* gs)
+{
+	while(gs->GetPendingTransferCount() != 0)
+	{
+		std::this_thread::yield();
+	}
+}
+
+int main(int argc, const char** argv)
+{
+	if(argc < 2)
+	{
+		printf("Usage: GifBench <frame dump path> [pass count]\r\n");
+		return 1;
+	}
+
+	unsigned int passCount = (argc > 2) ? std::stoul(argv[2]) : 100;
+
+	try
+	{
+		CFrameDump frameDump;
+		{
+			Framework::CStdStream inputStream(argv[1], "rb");
+			frameDump.Read(inputStream);
+		}
+
+		auto stream = BuildGifStream(frameDump);
+		printf("Built %d GIF packets (%d register writes, %d bytes of image data, %d bytes total).\r\n",
+		       stream.packetCount, stream.registerWriteCount, stream.imageSize, static_cast<uint32>(stream.data.size()));
+
+		CGSHandler* gs = new CGSH_Null();
+		gs->Initialize();
+		gs->Reset();
+		CGIF gif(gs, nullptr, nullptr);
+		gif.Reset();
+
+		auto gifDuration = std::chrono::nanoseconds::zero();
+		auto startTime = std::chrono::high_resolution_clock::now();
+		for(unsigned int pass = 0; pass < passCount; pass++)
+		{
+			memcpy(gs->GetRam(), frameDump.GetInitialGsRam(), CGSHandler::RAMSIZE);
+			memcpy(gs->GetRegisters(), frameDump.GetInitialGsRegisters(), CGSHandler::REGISTER_MAX * sizeof(uint64));
+			gs->SetSMODE2(frameDump.GetInitialSMODE2());
+
+			auto passStartTime = std::chrono::high_resolution_clock::now();
+			uint32 size = static_cast<uint32>(stream.data.size());
+			uint32 processed = gif.ProcessMultiplePackets(stream.data.data(), 0, size, CGsPacketMetadata(2));
+			gifDuration += std::chrono::high_resolution_clock::now() - passStartTime;
+			if(processed != size)
+			{
+				throw std::runtime_error("GIF didn't process the whole stream.");
+			}
+
+			//GS RAM is restored on this thread for the next pass
+			WaitForGs(gs);
+		}
+		auto endTime = std::chrono::high_resolution_clock::now();
+
+		double gifTime = static_cast<double>(gifDuration.count()) / 1000000000.0;
+		double totalTime = std::chrono::duration<double>(endTime - startTime).count();
+		double totalWrites = static_cast<double>(stream.registerWriteCount) * passCount;
+		double totalBytes = static_cast<double>(stream.data.size()) * passCount;
+		printf("GIF:   %d passes in %fs (%f Mwrites/s, %f MB/s).\r\n", passCount, gifTime,
+		       totalWrites / gifTime / 1000000.0, totalBytes / gifTime / (1024.0 * 1024.0));
+		printf("Total: %d passes in %fs including GS thread (%f Mwrites/s).\r\n", passCount, totalTime,
+		       totalWrites / totalTime / 1000000.0);
+
+		gs->Release();
+		delete gs;
+	}
+	catch(const std::exception& exception)
+	{
+		printf("Error: %s\r\n", exception.what());
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,100 @@
+#include <cassert>
+#include <stdexcept>
+#include "opengl/OpenGlDef.h"
+#include "GSH_OpenGLEgl.h"
+
+CGSH_OpenGLEgl::CGSH_OpenGLEgl(const fs::path& programCachePath)
+    : m_programCachePath(programCachePath)
+{
+	static const EGLint configAttribs[] =
+	    {
+	        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+	        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+	        EGL_BLUE_SIZE, 8,
+	        EGL_GREEN_SIZE, 8,
+	        EGL_RED_SIZE, 8,
+	        EGL_NONE};
+
+	static const EGLint contextAttribs[] =
+	    {
+	        EGL_CONTEXT_MAJOR_VERSION, 3,
+	        EGL_CONTEXT_MINOR_VERSION, 2,
+	        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+	        EGL_NONE};
+
+	static const EGLint surfaceAttribs[] =
+	    {
+	        EGL_WIDTH, 640,
+	        EGL_HEIGHT, 448,
+	        EGL_NONE};
+
+	auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+	if(getPlatformDisplay == nullptr)
+	{
+		throw std::runtime_error("eglGetPlatformDisplayEXT is not available.");
+	}
+
+	m_display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+	if((m_display == EGL_NO_DISPLAY) || !eglInitialize(m_display, nullptr, nullptr))
+	{
+		throw std::runtime_error("Failed to initialize surfaceless EGL display.");
+	}
+
+	eglBindAPI(EGL_OPENGL_API);
+
+	EGLConfig config = 0;
+	EGLint numConfigs = 0;
+	eglChooseConfig(m_display, configAttribs, &config, 1, &numConfigs);
+	if(numConfigs == 0)
+	{
+		eglTerminate(m_display);
+		throw std::runtime_error("Failed to find EGL config.");
+	}
+
+	m_context = eglCreateContext(m_display, config, EGL_NO_CONTEXT, contextAttribs);
+	m_surface = eglCreatePbufferSurface(m_display, config, surfaceAttribs);
+	if((m_context == EGL_NO_CONTEXT) || (m_surface == EGL_NO_SURFACE))
+	{
+		eglTerminate(m_display);
+		throw std::runtime_error("Failed to create EGL context.");
+	}
+}
+
+CGSH_OpenGLEgl::~CGSH_OpenGLEgl()
+{
+	eglDestroySurface(m_display, m_surface);
+	eglDestroyContext(m_display, m_context);
+	eglTerminate(m_display);
+}
+
+void CGSH_OpenGLEgl::InitializeImpl()
+{
+	//Context needs to be made current on the GS thread
+	auto makeCurrentResult = eglMakeCurrent(m_display, m_surface, m_surface, m_context);
+	assert(makeCurrentResult != EGL_FALSE);
+
+#ifdef USE_GLEW
+	//GLEW reports the lack of a GLX display with EGL contexts, entry points are still loaded
+	glewExperimental = GL_TRUE;
+	auto result = glewInit();
+	assert((result == GLEW_OK) || (result == GLEW_ERROR_NO_GLX_DISPLAY));
+#endif
+
+	CGSH_OpenGL::InitializeImpl();
+}
+
+void CGSH_OpenGLEgl::ReleaseImpl()
+{
+	CGSH_OpenGL::ReleaseImpl();
+
+	eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+}
+
+fs::path CGSH_OpenGLEgl::GetProgramCachePath() const
+{
+	return m_programCachePath;
+}
+
+void CGSH_OpenGLEgl::PresentBackbuffer()
+{
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "gs/GSH_OpenGL/GSH_OpenGL.h"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+//Offscreen GS handler using Mesa's surfaceless platform, doesn't need a display server
+class CGSH_OpenGLEgl : public CGSH_OpenGL
+{
+public:
+	CGSH_OpenGLEgl(const fs::path&);
+	virtual ~CGSH_OpenGLEgl();
+
+protected:
+	void InitializeImpl() override;
+	void ReleaseImpl() override;
+	fs::path GetProgramCachePath() const override;
+
+private:
+	void PresentBackbuffer() override;
+
+	fs::path m_programCachePath;
+	EGLDisplay m_display = EGL_NO_DISPLAY;
+	EGLContext m_context = EGL_NO_CONTEXT;
+	EGLSurface m_surface = EGL_NO_SURFACE;
+};
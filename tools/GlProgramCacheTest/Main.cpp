@@ -0,0 +1,166 @@
+#include <stdio.h>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "AppConfig.h"
+#include "StdStreamUtils.h"
+#include "GSH_OpenGLEgl.h"
+#include "Test.h"
+
+//Checks that program binaries and the shader caps list survive across sessions
+//Usage: GlProgramCacheTest (needs Mesa with the surfaceless EGL platform)
+
+#define PROGRAMCACHE_BINARIES_FILENAME "opengl_programs.bin"
+#define PROGRAMCACHE_CAPSLIST_FILENAME "opengl_shadercaps.txt"
+#define PROGRAMCACHE_MAGIC 0x42504C47
+
+typedef std::vector<uint32> CapsList;
+typedef std::map<uint32, unsigned int> BinaryCountMap;
+
+static const fs::path g_programCachePath = fs::path("./glprogramcache");
+static const fs::path g_capsListPath = g_programCachePath / PROGRAMCACHE_CAPSLIST_FILENAME;
+static const fs::path g_binariesPath = g_programCachePath / PROGRAMCACHE_BINARIES_FILENAME;
+
+static CapsList ReadCapsList()
+{
+	CapsList capsList;
+	if(!fs::exists(g_capsListPath)) return capsList;
+	auto stream = Framework::CreateInputStdStream(g_capsListPath.native());
+	std::stringstream lines(stream.ReadString(stream.GetLength()));
+	std::string line;
+	while(std::getline(lines, line))
+	{
+		if(line.empty()) continue;
+		capsList.push_back(std::stoul(line, nullptr, 16));
+	}
+	return capsList;
+}
+
+//Returns the number of records found for each caps, empty if the file isn't well formed
+static BinaryCountMap ReadBinaryCounts()
+{
+	BinaryCountMap counts;
+	auto stream = Framework::CreateInputStdStream(g_binariesPath.native());
+	uint64 fileSize = stream.GetLength();
+	if(stream.Read32() != PROGRAMCACHE_MAGIC) return BinaryCountMap();
+	stream.Read32();
+	uint32 driverIdSize = stream.Read32();
+	stream.Seek(driverIdSize, Framework::STREAM_SEEK_CUR);
+	while(stream.Tell() < fileSize)
+	{
+		if((fileSize - stream.Tell()) < 20) return BinaryCountMap();
+		uint32 caps = stream.Read32();
+		stream.Read64();
+		stream.Read32();
+		uint32 size = stream.Read32();
+		if(size > (fileSize - stream.Tell())) return BinaryCountMap();
+		stream.Seek(size, Framework::STREAM_SEEK_CUR);
+		counts[caps]++;
+	}
+	return counts;
+}
+
+//Draws an untextured triangle, which requires a program to be generated
+static void DrawTriangle(CGSHandler& gs)
+{
+	auto frame = make_convertible<CGSHandler::FRAME>(0);
+	frame.nWidth = 10;
+	frame.nPsm = CGSHandler::PSMCT32;
+
+	auto scissor = make_convertible<CGSHandler::SCISSOR>(0);
+	scissor.scax1 = 639;
+	scissor.scay1 = 447;
+
+	auto prim = make_convertible<CGSHandler::PRIM>(0);
+	prim.nType = CGSHandler::PRIM_TRIANGLE;
+
+	auto makeXyz = [](unsigned int x, unsigned int y) {
+		auto xyz = make_convertible<CGSHandler::XYZ>(0);
+		xyz.nX = x * 16;
+		xyz.nY = y * 16;
+		return static_cast<uint64>(xyz);
+	};
+
+	CGSHandler::RegisterWriteList writes;
+	writes.push_back(std::make_pair(GS_REG_FRAME_1, static_cast<uint64>(frame)));
+	writes.push_back(std::make_pair(GS_REG_SCISSOR_1, static_cast<uint64>(scissor)));
+	writes.push_back(std::make_pair(GS_REG_PRIM, static_cast<uint64>(prim)));
+	writes.push_back(std::make_pair(GS_REG_RGBAQ, 0x3F800000FFFFFFFFULL));
+	writes.push_back(std::make_pair(GS_REG_XYZ2, makeXyz(0, 0)));
+	writes.push_back(std::make_pair(GS_REG_XYZ2, makeXyz(256, 0)));
+	writes.push_back(std::make_pair(GS_REG_XYZ2, makeXyz(0, 256)));
+	gs.WriteRegisterMassively(std::move(writes), nullptr);
+	gs.Flip();
+}
+
+int main(int argc, const char** argv)
+{
+	CGSH_OpenGL::RegisterPreferences();
+	CAppConfig::GetInstance().SetPreferenceBoolean(PREF_CGSH_OPENGL_PROGRAMCACHE, true);
+	//Programs must be complete when drawing returns for the cache files to be predictable
+	CAppConfig::GetInstance().SetPreferenceBoolean(PREF_CGSH_OPENGL_ASYNCSHADERCOMPILATION, false);
+
+	fs::remove_all(g_programCachePath);
+
+	uint32 drawCaps = 0;
+	bool hasBinaries = false;
+
+	//First session: caps list must be written as soon as a program is generated
+	{
+		auto gs = std::make_unique<CGSH_OpenGLEgl>(g_programCachePath);
+		gs->Initialize();
+		CHECK(ReadCapsList().empty());
+		DrawTriangle(*gs);
+
+		auto capsList = ReadCapsList();
+		CHECK(capsList.size() == 1);
+		drawCaps = capsList[0];
+
+		//Drivers without binary formats only get the caps list
+		hasBinaries = fs::exists(g_binariesPath);
+		if(hasBinaries)
+		{
+			auto counts = ReadBinaryCounts();
+			CHECK(counts.size() == 1);
+			CHECK(counts[drawCaps] == 1);
+		}
+		gs->Release();
+	}
+
+	//Second session: program is loaded from its binary and caps list is restored from it
+	if(hasBinaries)
+	{
+		fs::remove(g_capsListPath);
+		auto binariesSize = fs::file_size(g_binariesPath);
+
+		auto gs = std::make_unique<CGSH_OpenGLEgl>(g_programCachePath);
+		gs->Initialize();
+		DrawTriangle(*gs);
+
+		auto capsList = ReadCapsList();
+		CHECK(capsList.size() == 1);
+		CHECK(capsList[0] == drawCaps);
+		CHECK(fs::file_size(g_binariesPath) == binariesSize);
+		gs->Release();
+	}
+
+	//Third session: partially written binaries file is rewritten and program is generated again from the caps list
+	if(hasBinaries)
+	{
+		fs::resize_file(g_binariesPath, fs::file_size(g_binariesPath) - 1);
+
+		auto gs = std::make_unique<CGSH_OpenGLEgl>(g_programCachePath);
+		gs->Initialize();
+
+		auto counts = ReadBinaryCounts();
+		CHECK(counts.size() == 1);
+		CHECK(counts[drawCaps] == 1);
+		gs->Release();
+	}
+
+	fs::remove_all(g_programCachePath);
+
+	return 0;
+}
@@ -0,0 +1,19 @@
+#include "ReadAheadStreamTest.h"
+#ifdef HAS_AMAZON_S3
+#include "S3ReadCacheTest.h"
+#endif
+
+int main(int argc, const char** argv)
+{
+	ExecuteReadAheadStreamReadTest();
+	ExecuteReadAheadStreamSeekTest();
+	ExecuteHostFileCacheReuseTest();
+	ExecuteHostFileCacheDisabledTest();
+#ifdef HAS_AMAZON_S3
+	ExecuteS3ReadCacheReadWriteTest();
+	ExecuteS3ReadCacheReopenTest();
+	ExecuteS3ReadCacheEvictionTest();
+	ExecuteS3ReadCacheInvalidFileTest();
+#endif
+	return 0;
+}
@@ -0,0 +1,188 @@
+#include <chrono>
+#include <cstring>
+#include <vector>
+#include "ReadAheadStreamTest.h"
+#include "Test.h"
+#include "iop/Ioman_ReadAheadStream.h"
+#include "StdStreamUtils.h"
+
+using namespace Iop::Ioman;
+
+//Larger than the stream's buffer to make sure reads cross buffer boundaries
+#define TEST_FILE_SIZE 0x28000
+
+static fs::path GetTestFilePath()
+{
+	return fs::path("./readaheadtest.bin");
+}
+
+static std::vector<uint8> MakeTestFile(uint8 seed)
+{
+	std::vector<uint8> data(TEST_FILE_SIZE);
+	for(uint32 i = 0; i < TEST_FILE_SIZE; i++)
+	{
+		data[i] = static_cast<uint8>((i * 7) + (i >> 8) + seed);
+	}
+	auto stream = Framework::CreateOutputStdStream(GetTestFilePath().native());
+	stream.Write(data.data(), data.size());
+	return data;
+}
+
+//Small, large and unaligned reads return the same data as the file, in the same amount of
+//host reads as there are buffers to fill
+void ExecuteReadAheadStreamReadTest()
+{
+	auto data = MakeTestFile(0);
+	auto cache = std::make_shared<CHostFileCache>();
+
+	{
+		CReadAheadStream stream(cache, GetTestFilePath());
+		std::vector<uint8> result(TEST_FILE_SIZE);
+		uint64 position = 0;
+		static const uint32 readSizes[] = {0x10, 0x3, 0x800, 0x7F0, 0x1, 0x4000};
+		uint32 readIndex = 0;
+		while(position < 0x10000)
+		{
+			uint32 readSize = readSizes[readIndex++ % 6];
+			CHECK(stream.Read(result.data() + position, readSize) == readSize);
+			position += readSize;
+			CHECK(stream.Tell() == position);
+		}
+		CHECK(!stream.IsEOF());
+
+		//Large read goes straight to the destination
+		uint64 remainSize = TEST_FILE_SIZE - position;
+		CHECK(stream.Read(result.data() + position, remainSize + 0x100) == remainSize);
+		CHECK(stream.IsEOF());
+		CHECK(result == data);
+
+		uint8 value = 0;
+		CHECK(stream.Read(&value, 1) == 0);
+		CHECK(stream.IsEOF());
+	}
+
+	cache->EndFrame();
+	auto stats = cache->GetFrameStats();
+	CHECK(stats.openCount == 1);
+	//First 64KB are served by 2 buffer fills, the rest by a single large read
+	CHECK(stats.hostReadCount <= 3);
+	CHECK(stats.readCount > stats.hostReadCount);
+	CHECK(stats.GetSavedSyscallCount() != 0);
+
+	fs::remove(GetTestFilePath());
+}
+
+//Seeks only move the position, the host file is only moved when data needs to be fetched
+void ExecuteReadAheadStreamSeekTest()
+{
+	auto data = MakeTestFile(1);
+	auto cache = std::make_shared<CHostFileCache>();
+
+	{
+		CReadAheadStream stream(cache, GetTestFilePath());
+		uint8 buffer[0x20];
+
+		stream.Seek(0x100, Framework::STREAM_SEEK_SET);
+		CHECK(stream.Read(buffer, sizeof(buffer)) == sizeof(buffer));
+		CHECK(memcmp(buffer, data.data() + 0x100, sizeof(buffer)) == 0);
+
+		//Seeking back inside the buffer doesn't touch the host file
+		stream.Seek(-0x10, Framework::STREAM_SEEK_CUR);
+		CHECK(stream.Tell() == 0x110);
+		CHECK(stream.Read(buffer, sizeof(buffer)) == sizeof(buffer));
+		CHECK(memcmp(buffer, data.data() + 0x110, sizeof(buffer)) == 0);
+
+		stream.Seek(-0x10, Framework::STREAM_SEEK_END);
+		CHECK(stream.Tell() == (TEST_FILE_SIZE - 0x10));
+		CHECK(stream.Read(buffer, sizeof(buffer)) == 0x10);
+		CHECK(memcmp(buffer, data.data() + TEST_FILE_SIZE - 0x10, 0x10) == 0);
+		CHECK(stream.IsEOF());
+
+		//Seeking clears the EOF flag
+		stream.Seek(0, Framework::STREAM_SEEK_SET);
+		CHECK(!stream.IsEOF());
+		CHECK(stream.Read(buffer, sizeof(buffer)) == sizeof(buffer));
+		CHECK(memcmp(buffer, data.data(), sizeof(buffer)) == 0);
+	}
+
+	cache->EndFrame();
+	auto stats = cache->GetFrameStats();
+	CHECK(stats.seekCount == 4);
+	CHECK(stats.hostReadCount == 3);
+	//Read following the seek from the end didn't need to move the host file
+	CHECK(stats.hostSeekCount == 3);
+	CHECK(stats.hostStatCount == 1);
+	CHECK(stats.GetSavedSyscallCount() == 1);
+
+	//Host can end up doing more work than the guest asked for, nothing was saved then
+	CHostFileCache::STATS unbufferedStats;
+	unbufferedStats.openCount = 1;
+	unbufferedStats.readCount = 1;
+	unbufferedStats.hostReadCount = 1;
+	unbufferedStats.hostSeekCount = 1;
+	unbufferedStats.hostStatCount = 1;
+	CHECK(unbufferedStats.GetSavedSyscallCount() == 0);
+
+	fs::remove(GetTestFilePath());
+}
+
+//Files closed by the guest are reused when opened again, unless they were modified or evicted
+void ExecuteHostFileCacheReuseTest()
+{
+	auto data = MakeTestFile(2);
+	auto cache = std::make_shared<CHostFileCache>();
+
+	auto readFirstByte =
+	    [&]() {
+		    CReadAheadStream stream(cache, GetTestFilePath());
+		    uint8 value = 0;
+		    CHECK(stream.Read(&value, 1) == 1);
+		    return value;
+	    };
+
+	CHECK(readFirstByte() == data[0]);
+	CHECK(readFirstByte() == data[0]);
+	cache->EndFrame();
+	CHECK(cache->GetFrameStats().openCount == 2);
+	CHECK(cache->GetFrameStats().handleCacheHitCount == 1);
+	CHECK(cache->GetFrameStats().hostStatCount == 2);
+
+	//Replacing the file changes its modification time, cached handle must not be used
+	auto modificationTime = fs::last_write_time(GetTestFilePath());
+	data = MakeTestFile(3);
+	fs::last_write_time(GetTestFilePath(), modificationTime + std::chrono::seconds(10));
+	CHECK(readFirstByte() == data[0]);
+	cache->EndFrame();
+	CHECK(cache->GetFrameStats().handleCacheHitCount == 0);
+
+	cache->Evict(GetTestFilePath());
+	CHECK(readFirstByte() == data[0]);
+	cache->Clear();
+	CHECK(readFirstByte() == data[0]);
+	cache->EndFrame();
+	CHECK(cache->GetFrameStats().openCount == 2);
+	CHECK(cache->GetFrameStats().handleCacheHitCount == 0);
+
+	fs::remove(GetTestFilePath());
+}
+
+//Caches without entries close files right away, which allows them to be removed
+void ExecuteHostFileCacheDisabledTest()
+{
+	auto data = MakeTestFile(4);
+	auto cache = std::make_shared<CHostFileCache>(0);
+
+	for(uint32 i = 0; i < 2; i++)
+	{
+		CReadAheadStream stream(cache, GetTestFilePath());
+		uint8 value = 0;
+		CHECK(stream.Read(&value, 1) == 1);
+		CHECK(value == data[0]);
+	}
+
+	cache->EndFrame();
+	CHECK(cache->GetFrameStats().openCount == 2);
+	CHECK(cache->GetFrameStats().handleCacheHitCount == 0);
+
+	CHECK(fs::remove(GetTestFilePath()));
+}
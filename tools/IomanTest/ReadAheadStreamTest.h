@@ -0,0 +1,6 @@
+#pragma once
+
+void ExecuteReadAheadStreamReadTest();
+void ExecuteReadAheadStreamSeekTest();
+void ExecuteHostFileCacheReuseTest();
+void ExecuteHostFileCacheDisabledTest();
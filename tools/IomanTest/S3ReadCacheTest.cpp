@@ -0,0 +1,157 @@
+#include <vector>
+#include "S3ReadCacheTest.h"
+#include "Test.h"
+#include "s3stream/S3ReadCache.h"
+#include "StdStreamUtils.h"
+
+#define TEST_BLOCK_SIZE 0x1000
+#define TEST_SLOT_COUNT 4
+
+static fs::path GetTestCachePath()
+{
+	return fs::path("./s3readcachetest.cache");
+}
+
+static std::vector<uint8> MakeTestBlock(uint32 size, uint8 seed)
+{
+	std::vector<uint8> data(size);
+	for(uint32 i = 0; i < size; i++)
+	{
+		data[i] = static_cast<uint8>((i * 13) + (i >> 8) + seed);
+	}
+	return data;
+}
+
+static bool ReadTestBlock(CS3ReadCache& cache, const char* objectKey, uint64 blockIndex, const std::vector<uint8>& expected)
+{
+	std::vector<uint8> result(expected.size());
+	if(!cache.Read(objectKey, blockIndex, result.data(), static_cast<uint32>(result.size()))) return false;
+	return result == expected;
+}
+
+//Blocks are found by object key and block index, a block that was written with a different
+//size than the one requested is a miss
+void ExecuteS3ReadCacheReadWriteTest()
+{
+	fs::remove(GetTestCachePath());
+
+	CS3ReadCache cache(GetTestCachePath(), TEST_BLOCK_SIZE, TEST_BLOCK_SIZE * TEST_SLOT_COUNT);
+	CHECK(cache.GetBlockSize() == TEST_BLOCK_SIZE);
+	CHECK(cache.GetSlotCount() == TEST_SLOT_COUNT);
+
+	auto block0 = MakeTestBlock(TEST_BLOCK_SIZE, 0);
+	auto block1 = MakeTestBlock(TEST_BLOCK_SIZE, 1);
+	auto lastBlock = MakeTestBlock(0x123, 2);
+
+	CHECK(!ReadTestBlock(cache, "bucket/object/etag", 0, block0));
+
+	cache.Write("bucket/object/etag", 0, block0.data(), TEST_BLOCK_SIZE);
+	cache.Write("bucket/object/etag", 1, block1.data(), TEST_BLOCK_SIZE);
+	cache.Write("bucket/object/etag", 2, lastBlock.data(), static_cast<uint32>(lastBlock.size()));
+
+	CHECK(ReadTestBlock(cache, "bucket/object/etag", 0, block0));
+	CHECK(ReadTestBlock(cache, "bucket/object/etag", 1, block1));
+	CHECK(ReadTestBlock(cache, "bucket/object/etag", 2, lastBlock));
+	CHECK(!ReadTestBlock(cache, "bucket/object/etag", 2, block0));
+	CHECK(!ReadTestBlock(cache, "bucket/object/etag", 3, block0));
+	CHECK(!ReadTestBlock(cache, "bucket/object/otheretag", 0, block0));
+
+	//Writing a block again replaces its data
+	cache.Write("bucket/object/etag", 0, block1.data(), TEST_BLOCK_SIZE);
+	CHECK(ReadTestBlock(cache, "bucket/object/etag", 0, block1));
+}
+
+//Blocks written by a previous instance are still available
+void ExecuteS3ReadCacheReopenTest()
+{
+	fs::remove(GetTestCachePath());
+
+	auto block0 = MakeTestBlock(TEST_BLOCK_SIZE, 3);
+	auto block1 = MakeTestBlock(TEST_BLOCK_SIZE, 4);
+
+	{
+		CS3ReadCache cache(GetTestCachePath(), TEST_BLOCK_SIZE, TEST_BLOCK_SIZE * TEST_SLOT_COUNT);
+		cache.Write("bucket/object/etag", 0, block0.data(), TEST_BLOCK_SIZE);
+		cache.Write("bucket/other/etag", 5, block1.data(), TEST_BLOCK_SIZE);
+	}
+
+	{
+		CS3ReadCache cache(GetTestCachePath(), TEST_BLOCK_SIZE, TEST_BLOCK_SIZE * TEST_SLOT_COUNT);
+		CHECK(ReadTestBlock(cache, "bucket/object/etag", 0, block0));
+		CHECK(ReadTestBlock(cache, "bucket/other/etag", 5, block1));
+	}
+}
+
+//Once all slots are used, the least recently used block is replaced, including after reopening
+void ExecuteS3ReadCacheEvictionTest()
+{
+	fs::remove(GetTestCachePath());
+
+	std::vector<std::vector<uint8>> blocks;
+	for(uint32 i = 0; i < TEST_SLOT_COUNT + 2; i++)
+	{
+		blocks.push_back(MakeTestBlock(TEST_BLOCK_SIZE, static_cast<uint8>(0x10 + i)));
+	}
+
+	{
+		CS3ReadCache cache(GetTestCachePath(), TEST_BLOCK_SIZE, TEST_BLOCK_SIZE * TEST_SLOT_COUNT);
+		for(uint32 i = 0; i < TEST_SLOT_COUNT; i++)
+		{
+			cache.Write("bucket/object/etag", i, blocks[i].data(), TEST_BLOCK_SIZE);
+		}
+
+		//Block 0 becomes the most recently used, block 1 is now the oldest
+		CHECK(ReadTestBlock(cache, "bucket/object/etag", 0, blocks[0]));
+
+		cache.Write("bucket/object/etag", TEST_SLOT_COUNT, blocks[TEST_SLOT_COUNT].data(), TEST_BLOCK_SIZE);
+		CHECK(!ReadTestBlock(cache, "bucket/object/etag", 1, blocks[1]));
+		CHECK(ReadTestBlock(cache, "bucket/object/etag", 0, blocks[0]));
+		CHECK(ReadTestBlock(cache, "bucket/object/etag", TEST_SLOT_COUNT, blocks[TEST_SLOT_COUNT]));
+	}
+
+	{
+		//Block 2 was used the longest time ago
+		CS3ReadCache cache(GetTestCachePath(), TEST_BLOCK_SIZE, TEST_BLOCK_SIZE * TEST_SLOT_COUNT);
+		cache.Write("bucket/object/etag", TEST_SLOT_COUNT + 1, blocks[TEST_SLOT_COUNT + 1].data(), TEST_BLOCK_SIZE);
+		CHECK(!ReadTestBlock(cache, "bucket/object/etag", 2, blocks[2]));
+		CHECK(ReadTestBlock(cache, "bucket/object/etag", 0, blocks[0]));
+		CHECK(ReadTestBlock(cache, "bucket/object/etag", 3, blocks[3]));
+		CHECK(ReadTestBlock(cache, "bucket/object/etag", TEST_SLOT_COUNT, blocks[TEST_SLOT_COUNT]));
+		CHECK(ReadTestBlock(cache, "bucket/object/etag", TEST_SLOT_COUNT + 1, blocks[TEST_SLOT_COUNT + 1]));
+	}
+}
+
+//Cache files that are corrupted or have been created with other parameters are started over
+void ExecuteS3ReadCacheInvalidFileTest()
+{
+	fs::remove(GetTestCachePath());
+
+	auto block = MakeTestBlock(TEST_BLOCK_SIZE, 5);
+
+	{
+		CS3ReadCache cache(GetTestCachePath(), TEST_BLOCK_SIZE, TEST_BLOCK_SIZE * TEST_SLOT_COUNT);
+		cache.Write("bucket/object/etag", 0, block.data(), TEST_BLOCK_SIZE);
+	}
+
+	{
+		CS3ReadCache cache(GetTestCachePath(), TEST_BLOCK_SIZE, TEST_BLOCK_SIZE * (TEST_SLOT_COUNT + 1));
+		CHECK(cache.GetSlotCount() == (TEST_SLOT_COUNT + 1));
+		CHECK(!ReadTestBlock(cache, "bucket/object/etag", 0, block));
+		cache.Write("bucket/object/etag", 0, block.data(), TEST_BLOCK_SIZE);
+		CHECK(ReadTestBlock(cache, "bucket/object/etag", 0, block));
+	}
+
+	{
+		auto stream = Framework::CreateOutputStdStream(GetTestCachePath().native());
+		stream.Write8(0xCC);
+	}
+
+	{
+		CS3ReadCache cache(GetTestCachePath(), TEST_BLOCK_SIZE, TEST_BLOCK_SIZE * TEST_SLOT_COUNT);
+		CHECK(!ReadTestBlock(cache, "bucket/object/etag", 0, block));
+		cache.Write("bucket/object/etag", 0, block.data(), TEST_BLOCK_SIZE);
+		CHECK(ReadTestBlock(cache, "bucket/object/etag", 0, block));
+	}
+
+	fs::remove(GetTestCachePath());
+}
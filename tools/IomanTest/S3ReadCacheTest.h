@@ -0,0 +1,6 @@
+#pragma once
+
+void ExecuteS3ReadCacheReadWriteTest();
+void ExecuteS3ReadCacheReopenTest();
+void ExecuteS3ReadCacheEvictionTest();
+void ExecuteS3ReadCacheInvalidFileTest();
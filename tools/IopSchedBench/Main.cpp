@@ -0,0 +1,202 @@
+#include <stdio.h>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "iop/IopBios.h"
+#include "iop/Iop_SubSystem.h"
+#include "iop/Iop_Thbase.h"
+#include "iop/Iop_Thsema.h"
+#include "ThreadQueuesTest.h"
+
+//Checks the ordering guarantees of the IOP thread ready queue, then measures the cost of
+//IOP thread scheduling operations (ready queue, delays, semaphores and vblank waits) with
+//a configurable amount of threads. Kernel calls go through the same module entry points
+//used by IOP code.
+//Usage: IopSchedBench [thread count] [iteration count]
+
+enum THBASE_FUNCTION
+{
+	THBASE_CREATETHREAD = 4,
+	THBASE_STARTTHREAD = 6,
+	THBASE_CHANGETHREADPRIORITY = 14,
+	THBASE_ROTATETHREADREADYQUEUE = 16,
+	THBASE_GETTHREADID = 20,
+	THBASE_DELAYTHREAD = 33,
+};
+
+enum THSEMA_FUNCTION
+{
+	THSEMA_CREATESEMAPHORE = 4,
+	THSEMA_SIGNALSEMAPHORE = 6,
+	THSEMA_WAITSEMAPHORE = 8,
+};
+
+//Priorities used by the benchmark threads, module starter thread uses priority 8
+#define BENCH_BASE_PRIORITY 16
+#define BENCH_PRIORITY_COUNT 16
+
+class CSchedBench
+{
+public:
+	CSchedBench(uint32 threadCount)
+	    : m_subSystem(true)
+	{
+		m_subSystem.Reset();
+		m_bios = static_cast<CIopBios*>(m_subSystem.m_bios.get());
+		m_bios->Reset(std::shared_ptr<Iop::CSifMan>());
+		m_thbase = std::make_unique<Iop::CThbase>(*m_bios, m_subSystem.m_ram);
+		m_thsema = std::make_unique<Iop::CThsema>(*m_bios, m_subSystem.m_ram);
+
+		//Move module starter thread out of the way
+		m_bios->Reschedule();
+		Call(*m_thbase, THBASE_CHANGETHREADPRIORITY, 0, BENCH_BASE_PRIORITY + BENCH_PRIORITY_COUNT);
+
+		uint32 paramsAddress = m_bios->GetSysmem()->AllocateMemory(0x20, 0, 0);
+		auto params = reinterpret_cast<uint32*>(m_subSystem.m_ram + paramsAddress);
+		for(uint32 i = 0; i < threadCount; i++)
+		{
+			params[0] = 0;                                                //attributes
+			params[1] = 0;                                                //options
+			params[2] = 0x1000;                                           //threadProc (never executed)
+			params[3] = 0x400;                                            //stackSize
+			params[4] = BENCH_BASE_PRIORITY + (i % BENCH_PRIORITY_COUNT); //priority
+			int32 threadId = Call(*m_thbase, THBASE_CREATETHREAD, paramsAddress);
+			if(threadId <= 0)
+			{
+				throw std::runtime_error("Failed to create thread.");
+			}
+			Call(*m_thbase, THBASE_STARTTHREAD, threadId, 0);
+		}
+
+		params[0] = 0; //attributes
+		params[1] = 0; //options
+		params[2] = 0; //initialCount
+		params[3] = threadCount;
+		m_semaphoreId = Call(*m_thsema, THSEMA_CREATESEMAPHORE, paramsAddress);
+		m_bios->Reschedule();
+	}
+
+	int32 Call(Iop::CModule& module, uint32 functionId, uint32 a0 = 0, uint32 a1 = 0)
+	{
+		auto& cpu = m_subSystem.m_cpu;
+		cpu.m_State.nGPR[CMIPS::A0].nV0 = a0;
+		cpu.m_State.nGPR[CMIPS::A1].nV0 = a1;
+		module.Invoke(cpu, functionId);
+		return cpu.m_State.nGPR[CMIPS::V0].nV0;
+	}
+
+	bool HasCurrentThread()
+	{
+		return Call(*m_thbase, THBASE_GETTHREADID) > 0;
+	}
+
+	//Current thread gives up its time slice to the next thread of the same priority
+	void Rotate()
+	{
+		if(HasCurrentThread())
+		{
+			Call(*m_thbase, THBASE_ROTATETHREADREADYQUEUE, 0);
+		}
+		m_bios->Reschedule();
+	}
+
+	//Current thread waits for a short amount of time, most threads end up delayed
+	void Delay(uint32 iteration)
+	{
+		if(HasCurrentThread())
+		{
+			Call(*m_thbase, THBASE_DELAYTHREAD, 50 + (iteration % 7) * 10);
+		}
+		m_bios->CountTicks(200);
+		m_bios->Reschedule();
+	}
+
+	//Threads alternate between waiting on and signaling a semaphore
+	void Semaphore(uint32 iteration)
+	{
+		if(!HasCurrentThread())
+		{
+			Call(*m_thsema, THSEMA_SIGNALSEMAPHORE, m_semaphoreId);
+		}
+		else if(iteration & 1)
+		{
+			Call(*m_thsema, THSEMA_WAITSEMAPHORE, m_semaphoreId);
+		}
+		else
+		{
+			Call(*m_thsema, THSEMA_SIGNALSEMAPHORE, m_semaphoreId);
+			Call(*m_thbase, THBASE_ROTATETHREADREADYQUEUE, 0);
+		}
+		m_bios->Reschedule();
+	}
+
+	//Threads wait for vblank one after the other and are all woken up periodically
+	void VBlank(uint32 iteration)
+	{
+		if(HasCurrentThread())
+		{
+			m_bios->SleepThreadTillVBlankStart();
+		}
+		if((iteration % 16) == 15)
+		{
+			m_bios->NotifyVBlankStart();
+		}
+		m_bios->Reschedule();
+	}
+
+private:
+	Iop::CSubSystem m_subSystem;
+	CIopBios* m_bios = nullptr;
+	std::unique_ptr<Iop::CThbase> m_thbase;
+	std::unique_ptr<Iop::CThsema> m_thsema;
+	uint32 m_semaphoreId = 0;
+};
+
+static void RunScenario(const char* name, uint32 threadCount, uint32 iterationCount,
+                        const std::function<void(CSchedBench&, uint32)>& iterate)
+{
+	CSchedBench bench(threadCount);
+	auto startTime = std::chrono::high_resolution_clock::now();
+	for(uint32 i = 0; i < iterationCount; i++)
+	{
+		iterate(bench, i);
+	}
+	auto endTime = std::chrono::high_resolution_clock::now();
+	auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
+	printf("%-10s %4d threads: %d iterations in %fs (%f ns/iteration).\r\n",
+	       name, threadCount, iterationCount, static_cast<double>(duration) / 1000000000.0,
+	       static_cast<double>(duration) / static_cast<double>(iterationCount));
+}
+
+int main(int argc, const char** argv)
+{
+	uint32 threadCount = (argc > 1) ? std::stoul(argv[1]) : 64;
+	uint32 iterationCount = (argc > 2) ? std::stoul(argv[2]) : 1000000;
+
+	try
+	{
+		ExecuteReadyQueueFifoTest();
+		ExecuteReadyQueuePriorityChangeTest();
+		ExecuteReadyQueueDelayTest();
+		ExecuteKernelWakeupTest();
+
+		RunScenario("rotate", threadCount, iterationCount,
+		            [](CSchedBench& bench, uint32) { bench.Rotate(); });
+		RunScenario("delay", threadCount, iterationCount,
+		            [](CSchedBench& bench, uint32 i) { bench.Delay(i); });
+		RunScenario("semaphore", threadCount, iterationCount,
+		            [](CSchedBench& bench, uint32 i) { bench.Semaphore(i); });
+		RunScenario("vblank", threadCount, iterationCount,
+		            [](CSchedBench& bench, uint32 i) { bench.VBlank(i); });
+	}
+	catch(const std::exception& exception)
+	{
+		printf("Error: %s\r\n", exception.what());
+		return 1;
+	}
+
+	return 0;
+}
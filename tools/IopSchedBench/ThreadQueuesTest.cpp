@@ -0,0 +1,171 @@
+#include <vector>
+#include "ThreadQueuesTest.h"
+#include "Test.h"
+#include "iop/IopBios.h"
+#include "iop/Iop_SubSystem.h"
+#include "iop/Iop_ThreadQueues.h"
+
+using Iop::CThreadReadyQueue;
+
+//Threads linked with activation times in the past are ready right away
+#define CURRENT_TIME 100
+
+//Walks the list from its head, same order as the list in IOP RAM
+static std::vector<uint32> GetThreadOrder(const CThreadReadyQueue& queue)
+{
+	std::vector<uint32> order;
+	for(uint32 threadId = queue.GetHead(); threadId != CThreadReadyQueue::INVALID_THREAD_ID;
+	    threadId = queue.GetNext(threadId))
+	{
+		order.push_back(threadId);
+	}
+	return order;
+}
+
+//Threads with the same priority run in the order they were linked, threads with a higher
+//priority (lower value) come first
+void ExecuteReadyQueueFifoTest()
+{
+	CThreadReadyQueue queue;
+	queue.Reset();
+
+	CHECK(queue.GetHead() == CThreadReadyQueue::INVALID_THREAD_ID);
+	CHECK(queue.FindNextReady(CURRENT_TIME) == CThreadReadyQueue::INVALID_THREAD_ID);
+
+	CHECK(queue.Link(1, 32, 0, CURRENT_TIME) == CThreadReadyQueue::INVALID_THREAD_ID);
+	CHECK(queue.Link(2, 32, 0, CURRENT_TIME) == 1);
+	CHECK(queue.Link(3, 16, 0, CURRENT_TIME) == CThreadReadyQueue::INVALID_THREAD_ID);
+	CHECK(queue.Link(4, 32, 0, CURRENT_TIME) == 2);
+	CHECK(queue.Link(5, 16, 0, CURRENT_TIME) == 3);
+
+	CHECK((GetThreadOrder(queue) == std::vector<uint32>{3, 5, 1, 2, 4}));
+	CHECK(queue.GetFirstWithPriority(16) == 3);
+	CHECK(queue.GetFirstWithPriority(32) == 1);
+	CHECK(queue.GetFirstWithPriority(64) == CThreadReadyQueue::INVALID_THREAD_ID);
+	CHECK(queue.FindNextReady(CURRENT_TIME) == 3);
+
+	//Rotating the ready queue moves the first thread at the end of its segment
+	CHECK(queue.Unlink(3) == CThreadReadyQueue::INVALID_THREAD_ID);
+	CHECK(queue.Link(3, 16, 0, CURRENT_TIME) == 5);
+	CHECK((GetThreadOrder(queue) == std::vector<uint32>{5, 3, 1, 2, 4}));
+	CHECK(queue.FindNextReady(CURRENT_TIME) == 5);
+
+	//Unlinking from the middle of a segment keeps the order of the other threads
+	CHECK(queue.Unlink(2) == 1);
+	CHECK(!queue.IsLinked(2));
+	CHECK((GetThreadOrder(queue) == std::vector<uint32>{5, 3, 1, 4}));
+
+	//Unlinking a thread twice does nothing
+	CHECK(queue.Unlink(2) == CThreadReadyQueue::INVALID_THREAD_ID);
+	CHECK((GetThreadOrder(queue) == std::vector<uint32>{5, 3, 1, 4}));
+
+	CHECK(queue.Unlink(5) == CThreadReadyQueue::INVALID_THREAD_ID);
+	CHECK(queue.Unlink(3) == CThreadReadyQueue::INVALID_THREAD_ID);
+	CHECK(queue.GetFirstWithPriority(16) == CThreadReadyQueue::INVALID_THREAD_ID);
+	CHECK(queue.FindNextReady(CURRENT_TIME) == 1);
+}
+
+//Changing the priority of a thread moves it at the end of its new priority's segment
+void ExecuteReadyQueuePriorityChangeTest()
+{
+	CThreadReadyQueue queue;
+	queue.Reset();
+
+	queue.Link(1, 20, 0, CURRENT_TIME);
+	queue.Link(2, 20, 0, CURRENT_TIME);
+	queue.Link(3, 40, 0, CURRENT_TIME);
+	queue.Link(4, 40, 0, CURRENT_TIME);
+
+	//Lower priority
+	queue.Unlink(1);
+	CHECK(queue.Link(1, 40, 0, CURRENT_TIME) == 4);
+	CHECK((GetThreadOrder(queue) == std::vector<uint32>{2, 3, 4, 1}));
+	CHECK(queue.FindNextReady(CURRENT_TIME) == 2);
+
+	//Raise priority above all other threads
+	queue.Unlink(4);
+	CHECK(queue.Link(4, 10, 0, CURRENT_TIME) == CThreadReadyQueue::INVALID_THREAD_ID);
+	CHECK((GetThreadOrder(queue) == std::vector<uint32>{4, 2, 3, 1}));
+	CHECK(queue.FindNextReady(CURRENT_TIME) == 4);
+
+	//Move to a priority between two existing ones
+	queue.Unlink(1);
+	CHECK(queue.Link(1, 30, 0, CURRENT_TIME) == 2);
+	CHECK((GetThreadOrder(queue) == std::vector<uint32>{4, 2, 1, 3}));
+	CHECK(queue.GetFirstWithPriority(20) == 2);
+	CHECK(queue.GetFirstWithPriority(30) == 1);
+	CHECK(queue.GetFirstWithPriority(40) == 3);
+}
+
+//Delayed threads keep their place in the list but are skipped until their activation time
+void ExecuteReadyQueueDelayTest()
+{
+	CThreadReadyQueue queue;
+	queue.Reset();
+
+	queue.Link(1, 20, CURRENT_TIME + 50, CURRENT_TIME);
+	queue.Link(2, 20, 0, CURRENT_TIME);
+	queue.Link(3, 30, CURRENT_TIME + 10, CURRENT_TIME);
+
+	CHECK((GetThreadOrder(queue) == std::vector<uint32>{1, 2, 3}));
+	CHECK(queue.FindNextReady(CURRENT_TIME) == 2);
+
+	queue.Unlink(2);
+	CHECK(queue.FindNextReady(CURRENT_TIME) == CThreadReadyQueue::INVALID_THREAD_ID);
+	CHECK(queue.FindNextReady(CURRENT_TIME + 11) == 3);
+	CHECK(queue.FindNextReady(CURRENT_TIME + 51) == 1);
+
+	//Timer of a thread unlinked before its activation must not make it ready when relinked
+	queue.Unlink(3);
+	queue.Link(3, 10, CURRENT_TIME + 200, CURRENT_TIME + 60);
+	queue.Unlink(3);
+	queue.Link(3, 10, CURRENT_TIME + 400, CURRENT_TIME + 60);
+	CHECK(queue.FindNextReady(CURRENT_TIME + 300) == 1);
+	CHECK(queue.FindNextReady(CURRENT_TIME + 401) == 3);
+}
+
+//Threads going to sleep are unlinked and threads woken up are linked back after
+//threads of the same priority, in the ready queue and in the list kept in IOP RAM
+void ExecuteKernelWakeupTest()
+{
+	Iop::CSubSystem subSystem(true);
+	subSystem.Reset();
+	auto bios = static_cast<CIopBios*>(subSystem.m_bios.get());
+	bios->Reset(std::shared_ptr<Iop::CSifMan>());
+
+	//Move module starter thread out of the way
+	bios->Reschedule();
+	CHECK(bios->ChangeThreadPriority(0, 100) == CIopBios::KERNEL_RESULT_OK);
+
+	std::vector<uint32> threadIds;
+	for(uint32 i = 0; i < 3; i++)
+	{
+		uint32 threadId = bios->CreateThread(0x1000, 16, 0x400, 0, 0);
+		CHECK(static_cast<int32>(threadId) > 0);
+		CHECK(bios->StartThread(threadId, 0) == CIopBios::KERNEL_RESULT_OK);
+		threadIds.push_back(threadId);
+	}
+
+	bios->Reschedule();
+	CHECK(static_cast<uint32>(bios->GetCurrentThreadIdRaw()) == threadIds[0]);
+
+	CHECK(bios->SleepThread() == CIopBios::KERNEL_RESULT_OK);
+	CHECK(bios->GetThread(threadIds[0])->nextThreadId == 0);
+	bios->Reschedule();
+	CHECK(static_cast<uint32>(bios->GetCurrentThreadIdRaw()) == threadIds[1]);
+
+	bios->WakeupThread(threadIds[0], false);
+	CHECK(bios->GetThread(threadIds[1])->nextThreadId == threadIds[2]);
+	CHECK(bios->GetThread(threadIds[2])->nextThreadId == threadIds[0]);
+	bios->Reschedule();
+	CHECK(static_cast<uint32>(bios->GetCurrentThreadIdRaw()) == threadIds[1]);
+
+	//Illegal priorities are rejected instead of reaching the ready queue
+	CHECK(bios->ChangeThreadPriority(threadIds[1], 127) == CIopBios::KERNEL_RESULT_ERROR_ILLEGAL_PRIORITY);
+	CHECK(bios->GetThread(threadIds[1])->priority == 16);
+
+	CHECK(bios->ChangeThreadPriority(threadIds[1], 20) == CIopBios::KERNEL_RESULT_OK);
+	CHECK(bios->GetThread(threadIds[0])->nextThreadId == threadIds[1]);
+	bios->Reschedule();
+	CHECK(static_cast<uint32>(bios->GetCurrentThreadIdRaw()) == threadIds[2]);
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+void ExecuteReadyQueueFifoTest();
+void ExecuteReadyQueuePriorityChangeTest();
+void ExecuteReadyQueueDelayTest();
+void ExecuteKernelWakeupTest();
@@ -0,0 +1,204 @@
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include "FileSystemTest.h"
+#include "Test.h"
+#include "MemStream.h"
+#include "ISO9660/ISO9660.h"
+
+#define SECTOR_SIZE 0x800
+#define VOLUME_DESCRIPTOR_SECTOR 0x10
+#define PATH_TABLE_SECTOR 0x11
+#define ROOT_DIRECTORY_SECTOR 0x12
+#define DATA_DIRECTORY_SECTOR 0x13
+#define DATA_DIRECTORY_SECTOR_COUNT 0x40
+#define FILE_SECTOR (DATA_DIRECTORY_SECTOR + DATA_DIRECTORY_SECTOR_COUNT)
+
+//More files than there are entries in the path cache
+#define FILE_COUNT 0x500
+
+struct DIRECTORY_ENTRY
+{
+	std::string name;
+	uint32 sector = 0;
+	uint32 size = 0;
+	bool isDirectory = false;
+};
+typedef std::vector<DIRECTORY_ENTRY> DirectoryEntryList;
+
+static std::string GetFileName(uint32 fileIndex)
+{
+	char name[16];
+	snprintf(name, sizeof(name), "FILE%04X.BIN;1", fileIndex);
+	return name;
+}
+
+static void WriteDirectoryRecord(std::vector<uint8>& image, uint32& position, const DIRECTORY_ENTRY& entry)
+{
+	uint32 nameSize = static_cast<uint32>(entry.name.size());
+	uint32 length = (0x21 + nameSize + 1) & ~1;
+
+	//Records don't cross sector boundaries
+	if(((position % SECTOR_SIZE) + length) > SECTOR_SIZE)
+	{
+		position = (position + SECTOR_SIZE - 1) & ~(SECTOR_SIZE - 1);
+	}
+
+	auto record = image.data() + position;
+	record[0x00] = static_cast<uint8>(length);
+	memcpy(record + 0x02, &entry.sector, sizeof(uint32));
+	memcpy(record + 0x0A, &entry.size, sizeof(uint32));
+	record[0x19] = entry.isDirectory ? 0x02 : 0x00;
+	record[0x20] = static_cast<uint8>(nameSize);
+	memcpy(record + 0x21, entry.name.data(), nameSize);
+	position += length;
+}
+
+static void WriteDirectory(std::vector<uint8>& image, uint32 sector, uint32 sectorCount, uint32 parentSector, const DirectoryEntryList& entries)
+{
+	uint32 position = sector * SECTOR_SIZE;
+	{
+		DIRECTORY_ENTRY entry;
+		entry.name = std::string(1, '\0');
+		entry.sector = sector;
+		entry.size = sectorCount * SECTOR_SIZE;
+		entry.isDirectory = true;
+		WriteDirectoryRecord(image, position, entry);
+	}
+	{
+		DIRECTORY_ENTRY entry;
+		entry.name = std::string(1, '\1');
+		entry.sector = parentSector;
+		entry.size = SECTOR_SIZE;
+		entry.isDirectory = true;
+		WriteDirectoryRecord(image, position, entry);
+	}
+	for(const auto& entry : entries)
+	{
+		WriteDirectoryRecord(image, position, entry);
+	}
+	CHECK(position <= ((sector + sectorCount) * SECTOR_SIZE));
+}
+
+//Builds a disc image with a few files in the root directory and lots of files in a
+//'DATA' directory. Every file is a sector that starts with the file's index.
+static std::shared_ptr<CISO9660> MakeFileSystem()
+{
+	std::vector<uint8> image((FILE_SECTOR + FILE_COUNT) * SECTOR_SIZE);
+
+	auto volumeDescriptor = image.data() + (VOLUME_DESCRIPTOR_SECTOR * SECTOR_SIZE);
+	volumeDescriptor[0] = 0x01;
+	memcpy(volumeDescriptor + 1, "CD001", 5);
+	uint32 pathTableSector = PATH_TABLE_SECTOR;
+	memcpy(volumeDescriptor + 140, &pathTableSector, sizeof(uint32));
+
+	{
+		auto pathTable = image.data() + (PATH_TABLE_SECTOR * SECTOR_SIZE);
+		uint32 rootSector = ROOT_DIRECTORY_SECTOR;
+		uint32 dataSector = DATA_DIRECTORY_SECTOR;
+		uint16 parent = 1;
+		pathTable[0x00] = 1;
+		memcpy(pathTable + 0x02, &rootSector, sizeof(uint32));
+		memcpy(pathTable + 0x06, &parent, sizeof(uint16));
+		pathTable[0x0A] = 4;
+		memcpy(pathTable + 0x0C, &dataSector, sizeof(uint32));
+		memcpy(pathTable + 0x10, &parent, sizeof(uint16));
+		memcpy(pathTable + 0x12, "DATA", 4);
+	}
+
+	for(uint32 fileIndex = 0; fileIndex < FILE_COUNT; fileIndex++)
+	{
+		memcpy(image.data() + ((FILE_SECTOR + fileIndex) * SECTOR_SIZE), &fileIndex, sizeof(uint32));
+	}
+
+	{
+		DirectoryEntryList entries;
+		DIRECTORY_ENTRY dataEntry;
+		dataEntry.name = "DATA";
+		dataEntry.sector = DATA_DIRECTORY_SECTOR;
+		dataEntry.size = DATA_DIRECTORY_SECTOR_COUNT * SECTOR_SIZE;
+		dataEntry.isDirectory = true;
+		entries.push_back(dataEntry);
+		for(uint32 fileIndex = 0; fileIndex < 4; fileIndex++)
+		{
+			DIRECTORY_ENTRY entry;
+			entry.name = GetFileName(fileIndex);
+			entry.sector = FILE_SECTOR + fileIndex;
+			entry.size = sizeof(uint32);
+			entries.push_back(entry);
+		}
+		WriteDirectory(image, ROOT_DIRECTORY_SECTOR, 1, ROOT_DIRECTORY_SECTOR, entries);
+	}
+
+	{
+		DirectoryEntryList entries;
+		for(uint32 fileIndex = 0; fileIndex < FILE_COUNT; fileIndex++)
+		{
+			DIRECTORY_ENTRY entry;
+			entry.name = GetFileName(fileIndex);
+			entry.sector = FILE_SECTOR + fileIndex;
+			entry.size = sizeof(uint32);
+			entries.push_back(entry);
+		}
+		WriteDirectory(image, DATA_DIRECTORY_SECTOR, DATA_DIRECTORY_SECTOR_COUNT, ROOT_DIRECTORY_SECTOR, entries);
+	}
+
+	auto stream = std::make_shared<Framework::CMemStream>();
+	stream->Write(image.data(), image.size());
+	auto blockProvider = std::make_shared<ISO9660::CBlockProvider2048>(std::static_pointer_cast<Framework::CStream>(stream));
+	return std::make_shared<CISO9660>(blockProvider);
+}
+
+static bool CheckFile(CISO9660& fileSystem, const char* path, uint32 fileIndex)
+{
+	auto file = std::unique_ptr<Framework::CStream>(fileSystem.Open(path));
+	if(!file) return false;
+	if(file->GetLength() != sizeof(uint32)) return false;
+	uint32 value = ~0U;
+	file->Read(&value, sizeof(uint32));
+	return value == fileIndex;
+}
+
+//Paths are case insensitive, can use backslashes and can omit the version number
+void ExecuteFileLookupTest()
+{
+	auto fileSystem = MakeFileSystem();
+
+	CHECK(CheckFile(*fileSystem, "/FILE0000.BIN;1", 0));
+	CHECK(CheckFile(*fileSystem, "FILE0001.BIN", 1));
+	CHECK(CheckFile(*fileSystem, "/file0002.bin;1", 2));
+	CHECK(CheckFile(*fileSystem, "/DATA/FILE0010.BIN;1", 0x10));
+	CHECK(CheckFile(*fileSystem, "\\data\\file04ff.bin", 0x4FF));
+
+	CHECK(!fileSystem->Open("/FILE0010.BIN"));
+	CHECK(!fileSystem->Open("/DATA/FILE0500.BIN"));
+	CHECK(!fileSystem->Open("/OTHER/FILE0000.BIN"));
+
+	CISO9660::DirectoryRecordList records;
+	CHECK(fileSystem->GetDirectoryRecords("/DATA", records));
+	CHECK(records.size() == (FILE_COUNT + 2));
+	CHECK(!fileSystem->GetDirectoryRecords("/OTHER/", records));
+}
+
+//Looking up more files than the cache can hold, in different orders and along with failing
+//lookups, always gives the same results
+void ExecuteFileLookupCacheTest()
+{
+	auto fileSystem = MakeFileSystem();
+
+	for(unsigned int pass = 0; pass < 3; pass++)
+	{
+		for(uint32 i = 0; i < FILE_COUNT; i++)
+		{
+			uint32 fileIndex = (pass == 1) ? (FILE_COUNT - 1 - i) : ((i * 7) % FILE_COUNT);
+			auto path = "/DATA/" + GetFileName(fileIndex);
+			CHECK(CheckFile(*fileSystem, path.c_str(), fileIndex));
+
+			//Frequently used file stays in the cache while others get evicted
+			CHECK(CheckFile(*fileSystem, "/DATA/FILE0000.BIN", 0));
+			CHECK(!fileSystem->Open("/DATA/MISSING.BIN"));
+		}
+	}
+}
@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include "DiskUtils.h"
+#include "ISO9660/ISO9660.h"
+#include "FileSystemTest.h"
+
+//Opens (and reads) every file present on a disc image, useful to measure the cost
+//of file lookups done by games that open lots of small files.
+//Usage: IsoBench <disc image path> [pass count]
+//       IsoBench --test (checks file lookups on a generated disc image)
+
+typedef std::vector<std::string> PathList;
+
+static void CollectFiles(CISO9660* fileSystem, const std::string& directoryPath, PathList& paths)
+{
+	CISO9660::DirectoryRecordList records;
+	if(!fileSystem->GetDirectoryRecords(directoryPath.c_str(), records))
+	{
+		return;
+	}
+
+	for(const auto& record : records)
+	{
+		const char* name = record.GetName();
+		if((name[0] == 0x00) || (name[0] == 0x01)) continue;
+		auto path = directoryPath + name;
+		if(record.IsDirectory())
+		{
+			CollectFiles(fileSystem, path + "/", paths);
+		}
+		else
+		{
+			paths.push_back(path);
+		}
+	}
+}
+
+int main(int argc, const char** argv)
+{
+	if(argc < 2)
+	{
+		printf("Usage: IsoBench <disc image path> [pass count]\r\n");
+		printf("       IsoBench --test\r\n");
+		return 1;
+	}
+
+	if(!strcmp(argv[1], "--test"))
+	{
+		try
+		{
+			ExecuteFileLookupTest();
+			ExecuteFileLookupCacheTest();
+		}
+		catch(const std::exception& exception)
+		{
+			printf("Error: %s\r\n", exception.what());
+			return 1;
+		}
+		return 0;
+	}
+
+	unsigned int passCount = (argc > 2) ? std::stoul(argv[2]) : 2;
+
+	try
+	{
+		auto opticalMedia = DiskUtils::CreateOpticalMediaFromPath(argv[1]);
+		auto fileSystem = opticalMedia->GetFileSystem();
+
+		PathList paths;
+		CollectFiles(fileSystem, "/", paths);
+		printf("Found %d files.\r\n", static_cast<int>(paths.size()));
+
+		std::vector<uint8> buffer;
+		for(unsigned int pass = 0; pass < passCount; pass++)
+		{
+			uint64 totalSize = 0;
+			unsigned int failedCount = 0;
+			auto startTime = std::chrono::high_resolution_clock::now();
+			for(const auto& path : paths)
+			{
+				auto file = std::unique_ptr<Framework::CStream>(fileSystem->Open(path.c_str()));
+				if(!file)
+				{
+					failedCount++;
+					continue;
+				}
+				auto fileSize = file->GetLength();
+				buffer.resize(static_cast<size_t>(fileSize));
+				file->Read(buffer.data(), fileSize);
+				totalSize += fileSize;
+			}
+			auto endTime = std::chrono::high_resolution_clock::now();
+			auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+			double seconds = static_cast<double>(duration) / 1000000.0;
+			printf("Pass %d: opened %d files (%d failed), read %llu bytes in %fs (%f files/s).\r\n",
+			       pass, static_cast<int>(paths.size()), failedCount, static_cast<unsigned long long>(totalSize),
+			       seconds, (seconds != 0) ? (paths.size() / seconds) : 0.0);
+		}
+	}
+	catch(const std::exception& exception)
+	{
+		printf("Error: %s\r\n", exception.what());
+		return 1;
+	}
+
+	return 0;
+}
@@ -95,6 +95,85 @@ void ExecuteTest(const CGameTestSheet::TEST& test)
 	}
 }
 
+std::vector<std::string> GetDirEntryNames(Iop::CMcServ* mcServ, const char* query)
+{
+	uint32 result = 0;
+
+	Iop::CMcServ::CMD cmd;
+	memset(&cmd, 0, sizeof(cmd));
+	cmd.maxEntries = 0x20;
+	strncpy(cmd.name, query, sizeof(cmd.name));
+
+	std::vector<Iop::CMcServ::ENTRY> entries(cmd.maxEntries);
+	mcServ->Invoke(0xD, reinterpret_cast<uint32*>(&cmd), sizeof(cmd), &result, sizeof(uint32), reinterpret_cast<uint8*>(entries.data()));
+
+	std::vector<std::string> names;
+	for(uint32 i = 0; i < result; i++)
+	{
+		names.push_back(reinterpret_cast<const char*>(entries[i].name));
+	}
+	return names;
+}
+
+bool HasEntry(const std::vector<std::string>& names, const char* name)
+{
+	return std::count(names.begin(), names.end(), name) == 1;
+}
+
+//Directory listings are cached by McServ, make sure modifications done through it are visible
+void ExecuteDirectoryIndexTest()
+{
+	CGameTestSheet::EnvironmentActionArray environment;
+	{
+		CGameTestSheet::ENVIRONMENT_ACTION action;
+		action.type = CGameTestSheet::ENVIRONMENT_ACTION_CREATE_DIRECTORY;
+		action.name = "/SAVE0";
+		environment.push_back(action);
+		action.type = CGameTestSheet::ENVIRONMENT_ACTION_CREATE_FILE;
+		action.name = "/SAVE0/icon.sys";
+		action.size = 964;
+		environment.push_back(action);
+	}
+	PrepareTestEnvironment(environment);
+
+	Iop::CSubSystem subSystem(true);
+	subSystem.Reset();
+	auto bios = static_cast<CIopBios*>(subSystem.m_bios.get());
+	bios->Reset(std::shared_ptr<Iop::CSifMan>());
+	auto mcServ = bios->GetMcServ();
+
+	CHECK(HasEntry(GetDirEntryNames(mcServ, "/*"), "SAVE0"));
+	CHECK(!HasEntry(GetDirEntryNames(mcServ, "/*"), "SAVE1"));
+	CHECK(HasEntry(GetDirEntryNames(mcServ, "/SAVE0/*"), "icon.sys"));
+
+	{
+		uint32 result = -1;
+
+		Iop::CMcServ::CMD cmd;
+		memset(&cmd, 0, sizeof(cmd));
+		cmd.flags = 0x40;
+		strncpy(cmd.name, "/SAVE1", sizeof(cmd.name));
+
+		mcServ->Invoke(0x2, reinterpret_cast<uint32*>(&cmd), sizeof(cmd), &result, sizeof(uint32), nullptr);
+		CHECK(result == 0);
+	}
+
+	CHECK(HasEntry(GetDirEntryNames(mcServ, "/*"), "SAVE1"));
+
+	{
+		uint32 result = -1;
+
+		Iop::CMcServ::CMD cmd;
+		memset(&cmd, 0, sizeof(cmd));
+		strncpy(cmd.name, "/SAVE0/icon.sys", sizeof(cmd.name));
+
+		mcServ->Invoke(0xF, reinterpret_cast<uint32*>(&cmd), sizeof(cmd), &result, sizeof(uint32), nullptr);
+		CHECK(result == 0);
+	}
+
+	CHECK(!HasEntry(GetDirEntryNames(mcServ, "/SAVE0/*"), "icon.sys"));
+}
+
 int main(int argc, const char** argv)
 {
 	auto testsPath = fs::path("./tests/");
@@ -115,5 +194,7 @@ int main(int argc, const char** argv)
 		}
 	}
 
+	ExecuteDirectoryIndexTest();
+
 	return 0;
 }
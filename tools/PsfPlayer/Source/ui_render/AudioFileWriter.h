@@ -0,0 +1,92 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "Types.h"
+#include "StdStream.h"
+#include "filesystem_def.h"
+
+//Writes 16-bit stereo audio to a file. Samples are interleaved (left, right).
+class CAudioFileWriter
+{
+public:
+	enum
+	{
+		CHANNEL_COUNT = 2,
+		BITS_PER_SAMPLE = 16,
+	};
+
+	virtual ~CAudioFileWriter() = default;
+
+	//Sample count is the amount of int16 values (frame count * CHANNEL_COUNT)
+	virtual void Write(const int16*, uint32) = 0;
+
+	//Completes headers, no writes are allowed afterwards
+	virtual void Finish() = 0;
+};
+
+typedef std::unique_ptr<CAudioFileWriter> AudioFileWriterPtr;
+
+class CWavFileWriter : public CAudioFileWriter
+{
+public:
+	CWavFileWriter(const fs::path&, uint32 sampleRate);
+
+	void Write(const int16*, uint32) override;
+	void Finish() override;
+
+private:
+	void WriteHeader();
+
+	Framework::CStdStream m_stream;
+	uint32 m_sampleRate = 0;
+	uint32 m_dataSize = 0;
+};
+
+//Uses fixed linear predictors (orders 0 to 4) with Rice coded residuals, which is what
+//reference encoders do at their fastest setting.
+class CFlacFileWriter : public CAudioFileWriter
+{
+public:
+	CFlacFileWriter(const fs::path&, uint32 sampleRate);
+
+	void Write(const int16*, uint32) override;
+	void Finish() override;
+
+private:
+	enum
+	{
+		BLOCK_SIZE = 4096,
+		MAX_FIXED_ORDER = 4,
+		MAX_RICE_PARAMETER = 14,
+	};
+
+	class CBitWriter
+	{
+	public:
+		void Reset();
+		void WriteBits(uint32 value, uint32 bitCount);
+		void WriteSignedBits(int32 value, uint32 bitCount);
+		void WriteUnary(uint32);
+		void AlignToByte();
+		const std::vector<uint8>& GetBytes() const;
+
+	private:
+		std::vector<uint8> m_bytes;
+		uint64 m_accumulator = 0;
+		uint32 m_accumulatorBits = 0;
+	};
+
+	void WriteStreamInfo();
+	void EncodeFrame(uint32 frameSize);
+	void EncodeSubframe(const int32*, uint32 frameSize);
+
+	Framework::CStdStream m_stream;
+	uint32 m_sampleRate = 0;
+	uint64 m_totalFrameCount = 0;
+	uint32 m_frameIndex = 0;
+	std::vector<int32> m_channelSamples[CHANNEL_COUNT];
+	uint32 m_bufferedFrameCount = 0;
+	std::vector<int32> m_residuals;
+	CBitWriter m_bitWriter;
+};
@@ -0,0 +1,349 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include "AudioFileWriter.h"
+#include "StdStreamUtils.h"
+
+#define STREAMINFO_SIZE 34
+
+static uint8 ComputeCrc8(const uint8* data, size_t size)
+{
+	uint8 crc = 0;
+	for(size_t i = 0; i < size; i++)
+	{
+		crc ^= data[i];
+		for(unsigned int bit = 0; bit < 8; bit++)
+		{
+			crc = (crc & 0x80) ? static_cast<uint8>((crc << 1) ^ 0x07) : static_cast<uint8>(crc << 1);
+		}
+	}
+	return crc;
+}
+
+static uint16 ComputeCrc16(const uint8* data, size_t size)
+{
+	uint16 crc = 0;
+	for(size_t i = 0; i < size; i++)
+	{
+		crc ^= static_cast<uint16>(data[i] << 8);
+		for(unsigned int bit = 0; bit < 8; bit++)
+		{
+			crc = (crc & 0x8000) ? static_cast<uint16>((crc << 1) ^ 0x8005) : static_cast<uint16>(crc << 1);
+		}
+	}
+	return crc;
+}
+
+static uint32 GetSampleRateCode(uint32 sampleRate)
+{
+	switch(sampleRate)
+	{
+	case 22050:
+		return 0x7;
+	case 32000:
+		return 0x8;
+	case 44100:
+		return 0x9;
+	case 48000:
+		return 0xA;
+	default:
+		//Use the value from STREAMINFO
+		return 0x0;
+	}
+}
+
+static uint32 FoldResidual(int32 residual)
+{
+	return (static_cast<uint32>(residual) << 1) ^ static_cast<uint32>(residual >> 31);
+}
+
+void CFlacFileWriter::CBitWriter::Reset()
+{
+	m_bytes.clear();
+	m_accumulator = 0;
+	m_accumulatorBits = 0;
+}
+
+void CFlacFileWriter::CBitWriter::WriteBits(uint32 value, uint32 bitCount)
+{
+	assert(bitCount <= 32);
+	if(bitCount == 0) return;
+	uint64 mask = (1ULL << bitCount) - 1;
+	m_accumulator = (m_accumulator << bitCount) | (value & mask);
+	m_accumulatorBits += bitCount;
+	while(m_accumulatorBits >= 8)
+	{
+		m_accumulatorBits -= 8;
+		m_bytes.push_back(static_cast<uint8>(m_accumulator >> m_accumulatorBits));
+	}
+}
+
+void CFlacFileWriter::CBitWriter::WriteSignedBits(int32 value, uint32 bitCount)
+{
+	WriteBits(static_cast<uint32>(value), bitCount);
+}
+
+void CFlacFileWriter::CBitWriter::WriteUnary(uint32 value)
+{
+	while(value >= 32)
+	{
+		WriteBits(0, 32);
+		value -= 32;
+	}
+	WriteBits(1, value + 1);
+}
+
+void CFlacFileWriter::CBitWriter::AlignToByte()
+{
+	if(m_accumulatorBits != 0)
+	{
+		WriteBits(0, 8 - m_accumulatorBits);
+	}
+}
+
+const std::vector<uint8>& CFlacFileWriter::CBitWriter::GetBytes() const
+{
+	assert(m_accumulatorBits == 0);
+	return m_bytes;
+}
+
+CFlacFileWriter::CFlacFileWriter(const fs::path& path, uint32 sampleRate)
+    : m_stream(Framework::CreateOutputStdStream(path.native()))
+    , m_sampleRate(sampleRate)
+{
+	for(auto& channelSamples : m_channelSamples)
+	{
+		channelSamples.resize(BLOCK_SIZE);
+	}
+	m_residuals.resize(BLOCK_SIZE);
+	WriteStreamInfo();
+}
+
+void CFlacFileWriter::Write(const int16* samples, uint32 sampleCount)
+{
+	uint32 frameCount = sampleCount / CHANNEL_COUNT;
+	for(uint32 i = 0; i < frameCount; i++)
+	{
+		for(uint32 channel = 0; channel < CHANNEL_COUNT; channel++)
+		{
+			m_channelSamples[channel][m_bufferedFrameCount] = samples[(i * CHANNEL_COUNT) + channel];
+		}
+		m_bufferedFrameCount++;
+		if(m_bufferedFrameCount == BLOCK_SIZE)
+		{
+			EncodeFrame(m_bufferedFrameCount);
+			m_bufferedFrameCount = 0;
+		}
+	}
+}
+
+void CFlacFileWriter::Finish()
+{
+	if(m_bufferedFrameCount != 0)
+	{
+		EncodeFrame(m_bufferedFrameCount);
+		m_bufferedFrameCount = 0;
+	}
+	m_stream.Seek(0, Framework::STREAM_SEEK_SET);
+	WriteStreamInfo();
+}
+
+void CFlacFileWriter::WriteStreamInfo()
+{
+	m_bitWriter.Reset();
+	m_bitWriter.WriteBits(0x664C6143, 32); //'fLaC'
+	m_bitWriter.WriteBits(0x80, 8);        //Last metadata block, STREAMINFO
+	m_bitWriter.WriteBits(STREAMINFO_SIZE, 24);
+	m_bitWriter.WriteBits(BLOCK_SIZE, 16); //Minimum block size
+	m_bitWriter.WriteBits(BLOCK_SIZE, 16); //Maximum block size
+	m_bitWriter.WriteBits(0, 24);          //Minimum frame size (unknown)
+	m_bitWriter.WriteBits(0, 24);          //Maximum frame size (unknown)
+	m_bitWriter.WriteBits(m_sampleRate, 20);
+	m_bitWriter.WriteBits(CHANNEL_COUNT - 1, 3);
+	m_bitWriter.WriteBits(BITS_PER_SAMPLE - 1, 5);
+	m_bitWriter.WriteBits(static_cast<uint32>(m_totalFrameCount >> 32), 4);
+	m_bitWriter.WriteBits(static_cast<uint32>(m_totalFrameCount), 32);
+	for(unsigned int i = 0; i < 4; i++)
+	{
+		//MD5 signature (not computed)
+		m_bitWriter.WriteBits(0, 32);
+	}
+	const auto& bytes = m_bitWriter.GetBytes();
+	m_stream.Write(bytes.data(), bytes.size());
+}
+
+void CFlacFileWriter::EncodeFrame(uint32 frameSize)
+{
+	m_bitWriter.Reset();
+	m_bitWriter.WriteBits(0xFFF8, 16); //Sync code, fixed block size
+	m_bitWriter.WriteBits(0x7, 4);     //Block size stored at end of header
+	m_bitWriter.WriteBits(GetSampleRateCode(m_sampleRate), 4);
+	m_bitWriter.WriteBits(CHANNEL_COUNT - 1, 4); //Independent channels
+	m_bitWriter.WriteBits(0x4, 3);               //16 bits per sample
+	m_bitWriter.WriteBits(0, 1);
+
+	//Frame number, coded like UTF-8
+	uint32 frameIndex = m_frameIndex++;
+	if(frameIndex < 0x80)
+	{
+		m_bitWriter.WriteBits(frameIndex, 8);
+	}
+	else
+	{
+		uint32 byteCount = 2;
+		while((byteCount < 6) && (frameIndex >= (1U << (5 * byteCount + 1))))
+		{
+			byteCount++;
+		}
+		uint32 leadBits = (0xFF00 >> byteCount) & 0xFF;
+		m_bitWriter.WriteBits(leadBits | (frameIndex >> (6 * (byteCount - 1))), 8);
+		for(uint32 i = byteCount - 1; i > 0; i--)
+		{
+			m_bitWriter.WriteBits(0x80 | ((frameIndex >> (6 * (i - 1))) & 0x3F), 8);
+		}
+	}
+	m_bitWriter.WriteBits(frameSize - 1, 16);
+	{
+		const auto& headerBytes = m_bitWriter.GetBytes();
+		m_bitWriter.WriteBits(ComputeCrc8(headerBytes.data(), headerBytes.size()), 8);
+	}
+
+	for(uint32 channel = 0; channel < CHANNEL_COUNT; channel++)
+	{
+		EncodeSubframe(m_channelSamples[channel].data(), frameSize);
+	}
+
+	m_bitWriter.AlignToByte();
+	{
+		const auto& frameBytes = m_bitWriter.GetBytes();
+		m_bitWriter.WriteBits(ComputeCrc16(frameBytes.data(), frameBytes.size()), 16);
+	}
+
+	const auto& bytes = m_bitWriter.GetBytes();
+	m_stream.Write(bytes.data(), bytes.size());
+	m_totalFrameCount += frameSize;
+}
+
+void CFlacFileWriter::EncodeSubframe(const int32* samples, uint32 frameSize)
+{
+	if(std::all_of(samples, samples + frameSize, [&](int32 sample) { return sample == samples[0]; }))
+	{
+		m_bitWriter.WriteBits(0x00, 8); //Constant
+		m_bitWriter.WriteSignedBits(samples[0], BITS_PER_SAMPLE);
+		return;
+	}
+
+	//Pick the predictor order that gives the smallest residuals
+	uint32 maxOrder = std::min<uint32>(MAX_FIXED_ORDER, frameSize);
+	uint32 bestOrder = 0;
+	uint64 bestSum = ~0ULL;
+	for(uint32 order = 0; order <= maxOrder; order++)
+	{
+		uint64 sum = 0;
+		for(uint32 i = maxOrder; i < frameSize; i++)
+		{
+			int32 residual = 0;
+			switch(order)
+			{
+			case 0:
+				residual = samples[i];
+				break;
+			case 1:
+				residual = samples[i] - samples[i - 1];
+				break;
+			case 2:
+				residual = samples[i] - 2 * samples[i - 1] + samples[i - 2];
+				break;
+			case 3:
+				residual = samples[i] - 3 * samples[i - 1] + 3 * samples[i - 2] - samples[i - 3];
+				break;
+			case 4:
+				residual = samples[i] - 4 * samples[i - 1] + 6 * samples[i - 2] - 4 * samples[i - 3] + samples[i - 4];
+				break;
+			}
+			sum += std::abs(residual);
+		}
+		if(sum < bestSum)
+		{
+			bestSum = sum;
+			bestOrder = order;
+		}
+	}
+
+	uint32 residualCount = frameSize - bestOrder;
+	uint64 foldedSum = 0;
+	for(uint32 i = bestOrder; i < frameSize; i++)
+	{
+		int32 residual = samples[i];
+		switch(bestOrder)
+		{
+		case 1:
+			residual -= samples[i - 1];
+			break;
+		case 2:
+			residual -= 2 * samples[i - 1] - samples[i - 2];
+			break;
+		case 3:
+			residual -= 3 * samples[i - 1] - 3 * samples[i - 2] + samples[i - 3];
+			break;
+		case 4:
+			residual -= 4 * samples[i - 1] - 6 * samples[i - 2] + 4 * samples[i - 3] - samples[i - 4];
+			break;
+		}
+		m_residuals[i - bestOrder] = residual;
+		foldedSum += FoldResidual(residual);
+	}
+
+	//Estimate the Rice parameter from the mean, then check which neighbour is better
+	auto getRiceBitCount =
+	    [&](uint32 parameter) {
+		    uint64 bitCount = static_cast<uint64>(residualCount) * (parameter + 1);
+		    for(uint32 i = 0; i < residualCount; i++)
+		    {
+			    bitCount += FoldResidual(m_residuals[i]) >> parameter;
+		    }
+		    return bitCount;
+	    };
+	uint32 riceParameter = 0;
+	while((riceParameter < MAX_RICE_PARAMETER) && ((static_cast<uint64>(residualCount) << riceParameter) < foldedSum))
+	{
+		riceParameter++;
+	}
+	uint64 riceBitCount = getRiceBitCount(riceParameter);
+	if(riceParameter != 0)
+	{
+		uint64 lowerBitCount = getRiceBitCount(riceParameter - 1);
+		if(lowerBitCount < riceBitCount)
+		{
+			riceParameter--;
+			riceBitCount = lowerBitCount;
+		}
+	}
+
+	uint64 fixedBitCount = (bestOrder * BITS_PER_SAMPLE) + 10 + riceBitCount;
+	uint64 verbatimBitCount = static_cast<uint64>(frameSize) * BITS_PER_SAMPLE;
+	if(verbatimBitCount <= fixedBitCount)
+	{
+		m_bitWriter.WriteBits(0x02, 8); //Verbatim
+		for(uint32 i = 0; i < frameSize; i++)
+		{
+			m_bitWriter.WriteSignedBits(samples[i], BITS_PER_SAMPLE);
+		}
+		return;
+	}
+
+	m_bitWriter.WriteBits(0x10 | (bestOrder << 1), 8); //Fixed predictor
+	for(uint32 i = 0; i < bestOrder; i++)
+	{
+		m_bitWriter.WriteSignedBits(samples[i], BITS_PER_SAMPLE);
+	}
+	m_bitWriter.WriteBits(0, 2); //Rice coding with 4-bit parameters
+	m_bitWriter.WriteBits(0, 4); //Single partition
+	m_bitWriter.WriteBits(riceParameter, 4);
+	for(uint32 i = 0; i < residualCount; i++)
+	{
+		uint32 folded = FoldResidual(m_residuals[i]);
+		m_bitWriter.WriteUnary(folded >> riceParameter);
+		m_bitWriter.WriteBits(folded, riceParameter);
+	}
+}
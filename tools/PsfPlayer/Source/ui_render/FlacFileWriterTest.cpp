@@ -0,0 +1,329 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "FlacFileWriterTest.h"
+#include "Test.h"
+#include "AudioFileWriter.h"
+#include "StdStreamUtils.h"
+
+#define TEST_SAMPLE_RATE 44100
+
+static fs::path GetTestFilePath()
+{
+	return fs::path("./flactest.flac");
+}
+
+static std::vector<uint8> ReadTestFile()
+{
+	auto stream = Framework::CreateInputStdStream(GetTestFilePath().native());
+	stream.Seek(0, Framework::STREAM_SEEK_END);
+	std::vector<uint8> data(stream.Tell());
+	stream.Seek(0, Framework::STREAM_SEEK_SET);
+	stream.Read(data.data(), data.size());
+	return data;
+}
+
+static std::vector<uint8> EncodeTestFile(const std::vector<int16>& samples)
+{
+	{
+		CFlacFileWriter writer(GetTestFilePath(), TEST_SAMPLE_RATE);
+		//Write in uneven pieces to make sure blocks are assembled correctly
+		uint32 position = 0;
+		uint32 writeSize = 0x122;
+		while(position < samples.size())
+		{
+			uint32 size = std::min<uint32>(writeSize, static_cast<uint32>(samples.size()) - position);
+			writer.Write(samples.data() + position, size);
+			position += size;
+			writeSize = (writeSize * 3) & 0x3FFE;
+		}
+		writer.Finish();
+	}
+	return ReadTestFile();
+}
+
+//Only supports what CFlacFileWriter produces: a single STREAMINFO block, fixed block size
+//frames with independent channels, constant, verbatim and fixed subframes.
+class CFlacDecoder
+{
+public:
+	struct STREAMINFO
+	{
+		uint32 minBlockSize = 0;
+		uint32 maxBlockSize = 0;
+		uint32 sampleRate = 0;
+		uint32 channelCount = 0;
+		uint32 bitsPerSample = 0;
+		uint64 totalFrameCount = 0;
+	};
+
+	CFlacDecoder(const std::vector<uint8>& data)
+	    : m_data(data)
+	{
+	}
+
+	STREAMINFO ReadStreamInfo()
+	{
+		CHECK(ReadBits(32) == 0x664C6143);
+		CHECK(ReadBits(8) == 0x80);
+		CHECK(ReadBits(24) == 34);
+		STREAMINFO streamInfo;
+		streamInfo.minBlockSize = ReadBits(16);
+		streamInfo.maxBlockSize = ReadBits(16);
+		ReadBits(24);
+		ReadBits(24);
+		streamInfo.sampleRate = ReadBits(20);
+		streamInfo.channelCount = ReadBits(3) + 1;
+		streamInfo.bitsPerSample = ReadBits(5) + 1;
+		streamInfo.totalFrameCount = static_cast<uint64>(ReadBits(4)) << 32;
+		streamInfo.totalFrameCount |= ReadBits(32);
+		for(unsigned int i = 0; i < 4; i++)
+		{
+			ReadBits(32);
+		}
+		return streamInfo;
+	}
+
+	//Returns interleaved samples
+	std::vector<int16> ReadFrames(uint32 expectedFrameCount)
+	{
+		std::vector<int16> samples;
+		uint32 frameIndex = 0;
+		while(m_position < m_data.size() * 8)
+		{
+			uint32 frameSize = ReadFrame(frameIndex++);
+			for(uint32 i = 0; i < frameSize; i++)
+			{
+				samples.push_back(static_cast<int16>(m_channelSamples[0][i]));
+				samples.push_back(static_cast<int16>(m_channelSamples[1][i]));
+			}
+		}
+		CHECK(samples.size() == (expectedFrameCount * 2));
+		return samples;
+	}
+
+private:
+	uint32 ReadFrame(uint32 expectedFrameIndex)
+	{
+		size_t frameStart = m_position / 8;
+		CHECK(ReadBits(16) == 0xFFF8);
+		CHECK(ReadBits(4) == 0x7);
+		CHECK(ReadBits(4) == 0x9);
+		CHECK(ReadBits(4) == 0x1);
+		CHECK(ReadBits(3) == 0x4);
+		CHECK(ReadBits(1) == 0);
+		CHECK(ReadUtf8() == expectedFrameIndex);
+		uint32 frameSize = ReadBits(16) + 1;
+		CHECK(ComputeCrc8(m_data.data() + frameStart, (m_position / 8) - frameStart) == ReadBits(8));
+
+		for(auto& channelSamples : m_channelSamples)
+		{
+			channelSamples.resize(frameSize);
+			ReadSubframe(channelSamples.data(), frameSize);
+		}
+
+		m_position = (m_position + 7) & ~7ULL;
+		CHECK(ComputeCrc16(m_data.data() + frameStart, (m_position / 8) - frameStart) == ReadBits(16));
+		return frameSize;
+	}
+
+	void ReadSubframe(int32* samples, uint32 frameSize)
+	{
+		uint32 type = ReadBits(8);
+		if(type == 0x00)
+		{
+			int32 value = ReadSignedBits(16);
+			std::fill(samples, samples + frameSize, value);
+		}
+		else if(type == 0x02)
+		{
+			for(uint32 i = 0; i < frameSize; i++)
+			{
+				samples[i] = ReadSignedBits(16);
+			}
+		}
+		else
+		{
+			CHECK((type & 0xF1) == 0x10);
+			uint32 order = (type >> 1) & 0x07;
+			CHECK(order <= 4);
+			for(uint32 i = 0; i < order; i++)
+			{
+				samples[i] = ReadSignedBits(16);
+			}
+			CHECK(ReadBits(2) == 0);
+			CHECK(ReadBits(4) == 0);
+			uint32 riceParameter = ReadBits(4);
+			for(uint32 i = order; i < frameSize; i++)
+			{
+				uint32 quotient = 0;
+				while(ReadBits(1) == 0)
+				{
+					quotient++;
+				}
+				uint32 folded = (quotient << riceParameter) | ReadBits(riceParameter);
+				int32 residual = static_cast<int32>(folded >> 1) ^ -static_cast<int32>(folded & 1);
+				int32 prediction = 0;
+				switch(order)
+				{
+				case 1:
+					prediction = samples[i - 1];
+					break;
+				case 2:
+					prediction = 2 * samples[i - 1] - samples[i - 2];
+					break;
+				case 3:
+					prediction = 3 * samples[i - 1] - 3 * samples[i - 2] + samples[i - 3];
+					break;
+				case 4:
+					prediction = 4 * samples[i - 1] - 6 * samples[i - 2] + 4 * samples[i - 3] - samples[i - 4];
+					break;
+				}
+				samples[i] = prediction + residual;
+			}
+		}
+	}
+
+	uint32 ReadUtf8()
+	{
+		uint32 leadByte = ReadBits(8);
+		if((leadByte & 0x80) == 0) return leadByte;
+		uint32 byteCount = 0;
+		while(leadByte & (0x80 >> byteCount))
+		{
+			byteCount++;
+		}
+		uint32 value = leadByte & (0x7F >> byteCount);
+		for(uint32 i = 1; i < byteCount; i++)
+		{
+			uint32 byte = ReadBits(8);
+			CHECK((byte & 0xC0) == 0x80);
+			value = (value << 6) | (byte & 0x3F);
+		}
+		return value;
+	}
+
+	uint32 ReadBits(uint32 bitCount)
+	{
+		uint32 value = 0;
+		for(uint32 i = 0; i < bitCount; i++)
+		{
+			CHECK(m_position < m_data.size() * 8);
+			uint32 bit = (m_data[m_position / 8] >> (7 - (m_position % 8))) & 1;
+			value = (value << 1) | bit;
+			m_position++;
+		}
+		return value;
+	}
+
+	int32 ReadSignedBits(uint32 bitCount)
+	{
+		uint32 value = ReadBits(bitCount);
+		uint32 shift = 32 - bitCount;
+		return static_cast<int32>(value << shift) >> shift;
+	}
+
+	static uint8 ComputeCrc8(const uint8* data, size_t size)
+	{
+		uint8 crc = 0;
+		for(size_t i = 0; i < size; i++)
+		{
+			crc ^= data[i];
+			for(unsigned int bit = 0; bit < 8; bit++)
+			{
+				crc = (crc & 0x80) ? static_cast<uint8>((crc << 1) ^ 0x07) : static_cast<uint8>(crc << 1);
+			}
+		}
+		return crc;
+	}
+
+	static uint16 ComputeCrc16(const uint8* data, size_t size)
+	{
+		uint16 crc = 0;
+		for(size_t i = 0; i < size; i++)
+		{
+			crc ^= static_cast<uint16>(data[i] << 8);
+			for(unsigned int bit = 0; bit < 8; bit++)
+			{
+				crc = (crc & 0x8000) ? static_cast<uint16>((crc << 1) ^ 0x8005) : static_cast<uint16>(crc << 1);
+			}
+		}
+		return crc;
+	}
+
+	const std::vector<uint8>& m_data;
+	uint64 m_position = 0;
+	std::vector<int32> m_channelSamples[2];
+};
+
+//Header is rewritten with the amount of frames once the writer is done
+void ExecuteFlacFileWriterHeaderTest()
+{
+	static const uint32 frameCount = 10000;
+	std::vector<int16> samples(frameCount * 2);
+	auto data = EncodeTestFile(samples);
+
+	CFlacDecoder decoder(data);
+	auto streamInfo = decoder.ReadStreamInfo();
+	CHECK(streamInfo.minBlockSize == 4096);
+	CHECK(streamInfo.maxBlockSize == 4096);
+	CHECK(streamInfo.sampleRate == TEST_SAMPLE_RATE);
+	CHECK(streamInfo.channelCount == 2);
+	CHECK(streamInfo.bitsPerSample == 16);
+	CHECK(streamInfo.totalFrameCount == frameCount);
+
+	fs::remove(GetTestFilePath());
+}
+
+//Decoding gives back the exact samples for all subframe types. Enough blocks are written
+//for frame numbers to need more than one byte.
+void ExecuteFlacFileWriterRoundTripTest()
+{
+	static const uint32 blockSize = 4096;
+	static const uint32 frameCount = (blockSize * 160) + 1234;
+	std::vector<int16> samples(frameCount * 2);
+	uint32 noise = 0x12345678;
+	for(uint32 i = 0; i < frameCount; i++)
+	{
+		uint32 block = i / blockSize;
+		int16 left = 0;
+		int16 right = 0;
+		noise = (noise * 1103515245) + 12345;
+		switch(block % 4)
+		{
+		case 0:
+			//Constant
+			left = 0;
+			right = -1234;
+			break;
+		case 1:
+			//Smooth signal, fixed predictors do well
+			left = static_cast<int16>(std::sin(static_cast<double>(i) * 0.01) * 30000.0);
+			right = static_cast<int16>(std::sin(static_cast<double>(i) * 0.003) * 12000.0 + static_cast<double>((noise >> 16) & 0x0F));
+			break;
+		case 2:
+			//White noise, only verbatim works
+			left = static_cast<int16>(noise >> 16);
+			right = static_cast<int16>(noise);
+			break;
+		case 3:
+			//Full scale square wave, largest residuals
+			left = ((i / 7) & 1) ? 32767 : -32768;
+			right = ((i / 3) & 1) ? -32768 : 32767;
+			break;
+		}
+		samples[(i * 2) + 0] = left;
+		samples[(i * 2) + 1] = right;
+	}
+
+	auto data = EncodeTestFile(samples);
+	CHECK(data.size() < (samples.size() * sizeof(int16)));
+
+	CFlacDecoder decoder(data);
+	auto streamInfo = decoder.ReadStreamInfo();
+	CHECK(streamInfo.totalFrameCount == frameCount);
+	auto decodedSamples = decoder.ReadFrames(frameCount);
+	CHECK(decodedSamples == samples);
+
+	fs::remove(GetTestFilePath());
+}
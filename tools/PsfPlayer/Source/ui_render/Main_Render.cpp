@@ -0,0 +1,336 @@
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+#include "filesystem_def.h"
+#include "PsfVm.h"
+#include "PsfLoader.h"
+#include "PsfArchive.h"
+#include "PsfTags.h"
+#include "Playlist.h"
+#include "ThreadPool.h"
+#include "RenderOutput.h"
+
+//Renders PSF files to audio files without any audio device. Every worker owns its own VM
+//and emulation isn't throttled, so the realtime factor of each track is also reported.
+
+#define DEFAULT_LENGTH 180.0
+#define DEFAULT_FADE 10.0
+
+enum OUTPUT_FORMAT
+{
+	OUTPUT_FORMAT_WAV,
+	OUTPUT_FORMAT_FLAC,
+};
+
+struct RENDER_OPTIONS
+{
+	fs::path outputPath;
+	OUTPUT_FORMAT format = OUTPUT_FORMAT_WAV;
+	unsigned int jobCount = std::thread::hardware_concurrency();
+	double defaultLength = DEFAULT_LENGTH;
+	double defaultFade = DEFAULT_FADE;
+};
+
+struct RENDER_JOB
+{
+	std::wstring path;
+	fs::path archivePath;
+	fs::path outputPath;
+	std::string name;
+};
+typedef std::vector<RENDER_JOB> RenderJobList;
+
+class CJobListBuilder
+{
+public:
+	CJobListBuilder(const RENDER_OPTIONS& options)
+	    : m_options(options)
+	{
+	}
+
+	void AddInput(const fs::path& inputPath)
+	{
+		auto extension = inputPath.extension().string();
+		if(extension == ".psfpl")
+		{
+			CPlaylist playlist;
+			playlist.Read(inputPath);
+			for(unsigned int i = 0; i < playlist.GetItemCount(); i++)
+			{
+				const auto& item = playlist.GetItem(i);
+				fs::path archivePath;
+				if(item.archiveId != 0)
+				{
+					archivePath = playlist.GetArchive(item.archiveId);
+				}
+				AddJob(item.path, archivePath);
+			}
+		}
+		else if((extension == ".zip") || (extension == ".rar"))
+		{
+			auto archive = CPsfArchive::CreateFromPath(inputPath);
+			for(const auto& fileInfo : archive->GetFiles())
+			{
+				auto archiveItemExtension = fs::path(fileInfo.name).extension().string();
+				if(archiveItemExtension.empty()) continue;
+				if(!CPlaylist::IsLoadableExtension(archiveItemExtension.c_str() + 1)) continue;
+				AddJob(CPsfPathToken::WidenString(fileInfo.name), inputPath);
+			}
+		}
+		else
+		{
+			AddJob(inputPath.wstring(), fs::path());
+		}
+	}
+
+	const RenderJobList& GetJobs() const
+	{
+		return m_jobs;
+	}
+
+private:
+	void AddJob(const std::wstring& path, const fs::path& archivePath)
+	{
+		const char* outputExtension = (m_options.format == OUTPUT_FORMAT_FLAC) ? ".flac" : ".wav";
+		auto stem = fs::path(path).stem().string();
+		auto outputName = stem + outputExtension;
+		for(unsigned int suffix = 2; m_outputNames.count(outputName) != 0; suffix++)
+		{
+			outputName = stem + " (" + std::to_string(suffix) + ")" + outputExtension;
+		}
+		m_outputNames.insert(outputName);
+
+		RENDER_JOB job;
+		job.path = path;
+		job.archivePath = archivePath;
+		job.outputPath = m_options.outputPath / outputName;
+		job.name = fs::path(path).filename().string();
+		m_jobs.push_back(job);
+	}
+
+	const RENDER_OPTIONS& m_options;
+	RenderJobList m_jobs;
+	std::set<std::string> m_outputNames;
+};
+
+static AudioFileWriterPtr CreateWriter(const RENDER_OPTIONS& options, const fs::path& outputPath)
+{
+	switch(options.format)
+	{
+	case OUTPUT_FORMAT_FLAC:
+		return std::make_unique<CFlacFileWriter>(outputPath, CRenderOutput::SAMPLE_RATE);
+	default:
+	case OUTPUT_FORMAT_WAV:
+		return std::make_unique<CWavFileWriter>(outputPath, CRenderOutput::SAMPLE_RATE);
+	}
+}
+
+static double GetTimeTag(const CPsfTags& tags, const char* name, double defaultValue)
+{
+	if(!tags.HasTag(name)) return defaultValue;
+	double value = CPsfTags::ConvertTimeString(tags.GetTagValue(name).c_str());
+	return (value > 0) ? value : defaultValue;
+}
+
+//Returns the amount of seconds that were rendered
+static double RenderJob(const RENDER_OPTIONS& options, const RENDER_JOB& job)
+{
+	CPsfVm virtualMachine;
+
+	CPsfBase::TagMap tagMap;
+	CPsfLoader::LoadPsf(virtualMachine, job.path, job.archivePath, &tagMap);
+	CPsfTags tags(tagMap);
+
+	double length = GetTimeTag(tags, "length", options.defaultLength);
+	double fade = tags.HasTag("fade") ? CPsfTags::ConvertTimeString(tags.GetTagValue("fade").c_str()) : options.defaultFade;
+	if(tags.HasTag("volume"))
+	{
+		virtualMachine.SetVolumeAdjust(stof(tags.GetTagValue("volume")));
+	}
+
+	auto lengthFrameCount = static_cast<uint64>(length * CRenderOutput::SAMPLE_RATE);
+	auto fadeFrameCount = static_cast<uint64>(fade * CRenderOutput::SAMPLE_RATE);
+	CRenderOutput output(CreateWriter(options, job.outputPath), lengthFrameCount, fadeFrameCount);
+
+	//Sound handler is owned by the VM, but output outlives it since the VM is paused before leaving
+	virtualMachine.SetSpuHandler([&output]() { return new CSH_RenderOutput(output); });
+	virtualMachine.Resume();
+	try
+	{
+		output.WaitForCompletion();
+	}
+	catch(...)
+	{
+		//Don't leave an incomplete file behind
+		virtualMachine.Pause();
+		output.Abort();
+		std::error_code errorCode;
+		fs::remove(job.outputPath, errorCode);
+		throw;
+	}
+	virtualMachine.Pause();
+	output.Finish();
+
+	return static_cast<double>(output.GetRenderedFrameCount()) / static_cast<double>(CRenderOutput::SAMPLE_RATE);
+}
+
+static bool ParseTimeOption(const char* value, double& result)
+{
+	result = CPsfTags::ConvertTimeString(CPsfPathToken::WidenString(value).c_str());
+	return result >= 0;
+}
+
+static void PrintUsage()
+{
+	printf("PsfRender usage:\r\n");
+	printf("\tPsfRender [options] [InputFile...]\r\n");
+	printf("Input files can be PSF files, archives (.zip, .rar) or playlists (.psfpl).\r\n");
+	printf("Options:\r\n");
+	printf("\t--output [Path]     Output directory (default: current directory)\r\n");
+	printf("\t--format [wav|flac] Output format (default: wav)\r\n");
+	printf("\t--jobs [Count]      Amount of tracks rendered simultaneously (default: CPU count)\r\n");
+	printf("\t--length [Time]     Length used when track has no length tag (default: 3:00)\r\n");
+	printf("\t--fade [Time]       Fade used when track has no fade tag (default: 10)\r\n");
+}
+
+int main(int argc, char** argv)
+{
+	RENDER_OPTIONS options;
+	std::vector<fs::path> inputPaths;
+
+	for(int i = 1; i < argc; i++)
+	{
+		const char* arg = argv[i];
+		bool hasValue = (i + 1) < argc;
+		if(!strcmp(arg, "--output") && hasValue)
+		{
+			options.outputPath = argv[++i];
+		}
+		else if(!strcmp(arg, "--format") && hasValue)
+		{
+			const char* format = argv[++i];
+			if(!strcmp(format, "wav"))
+			{
+				options.format = OUTPUT_FORMAT_WAV;
+			}
+			else if(!strcmp(format, "flac"))
+			{
+				options.format = OUTPUT_FORMAT_FLAC;
+			}
+			else
+			{
+				PrintUsage();
+				return -1;
+			}
+		}
+		else if(!strcmp(arg, "--jobs") && hasValue)
+		{
+			options.jobCount = std::max(atoi(argv[++i]), 1);
+		}
+		else if(!strcmp(arg, "--length") && hasValue)
+		{
+			if(!ParseTimeOption(argv[++i], options.defaultLength))
+			{
+				PrintUsage();
+				return -1;
+			}
+		}
+		else if(!strcmp(arg, "--fade") && hasValue)
+		{
+			if(!ParseTimeOption(argv[++i], options.defaultFade))
+			{
+				PrintUsage();
+				return -1;
+			}
+		}
+		else if(!strncmp(arg, "--", 2))
+		{
+			PrintUsage();
+			return -1;
+		}
+		else
+		{
+			inputPaths.push_back(arg);
+		}
+	}
+
+	if(inputPaths.empty())
+	{
+		PrintUsage();
+		return -1;
+	}
+
+	CJobListBuilder jobListBuilder(options);
+	try
+	{
+		if(!options.outputPath.empty())
+		{
+			fs::create_directories(options.outputPath);
+		}
+		for(const auto& inputPath : inputPaths)
+		{
+			jobListBuilder.AddInput(inputPath);
+		}
+	}
+	catch(const std::exception& exception)
+	{
+		printf("Failed to build track list: %s\r\n", exception.what());
+		return -1;
+	}
+
+	const auto& jobs = jobListBuilder.GetJobs();
+	if(jobs.empty())
+	{
+		printf("No track to render.\r\n");
+		return -1;
+	}
+
+	unsigned int jobCount = std::max<unsigned int>(std::min<unsigned int>(options.jobCount, jobs.size()), 1);
+	std::mutex outputMutex;
+	std::atomic<unsigned int> failedCount(0);
+	double totalRenderedTime = 0;
+
+	auto startTime = std::chrono::steady_clock::now();
+	{
+		Framework::CThreadPool threadPool(jobCount);
+		for(const auto& job : jobs)
+		{
+			threadPool.Enqueue(
+			    [&]() {
+				    try
+				    {
+					    auto jobStartTime = std::chrono::steady_clock::now();
+					    double renderedTime = RenderJob(options, job);
+					    auto jobEndTime = std::chrono::steady_clock::now();
+					    double elapsedTime = std::chrono::duration<double>(jobEndTime - jobStartTime).count();
+
+					    std::lock_guard<std::mutex> outputLock(outputMutex);
+					    totalRenderedTime += renderedTime;
+					    printf("%s: %.1fs rendered in %.2fs (%.1fx realtime).\r\n",
+					           job.name.c_str(), renderedTime, elapsedTime, renderedTime / elapsedTime);
+					    fflush(stdout);
+				    }
+				    catch(const std::exception& exception)
+				    {
+					    std::lock_guard<std::mutex> outputLock(outputMutex);
+					    failedCount++;
+					    printf("Failed to render '%s', reason: '%s'.\r\n", job.name.c_str(), exception.what());
+					    fflush(stdout);
+				    }
+			    });
+		}
+	}
+	auto endTime = std::chrono::steady_clock::now();
+	double elapsedTime = std::chrono::duration<double>(endTime - startTime).count();
+
+	printf("Rendered %d of %d tracks (%.1fs of audio) in %.2fs using %d jobs (%.1fx realtime).\r\n",
+	       static_cast<int>(jobs.size() - failedCount), static_cast<int>(jobs.size()), totalRenderedTime,
+	       elapsedTime, jobCount, (elapsedTime > 0) ? (totalRenderedTime / elapsedTime) : 0);
+
+	return (failedCount == 0) ? 0 : -1;
+}
@@ -0,0 +1,8 @@
+#include "FlacFileWriterTest.h"
+
+int main(int argc, const char** argv)
+{
+	ExecuteFlacFileWriterHeaderTest();
+	ExecuteFlacFileWriterRoundTripTest();
+	return 0;
+}
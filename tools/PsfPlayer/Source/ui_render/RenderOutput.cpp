@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include "RenderOutput.h"
+
+CRenderOutput::CRenderOutput(AudioFileWriterPtr writer, uint64 lengthFrameCount, uint64 fadeFrameCount)
+    : m_writer(std::move(writer))
+    , m_fadeStartFrame(lengthFrameCount)
+    , m_totalFrameCount(lengthFrameCount + fadeFrameCount)
+{
+}
+
+void CRenderOutput::Write(const int16* samples, uint32 sampleCount, uint32 sampleRate)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	if((m_renderedFrameCount >= m_totalFrameCount) || !m_error.empty()) return;
+
+	//Resampling isn't supported, the file's sample rate is fixed when it's created
+	if(sampleRate != SAMPLE_RATE)
+	{
+		m_error = "Unsupported sample rate (" + std::to_string(sampleRate) + ").";
+		m_completeCondition.notify_all();
+		return;
+	}
+
+	uint64 frameCount = sampleCount / CAudioFileWriter::CHANNEL_COUNT;
+	frameCount = std::min<uint64>(frameCount, m_totalFrameCount - m_renderedFrameCount);
+
+	uint64 endFrame = m_renderedFrameCount + frameCount;
+	if(endFrame <= m_fadeStartFrame)
+	{
+		m_writer->Write(samples, static_cast<uint32>(frameCount * CAudioFileWriter::CHANNEL_COUNT));
+	}
+	else
+	{
+		uint64 fadeLength = m_totalFrameCount - m_fadeStartFrame;
+		m_fadeBuffer.resize(frameCount * CAudioFileWriter::CHANNEL_COUNT);
+		for(uint64 i = 0; i < frameCount; i++)
+		{
+			uint64 frame = m_renderedFrameCount + i;
+			float volume = 1.0f;
+			if(frame >= m_fadeStartFrame)
+			{
+				volume = static_cast<float>(m_totalFrameCount - frame) / static_cast<float>(fadeLength);
+			}
+			for(uint32 channel = 0; channel < CAudioFileWriter::CHANNEL_COUNT; channel++)
+			{
+				uint64 index = (i * CAudioFileWriter::CHANNEL_COUNT) + channel;
+				m_fadeBuffer[index] = static_cast<int16>(static_cast<float>(samples[index]) * volume);
+			}
+		}
+		m_writer->Write(m_fadeBuffer.data(), static_cast<uint32>(m_fadeBuffer.size()));
+	}
+
+	m_renderedFrameCount = endFrame;
+	if(m_renderedFrameCount == m_totalFrameCount)
+	{
+		m_completeCondition.notify_all();
+	}
+}
+
+void CRenderOutput::WaitForCompletion()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	auto isDone = [this]() { return (m_renderedFrameCount == m_totalFrameCount) || !m_error.empty(); };
+	uint64 lastRenderedFrameCount = m_renderedFrameCount;
+	while(!m_completeCondition.wait_for(lock, std::chrono::seconds(STALL_TIMEOUT_SECONDS), isDone))
+	{
+		//Emulation isn't throttled, not getting any samples for that long means the VM is stuck
+		if(m_renderedFrameCount == lastRenderedFrameCount)
+		{
+			throw std::runtime_error("Emulation stopped producing audio.");
+		}
+		lastRenderedFrameCount = m_renderedFrameCount;
+	}
+	if(!m_error.empty())
+	{
+		throw std::runtime_error(m_error);
+	}
+}
+
+bool CRenderOutput::IsComplete()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	return m_renderedFrameCount == m_totalFrameCount;
+}
+
+uint64 CRenderOutput::GetRenderedFrameCount()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	return m_renderedFrameCount;
+}
+
+void CRenderOutput::Finish()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_writer->Finish();
+}
+
+void CRenderOutput::Abort()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_writer.reset();
+}
+
+CSH_RenderOutput::CSH_RenderOutput(CRenderOutput& output)
+    : m_output(output)
+{
+}
+
+void CSH_RenderOutput::Reset()
+{
+}
+
+void CSH_RenderOutput::Write(int16* samples, unsigned int sampleCount, unsigned int sampleRate)
+{
+	m_output.Write(samples, sampleCount, sampleRate);
+}
+
+bool CSH_RenderOutput::HasFreeBuffers()
+{
+	return true;
+}
+
+void CSH_RenderOutput::RecycleBuffers()
+{
+}
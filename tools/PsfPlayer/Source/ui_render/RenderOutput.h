@@ -0,0 +1,63 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include "AudioFileWriter.h"
+#include "SoundHandler.h"
+
+//Receives samples produced by the VM thread, applies the end of track fade out and
+//forwards everything to a file writer until the requested length has been reached.
+class CRenderOutput
+{
+public:
+	enum
+	{
+		SAMPLE_RATE = 44100,
+	};
+
+	CRenderOutput(AudioFileWriterPtr, uint64 lengthFrameCount, uint64 fadeFrameCount);
+
+	//Called from the VM thread, sample count is the amount of int16 values
+	void Write(const int16*, uint32 sampleCount, uint32 sampleRate);
+
+	//Throws if the samples can't be used or if the VM stops producing them
+	void WaitForCompletion();
+	bool IsComplete();
+	uint64 GetRenderedFrameCount();
+
+	//Must be called once the VM has been paused
+	void Finish();
+	//Closes the file without completing it, must also be called once the VM has been paused
+	void Abort();
+
+private:
+	enum
+	{
+		STALL_TIMEOUT_SECONDS = 10,
+	};
+
+	AudioFileWriterPtr m_writer;
+	uint64 m_fadeStartFrame = 0;
+	uint64 m_totalFrameCount = 0;
+	uint64 m_renderedFrameCount = 0;
+	std::vector<int16> m_fadeBuffer;
+	std::string m_error;
+	std::mutex m_mutex;
+	std::condition_variable m_completeCondition;
+};
+
+//Never blocks the VM, emulation runs as fast as the host allows
+class CSH_RenderOutput : public CSoundHandler
+{
+public:
+	CSH_RenderOutput(CRenderOutput&);
+
+	void Reset() override;
+	void Write(int16*, unsigned int, unsigned int) override;
+	bool HasFreeBuffers() override;
+	void RecycleBuffers() override;
+
+private:
+	CRenderOutput& m_output;
+};
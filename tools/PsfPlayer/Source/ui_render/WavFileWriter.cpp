@@ -0,0 +1,42 @@
+#include "AudioFileWriter.h"
+#include "StdStreamUtils.h"
+
+#define WAV_HEADER_SIZE 44
+
+CWavFileWriter::CWavFileWriter(const fs::path& path, uint32 sampleRate)
+    : m_stream(Framework::CreateOutputStdStream(path.native()))
+    , m_sampleRate(sampleRate)
+{
+	WriteHeader();
+}
+
+void CWavFileWriter::Write(const int16* samples, uint32 sampleCount)
+{
+	uint32 size = sampleCount * sizeof(int16);
+	m_stream.Write(samples, size);
+	m_dataSize += size;
+}
+
+void CWavFileWriter::Finish()
+{
+	m_stream.Seek(0, Framework::STREAM_SEEK_SET);
+	WriteHeader();
+}
+
+void CWavFileWriter::WriteHeader()
+{
+	uint32 blockAlign = CHANNEL_COUNT * (BITS_PER_SAMPLE / 8);
+	m_stream.Write("RIFF", 4);
+	m_stream.Write32(WAV_HEADER_SIZE - 8 + m_dataSize);
+	m_stream.Write("WAVE", 4);
+	m_stream.Write("fmt ", 4);
+	m_stream.Write32(16);
+	m_stream.Write16(1); //PCM
+	m_stream.Write16(CHANNEL_COUNT);
+	m_stream.Write32(m_sampleRate);
+	m_stream.Write32(m_sampleRate * blockAlign);
+	m_stream.Write16(blockAlign);
+	m_stream.Write16(BITS_PER_SAMPLE);
+	m_stream.Write("data", 4);
+	m_stream.Write32(m_dataSize);
+}
@@ -0,0 +1,41 @@
+#include <stdio.h>
+#include <memory>
+#include <vector>
+#include "StdStream.h"
+#include "StdStreamUtils.h"
+#include "filesystem_def.h"
+#include "states/StateDeltaTracker.h"
+
+//Rebuilds a complete state from a chain of incremental states (as saved by CPS2VM::SaveIncrementalState).
+//Usage: StateMaterializer <output state path> <base state path> [delta state paths...]
+
+int main(int argc, const char** argv)
+{
+	if(argc < 3)
+	{
+		printf("Usage: StateMaterializer <output state path> <base state path> [delta state paths...]\r\n");
+		return 1;
+	}
+
+	try
+	{
+		std::vector<std::unique_ptr<Framework::CStdStream>> inputStreams;
+		CStateDeltaTracker::StreamList chain;
+		for(int i = 2; i < argc; i++)
+		{
+			auto inputStream = std::make_unique<Framework::CStdStream>(Framework::CreateInputStdStream(fs::path(argv[i]).native()));
+			chain.push_back(inputStream.get());
+			inputStreams.push_back(std::move(inputStream));
+		}
+
+		auto outputStream = Framework::CreateOutputStdStream(fs::path(argv[1]).native());
+		CStateDeltaTracker::MaterializeChain(chain, outputStream);
+	}
+	catch(const std::exception& exception)
+	{
+		printf("Error: %s\r\n", exception.what());
+		return 1;
+	}
+
+	return 0;
+}
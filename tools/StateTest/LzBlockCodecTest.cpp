@@ -0,0 +1,74 @@
+#include <algorithm>
+#include <vector>
+#include "LzBlockCodecTest.h"
+#include "LzBlockCodec.h"
+#include "Test.h"
+
+static void CheckRoundTrip(const std::vector<uint8>& input)
+{
+	std::vector<uint8> compressed(LzBlockCodec::GetMaxCompressedSize(input.size()));
+	size_t compressedSize = LzBlockCodec::Compress(input.data(), input.size(), compressed.data(), compressed.size());
+	CHECK(compressedSize != 0);
+	CHECK(compressedSize <= compressed.size());
+
+	std::vector<uint8> output(input.size() + 1, 0xCC);
+	CHECK(LzBlockCodec::Decompress(compressed.data(), compressedSize, output.data(), input.size()));
+	CHECK(std::equal(input.begin(), input.end(), output.begin()));
+	//Nothing must be written past the expected size
+	CHECK(output[input.size()] == 0xCC);
+
+	//Sizes that don't match the original data are rejected
+	CHECK(!LzBlockCodec::Decompress(compressed.data(), compressedSize, output.data(), input.size() + 1));
+	if(!input.empty())
+	{
+		CHECK(!LzBlockCodec::Decompress(compressed.data(), compressedSize, output.data(), input.size() - 1));
+	}
+}
+
+void ExecuteLzBlockCodecTest()
+{
+	//Tiny inputs are stored as literals only
+	CheckRoundTrip(std::vector<uint8>(1, 0x55));
+	CheckRoundTrip(std::vector<uint8>(7, 0x55));
+
+	//Long runs use extra match length bytes
+	CheckRoundTrip(std::vector<uint8>(0x1000, 0));
+
+	//Repeating patterns
+	{
+		std::vector<uint8> input(0x1000);
+		for(size_t i = 0; i < input.size(); i++)
+		{
+			input[i] = static_cast<uint8>(i % 13);
+		}
+		CheckRoundTrip(input);
+	}
+
+	//Incompressible data uses extra literal length bytes and needs the worst case output size
+	std::vector<uint8> noise(0x1000);
+	{
+		uint32 state = 0x12345678;
+		for(auto& value : noise)
+		{
+			state = (state * 1103515245) + 12345;
+			value = static_cast<uint8>(state >> 24);
+		}
+		CheckRoundTrip(noise);
+	}
+
+	//Output that doesn't fit is reported as a failure
+	{
+		std::vector<uint8> compressed(noise.size() / 2);
+		CHECK(LzBlockCodec::Compress(noise.data(), noise.size(), compressed.data(), compressed.size()) == 0);
+	}
+
+	//Truncated streams are rejected
+	{
+		std::vector<uint8> input(0x1000, 0xAA);
+		std::vector<uint8> compressed(LzBlockCodec::GetMaxCompressedSize(input.size()));
+		size_t compressedSize = LzBlockCodec::Compress(input.data(), input.size(), compressed.data(), compressed.size());
+		CHECK(compressedSize > 1);
+		std::vector<uint8> output(input.size());
+		CHECK(!LzBlockCodec::Decompress(compressed.data(), compressedSize - 1, output.data(), output.size()));
+	}
+}
@@ -0,0 +1,16 @@
+#include "LzBlockCodecTest.h"
+#include "ParallelStateWriterTest.h"
+#include "RewindBufferTest.h"
+#include "StateDeltaTrackerTest.h"
+
+int main(int argc, const char** argv)
+{
+	ExecuteLzBlockCodecTest();
+	ExecuteParallelStateWriterTest();
+	ExecuteRewindBufferTest();
+	ExecuteRewindBufferTrackedTest();
+	ExecuteStateDeltaTrackerTest();
+	ExecuteStateDeltaTrackerTrackedTest();
+	ExecuteStateDeltaChainValidationTest();
+	return 0;
+}
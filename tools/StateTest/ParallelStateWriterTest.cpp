@@ -0,0 +1,70 @@
+#include <vector>
+#include "ParallelStateWriterTest.h"
+#include "Test.h"
+#include "MemStream.h"
+#include "ThreadPool.h"
+#include "states/ParallelStateReader.h"
+#include "states/ParallelStateWriter.h"
+#include "states/RegisterStateFile.h"
+#include "states/StateArchiveFormat.h"
+#include "zip/ZipArchiveReader.h"
+#include "zip/ZipArchiveWriter.h"
+
+#define REGISTERS_FILE_NAME "regs.xml"
+#define REGISTER_NAME "Value"
+#define MEMORY_FILE_NAME "ram"
+
+//Archives written in parallel must be readable by both the regular and the parallel readers
+void ExecuteParallelStateWriterTest()
+{
+	Framework::CThreadPool threadPool(2);
+
+	//Large enough to be split in several chunks, last chunk being partial
+	std::vector<uint8> memory((StateArchiveFormat::CHUNK_SIZE * 2) + 0x1234);
+	uint32 state = 0x12345678;
+	for(size_t i = 0; i < memory.size(); i++)
+	{
+		state = (state * 1103515245) + 12345;
+		//Mix compressible and incompressible parts
+		memory[i] = ((i / 0x1000) & 1) ? static_cast<uint8>(state >> 24) : static_cast<uint8>(i);
+	}
+
+	Framework::CMemStream stateStream;
+	{
+		CParallelStateWriter stateWriter(threadPool);
+		Framework::CZipArchiveWriter archive;
+
+		auto registerFile = new CRegisterStateFile(REGISTERS_FILE_NAME);
+		registerFile->SetRegister32(REGISTER_NAME, 0xCAFEBABE);
+		archive.InsertFile(registerFile);
+		CMemoryStateTracker::SaveMemory(archive, &stateWriter, MEMORY_FILE_NAME, memory.data(), memory.size());
+
+		stateWriter.CaptureArchive(archive);
+		stateWriter.Write(stateStream);
+	}
+
+	{
+		stateStream.Seek(0, Framework::STREAM_SEEK_SET);
+		Framework::CZipArchiveReader archive(stateStream);
+
+		CRegisterStateFile registerFile(*archive.BeginReadFile(REGISTERS_FILE_NAME));
+		CHECK(registerFile.GetRegister32(REGISTER_NAME) == 0xCAFEBABE);
+
+		std::vector<uint8> output(memory.size());
+		CMemoryStateTracker::LoadMemory(archive, nullptr, MEMORY_FILE_NAME, output.data(), output.size());
+		CHECK(output == memory);
+	}
+
+	{
+		stateStream.Seek(0, Framework::STREAM_SEEK_SET);
+		CParallelStateReader stateReader(stateStream, threadPool);
+		Framework::CZipArchiveReader archive(stateStream);
+
+		CRegisterStateFile registerFile(*archive.BeginReadFile(REGISTERS_FILE_NAME));
+		CHECK(registerFile.GetRegister32(REGISTER_NAME) == 0xCAFEBABE);
+
+		std::vector<uint8> output(memory.size());
+		CMemoryStateTracker::LoadMemory(archive, &stateReader, MEMORY_FILE_NAME, output.data(), output.size());
+		CHECK(output == memory);
+	}
+}
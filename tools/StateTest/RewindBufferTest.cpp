@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <vector>
+#include "RewindBufferTest.h"
+#include "RewindBuffer.h"
+#include "Test.h"
+#include "zip/ZipArchiveReader.h"
+#include "zip/ZipArchiveWriter.h"
+
+#define REGION_NAME "ram"
+
+enum
+{
+	PAGE_SIZE = CMemoryStateTracker::DEFAULT_PAGE_SIZE,
+	PAGE_COUNT = 0x10,
+	MEMORY_SIZE = PAGE_SIZE * PAGE_COUNT,
+};
+
+static void Capture(CRewindBuffer& rewindBuffer, uint32 frame, const std::vector<uint8>& memory)
+{
+	Framework::CZipArchiveWriter archive;
+	rewindBuffer.BeginCapture(frame);
+	rewindBuffer.InsertMemoryFile(archive, REGION_NAME, memory.data(), memory.size());
+	rewindBuffer.EndCapture(archive);
+}
+
+static void Restore(CRewindBuffer& rewindBuffer, unsigned int index, std::vector<uint8>& memory)
+{
+	auto stream = rewindBuffer.BeginRestore(index);
+	Framework::CZipArchiveReader archive(*stream);
+	rewindBuffer.ReadMemoryFile(archive, REGION_NAME, memory.data(), memory.size());
+	rewindBuffer.EndRestore();
+}
+
+static void FillPage(std::vector<uint8>& memory, uint32 pageIndex, uint8 value)
+{
+	std::fill(memory.begin() + (pageIndex * PAGE_SIZE), memory.begin() + ((pageIndex + 1) * PAGE_SIZE), value);
+}
+
+//Memory without dirty page tracking is compared against entries when restoring
+void ExecuteRewindBufferTest()
+{
+	CRewindBuffer rewindBuffer;
+	std::vector<uint8> memory(MEMORY_SIZE);
+	for(uint32 i = 0; i < PAGE_COUNT; i++)
+	{
+		FillPage(memory, i, static_cast<uint8>(i));
+	}
+	auto memory0 = memory;
+	Capture(rewindBuffer, 0, memory);
+
+	FillPage(memory, 2, 0xAA);
+	FillPage(memory, 7, 0xBB);
+	auto memory1 = memory;
+	Capture(rewindBuffer, 1, memory);
+
+	CHECK(rewindBuffer.GetEntryCount() == 2);
+	CHECK(rewindBuffer.GetEntryFrame(0) == 0);
+	CHECK(rewindBuffer.GetEntryFrame(1) == 1);
+
+	//Unchanged pages are shared between entries
+	CHECK(rewindBuffer.GetStats().pageCount == (PAGE_COUNT + 2));
+
+	FillPage(memory, 2, 0xCC);
+	FillPage(memory, 9, 0xDD);
+
+	Restore(rewindBuffer, 0, memory);
+	CHECK(memory == memory0);
+	CHECK(rewindBuffer.GetStats().lastRestorePageCount == 3);
+
+	Restore(rewindBuffer, 1, memory);
+	CHECK(memory == memory1);
+	CHECK(rewindBuffer.GetStats().lastRestorePageCount == 2);
+
+	//Restoring the current entry again doesn't write anything
+	Restore(rewindBuffer, 1, memory);
+	CHECK(memory == memory1);
+	CHECK(rewindBuffer.GetStats().lastRestorePageCount == 0);
+}
+
+//Pages that were written to but hold the same data as before must still be restored properly
+void ExecuteRewindBufferTrackedTest()
+{
+	CRewindBuffer rewindBuffer;
+	std::vector<uint8> memory(MEMORY_SIZE, 0);
+	CMemoryStateTracker::PageBitmap dirtyPages(PAGE_COUNT, 1);
+
+	rewindBuffer.SetDirtyPageQuery(memory.data(), PAGE_SIZE,
+	                               [&](CMemoryStateTracker::PageBitmap& result) {
+		                               result = dirtyPages;
+		                               std::fill(dirtyPages.begin(), dirtyPages.end(), 0);
+		                               return true;
+	                               });
+
+	auto writePage = [&](uint32 pageIndex, uint8 value) {
+		FillPage(memory, pageIndex, value);
+		dirtyPages[pageIndex] = 1;
+	};
+
+	auto memory0 = memory;
+	Capture(rewindBuffer, 0, memory);
+
+	writePage(1, 0x11);
+	//Same content as before, page will be shared with the previous entry
+	writePage(3, 0x00);
+	auto memory1 = memory;
+	Capture(rewindBuffer, 1, memory);
+	CHECK(rewindBuffer.GetStats().pageCount == (PAGE_COUNT + 1));
+
+	writePage(1, 0x22);
+	writePage(5, 0x55);
+
+	Restore(rewindBuffer, 0, memory);
+	CHECK(memory == memory0);
+
+	//Page 1 differs between entries, other pages weren't touched since the restore
+	Restore(rewindBuffer, 1, memory);
+	CHECK(memory == memory1);
+	CHECK(rewindBuffer.GetStats().lastRestorePageCount == 1);
+}
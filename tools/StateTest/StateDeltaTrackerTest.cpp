@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include "StateDeltaTrackerTest.h"
+#include "Test.h"
+#include "MemStream.h"
+#include "states/RegisterStateFile.h"
+#include "states/StateDeltaTracker.h"
+#include "zip/ZipArchiveReader.h"
+#include "zip/ZipArchiveWriter.h"
+
+#define REGISTERS_FILE_NAME "regs.xml"
+#define REGISTER_NAME "Value"
+#define REGION_NAME "ram"
+#define REGION_DELTA_NAME "ram.delta"
+
+enum
+{
+	PAGE_SIZE = CMemoryStateTracker::DEFAULT_PAGE_SIZE,
+	PAGE_COUNT = 0x10,
+	MEMORY_SIZE = PAGE_SIZE * PAGE_COUNT,
+	//Header followed by one byte per page
+	DELTA_HEADER_SIZE = 0x10 + PAGE_COUNT,
+};
+
+typedef std::unique_ptr<Framework::CMemStream> StateStreamPtr;
+typedef std::vector<StateStreamPtr> StateStreamList;
+
+static StateStreamPtr SaveCheckpoint(CStateDeltaTracker& tracker, const std::vector<uint8>& memory, uint32 value)
+{
+	auto stream = std::make_unique<Framework::CMemStream>();
+	Framework::CZipArchiveWriter archive;
+	tracker.BeginCheckpoint(archive);
+	auto registerFile = new CRegisterStateFile(REGISTERS_FILE_NAME);
+	registerFile->SetRegister32(REGISTER_NAME, value);
+	archive.InsertFile(registerFile);
+	CMemoryStateTracker::SaveMemory(archive, &tracker, REGION_NAME, memory.data(), memory.size());
+	archive.Write(*stream);
+	return stream;
+}
+
+//Returns the size of a file in a state, 0 if it's not present
+static uint64 GetStateFileSize(Framework::CMemStream& stream, const char* fileName)
+{
+	stream.Seek(0, Framework::STREAM_SEEK_SET);
+	Framework::CZipArchiveReader archive(stream);
+	auto fileHeader = archive.GetFileHeader(fileName);
+	return fileHeader ? fileHeader->uncompressedSize : 0;
+}
+
+static StateStreamPtr MaterializeChain(const std::vector<Framework::CMemStream*>& chain)
+{
+	CStateDeltaTracker::StreamList streams;
+	for(auto stream : chain)
+	{
+		stream->Seek(0, Framework::STREAM_SEEK_SET);
+		streams.push_back(stream);
+	}
+	auto output = std::make_unique<Framework::CMemStream>();
+	CStateDeltaTracker::MaterializeChain(streams, *output);
+	output->Seek(0, Framework::STREAM_SEEK_SET);
+	return output;
+}
+
+static bool IsChainRejected(const std::vector<Framework::CMemStream*>& chain)
+{
+	try
+	{
+		MaterializeChain(chain);
+	}
+	catch(const std::exception&)
+	{
+		return true;
+	}
+	return false;
+}
+
+static void CheckState(Framework::CMemStream& stream, const std::vector<uint8>& memory, uint32 value)
+{
+	Framework::CZipArchiveReader archive(stream);
+	CRegisterStateFile registerFile(*archive.BeginReadFile(REGISTERS_FILE_NAME));
+	CHECK(registerFile.GetRegister32(REGISTER_NAME) == value);
+
+	std::vector<uint8> output(memory.size());
+	CMemoryStateTracker::LoadMemory(archive, nullptr, REGION_NAME, output.data(), output.size());
+	CHECK(output == memory);
+}
+
+static void FillPage(std::vector<uint8>& memory, uint32 pageIndex, uint8 value)
+{
+	std::fill(memory.begin() + (pageIndex * PAGE_SIZE), memory.begin() + ((pageIndex + 1) * PAGE_SIZE), value);
+}
+
+//Memory without dirty page tracking is compared against the hashes of the previous checkpoint
+void ExecuteStateDeltaTrackerTest()
+{
+	CStateDeltaTracker tracker;
+	std::vector<uint8> memory(MEMORY_SIZE);
+	for(uint32 i = 0; i < PAGE_COUNT; i++)
+	{
+		FillPage(memory, i, static_cast<uint8>(i));
+	}
+
+	auto memory0 = memory;
+	auto state0 = SaveCheckpoint(tracker, memory, 0);
+	CHECK(tracker.GetSequence() == 0);
+	CHECK(GetStateFileSize(*state0, REGION_NAME) == MEMORY_SIZE);
+	CHECK(GetStateFileSize(*state0, REGION_DELTA_NAME) == 0);
+
+	FillPage(memory, 3, 0xAA);
+	FillPage(memory, 8, 0xBB);
+	//Same content as before, page doesn't need to be saved
+	FillPage(memory, 5, 5);
+	auto memory1 = memory;
+	auto state1 = SaveCheckpoint(tracker, memory, 1);
+	CHECK(tracker.GetSequence() == 1);
+	CHECK(GetStateFileSize(*state1, REGION_NAME) == 0);
+	CHECK(GetStateFileSize(*state1, REGION_DELTA_NAME) == (DELTA_HEADER_SIZE + (2 * PAGE_SIZE)));
+
+	FillPage(memory, 3, 0xCC);
+	FillPage(memory, 15, 0xDD);
+	auto memory2 = memory;
+	auto state2 = SaveCheckpoint(tracker, memory, 2);
+	CHECK(GetStateFileSize(*state2, REGION_DELTA_NAME) == (DELTA_HEADER_SIZE + (2 * PAGE_SIZE)));
+
+	//Nothing changed, delta only has its header
+	auto state3 = SaveCheckpoint(tracker, memory, 3);
+	CHECK(GetStateFileSize(*state3, REGION_DELTA_NAME) == DELTA_HEADER_SIZE);
+
+	CheckState(*MaterializeChain({state0.get()}), memory0, 0);
+	CheckState(*MaterializeChain({state0.get(), state1.get()}), memory1, 1);
+	CheckState(*MaterializeChain({state0.get(), state1.get(), state2.get()}), memory2, 2);
+	CheckState(*MaterializeChain({state0.get(), state1.get(), state2.get(), state3.get()}), memory2, 3);
+}
+
+//Only pages reported as written are looked at, those with unchanged content are left out
+void ExecuteStateDeltaTrackerTrackedTest()
+{
+	CStateDeltaTracker tracker;
+	std::vector<uint8> memory(MEMORY_SIZE, 0);
+	CMemoryStateTracker::PageBitmap dirtyPages(PAGE_COUNT, 1);
+	unsigned int queryCount = 0;
+
+	tracker.SetDirtyPageQuery(memory.data(), PAGE_SIZE,
+	                          [&](CMemoryStateTracker::PageBitmap& result) {
+		                          result = dirtyPages;
+		                          std::fill(dirtyPages.begin(), dirtyPages.end(), 0);
+		                          queryCount++;
+		                          return true;
+	                          });
+
+	auto writePage = [&](uint32 pageIndex, uint8 value) {
+		FillPage(memory, pageIndex, value);
+		dirtyPages[pageIndex] = 1;
+	};
+
+	auto state0 = SaveCheckpoint(tracker, memory, 0);
+	CHECK(queryCount == 1);
+
+	writePage(2, 0x22);
+	writePage(6, 0x00);
+	auto memory1 = memory;
+	auto state1 = SaveCheckpoint(tracker, memory, 1);
+	CHECK(queryCount == 2);
+	CHECK(GetStateFileSize(*state1, REGION_DELTA_NAME) == (DELTA_HEADER_SIZE + PAGE_SIZE));
+
+	writePage(2, 0x33);
+	writePage(9, 0x99);
+	auto memory2 = memory;
+	auto state2 = SaveCheckpoint(tracker, memory, 2);
+	CHECK(GetStateFileSize(*state2, REGION_DELTA_NAME) == (DELTA_HEADER_SIZE + (2 * PAGE_SIZE)));
+
+	CheckState(*MaterializeChain({state0.get(), state1.get()}), memory1, 1);
+	CheckState(*MaterializeChain({state0.get(), state1.get(), state2.get()}), memory2, 2);
+}
+
+//Chains with missing, reordered or foreign states can't be materialized
+void ExecuteStateDeltaChainValidationTest()
+{
+	std::vector<uint8> memory(MEMORY_SIZE, 0);
+
+	CStateDeltaTracker tracker;
+	auto state0 = SaveCheckpoint(tracker, memory, 0);
+	FillPage(memory, 1, 0x11);
+	auto state1 = SaveCheckpoint(tracker, memory, 1);
+	FillPage(memory, 2, 0x22);
+	auto state2 = SaveCheckpoint(tracker, memory, 2);
+
+	CStateDeltaTracker otherTracker;
+	auto otherState0 = SaveCheckpoint(otherTracker, memory, 0);
+	auto otherState1 = SaveCheckpoint(otherTracker, memory, 1);
+
+	CHECK(!IsChainRejected({state0.get(), state1.get(), state2.get()}));
+	CHECK(IsChainRejected({}));
+	CHECK(IsChainRejected({state1.get()}));
+	CHECK(IsChainRejected({state0.get(), state2.get()}));
+	CHECK(IsChainRejected({state0.get(), state2.get(), state1.get()}));
+	CHECK(IsChainRejected({state0.get(), otherState1.get()}));
+	CHECK(IsChainRejected({otherState0.get(), state1.get()}));
+
+	//A reset starts a new chain with a complete state
+	tracker.Reset();
+	auto state3 = SaveCheckpoint(tracker, memory, 3);
+	CHECK(tracker.IsBaseCheckpoint());
+	CHECK(GetStateFileSize(*state3, REGION_NAME) == MEMORY_SIZE);
+	CHECK(IsChainRejected({state0.get(), state1.get(), state2.get(), state3.get()}));
+	CheckState(*MaterializeChain({state3.get()}), memory, 3);
+}
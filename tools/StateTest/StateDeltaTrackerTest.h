@@ -0,0 +1,5 @@
+#pragma once
+
+void ExecuteStateDeltaTrackerTest();
+void ExecuteStateDeltaTrackerTrackedTest();
+void ExecuteStateDeltaChainValidationTest();
@@ -0,0 +1,57 @@
+#include <stdio.h>
+#include <stdexcept>
+#include "StdStream.h"
+#include "StdStreamUtils.h"
+#include "filesystem_def.h"
+#include "TraceFile.h"
+
+//Converts a binary trace file (as written by CTraceLog::Dump) to text.
+//Usage: TraceDecoder <trace path>
+
+int main(int argc, const char** argv)
+{
+	if(argc < 2)
+	{
+		printf("Usage: TraceDecoder <trace path>\r\n");
+		return 1;
+	}
+
+	try
+	{
+		auto stream = Framework::CreateInputStdStream(fs::path(argv[1]).native());
+		CTraceFile traceFile(stream);
+
+		for(const auto& thread : traceFile.GetThreads())
+		{
+			if(thread.lostEventCount != 0)
+			{
+				printf("Thread %d: %llu older events were overwritten.\r\n",
+				       thread.threadIndex, static_cast<unsigned long long>(thread.lostEventCount));
+			}
+		}
+
+		const auto& formats = traceFile.GetFormats();
+		const auto& events = traceFile.GetEvents();
+		uint64 baseTimestamp = events.empty() ? 0 : events[0].event.timestamp;
+		for(const auto& event : events)
+		{
+			double time = static_cast<double>(event.event.timestamp - baseTimestamp) / 1000000000.0;
+			if(event.event.formatId >= formats.size())
+			{
+				printf("[%12.6f] T%d: <invalid format id %d>\r\n", time, event.threadIndex, event.event.formatId);
+				continue;
+			}
+			const auto& format = formats[event.event.formatId];
+			auto text = CTraceFile::FormatEvent(format.format, event.event);
+			printf("[%12.6f] T%d %s: %s\r\n", time, event.threadIndex,
+			       CTraceLog::GetSubsystemName(format.subsystem), text.c_str());
+		}
+	}
+	catch(const std::exception& exception)
+	{
+		printf("Error: %s\r\n", exception.what());
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,101 @@
+#include <cstring>
+#include "MemStream.h"
+#include "TraceFile.h"
+
+#define CHECK(condition)        \
+	if(!(condition))            \
+	{                           \
+		throw std::exception(); \
+	}
+
+static CTraceLog::EVENT MakeEvent(std::initializer_list<uint32> args)
+{
+	CTraceLog::EVENT event = {};
+	for(auto arg : args)
+	{
+		event.args[event.argCount++] = arg;
+	}
+	return event;
+}
+
+static CTraceFile DumpTraceLog()
+{
+	Framework::CMemStream stream;
+	CTraceLog::GetInstance().Dump(stream);
+	stream.Seek(0, Framework::STREAM_SEEK_SET);
+	return CTraceFile(stream);
+}
+
+//Events of disabled subsystems must not be recorded
+void ExecuteDisabledTest()
+{
+	auto& traceLog = CTraceLog::GetInstance();
+	CHECK(traceLog.GetEnabledMask() == 0);
+	CHECK(!traceLog.IsEnabled(TRACE_SUBSYSTEM_DMAC));
+
+	TRACE_EVENT(TRACE_SUBSYSTEM_DMAC, "disabled = %d", 1);
+
+	auto traceFile = DumpTraceLog();
+	CHECK(traceFile.GetFormats().empty());
+	CHECK(traceFile.GetEvents().empty());
+}
+
+//Once a ring is full, the oldest events are overwritten and accounted for
+void ExecuteRingWrapTest()
+{
+	auto& traceLog = CTraceLog::GetInstance();
+	traceLog.SetEnabledMask(1 << TRACE_SUBSYSTEM_DMAC);
+	CHECK(traceLog.IsEnabled(TRACE_SUBSYSTEM_DMAC));
+	CHECK(!traceLog.IsEnabled(TRACE_SUBSYSTEM_SIF));
+
+	static const uint32 lostEventCount = 0x10;
+	static const uint32 eventCount = CTraceLog::RING_SIZE + lostEventCount;
+	uint32 formatId = traceLog.RegisterFormat(TRACE_SUBSYSTEM_DMAC, "event = %d");
+	for(uint32 i = 0; i < eventCount; i++)
+	{
+		traceLog.Write(formatId, i);
+	}
+
+	auto traceFile = DumpTraceLog();
+	CHECK(traceFile.GetFormats().size() == 1);
+	CHECK(traceFile.GetFormats()[0].subsystem == TRACE_SUBSYSTEM_DMAC);
+	CHECK(traceFile.GetFormats()[0].format == "event = %d");
+
+	const auto& threads = traceFile.GetThreads();
+	CHECK(threads.size() == 1);
+	CHECK(threads[0].eventCount == CTraceLog::RING_SIZE);
+	CHECK(threads[0].lostEventCount == lostEventCount);
+
+	const auto& events = traceFile.GetEvents();
+	CHECK(events.size() == CTraceLog::RING_SIZE);
+	for(uint32 i = 0; i < events.size(); i++)
+	{
+		const auto& event = events[i].event;
+		CHECK(event.formatId == formatId);
+		CHECK(event.argCount == 1);
+		CHECK(event.args[0] == (lostEventCount + i));
+	}
+
+	traceLog.SetEnabledMask(0);
+}
+
+void ExecuteFormatTest()
+{
+	float floatValue = 1.5f;
+	uint32 floatBits = 0;
+	memcpy(&floatBits, &floatValue, sizeof(uint32));
+
+	CHECK(CTraceFile::FormatEvent("%d %u 0x%08X", MakeEvent({static_cast<uint32>(-5), 7, 0xABCD})) == "-5 7 0x0000ABCD");
+	CHECK(CTraceFile::FormatEvent("%hhd %hu", MakeEvent({0x1FF, 0x12345})) == "-1 9029");
+	CHECK(CTraceFile::FormatEvent("%5.2f%%", MakeEvent({floatBits})) == " 1.50%");
+	CHECK(CTraceFile::FormatEvent("[%*d]", MakeEvent({4, 7})) == "[   7]");
+	CHECK(CTraceFile::FormatEvent("%d, %d", MakeEvent({1})) == "1, <missing>");
+}
+
+int main(int argc, const char** argv)
+{
+	ExecuteDisabledTest();
+	ExecuteRingWrapTest();
+	ExecuteFormatTest();
+	return 0;
+}
@@ -0,0 +1,186 @@
+#include <stdio.h>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <stdexcept>
+#include "TraceFile.h"
+
+static void ReadExact(Framework::CStream& stream, void* buffer, uint64 size)
+{
+	if(size == 0) return;
+	if(stream.Read(buffer, size) != size)
+	{
+		throw std::runtime_error("Unexpected end of trace file.");
+	}
+}
+
+CTraceFile::CTraceFile(Framework::CStream& stream)
+{
+	CTraceLog::FILEHEADER header = {};
+	ReadExact(stream, &header, sizeof(header));
+	if(header.magic != CTraceLog::FILE_MAGIC)
+	{
+		throw std::runtime_error("Not a trace file.");
+	}
+	if(header.version != CTraceLog::FILE_VERSION)
+	{
+		throw std::runtime_error("Unsupported trace file version.");
+	}
+
+	m_formats.resize(header.formatCount);
+	for(auto& format : m_formats)
+	{
+		CTraceLog::FORMATHEADER formatHeader = {};
+		ReadExact(stream, &formatHeader, sizeof(formatHeader));
+		format.subsystem = formatHeader.subsystem;
+		format.format.resize(formatHeader.length);
+		ReadExact(stream, &format.format[0], formatHeader.length);
+	}
+
+	for(uint32 i = 0; i < header.threadCount; i++)
+	{
+		CTraceLog::THREADHEADER threadHeader = {};
+		ReadExact(stream, &threadHeader, sizeof(threadHeader));
+
+		THREAD thread;
+		thread.threadIndex = threadHeader.threadIndex;
+		thread.eventCount = threadHeader.eventCount;
+		thread.lostEventCount = threadHeader.lostEventCount;
+		m_threads.push_back(thread);
+
+		for(uint32 j = 0; j < threadHeader.eventCount; j++)
+		{
+			EVENT event;
+			event.threadIndex = threadHeader.threadIndex;
+			ReadExact(stream, &event.event, sizeof(CTraceLog::EVENT));
+			m_events.push_back(event);
+		}
+	}
+
+	std::stable_sort(m_events.begin(), m_events.end(),
+	                 [](const EVENT& lhs, const EVENT& rhs) { return lhs.event.timestamp < rhs.event.timestamp; });
+}
+
+const CTraceFile::FormatArray& CTraceFile::GetFormats() const
+{
+	return m_formats;
+}
+
+const CTraceFile::ThreadArray& CTraceFile::GetThreads() const
+{
+	return m_threads;
+}
+
+const CTraceFile::EventArray& CTraceFile::GetEvents() const
+{
+	return m_events;
+}
+
+std::string CTraceFile::FormatEvent(const std::string& format, const CTraceLog::EVENT& event)
+{
+	std::string result;
+	uint32 argIndex = 0;
+	auto nextArg = [&](bool& valid) {
+		valid = (argIndex < std::min<uint32>(event.argCount, CTraceLog::MAX_ARGS));
+		return valid ? event.args[argIndex++] : 0;
+	};
+
+	char output[256];
+	size_t position = 0;
+	while(position < format.size())
+	{
+		char character = format[position++];
+		if(character != '%')
+		{
+			result += character;
+			continue;
+		}
+		if((position < format.size()) && (format[position] == '%'))
+		{
+			result += '%';
+			position++;
+			continue;
+		}
+
+		//Rebuild the conversion specification, without length modifiers
+		std::string spec = "%";
+		bool valid = true;
+		while((position < format.size()) && strchr("-+ #0", format[position]))
+		{
+			spec += format[position++];
+		}
+		for(int field = 0; field < 2; field++)
+		{
+			if(field == 1)
+			{
+				if((position >= format.size()) || (format[position] != '.')) break;
+				spec += format[position++];
+			}
+			if((position < format.size()) && (format[position] == '*'))
+			{
+				spec += std::to_string(static_cast<int32>(nextArg(valid)));
+				position++;
+			}
+			while((position < format.size()) && isdigit(static_cast<unsigned char>(format[position])))
+			{
+				spec += format[position++];
+			}
+		}
+		std::string length;
+		while((position < format.size()) && strchr("hljztL", format[position]))
+		{
+			length += format[position++];
+		}
+		if(position >= format.size()) break;
+		char conversion = format[position++];
+		spec += conversion;
+
+		uint32 value = nextArg(valid);
+		if(!valid)
+		{
+			result += "<missing>";
+			continue;
+		}
+
+		switch(conversion)
+		{
+		case 'd':
+		case 'i':
+		{
+			int32 signedValue = static_cast<int32>(value);
+			if(length == "hh") signedValue = static_cast<int8>(value);
+			if(length == "h") signedValue = static_cast<int16>(value);
+			snprintf(output, sizeof(output), spec.c_str(), signedValue);
+		}
+		break;
+		case 'u':
+		case 'o':
+		case 'x':
+		case 'X':
+		case 'c':
+			if(length == "hh") value = static_cast<uint8>(value);
+			if(length == "h") value = static_cast<uint16>(value);
+			snprintf(output, sizeof(output), spec.c_str(), value);
+			break;
+		case 'f':
+		case 'F':
+		case 'e':
+		case 'E':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+		{
+			float floatValue = 0;
+			memcpy(&floatValue, &value, sizeof(float));
+			snprintf(output, sizeof(output), spec.c_str(), static_cast<double>(floatValue));
+		}
+		break;
+		default:
+			snprintf(output, sizeof(output), "<%%%c unsupported>", conversion);
+			break;
+		}
+		result += output;
+	}
+	return result;
+}
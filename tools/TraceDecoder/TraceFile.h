@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "Stream.h"
+#include "TraceLog.h"
+
+//Reads a binary trace file, as written by CTraceLog::Dump
+class CTraceFile
+{
+public:
+	struct FORMAT
+	{
+		uint32 subsystem = 0;
+		std::string format;
+	};
+	typedef std::vector<FORMAT> FormatArray;
+
+	struct THREAD
+	{
+		uint32 threadIndex = 0;
+		uint32 eventCount = 0;
+		uint64 lostEventCount = 0;
+	};
+	typedef std::vector<THREAD> ThreadArray;
+
+	struct EVENT
+	{
+		uint32 threadIndex = 0;
+		CTraceLog::EVENT event;
+	};
+	typedef std::vector<EVENT> EventArray;
+
+	CTraceFile(Framework::CStream&);
+
+	const FormatArray& GetFormats() const;
+	const ThreadArray& GetThreads() const;
+	//Events of all threads, ordered by timestamp
+	const EventArray& GetEvents() const;
+
+	//Formats the arguments the same way printf would have, arguments being stored as 32-bit values
+	static std::string FormatEvent(const std::string&, const CTraceLog::EVENT&);
+
+private:
+	FormatArray m_formats;
+	ThreadArray m_threads;
+	EventArray m_events;
+};
@@ -1,12 +1,33 @@
+#include <stdio.h>
+#include <chrono>
+#include <random>
 #include "AddTest.h"
 #include "VuAssembler.h"
+#include "ee/FpAddTruncate.h"
+#include "ee/FpMulTruncate.h"
+
+#define BIT_EXACT_TEST_COUNT 0x10000
+#define THROUGHPUT_TEST_INSTRUCTION_COUNT 0x600
+#define THROUGHPUT_TEST_ITERATION_COUNT 0x400
 
 static uint32 FloatToInt(float value)
 {
 	return *reinterpret_cast<uint32*>(&value);
 }
 
+static uint32 GetExponent(uint32 value)
+{
+	return (value >> 23) & 0xFF;
+}
+
 void CAddTest::Execute(CTestVm& virtualMachine)
+{
+	ExecuteBasicTest(virtualMachine);
+	ExecuteBitExactTest(virtualMachine);
+	ExecuteThroughputTest(virtualMachine);
+}
+
+void CAddTest::ExecuteBasicTest(CTestVm& virtualMachine)
 {
 	virtualMachine.Reset();
 
@@ -42,3 +63,212 @@ void CAddTest::Execute(CTestVm& virtualMachine)
 	TEST_VERIFY(virtualMachine.m_cpu.m_State.nCOP2[2].nV2 == FloatToInt(96 + 2048));
 	TEST_VERIFY(virtualMachine.m_cpu.m_State.nCOP2[2].nV3 == FloatToInt(128 + 2048));
 }
+
+void CAddTest::ExecuteBitExactTest(CTestVm& virtualMachine)
+{
+	//Compares results of the FMAC additions, subtractions and multiplications against the scalar
+	//FpAddTruncate and FpMulTruncate functions
+	virtualMachine.Reset();
+
+	auto microMem = reinterpret_cast<uint32*>(virtualMachine.m_microMem);
+
+	CVuAssembler assembler(microMem);
+
+	assembler.Write(
+	    CVuAssembler::Upper::ADDi(CVuAssembler::DEST_XYZW, CVuAssembler::VF2, CVuAssembler::VF1),
+	    CVuAssembler::Lower::NOP());
+
+	assembler.Write(
+	    CVuAssembler::Upper::MULi(CVuAssembler::DEST_XYZW, CVuAssembler::VF3, CVuAssembler::VF1),
+	    CVuAssembler::Lower::NOP());
+
+	assembler.Write(
+	    CVuAssembler::Upper::ADD(CVuAssembler::DEST_XYZW, CVuAssembler::VF5, CVuAssembler::VF1, CVuAssembler::VF4),
+	    CVuAssembler::Lower::NOP());
+
+	assembler.Write(
+	    CVuAssembler::Upper::ADDbc(CVuAssembler::DEST_XYZW, CVuAssembler::VF6, CVuAssembler::VF1, CVuAssembler::VF4, CVuAssembler::BC_Y),
+	    CVuAssembler::Lower::NOP());
+
+	assembler.Write(
+	    CVuAssembler::Upper::ADDq(CVuAssembler::DEST_XYZW, CVuAssembler::VF7, CVuAssembler::VF1),
+	    CVuAssembler::Lower::NOP());
+
+	assembler.Write(
+	    CVuAssembler::Upper::SUB(CVuAssembler::DEST_XYZW, CVuAssembler::VF8, CVuAssembler::VF1, CVuAssembler::VF4),
+	    CVuAssembler::Lower::NOP());
+
+	assembler.Write(
+	    CVuAssembler::Upper::SUBq(CVuAssembler::DEST_XYZW, CVuAssembler::VF9, CVuAssembler::VF1),
+	    CVuAssembler::Lower::NOP());
+
+	assembler.Write(
+	    CVuAssembler::Upper::MADD(CVuAssembler::DEST_XYZW, CVuAssembler::VF10, CVuAssembler::VF1, CVuAssembler::VF4),
+	    CVuAssembler::Lower::NOP());
+
+	assembler.Write(
+	    CVuAssembler::Upper::MSUB(CVuAssembler::DEST_XYZW, CVuAssembler::VF11, CVuAssembler::VF1, CVuAssembler::VF4),
+	    CVuAssembler::Lower::NOP());
+
+	assembler.Write(
+	    CVuAssembler::Upper::NOP() | CVuAssembler::Upper::E_BIT,
+	    CVuAssembler::Lower::NOP());
+
+	assembler.Write(
+	    CVuAssembler::Upper::NOP(),
+	    CVuAssembler::Lower::NOP());
+
+	static const uint32 specialValues[] =
+	    {
+	        0x00000000, 0x80000000, 0x00000001, 0x807FFFFF, 0x00800000, 0x80800000,
+	        0x3F800000, 0xBF800000, 0x3F800001, 0xBF7FFFFF, 0x4B000000, 0xCB7FFFFF,
+	        0x7F7FFFFF, 0xFF7FFFFF, 0x7F000000, 0xFEFFFFFF, 0x0D000001, 0x8C800001};
+
+	std::mt19937 randomGenerator(0x5A5A5A5A);
+	auto generateValue = [&](uint32 other) {
+		uint32 value = randomGenerator();
+		switch(randomGenerator() % 4)
+		{
+		case 0:
+			//Same exponent range as the other operand, to have bits shifted out
+			value = (value & 0x807FFFFF) | (((GetExponent(other) + (value % 61) - 30) & 0xFF) << 23);
+			break;
+		case 1:
+			//Close to the negated other operand, to have cancellation
+			value = (other ^ 0x80000000) + (value % 64) - 32;
+			break;
+		case 2:
+			value = specialValues[value % (sizeof(specialValues) / sizeof(specialValues[0]))];
+			break;
+		}
+		//NaN and infinities can't be produced by the VU
+		if(GetExponent(value) == 0xFF)
+		{
+			value &= 0xBFFFFFFF;
+		}
+		return value;
+	};
+
+	auto& state = virtualMachine.m_cpu.m_State;
+	for(unsigned int i = 0; i < BIT_EXACT_TEST_COUNT; i++)
+	{
+		uint32 iValue = generateValue(randomGenerator());
+		uint32 qValue = generateValue(randomGenerator());
+		state.nCOP2I = iValue;
+		//Q is refreshed from the pipeline when the program starts
+		state.nCOP2Q = qValue;
+		state.pipeQ.heldValue = qValue;
+		for(unsigned int j = 0; j < 4; j++)
+		{
+			state.nCOP2[1].nV[j] = generateValue(iValue);
+			state.nCOP2[4].nV[j] = generateValue(state.nCOP2[1].nV[j]);
+		}
+		for(unsigned int j = 0; j < 4; j++)
+		{
+			uint32 product = FpMulTruncate(state.nCOP2[1].nV[j], state.nCOP2[4].nV[j]);
+			state.nCOP2A.nV[j] = generateValue(product);
+		}
+
+		state.nHasException = MIPS_EXCEPTION_NONE;
+		virtualMachine.ExecuteTest(0);
+
+		for(unsigned int j = 0; j < 4; j++)
+		{
+			uint32 value = state.nCOP2[1].nV[j];
+			uint32 other = state.nCOP2[4].nV[j];
+			TEST_VERIFY(state.nCOP2[2].nV[j] == FpAddTruncate(value, iValue));
+			TEST_VERIFY(state.nCOP2[5].nV[j] == FpAddTruncate(value, other));
+			TEST_VERIFY(state.nCOP2[6].nV[j] == FpAddTruncate(value, state.nCOP2[4].nV1));
+			TEST_VERIFY(state.nCOP2[7].nV[j] == FpAddTruncate(value, qValue));
+			TEST_VERIFY(state.nCOP2[8].nV[j] == FpAddTruncate(value, other ^ 0x80000000));
+			TEST_VERIFY(state.nCOP2[9].nV[j] == FpAddTruncate(value, qValue ^ 0x80000000));
+
+			//Multiplications are done by the host while rounding toward zero, which matches for normal operands
+			//as long as there's no overflow (FpMulTruncate returns infinity, host returns the largest value)
+			auto isProductExact = [](uint32 lhs, uint32 rhs, uint32 product) {
+				return (GetExponent(lhs) != 0) && (GetExponent(rhs) != 0) && (GetExponent(product) != 0xFF);
+			};
+
+			uint32 product = FpMulTruncate(value, iValue);
+			if(isProductExact(value, iValue, product))
+			{
+				TEST_VERIFY(state.nCOP2[3].nV[j] == product);
+			}
+
+			//Product is rounded before being accumulated, a denormal product is flushed to zero by the addition
+			uint32 accumulator = state.nCOP2A.nV[j];
+			product = FpMulTruncate(value, other);
+			if(isProductExact(value, other, product))
+			{
+				TEST_VERIFY(state.nCOP2[10].nV[j] == FpAddTruncate(accumulator, product));
+				TEST_VERIFY(state.nCOP2[11].nV[j] == FpAddTruncate(accumulator, product ^ 0x80000000));
+			}
+		}
+	}
+}
+
+void CAddTest::ExecuteThroughputTest(CTestVm& virtualMachine)
+{
+	auto measureInstruction = [&](uint32 upperOp) {
+		virtualMachine.Reset();
+
+		CVuAssembler assembler(reinterpret_cast<uint32*>(virtualMachine.m_microMem));
+		for(unsigned int i = 0; i < THROUGHPUT_TEST_INSTRUCTION_COUNT; i++)
+		{
+			assembler.Write(upperOp, CVuAssembler::Lower::NOP());
+		}
+		assembler.Write(CVuAssembler::Upper::NOP() | CVuAssembler::Upper::E_BIT, CVuAssembler::Lower::NOP());
+		assembler.Write(CVuAssembler::Upper::NOP(), CVuAssembler::Lower::NOP());
+
+		auto& state = virtualMachine.m_cpu.m_State;
+		state.nCOP2I = FloatToInt(2048);
+		for(unsigned int i = 0; i < 4; i++)
+		{
+			state.nCOP2[1].nV[i] = FloatToInt(static_cast<float>(i) - 96.5f);
+		}
+
+		//First run compiles the program
+		virtualMachine.ExecuteTest(0);
+
+		auto startTime = std::chrono::steady_clock::now();
+		for(unsigned int i = 0; i < THROUGHPUT_TEST_ITERATION_COUNT; i++)
+		{
+			state.nHasException = MIPS_EXCEPTION_NONE;
+			virtualMachine.ExecuteTest(0);
+		}
+		auto endTime = std::chrono::steady_clock::now();
+		return std::chrono::duration<double>(endTime - startTime).count();
+	};
+
+	double addTime = measureInstruction(CVuAssembler::Upper::ADDi(CVuAssembler::DEST_XYZW, CVuAssembler::VF2, CVuAssembler::VF1));
+	double mulTime = measureInstruction(CVuAssembler::Upper::MULi(CVuAssembler::DEST_XYZW, CVuAssembler::VF2, CVuAssembler::VF1));
+
+	//Same amount of elements through the scalar function, as ADDi used to call it for every element
+	double scalarTime = 0;
+	{
+		const uint32 iValue = FloatToInt(2048);
+		uint32 values[4] = {};
+		uint32 expectedSum = 0;
+		for(unsigned int i = 0; i < 4; i++)
+		{
+			values[i] = FloatToInt(static_cast<float>(i) - 96.5f);
+			expectedSum += FpAddTruncate(values[i], iValue);
+		}
+		uint32 sum = 0;
+		auto startTime = std::chrono::steady_clock::now();
+		for(unsigned int i = 0; i < THROUGHPUT_TEST_ITERATION_COUNT * THROUGHPUT_TEST_INSTRUCTION_COUNT; i++)
+		{
+			for(unsigned int j = 0; j < 4; j++)
+			{
+				sum += FpAddTruncate(values[j], iValue);
+			}
+		}
+		auto endTime = std::chrono::steady_clock::now();
+		scalarTime = std::chrono::duration<double>(endTime - startTime).count();
+		TEST_VERIFY(sum == expectedSum * THROUGHPUT_TEST_ITERATION_COUNT * THROUGHPUT_TEST_INSTRUCTION_COUNT);
+	}
+
+	double elementCount = static_cast<double>(THROUGHPUT_TEST_ITERATION_COUNT * THROUGHPUT_TEST_INSTRUCTION_COUNT * 4);
+	printf("Truncating add throughput (Melements/s): ADDi %.1f, MULi %.1f, FpAddTruncate %.1f.\n",
+	       elementCount / (addTime * 1000000.0), elementCount / (mulTime * 1000000.0), elementCount / (scalarTime * 1000000.0));
+}
@@ -6,4 +6,9 @@ class CAddTest : public CTest
 {
 public:
 	void Execute(CTestVm&) override;
+
+private:
+	void ExecuteBasicTest(CTestVm&);
+	void ExecuteBitExactTest(CTestVm&);
+	void ExecuteThroughputTest(CTestVm&);
 };
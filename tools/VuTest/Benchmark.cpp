@@ -0,0 +1,221 @@
+#include <stdio.h>
+#include <cstring>
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+#include "Benchmark.h"
+#include "VuAssembler.h"
+#include "StdStream.h"
+#include "FrameDump.h"
+#include "Ps2Const.h"
+
+#define BUILTIN_INSTRUCTION_COUNT 0x7F0
+
+CBenchmark::CBenchmark(std::string name, ProgramArray programs)
+    : m_name(std::move(name))
+    , m_programs(std::move(programs))
+{
+}
+
+CBenchmark CBenchmark::CreateFromFrameDump(const std::string& path)
+{
+#ifdef DEBUGGER_INCLUDED
+	CFrameDump frameDump;
+	{
+		Framework::CStdStream inputStream(path.c_str(), "rb");
+		frameDump.Read(inputStream);
+	}
+
+	//Every XGKICK packet holds the VU1 state from the start of the microprogram that sent it
+	ProgramArray programs;
+	for(const auto& packet : frameDump.GetPackets())
+	{
+		const auto& metadata = packet.metadata;
+		if(metadata.pathIndex != 1) continue;
+		PROGRAM program;
+		program.microMem.assign(metadata.microMem1, metadata.microMem1 + PS2::MICROMEM1SIZE);
+		program.vuMem.assign(metadata.vuMem1, metadata.vuMem1 + PS2::VUMEM1SIZE);
+		program.state = metadata.vu1State;
+		program.vifTop = metadata.vpu1Top;
+		program.vifItop = metadata.vpu1Itop;
+		programs.push_back(std::move(program));
+	}
+	if(programs.empty())
+	{
+		throw std::runtime_error("Frame dump doesn't contain any VU1 microprogram.");
+	}
+	return CBenchmark(path, std::move(programs));
+#else
+	throw std::runtime_error("Frame dumps only contain VU1 state when built with DEBUGGER_INCLUDED.");
+#endif
+}
+
+std::vector<CBenchmark> CBenchmark::CreateBuiltins(CTestVm& virtualMachine)
+{
+	virtualMachine.Reset();
+
+	//All programs start with the same register values
+	auto& initialState = virtualMachine.m_cpu.m_State;
+	for(unsigned int i = 1; i < 32; i++)
+	{
+		for(unsigned int j = 0; j < 4; j++)
+		{
+			float value = static_cast<float>(((i * 4) + j) % 7 + 1) * 0.5f;
+			memcpy(&initialState.nCOP2[i].nV[j], &value, sizeof(uint32));
+		}
+	}
+	float iValue = 1.5f;
+	memcpy(&initialState.nCOP2I, &iValue, sizeof(uint32));
+
+	auto createProgram = [&](const std::function<void(CVuAssembler&, unsigned int)>& writeInstruction) {
+		PROGRAM program;
+		program.microMem.resize(PS2::MICROMEM1SIZE);
+		program.vuMem.resize(PS2::VUMEM1SIZE);
+		program.state = initialState;
+		CVuAssembler assembler(reinterpret_cast<uint32*>(program.microMem.data()));
+		for(unsigned int i = 0; i < BUILTIN_INSTRUCTION_COUNT; i++)
+		{
+			writeInstruction(assembler, i);
+		}
+		assembler.Write(CVuAssembler::Upper::NOP() | CVuAssembler::Upper::E_BIT, CVuAssembler::Lower::NOP());
+		assembler.Write(CVuAssembler::Upper::NOP(), CVuAssembler::Lower::NOP());
+		return ProgramArray{program};
+	};
+
+	auto getRegister = [](unsigned int base, unsigned int index) {
+		return static_cast<CVuAssembler::VF_REGISTER>(base + (index % 8));
+	};
+
+	std::vector<CBenchmark> benchmarks;
+
+	//Vertex transformation by a matrix held in VF1-VF4
+	benchmarks.emplace_back("builtin:transform", createProgram([&](CVuAssembler& assembler, unsigned int i) {
+		auto vertex = getRegister(CVuAssembler::VF10, i / 4);
+		auto result = getRegister(CVuAssembler::VF20, i / 4);
+		switch(i % 4)
+		{
+		case 0:
+			assembler.Write(CVuAssembler::Upper::MULAbc(CVuAssembler::DEST_XYZW, CVuAssembler::VF1, vertex, CVuAssembler::BC_X), CVuAssembler::Lower::NOP());
+			break;
+		case 1:
+			assembler.Write(CVuAssembler::Upper::MADDAbc(CVuAssembler::DEST_XYZW, CVuAssembler::VF2, vertex, CVuAssembler::BC_Y), CVuAssembler::Lower::NOP());
+			break;
+		case 2:
+			assembler.Write(CVuAssembler::Upper::MADDAbc(CVuAssembler::DEST_XYZW, CVuAssembler::VF3, vertex, CVuAssembler::BC_Z), CVuAssembler::Lower::NOP());
+			break;
+		case 3:
+			assembler.Write(CVuAssembler::Upper::MADDbc(CVuAssembler::DEST_XYZW, result, CVuAssembler::VF4, vertex, CVuAssembler::BC_W), CVuAssembler::Lower::NOP());
+			break;
+		}
+	}));
+
+	//Additions and multiplications with the I register, additions need to truncate their operands
+	benchmarks.emplace_back("builtin:immediate", createProgram([&](CVuAssembler& assembler, unsigned int i) {
+		auto source = getRegister(CVuAssembler::VF1, i);
+		auto result = getRegister(CVuAssembler::VF20, i);
+		if(i & 1)
+		{
+			assembler.Write(CVuAssembler::Upper::MULi(CVuAssembler::DEST_XYZW, result, source), CVuAssembler::Lower::NOP());
+		}
+		else
+		{
+			assembler.Write(CVuAssembler::Upper::ADDi(CVuAssembler::DEST_XYZW, result, source), CVuAssembler::Lower::NOP());
+		}
+	}));
+
+	//Cross products, computed one element at a time
+	benchmarks.emplace_back("builtin:crossproduct", createProgram([&](CVuAssembler& assembler, unsigned int i) {
+		auto source0 = getRegister(CVuAssembler::VF1, i / 2);
+		auto source1 = getRegister(CVuAssembler::VF10, i / 2);
+		auto result = getRegister(CVuAssembler::VF20, i / 2);
+		if(i & 1)
+		{
+			assembler.Write(CVuAssembler::Upper::OPMSUB(result, source0, source1), CVuAssembler::Lower::NOP());
+		}
+		else
+		{
+			assembler.Write(CVuAssembler::Upper::OPMULA(source0, source1), CVuAssembler::Lower::NOP());
+		}
+	}));
+
+	//Subtractions with their MAC flags checked by the lower instruction
+	benchmarks.emplace_back("builtin:flags", createProgram([&](CVuAssembler& assembler, unsigned int i) {
+		auto source = getRegister(CVuAssembler::VF1, i);
+		auto result = getRegister(CVuAssembler::VF20, i);
+		uint32 lowerOp = (i & 1) ? CVuAssembler::Lower::FMAND(CVuAssembler::VI1, CVuAssembler::VI2) : CVuAssembler::Lower::FSAND(CVuAssembler::VI3, 0xF);
+		assembler.Write(CVuAssembler::Upper::SUBbc(CVuAssembler::DEST_XYZW, result, source, CVuAssembler::VF10, CVuAssembler::BC_X), lowerOp);
+	}));
+
+	return benchmarks;
+}
+
+CBenchmark::RESULT CBenchmark::Run(CTestVm& virtualMachine, unsigned int iterationCount)
+{
+	RESULT result;
+	result.name = m_name;
+
+	virtualMachine.Reset();
+	virtualMachine.m_executor.ResetStats();
+
+	auto& state = virtualMachine.m_cpu.m_State;
+	auto executionDuration = std::chrono::steady_clock::duration::zero();
+	for(unsigned int iteration = 0; iteration < iterationCount; iteration++)
+	{
+		for(const auto& program : m_programs)
+		{
+			if(memcmp(virtualMachine.m_microMem, program.microMem.data(), PS2::MICROMEM1SIZE))
+			{
+				//Same as what the VPU does when a microprogram is uploaded
+				memcpy(virtualMachine.m_microMem, program.microMem.data(), PS2::MICROMEM1SIZE);
+				virtualMachine.m_executor.ClearActiveBlocksInRange(0, PS2::MICROMEM1SIZE, false);
+			}
+			memcpy(virtualMachine.m_vuMem, program.vuMem.data(), PS2::VUMEM1SIZE);
+			state = program.state;
+			state.nHasException = MIPS_EXCEPTION_NONE;
+			virtualMachine.m_vifTop = program.vifTop;
+			virtualMachine.m_vifItop = program.vifItop;
+
+			uint64 runCycleCount = 0;
+			auto startTime = std::chrono::steady_clock::now();
+			while(state.nHasException == MIPS_EXCEPTION_NONE)
+			{
+				if(runCycleCount >= MAX_RUN_CYCLES)
+				{
+					//Program probably waits on something that isn't emulated here
+					result.abortedRunCount++;
+					break;
+				}
+				int remainingCycles = virtualMachine.m_executor.Execute(EXECUTION_QUOTA);
+				runCycleCount += EXECUTION_QUOTA - remainingCycles;
+			}
+			executionDuration += std::chrono::steady_clock::now() - startTime;
+
+			result.cycleCount += runCycleCount;
+			result.runCount++;
+		}
+	}
+
+	result.executionTime = std::chrono::duration<double>(executionDuration).count();
+	result.xgKickCount = virtualMachine.m_xgKickCount;
+	result.executorStats = virtualMachine.m_executor.GetStats();
+	return result;
+}
+
+void CBenchmark::PrintResultHeader()
+{
+	printf("name,runs,aborted_runs,cycles,seconds,compile_seconds,cycles_per_second,compiles,block_lookups,block_cache_hits,block_cache_hit_rate,xgkicks\n");
+}
+
+void CBenchmark::PrintResult(const RESULT& result)
+{
+	//Cycles per second doesn't account for time spent compiling blocks
+	const auto& stats = result.executorStats;
+	double compileTime = static_cast<double>(stats.compileTime) / 1000000000.0;
+	double runTime = result.executionTime - compileTime;
+	double cyclesPerSecond = (runTime > 0) ? (static_cast<double>(result.cycleCount) / runTime) : 0;
+	double hitRate = (stats.blockLookupCount != 0) ? (static_cast<double>(stats.blockCacheHitCount) / static_cast<double>(stats.blockLookupCount)) : 0;
+	printf("%s,%u,%u,%llu,%f,%f,%.0f,%u,%u,%u,%f,%u\n",
+	       result.name.c_str(), result.runCount, result.abortedRunCount, static_cast<unsigned long long>(result.cycleCount),
+	       result.executionTime, compileTime, cyclesPerSecond, stats.compileCount, stats.blockLookupCount,
+	       stats.blockCacheHitCount, hitRate, result.xgKickCount);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "TestVm.h"
+
+//Runs microprograms repeatedly through the VU executor and reports how fast they run.
+//Results are printed as CSV lines to make them easy to compare between builds.
+class CBenchmark
+{
+public:
+	struct PROGRAM
+	{
+		std::vector<uint8> microMem;
+		std::vector<uint8> vuMem;
+		MIPSSTATE state;
+		uint32 vifTop = 0;
+		uint32 vifItop = 0;
+	};
+	typedef std::vector<PROGRAM> ProgramArray;
+
+	struct RESULT
+	{
+		std::string name;
+		uint32 runCount = 0;
+		uint32 abortedRunCount = 0;
+		uint64 cycleCount = 0;
+		double executionTime = 0;
+		uint32 xgKickCount = 0;
+		CVuExecutor::STATS executorStats;
+	};
+
+	CBenchmark(std::string, ProgramArray);
+
+	static CBenchmark CreateFromFrameDump(const std::string&);
+	static std::vector<CBenchmark> CreateBuiltins(CTestVm&);
+
+	RESULT Run(CTestVm&, unsigned int);
+
+	static void PrintResultHeader();
+	static void PrintResult(const RESULT&);
+
+private:
+	enum
+	{
+		EXECUTION_QUOTA = 5000,
+		MAX_RUN_CYCLES = 0x1000000,
+	};
+
+	std::string m_name;
+	ProgramArray m_programs;
+};
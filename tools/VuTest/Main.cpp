@@ -1,7 +1,12 @@
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
 #include <fenv.h>
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
 #include "AddTest.h"
+#include "Benchmark.h"
 #include "FlagsTest.h"
 #include "FlagsTest2.h"
 #include "TriAceTest.h"
@@ -16,12 +21,58 @@ static const TestFactoryFunction s_factories[] =
         []() { return new CTriAceTest(); },
 };
 
+//Usage: VuTest --benchmark [--iterations Count] [FrameDumpPath...]
+static int RunBenchmarks(CTestVm& virtualMachine, int argc, const char** argv)
+{
+	unsigned int iterationCount = 1000;
+	std::vector<std::string> frameDumpPaths;
+	for(int i = 2; i < argc; i++)
+	{
+		if(!strcmp(argv[i], "--iterations") && ((i + 1) < argc))
+		{
+			iterationCount = std::max(atoi(argv[++i]), 1);
+		}
+		else
+		{
+			frameDumpPaths.push_back(argv[i]);
+		}
+	}
+
+	try
+	{
+		auto benchmarks = CBenchmark::CreateBuiltins(virtualMachine);
+		for(const auto& frameDumpPath : frameDumpPaths)
+		{
+			benchmarks.push_back(CBenchmark::CreateFromFrameDump(frameDumpPath));
+		}
+
+		CBenchmark::PrintResultHeader();
+		for(auto& benchmark : benchmarks)
+		{
+			CBenchmark::PrintResult(benchmark.Run(virtualMachine, iterationCount));
+			fflush(stdout);
+		}
+	}
+	catch(const std::exception& exception)
+	{
+		fprintf(stderr, "Error: %s\n", exception.what());
+		return 1;
+	}
+
+	return 0;
+}
+
 int main(int argc, const char** argv)
 {
 	fesetround(FE_TOWARDZERO);
 
 	CTestVm virtualMachine;
 
+	if((argc >= 2) && !strcmp(argv[1], "--benchmark"))
+	{
+		return RunBenchmarks(virtualMachine, argc, argv);
+	}
+
 	for(const auto& factory : s_factories)
 	{
 		virtualMachine.Reset();
@@ -1,5 +1,7 @@
 #include "TestVm.h"
 #include "Ps2Const.h"
+#include "ee/Vpu.h"
+#include "placeholder_def.h"
 
 CTestVm::CTestVm()
     : m_cpu(MEMORYMAP_ENDIAN_LSBF)
@@ -9,7 +11,9 @@ CTestVm::CTestVm()
     , m_maVu(PS2::VUMEM1SIZE - 1)
 {
 	m_cpu.m_pMemoryMap->InsertReadMap(0x00000000, 0x00003FFF, m_vuMem, 0x00);
+	m_cpu.m_pMemoryMap->InsertReadMap(0x00008000, 0x00008FFF, std::bind(&CTestVm::IoPortReadHandler, this, PLACEHOLDER_1), 0x01);
 	m_cpu.m_pMemoryMap->InsertWriteMap(0x00000000, 0x00003FFF, m_vuMem, 0x00);
+	m_cpu.m_pMemoryMap->InsertWriteMap(0x00008000, 0x00008FFF, std::bind(&CTestVm::IoPortWriteHandler, this, PLACEHOLDER_1, PLACEHOLDER_2), 0x01);
 
 	m_cpu.m_pMemoryMap->InsertInstructionMap(0x00000000, 0x00003FFF, m_microMem, 0x01);
 
@@ -31,6 +35,9 @@ void CTestVm::Reset()
 	m_executor.Reset();
 	memset(m_vuMem, 0, PS2::VUMEM1SIZE);
 	memset(m_microMem, 0, PS2::MICROMEM1SIZE);
+	m_vifTop = 0;
+	m_vifItop = 0;
+	m_xgKickCount = 0;
 }
 
 void CTestVm::ExecuteTest(uint32 startAddress)
@@ -41,3 +48,25 @@ void CTestVm::ExecuteTest(uint32 startAddress)
 		m_executor.Execute(100);
 	}
 }
+
+uint32 CTestVm::IoPortReadHandler(uint32 address)
+{
+	switch(address)
+	{
+	case CVpu::VU_TOP:
+		return m_vifTop;
+	case CVpu::VU_ITOP:
+		return m_vifItop;
+	default:
+		return 0;
+	}
+}
+
+uint32 CTestVm::IoPortWriteHandler(uint32 address, uint32)
+{
+	if(address == CVpu::VU_XGKICK)
+	{
+		m_xgKickCount++;
+	}
+	return 0;
+}
@@ -18,4 +18,13 @@ public:
 	uint8* m_vuMem = nullptr;
 	uint8* m_microMem = nullptr;
 	CMA_VU m_maVu;
+
+	//Values returned when reading VIF registers, XGKICKs are only counted
+	uint32 m_vifTop = 0;
+	uint32 m_vifItop = 0;
+	uint32 m_xgKickCount = 0;
+
+private:
+	uint32 IoPortReadHandler(uint32);
+	uint32 IoPortWriteHandler(uint32, uint32);
 };
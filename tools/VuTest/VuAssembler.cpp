@@ -20,6 +20,27 @@ void CVuAssembler::Write(uint32 upperOp, uint32 lowerOp)
 //UPPER OPs
 //---------------------------------------------------------------------------------
 
+uint32 CVuAssembler::Upper::ADD(DEST dest, VF_REGISTER fd, VF_REGISTER fs, VF_REGISTER ft)
+{
+	uint32 result = 0x00000028;
+	result |= (fd << 6);
+	result |= (fs << 11);
+	result |= (ft << 16);
+	result |= (dest << 21);
+	return result;
+}
+
+uint32 CVuAssembler::Upper::ADDbc(DEST dest, VF_REGISTER fd, VF_REGISTER fs, VF_REGISTER ft, BROADCAST bc)
+{
+	uint32 result = 0x00000000;
+	result |= bc;
+	result |= (fd << 6);
+	result |= (fs << 11);
+	result |= (ft << 16);
+	result |= (dest << 21);
+	return result;
+}
+
 uint32 CVuAssembler::Upper::ADDi(DEST dest, VF_REGISTER fd, VF_REGISTER fs)
 {
 	uint32 result = 0x00000022;
@@ -29,6 +50,15 @@ uint32 CVuAssembler::Upper::ADDi(DEST dest, VF_REGISTER fd, VF_REGISTER fs)
 	return result;
 }
 
+uint32 CVuAssembler::Upper::ADDq(DEST dest, VF_REGISTER fd, VF_REGISTER fs)
+{
+	uint32 result = 0x00000020;
+	result |= (fd << 6);
+	result |= (fs << 11);
+	result |= (dest << 21);
+	return result;
+}
+
 uint32 CVuAssembler::Upper::ITOF0(DEST dest, VF_REGISTER ft, VF_REGISTER fs)
 {
 	uint32 result = 0x0000013C;
@@ -38,6 +68,16 @@ uint32 CVuAssembler::Upper::ITOF0(DEST dest, VF_REGISTER ft, VF_REGISTER fs)
 	return result;
 }
 
+uint32 CVuAssembler::Upper::MADD(DEST dest, VF_REGISTER fd, VF_REGISTER fs, VF_REGISTER ft)
+{
+	uint32 result = 0x00000029;
+	result |= (fd << 6);
+	result |= (fs << 11);
+	result |= (ft << 16);
+	result |= (dest << 21);
+	return result;
+}
+
 uint32 CVuAssembler::Upper::MADDbc(DEST dest, VF_REGISTER fd, VF_REGISTER fs, VF_REGISTER ft, BROADCAST bc)
 {
 	uint32 result = 0x00000008;
@@ -59,6 +99,16 @@ uint32 CVuAssembler::Upper::MADDAbc(DEST dest, VF_REGISTER fs, VF_REGISTER ft, B
 	return result;
 }
 
+uint32 CVuAssembler::Upper::MSUB(DEST dest, VF_REGISTER fd, VF_REGISTER fs, VF_REGISTER ft)
+{
+	uint32 result = 0x0000002D;
+	result |= (fd << 6);
+	result |= (fs << 11);
+	result |= (ft << 16);
+	result |= (dest << 21);
+	return result;
+}
+
 uint32 CVuAssembler::Upper::MULi(DEST dest, VF_REGISTER fd, VF_REGISTER fs)
 {
 	uint32 result = 0x0000001E;
@@ -100,6 +150,16 @@ uint32 CVuAssembler::Upper::OPMSUB(VF_REGISTER fd, VF_REGISTER fs, VF_REGISTER f
 	return result;
 }
 
+uint32 CVuAssembler::Upper::SUB(DEST dest, VF_REGISTER fd, VF_REGISTER fs, VF_REGISTER ft)
+{
+	uint32 result = 0x0000002C;
+	result |= (fd << 6);
+	result |= (fs << 11);
+	result |= (ft << 16);
+	result |= (dest << 21);
+	return result;
+}
+
 uint32 CVuAssembler::Upper::SUBbc(DEST dest, VF_REGISTER fd, VF_REGISTER fs, VF_REGISTER ft, BROADCAST bc)
 {
 	uint32 result = 0x00000004;
@@ -111,6 +171,15 @@ uint32 CVuAssembler::Upper::SUBbc(DEST dest, VF_REGISTER fd, VF_REGISTER fs, VF_
 	return result;
 }
 
+uint32 CVuAssembler::Upper::SUBq(DEST dest, VF_REGISTER fd, VF_REGISTER fs)
+{
+	uint32 result = 0x00000024;
+	result |= (fd << 6);
+	result |= (fs << 11);
+	result |= (dest << 21);
+	return result;
+}
+
 //---------------------------------------------------------------------------------
 //LOWER OPs
 //---------------------------------------------------------------------------------
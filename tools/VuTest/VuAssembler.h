@@ -103,16 +103,23 @@ public:
 			E_BIT = 0x40000000,
 		};
 
+		static uint32 ADD(DEST, VF_REGISTER, VF_REGISTER, VF_REGISTER);
+		static uint32 ADDbc(DEST, VF_REGISTER, VF_REGISTER, VF_REGISTER, BROADCAST);
 		static uint32 ADDi(DEST, VF_REGISTER, VF_REGISTER);
+		static uint32 ADDq(DEST, VF_REGISTER, VF_REGISTER);
 		static uint32 ITOF0(DEST, VF_REGISTER, VF_REGISTER);
+		static uint32 MADD(DEST, VF_REGISTER, VF_REGISTER, VF_REGISTER);
 		static uint32 MADDbc(DEST, VF_REGISTER, VF_REGISTER, VF_REGISTER, BROADCAST);
 		static uint32 MADDAbc(DEST, VF_REGISTER, VF_REGISTER, BROADCAST);
+		static uint32 MSUB(DEST, VF_REGISTER, VF_REGISTER, VF_REGISTER);
 		static uint32 MULi(DEST, VF_REGISTER, VF_REGISTER);
 		static uint32 MULAbc(DEST, VF_REGISTER, VF_REGISTER, BROADCAST);
 		static uint32 NOP();
 		static uint32 OPMULA(VF_REGISTER, VF_REGISTER);
 		static uint32 OPMSUB(VF_REGISTER, VF_REGISTER, VF_REGISTER);
+		static uint32 SUB(DEST, VF_REGISTER, VF_REGISTER, VF_REGISTER);
 		static uint32 SUBbc(DEST, VF_REGISTER, VF_REGISTER, VF_REGISTER, BROADCAST);
+		static uint32 SUBq(DEST, VF_REGISTER, VF_REGISTER);
 	};
 
 	class Lower